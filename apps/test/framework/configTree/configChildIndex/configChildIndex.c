@@ -0,0 +1,261 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tests lookups in a stem with enough children for the configTree to index them by name, and that
+ * the configTree's cache of path lookups never hands back a node that has since been deleted or
+ * renamed.
+ *
+ * - Create a stem with many more children than it takes to get them indexed, and a nested stem.
+ * - Look all of them up a couple of times over, so that the lookups get cached.
+ * - Delete some of the children, and rename others, (the same way the config tool's move does.)
+ * - Check that the old paths are gone, that the new paths work, and that new nodes created under
+ *   the old names are the ones found.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+
+#define TEST_ROOT       "/configChildIndexTest"
+#define NUM_CHILDREN    40  // Well past the 16 children it takes to get a stem's children indexed.
+#define NUM_LOOKUPS     2   // Look each node up more than once, so the later lookups hit the cache.
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks the value of a child of the test root, which must be an int if it exists.  Its path is
+ * looked up both relative to the iterator and as an absolute path.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckChild
+(
+    le_cfg_IteratorRef_t iterRef,
+    const char* namePtr,
+    bool exists,
+    int32_t value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char absPath[LE_CFG_STR_LEN_BYTES] = "";
+    int lookup;
+
+    snprintf(absPath, sizeof(absPath), TEST_ROOT "/%s", namePtr);
+
+    for (lookup = 0; lookup < NUM_LOOKUPS; lookup++)
+    {
+        LE_TEST(le_cfg_NodeExists(iterRef, namePtr) == exists);
+        LE_TEST(le_cfg_NodeExists(iterRef, absPath) == exists);
+
+        if (exists)
+        {
+            LE_TEST(le_cfg_GetNodeType(iterRef, namePtr) == LE_CFG_TYPE_INT);
+            LE_TEST(le_cfg_GetInt(iterRef, namePtr, -1) == value);
+            LE_TEST(le_cfg_GetInt(iterRef, absPath, -1) == value);
+        }
+        else
+        {
+            LE_TEST(le_cfg_GetNodeType(iterRef, namePtr) == LE_CFG_TYPE_DOESNT_EXIST);
+            LE_TEST(le_cfg_GetInt(iterRef, absPath, -1) == -1);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks the value of the leaf under the nested stem, which has the given name.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckLeaf
+(
+    le_cfg_IteratorRef_t iterRef,
+    const char* stemNamePtr,
+    bool exists,
+    const char* valuePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char leafPath[LE_CFG_STR_LEN_BYTES] = "";
+    char buffer[LE_CFG_STR_LEN_BYTES] = "";
+    int lookup;
+
+    snprintf(leafPath, sizeof(leafPath), "%s/leaf", stemNamePtr);
+
+    for (lookup = 0; lookup < NUM_LOOKUPS; lookup++)
+    {
+        LE_TEST(le_cfg_NodeExists(iterRef, leafPath) == exists);
+        LE_TEST(le_cfg_GetString(iterRef, leafPath, buffer, sizeof(buffer), "none") == LE_OK);
+        LE_TEST(strcmp(buffer, exists ? valuePtr : "none") == 0);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Renames a node under the test root, by exporting it, deleting it and importing it again under its
+ * new name, the same way the config tool moves nodes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RenameNode
+(
+    le_cfg_IteratorRef_t iterRef,   ///< Write transaction, positioned at the test root.
+    const char* oldNamePtr,
+    const char* newNamePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char filePath[] = "/tmp/configChildIndex-XXXXXX";
+    int fd = mkstemp(filePath);
+
+    LE_FATAL_IF(fd == -1, "Could not create temp file (%m).");
+    close(fd);
+
+    LE_TEST(le_cfgAdmin_ExportTree(iterRef, filePath, oldNamePtr) == LE_OK);
+    le_cfg_DeleteNode(iterRef, oldNamePtr);
+    LE_TEST(le_cfgAdmin_ImportTree(iterRef, filePath, newNamePtr) == LE_OK);
+
+    unlink(filePath);
+}
+
+
+COMPONENT_INIT
+{
+    char name[LE_CFG_NAME_LEN_BYTES] = "";
+    le_cfg_IteratorRef_t iterRef;
+    int i;
+
+    LE_INFO("----  Creating %d children.  ----------------------------", NUM_CHILDREN);
+
+    iterRef = le_cfg_CreateWriteTxn(TEST_ROOT);
+    le_cfg_DeleteNode(iterRef, "");
+
+    for (i = 0; i < NUM_CHILDREN; i++)
+    {
+        snprintf(name, sizeof(name), "child%d", i);
+        le_cfg_SetInt(iterRef, name, i);
+    }
+
+    le_cfg_SetString(iterRef, "nested/leaf", "leafValue");
+    le_cfg_CommitTxn(iterRef);
+
+
+    LE_INFO("----  Looking up all of the children.  ------------------");
+
+    iterRef = le_cfg_CreateReadTxn(TEST_ROOT);
+
+    for (i = 0; i < NUM_CHILDREN; i++)
+    {
+        snprintf(name, sizeof(name), "child%d", i);
+        CheckChild(iterRef, name, true, i);
+    }
+
+    CheckChild(iterRef, "child5x", false, 0);
+    CheckLeaf(iterRef, "nested", true, "leafValue");
+
+    le_cfg_CancelTxn(iterRef);
+
+
+    LE_INFO("----  Deleting and renaming children.  ------------------");
+
+    iterRef = le_cfg_CreateWriteTxn(TEST_ROOT);
+
+    // Delete every fourth child, and rename the ones after them.
+    for (i = 0; i < NUM_CHILDREN; i += 4)
+    {
+        snprintf(name, sizeof(name), "child%d", i);
+        le_cfg_DeleteNode(iterRef, name);
+
+        char newName[LE_CFG_NAME_LEN_BYTES] = "";
+        snprintf(name, sizeof(name), "child%d", i + 1);
+        snprintf(newName, sizeof(newName), "renamed%d", i + 1);
+        RenameNode(iterRef, name, newName);
+    }
+
+    RenameNode(iterRef, "nested", "nestedRenamed");
+
+    // The write transaction has to see the changes it made too.
+    CheckChild(iterRef, "child0", false, 0);
+    CheckChild(iterRef, "child1", false, 0);
+    CheckChild(iterRef, "renamed1", true, 1);
+    CheckLeaf(iterRef, "nested", false, NULL);
+    CheckLeaf(iterRef, "nestedRenamed", true, "leafValue");
+
+    le_cfg_CommitTxn(iterRef);
+
+
+    LE_INFO("----  Checking the old paths are gone.  -----------------");
+
+    iterRef = le_cfg_CreateReadTxn(TEST_ROOT);
+
+    for (i = 0; i < NUM_CHILDREN; i++)
+    {
+        snprintf(name, sizeof(name), "child%d", i);
+        CheckChild(iterRef, name, (i % 4) > 1, i);
+
+        if ((i % 4) == 1)
+        {
+            snprintf(name, sizeof(name), "renamed%d", i);
+            CheckChild(iterRef, name, true, i);
+        }
+    }
+
+    CheckLeaf(iterRef, "nested", false, NULL);
+    CheckLeaf(iterRef, "nestedRenamed", true, "leafValue");
+
+    le_cfg_CancelTxn(iterRef);
+
+
+    LE_INFO("----  Reusing the old names.  ---------------------------");
+
+    iterRef = le_cfg_CreateWriteTxn(TEST_ROOT);
+
+    for (i = 0; i < NUM_CHILDREN; i += 4)
+    {
+        snprintf(name, sizeof(name), "child%d", i);
+        le_cfg_SetInt(iterRef, name, 1000 + i);
+
+        snprintf(name, sizeof(name), "child%d", i + 1);
+        le_cfg_SetInt(iterRef, name, 2000 + i);
+    }
+
+    le_cfg_SetString(iterRef, "nested/leaf", "newLeafValue");
+    le_cfg_CommitTxn(iterRef);
+
+    iterRef = le_cfg_CreateReadTxn(TEST_ROOT);
+
+    for (i = 0; i < NUM_CHILDREN; i += 4)
+    {
+        snprintf(name, sizeof(name), "child%d", i);
+        CheckChild(iterRef, name, true, 1000 + i);
+
+        snprintf(name, sizeof(name), "child%d", i + 1);
+        CheckChild(iterRef, name, true, 2000 + i);
+
+        snprintf(name, sizeof(name), "renamed%d", i + 1);
+        CheckChild(iterRef, name, true, i + 1);
+    }
+
+    CheckLeaf(iterRef, "nested", true, "newLeafValue");
+    CheckLeaf(iterRef, "nestedRenamed", true, "leafValue");
+
+    le_cfg_CancelTxn(iterRef);
+
+
+    LE_INFO("----  Deleting the test root.  --------------------------");
+
+    le_cfg_QuickDeleteNode(TEST_ROOT);
+
+    iterRef = le_cfg_CreateReadTxn(TEST_ROOT);
+
+    CheckChild(iterRef, "child2", false, 0);
+    CheckChild(iterRef, "renamed1", false, 0);
+    CheckLeaf(iterRef, "nestedRenamed", false, NULL);
+
+    le_cfg_CancelTxn(iterRef);
+
+    LE_INFO("----  Done.  --------------------------------------------");
+
+    exit(EXIT_SUCCESS);
+}
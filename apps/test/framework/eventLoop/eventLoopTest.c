@@ -14,6 +14,15 @@ static le_event_Id_t EventIdC;
 
 static char EventContextA[] = "Context A";
 
+// Number of threads queueing functions to the main thread at the same time, and number of
+// functions queued by each of them.
+#define NUM_PRODUCERS 4
+#define NUM_PRODUCER_CALLS 10000
+
+static le_thread_Ref_t MainThread;
+static size_t NextProducerCall[NUM_PRODUCERS];
+static size_t ProducerCallCount = 0;
+
 typedef struct
 {
     char str[10];
@@ -82,6 +91,46 @@ static void Destructor
 }
 
 
+static void ProducerCall
+(
+    void* param1Ptr,    // Producer number.
+    void* param2Ptr     // Call number.
+)
+{
+    size_t producer = (size_t)param1Ptr;
+
+    LE_ASSERT(le_thread_GetCurrent() == MainThread);
+
+    // Each producer's calls must arrive in the order they were queued.
+    LE_ASSERT(producer < NUM_PRODUCERS);
+    LE_ASSERT((size_t)param2Ptr == NextProducerCall[producer]);
+    NextProducerCall[producer]++;
+
+    ProducerCallCount++;
+    if (ProducerCallCount == NUM_PRODUCERS * NUM_PRODUCER_CALLS)
+    {
+        LE_INFO("======== EVENT LOOP TEST COMPLETE (PASSED) ========");
+        exit(EXIT_SUCCESS);
+    }
+}
+
+
+static void* ProducerThread
+(
+    void* contextPtr    // Producer number.
+)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_PRODUCER_CALLS; i++)
+    {
+        le_event_QueueFunctionToThread(MainThread, ProducerCall, contextPtr, (void*)i);
+    }
+
+    return NULL;
+}
+
+
 static void CheckTestResults
 (
     void* param1Ptr,
@@ -95,8 +144,17 @@ static void CheckTestResults
     LE_ASSERT(TestBPassed);
     LE_ASSERT(TestCPassed);
 
-    LE_INFO("======== EVENT LOOP TEST COMPLETE (PASSED) ========");
-    exit(EXIT_SUCCESS);
+    // Have several threads queue functions to this one at the same time.  The test only
+    // finishes if none of them is lost.
+    LE_INFO("Queueing %d functions from each of %d threads.", NUM_PRODUCER_CALLS, NUM_PRODUCERS);
+
+    size_t i;
+    for (i = 0; i < NUM_PRODUCERS; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "Producer%zu", i);
+        le_thread_Start(le_thread_Create(name, ProducerThread, (void*)i));
+    }
 }
 
 
@@ -108,6 +166,8 @@ COMPONENT_INIT
 
     LE_INFO("%s called!", __func__);
 
+    MainThread = le_thread_GetCurrent();
+
     EventIdA = le_event_CreateId("Event A", sizeof(ReportA));
     EventIdB = le_event_CreateIdWithRefCounting("Event B");
     EventIdC = le_event_CreateIdWithRefCounting("Event C");
@@ -21,6 +21,8 @@ size_t le_hashmap_HashCustom(const void* keyPtr);
 bool le_hashmap_EqualsCustom(const void* firstPtr, const void* secondPtr);
 bool itHandler(const void* keyPtr, const void* valuePtr, void* contextPtr);
 void TestIterRemove(le_hashmap_Ref_t map);
+void TestGrowingMap(le_hashmap_Ref_t map);
+void TestCompactMap(le_hashmap_Ref_t map);
 
 typedef struct Key Key_t;
 struct Key {
@@ -55,7 +57,16 @@ COMPONENT_INIT
     LE_INFO("Creating long int/long int map");
     le_hashmap_Ref_t map6 = le_hashmap_Create("Map6", 200, &le_hashmap_HashUInt64, &le_hashmap_EqualsUInt64);
 
-    LE_TEST(map1 && map2 && map3 && map4 && map5 && map6);
+    LE_INFO("Creating growing map");
+    le_hashmap_Ref_t map7 = le_hashmap_Create("Map7", 3,
+                                              &le_hashmap_HashUInt32, &le_hashmap_EqualsUInt32);
+
+    LE_INFO("Creating compact map");
+    le_hashmap_Ref_t map8 = le_hashmap_CreateCompact("Map8", 3,
+                                                     &le_hashmap_HashUInt32,
+                                                     &le_hashmap_EqualsUInt32);
+
+    LE_TEST(map1 && map2 && map3 && map4 && map5 && map6 && map7 && map8);
 
     TestHashFns();
     TestIntHashMap(map1);
@@ -66,6 +77,8 @@ COMPONENT_INIT
     TestLongIntHashMap(map6);
     TestNewIter();
     TestIterRemove(map1);
+    TestGrowingMap(map7);
+    TestCompactMap(map8);
 
     LE_INFO("==== Hashmap Tests PASSED ====\n");
 
@@ -127,15 +140,28 @@ void TestIntHashMap(le_hashmap_Ref_t map)
     }
     LE_INFO("Iterator count = %d", itercnt);
     LE_TEST(itercnt == 500);
-    // Now back again.
+
+    // Walk forward again, stopping on the last entry, then back.  The entries must come back in
+    // the reverse of the order they were visited in, whatever that order is.
+    const void* visitedKeys[500];
+    mapIt = le_hashmap_GetIterator(map);
+    for (itercnt = 0; itercnt < 500; itercnt++)
+    {
+        LE_ASSERT(le_hashmap_NextNode(mapIt) == LE_OK);
+        visitedKeys[itercnt] = le_hashmap_GetKey(mapIt);
+    }
+    itercnt--;
     while (le_hashmap_PrevNode(mapIt) == LE_OK)
     {
         itercnt--;
-        le_hashmap_GetKey(mapIt);
+        if ((itercnt < 0) || (le_hashmap_GetKey(mapIt) != visitedKeys[itercnt]))
+        {
+            break;
+        }
         le_hashmap_GetValue(mapIt);
     }
     LE_INFO("Iterator count = %d", itercnt);
-    LE_TEST(itercnt == -1);
+    LE_TEST(itercnt == 0);
 
     // Cleanup the map again to allow it to be reused
     le_hashmap_RemoveAll(map);
@@ -526,3 +552,162 @@ void TestLongIntHashMap(le_hashmap_Ref_t map)
     mapIt = le_hashmap_GetIterator(map);
     LE_TEST(le_hashmap_NextNode(mapIt) == LE_NOT_FOUND);
 }
+
+void TestGrowingMap(le_hashmap_Ref_t map)
+{
+    uint32_t iKeys[1000];
+    uint32_t iVals[1000];
+    int itercnt = 0;
+    int j = 0;
+
+    LE_INFO("*** Running growing hashmap tests ***");
+
+    // Fill a map created for 3 entries, checking every entry is still found as it grows.
+    for (j=0; j<1000; j++) {
+        iKeys[j] = j;
+        iVals[j] = j * 3;
+        LE_ASSERT(le_hashmap_Put(map, &iKeys[j], &iVals[j]) == NULL);
+        LE_ASSERT(le_hashmap_Get(map, &iKeys[0]) == &iVals[0]);
+        LE_ASSERT(le_hashmap_Get(map, &iKeys[j / 2]) == &iVals[j / 2]);
+        LE_ASSERT(le_hashmap_Get(map, &iKeys[j]) == &iVals[j]);
+    }
+    LE_TEST(le_hashmap_Size(map) == 1000);
+
+    for (j=0; j<1000; j++) {
+        if (le_hashmap_Get(map, &iKeys[j]) != &iVals[j]) {
+            break;
+        }
+    }
+    LE_TEST(j == 1000);
+
+    // The map should have grown rather than degrading into long chains.
+    LE_INFO("Collision count = %zu", le_hashmap_CountCollisions(map));
+    LE_TEST(le_hashmap_CountCollisions(map) < 350);
+
+    // Add entries while iterating; every original entry must be visited exactly once.
+    uint32_t extraKeys[1000];
+    uint32_t seen[1000] = {0};
+    int added = 0;
+    le_hashmap_It_Ref_t mapIt = le_hashmap_GetIterator(map);
+    while (le_hashmap_NextNode(mapIt) == LE_OK)
+    {
+        const uint32_t* keyPtr = le_hashmap_GetKey(mapIt);
+        if (*keyPtr < 1000)
+        {
+            itercnt++;
+            seen[*keyPtr]++;
+        }
+        if (added < 1000)
+        {
+            extraKeys[added] = 1000 + added;
+            le_hashmap_Put(map, &extraKeys[added], &iVals[0]);
+            added++;
+        }
+    }
+    LE_TEST(itercnt == 1000);
+    for (j=0; j<1000; j++) {
+        if (seen[j] != 1) {
+            break;
+        }
+    }
+    LE_TEST(j == 1000);
+    LE_TEST(le_hashmap_Size(map) == 2000);
+
+    // Remove everything again, one by one.
+    for (j=0; j<1000; j++) {
+        LE_ASSERT(le_hashmap_Remove(map, &iKeys[j]) == &iVals[j]);
+        LE_ASSERT(le_hashmap_Remove(map, &extraKeys[j]) == &iVals[0]);
+    }
+    LE_TEST(le_hashmap_isEmpty(map));
+}
+
+void TestCompactMap(le_hashmap_Ref_t map)
+{
+    uint32_t iKeys[1000];
+    uint32_t iVals[1000];
+    uint32_t otherVal = 1;
+    bool removed[1000] = {false};
+    int itercnt = 0;
+    int j = 0;
+
+    LE_INFO("*** Running compact hashmap tests ***");
+
+    for (j=0; j<1000; j++) {
+        iKeys[j] = j * 2;
+        iVals[j] = j * 4;
+        LE_ASSERT(le_hashmap_Put(map, &iKeys[j], &iVals[j]) == NULL);
+    }
+    LE_TEST(le_hashmap_Size(map) == 1000);
+
+    // Replace a value.
+    LE_TEST(le_hashmap_Put(map, &iKeys[10], &otherVal) == &iVals[10]);
+    LE_TEST(le_hashmap_Get(map, &iKeys[10]) == &otherVal);
+    LE_TEST(le_hashmap_Put(map, &iKeys[10], &iVals[10]) == &otherVal);
+    LE_TEST(le_hashmap_Size(map) == 1000);
+
+    for (j=0; j<1000; j++) {
+        uint32_t key = j * 2;
+        if ((le_hashmap_Get(map, &key) != &iVals[j]) ||
+            (le_hashmap_GetStoredKey(map, &key) != &iKeys[j])) {
+            break;
+        }
+    }
+    LE_TEST(j == 1000);
+
+    uint32_t missingKey = 1;
+    LE_TEST(!le_hashmap_ContainsKey(map, &missingKey));
+    LE_TEST(le_hashmap_Get(map, &missingKey) == NULL);
+    LE_INFO("Collision count = %zu", le_hashmap_CountCollisions(map));
+
+    // Remove every other entry while iterating.
+    le_hashmap_It_Ref_t mapIt = le_hashmap_GetIterator(map);
+    LE_TEST(le_hashmap_GetKey(mapIt) == NULL);
+    while (le_hashmap_NextNode(mapIt) == LE_OK)
+    {
+        itercnt++;
+        const uint32_t* keyPtr = le_hashmap_GetKey(mapIt);
+        const uint32_t* valuePtr = le_hashmap_GetValue(mapIt);
+
+        LE_ASSERT(*valuePtr == (*keyPtr * 2));
+
+        if (itercnt % 2 != 0)
+        {
+            removed[*keyPtr / 2] = true;
+            le_hashmap_Remove(map, keyPtr);
+        }
+    }
+    LE_TEST(itercnt == 1000);
+    LE_TEST(le_hashmap_Size(map) == 500);
+
+    // Walk the remaining entries with the stateless functions.
+    void* keyPtr;
+    void* valuePtr;
+    itercnt = 0;
+    LE_TEST(le_hashmap_GetFirstNode(map, &keyPtr, &valuePtr) == LE_OK);
+    do
+    {
+        itercnt++;
+    }
+    while (le_hashmap_GetNodeAfter(map, keyPtr, &keyPtr, &valuePtr) == LE_OK);
+    LE_TEST(itercnt == 500);
+
+    // The entries left after removal must still be found past the deleted slots, and the removed
+    // ones must be gone.
+    for (j=0; j<1000; j++) {
+        if (removed[j]) {
+            if (le_hashmap_ContainsKey(map, &iKeys[j]) ||
+                (le_hashmap_Get(map, &iKeys[j]) != NULL)) {
+                break;
+            }
+        }
+        else if (le_hashmap_Get(map, &iKeys[j]) != &iVals[j]) {
+            break;
+        }
+    }
+    LE_TEST(j == 1000);
+
+    le_hashmap_RemoveAll(map);
+    LE_TEST(le_hashmap_isEmpty(map));
+    mapIt = le_hashmap_GetIterator(map);
+    LE_TEST(le_hashmap_NextNode(mapIt) == LE_NOT_FOUND);
+}
@@ -0,0 +1,426 @@
+/**
+ * Tests the JSON parser.
+ *
+ * The same document is parsed from a memory buffer, a regular file (which is read in chunks),
+ * a pipe and a socket (which are read a byte at a time), and the events must be the same each
+ * time.  The document is followed by a payload, which must still be there to be read from the fd
+ * once the document has been parsed.  Then a syntax error part way through a file's second chunk
+ * and a truncated buffer are checked.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#define NUM_ITEMS           300
+#define PADDING_BYTES       3600    // Puts the long string across the end of the first chunk.
+#define LONG_STRING_BYTES   1000
+#define ERROR_SEARCH_OFFSET 5000    // The syntax error goes at the next newline after this.
+
+static const char Payload[] = "PAYLOAD FOLLOWING THE DOCUMENT";
+
+static char Doc[32 * 1024];
+static size_t DocLen;
+static size_t ErrorOffset;
+
+/// Tally of the events received while parsing the document.
+static struct
+{
+    size_t count[LE_JSON_DOC_END + 1];
+    double numberSum;
+    size_t stringBytes;
+    bool inLongMember;
+    bool longStringFound;
+}
+Result;
+
+static int Fd = -1;                 // fd being parsed from (the read end for pipes and sockets).
+static le_json_ParsingSessionRef_t Session;
+
+static void NextTest(void* param1Ptr, void* param2Ptr);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds the test document: a long run of whitespace, a long string, then an array of objects
+ * with one value of each type.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BuildDoc
+(
+    void
+)
+{
+    int i;
+
+    DocLen = 0;
+    Doc[DocLen++] = '{';
+    memset(Doc + DocLen, ' ', PADDING_BYTES);
+    DocLen += PADDING_BYTES;
+
+    DocLen += snprintf(Doc + DocLen, sizeof(Doc) - DocLen, "\"long\":\"");
+    memset(Doc + DocLen, 'x', LONG_STRING_BYTES);
+    DocLen += LONG_STRING_BYTES;
+    DocLen += snprintf(Doc + DocLen, sizeof(Doc) - DocLen, "\",\n\"items\":[");
+
+    for (i = 0; i < NUM_ITEMS; i++)
+    {
+        DocLen += snprintf(Doc + DocLen, sizeof(Doc) - DocLen,
+                           "%s\n  {\"id\": %d, \"name\":\"item %d\", \"ok\":%s, \"none\":null}",
+                           (i == 0) ? "" : ",",
+                           i,
+                           i,
+                           (i % 2) ? "true" : "false");
+    }
+
+    DocLen += snprintf(Doc + DocLen, sizeof(Doc) - DocLen, "\n],\n\"neg\": -125.5\n}");
+    LE_ASSERT(DocLen < sizeof(Doc));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks the tally of events against the document built by BuildDoc().
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckResult
+(
+    void
+)
+{
+    size_t nameBytes = 0;
+    int i;
+
+    for (i = 0; i < NUM_ITEMS; i++)
+    {
+        char name[32];
+        nameBytes += snprintf(name, sizeof(name), "item %d", i);
+    }
+
+    LE_TEST(Result.count[LE_JSON_OBJECT_START] == NUM_ITEMS + 1);
+    LE_TEST(Result.count[LE_JSON_OBJECT_END] == NUM_ITEMS + 1);
+    LE_TEST(Result.count[LE_JSON_OBJECT_MEMBER] == (NUM_ITEMS * 4) + 3);
+    LE_TEST(Result.count[LE_JSON_ARRAY_START] == 1);
+    LE_TEST(Result.count[LE_JSON_ARRAY_END] == 1);
+    LE_TEST(Result.count[LE_JSON_STRING] == NUM_ITEMS + 1);
+    LE_TEST(Result.count[LE_JSON_NUMBER] == NUM_ITEMS + 1);
+    LE_TEST(Result.count[LE_JSON_TRUE] == NUM_ITEMS / 2);
+    LE_TEST(Result.count[LE_JSON_FALSE] == NUM_ITEMS / 2);
+    LE_TEST(Result.count[LE_JSON_NULL] == NUM_ITEMS);
+    LE_TEST(Result.count[LE_JSON_DOC_END] == 1);
+    LE_TEST(Result.numberSum == ((NUM_ITEMS * (NUM_ITEMS - 1)) / 2) - 125.5);
+    LE_TEST(Result.stringBytes == LONG_STRING_BYTES + nameBytes);
+    LE_TEST(Result.longStringFound);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks that the fd is left positioned right after the document, with the payload still to be
+ * read.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckPayload
+(
+    void
+)
+{
+    char buffer[sizeof(Payload)] = "";
+    ssize_t bytesRead;
+
+    LE_TEST(le_json_GetBytesRead(le_json_GetSession()) == DocLen);
+
+    do
+    {
+        bytesRead = read(Fd, buffer, sizeof(buffer) - 1);
+    }
+    while ((bytesRead == -1) && (errno == EINTR));
+
+    LE_TEST(bytesRead == sizeof(Payload) - 1);
+    LE_TEST(strcmp(buffer, Payload) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event handler used for all of the documents.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EventHandler
+(
+    le_json_Event_t event
+)
+{
+    const char* stringPtr;
+
+    Result.count[event]++;
+
+    switch (event)
+    {
+        case LE_JSON_OBJECT_MEMBER:
+
+            Result.inLongMember = (strcmp(le_json_GetString(), "long") == 0);
+            break;
+
+        case LE_JSON_STRING:
+
+            stringPtr = le_json_GetString();
+            Result.stringBytes += strlen(stringPtr);
+            if (Result.inLongMember)
+            {
+                Result.longStringFound = (strlen(stringPtr) == LONG_STRING_BYTES) &&
+                                         (strspn(stringPtr, "x") == LONG_STRING_BYTES);
+            }
+            break;
+
+        case LE_JSON_NUMBER:
+
+            Result.numberSum += le_json_GetNumber();
+            break;
+
+        case LE_JSON_DOC_END:
+
+            CheckResult();
+            if (Fd != -1)
+            {
+                CheckPayload();
+            }
+            le_event_QueueFunction(NextTest, NULL, NULL);
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Error handler for the documents that should parse cleanly.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnexpectedErrorHandler
+(
+    le_json_Error_t error,
+    const char* msg
+)
+{
+    LE_FATAL("Unexpected parsing error %d: %s", error, msg);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Error handler for the document with a syntax error in it.  Whatever hasn't been processed must
+ * have been handed back to the fd.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SyntaxErrorHandler
+(
+    le_json_Error_t error,
+    const char* msg
+)
+{
+    LE_INFO("Got expected error: %s", msg);
+
+    LE_TEST(error == LE_JSON_SYNTAX_ERROR);
+    LE_TEST(le_json_GetBytesRead(le_json_GetSession()) == ErrorOffset + 1);
+    LE_TEST(lseek(Fd, 0, SEEK_CUR) == ErrorOffset + 1);
+
+    le_event_QueueFunction(NextTest, NULL, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Error handler for the truncated document.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TruncatedErrorHandler
+(
+    le_json_Error_t error,
+    const char* msg
+)
+{
+    LE_INFO("Got expected error: %s", msg);
+
+    LE_TEST(error == LE_JSON_READ_ERROR);
+    LE_TEST(le_json_GetBytesRead(le_json_GetSession()) == DocLen / 2);
+
+    le_event_QueueFunction(NextTest, NULL, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes all of a block of data to an fd.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteAll
+(
+    int fd,
+    const char* dataPtr,
+    size_t len
+)
+{
+    while (len > 0)
+    {
+        ssize_t bytesWritten = write(fd, dataPtr, len);
+
+        LE_ASSERT(bytesWritten > 0);
+        dataPtr += bytesWritten;
+        len -= bytesWritten;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an unlinked temporary file holding a block of data, and rewinds it.
+ *
+ * @return The file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CreateFile
+(
+    const char* dataPtr,
+    size_t len
+)
+{
+    char path[] = "/tmp/jsonTestXXXXXX";
+    int fd = mkstemp(path);
+
+    LE_ASSERT(fd != -1);
+    unlink(path);
+
+    WriteAll(fd, dataPtr, len);
+    LE_ASSERT(lseek(fd, 0, SEEK_SET) == 0);
+
+    return fd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes the document followed by the payload into one end of a connected pair of fds, and closes
+ * it.  The other end is made non-blocking, as le_json_Parse() reads until there is nothing left.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FillPair
+(
+    int fds[2]
+)
+{
+    WriteAll(fds[1], Doc, DocLen);
+    WriteAll(fds[1], Payload, sizeof(Payload) - 1);
+    close(fds[1]);
+
+    LE_ASSERT(fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs the next test once the previous one has finished.
+ */
+//--------------------------------------------------------------------------------------------------
+static void NextTest
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    static int testNum = 0;
+    int fds[2];
+    char* dataPtr;
+
+    if (Session != NULL)
+    {
+        le_json_Cleanup(Session);
+        Session = NULL;
+    }
+    if (Fd != -1)
+    {
+        close(Fd);
+        Fd = -1;
+    }
+    memset(&Result, 0, sizeof(Result));
+
+    switch (testNum++)
+    {
+        case 0:
+
+            LE_INFO("Parsing from a buffer");
+            Session = le_json_ParseBuffer(Doc, DocLen, EventHandler, UnexpectedErrorHandler, NULL);
+            break;
+
+        case 1:
+
+            LE_INFO("Parsing from a regular file");
+            dataPtr = malloc(DocLen + sizeof(Payload));
+            LE_ASSERT(dataPtr != NULL);
+            memcpy(dataPtr, Doc, DocLen);
+            memcpy(dataPtr + DocLen, Payload, sizeof(Payload) - 1);
+            Fd = CreateFile(dataPtr, DocLen + sizeof(Payload) - 1);
+            free(dataPtr);
+            Session = le_json_Parse(Fd, EventHandler, UnexpectedErrorHandler, NULL);
+            break;
+
+        case 2:
+
+            LE_INFO("Parsing from a pipe");
+            LE_ASSERT(pipe(fds) == 0);
+            FillPair(fds);
+            Fd = fds[0];
+            Session = le_json_Parse(Fd, EventHandler, UnexpectedErrorHandler, NULL);
+            break;
+
+        case 3:
+
+            LE_INFO("Parsing from a socket");
+            LE_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+            FillPair(fds);
+            Fd = fds[0];
+            Session = le_json_Parse(Fd, EventHandler, UnexpectedErrorHandler, NULL);
+            break;
+
+        case 4:
+
+            LE_INFO("Parsing a file with a syntax error");
+            dataPtr = malloc(DocLen);
+            LE_ASSERT(dataPtr != NULL);
+            memcpy(dataPtr, Doc, DocLen);
+            dataPtr[ErrorOffset] = '#';
+            Fd = CreateFile(dataPtr, DocLen);
+            free(dataPtr);
+            Session = le_json_Parse(Fd, EventHandler, SyntaxErrorHandler, NULL);
+            break;
+
+        case 5:
+
+            LE_INFO("Parsing a truncated buffer");
+            Session = le_json_ParseBuffer(Doc, DocLen / 2, EventHandler, TruncatedErrorHandler,
+                                          NULL);
+            break;
+
+        default:
+
+            LE_INFO("======== JSON Test PASSED ========");
+            exit(EXIT_SUCCESS);
+    }
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("======== Start JSON Test ========");
+
+    BuildDoc();
+
+    // Newlines are only ever found between tokens.
+    char* newLinePtr = memchr(Doc + ERROR_SEARCH_OFFSET, '\n', DocLen - ERROR_SEARCH_OFFSET);
+    LE_ASSERT(newLinePtr != NULL);
+    ErrorOffset = newLinePtr - Doc;
+
+    NextTest(NULL, NULL);
+}
@@ -0,0 +1,387 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Automated unit test for the binary logging mode (LE_LOG_BINARY=1).
+ *
+ * The test runs itself twice as a child process, once in text mode and once in binary mode, with
+ * standard error going to a file.  The child logs:
+ *
+ *  - messages with a wide range of conversion specifications, including some that binary mode
+ *    can't capture and has to format right away,
+ *  - a string from a buffer that is changed as soon as the message has been logged, to check
+ *    that binary mode copies string arguments,
+ *  - enough messages of varying sizes to go around the thread's ring buffer many times, flushing
+ *    the ring regularly so that nothing is dropped,
+ *  - messages from two threads taking turns, which binary mode has to merge back from the two
+ *    threads' ring buffers in the order in which they were logged.
+ *
+ * The parent then checks that both modes output exactly the same messages, in the same order.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "logRing.h"
+#include <wchar.h>
+#include <semaphore.h>
+
+
+/// Environment variable that tells the program that it is running as the child.
+#define CHILD_ENV_VAR       "LE_LOG_RING_TEST_CHILD"
+
+/// Number of messages logged by LogFormats().
+#define FORMAT_MSG_COUNT    16
+
+/// Number of messages logged by LogWrapAround(), and how often it flushes the ring.
+#define WRAP_MSG_COUNT      1000
+#define WRAP_FLUSH_COUNT    40
+
+/// Number of messages logged by each of the threads started by LogInterleaved().
+#define TURN_MSG_COUNT      100
+
+/// Size of a string that is too long to fit in a log message.
+#define LONG_STR_BYTES      320
+
+/// Largest line read back from the output files.
+#define MAX_LINE_BYTES      1024
+
+/// Marks the lines that were logged by this component.
+#define LINE_MARKER         "/logRingTest T="
+
+
+static const char Filler[] = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/// Semaphores used by the threads started by LogInterleaved() to take turns.
+static sem_t TurnSems[2];
+
+
+// ==================================
+//  CHILD
+// ==================================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs messages with all sorts of formats.  Must log exactly FORMAT_MSG_COUNT messages.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void LogFormats
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* volatile nullStr = NULL;
+    char buffer[32];
+    char longStr[LONG_STR_BYTES];
+
+    LE_INFO("Integers: %d %i %u %ld %lld %hd %hhu %jd %zu %zd %td",
+            -1, 42, 4000000000u, -123456789L, -1234567890123LL, (short)-7, (unsigned char)200,
+            (intmax_t)-9, (size_t)12345, (ssize_t)-12345, (ptrdiff_t)-3);
+    LE_INFO("Hex and octal: %x %#X %08x %o %#o %llx", 0xbeef, 0xbeef, 0x1a, 8, 8, 0x123456789aULL);
+    LE_INFO("Floats: %f %.2f %10.3f %e %g %G %a", 1.5, -2.345, 3.14159, 12345.678, 0.0001,
+            1e20, 1.0);
+    LE_INFO("Long double: %Lf %.3Le", (long double)1.25, (long double)-6.5e10);
+    LE_INFO("Chars: %c%c%c %%", 'a', 'b', 'c');
+    LE_INFO("Widths: [%5d] [%-5d] [%*d] [%-*d] [%.*f] [%*.*s]",
+            1, 2, 6, 3, 6, 4, 2, 3.14159, 8, 3, "abcdef");
+    LE_INFO("Strings: '%s' '%.3s' '%10s' '%-10s' '%s'", "hello", "truncated", "right", "left", "");
+    LE_INFO("Null string: '%s'", nullStr);
+    LE_INFO("Pointer: %p %p", (void*)0x1234, NULL);
+    LE_INFO("Mixed: %s=%d, %s=%.1f, %s=%c", "a", 1, "b", 2.5, "c", 'z');
+
+    errno = EACCES;
+    LE_INFO("Errno: %m");
+
+    // Binary mode can't capture these, so it formats them right away.
+    LE_INFO("Wide string: %ls", L"wide");
+    LE_INFO("Positional: %2$s %1$s", "world", "hello");
+
+    // The string must be copied when the message is logged, not when it is output.
+    le_utf8_Copy(buffer, "before", sizeof(buffer), NULL);
+    LE_INFO("Copied: '%s'", buffer);
+    le_utf8_Copy(buffer, "after", sizeof(buffer), NULL);
+
+    // Messages that are too long get truncated the same way in both modes.
+    memset(longStr, 'x', sizeof(longStr) - 1);
+    longStr[sizeof(longStr) - 1] = '\0';
+    LE_INFO("Long: %s", longStr);
+    LE_INFO("Long too: %.*s%d", (int)sizeof(longStr) - 1, longStr, 1234);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs enough messages of varying sizes to go around the ring buffer many times.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void LogWrapAround
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int i;
+
+    for (i = 0; i < WRAP_MSG_COUNT; i++)
+    {
+        // The strings vary in length, so the records end at different places in the ring.
+        LE_INFO("Wrap %d: '%.*s' %s %d", i, i % (int)(sizeof(Filler) - 1), Filler,
+                Filler + (i % 7), i * 3);
+
+        if ((i % WRAP_FLUSH_COUNT) == (WRAP_FLUSH_COUNT - 1))
+        {
+            logRing_Flush();
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the threads started by LogInterleaved().  Logs a message each time it is this
+ * thread's turn, then hands the turn to the other thread.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void* TurnThreadMain
+(
+    void* contextPtr        ///< Index of this thread's turn semaphore.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t me = (size_t)contextPtr;
+    int i;
+
+    for (i = 0; i < TURN_MSG_COUNT; i++)
+    {
+        LE_ASSERT(sem_wait(&TurnSems[me]) == 0);
+        LE_INFO("Turn %d of thread %zu.", i, me);
+        LE_ASSERT(sem_post(&TurnSems[1 - me]) == 0);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs messages from two threads that take turns, so that the messages alternate between the two
+ * threads' ring buffers.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void LogInterleaved
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_thread_Ref_t threads[2];
+    size_t i;
+
+    for (i = 0; i < 2; i++)
+    {
+        LE_ASSERT(sem_init(&TurnSems[i], 0, 0) == 0);
+
+        threads[i] = le_thread_Create(i == 0 ? "Turn0" : "Turn1", TurnThreadMain, (void*)i);
+        le_thread_SetJoinable(threads[i]);
+        le_thread_Start(threads[i]);
+    }
+
+    LE_ASSERT(sem_post(&TurnSems[0]) == 0);
+
+    for (i = 0; i < 2; i++)
+    {
+        LE_ASSERT(le_thread_Join(threads[i], NULL) == LE_OK);
+    }
+}
+
+
+// ==================================
+//  PARENT
+// ==================================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs the test program as a child process, with its standard error going to a file.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void RunChild
+(
+    const char* binaryModeStr,  ///< Value for LE_LOG_BINARY.
+    const char* outputPath      ///< File to put the child's standard error in.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    pid_t pid = fork();
+    LE_FATAL_IF(pid < 0, "fork() failed (%m).");
+
+    if (pid == 0)
+    {
+        int fd = open(outputPath, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+
+        if ((fd < 0) || (dup2(fd, STDERR_FILENO) < 0))
+        {
+            _exit(EXIT_FAILURE);
+        }
+        close(fd);
+
+        setenv("LE_LOG_BINARY", binaryModeStr, 1);
+        setenv(CHILD_ENV_VAR, "1", 1);
+
+        execl("/proc/self/exe", "testFwLogRing", (char*)NULL);
+        _exit(EXIT_FAILURE);
+    }
+
+    int status;
+    pid_t result;
+
+    do
+    {
+        result = waitpid(pid, &status, 0);
+    }
+    while ((result < 0) && (errno == EINTR));
+
+    LE_TEST(result == pid);
+    LE_TEST(WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the next line logged by this component from a child's output, without the time stamp and the
+ * process ID.
+ *
+ * @return true if a line was read, false at the end of the file.
+ **/
+//--------------------------------------------------------------------------------------------------
+static bool ReadLine
+(
+    FILE* filePtr,
+    char* linePtr           ///< Buffer of MAX_LINE_BYTES bytes.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char rawLine[MAX_LINE_BYTES];
+
+    while (fgets(rawLine, sizeof(rawLine), filePtr) != NULL)
+    {
+        // "<time stamp> : <level> | <process>[<pid>]/<component> ..."
+        char* startPtr = strstr(rawLine, " : ");
+        char* pidPtr = strchr(rawLine, '[');
+        char* pidEndPtr = strchr(rawLine, ']');
+
+        if (   (startPtr == NULL) || (pidPtr == NULL) || (pidEndPtr == NULL)
+            || (pidPtr < startPtr) || (pidEndPtr < pidPtr) )
+        {
+            continue;
+        }
+
+        *pidPtr = '\0';
+        snprintf(linePtr, MAX_LINE_BYTES, "%s%s", startPtr + 3, pidEndPtr + 1);
+
+        if (strstr(linePtr, LINE_MARKER) != NULL)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compares the messages output in text mode and in binary mode.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void CompareOutputs
+(
+    const char* textPath,
+    const char* binaryPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char textLine[MAX_LINE_BYTES];
+    char binaryLine[MAX_LINE_BYTES];
+    char expectedLine[MAX_LINE_BYTES];
+    int lineCount = 0;
+    int diffCount = 0;
+    bool isCopiedFound = false;
+    bool isLastWrapFound = false;
+
+    FILE* textFilePtr = fopen(textPath, "r");
+    FILE* binaryFilePtr = fopen(binaryPath, "r");
+    LE_FATAL_IF((textFilePtr == NULL) || (binaryFilePtr == NULL), "Can't open outputs (%m).");
+
+    snprintf(expectedLine, sizeof(expectedLine), "Wrap %d: ", WRAP_MSG_COUNT - 1);
+
+    for (;;)
+    {
+        bool isTextLine = ReadLine(textFilePtr, textLine);
+        bool isBinaryLine = ReadLine(binaryFilePtr, binaryLine);
+
+        if (!isTextLine && !isBinaryLine)
+        {
+            break;
+        }
+
+        if (!isTextLine || !isBinaryLine || (strcmp(textLine, binaryLine) != 0))
+        {
+            LE_ERROR("Line %d differs.", lineCount);
+            LE_ERROR("  text:   %s", isTextLine ? textLine : "(none)");
+            LE_ERROR("  binary: %s", isBinaryLine ? binaryLine : "(none)");
+            diffCount++;
+        }
+
+        if (isBinaryLine)
+        {
+            isCopiedFound = isCopiedFound || (strstr(binaryLine, "| Copied: 'before'") != NULL);
+            isLastWrapFound = isLastWrapFound || (strstr(binaryLine, expectedLine) != NULL);
+        }
+
+        lineCount++;
+    }
+
+    fclose(textFilePtr);
+    fclose(binaryFilePtr);
+
+    LE_INFO("Compared %d lines.", lineCount);
+
+    LE_TEST(diffCount == 0);
+    LE_TEST(lineCount == FORMAT_MSG_COUNT + WRAP_MSG_COUNT + (2 * TURN_MSG_COUNT));
+    LE_TEST(isCopiedFound);
+    LE_TEST(isLastWrapFound);
+}
+
+
+COMPONENT_INIT
+{
+    if (getenv(CHILD_ENV_VAR) != NULL)
+    {
+        LogFormats();
+        LogWrapAround();
+        LogInterleaved();
+        exit(EXIT_SUCCESS);
+    }
+
+    LE_TEST_INIT;
+
+    LE_INFO("======= Binary logging test: text and binary mode outputs must match. ========");
+
+    char textPath[] = "/tmp/testFwLogRing-text-XXXXXX";
+    char binaryPath[] = "/tmp/testFwLogRing-binary-XXXXXX";
+    int textFd = mkstemp(textPath);
+    int binaryFd = mkstemp(binaryPath);
+    LE_FATAL_IF((textFd < 0) || (binaryFd < 0), "mkstemp() failed (%m).");
+    close(textFd);
+    close(binaryFd);
+
+    RunChild("0", textPath);
+    RunChild("1", binaryPath);
+
+    CompareOutputs(textPath, binaryPath);
+
+    unlink(textPath);
+    unlink(binaryPath);
+
+    LE_TEST_EXIT;
+}
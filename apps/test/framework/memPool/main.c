@@ -31,6 +31,9 @@ colourObj_t;
 #define FORCE_SIZE          3
 #define NUM_EXPAND_SUB_POOL 2
 #define NUM_ALLOC_SUPER_POOL    1
+#define THREAD_POOL_SIZE        64
+#define NUM_THREADS             4
+#define NUM_THREAD_ITERATIONS   10000
 
 static unsigned int NumRelease = 0;
 static unsigned int ReleaseId;
@@ -46,6 +49,69 @@ static void IdDestructor(void* objPtr)
 }
 
 
+static le_mem_PoolRef_t ThreadTestPool;
+static le_sem_Ref_t CachedSem;
+static le_sem_Ref_t ExitSem;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread that allocates and releases objects, leaving released blocks in its thread cache.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* AllocReleaseThread(void* contextPtr)
+{
+    idObj_t* objsPtr[THREAD_POOL_SIZE / NUM_THREADS];
+    unsigned int i, j;
+
+    for (i = 0; i < NUM_THREAD_ITERATIONS; i++)
+    {
+        size_t numObjs = (i % NUM_ARRAY_MEMBERS(objsPtr)) + 1;
+
+        for (j = 0; j < numObjs; j++)
+        {
+            objsPtr[j] = le_mem_AssertAlloc(ThreadTestPool);
+            objsPtr[j]->id = (uint32_t)(uintptr_t)contextPtr;
+        }
+
+        for (j = 0; j < numObjs; j++)
+        {
+            LE_ASSERT(objsPtr[j]->id == (uint32_t)(uintptr_t)contextPtr);
+            le_mem_Release(objsPtr[j]);
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread that allocates every block in the pool and releases them all, leaving some of them in its
+ * thread cache, then stays alive until it is told to exit.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* CacheAndWaitThread(void* contextPtr)
+{
+    idObj_t* objsPtr[THREAD_POOL_SIZE];
+    unsigned int i;
+
+    for (i = 0; i < THREAD_POOL_SIZE; i++)
+    {
+        objsPtr[i] = le_mem_AssertAlloc(ThreadTestPool);
+    }
+
+    for (i = 0; i < THREAD_POOL_SIZE; i++)
+    {
+        le_mem_Release(objsPtr[i]);
+    }
+
+    le_sem_Post(CachedSem);
+    le_sem_Wait(ExitSem);
+
+    return NULL;
+}
+
+
 COMPONENT_INIT
 {
     le_mem_PoolRef_t idPool, colourPool;
@@ -525,6 +591,124 @@ COMPONENT_INIT
     }
     printf("Successfully searched for pools by name.\n");
 #endif
+
+    //
+    // Allocate and release from multiple threads at once.
+    //
+    {
+        le_thread_Ref_t threads[NUM_THREADS];
+        idObj_t* objsPtr[THREAD_POOL_SIZE];
+
+        ThreadTestPool = le_mem_CreatePool("Thread Pool", sizeof(idObj_t));
+        le_mem_ExpandPool(ThreadTestPool, THREAD_POOL_SIZE);
+
+        for (i = 0; i < NUM_THREADS; i++)
+        {
+            threads[i] = le_thread_Create("memTest", AllocReleaseThread, (void*)(uintptr_t)i);
+            le_thread_SetJoinable(threads[i]);
+            le_thread_Start(threads[i]);
+        }
+
+        for (i = 0; i < NUM_THREADS; i++)
+        {
+            LE_ASSERT(le_thread_Join(threads[i], NULL) == LE_OK);
+        }
+
+        le_mem_GetStats(ThreadTestPool, &stats);
+        if ( (stats.numBlocksInUse != 0) ||
+             (stats.numFree != THREAD_POOL_SIZE) ||
+             (stats.numOverflows != 0) )
+        {
+            printf("Stats are incorrect after multi-threaded use: %d", __LINE__);
+            exit(EXIT_FAILURE);
+        }
+
+        // Every block must still be allocatable from this thread.
+        for (i = 0; i < THREAD_POOL_SIZE; i++)
+        {
+            objsPtr[i] = le_mem_TryAlloc(ThreadTestPool);
+
+            if (NULL == objsPtr[i])
+            {
+                printf("Allocation error: %d", __LINE__);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        if (le_mem_TryAlloc(ThreadTestPool) != NULL)
+        {
+            printf("Allocation error: %d", __LINE__);
+            exit(EXIT_FAILURE);
+        }
+
+        for (i = 0; i < THREAD_POOL_SIZE; i++)
+        {
+            le_mem_Release(objsPtr[i]);
+        }
+
+        le_mem_GetStats(ThreadTestPool, &stats);
+        if ( (stats.numBlocksInUse != 0) ||
+             (stats.numFree != THREAD_POOL_SIZE) ||
+             (stats.maxNumBlocksUsed != THREAD_POOL_SIZE) ||
+             (stats.numAllocs < NUM_THREADS * NUM_THREAD_ITERATIONS + THREAD_POOL_SIZE) )
+        {
+            printf("Stats are incorrect after multi-threaded use: %d", __LINE__);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("Allocated and released from multiple threads correctly.\n");
+
+    //
+    // Reclaim blocks from the cache of a thread that is still running.
+    //
+    {
+        idObj_t* objsPtr[THREAD_POOL_SIZE];
+
+        CachedSem = le_sem_Create("CachedSem", 0);
+        ExitSem = le_sem_Create("ExitSem", 0);
+
+        le_thread_Ref_t thread = le_thread_Create("memCache", CacheAndWaitThread, NULL);
+        le_thread_SetJoinable(thread);
+        le_thread_Start(thread);
+
+        le_sem_Wait(CachedSem);
+
+        // Every block must be allocatable from this thread while the other one is still alive.
+        for (i = 0; i < THREAD_POOL_SIZE; i++)
+        {
+            objsPtr[i] = le_mem_TryAlloc(ThreadTestPool);
+
+            if (NULL == objsPtr[i])
+            {
+                printf("Blocks weren't reclaimed from a live thread's cache: %d", __LINE__);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        le_sem_Post(ExitSem);
+        LE_ASSERT(le_thread_Join(thread, NULL) == LE_OK);
+
+        for (i = 0; i < THREAD_POOL_SIZE; i++)
+        {
+            le_mem_Release(objsPtr[i]);
+        }
+
+        le_mem_GetStats(ThreadTestPool, &stats);
+        if ( (stats.numBlocksInUse != 0) ||
+             (stats.numFree != THREAD_POOL_SIZE) ||
+             (stats.numOverflows != 0) )
+        {
+            printf("Stats are incorrect after reclaiming cached blocks: %d", __LINE__);
+            exit(EXIT_FAILURE);
+        }
+
+        le_sem_Delete(CachedSem);
+        le_sem_Delete(ExitSem);
+    }
+
+    printf("Reclaimed blocks from a live thread's cache correctly.\n");
+
     printf("*** Unit Test for le_mem module passed. ***\n");
     printf("\n");
     exit(EXIT_SUCCESS);
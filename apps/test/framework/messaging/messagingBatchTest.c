@@ -0,0 +1,247 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Automated unit test for batched receiving in the Low-Level Messaging APIs.
+ *
+ * - Create a server thread and a client thread in the same process.
+ * - The client sends a message that holds the server thread up, then a flood of messages, so that
+ *   the server finds them all waiting on its socket when it gets going again.  The server receives
+ *   them in batches of increasing size, ending with a batch that is cut short when the socket
+ *   runs dry part way through.
+ * - Every other message only sends the start of its payload.  The server checks that the rest of
+ *   the payload reads as zeros, even though the Message objects are reused.
+ * - This is done a few times over, so later rounds receive into recycled Message objects.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+
+#define SERVICE_INSTANCE_NAME "BatchTest"
+#define PROTOCOL_ID_STR "BatchTestProtocol"
+
+#define NUM_ROUNDS      3
+#define NUM_DATA_MSGS   37  // First round: batches of 2, 4, 8 and 16, then a partial batch of 7.
+#define FILL_BYTES      200
+
+
+typedef enum
+{
+    MSG_HOLD,   ///< Server waits until the client releases it.
+    MSG_DATA,   ///< Data message to check.
+    MSG_DONE,   ///< Request for the number of data messages received so far.
+}
+MsgKind_t;
+
+typedef struct
+{
+    uint32_t kind;
+    uint32_t seq;
+    uint8_t  fill[FILL_BYTES];  ///< All set to the low byte of seq, if sent.
+}
+BatchMsg_t;
+
+/// Size of the start of the payload sent by short messages.
+#define SHORT_PAYLOAD_SIZE  offsetof(BatchMsg_t, fill)
+
+
+static le_sem_Ref_t HoldSem;        ///< Posted by the client to let the server carry on.
+static le_sem_Ref_t ServerReadySem; ///< Posted by the server once it has advertised the service.
+
+
+// ==================================
+//  SERVER
+// ==================================
+
+static uint32_t ReceivedCount = 0;  ///< Number of data messages received.
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks a data message.  They must arrive in order, and what wasn't sent must be zero.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void CheckDataMsg
+(
+    const BatchMsg_t* msgPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint8_t expectedFill = ((msgPtr->seq % 2) == 0) ? (uint8_t)msgPtr->seq : 0;
+    size_t i;
+
+    LE_FATAL_IF(msgPtr->seq != ReceivedCount,
+                "Received message %u, expected %u.",
+                msgPtr->seq,
+                ReceivedCount);
+
+    for (i = 0; i < FILL_BYTES; i++)
+    {
+        LE_FATAL_IF(msgPtr->fill[i] != expectedFill,
+                    "Message %u byte %zu is 0x%x, expected 0x%x.",
+                    msgPtr->seq,
+                    i,
+                    msgPtr->fill[i],
+                    expectedFill);
+    }
+
+    ReceivedCount++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handles messages received by the server.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ServerRecvHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void*               contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    BatchMsg_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+
+    switch (msgPtr->kind)
+    {
+        case MSG_HOLD:
+
+            le_msg_ReleaseMsg(msgRef);
+            le_sem_Wait(HoldSem);
+            break;
+
+        case MSG_DATA:
+
+            CheckDataMsg(msgPtr);
+            le_msg_ReleaseMsg(msgRef);
+            break;
+
+        case MSG_DONE:
+
+            msgPtr->seq = ReceivedCount;
+            le_msg_Respond(msgRef);
+            break;
+
+        default:
+
+            LE_FATAL("Unexpected message kind %u.", msgPtr->kind);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function for the server thread.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void* ServerThreadMain
+(
+    void* opaqueContextPtr  ///< not used
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, sizeof(BatchMsg_t));
+    le_msg_ServiceRef_t serviceRef = le_msg_CreateService(protocolRef, SERVICE_INSTANCE_NAME);
+
+    le_msg_SetServiceRecvHandler(serviceRef, ServerRecvHandler, NULL);
+    le_msg_AdvertiseService(serviceRef);
+
+    le_sem_Post(ServerReadySem);
+
+    le_event_RunLoop();
+}
+
+
+// ==================================
+//  CLIENT
+// ==================================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a message of a given kind.  Data messages with odd sequence numbers only send the start of
+ * their payload.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void SendMsg
+(
+    le_msg_SessionRef_t sessionRef,
+    MsgKind_t           kind,
+    uint32_t            seq
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+    BatchMsg_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+
+    msgPtr->kind = kind;
+    msgPtr->seq = seq;
+
+    if ((kind == MSG_DATA) && ((seq % 2) == 1))
+    {
+        // Leave something in the fill, to make sure it doesn't get sent.
+        memset(msgPtr->fill, 0xFF, FILL_BYTES);
+        le_msg_SetPayloadSize(msgRef, SHORT_PAYLOAD_SIZE);
+    }
+    else
+    {
+        memset(msgPtr->fill, (uint8_t)seq, FILL_BYTES);
+    }
+
+    le_msg_Send(msgRef);
+}
+
+
+// Component initialization function.
+COMPONENT_INIT
+{
+    LE_INFO("======= Messaging Batch Test: flood of messages received in batches ========");
+
+    system("testFwMessaging-Setup");
+
+    HoldSem = le_sem_Create("HoldSem", 0);
+    ServerReadySem = le_sem_Create("ServerReadySem", 0);
+
+    le_thread_Start(le_thread_Create("BatchTestServer", ServerThreadMain, NULL));
+    le_sem_Wait(ServerReadySem);
+
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, sizeof(BatchMsg_t));
+    le_msg_SessionRef_t sessionRef = le_msg_CreateSession(protocolRef, SERVICE_INSTANCE_NAME);
+    le_msg_OpenSessionSync(sessionRef);
+
+    uint32_t seq = 0;
+    int round;
+
+    for (round = 0; round < NUM_ROUNDS; round++)
+    {
+        int i;
+
+        // Hold the server up while the flood is sent, so it is all waiting when the server
+        // gets going again.
+        SendMsg(sessionRef, MSG_HOLD, 0);
+
+        for (i = 0; i < NUM_DATA_MSGS; i++)
+        {
+            SendMsg(sessionRef, MSG_DATA, seq);
+            seq++;
+        }
+
+        le_sem_Post(HoldSem);
+
+        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+        ((BatchMsg_t*)le_msg_GetPayloadPtr(msgRef))->kind = MSG_DONE;
+        msgRef = le_msg_RequestSyncResponse(msgRef);
+        LE_FATAL_IF(msgRef == NULL, "Transaction failed!");
+
+        uint32_t receivedCount = ((BatchMsg_t*)le_msg_GetPayloadPtr(msgRef))->seq;
+        LE_INFO("Round %d: server received %u messages.", round, receivedCount);
+        LE_TEST(receivedCount == seq);
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    le_msg_CloseSession(sessionRef);
+
+    LE_TEST_SUMMARY
+}
@@ -0,0 +1,224 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Benchmark for the Low-Level Messaging API's shared memory transport.
+ *
+ *  - Create a server thread that answers each request with the size of the request's payload.
+ *  - Open one session that sends everything through the socket and one that has the shared memory
+ *    transport enabled (see LE_MSG_SHM_THRESHOLD).
+ *  - Time synchronous request-response transactions with 1 KB to 64 KB request payloads on
+ *    each session and log the throughput of both.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+
+#define SERVICE_INSTANCE_NAME "ShmBenchmark"
+
+#define PROTOCOL_ID_STR "ShmBenchmarkProtocol"
+
+/// Largest request payload.
+#define MAX_PAYLOAD_SIZE (64 * 1024)
+
+/// Smallest request payload.
+#define MIN_PAYLOAD_SIZE 1024
+
+/// Number of payload bytes to send for each payload size and transport.
+#define BYTES_PER_RUN (32 * 1024 * 1024)
+
+/// Threshold given to the shared memory session (see LE_MSG_SHM_THRESHOLD).
+#define SHM_THRESHOLD_STR "1024"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of every request payload.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t size;      ///< Number of payload bytes in the request (header included).
+    uint32_t seq;       ///< Sequence number, also written in the last byte of the payload.
+}
+RequestHeader_t;
+
+
+// ==================================
+//  SERVER
+// ==================================
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receives requests from the client and responds with the request size, once it has checked that
+ * the whole payload arrived.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ServerRecvHandler
+(
+    le_msg_MessageRef_t msgRef,     ///< Reference to the received message.
+    void*               contextPtr  ///< Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint8_t* payloadPtr = le_msg_GetPayloadPtr(msgRef);
+    RequestHeader_t header;
+
+    memcpy(&header, payloadPtr, sizeof(header));
+
+    if ((header.size < sizeof(header))
+        || (header.size > MAX_PAYLOAD_SIZE)
+        || (payloadPtr[header.size - 1] != (uint8_t)header.seq))
+    {
+        header.size = 0;
+    }
+
+    memcpy(payloadPtr, &header.size, sizeof(header.size));
+    le_msg_SetPayloadSize(msgRef, sizeof(header.size));
+
+    le_msg_Respond(msgRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function for the server thread.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void* ServerThreadMain
+(
+    void* opaqueContextPtr  ///< not used
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, MAX_PAYLOAD_SIZE);
+    le_msg_ServiceRef_t serviceRef = le_msg_CreateService(protocolRef, SERVICE_INSTANCE_NAME);
+
+    le_msg_SetServiceRecvHandler(serviceRef, ServerRecvHandler, NULL);
+    le_msg_AdvertiseService(serviceRef);
+
+    le_event_RunLoop();
+}
+
+
+// ==================================
+//  CLIENT
+// ==================================
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens a session with the server.
+ *
+ * @return The session reference.
+ **/
+//--------------------------------------------------------------------------------------------------
+static le_msg_SessionRef_t OpenSession
+(
+    const char* thresholdStr    ///< Value for LE_MSG_SHM_THRESHOLD (NULL = don't use shared memory)
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The shared memory transport is set up when the session opens, according to the environment
+    // variable at that time.
+    if (thresholdStr != NULL)
+    {
+        LE_ASSERT(setenv("LE_MSG_SHM_THRESHOLD", thresholdStr, 1) == 0);
+    }
+    else
+    {
+        LE_ASSERT(unsetenv("LE_MSG_SHM_THRESHOLD") == 0);
+    }
+
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(PROTOCOL_ID_STR, MAX_PAYLOAD_SIZE);
+    le_msg_SessionRef_t sessionRef = le_msg_CreateSession(protocolRef, SERVICE_INSTANCE_NAME);
+
+    le_msg_OpenSessionSync(sessionRef);
+
+    return sessionRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends BYTES_PER_RUN bytes to the server in requests of a given size.
+ *
+ * @return The throughput, in MB/s.
+ **/
+//--------------------------------------------------------------------------------------------------
+static double RunBenchmark
+(
+    le_msg_SessionRef_t sessionRef,
+    size_t              payloadSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count = BYTES_PER_RUN / payloadSize;
+    size_t errorCount = 0;
+    size_t i;
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < count; i++)
+    {
+        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+        uint8_t* payloadPtr = le_msg_GetPayloadPtr(msgRef);
+        RequestHeader_t header = { .size = payloadSize, .seq = i };
+
+        memcpy(payloadPtr, &header, sizeof(header));
+        payloadPtr[payloadSize - 1] = (uint8_t)i;
+        le_msg_SetPayloadSize(msgRef, payloadSize);
+
+        msgRef = le_msg_RequestSyncResponse(msgRef);
+        LE_FATAL_IF(msgRef == NULL, "Transaction failed!");
+
+        uint32_t echoedSize;
+        memcpy(&echoedSize, le_msg_GetPayloadPtr(msgRef), sizeof(echoedSize));
+        if (echoedSize != payloadSize)
+        {
+            errorCount++;
+        }
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    LE_TEST(errorCount == 0);
+
+    double seconds = elapsed.sec + (elapsed.usec / 1000000.0);
+
+    return (count * payloadSize) / (seconds * 1024 * 1024);
+}
+
+
+// Component initialization function.
+COMPONENT_INIT
+{
+    LE_INFO("======= Shared memory transport benchmark ========");
+
+    system("testFwMessaging-Setup");
+
+    le_thread_Start(le_thread_Create("ShmBenchServer", ServerThreadMain, NULL));
+
+    le_msg_SessionRef_t socketSessionRef = OpenSession(NULL);
+    le_msg_SessionRef_t shmSessionRef = OpenSession(SHM_THRESHOLD_STR);
+
+    LE_INFO("%10s %14s %14s", "payload", "socket MB/s", "shm MB/s");
+
+    size_t payloadSize;
+    for (payloadSize = MIN_PAYLOAD_SIZE; payloadSize <= MAX_PAYLOAD_SIZE; payloadSize *= 2)
+    {
+        double socketRate = RunBenchmark(socketSessionRef, payloadSize);
+        double shmRate = RunBenchmark(shmSessionRef, payloadSize);
+
+        LE_INFO("%8zuKB %14.1f %14.1f", payloadSize / 1024, socketRate, shmRate);
+    }
+
+    le_msg_CloseSession(socketSessionRef);
+    le_msg_CloseSession(shmSessionRef);
+
+    LE_TEST_SUMMARY
+}
@@ -0,0 +1,179 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client for the shared memory setup test of the Low-Level Messaging APIs.
+ *
+ * 1. Client enables the shared memory transport and opens a session, offering shared memory.
+ * 2. Server accepts it.  Client checks that requests and responses are correct and that the
+ *    shared memory is mapped.
+ * 3. Client asks the server to limit its address space.
+ * 4. Client opens a second session, offering new shared memory.  The server fails to map it and
+ *    refuses it.
+ * 5. Client checks that requests and responses on the second session are still correct and that
+ *    the refused shared memory has been let go of.
+ * 6. Client checks that the first session still works, tells the server to quit and checks that
+ *    closing the first session lets go of its shared memory.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "messagingShmTest.h"
+
+
+#define ECHO_COUNT  20
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts the messaging shared memory mappings in this process.
+ **/
+//--------------------------------------------------------------------------------------------------
+static int CountShmMappings
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char line[512];
+    int count = 0;
+
+    FILE* filePtr = fopen("/proc/self/maps", "r");
+    LE_FATAL_IF(filePtr == NULL, "Failed to open /proc/self/maps (%m).");
+
+    while (fgets(line, sizeof(line), filePtr) != NULL)
+    {
+        if (strstr(line, "/memfd:le_msg") != NULL)
+        {
+            count++;
+        }
+    }
+
+    fclose(filePtr);
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a request of a given kind and waits for the response.
+ **/
+//--------------------------------------------------------------------------------------------------
+static le_msg_MessageRef_t Request
+(
+    le_msg_SessionRef_t sessionRef,
+    ShmTestKind_t       kind,
+    uint8_t             fill
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionRef);
+    ShmTestMsg_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+
+    msgPtr->kind = kind;
+    memset(msgPtr->data, fill, SHM_TEST_DATA_SIZE);
+    le_msg_SetPayloadSize(msgRef, offsetof(ShmTestMsg_t, data) + SHM_TEST_DATA_SIZE);
+
+    msgRef = le_msg_RequestSyncResponse(msgRef);
+    LE_FATAL_IF(msgRef == NULL, "Transaction failed!");
+
+    return msgRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends echo requests and checks the responses.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void CheckEchoes
+(
+    le_msg_SessionRef_t sessionRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int i;
+    int badCount = 0;
+
+    for (i = 0; i < ECHO_COUNT; i++)
+    {
+        le_msg_MessageRef_t msgRef = Request(sessionRef, SHM_TEST_ECHO, (uint8_t)i);
+        ShmTestMsg_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+        size_t j;
+
+        for (j = 0; j < SHM_TEST_DATA_SIZE; j++)
+        {
+            if (msgPtr->data[j] != (uint8_t)(i + 1))
+            {
+                badCount++;
+                break;
+            }
+        }
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    LE_TEST(badCount == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens a session to the server.
+ **/
+//--------------------------------------------------------------------------------------------------
+static le_msg_SessionRef_t OpenSession
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(SHM_TEST_PROTOCOL_ID,
+                                                             sizeof(ShmTestMsg_t));
+    le_msg_SessionRef_t sessionRef = le_msg_CreateSession(protocolRef, SHM_TEST_SERVICE_NAME);
+
+    le_msg_OpenSessionSync(sessionRef);
+
+    return sessionRef;
+}
+
+
+COMPONENT_INIT
+{
+    LE_TEST_INIT;
+
+    LE_FATAL_IF(setenv("LE_MSG_SHM_THRESHOLD", SHM_TEST_THRESHOLD_STR, 1) != 0,
+                "Failed to set LE_MSG_SHM_THRESHOLD (%m).");
+
+    // First session: the server accepts the shared memory.
+    le_msg_SessionRef_t firstSessionRef = OpenSession();
+
+    CheckEchoes(firstSessionRef);
+    LE_TEST(CountShmMappings() == 1);
+
+    le_msg_ReleaseMsg(Request(firstSessionRef, SHM_TEST_LIMIT, 0));
+
+    // Second session: the server can't map the shared memory, so it refuses it.  The first
+    // response can only come after the refusal, so the client has let go of the memory by then.
+    // The first session stays open, so the server can't get the address space back from it.
+    le_msg_SessionRef_t secondSessionRef = OpenSession();
+
+    CheckEchoes(secondSessionRef);
+    LE_TEST(CountShmMappings() == 1);
+
+    le_msg_CloseSession(secondSessionRef);
+
+    // The first session must still be working through its shared memory.
+    CheckEchoes(firstSessionRef);
+
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(firstSessionRef);
+    ((ShmTestMsg_t*)le_msg_GetPayloadPtr(msgRef))->kind = SHM_TEST_QUIT;
+    le_msg_SetPayloadSize(msgRef, offsetof(ShmTestMsg_t, data));
+    le_msg_Send(msgRef);
+    le_msg_CloseSession(firstSessionRef);
+
+    LE_TEST(CountShmMappings() == 0);
+
+    LE_TEST_EXIT;
+}
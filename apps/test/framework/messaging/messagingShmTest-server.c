@@ -0,0 +1,99 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Server for the shared memory setup test of the Low-Level Messaging APIs.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "messagingShmTest.h"
+
+// NOTE: See messagingShmTest-client.c for a description of the test.
+
+
+/// Address space left for the server to use once it has been limited.  Less than a ring pair.
+#define ADDRESS_SPACE_SLACK (4 * 1024 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Limits the process's address space to a little more than it uses now, so the next shared memory
+ * ring pair can't be mapped.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void LimitAddressSpace
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    unsigned long pageCount = 0;
+
+    FILE* filePtr = fopen("/proc/self/statm", "r");
+    LE_FATAL_IF(filePtr == NULL, "Failed to open /proc/self/statm (%m).");
+    LE_FATAL_IF(fscanf(filePtr, "%lu", &pageCount) != 1, "Failed to read /proc/self/statm.");
+    fclose(filePtr);
+
+    struct rlimit limit;
+    limit.rlim_cur = pageCount * sysconf(_SC_PAGESIZE) + ADDRESS_SPACE_SLACK;
+    limit.rlim_max = RLIM_INFINITY;
+
+    LE_INFO("Limiting address space to %lu bytes.", (unsigned long)limit.rlim_cur);
+    LE_FATAL_IF(setrlimit(RLIMIT_AS, &limit) != 0, "Failed to limit address space (%m).");
+}
+
+
+static void MessageReceiveHandler
+(
+    le_msg_MessageRef_t msgRef,
+    void* ignored
+)
+{
+    ShmTestMsg_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+    size_t i;
+
+    switch (msgPtr->kind)
+    {
+        case SHM_TEST_ECHO:
+
+            for (i = 0; i < SHM_TEST_DATA_SIZE; i++)
+            {
+                msgPtr->data[i]++;
+            }
+            le_msg_SetPayloadSize(msgRef, offsetof(ShmTestMsg_t, data) + SHM_TEST_DATA_SIZE);
+            le_msg_Respond(msgRef);
+            break;
+
+        case SHM_TEST_LIMIT:
+
+            LimitAddressSpace();
+            le_msg_SetPayloadSize(msgRef, offsetof(ShmTestMsg_t, data));
+            le_msg_Respond(msgRef);
+            break;
+
+        case SHM_TEST_QUIT:
+
+            LE_INFO("Client told me to quit.");
+            le_msg_ReleaseMsg(msgRef);
+            LE_TEST_EXIT;
+            break;
+
+        default:
+
+            LE_FATAL("Unexpected message kind %u.", msgPtr->kind);
+    }
+}
+
+
+COMPONENT_INIT
+{
+    LE_TEST_INIT;
+
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(SHM_TEST_PROTOCOL_ID,
+                                                             sizeof(ShmTestMsg_t));
+    le_msg_ServiceRef_t serviceRef = le_msg_CreateService(protocolRef, SHM_TEST_SERVICE_NAME);
+
+    le_msg_SetServiceRecvHandler(serviceRef, MessageReceiveHandler, NULL);
+    le_msg_AdvertiseService(serviceRef);
+}
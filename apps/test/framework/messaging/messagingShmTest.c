@@ -0,0 +1,33 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unit test for the shared memory setup of the Low-Level Messaging APIs.
+ *
+ *  - Server and Client in different processes, with the shared memory transport enabled in the
+ *    client.
+ *  - The first session gets the shared memory accepted by the server and uses it.
+ *  - The server then makes sure it can't map any more shared memory, so the second session's
+ *    shared memory is refused.  The client must not use it, and everything must still work over
+ *    the socket.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+COMPONENT_INIT
+{
+    LE_TEST_INIT;
+
+    LE_INFO("======= Shared memory setup test: accepted, then refused by the server. ========");
+
+    system("testFwMessaging-Setup");
+
+    le_test_ChildRef_t server = LE_TEST_FORK("testFwMessaging-Shm-server");
+    le_test_ChildRef_t client = LE_TEST_FORK("testFwMessaging-Shm-client");
+
+    LE_TEST_JOIN(client);
+    LE_TEST_JOIN(server);
+
+    LE_TEST_EXIT;
+}
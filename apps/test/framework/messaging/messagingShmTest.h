@@ -0,0 +1,39 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Definitions shared by the client and server of the shared memory setup test.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef MESSAGING_SHM_TEST_H_INCLUDE_GUARD
+#define MESSAGING_SHM_TEST_H_INCLUDE_GUARD
+
+#define SHM_TEST_SERVICE_NAME   "ShmTest"
+#define SHM_TEST_PROTOCOL_ID    "ShmTestProtocol"
+
+/// Big enough to get a shared memory ring pair of several megabytes.
+#define SHM_TEST_PAYLOAD_SIZE   (512 * 1024)
+
+/// Number of data bytes actually sent, which is small enough to go through the socket too.
+#define SHM_TEST_DATA_SIZE      (32 * 1024)
+
+/// Messages at least this big go through the shared memory, when the session is using it.
+#define SHM_TEST_THRESHOLD_STR  "1024"
+
+typedef enum
+{
+    SHM_TEST_ECHO,      ///< Server sends the message back with every data byte incremented.
+    SHM_TEST_LIMIT,     ///< Server limits its address space, so it can't map any more rings.
+    SHM_TEST_QUIT,      ///< Server exits.
+}
+ShmTestKind_t;
+
+typedef struct
+{
+    uint32_t kind;
+    uint8_t  data[SHM_TEST_PAYLOAD_SIZE - sizeof(uint32_t)];
+}
+ShmTestMsg_t;
+
+#endif // MESSAGING_SHM_TEST_H_INCLUDE_GUARD
@@ -123,6 +123,198 @@ static void TestString(void)
     CheckString(notNullTerm, 512, NUM_ARRAY_MEMBERS(notNullTerm), false);
 }
 
+/** Store/Load **/
+
+#define SAMPLE_MAX_COUNT 32
+#define TIMING_LOOPS 100000
+
+// Pack a message with the pack functions.  Returns the number of bytes packed.
+static size_t PackMessage
+(
+    uint8_t* buffer,
+    int16_t i16,
+    bool flag,
+    double value,
+    void* ref,
+    const int32_t* samplesPtr,
+    size_t samplesCount
+)
+{
+    uint8_t* bufferPtr = buffer;
+    size_t bufferSz = BUFFER_SZ;
+    bool result;
+
+    LE_ASSERT(le_pack_PackInt16(&bufferPtr, &bufferSz, i16));
+    LE_ASSERT(le_pack_PackBool(&bufferPtr, &bufferSz, flag));
+    LE_ASSERT(le_pack_PackDouble(&bufferPtr, &bufferSz, value));
+    LE_ASSERT(le_pack_PackReference(&bufferPtr, &bufferSz, ref));
+    LE_PACK_PACKARRAY(&bufferPtr, &bufferSz, samplesPtr, samplesCount, SAMPLE_MAX_COUNT,
+                      le_pack_PackInt32, &result);
+    LE_ASSERT(result);
+
+    return bufferPtr - buffer;
+}
+
+// Store the same message with the store functions.  Returns the number of bytes stored.
+static size_t StoreMessage
+(
+    uint8_t* buffer,
+    int16_t i16,
+    bool flag,
+    double value,
+    void* ref,
+    const int32_t* samplesPtr,
+    size_t samplesCount
+)
+{
+    uint8_t* bufferPtr = buffer;
+
+    LE_PACK_STORE(&bufferPtr, int16_t, i16);
+    LE_PACK_STORE(&bufferPtr, uint8_t, flag);
+    LE_PACK_STORE(&bufferPtr, double, value);
+    LE_ASSERT(le_pack_StoreReference(&bufferPtr, ref));
+    LE_ASSERT(le_pack_StoreArray(&bufferPtr, samplesPtr, sizeof(int32_t),
+                                 samplesCount, SAMPLE_MAX_COUNT));
+
+    return bufferPtr - buffer;
+}
+
+static void CheckStoreLoad
+(
+    size_t samplesCount
+)
+{
+    uint8_t packed[BUFFER_SZ];
+    uint8_t stored[BUFFER_SZ];
+    int32_t samples[SAMPLE_MAX_COUNT];
+    size_t i;
+
+    for (i = 0; i < samplesCount; i++)
+    {
+        samples[i] = (int32_t)(i * 100003) - 50;
+    }
+
+    ResetBuffer(packed, sizeof(packed));
+    ResetBuffer(stored, sizeof(stored));
+
+    printf("- %zu samples\n", samplesCount);
+
+    // Both must produce exactly the same message
+    size_t packedSz = PackMessage(packed, -1234, true, 2.5, (void*)0x1235,
+                                  samples, samplesCount);
+    size_t storedSz = StoreMessage(stored, -1234, true, 2.5, (void*)0x1235,
+                                   samples, samplesCount);
+    LE_TEST(packedSz == storedSz);
+    LE_TEST(0 == memcmp(packed, stored, sizeof(packed)));
+
+    // Load what was packed
+    uint8_t* bufferPtr = packed;
+    int16_t i16;
+    bool flag;
+    double value;
+    void* ref;
+    int32_t samplesOut[SAMPLE_MAX_COUNT];
+    size_t samplesOutCount;
+
+    LE_PACK_LOAD(&bufferPtr, int16_t, &i16);
+    LE_PACK_LOAD(&bufferPtr, uint8_t, &flag);
+    LE_PACK_LOAD(&bufferPtr, double, &value);
+    LE_TEST(le_pack_LoadReference(&bufferPtr, &ref));
+    LE_TEST(le_pack_LoadArray(&bufferPtr, samplesOut, sizeof(int32_t),
+                              &samplesOutCount, SAMPLE_MAX_COUNT));
+    LE_TEST(bufferPtr - packed == packedSz);
+
+    LE_TEST(i16 == -1234);
+    LE_TEST(flag == true);
+    LE_TEST(value == 2.5);
+    LE_TEST(ref == (void*)0x1235);
+    LE_TEST(samplesOutCount == samplesCount);
+    LE_TEST(0 == memcmp(samples, samplesOut, samplesCount * sizeof(int32_t)));
+
+    printf("   [passed]\n");
+}
+
+static void TestStoreLoad(void)
+{
+    uint8_t buffer[BUFFER_SZ];
+    uint8_t* bufferPtr;
+    int32_t samples[SAMPLE_MAX_COUNT] = { 0 };
+    size_t samplesCount;
+    void* ref;
+
+    printf("=> store/load\n");
+
+    CheckStoreLoad(0);
+    CheckStoreLoad(1);
+    CheckStoreLoad(SAMPLE_MAX_COUNT);
+
+    // Only safe references (or NULL) can be stored or loaded
+    bufferPtr = buffer;
+    LE_TEST(!le_pack_StoreReference(&bufferPtr, (void*)0x1234));
+    LE_TEST(bufferPtr == buffer);
+    LE_TEST(le_pack_StoreReference(&bufferPtr, NULL));
+    LE_PACK_STORE(&bufferPtr, uint32_t, 0x1234);
+    bufferPtr = buffer;
+    LE_TEST(le_pack_LoadReference(&bufferPtr, &ref));
+    LE_TEST(ref == NULL);
+    LE_TEST(!le_pack_LoadReference(&bufferPtr, &ref));
+
+    // Arrays can't have more than their maximum number of elements
+    bufferPtr = buffer;
+    LE_TEST(!le_pack_StoreArray(&bufferPtr, samples, sizeof(int32_t), SAMPLE_MAX_COUNT + 1,
+                                SAMPLE_MAX_COUNT));
+    LE_TEST(bufferPtr == buffer);
+    LE_PACK_STORE(&bufferPtr, uint32_t, SAMPLE_MAX_COUNT + 1);
+    bufferPtr = buffer;
+    LE_TEST(!le_pack_LoadArray(&bufferPtr, samples, sizeof(int32_t), &samplesCount,
+                               SAMPLE_MAX_COUNT));
+
+    // Only an empty array can be loaded without an output buffer
+    bufferPtr = buffer;
+    LE_TEST(le_pack_StoreArray(&bufferPtr, samples, sizeof(int32_t), 1, SAMPLE_MAX_COUNT));
+    bufferPtr = buffer;
+    LE_TEST(!le_pack_LoadArray(&bufferPtr, NULL, sizeof(int32_t), &samplesCount,
+                               SAMPLE_MAX_COUNT));
+    bufferPtr = buffer;
+    LE_TEST(le_pack_StoreArray(&bufferPtr, NULL, sizeof(int32_t), 0, SAMPLE_MAX_COUNT));
+    bufferPtr = buffer;
+    LE_TEST(le_pack_LoadArray(&bufferPtr, NULL, sizeof(int32_t), &samplesCount,
+                              SAMPLE_MAX_COUNT));
+    LE_TEST(samplesCount == 0);
+}
+
+static void TimePackStore(void)
+{
+    static uint8_t buffer[BUFFER_SZ];
+    int32_t samples[SAMPLE_MAX_COUNT] = { 0 };
+    le_clk_Time_t startTime;
+    le_clk_Time_t packTime;
+    le_clk_Time_t storeTime;
+    int i;
+
+    printf("=> pack vs. store timing\n");
+
+    // Not a pass/fail test, as timings depend on the target; the results are just reported.
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < TIMING_LOOPS; i++)
+    {
+        PackMessage(buffer, i, i & 1, i, (void*)0x1235, samples, SAMPLE_MAX_COUNT);
+    }
+    packTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < TIMING_LOOPS; i++)
+    {
+        StoreMessage(buffer, i, i & 1, i, (void*)0x1235, samples, SAMPLE_MAX_COUNT);
+    }
+    storeTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    printf("- pack:  %.1f ns/message\n",
+           (packTime.sec * 1e9 + packTime.usec * 1e3) / TIMING_LOOPS);
+    printf("- store: %.1f ns/message\n",
+           (storeTime.sec * 1e9 + storeTime.usec * 1e3) / TIMING_LOOPS);
+}
+
 COMPONENT_INIT
 {
     printf("======== le_pack Test Started ========\n");
@@ -132,6 +324,8 @@ COMPONENT_INIT
 
     TestUint8();
     TestString();
+    TestStoreLoad();
+    TimePackStore();
 
     printf("======== le_pack Test Complete ========\n");
     printf("\n");
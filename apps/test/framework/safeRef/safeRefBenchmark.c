@@ -0,0 +1,153 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Benchmark comparing the two Safe Reference Map backends (hashmap and slot maps).
+ *
+ *  - For maps holding 16 up to 64K references, create a map of each kind and fill it.
+ *  - Time lookups of the references in a shuffled order.
+ *  - Time deleting and re-creating references.
+ *  - Log the time per operation for both backends.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+
+/// Smallest number of references in a map.
+#define MIN_REFS 16
+
+/// Largest number of references in a map.
+#define MAX_REFS (64 * 1024)
+
+/// Number of lookups timed for each map size and backend.
+#define LOOKUPS_PER_RUN (4 * 1024 * 1024)
+
+/// Number of delete + create pairs timed for each map size and backend.
+#define CHURNS_PER_RUN (1024 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The references of the map being timed, and the order they are looked up in.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void* Refs[MAX_REFS];
+static uint32_t Order[MAX_REFS];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time elapsed since a start time, in nanoseconds.
+ **/
+//--------------------------------------------------------------------------------------------------
+static uint64_t NsSince
+(
+    le_clk_Time_t startTime
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return ((uint64_t)elapsed.sec * 1000000000) + ((uint64_t)elapsed.usec * 1000);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill a map with references, then time lookups and delete + create pairs on it.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void TimeMap
+(
+    const char* backendName,    ///< Name of the backend, for the log.
+    le_ref_MapRef_t mapRef,     ///< The (empty) map.
+    size_t refCount,            ///< Number of references to put in the map.
+    uint64_t* lookupNsPtr,      ///< [OUT] Time per lookup, in hundredths of nanoseconds.
+    uint64_t* churnNsPtr        ///< [OUT] Time per delete + create pair, in hundredths of ns.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i;
+    uintptr_t sum = 0;
+
+    for (i = 0; i < refCount; i++)
+    {
+        Refs[i] = le_ref_CreateRef(mapRef, &Refs[i]);
+    }
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < LOOKUPS_PER_RUN; i++)
+    {
+        sum += (uintptr_t)le_ref_Lookup(mapRef, Refs[Order[i % refCount]]);
+    }
+
+    *lookupNsPtr = (NsSince(startTime) * 100) / LOOKUPS_PER_RUN;
+
+    startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < CHURNS_PER_RUN; i++)
+    {
+        size_t index = Order[i % refCount];
+
+        le_ref_DeleteRef(mapRef, Refs[index]);
+        Refs[index] = le_ref_CreateRef(mapRef, &Refs[index]);
+    }
+
+    *churnNsPtr = (NsSince(startTime) * 100) / CHURNS_PER_RUN;
+
+    // Check the map is still right, which also stops the lookups being optimized away.
+    for (i = 0; i < refCount; i++)
+    {
+        LE_ASSERT(le_ref_Lookup(mapRef, Refs[i]) == &Refs[i]);
+    }
+    LE_ASSERT(sum != 0);
+
+    LE_DEBUG("%s map with %zu references done.", backendName, refCount);
+}
+
+
+COMPONENT_INIT
+{
+    size_t refCount;
+    size_t i;
+
+    LE_INFO("     refs : lookup ns (hash / slot) : delete+create ns (hash / slot)");
+
+    for (refCount = MIN_REFS; refCount <= MAX_REFS; refCount *= 4)
+    {
+        uint64_t hashLookupNs, hashChurnNs, slotLookupNs, slotChurnNs;
+
+        // Shuffle the lookup order, so the lookups don't just walk through memory.
+        for (i = 0; i < refCount; i++)
+        {
+            Order[i] = i;
+        }
+        for (i = refCount - 1; i > 0; i--)
+        {
+            size_t j = le_rand_GetNumBetween(0, i);
+            uint32_t temp = Order[i];
+
+            Order[i] = Order[j];
+            Order[j] = temp;
+        }
+
+        // Each map needs its own name, as hashmap maps create a memory pool named after the map.
+        char mapName[32];
+        snprintf(mapName, sizeof(mapName), "Bench%zu", refCount);
+
+        TimeMap("Hashmap", le_ref_CreateMap(mapName, refCount), refCount,
+                &hashLookupNs, &hashChurnNs);
+        TimeMap("Slot", le_ref_CreateSlotMap(mapName, refCount), refCount,
+                &slotLookupNs, &slotChurnNs);
+
+        LE_INFO("%9zu : %6"PRIu64".%02"PRIu64" / %6"PRIu64".%02"PRIu64
+                "       : %6"PRIu64".%02"PRIu64" / %6"PRIu64".%02"PRIu64,
+                refCount,
+                hashLookupNs / 100, hashLookupNs % 100, slotLookupNs / 100, slotLookupNs % 100,
+                hashChurnNs / 100, hashChurnNs % 100, slotChurnNs / 100, slotChurnNs % 100);
+    }
+
+    exit(EXIT_SUCCESS);
+}
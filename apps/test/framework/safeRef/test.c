@@ -1,6 +1,126 @@
 
 #include "legato.h"
 
+#define SLOT_TEST_REFS 100
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the references in a map using its iterator, checking each one on the way.
+ *
+ * @return The number of references.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t CountRefs
+(
+    le_ref_MapRef_t mapRef
+)
+{
+    size_t count = 0;
+    le_ref_IterRef_t iterRef = le_ref_GetIterator(mapRef);
+
+    LE_ASSERT(le_ref_GetValue(iterRef) == NULL);
+
+    while (le_ref_NextNode(iterRef) == LE_OK)
+    {
+        void* safeRef = (void*)le_ref_GetSafeRef(iterRef);
+
+        LE_ASSERT(((uintptr_t)safeRef & 1) == 1);
+        LE_ASSERT(le_ref_Lookup(mapRef, safeRef) == le_ref_GetValue(iterRef));
+        count++;
+    }
+
+    LE_ASSERT(le_ref_NextNode(iterRef) != LE_OK);
+
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the slot map backend.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestSlotMap
+(
+    le_ref_MapRef_t hashMapRef      ///< A hashmap map, to look its references up in a slot map.
+)
+{
+    static void* refs[SLOT_TEST_REFS];
+    int i;
+
+    LE_INFO("Testing slot map.");
+
+    // Start small so the slot array has to grow.
+    le_ref_MapRef_t mapRef = le_ref_CreateSlotMap("Slot Map", 2);
+    le_ref_MapRef_t otherMapRef = le_ref_CreateSlotMap("Other Slot Map", 2);
+
+    for (i = 0; i < SLOT_TEST_REFS; i++)
+    {
+        refs[i] = le_ref_CreateRef(mapRef, (void*)(uintptr_t)(0x2000 + i));
+        LE_ASSERT(((uintptr_t)refs[i] & 1) == 1);
+        LE_ASSERT(le_ref_Lookup(mapRef, refs[i]) == (void*)(uintptr_t)(0x2000 + i));
+    }
+    for (i = 0; i < SLOT_TEST_REFS; i++)
+    {
+        LE_ASSERT(le_ref_Lookup(mapRef, refs[i]) == (void*)(uintptr_t)(0x2000 + i));
+    }
+    LE_ASSERT(CountRefs(mapRef) == SLOT_TEST_REFS);
+
+    // Invalid references.
+    void* otherRef = le_ref_CreateRef(otherMapRef, (void*)0x3000);
+    LE_ASSERT(le_ref_Lookup(mapRef, NULL) == NULL);
+    LE_ASSERT(le_ref_Lookup(mapRef, &mapRef) == NULL);
+    LE_ASSERT(le_ref_Lookup(mapRef, otherRef) == NULL);
+    LE_ASSERT(le_ref_Lookup(otherMapRef, refs[0]) == NULL);
+    LE_ASSERT(le_ref_Lookup(mapRef, le_ref_CreateRef(hashMapRef, (void*)0x3001)) == NULL);
+    LE_ASSERT(le_ref_Lookup(mapRef, (void*)((uintptr_t)refs[0] + 2 * SLOT_TEST_REFS)) == NULL);
+
+    // Delete every other reference, then reuse the slots.  The old references must stay stale.
+    for (i = 0; i < SLOT_TEST_REFS; i += 2)
+    {
+        le_ref_DeleteRef(mapRef, refs[i]);
+        LE_ASSERT(le_ref_Lookup(mapRef, refs[i]) == NULL);
+        LE_ASSERT(le_ref_Lookup(mapRef, refs[i + 1]) == (void*)(uintptr_t)(0x2000 + i + 1));
+    }
+    LE_ASSERT(CountRefs(mapRef) == SLOT_TEST_REFS / 2);
+
+    LE_INFO("Deleting stale reference (expect ERROR)");
+    le_ref_DeleteRef(mapRef, refs[0]);
+
+    for (i = 0; i < SLOT_TEST_REFS; i += 2)
+    {
+        void* newRef = le_ref_CreateRef(mapRef, (void*)(uintptr_t)(0x4000 + i));
+        LE_ASSERT(newRef != refs[i]);
+        LE_ASSERT(le_ref_Lookup(mapRef, newRef) == (void*)(uintptr_t)(0x4000 + i));
+        LE_ASSERT(le_ref_Lookup(mapRef, refs[i]) == NULL);
+        refs[i] = newRef;
+    }
+    LE_ASSERT(CountRefs(mapRef) == SLOT_TEST_REFS);
+
+    // Churn one slot many times; its old references must never come back.
+    void* firstRef = refs[0];
+    for (i = 0; i < 1000; i++)
+    {
+        le_ref_DeleteRef(mapRef, refs[0]);
+        refs[0] = le_ref_CreateRef(mapRef, (void*)0x5000);
+        LE_ASSERT(le_ref_Lookup(mapRef, firstRef) == NULL);
+    }
+
+    // Deleting the current reference while iterating.
+    le_ref_IterRef_t iterRef = le_ref_GetIterator(mapRef);
+    while (le_ref_NextNode(iterRef) == LE_OK)
+    {
+        le_ref_DeleteRef(mapRef, (void*)le_ref_GetSafeRef(iterRef));
+        LE_ASSERT(le_ref_GetValue(iterRef) == NULL);
+    }
+    LE_ASSERT(CountRefs(mapRef) == 0);
+    for (i = 0; i < SLOT_TEST_REFS; i++)
+    {
+        LE_ASSERT(le_ref_Lookup(mapRef, refs[i]) == NULL);
+    }
+
+    LE_INFO("Slot map test passed.");
+}
+
 COMPONENT_INIT
 {
     LE_INFO("======== BEGIN SAFE REFERENCES TEST ========");
@@ -64,6 +184,10 @@ COMPONENT_INIT
     LE_ASSERT(le_ref_Lookup(mapRef1, &mapRef1) == NULL);
     LE_INFO("Looking up a pointer value failed, as expected");
 
+    LE_ASSERT(CountRefs(mapRef1) == 4);
+
+    TestSlotMap(mapRef1);
+
 
     LE_INFO("======== SAFE REFERENCES TEST COMPLETE (PASSED) ========");
     exit(EXIT_SUCCESS);
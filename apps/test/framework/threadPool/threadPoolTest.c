@@ -0,0 +1,169 @@
+/**
+ * Tests the Thread Pool API.
+ *
+ * A fixed pool runs work submitted by the main thread, some of which submits more work from the
+ * workers (which other workers can steal).  Then an elastic pool runs blocking work, growing up to
+ * its maximum.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+#define NUM_FIXED_THREADS   4
+#define NUM_ITEMS           1000
+#define NUM_NESTED_ITEMS    10      // Submitted by every tenth item.
+
+#define MAX_ELASTIC_THREADS 3
+#define NUM_BLOCKING_ITEMS  6
+#define BLOCKING_TIME_US    20000
+
+static le_thread_Ref_t MainThread;
+static le_threadPool_Ref_t PoolRef;
+
+static size_t WorkCount = 0;        // Updated atomically by the workers.
+static size_t CompletionCount = 0;  // Only updated by the main thread.
+
+
+static void NestedWork
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    LE_ASSERT(le_thread_GetCurrent() != MainThread);
+
+    __atomic_add_fetch(&WorkCount, 1, __ATOMIC_RELAXED);
+}
+
+
+static void Work
+(
+    void* param1Ptr,    // Item number.
+    void* param2Ptr
+)
+{
+    LE_ASSERT(le_thread_GetCurrent() != MainThread);
+
+    if (((size_t)param1Ptr % 10) == 0)
+    {
+        int i;
+        for (i = 0; i < NUM_NESTED_ITEMS; i++)
+        {
+            le_threadPool_Submit(PoolRef, NestedWork, NULL, NULL, NULL);
+        }
+    }
+
+    __atomic_add_fetch(&WorkCount, 1, __ATOMIC_RELAXED);
+}
+
+
+static void BlockingWork
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    usleep(BLOCKING_TIME_US);
+}
+
+
+static void BlockingDone
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    LE_ASSERT(le_thread_GetCurrent() == MainThread);
+
+    if (++CompletionCount < NUM_BLOCKING_ITEMS)
+    {
+        return;
+    }
+
+    le_threadPool_Stats_t stats;
+    le_threadPool_GetStats(PoolRef, &stats);
+
+    LE_INFO("Elastic pool: %zu threads (max %zu), %"PRIu64" completed, max wait %ld.%06ld s.",
+            stats.numThreads, stats.maxNumThreads, stats.numCompleted,
+            (long)stats.maxWaitTime.sec, (long)stats.maxWaitTime.usec);
+
+    LE_ASSERT(stats.numCompleted == NUM_BLOCKING_ITEMS);
+    LE_ASSERT(stats.queueDepth == 0);
+    LE_ASSERT((stats.maxNumThreads >= 1) && (stats.maxNumThreads <= MAX_ELASTIC_THREADS));
+    LE_ASSERT(stats.numThreads <= MAX_ELASTIC_THREADS);
+
+    le_threadPool_Delete(PoolRef);
+
+    LE_INFO("======== THREAD POOL TEST COMPLETE (PASSED) ========");
+    exit(EXIT_SUCCESS);
+}
+
+
+static void StartElasticTest
+(
+    void
+)
+{
+    int i;
+
+    PoolRef = le_threadPool_Create("Elastic", 0, MAX_ELASTIC_THREADS);
+    CompletionCount = 0;
+
+    for (i = 0; i < NUM_BLOCKING_ITEMS; i++)
+    {
+        le_threadPool_Submit(PoolRef, BlockingWork, BlockingDone, NULL, NULL);
+    }
+}
+
+
+static void WorkDone
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    LE_ASSERT(le_thread_GetCurrent() == MainThread);
+
+    if (++CompletionCount < NUM_ITEMS)
+    {
+        return;
+    }
+
+    le_threadPool_Stats_t stats;
+    le_threadPool_GetStats(PoolRef, &stats);
+
+    LE_INFO("Fixed pool: %"PRIu64" completed, %"PRIu64" stolen, max queue depth %zu.",
+            stats.numCompleted, stats.numStolen, stats.maxQueueDepth);
+
+    LE_ASSERT(stats.numThreads == NUM_FIXED_THREADS);
+    LE_ASSERT(stats.maxNumThreads == NUM_FIXED_THREADS);
+    LE_ASSERT(stats.numCompleted >= NUM_ITEMS);
+    LE_ASSERT(stats.maxQueueDepth >= 1);
+    LE_ASSERT(stats.maxQueueDepth <= NUM_ITEMS + (NUM_ITEMS / 10) * NUM_NESTED_ITEMS);
+
+    // Deleting the pool runs the nested work that is still queued.
+    le_threadPool_Delete(PoolRef);
+
+    LE_ASSERT(__atomic_load_n(&WorkCount, __ATOMIC_RELAXED) ==
+              NUM_ITEMS + (NUM_ITEMS / 10) * NUM_NESTED_ITEMS);
+
+    StartElasticTest();
+}
+
+
+COMPONENT_INIT
+{
+    size_t i;
+
+    LE_INFO("======== BEGIN THREAD POOL TEST ========");
+
+    MainThread = le_thread_GetCurrent();
+
+    PoolRef = le_threadPool_Create("Fixed", NUM_FIXED_THREADS, NUM_FIXED_THREADS);
+
+    for (i = 0; i < NUM_ITEMS; i++)
+    {
+        le_threadPool_Submit(PoolRef, Work, WorkDone, (void*)i, NULL);
+    }
+}
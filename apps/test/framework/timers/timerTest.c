@@ -113,6 +113,30 @@ void LongTimerExpiryHandler
 
 }
 
+void SlackTimerExpiryHandler
+(
+    le_timer_Ref_t timerRef    ///< This timer has expired
+)
+{
+    LE_INFO("\n ======================================");
+    // The slack timer was allowed to expire late, so it should have been handled on the same
+    // wake-up as the precise timer (passed in as contextPtr), which expires after it.
+
+    le_timer_Ref_t preciseTimer = le_timer_GetContextPtr(timerRef);
+
+    if ( le_timer_GetExpiryCount(preciseTimer) == 1 )
+    {
+        LE_INFO("Slack timer expired together with precise timer: TEST PASSED");
+    }
+    else
+    {
+        LE_ERROR("Slack timer expired before precise timer: TEST FAILED");
+    }
+
+    le_timer_Delete(preciseTimer);
+    le_timer_Delete(timerRef);
+}
+
 void AdditionalTests
 (
     le_timer_Ref_t oldTimer
@@ -121,6 +145,8 @@ void AdditionalTests
     le_result_t result;
     le_timer_Ref_t shortTimer;
     le_timer_Ref_t longTimer;
+    le_timer_Ref_t slackTimer;
+    le_timer_Ref_t preciseTimer;
     le_clk_Time_t oneSecInterval = { 1, 0 };
 
     LE_INFO("\n ======================================");
@@ -150,9 +176,21 @@ void AdditionalTests
     le_timer_SetHandler(longTimer, LongTimerExpiryHandler);
     le_timer_SetContextPtr(longTimer, shortTimer);
 
+    // A timer with slack that expires before a precise timer, but is allowed to expire after it.
+    preciseTimer = le_timer_Create("precise timer");
+    le_timer_SetInterval( preciseTimer, le_clk_Multiply(oneSecInterval, 3) );
+
+    slackTimer = le_timer_Create("slack timer");
+    le_timer_SetInterval( slackTimer, le_clk_Multiply(oneSecInterval, 2) );
+    le_timer_SetMsSlack( slackTimer, 2000 );
+    le_timer_SetHandler(slackTimer, SlackTimerExpiryHandler);
+    le_timer_SetContextPtr(slackTimer, preciseTimer);
+
     StartTime = le_clk_GetRelativeTime();
     le_timer_Start(shortTimer);
     le_timer_Start(longTimer);
+    le_timer_Start(slackTimer);
+    le_timer_Start(preciseTimer);
 
     // Sleep 1 second for testing purpose only, to verify that restarting the timer will cause
     // it to expire one second later.
@@ -0,0 +1,186 @@
+/*
+ * Client side of the specialized packing test.
+ *
+ * Checks the results of each function in layout.api, then calls each of them repeatedly and logs
+ * the average time per call, so the default and specialized pack/unpack code can be compared.
+ * The test script runs every combination of default and specialized client and server, which
+ * also checks that they use the same message layout.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "layout_interface.h"
+
+#define NUM_CALLS 10000
+
+
+static void TestScalars
+(
+    void
+)
+{
+    int64_t sum;
+    bool notFlag;
+    char upperLetter;
+    double half;
+    layout_Color_t nextColor;
+    layout_Flags_t allFlags;
+
+    layout_Scalars(0xF0, -300, 0x80000000, -5000000000LL, true, 'q', 3.5, LAYOUT_BLUE,
+                   LAYOUT_FLAG_A, &sum, &notFlag, &upperLetter, &half, &nextColor, &allFlags);
+
+    LE_ASSERT(sum == 0xF0 - 300 + 0x80000000LL - 5000000000LL);
+    LE_ASSERT(notFlag == false);
+    LE_ASSERT(upperLetter == 'Q');
+    LE_ASSERT(half == 1.75);
+    LE_ASSERT(nextColor == LAYOUT_RED);
+    LE_ASSERT(allFlags == (LAYOUT_FLAG_A | LAYOUT_FLAG_C));
+
+    // Outputs which aren't asked for are left out of the response.
+    half = 0;
+    layout_Scalars(1, 2, 3, 4, false, 'a', 1.0, LAYOUT_RED, 0,
+                   NULL, &notFlag, NULL, &half, NULL, NULL);
+
+    LE_ASSERT(notFlag == true);
+    LE_ASSERT(half == 0.5);
+}
+
+
+static void TestReverse
+(
+    void
+)
+{
+    int32_t samples[LAYOUT_MAX_SAMPLES];
+    int32_t reversed[LAYOUT_MAX_SAMPLES];
+    size_t reversedSize = NUM_ARRAY_MEMBERS(reversed);
+    int64_t sum;
+    int i;
+
+    for (i = 0; i < LAYOUT_MAX_SAMPLES; i++)
+    {
+        samples[i] = i * 1000 - 7;
+    }
+
+    LE_ASSERT(layout_Reverse(samples, 10, reversed, &reversedSize, &sum) == LE_OK);
+    LE_ASSERT(reversedSize == 10);
+    LE_ASSERT(sum == 45 * 1000 - 70);
+    for (i = 0; i < 10; i++)
+    {
+        LE_ASSERT(reversed[i] == samples[9 - i]);
+    }
+
+    reversedSize = NUM_ARRAY_MEMBERS(reversed);
+    LE_ASSERT(layout_Reverse(samples, LAYOUT_MAX_SAMPLES, reversed, &reversedSize, &sum) == LE_OK);
+    LE_ASSERT(reversedSize == LAYOUT_MAX_SAMPLES);
+    LE_ASSERT(reversed[0] == samples[LAYOUT_MAX_SAMPLES - 1]);
+
+    reversedSize = NUM_ARRAY_MEMBERS(reversed);
+    LE_ASSERT(layout_Reverse(NULL, 0, reversed, &reversedSize, &sum) == LE_OK);
+    LE_ASSERT(reversedSize == 0);
+    LE_ASSERT(sum == 0);
+
+    reversedSize = 5;
+    LE_ASSERT(layout_Reverse(samples, 10, reversed, &reversedSize, &sum) == LE_OVERFLOW);
+    LE_ASSERT(reversedSize == 0);
+}
+
+
+static void TestWidgets
+(
+    void
+)
+{
+    layout_WidgetRef_t widget = layout_GetWidget(41);
+    layout_WidgetRef_t nextWidget;
+    uint32_t id;
+
+    LE_ASSERT(widget != NULL);
+    LE_ASSERT(layout_GetWidget(0) == NULL);
+
+    LE_ASSERT(layout_GetNextWidget(widget, &id, &nextWidget) == LE_OK);
+    LE_ASSERT(id == 41);
+    LE_ASSERT(nextWidget == layout_GetWidget(42));
+
+    LE_ASSERT(layout_GetNextWidget(NULL, &id, &nextWidget) == LE_BAD_PARAMETER);
+}
+
+
+static void LogTimePerCall
+(
+    const char* functionName,
+    le_clk_Time_t startTime
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    LE_INFO("%s: %d calls, %.2f us/call", functionName, NUM_CALLS,
+            (elapsed.sec * 1000000.0 + elapsed.usec) / NUM_CALLS);
+}
+
+
+static void TimeCalls
+(
+    void
+)
+{
+    int32_t samples[LAYOUT_MAX_SAMPLES] = { 0 };
+    int32_t reversed[LAYOUT_MAX_SAMPLES];
+    size_t reversedSize;
+    int64_t sum;
+    bool notFlag;
+    char upperLetter;
+    double half;
+    layout_Color_t nextColor;
+    layout_Flags_t allFlags;
+    uint32_t id;
+    layout_WidgetRef_t nextWidget;
+    le_clk_Time_t startTime;
+    int i;
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < NUM_CALLS; i++)
+    {
+        layout_Nothing();
+    }
+    LogTimePerCall("Nothing", startTime);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < NUM_CALLS; i++)
+    {
+        layout_Scalars(i, i, i, i, true, 'x', i, LAYOUT_GREEN, LAYOUT_FLAG_B,
+                       &sum, &notFlag, &upperLetter, &half, &nextColor, &allFlags);
+    }
+    LogTimePerCall("Scalars", startTime);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < NUM_CALLS; i++)
+    {
+        reversedSize = NUM_ARRAY_MEMBERS(reversed);
+        layout_Reverse(samples, LAYOUT_MAX_SAMPLES, reversed, &reversedSize, &sum);
+    }
+    LogTimePerCall("Reverse", startTime);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < NUM_CALLS; i++)
+    {
+        layout_GetNextWidget(layout_GetWidget(i + 1), &id, &nextWidget);
+    }
+    LogTimePerCall("GetWidget+GetNextWidget", startTime);
+}
+
+
+COMPONENT_INIT
+{
+    layout_ConnectService();
+
+    TestScalars();
+    TestReverse();
+    TestWidgets();
+    LE_INFO("All results are correct");
+
+    TimeCalls();
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,144 @@
+/*
+ * Server side of the specialized packing test.
+ *
+ * The same implementation is linked with both the default and the specialized server code, so
+ * the client gets the same results from either.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "layout_server.h"
+
+
+// Widget references are made up from the widget id, so they look like safe references.
+#define WIDGET_REF(id)  ((layout_WidgetRef_t)(((size_t)(id) << 1) | 1))
+#define WIDGET_ID(ref)  ((uint32_t)((size_t)(ref) >> 1))
+
+
+void layout_Nothing
+(
+    void
+)
+{
+}
+
+
+void layout_Scalars
+(
+    uint8_t u8,
+    int16_t i16,
+    uint32_t u32,
+    int64_t i64,
+    bool flag,
+    char letter,
+    double value,
+    layout_Color_t color,
+    layout_Flags_t flags,
+    int64_t* sumPtr,
+    bool* notFlagPtr,
+    char* upperLetterPtr,
+    double* halfPtr,
+    layout_Color_t* nextColorPtr,
+    layout_Flags_t* allFlagsPtr
+)
+{
+    // Only the outputs the client asked for are non-NULL.
+    if (sumPtr)
+    {
+        *sumPtr = u8 + i16 + u32 + i64;
+    }
+    if (notFlagPtr)
+    {
+        *notFlagPtr = !flag;
+    }
+    if (upperLetterPtr)
+    {
+        *upperLetterPtr = toupper(letter);
+    }
+    if (halfPtr)
+    {
+        *halfPtr = value / 2;
+    }
+    if (nextColorPtr)
+    {
+        *nextColorPtr = (color + 1) % (LAYOUT_BLUE + 1);
+    }
+    if (allFlagsPtr)
+    {
+        *allFlagsPtr = flags | LAYOUT_FLAG_C;
+    }
+}
+
+
+le_result_t layout_Reverse
+(
+    const int32_t* samplesPtr,
+    size_t samplesSize,
+    int32_t* reversedPtr,
+    size_t* reversedSizePtr,
+    int64_t* sumPtr
+)
+{
+    size_t i;
+    int64_t sum = 0;
+
+    if (*reversedSizePtr < samplesSize)
+    {
+        *reversedSizePtr = 0;
+        *sumPtr = 0;
+        return LE_OVERFLOW;
+    }
+
+    for (i = 0; i < samplesSize; i++)
+    {
+        reversedPtr[samplesSize - 1 - i] = samplesPtr[i];
+        sum += samplesPtr[i];
+    }
+    *reversedSizePtr = samplesSize;
+    *sumPtr = sum;
+
+    return LE_OK;
+}
+
+
+layout_WidgetRef_t layout_GetWidget
+(
+    uint32_t id
+)
+{
+    if (id == 0)
+    {
+        return NULL;
+    }
+
+    return WIDGET_REF(id);
+}
+
+
+le_result_t layout_GetNextWidget
+(
+    layout_WidgetRef_t widget,
+    uint32_t* idPtr,
+    layout_WidgetRef_t* nextWidgetPtr
+)
+{
+    // Outputs are sent back even on failure, so they must be valid references.
+    if (widget == NULL)
+    {
+        *idPtr = 0;
+        *nextWidgetPtr = NULL;
+        return LE_BAD_PARAMETER;
+    }
+
+    *idPtr = WIDGET_ID(widget);
+    *nextWidgetPtr = WIDGET_REF(*idPtr + 1);
+
+    return LE_OK;
+}
+
+
+COMPONENT_INIT
+{
+    layout_AdvertiseService();
+}
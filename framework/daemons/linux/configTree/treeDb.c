@@ -120,6 +120,38 @@
  *  in order to have a handler registed for it.  In fact, a handler will be called when a node is
  *  deleted and when it is recreated.
  *
+ *  <b>Tree Files and Journals:</b>
+ *
+ *  Each tree is saved in a tree file, named after the tree and one of the three "rock, paper,
+ *  scissors" revisions.  Rewriting the whole tree file on every commit is expensive for large
+ *  trees, so once a tree file exists, commits are instead appended to a journal file next to it
+ *  (the tree file's path followed by ".journal").  A journal starts with the inode number and size
+ *  of the tree file it applies to, followed by one entry per committed transaction:
+ *
+ *  @verbatim
+    [inode] [size]
+    + "/path/to/node" <node, in tree file format> ;
+    - "/path/to/deletedNode" - "/path/to/renamedNode" + "/path/to/newName" { } ;
+ @endverbatim
+ *
+ *  A '+' record replaces (or creates) the node at the given path, and '-' deletes it.  A renamed
+ *  node is recorded as the deletion of its old path and the creation of its new one.  The records
+ *  of a transaction are only applied if its closing ';' is found, so a transaction whose write was
+ *  interrupted is dropped.
+ *
+ *  When a tree is loaded, its tree file is read and then its journal is replayed on top of it.
+ *  Once the journal grows bigger than the tree file, the next commit writes the whole tree to a
+ *  new revision of the tree file instead, then deletes the old revision and its journal.
+ *
+ *  <b>Lookups:</b>
+ *
+ *  A stem's children are kept in a list, which is searched one by one when looking up a child by
+ *  name.  Once such a search has had to go through many children, the stem gets an index of its
+ *  children, by name, which is then kept up to date as children are added, removed and renamed.
+ *
+ *  Lookups of whole paths in the trees that read transactions use are also cached, by path.  The
+ *  cache is cleared whenever a node is deleted or renamed in one of those trees.
+ *
  *  Copyright (C) Sierra Wireless Inc.
  *
  */
@@ -148,6 +180,82 @@
 
 
 
+/// Suffix added to the path of a tree file to get the path of its journal.
+#define JOURNAL_SUFFIX ".journal"
+
+
+
+/// A journal is never compacted into a new tree file before it reaches this size, in bytes.
+#define JOURNAL_MIN_COMPACT_SIZE (16 * 1024)
+
+
+
+/// A stem's children are indexed by name once a search has had to look through this many of them.
+#define CHILD_INDEX_THRESHOLD 16
+
+
+
+/// Smallest number of slots in a child index.  Must be a power of 2.
+#define CHILD_INDEX_MIN_SLOTS 32
+
+
+
+/// Number of entries in the path lookup cache.  Must be a power of 2.
+#define PATH_CACHE_SIZE 32
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A slot in a child index.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t hash;            ///< Hash of the child's name.
+    tdb_NodeRef_t nodeRef;  ///< The child node, NULL if the slot is free.
+}
+ChildIndexSlot_t;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index of a stem's children, by name.  This is an open addressing hash table with linear probing,
+ * kept at most half full.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct ChildIndex
+{
+    size_t count;                  ///< Number of children in the index.
+    size_t mask;                   ///< Number of slots minus one.  The number of slots is a power
+                                   ///<   of 2.
+    ChildIndexSlot_t slots[];      ///< The slots of the table.
+}
+ChildIndex_t;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An entry in the path lookup cache.  Entries are only valid while their generation matches the
+ * current one, which moves on whenever a node of a non-shadow tree is deleted or renamed.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t generation;                  ///< Value of PathCacheGeneration when this was cached.
+    tdb_NodeRef_t baseNodeRef;            ///< The base node the path was looked up from.
+    tdb_NodeRef_t nodeRef;                ///< The node that the path leads to.
+    char path[LE_CFG_STR_LEN_BYTES];      ///< The path that was looked up.
+}
+PathCacheEntry_t;
+
+
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -271,6 +379,9 @@ typedef struct Node
         le_dls_List_t children;      ///< The linked list of children belonging to this node.
     }
     info;                            ///< The actual inforation that this node stores.
+
+    ChildIndex_t* childIndexPtr;     ///< Index of this node's children by name.  NULL until the
+                                     ///<   node is a stem with enough children to be worth it.
 }
 Node_t;
 
@@ -307,12 +418,51 @@ typedef struct Tree
 
     le_sls_List_t requestList;            ///< Each tree maintains it's own list of pending
                                           ///<   requests.
+
+    ino_t fileInode;                      ///< Inode of the tree file that was loaded or last
+                                          ///<   written.  0 if there isn't one, in which case
+                                          ///<   changes can't be journaled.
+    off_t fileSize;                       ///< Size of that tree file, in bytes.
+    off_t journalSize;                    ///< Size of the tree file's journal, in bytes.  0 if
+                                          ///<   there's no journal.
 }
 Tree_t;
 
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kinds of journal records.  The values are the characters that start the records in the journal.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    JOURNAL_SET = '+',      ///< Replace the node at the path with the node that follows.
+    JOURNAL_DELETE = '-',   ///< Delete the node at the path.
+    JOURNAL_END = ';'       ///< End of a transaction.
+}
+JournalOp_t;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A change made by a transaction, waiting to be written to a tree's journal.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct JournalChange
+{
+    le_sls_Link_t link;                  ///< Link in the transaction's list of changes.
+    JournalOp_t op;                      ///< What kind of change.
+    char path[LE_CFG_STR_LEN_BYTES];     ///< Absolute path to the changed node.
+}
+JournalChange_t;
+
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Types of lexical tokens that can be found in configuration data files.
@@ -388,6 +538,22 @@ static le_mem_PoolRef_t RegistrationPool = NULL;
 
 
 
+/// Cache of recent lookups of paths in non-shadow trees, (the ones read transactions work on.)
+static PathCacheEntry_t PathCache[PATH_CACHE_SIZE];
+
+/// Current generation of the path lookup cache.  Bumping this invalidates every cached entry.
+static uint32_t PathCacheGeneration = 1;
+
+
+
+/// Pool for the journal change records.
+static le_mem_PoolRef_t JournalChangePool = NULL;
+
+/// Name of the journal change pool.
+#define CFG_JOURNAL_CHANGE_POOL_NAME "JournalChangePool"
+
+
+
 
 // -------------------------------------------------------------------------------------------------
 /**
@@ -542,6 +708,273 @@ static void ClearDeletedFlag
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Hash a node's name for the child index.
+ *
+ *  @return The hash of the name the node currently goes by.
+ */
+// -------------------------------------------------------------------------------------------------
+static size_t HashNodeName
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] The node whose name is hashed.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char name[LE_CFG_NAME_LEN_BYTES] = "";
+
+    tdb_GetNodeName(nodeRef, name, sizeof(name));
+
+    return le_hashmap_HashString(name);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Put a node in a free slot of a child index.  The index must have room for it.
+ */
+// -------------------------------------------------------------------------------------------------
+static void InsertIntoIndex
+(
+    ChildIndex_t* indexPtr,  ///< [IN] The index to update.
+    size_t hash,             ///< [IN] Hash of the node's name.
+    tdb_NodeRef_t nodeRef    ///< [IN] The node to add.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t i = hash & indexPtr->mask;
+
+    while (indexPtr->slots[i].nodeRef != NULL)
+    {
+        i = (i + 1) & indexPtr->mask;
+    }
+
+    indexPtr->slots[i].hash = hash;
+    indexPtr->slots[i].nodeRef = nodeRef;
+    indexPtr->count++;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Drop a stem's child index, if it has one.  Searches go back to walking the child list until the
+ *  index is rebuilt.
+ */
+// -------------------------------------------------------------------------------------------------
+static void DeleteChildIndex
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] The node whose index is dropped.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    free(nodeRef->childIndexPtr);
+    nodeRef->childIndexPtr = NULL;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  (Re)build the index of a stem's children, with enough slots for the given number of children.
+ */
+// -------------------------------------------------------------------------------------------------
+static void BuildChildIndex
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] The stem to index.
+    size_t minCount         ///< [IN] Number of children the index must have room for.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t slotCount = CHILD_INDEX_MIN_SLOTS;
+
+    while (slotCount < (minCount * 2))
+    {
+        slotCount *= 2;
+    }
+
+    ChildIndex_t* indexPtr = calloc(1, sizeof(ChildIndex_t) + (slotCount * sizeof(ChildIndexSlot_t)));
+    LE_ASSERT(indexPtr != NULL);
+
+    indexPtr->count = 0;
+    indexPtr->mask = slotCount - 1;
+
+    // When growing, reuse the hashes already in the old index.
+    ChildIndex_t* oldIndexPtr = nodeRef->childIndexPtr;
+
+    if (oldIndexPtr != NULL)
+    {
+        for (size_t i = 0; i <= oldIndexPtr->mask; i++)
+        {
+            if (oldIndexPtr->slots[i].nodeRef != NULL)
+            {
+                InsertIntoIndex(indexPtr, oldIndexPtr->slots[i].hash, oldIndexPtr->slots[i].nodeRef);
+            }
+        }
+
+        free(oldIndexPtr);
+    }
+    else
+    {
+        le_dls_Link_t* linkPtr = le_dls_Peek(&nodeRef->info.children);
+
+        while (linkPtr != NULL)
+        {
+            tdb_NodeRef_t childRef = CONTAINER_OF(linkPtr, Node_t, siblingList);
+
+            InsertIntoIndex(indexPtr, HashNodeName(childRef), childRef);
+            linkPtr = le_dls_PeekNext(&nodeRef->info.children, linkPtr);
+        }
+    }
+
+    nodeRef->childIndexPtr = indexPtr;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Add a child node to its parent's child index, if the parent has one.  Call this after the node
+ *  is added to the parent's child list, or after it's renamed.
+ */
+// -------------------------------------------------------------------------------------------------
+static void AddToChildIndex
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] The child node.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    tdb_NodeRef_t parentRef = nodeRef->parentRef;
+
+    if (   (parentRef == NULL)
+        || (parentRef->childIndexPtr == NULL))
+    {
+        return;
+    }
+
+    if (((parentRef->childIndexPtr->count + 1) * 2) > (parentRef->childIndexPtr->mask + 1))
+    {
+        BuildChildIndex(parentRef, parentRef->childIndexPtr->count + 1);
+    }
+
+    InsertIntoIndex(parentRef->childIndexPtr, HashNodeName(nodeRef), nodeRef);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Remove a child node from its parent's child index, if the parent has one.  Call this before the
+ *  node is removed from the parent's child list, or before it's renamed.
+ */
+// -------------------------------------------------------------------------------------------------
+static void RemoveFromChildIndex
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] The child node.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    tdb_NodeRef_t parentRef = nodeRef->parentRef;
+
+    if (   (parentRef == NULL)
+        || (parentRef->childIndexPtr == NULL))
+    {
+        return;
+    }
+
+    ChildIndex_t* indexPtr = parentRef->childIndexPtr;
+    size_t i = HashNodeName(nodeRef) & indexPtr->mask;
+
+    while (indexPtr->slots[i].nodeRef != nodeRef)
+    {
+        if (indexPtr->slots[i].nodeRef == NULL)
+        {
+            // The node isn't where its name says it should be.  Rather than risk bad lookups, drop
+            // the index so that it gets rebuilt from the child list.
+            LE_WARN("Child index out of sync, rebuilding.");
+            DeleteChildIndex(parentRef);
+            return;
+        }
+
+        i = (i + 1) & indexPtr->mask;
+    }
+
+    // Shift the following entries of the cluster back, so that none of them ends up separated from
+    // its home slot by a free slot.
+    size_t freeSlot = i;
+
+    for (;;)
+    {
+        i = (i + 1) & indexPtr->mask;
+
+        if (indexPtr->slots[i].nodeRef == NULL)
+        {
+            break;
+        }
+
+        size_t home = indexPtr->slots[i].hash & indexPtr->mask;
+
+        // Move the entry if its home slot isn't cyclically within (freeSlot, i].
+        if (((i - home) & indexPtr->mask) >= ((i - freeSlot) & indexPtr->mask))
+        {
+            indexPtr->slots[freeSlot] = indexPtr->slots[i];
+            freeSlot = i;
+        }
+    }
+
+    indexPtr->slots[freeSlot].nodeRef = NULL;
+    indexPtr->count--;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Look up a child node by name in a stem's child index.
+ *
+ *  @return The child node, or NULL if there is no child by that name.
+ */
+// -------------------------------------------------------------------------------------------------
+static tdb_NodeRef_t FindIndexedChild
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] The indexed stem to search.
+    const char* nameRef     ///< [IN] The name we're searching for.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    ChildIndex_t* indexPtr = nodeRef->childIndexPtr;
+    size_t hash = le_hashmap_HashString(nameRef);
+    size_t i = hash & indexPtr->mask;
+    char currentNameRef[LE_CFG_NAME_LEN_BYTES] = "";
+
+    while (indexPtr->slots[i].nodeRef != NULL)
+    {
+        if (indexPtr->slots[i].hash == hash)
+        {
+            tdb_GetNodeName(indexPtr->slots[i].nodeRef, currentNameRef, sizeof(currentNameRef));
+
+            if (strncmp(currentNameRef, nameRef, sizeof(currentNameRef)) == 0)
+            {
+                return indexPtr->slots[i].nodeRef;
+            }
+        }
+
+        i = (i + 1) & indexPtr->mask;
+    }
+
+    return NULL;
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Allocate a new node and fill out it's default information.
@@ -565,6 +998,7 @@ static tdb_NodeRef_t NewNode
     newNodeRef->nameRef = NULL;
     newNodeRef->siblingList = LE_DLS_LINK_INIT;
     memset(&newNodeRef->info, 0, sizeof(newNodeRef->info));
+    newNodeRef->childIndexPtr = NULL;
 
     return newNodeRef;
 }
@@ -586,6 +1020,16 @@ static void NodeDestructor
 {
     tdb_NodeRef_t nodeRef = (tdb_NodeRef_t)objectPtr;
 
+    // Take the node out of its parent's index while it still has its name, and drop its own index
+    // so that its children don't have to be taken out of it one by one.
+    RemoveFromChildIndex(nodeRef);
+    DeleteChildIndex(nodeRef);
+
+    if (IsShadow(nodeRef) == false)
+    {
+        PathCacheGeneration++;
+    }
+
     if (nodeRef->nameRef)
     {
         dstr_Release(nodeRef->nameRef);
@@ -718,6 +1162,7 @@ static tdb_NodeRef_t NewChildNode
 
     // Now make sure to add the new child node to the end of the parents collection.
     le_dls_Queue(&nodeRef->info.children, &newRef->siblingList);
+    AddToChildIndex(newRef);
 
     // Finally return the newly created node to the caller.
     return newRef;
@@ -778,6 +1223,7 @@ static void ShadowChildren
         newShadowRef->parentRef = shadowParentRef;
 
         le_dls_Queue(&shadowParentRef->info.children, &newShadowRef->siblingList);
+        AddToChildIndex(newShadowRef);
 
         originalChildRef = tdb_GetNextSiblingNode(originalChildRef);
     }
@@ -842,9 +1288,16 @@ static tdb_NodeRef_t GetNamedChild
         return NULL;
     }
 
+    // Large collections have an index, so use it.
+    if (nodeRef->childIndexPtr != NULL)
+    {
+        return FindIndexedChild(nodeRef, nameRef);
+    }
+
     // Search the child list for a node with the given name.
     tdb_NodeRef_t currentRef = tdb_GetFirstChildNode(nodeRef);
     char currentNameRef[LE_CFG_NAME_LEN_BYTES] = "";
+    size_t count = 0;
 
     while (currentRef != NULL)
     {
@@ -852,14 +1305,20 @@ static tdb_NodeRef_t GetNamedChild
 
         if (strncmp(currentNameRef, nameRef, sizeof(currentNameRef)) == 0)
         {
-            return currentRef;
+            break;
         }
 
         currentRef = tdb_GetNextSiblingNode(currentRef);
+        count++;
     }
 
-    // Looks like there was no node to return.
-    return NULL;
+    // If that was a long search, index the collection so that the next one isn't.
+    if (count >= CHILD_INDEX_THRESHOLD)
+    {
+        BuildChildIndex(nodeRef, count);
+    }
+
+    return currentRef;
 }
 
 
@@ -926,22 +1385,7 @@ static bool NodeExists
 )
 // -------------------------------------------------------------------------------------------------
 {
-    tdb_NodeRef_t currentRef = tdb_GetFirstChildNode(parentRef);
-    char currentName[LE_CFG_NAME_LEN_BYTES] = "";
-
-    while (currentRef != NULL)
-    {
-        tdb_GetNodeName(currentRef, currentName, sizeof(currentName));
-
-        if (strncmp(currentName, namePtr, sizeof(currentName)) == 0)
-        {
-            return true;
-        }
-
-        currentRef = tdb_GetNextSiblingNode(currentRef);
-    }
-
-    return false;
+    return GetNamedChild(parentRef, namePtr) != NULL;
 }
 
 
@@ -1074,6 +1518,8 @@ static void MergeNode
     // If the name has been changed, then copy it over now.
     if (dstr_IsNullOrEmpty(nodeRef->nameRef) == false)
     {
+        RemoveFromChildIndex(originalRef);
+
         if (originalRef->nameRef != NULL)
         {
             dstr_Copy(originalRef->nameRef, nodeRef->nameRef);
@@ -1082,6 +1528,9 @@ static void MergeNode
         {
             originalRef->nameRef = dstr_NewFromDstr(nodeRef->nameRef);
         }
+
+        AddToChildIndex(originalRef);
+        PathCacheGeneration++;
     }
 
     // Check the types of the original and the shadow nodes.  If the new node has been cleared,
@@ -1586,6 +2035,9 @@ tdb_TreeRef_t NewTree
     treeRef->activeReadCount = 0;
     treeRef->activeWriteIterRef = NULL;
     treeRef->requestList = LE_SLS_LIST_INIT;
+    treeRef->fileInode = 0;
+    treeRef->fileSize = 0;
+    treeRef->journalSize = 0;
 
     return treeRef;
 }
@@ -2447,166 +2899,950 @@ static void IncrementRevision
 {
     treeRef->revisionId++;
 
-    if (treeRef->revisionId > 3)
+    if (treeRef->revisionId > 3)
+    {
+        treeRef->revisionId = 1;
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Create a path to the journal of a tree file with the given revision id.
+ */
+// -------------------------------------------------------------------------------------------------
+static void GetJournalPath
+(
+    const char* treeNameRef,  ///< [IN] The name of the tree we're generating a name for.
+    int revisionId,           ///< [IN] Revision of the tree file the journal applies to.
+    char* pathBuffer,         ///< [IN] Buffer to hold the new path.
+    size_t pathSize           ///< [IN] Size of the path buffer.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    GetTreePath(treeNameRef, revisionId, pathBuffer, pathSize);
+
+    if (   (pathBuffer[0] != '\0')
+        && (le_utf8_Append(pathBuffer, JOURNAL_SUFFIX, pathSize, NULL) != LE_OK))
+    {
+        LE_ERROR("Unable to store config tree journal path in buffer");
+        pathBuffer[0] = '\0';
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Delete the journal of a tree file, if there is one.
+ */
+// -------------------------------------------------------------------------------------------------
+static void DeleteJournal
+(
+    const char* treeNameRef,  ///< [IN] The name of the tree.
+    int revisionId            ///< [IN] Revision of the tree file the journal applies to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char journalPath[LE_CFG_STR_LEN_BYTES] = "";
+    GetJournalPath(treeNameRef, revisionId, journalPath, sizeof(journalPath));
+
+    if (   (journalPath[0] != '\0')
+        && (unlink(journalPath) != 0)
+        && (errno != ENOENT))
+    {
+        LE_ERROR("File delete failure, '%s', reason '%m'.", journalPath);
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Record the inode and size of the tree's current tree file, so that it can be matched with its
+ *  journal.
+ */
+// -------------------------------------------------------------------------------------------------
+static void UpdateFileInfo
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree object to update.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char filePath[LE_CFG_STR_LEN_BYTES] = "";
+    struct stat fileStat;
+
+    treeRef->fileInode = 0;
+    treeRef->fileSize = 0;
+
+    if (treeRef->revisionId == 0)
+    {
+        return;
+    }
+
+    GetTreePath(treeRef->name, treeRef->revisionId, filePath, sizeof(filePath));
+
+    if (   (filePath[0] != '\0')
+        && (stat(filePath, &fileStat) == 0))
+    {
+        treeRef->fileInode = fileStat.st_ino;
+        treeRef->fileSize = fileStat.st_size;
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Find the node at the given absolute path in a non-shadow tree, optionally creating it, along with
+ *  any missing parent nodes.
+ *
+ *  @return The node, or NULL if it doesn't exist and could not be created.
+ */
+// -------------------------------------------------------------------------------------------------
+static tdb_NodeRef_t FindJournalNode
+(
+    tdb_NodeRef_t rootRef,  ///< [IN] Root node of the tree.
+    const char* pathPtr,    ///< [IN] Absolute path to the node, as found in the journal.
+    bool create             ///< [IN] Create the node if it doesn't exist?
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char path[LE_CFG_STR_LEN_BYTES] = "";
+    char* savePtr = NULL;
+    tdb_NodeRef_t nodeRef = rootRef;
+
+    if (le_utf8_Copy(path, pathPtr, sizeof(path), NULL) != LE_OK)
+    {
+        return NULL;
+    }
+
+    char* namePtr = strtok_r(path, "/", &savePtr);
+
+    while (   (namePtr != NULL)
+           && (nodeRef != NULL))
+    {
+        tdb_NodeRef_t childRef = GetNamedChild(nodeRef, namePtr);
+
+        if (   (childRef == NULL)
+            && (create == true))
+        {
+            // Values can't have children, so a value has to be cleared before a child is added.
+            if (nodeRef->type != LE_CFG_TYPE_STEM)
+            {
+                tdb_SetEmpty(nodeRef);
+                ClearModifiedFlag(nodeRef);
+            }
+
+            childRef = NewChildNode(nodeRef);
+
+            if (tdb_SetNodeName(childRef, namePtr) != LE_OK)
+            {
+                le_mem_Release(childRef);
+                return NULL;
+            }
+
+            ClearModifiedFlag(childRef);
+        }
+
+        nodeRef = childRef;
+        namePtr = strtok_r(NULL, "/", &savePtr);
+    }
+
+    return nodeRef;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read one transaction from a tree's journal, and apply its changes to the tree if requested.
+ *
+ *  @return LE_OK if a whole transaction was read.
+ *          LE_OUT_OF_RANGE if the end of the journal was reached before the transaction started.
+ *          LE_FORMAT_ERROR if the transaction is incomplete or can't be parsed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t ReadJournalTransaction
+(
+    tdb_NodeRef_t rootRef,  ///< [IN] Root node of the tree to apply the transaction to.
+    FILE* filePtr,          ///< [IN] The journal, positioned at the start of the transaction.
+    bool apply              ///< [IN] Apply the changes, or only check that they can be read?
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char path[LE_CFG_STR_LEN_BYTES] = "";
+    TokenType_t tokenType;
+    bool isFirst = true;
+
+    for (;;)
+    {
+        if (SkipWhiteSpace(filePtr) != LE_OK)
+        {
+            return isFirst ? LE_OUT_OF_RANGE : LE_FORMAT_ERROR;
+        }
+
+        isFirst = false;
+
+        int op = fgetc(filePtr);
+
+        if (op == JOURNAL_END)
+        {
+            return LE_OK;
+        }
+
+        if (   (   (op != JOURNAL_SET)
+                && (op != JOURNAL_DELETE))
+            || (ReadToken(filePtr, path, sizeof(path), &tokenType) != LE_OK)
+            || (tokenType != TT_STRING_VALUE)
+            || (path[0] != '/'))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        if (op == JOURNAL_SET)
+        {
+            // When only checking, read the value into a scratch node.
+            tdb_NodeRef_t nodeRef = apply ? FindJournalNode(rootRef, path, true) : NewNode();
+
+            if (nodeRef == NULL)
+            {
+                LE_ERROR("Bad node path in config tree journal, '%s'.", path);
+                return LE_FORMAT_ERROR;
+            }
+
+            le_result_t result = InternalReadNode(nodeRef, filePtr, strlen(path) + 1);
+
+            if (apply == false)
+            {
+                le_mem_Release(nodeRef);
+            }
+
+            if (result != LE_OK)
+            {
+                return LE_FORMAT_ERROR;
+            }
+        }
+        else
+        {
+            tdb_NodeRef_t nodeRef = apply ? FindJournalNode(rootRef, path, false) : NULL;
+
+            if (nodeRef == rootRef)
+            {
+                tdb_SetEmpty(nodeRef);
+                ClearModifiedFlag(nodeRef);
+            }
+            else if (nodeRef != NULL)
+            {
+                le_mem_Release(nodeRef);
+            }
+        }
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Apply the journal of the tree's current tree file to the tree, if there is one.  The end of the
+ *  journal is cut off if it holds an incomplete transaction, and the whole journal is deleted if it
+ *  doesn't apply to the tree file that was loaded.
+ */
+// -------------------------------------------------------------------------------------------------
+static void ReplayJournal
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree to update.  Its tree file must already be loaded.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char journalPath[LE_CFG_STR_LEN_BYTES] = "";
+    GetJournalPath(treeRef->name, treeRef->revisionId, journalPath, sizeof(journalPath));
+
+    treeRef->journalSize = 0;
+
+    FILE* filePtr = (journalPath[0] != '\0') ? fopen(journalPath, "r") : NULL;
+
+    if (filePtr == NULL)
+    {
+        return;
+    }
+
+    // Make sure that the journal was written for the tree file that was just loaded.
+    char inodeStr[SMALL_STR] = "";
+    char sizeStr[SMALL_STR] = "";
+    char expectedInodeStr[SMALL_STR] = "";
+    char expectedSizeStr[SMALL_STR] = "";
+    TokenType_t inodeType = TT_EMPTY_VALUE;
+    TokenType_t sizeType = TT_EMPTY_VALUE;
+
+    snprintf(expectedInodeStr, sizeof(expectedInodeStr), "%ju", (uintmax_t)treeRef->fileInode);
+    snprintf(expectedSizeStr, sizeof(expectedSizeStr), "%jd", (intmax_t)treeRef->fileSize);
+
+    if (   (ReadToken(filePtr, inodeStr, sizeof(inodeStr), &inodeType) != LE_OK)
+        || (ReadToken(filePtr, sizeStr, sizeof(sizeStr), &sizeType) != LE_OK)
+        || (inodeType != TT_INT_VALUE)
+        || (sizeType != TT_INT_VALUE)
+        || (strcmp(inodeStr, expectedInodeStr) != 0)
+        || (strcmp(sizeStr, expectedSizeStr) != 0))
+    {
+        LE_WARN("Discarding config tree journal '%s', it doesn't match the tree file.",
+                journalPath);
+
+        fclose(filePtr);
+        DeleteJournal(treeRef->name, treeRef->revisionId);
+        return;
+    }
+
+    // Check each transaction before applying it, so that a partially written one is left out.
+    size_t count = 0;
+    long endPos = ftell(filePtr);
+    le_result_t result;
+
+    while ((result = ReadJournalTransaction(treeRef->rootNodeRef, filePtr, false)) == LE_OK)
+    {
+        long nextPos = ftell(filePtr);
+
+        LE_ASSERT(fseek(filePtr, endPos, SEEK_SET) == 0);
+        LE_ASSERT(ReadJournalTransaction(treeRef->rootNodeRef, filePtr, true) == LE_OK);
+
+        endPos = nextPos;
+        count++;
+    }
+
+    fclose(filePtr);
+
+    if (result != LE_OUT_OF_RANGE)
+    {
+        LE_WARN("Discarding incomplete transaction at the end of config tree journal '%s'.",
+                journalPath);
+
+        if (truncate(journalPath, endPos) != 0)
+        {
+            LE_ERROR("Could not truncate '%s' (%m).", journalPath);
+        }
+    }
+
+    treeRef->journalSize = endPos;
+
+    LE_DEBUG("** Replayed %zu transactions from config tree journal '%s'.", count, journalPath);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Attempt to load a configuration tree from a config file.  This function will look for the latest
+ *  valid version of the config file and load that one.
+ */
+// -------------------------------------------------------------------------------------------------
+static void LoadTree
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree object to load from the filesystem.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // If we don't know the revision then hunt it out from the filesystem.
+    if (treeRef->revisionId == 0)
+    {
+        UpdateRevision(treeRef);
+    }
+
+    // If this tree has no root, create it now.
+    if (treeRef->rootNodeRef == NULL)
+    {
+        treeRef->rootNodeRef = NewNode();
+    }
+
+    // Ok, if we found a valid revision of the tree in the fs, try to load it now.
+    if (treeRef->revisionId != 0)
+    {
+        char pathPtr[LE_CFG_STR_LEN_BYTES] = "";
+        GetTreePath(treeRef->name, treeRef->revisionId, pathPtr, sizeof(pathPtr));
+
+        LE_DEBUG("** Loading configuration tree from '%s'.", pathPtr);
+
+        int fileRef = -1;
+
+        do
+        {
+            fileRef = open(pathPtr, O_RDONLY);
+        }
+        while ((fileRef == -1) && (errno == EINTR));
+
+        tdb_EnsureExists(treeRef->rootNodeRef);
+
+        if (fileRef == -1)
+        {
+            LE_ERROR("Could not open configuration tree file: %s, reason: %s",
+                     pathPtr,
+                     strerror(errno));
+        }
+        else
+        {
+            if (tdb_ReadTreeNode(treeRef->rootNodeRef, fileRef) == false)
+            {
+                LE_ERROR("Could not parse configuration tree file: %s.", pathPtr);
+                le_mem_Release(treeRef->rootNodeRef);
+                treeRef->rootNodeRef = NewNode();
+            }
+            else
+            {
+                // Bring the tree up to date with the changes committed since the file was written.
+                UpdateFileInfo(treeRef);
+                ReplayJournal(treeRef);
+            }
+
+            int retVal = -1;
+
+            do
+            {
+                retVal = close(fileRef);
+            }
+            while ((retVal == -1) && (errno == EINTR));
+        }
+    }
+
+    // Journals are only ever kept for the tree file in use, so any others were left behind by an
+    // interrupted compaction.
+    for (int id = 1; id <= 3; id++)
+    {
+        if (   (id != treeRef->revisionId)
+            || (treeRef->fileInode == 0))
+        {
+            DeleteJournal(treeRef->name, id);
+        }
+    }
+}
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Removes the handler object from the given registration object.  This function will also free the
+ *  memory that the handler object had used.
+ */
+// -------------------------------------------------------------------------------------------------
+static void RemoveHandler
+(
+    Registration_t* registrationPtr,  ///< [IN] The registration object to remove the link from.
+    Handler_t* handlerPtr             ///< [IN] The handler object we're removing.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // Kill the ref, and remove the object from the registration list.
+    le_ref_DeleteRef(HandlerSafeRefMap, handlerPtr->safeRef);
+    le_dls_Remove(&registrationPtr->handlerList, &handlerPtr->link);
+
+    // Clear out the link data, just to be safe.
+    handlerPtr->link = LE_DLS_LINK_INIT;
+    handlerPtr->sessionRef = NULL;
+    handlerPtr->registrationPtr = NULL;
+    handlerPtr->safeRef = NULL;
+
+    // Finally kill the object.
+    le_mem_Release(handlerPtr);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  This function is called by the hash map ForEach function, which is invoked when a session closed
+ *  event occurs.
+ *
+ *  This function takes care of cleaning out orphaned event handlers from the registration objects
+ *  currently stored in the registration hash map.  If a given registration handler is no longer
+ *  required then the object itself is queued for deletion.  It is queued and not deleted in place
+ *  because the hash map does not support deleting objects in the middle of an iteration.
+ *
+ *  @return True.  This function always returns true to indicate that iteration should continue
+ *          until the end of the hash map.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool OnHandlerRegistrationCleanup
+(
+    const void* keyPtr,    ///< [IN] The key used by this hash entry.
+    const void* valuePtr,  ///< [IN] The registration object.
+    void* contextPtr       ///< [IN] Context info including the ref for the session that closed.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // Convert our pointers into something useable.
+    Registration_t* registrationPtr = (Registration_t*)valuePtr;
+    CleanUpContext_t* cleanUpContextPtr = (CleanUpContext_t*)contextPtr;
+
+    // Go through this registration object's list of update handlers and check to see if they were
+    // registered on the target session.  If so, free them from the list.
+    le_dls_Link_t* linkPtr = le_dls_Peek(&registrationPtr->handlerList);
+
+    while (linkPtr != NULL)
+    {
+        Handler_t* handlerObjectPtr = CONTAINER_OF(linkPtr, Handler_t, link);
+        linkPtr = le_dls_PeekNext(&registrationPtr->handlerList, linkPtr);
+
+        if (handlerObjectPtr->sessionRef == cleanUpContextPtr->sessionRef)
+        {
+            RemoveHandler(registrationPtr, handlerObjectPtr);
+        }
+    }
+
+    // Now, check to see if there are any handlers left in this object.  If the registration object
+    // is empty, then queue it for deletion.
+    if (le_dls_IsEmpty(&registrationPtr->handlerList))
+    {
+        registrationPtr->link = LE_SLS_LINK_INIT;
+        le_sls_Queue(&cleanUpContextPtr->deleteQueue, &registrationPtr->link);
+    }
+
+    // We want to continue iterating through the collection.
+    return true;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Call this function to delete a tree file from the filesystem.
+ */
+// -------------------------------------------------------------------------------------------------
+static void DeleteTreeFile
+(
+    const char* filePathPtr  ///< Path to the tree file in question.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_DEBUG("** Deleting tree file, '%s'.", filePathPtr);
+
+    if (unlink(filePathPtr) != 0)
+    {
+        LE_ERROR("File delete failure, '%s', reason '%m'.", filePathPtr);
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Add a change to the list of changes to write to a tree's journal.  Deletions are put before all
+ *  other changes, so that a node renamed over a deleted one isn't deleted in its turn on replay.
+ */
+// -------------------------------------------------------------------------------------------------
+static void AddJournalChange
+(
+    le_sls_List_t* listPtr,  ///< [IN] The list of changes to update.
+    JournalOp_t op,          ///< [IN] What kind of change.
+    const char* pathPtr      ///< [IN] Absolute path to the changed node.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    JournalChange_t* changePtr = le_mem_ForceAlloc(JournalChangePool);
+
+    changePtr->link = LE_SLS_LINK_INIT;
+    changePtr->op = op;
+    LE_ASSERT(le_utf8_Copy(changePtr->path, pathPtr, sizeof(changePtr->path), NULL) == LE_OK);
+
+    if (op == JOURNAL_DELETE)
+    {
+        le_sls_Stack(listPtr, &changePtr->link);
+    }
+    else
+    {
+        le_sls_Queue(listPtr, &changePtr->link);
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Free all of the changes in a list of journal changes.
+ */
+// -------------------------------------------------------------------------------------------------
+static void ReleaseJournalChanges
+(
+    le_sls_List_t* listPtr  ///< [IN] The list of changes to free.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_sls_Link_t* linkPtr;
+
+    while ((linkPtr = le_sls_Pop(listPtr)) != NULL)
+    {
+        le_mem_Release(CONTAINER_OF(linkPtr, JournalChange_t, link));
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Walk a shadow tree, before it is merged, and list the changes that the merge will make to the
+ *  original tree.  The walk stops at modified nodes, as the whole node will be written to the
+ *  journal.  Only the shadow nodes that were already created are visited, as any others can't have
+ *  been changed.
+ *
+ *  @return True if the changes could be listed, false if a path is too long to be journaled.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool CollectJournalChanges
+(
+    tdb_NodeRef_t nodeRef,   ///< [IN] The shadow node to check, along with its children.
+    char* pathPtr,           ///< [IN] Path to the node's parent, "" for the root.  The buffer must
+                             ///<      be LE_CFG_STR_LEN_BYTES long.  It is restored on return.
+    le_sls_List_t* listPtr   ///< [IN] The list to add the changes to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t parentLen = strlen(pathPtr);
+    char name[LE_CFG_NAME_LEN_BYTES] = "";
+    bool result = true;
+
+    if (nodeRef->parentRef == NULL)
+    {
+        if (IsModified(nodeRef))
+        {
+            AddJournalChange(listPtr, JOURNAL_SET, "/");
+            return true;
+        }
+    }
+    else
+    {
+        LE_ASSERT(tdb_GetNodeName(nodeRef, name, sizeof(name)) == LE_OK);
+
+        if (snprintf(pathPtr + parentLen,
+                     LE_CFG_STR_LEN_BYTES - parentLen,
+                     "/%s",
+                     name) >= (LE_CFG_STR_LEN_BYTES - parentLen))
+        {
+            pathPtr[parentLen] = '\0';
+            return false;
+        }
+    }
+
+    if (IsModified(nodeRef))
+    {
+        // Find the original node the same way that MergeNode() does.  If there's one, and it's
+        // being deleted or renamed, then its old path goes away.
+        tdb_NodeRef_t originalRef = nodeRef->shadowRef;
+
+        if (   (originalRef == NULL)
+            && (nodeRef->parentRef->shadowRef != NULL))
+        {
+            originalRef = GetNamedChild(nodeRef->parentRef->shadowRef, name);
+        }
+
+        if (   (originalRef != NULL)
+            && (   (IsDeleted(nodeRef) == true)
+                || (WasRenamed(nodeRef) == true)))
+        {
+            char originalName[LE_CFG_NAME_LEN_BYTES] = "";
+            char originalPath[LE_CFG_STR_LEN_BYTES] = "";
+
+            LE_ASSERT(tdb_GetNodeName(originalRef, originalName, sizeof(originalName)) == LE_OK);
+            snprintf(originalPath, sizeof(originalPath), "%.*s/%s",
+                     (int)parentLen, pathPtr, originalName);
+
+            AddJournalChange(listPtr, JOURNAL_DELETE, originalPath);
+        }
+
+        if (IsDeleted(nodeRef) == false)
+        {
+            AddJournalChange(listPtr, JOURNAL_SET, pathPtr);
+        }
+    }
+    else if (   (nodeRef->type == LE_CFG_TYPE_STEM)
+             && (IsDeleted(nodeRef) == false))
+    {
+        le_dls_Link_t* linkPtr = le_dls_Peek(&nodeRef->info.children);
+
+        while (   (linkPtr != NULL)
+               && (result == true))
+        {
+            result = CollectJournalChanges(CONTAINER_OF(linkPtr, Node_t, siblingList),
+                                           pathPtr,
+                                           listPtr);
+
+            linkPtr = le_dls_PeekNext(&nodeRef->info.children, linkPtr);
+        }
+    }
+
+    pathPtr[parentLen] = '\0';
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Append a merged transaction to the journal of the tree's current tree file.  The changes are
+ *  read from the tree itself, so this must be called after the merge.
+ *
+ *  @return LE_OK if the transaction was written, (or discarded because the file system is read
+ *          only.)
+ *          LE_OVERFLOW if the journal would grow too big, and so the tree file should be rewritten
+ *          instead.
+ *          LE_FAULT if the transaction couldn't be written.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t AppendJournal
+(
+    tdb_TreeRef_t treeRef,  ///< [IN] The tree that the transaction was merged into.
+    le_sls_List_t* listPtr  ///< [IN] The changes made by the transaction.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char* bufferPtr = NULL;
+    size_t bufferSize = 0;
+    le_result_t result = LE_OK;
+
+    // Build the whole entry in memory first, so that it can be checked against the size limit and
+    // then written to the journal in one go.
+    FILE* filePtr = open_memstream(&bufferPtr, &bufferSize);
+
+    if (filePtr == NULL)
+    {
+        LE_ERROR("Could not create journal entry buffer, reason: %m");
+        return LE_FAULT;
+    }
+
+    if (treeRef->journalSize == 0)
+    {
+        fprintf(filePtr, "[%ju] [%jd]\n", (uintmax_t)treeRef->fileInode, (intmax_t)treeRef->fileSize);
+    }
+
+    le_sls_Link_t* linkPtr = le_sls_Peek(listPtr);
+
+    while (   (linkPtr != NULL)
+           && (result == LE_OK))
+    {
+        JournalChange_t* changePtr = CONTAINER_OF(linkPtr, JournalChange_t, link);
+        const char opBuffer[2] = { changePtr->op, ' ' };
+
+        result = WriteFile(filePtr, opBuffer, sizeof(opBuffer));
+
+        if (result == LE_OK)
+        {
+            result = WriteStringValue(filePtr, '\"', '\"', changePtr->path);
+        }
+
+        if (   (result == LE_OK)
+            && (changePtr->op == JOURNAL_SET))
+        {
+            tdb_NodeRef_t nodeRef = FindJournalNode(treeRef->rootNodeRef, changePtr->path, false);
+
+            if (nodeRef == NULL)
+            {
+                LE_ERROR("Merged node '%s' not found in tree '%s'.", changePtr->path, treeRef->name);
+                result = LE_FAULT;
+            }
+            else
+            {
+                result = InternalWriteNode(nodeRef, filePtr);
+            }
+        }
+
+        linkPtr = le_sls_PeekNext(listPtr, linkPtr);
+    }
+
+    if (result == LE_OK)
+    {
+        result = WriteFile(filePtr, ";\n", 2);
+    }
+
+    if (fclose(filePtr) != 0)
+    {
+        result = LE_FAULT;
+    }
+
+    if (result != LE_OK)
+    {
+        free(bufferPtr);
+        return LE_FAULT;
+    }
+
+    // Once the journal outgrows the tree file, it's time to rewrite the tree file.
+    off_t maxSize = (treeRef->fileSize > JOURNAL_MIN_COMPACT_SIZE) ? treeRef->fileSize
+                                                                   : JOURNAL_MIN_COMPACT_SIZE;
+
+    if ((treeRef->journalSize + (off_t)bufferSize) > maxSize)
+    {
+        free(bufferPtr);
+        return LE_OVERFLOW;
+    }
+
+    char journalPath[LE_CFG_STR_LEN_BYTES] = "";
+    GetJournalPath(treeRef->name, treeRef->revisionId, journalPath, sizeof(journalPath));
+
+    int flags = O_WRONLY | O_CREAT | O_APPEND | ((treeRef->journalSize == 0) ? O_TRUNC : 0);
+    int fileRef = -1;
+
+    do
+    {
+        fileRef = open(journalPath, flags, S_IRUSR | S_IWUSR);
+    }
+    while (   (fileRef == -1)
+           && (errno == EINTR));
+
+    if (fileRef == -1)
     {
-        treeRef->revisionId = 1;
-    }
-}
+        free(bufferPtr);
 
+        if (errno == EROFS)
+        {
+            // In case we are R/O for the config tree, we discard the update to flash
+            return LE_OK;
+        }
 
+        LE_ERROR("Failed to open config tree journal '%s' (%m).", journalPath);
+        return LE_FAULT;
+    }
 
+    ssize_t written = -1;
 
-// -------------------------------------------------------------------------------------------------
-/**
- *  Attempt to load a configuration tree from a config file.  This function will look for the latest
- *  valid version of the config file and load that one.
- */
-// -------------------------------------------------------------------------------------------------
-static void LoadTree
-(
-    tdb_TreeRef_t treeRef  ///< [IN] The tree object to load from the filesystem.
-)
-// -------------------------------------------------------------------------------------------------
-{
-    // If we don't know the revision then hunt it out from the filesystem.
-    if (treeRef->revisionId == 0)
+    do
     {
-        UpdateRevision(treeRef);
+        written = write(fileRef, bufferPtr, bufferSize);
     }
+    while (   (written == -1)
+           && (errno == EINTR));
 
-    // If this tree has no root, create it now.
-    if (treeRef->rootNodeRef == NULL)
+    if (written == (ssize_t)bufferSize)
     {
-        treeRef->rootNodeRef = NewNode();
+        treeRef->journalSize += bufferSize;
     }
-
-    // Ok, if we found a valid revision of the tree in the fs, try to load it now.
-    if (treeRef->revisionId != 0)
+    else
     {
-        char pathPtr[LE_CFG_STR_LEN_BYTES] = "";
-        GetTreePath(treeRef->name, treeRef->revisionId, pathPtr, sizeof(pathPtr));
-
-        LE_DEBUG("** Loading configuration tree from '%s'.", pathPtr);
-
-        int fileRef = -1;
+        LE_ERROR("Failed to write to config tree journal '%s' (%m).", journalPath);
 
-        do
+        // Cut off whatever part of the entry made it to the file, so that it doesn't get in the
+        // way of the next one.
+        if (   (written > 0)
+            && (ftruncate(fileRef, treeRef->journalSize) != 0))
         {
-            fileRef = open(pathPtr, O_RDONLY);
+            LE_ERROR("Could not truncate '%s' (%m).", journalPath);
         }
-        while ((fileRef == -1) && (errno == EINTR));
 
-        tdb_EnsureExists(treeRef->rootNodeRef);
+        result = LE_FAULT;
+    }
 
-        if (fileRef == -1)
-        {
-            LE_ERROR("Could not open configuration tree file: %s, reason: %s",
-                     pathPtr,
-                     strerror(errno));
-        }
-        else
-        {
-            if (tdb_ReadTreeNode(treeRef->rootNodeRef, fileRef) == false)
-            {
-                LE_ERROR("Could not parse configuration tree file: %s.", pathPtr);
-                le_mem_Release(treeRef->rootNodeRef);
-                treeRef->rootNodeRef = NewNode();
-            }
+    free(bufferPtr);
 
-            int retVal = -1;
+    int retVal = -1;
 
-            do
-            {
-                retVal = close(fileRef);
-            }
-            while ((retVal == -1) && (errno == EINTR));
-        }
+    do
+    {
+        retVal = close(fileRef);
     }
+    while ((retVal == -1) && (errno == EINTR));
+
+    return result;
 }
 
 
 
+
 // -------------------------------------------------------------------------------------------------
 /**
- *  Removes the handler object from the given registration object.  This function will also free the
- *  memory that the handler object had used.
+ *  Write the whole tree to a new revision of its tree file, then delete the old revision and its
+ *  journal.
  */
 // -------------------------------------------------------------------------------------------------
-static void RemoveHandler
+static void WriteTreeFile
 (
-    Registration_t* registrationPtr,  ///< [IN] The registration object to remove the link from.
-    Handler_t* handlerPtr             ///< [IN] The handler object we're removing.
+    tdb_TreeRef_t treeRef  ///< [IN] The tree to write.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    // Kill the ref, and remove the object from the registration list.
-    le_ref_DeleteRef(HandlerSafeRefMap, handlerPtr->safeRef);
-    le_dls_Remove(&registrationPtr->handlerList, &handlerPtr->link);
+    // Increment revision of the tree and open a tree file for writing.
+    int oldId = treeRef->revisionId;
 
-    // Clear out the link data, just to be safe.
-    handlerPtr->link = LE_DLS_LINK_INIT;
-    handlerPtr->sessionRef = NULL;
-    handlerPtr->registrationPtr = NULL;
-    handlerPtr->safeRef = NULL;
+    IncrementRevision(treeRef);
 
-    // Finally kill the object.
-    le_mem_Release(handlerPtr);
-}
+    char filePath[LE_CFG_STR_LEN_BYTES] = "";
+    GetTreePath(treeRef->name, treeRef->revisionId, filePath, sizeof(filePath));
 
+    LE_DEBUG("Changes merged, now attempting to serialize the tree to '%s'.", filePath);
 
+    // The new tree file has no journal, so make sure that one isn't left over from an earlier use
+    // of this revision.
+    DeleteJournal(treeRef->name, treeRef->revisionId);
+    treeRef->fileInode = 0;
+    treeRef->fileSize = 0;
+    treeRef->journalSize = 0;
 
+    int fileRef = -1;
 
-// -------------------------------------------------------------------------------------------------
-/**
- *  This function is called by the hash map ForEach function, which is invoked when a session closed
- *  event occurs.
- *
- *  This function takes care of cleaning out orphaned event handlers from the registration objects
- *  currently stored in the registration hash map.  If a given registration handler is no longer
- *  required then the object itself is queued for deletion.  It is queued and not deleted in place
- *  because the hash map does not support deleting objects in the middle of an iteration.
- *
- *  @return True.  This function always returns true to indicate that iteration should continue
- *          until the end of the hash map.
- */
-// -------------------------------------------------------------------------------------------------
-static bool OnHandlerRegistrationCleanup
-(
-    const void* keyPtr,    ///< [IN] The key used by this hash entry.
-    const void* valuePtr,  ///< [IN] The registration object.
-    void* contextPtr       ///< [IN] Context info including the ref for the session that closed.
-)
-// -------------------------------------------------------------------------------------------------
-{
-    // Convert our pointers into something useable.
-    Registration_t* registrationPtr = (Registration_t*)valuePtr;
-    CleanUpContext_t* cleanUpContextPtr = (CleanUpContext_t*)contextPtr;
+    do
+    {
+        fileRef = open(filePath, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    }
+    while (   (fileRef == -1)
+           && (errno == EINTR));
 
-    // Go through this registration object's list of update handlers and check to see if they were
-    // registered on the target session.  If so, free them from the list.
-    le_dls_Link_t* linkPtr = le_dls_Peek(&registrationPtr->handlerList);
+    if ((-1 == fileRef) && (EROFS == errno))
+    {
+        // In case we are R/O for the config tree, we discard the update to flash
+        return;
+    }
 
-    while (linkPtr != NULL)
+    if (fileRef == -1)
     {
-        Handler_t* handlerObjectPtr = CONTAINER_OF(linkPtr, Handler_t, link);
-        linkPtr = le_dls_PeekNext(&registrationPtr->handlerList, linkPtr);
+        LE_EMERG("Failed to open config file '%s' (%m).", filePath);
+        LE_EMERG("Changes have been merged in memory, however they could not be committed to the "
+                 "filesystem!!");
+        return;
+    }
 
-        if (handlerObjectPtr->sessionRef == cleanUpContextPtr->sessionRef)
+    // We have a tree file to write to, so stream the new tree to it then close the output file.
+    le_result_t writeResult = tdb_WriteTreeNode(treeRef->rootNodeRef, fileRef);
+    int retVal = -1;
+
+    do
+    {
+        retVal = close(fileRef);
+    }
+    while ((retVal == -1) && (errno == EINTR));
+
+    LE_EMERG_IF(retVal == -1, "An error occurred while closing the tree file: %s", strerror(errno));
+
+
+    // Finally remove the old version of the tree file and its journal, if there is one.
+    if (writeResult == LE_OK)
+    {
+        if (oldId != 0)
         {
-            RemoveHandler(registrationPtr, handlerObjectPtr);
+            if (TreeFileExists(treeRef->name, oldId))
+            {
+                GetTreePath(treeRef->name, oldId, filePath, sizeof(filePath));
+                DeleteTreeFile(filePath);
+            }
+
+            DeleteJournal(treeRef->name, oldId);
         }
-    }
 
-    // Now, check to see if there are any handlers left in this object.  If the registration object
-    // is empty, then queue it for deletion.
-    if (le_dls_IsEmpty(&registrationPtr->handlerList))
+        UpdateFileInfo(treeRef);
+    }
+    else
     {
-        registrationPtr->link = LE_SLS_LINK_INIT;
-        le_sls_Queue(&cleanUpContextPtr->deleteQueue, &registrationPtr->link);
+        // The write failed, delete the new file we attempted to create.
+        LE_EMERG("The attempt to write to the config tree file, '%s,' failed.", filePath);
+        DeleteTreeFile(filePath);
     }
-
-    // We want to continue iterating through the collection.
-    return true;
 }
 
 
@@ -2614,21 +3850,28 @@ static bool OnHandlerRegistrationCleanup
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Call this function to delete a tree file from the filesystem.
+ *  Find the entry of the path lookup cache that a lookup of the given path would be cached in.
+ *
+ *  @return The cache entry, or NULL if the path is too long to be cached.
  */
 // -------------------------------------------------------------------------------------------------
-static void DeleteTreeFile
+static PathCacheEntry_t* GetPathCacheEntry
 (
-    const char* filePathPtr  ///< Path to the tree file in question.
+    tdb_NodeRef_t baseNodeRef,      ///< [IN] The node that the lookup starts from.
+    le_pathIter_Ref_t nodePathRef,  ///< [IN] The path being looked up.
+    char* pathPtr,                  ///< [OUT] Buffer to hold the path as a string.
+    size_t pathSize                 ///< [IN]  Size of the path buffer.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    LE_DEBUG("** Deleting tree file, '%s'.", filePathPtr);
-
-    if (unlink(filePathPtr) != 0)
+    if (le_pathIter_GetPath(nodePathRef, pathPtr, pathSize) != LE_OK)
     {
-        LE_ERROR("File delete failure, '%s', reason '%m'.", filePathPtr);
+        return NULL;
     }
+
+    size_t hash = le_hashmap_HashString(pathPtr) ^ le_hashmap_HashVoidPointer(baseNodeRef);
+
+    return &PathCache[hash & (PATH_CACHE_SIZE - 1)];
 }
 
 
@@ -2791,6 +4034,7 @@ void tdb_Init
 
     HandlerPool = le_mem_CreatePool(CFG_HANDLER_POOL_NAME, sizeof(Handler_t));
     RegistrationPool = le_mem_CreatePool(CFG_REGISTRATION_POOL_NAME, sizeof(Registration_t));
+    JournalChangePool = le_mem_CreatePool(CFG_JOURNAL_CHANGE_POOL_NAME, sizeof(JournalChange_t));
 
     // Preload the system tree.
     tdb_GetTree("system");
@@ -2864,6 +4108,8 @@ void tdb_DeleteTree
 
                 DeleteTreeFile(filePathPtr);
             }
+
+            DeleteJournal(treeRef->name, id);
         }
 
         LE_ASSERT(le_hashmap_Remove(TreeCollectionRef, treeRef->name) == treeRef);
@@ -3127,7 +4373,8 @@ le_sls_List_t* tdb_GetRequestQueue
 // -------------------------------------------------------------------------------------------------
 /**
  *  Merge a shadow tree into the original tree it was created from.  Once the change is merged the
- *  updated tree is serialized to the filesystem.
+ *  changed nodes are appended to the tree's journal, or the whole updated tree is serialized to the
+ *  filesystem if the journal has grown too big.
  */
 // -------------------------------------------------------------------------------------------------
 void tdb_MergeTree
@@ -3138,78 +4385,42 @@ void tdb_MergeTree
 {
     // Get our shadow tree's root node and merge it's changes into the real tree.  Create a path
     // iterator to track the merge and allow for update handlers to be called.
+    tdb_TreeRef_t originalTreeRef = shadowTreeRef->originalTreeRef;
     tdb_NodeRef_t nodeRef = shadowTreeRef->rootNodeRef;
-    le_pathIter_Ref_t pathRef = CreateBasePath(shadowTreeRef->originalTreeRef->name);
+    le_pathIter_Ref_t pathRef = CreateBasePath(originalTreeRef->name);
 
-    InternalMergeTree(shadowTreeRef->originalTreeRef->name, pathRef, nodeRef, false);
+    // Work out what the merge is going to change, so that only those changes need to be saved.
+    // That can only be done if there's a tree file for them to be applied to.
+    le_sls_List_t changeList = LE_SLS_LIST_INIT;
+    char path[LE_CFG_STR_LEN_BYTES] = "";
+    bool canJournal =    (originalTreeRef->fileInode != 0)
+                      && CollectJournalChanges(nodeRef, path, &changeList);
+
+    InternalMergeTree(originalTreeRef->name, pathRef, nodeRef, false);
     le_pathIter_Delete(pathRef);
 
     // Now, go through and call the triggered callbacks.
     FireTriggeredCallbacks();
 
-    // Now increment revision of the tree and open a tree file for writing.
-    tdb_TreeRef_t originalTreeRef = shadowTreeRef->originalTreeRef;
-    int oldId = originalTreeRef->revisionId;
-
-    IncrementRevision(originalTreeRef);
-
-    char filePath[LE_CFG_STR_LEN_BYTES] = "";
-    GetTreePath(originalTreeRef->name, originalTreeRef->revisionId, filePath, sizeof(filePath));
-
-    LE_DEBUG("Changes merged, now attempting to serialize the tree to '%s'.", filePath);
-
-    int fileRef = -1;
-
-    do
-    {
-        fileRef = open(filePath, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
-    }
-    while (   (fileRef == -1)
-           && (errno == EINTR));
-
-    if ((-1 == fileRef) && (EROFS == errno))
-    {
-        // In case we are R/O for the config tree, we discard the update to flash
-        return;
-    }
-
-    if (fileRef == -1)
-    {
-        LE_EMERG("Failed to open config file '%s' (%m).", filePath);
-        LE_EMERG("Changes have been merged in memory, however they could not be committed to the "
-                 "filesystem!!");
-        return;
-    }
-
-    // We have a tree file to write to, so stream the new tree to it then close the output file.
-    le_result_t writeResult = tdb_WriteTreeNode(originalTreeRef->rootNodeRef, fileRef);
-    int retVal = -1;
-
-    do
+    // Save the changes.  If they can't be appended to the journal, then write the whole tree.
+    if (canJournal)
     {
-        retVal = close(fileRef);
-    }
-    while ((retVal == -1) && (errno == EINTR));
-
-    LE_EMERG_IF(retVal == -1, "An error occurred while closing the tree file: %s", strerror(errno));
+        if (le_sls_IsEmpty(&changeList))
+        {
+            return;
+        }
 
+        le_result_t result = AppendJournal(originalTreeRef, &changeList);
+        ReleaseJournalChanges(&changeList);
 
-    // Finally remove the old version of the tree file, if there is one.
-    if (writeResult == LE_OK)
-    {
-        if (   (oldId != 0)
-            && (TreeFileExists(originalTreeRef->name, oldId)))
+        if (result == LE_OK)
         {
-            GetTreePath(originalTreeRef->name, oldId, filePath, sizeof(filePath));
-            DeleteTreeFile(filePath);
+            return;
         }
     }
-    else
-    {
-        // The write failed, delete the new file we attempted to create.
-        LE_EMERG("The attempt to write to the config tree file, '%s,' failed.", filePath);
-        DeleteTreeFile(filePath);
-    }
+
+    ReleaseJournalChanges(&changeList);
+    WriteTreeFile(originalTreeRef);
 }
 
 
@@ -3362,6 +4573,26 @@ tdb_NodeRef_t tdb_GetNode
     // Check to see if we're starting at the given node, or that node's root node.
     tdb_NodeRef_t currentRef = GetPathBaseNodeRef(baseNodeRef, nodePathRef);
 
+    // Check the cache for the trees used by read transactions.  Shadow trees are left out, as
+    // looking up a path in one can create new shadow nodes.
+    char path[LE_CFG_STR_LEN_BYTES] = "";
+    PathCacheEntry_t* entryPtr = NULL;
+
+    if (IsShadow(currentRef) == false)
+    {
+        entryPtr = GetPathCacheEntry(currentRef, nodePathRef, path, sizeof(path));
+
+        if (   (entryPtr != NULL)
+            && (entryPtr->generation == PathCacheGeneration)
+            && (entryPtr->baseNodeRef == currentRef)
+            && (strcmp(entryPtr->path, path) == 0))
+        {
+            return entryPtr->nodeRef;
+        }
+    }
+
+    tdb_NodeRef_t startRef = currentRef;
+
     // Now start moving along the path, moving the current node along as we go.  The called function
     // also deals with . and .. names in the path as well, returning the current and parent nodes
     // respectivly.
@@ -3386,6 +4617,17 @@ tdb_NodeRef_t tdb_GetNode
         }
     }
 
+    // Only nodes that were found are cached, as a node that doesn't exist yet can be created without
+    // moving the cache on to a new generation.
+    if (   (entryPtr != NULL)
+        && (currentRef != NULL))
+    {
+        entryPtr->generation = PathCacheGeneration;
+        entryPtr->baseNodeRef = startRef;
+        entryPtr->nodeRef = currentRef;
+        LE_ASSERT(le_utf8_Copy(entryPtr->path, path, sizeof(entryPtr->path), NULL) == LE_OK);
+    }
+
     // Finally return the last node we traversed to.
     return currentRef;
 }
@@ -3574,6 +4816,8 @@ le_result_t tdb_SetNodeName
 
     // Copy over the new name.  Note that we don't care if this node is a shadow node.  Coping over
     // the name is taken care of as part of the merge process.
+    RemoveFromChildIndex(nodeRef);
+
     if (nodeRef->nameRef == NULL)
     {
         nodeRef->nameRef = dstr_NewFromCstr(stringPtr);
@@ -3583,6 +4827,13 @@ le_result_t tdb_SetNodeName
         dstr_CopyFromCstr(nodeRef->nameRef, stringPtr);
     }
 
+    AddToChildIndex(nodeRef);
+
+    if (IsShadow(nodeRef) == false)
+    {
+        PathCacheGeneration++;
+    }
+
     // If this is a shadow node and this is the change that modified it, then try to get it's
     // children now.  This is done so that later when this node is merged the merge code doesn't end
     // up thinking that the child nodes where removed.
@@ -3708,6 +4959,8 @@ void tdb_SetEmpty
     // If this is a stem node, then go through and clear out the children.
     if (nodeRef->type == LE_CFG_TYPE_STEM)
     {
+        DeleteChildIndex(nodeRef);
+
         tdb_NodeRef_t childRef = tdb_GetFirstChildNode(nodeRef);
 
         while (childRef != NULL)
@@ -228,7 +228,8 @@ le_sls_List_t* tdb_GetRequestQueue
 // -------------------------------------------------------------------------------------------------
 /**
  *  Merge a shadow tree into the original tree it was created from.  Once the change is merged the
- *  updated tree is serialized to the filesystem.
+ *  changed nodes are appended to the tree's journal, or the whole updated tree is serialized to the
+ *  filesystem if the journal has grown too big.
  */
 // -------------------------------------------------------------------------------------------------
 void tdb_MergeTree
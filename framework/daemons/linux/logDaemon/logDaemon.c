@@ -59,6 +59,11 @@
  * running process that belongs to an IPC session reference when the IPC system reports that
  * a session closed.  This is how the Log Control Daemon finds out that a client process died.
  *
+ * Once a client process has registered its log sessions, it hands the Log Control Daemon a shared
+ * memory ring that it puts its log messages in (see logShm.h).  Those messages, and whatever
+ * application processes write to their standard out and standard error, go through the log
+ * routing engine (see logRouter.c) on their way to syslog and the other log sinks.
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 
@@ -67,6 +72,7 @@
 #include "logDaemon.h"
 #include "limit.h"
 #include "fileDescriptor.h"
+#include "logRouter.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -223,10 +229,8 @@ typedef struct
     pid_t               pid;            ///< The process ID.
     le_msg_SessionRef_t ipcSessionRef;  ///< Reference to the IPC session connected to this process.
     le_dls_List_t       logSessionList; ///< List of log sessions in this process.
-/* TODO: Implement shared memory.
-    void*               sharedMemAddr;  ///< Address of base of memory region shared with
-                                        ///  this process.
- */
+    logRouter_SourceRef_t sourceRef;    ///< Source of messages from this process's shared memory
+                                        ///  ring (NULL if the process hasn't attached one).
 }
 RunningProcess_t;
 
@@ -301,6 +305,24 @@ static le_mem_PoolRef_t TracePoolRef;
                                 - LIMIT_MAX_COMPONENT_NAME_LEN )
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes read from an application process's standard out or standard error at a
+ * time.  Big enough to take in a whole pipe-buffer's worth of short lines per wake-up.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FD_LOG_READ_BYTES       4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time (in ms) that the start of a line is held back, waiting for the rest of the line, before it
+ * is logged on its own.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FD_LOG_PARTIAL_LINE_MS  100
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * File descriptor logging object.
@@ -315,24 +337,31 @@ typedef struct
     int             pid;                                    ///< PID of the process.
     le_log_Level_t  level;                                  ///< Log level.
     le_fdMonitor_Ref_t monitorRef;                          ///< Monitor object.
+    logRouter_SourceRef_t sourceRef;                        ///< Source the messages are routed as.
+    le_timer_Ref_t  partialLineTimer;                       ///< Logs a partial line on its own.
+    size_t          partialLineLen;                         ///< Length of the partial line.
+    char            partialLine[LOG_MAX_MSG_SIZE];          ///< Start of a line whose end hasn't
+                                                            ///  been read yet (not terminated).
 }
 FdLog_t;
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Pool for file descriptor logging objects.
+ * Buffer that application processes' standard out and standard error are read into.  Only one is
+ * needed, as the data is routed before the next file descriptor is read.  Room is left at the
+ * start for a partial line left over from the previous read.
  */
 //--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t FdLogPoolRef;
+static char FdLogReadBuffer[LOG_MAX_MSG_SIZE + FD_LOG_READ_BYTES];
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Maximum length of log messages.
+ * Pool for file descriptor logging objects.
  */
 //--------------------------------------------------------------------------------------------------
-#define MAX_MSG_SIZE            256
+static le_mem_PoolRef_t FdLogPoolRef;
 
 
 
@@ -730,7 +759,7 @@ static RunningProcess_t* CreateRunningProcess
 
     objPtr->pid = pid;
     objPtr->ipcSessionRef = ipcSessionRef;
-//    objPtr->sharedMemAddr = NULL;   // TODO: Implement shared memory.
+    objPtr->sourceRef = NULL;
 
     le_hashmap_Put(ProcessIdMapRef, &objPtr->pid, objPtr);
     le_hashmap_Put(IpcSessionMapRef, &objPtr->ipcSessionRef, objPtr);
@@ -951,8 +980,8 @@ static bool ParseCmdPacket
     }
     packetPtr++;
 
-    // The "list" command has no parameters.
-    if (commandCode == LOG_CMD_LIST_COMPONENTS)
+    // The "list" and "stream" commands have no parameters.
+    if ((commandCode == LOG_CMD_LIST_COMPONENTS) || (commandCode == LOG_CMD_STREAM))
     {
         return true;
     }
@@ -1498,6 +1527,12 @@ static void ClientIpcSessionClosed
         le_mem_Release(logSessionPtr);
     }
 
+    // Route whatever the process logged last before it went away.
+    if (runningProcObjPtr->sourceRef != NULL)
+    {
+        logRouter_DeleteSource(runningProcObjPtr->sourceRef);
+    }
+
     // Remove the process from the list of processes with this name.
     le_dls_Remove(&procNameObjPtr->runningProcessesList,
                   &runningProcObjPtr->link);
@@ -2458,6 +2493,106 @@ static void ForgetProcess
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets (or, given "off", clears) the file that log messages are written to.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetLogFile
+(
+    const char* pathPtr,
+    le_msg_SessionRef_t toolIpcSessionRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char message[PATH_MAX + 64];
+
+    if (strcmp(pathPtr, "off") == 0)
+    {
+        logRouter_SetFile(NULL);
+        SendToLogTool(toolIpcSessionRef, "Not writing log messages to a file.");
+    }
+    else if (logRouter_SetFile(pathPtr) == LE_OK)
+    {
+        snprintf(message, sizeof(message), "Writing log messages to '%s'.", pathPtr);
+        SendToLogTool(toolIpcSessionRef, message);
+    }
+    else
+    {
+        snprintf(message, sizeof(message), "***ERROR: Can't write log messages to '%s'.", pathPtr);
+        SendToLogTool(toolIpcSessionRef, message);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle the closing of a log control tool's IPC session.  Stops streaming to it, if it was
+ * streaming the log.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ControlToolSessionClosed
+(
+    le_msg_SessionRef_t ipcSessionRef,
+    void* contextPtr    // not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    logRouter_RemoveStream(ipcSessionRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Attaches a client process's shared memory log ring and responds with the ring's doorbell.  If
+ * the ring can't be attached, the response carries no doorbell and the client keeps logging to
+ * syslog directly.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void AttachRing
+(
+    const char* processName,
+    const char* pidStr,
+    le_msg_MessageRef_t msgRef      ///< [IN] Attach command message (responded to).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int memFd = le_msg_GetFd(msgRef);
+    RunningProcess_t* runningProcObjPtr = FindProcessByIpcSession(le_msg_GetSession(msgRef));
+
+    if (memFd < 0)
+    {
+        LE_ERROR("No shared memory in log ring attach request from '%s'.", processName);
+    }
+    else if (   (runningProcObjPtr == NULL)
+             || (runningProcObjPtr->pid != StringToPid(pidStr))
+             || (strcmp(runningProcObjPtr->procNameObjPtr->name, processName) != 0) )
+    {
+        LE_ERROR("Log ring attach request from unregistered process '%s[%s]'.",
+                 processName,
+                 pidStr);
+        fd_Close(memFd);
+    }
+    else
+    {
+        if (runningProcObjPtr->sourceRef == NULL)
+        {
+            runningProcObjPtr->sourceRef = logRouter_CreateSource(processName,
+                                                                  runningProcObjPtr->pid);
+        }
+
+        int doorbellFd;
+
+        if (logRouter_AttachRing(runningProcObjPtr->sourceRef, memFd, &doorbellFd) == LE_OK)
+        {
+            le_msg_SetFd(msgRef, doorbellFd);
+        }
+    }
+
+    le_msg_Respond(msgRef);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Process a message received from a connected log session client.
@@ -2491,11 +2626,19 @@ static void ClientMsgReceiveHandler
 
                 return;
 
+            case LOG_CMD_ATTACH_RING:
+
+                AttachRing(processName, commandDataPtr, msgRef);
+
+                return;
+
             case LOG_CMD_SET_LEVEL:
             case LOG_CMD_ENABLE_TRACE:
             case LOG_CMD_DISABLE_TRACE:
             case LOG_CMD_LIST_COMPONENTS:
             case LOG_CMD_FORGET_PROCESS:
+            case LOG_CMD_STREAM:
+            case LOG_CMD_SET_FILE:
 
                 LE_ERROR("Client attempted to issue a log control command (%c)!", command);
 
@@ -2566,6 +2709,7 @@ static void ControlToolMsgReceiveHandler
                 break;
 
             case LOG_CMD_REG_COMPONENT:
+            case LOG_CMD_ATTACH_RING:
 
                 LE_ERROR("Unexpected command '%c' from log control tool.", command);
 
@@ -2583,6 +2727,20 @@ static void ControlToolMsgReceiveHandler
 
                 break;
 
+            case LOG_CMD_STREAM:
+
+                // The session stays open; log messages are sent on it until the tool closes it.
+                logRouter_AddStream(ipcSessionRef);
+                le_msg_ReleaseMsg(msgRef);
+
+                return;
+
+            case LOG_CMD_SET_FILE:
+
+                SetLogFile(commandDataPtr, ipcSessionRef);
+
+                break;
+
             default:
 
                 LE_ERROR("Unknown command byte '%c' received from log control tool.", command);
@@ -2599,7 +2757,128 @@ static void ControlToolMsgReceiveHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Deletes the fd log object and monitor.  Closes the associated fd.
+ * Routes one line (or piece of a line) read from an application process's standard out or standard
+ * error.  Lines too long for a log message are split.  A blank line is logged as an empty message.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RouteFdLine
+(
+    FdLog_t* fdLogPtr,
+    const char* linePtr,        ///< [IN] Start of the line (not terminated).
+    size_t lineLen,             ///< [IN] Length of the line, without the line break.
+    time_t timestamp
+)
+{
+    logShm_Slot_t msg;
+
+    // Drop the carriage return of DOS-style line breaks.
+    if ((lineLen > 0) && (linePtr[lineLen - 1] == '\r'))
+    {
+        lineLen--;
+    }
+
+    // Only the message text varies, so only clear what the router looks at.
+    msg.timestamp = timestamp;
+    msg.level = fdLogPtr->level;
+    msg.lineNumber = 0;
+    msg.keyword[0] = '\0';
+    msg.compName[0] = '\0';
+    msg.threadName[0] = '\0';
+    msg.fileName[0] = '\0';
+    msg.funcName[0] = '\0';
+
+    do
+    {
+        size_t pieceLen = (lineLen < sizeof(msg.msg)) ? lineLen : (sizeof(msg.msg) - 1);
+
+        memcpy(msg.msg, linePtr, pieceLen);
+        msg.msg[pieceLen] = '\0';
+
+        // TODO: Don't log the app name for now so that it matches all the other log formats.
+        //       Add the app name to all log messages at the same time.
+        logRouter_Route(fdLogPtr->sourceRef, &msg);
+
+        linePtr += pieceLen;
+        lineLen -= pieceLen;
+    }
+    while (lineLen > 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Routes the lines in a buffer of data read from an application process's standard out or
+ * standard error, all in one batch.  What follows the last line break is kept as the fd log's
+ * partial line, unless isFinal is true.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RouteFdData
+(
+    FdLog_t* fdLogPtr,
+    const char* dataPtr,        ///< [IN] Data, starting with the previous partial line.
+    size_t dataLen,             ///< [IN] Number of bytes of data.
+    bool isFinal                ///< [IN] true if no more data will follow.
+)
+{
+    const char* endPtr = dataPtr + dataLen;
+    time_t now = time(NULL);
+
+    logRouter_StartBatch();
+
+    // memchr() is vectorized by the C library, so scanning for line breaks costs a small fraction
+    // of a byte-by-byte loop.
+    const char* lineBreakPtr;
+    while ((lineBreakPtr = memchr(dataPtr, '\n', endPtr - dataPtr)) != NULL)
+    {
+        RouteFdLine(fdLogPtr, dataPtr, lineBreakPtr - dataPtr, now);
+        dataPtr = lineBreakPtr + 1;
+    }
+
+    // Whatever doesn't fit in a message won't be joined with what follows anyway.
+    size_t partialLen = endPtr - dataPtr;
+    size_t keepLen = isFinal ? 0 : (partialLen % (sizeof(fdLogPtr->partialLine) - 1));
+
+    if (partialLen > keepLen)
+    {
+        RouteFdLine(fdLogPtr, dataPtr, partialLen - keepLen, now);
+    }
+
+    logRouter_EndBatch();
+
+    memcpy(fdLogPtr->partialLine, endPtr - keepLen, keepLen);
+    fdLogPtr->partialLineLen = keepLen;
+
+    if (keepLen == 0)
+    {
+        le_timer_Stop(fdLogPtr->partialLineTimer);
+    }
+    else if (!le_timer_IsRunning(fdLogPtr->partialLineTimer))
+    {
+        le_timer_Start(fdLogPtr->partialLineTimer);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Logs a partial line that has been waiting too long for the rest of the line.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PartialLineTimerExpired
+(
+    le_timer_Ref_t timerRef
+)
+{
+    FdLog_t* fdLogPtr = le_timer_GetContextPtr(timerRef);
+
+    RouteFdData(fdLogPtr, fdLogPtr->partialLine, fdLogPtr->partialLineLen, true);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes the fd log object and monitor.  Closes the associated fd.  Any partial line is logged
+ * first.
  */
 //--------------------------------------------------------------------------------------------------
 static void DeleteFdLog
@@ -2608,9 +2887,18 @@ static void DeleteFdLog
     FdLog_t* fdLogPtr           ///< [IN] Fd log object to delete.
 )
 {
+    if (fdLogPtr->partialLineLen > 0)
+    {
+        RouteFdData(fdLogPtr, fdLogPtr->partialLine, fdLogPtr->partialLineLen, true);
+    }
+
     // Delete the fd monitor.
     le_fdMonitor_Delete(fdLogPtr->monitorRef);
 
+    le_timer_Delete(fdLogPtr->partialLineTimer);
+
+    logRouter_DeleteSource(fdLogPtr->sourceRef);
+
     // Close the fd.
     fd_Close(fd);
 
@@ -2621,7 +2909,11 @@ static void DeleteFdLog
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Logs message received from the fd.
+ * Logs messages received from the fd, one per line.
+ *
+ * Everything that is waiting in the pipe (up to FD_LOG_READ_BYTES) is read with a single system
+ * call and routed as one batch, so a chatty process costs one read and one log file write per
+ * wake-up rather than per line.
  */
 //--------------------------------------------------------------------------------------------------
 static void LogFdMessages
@@ -2634,14 +2926,15 @@ static void LogFdMessages
 
     if (events & POLLIN)
     {
-        // Read the data from the fd.
-        char msg[MAX_MSG_SIZE] = {'\0'};
+        // Put the partial line left over from last time in front of the new data.
+        size_t partialLen = fdLogPtr->partialLineLen;
+        memcpy(FdLogReadBuffer, fdLogPtr->partialLine, partialLen);
 
-        int c;
+        ssize_t c;
 
         do
         {
-            c = read(fd, msg, sizeof(msg));
+            c = read(fd, FdLogReadBuffer + partialLen, FD_LOG_READ_BYTES);
         }
         while ( (c == -1) && (errno == EINTR) );
 
@@ -2651,15 +2944,19 @@ static void LogFdMessages
                      fdLogPtr->appName, fdLogPtr->procName, fdLogPtr->pid);
 
             DeleteFdLog(fd, fdLogPtr);
+            return;
         }
 
-        // Log the data.
-        // TODO: Don't log the app name for now so that it matches all the other log formats.  Add
-        //       the app name to all log messages at the same time.
-        log_LogGenericMsg(fdLogPtr->level, fdLogPtr->procName, fdLogPtr->pid, msg);
+        if (c > 0)
+        {
+            RouteFdData(fdLogPtr, FdLogReadBuffer, partialLen + c, false);
+
+            // Anything else (e.g., a hang-up) will be seen once the pipe has been drained.
+            return;
+        }
     }
 
-    if ( (events & POLLRDHUP) || (events & POLLERR) || (events & POLLHUP) )
+    if ( (events & POLLIN) || (events & POLLRDHUP) || (events & POLLERR) || (events & POLLHUP) )
     {
         LE_DEBUG("Error on app/proc '%s/%s' log fd, events=%d.  Cannot log from this fd.",
                 fdLogPtr->appName, fdLogPtr->procName, events);
@@ -2699,6 +2996,14 @@ static void CreateFdLogMonitor
 
     fdLogPtr->level = logLevel;
     fdLogPtr->pid = pid;
+    fdLogPtr->sourceRef = logRouter_CreateSource(procNamePtr, pid);
+    fdLogPtr->partialLineLen = 0;
+
+    fdLogPtr->partialLineTimer = le_timer_Create(monitorNamePtr);
+    le_timer_SetMsInterval(fdLogPtr->partialLineTimer, FD_LOG_PARTIAL_LINE_MS);
+    le_timer_SetHandler(fdLogPtr->partialLineTimer, PartialLineTimerExpired);
+    le_timer_SetContextPtr(fdLogPtr->partialLineTimer, fdLogPtr);
+    le_timer_SetWakeup(fdLogPtr->partialLineTimer, false);
 
     // Create the fd monitor.
     fdLogPtr->monitorRef = le_fdMonitor_Create(monitorNamePtr, fd, LogFdMessages, 0);
@@ -2826,6 +3131,8 @@ COMPONENT_INIT
                                           ProcessIdHash,
                                           ProcessIdEquals);
 
+    logRouter_Init();
+
     // Get a reference to the Log Control Protocol identification.
     le_msg_ProtocolRef_t protocolRef = le_msg_GetProtocolRef(LOG_CONTROL_PROTOCOL_ID,
                                                              LOG_MAX_CMD_PACKET_BYTES);
@@ -2839,6 +3146,7 @@ COMPONENT_INIT
     // Create and advertise the log control service (the one the control tool uses).
     serviceRef = le_msg_CreateService(protocolRef, LOG_CONTROL_SERVICE_NAME);
     le_msg_SetServiceRecvHandler(serviceRef, ControlToolMsgReceiveHandler, NULL);
+    le_msg_AddServiceCloseHandler(serviceRef, ControlToolSessionClosed, NULL);
     le_msg_AdvertiseService(serviceRef);
 
     // Close the fd that we inherited from the Supervisor.  This will let the Supervisor know that
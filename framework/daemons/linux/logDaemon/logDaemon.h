@@ -94,6 +94,9 @@
  */
 //--------------------------------------------------------------------------------------------------
 #define LOG_CMD_REG_COMPONENT           'r' // CommandData = string containing the process ID.
+#define LOG_CMD_ATTACH_RING             'm' // No ComponentName. CommandData = process ID.
+                                            // The message carries the ring's memfd (see
+                                            // logShm.h); the response carries the doorbell.
 
 
 //--------------------------------------------------------------------------------------------------
@@ -103,6 +106,9 @@
 //--------------------------------------------------------------------------------------------------
 #define LOG_CMD_LIST_COMPONENTS         'c' // No ProcessName, ComponentName, or CommandData
 #define LOG_CMD_FORGET_PROCESS          'x' // No ComponentName or CommandData
+#define LOG_CMD_STREAM                  's' // No ProcessName, ComponentName, or CommandData
+#define LOG_CMD_SET_FILE                'f' // ProcessName and ComponentName are "*".
+                                            // CommandData = file path, or "off".
 
 
 // =======================================================
@@ -0,0 +1,108 @@
+/** @file logHistory.h
+ *
+ * Layout of the Log Control Daemon's in-RAM log history.
+ *
+ * The Log Control Daemon keeps a copy of the last LOG_HISTORY_SLOT_COUNT messages that it routed
+ * in a ring of fixed-size, already formatted lines, in a file on tmpfs.  Because the file outlives
+ * the processes that logged the messages (and the Log Control Daemon itself), the log tool can
+ * read back what was logged just before a crash with "log dump", without any help from the Log
+ * Control Daemon and without taking any locks.
+ *
+ * The Log Control Daemon is the only writer.  Message number n goes in slot (n % slotCount).  The
+ * slot's sequence number is cleared while the line is being written and set to (n + 1) once it is
+ * complete, so a reader skips slots that are being written, or that got overwritten while it was
+ * copying them.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LOG_HISTORY_INCLUDE_GUARD
+#define LOG_HISTORY_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path of the log history file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_HISTORY_PATH        "/tmp/legato/logHistory"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of the magic number at the start of the log history ("LELH").
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_HISTORY_MAGIC       0x484C454C
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of lines kept in the log history.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_HISTORY_SLOT_COUNT  512
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of a line in the log history, including the null terminator.  Longer lines are
+ * truncated.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_HISTORY_LINE_BYTES  380
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of the log history file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t magic;         ///< LOG_HISTORY_MAGIC.
+    uint32_t slotCount;     ///< LOG_HISTORY_SLOT_COUNT.
+    uint32_t slotSize;      ///< sizeof(logHistory_Slot_t).
+    uint32_t lineCount;     ///< Number of lines written so far.
+}
+logHistory_Header_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A line in the log history.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t seq;                           ///< Line number + 1, or 0 while being written.
+    char     line[LOG_HISTORY_LINE_BYTES];  ///< Formatted line (null-terminated).
+}
+logHistory_Slot_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the log history file, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_HISTORY_FILE_BYTES \
+            (sizeof(logHistory_Header_t) + (LOG_HISTORY_SLOT_COUNT * sizeof(logHistory_Slot_t)))
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a pointer to the slot that a line number goes in.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline logHistory_Slot_t* logHistory_GetSlotPtr
+(
+    logHistory_Header_t* headerPtr,
+    uint32_t lineNum
+)
+{
+    return ((logHistory_Slot_t*)(headerPtr + 1)) + (lineNum % LOG_HISTORY_SLOT_COUNT);
+}
+
+
+#endif // LOG_HISTORY_INCLUDE_GUARD
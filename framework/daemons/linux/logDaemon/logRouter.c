@@ -0,0 +1,1409 @@
+/** @file logRouter.c
+ *
+ * Log Control Daemon's log routing engine.
+ *
+ * Every message goes through these steps, in order:
+ *
+ *  1. <b>Duplicate suppression.</b>  A message that is identical to the previous message from the
+ *     same source (same severity, component, source location and text) is only counted.  The
+ *     count is reported ("Last message repeated N times") when a different message arrives from
+ *     that source, or after a second.
+ *
+ *  2. <b>Rate limiting.</b>  This is off unless LE_LOG_RATE_LIMIT is set to a number of messages
+ *     per second.  Then each component of each process (and the standard out and standard error
+ *     of each application process) has a token bucket that refills at LE_LOG_RATE_LIMIT messages
+ *     per second up to LE_LOG_RATE_BURST messages (default DEFAULT_RATE_BURST).  Messages that
+ *     arrive when the bucket is empty are dropped and counted, and the count is reported once a
+ *     second.  Critical and emergency messages are never dropped.
+ *
+ *  3. <b>Fan-out.</b>  The message is formatted once and sent to:
+ *     - syslog (or standard error on a PC, except for messages from a client's ring, which the
+ *       client writes to its own standard error),
+ *     - the in-RAM log history (see logHistory.h),
+ *     - the log file, if one has been set with "log file" or LE_LOG_FILE.  The file is renamed to
+ *       PATH.1 and started over when it reaches LOG_FILE_MAX_BYTES, so a flood can't fill flash,
+ *     - every log tool running "log stream".
+ *
+ * So a misbehaving process that floods the log costs the Log Control Daemon a string comparison
+ * per repeated message and a token bucket check per flooding message, and costs the file systems
+ * nothing.
+ *
+ * Callers that route many messages at once (a drained ring, a chunk of standard out) bracket them
+ * with logRouter_StartBatch() and logRouter_EndBatch().  Within a batch, the lines for the log file
+ * (and for standard error on a PC) are gathered in memory and written with one system call when the
+ * batch ends (or the buffer fills up), instead of one system call per line.  Syslog still gets one
+ * call per message, since each syslog record must be a single message.
+ *
+ * Messages from client processes arrive through each client's shared memory ring (see logShm.h).
+ * Draining a ring is bounded (DRAIN_BUDGET messages at a time), so one busy client can't starve
+ * the others.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "log.h"
+#include "limit.h"
+#include "fileDescriptor.h"
+#include "logRouter.h"
+#include "logHistory.h"
+
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS         1033
+#define F_GET_SEALS         1034
+#define F_SEAL_SEAL         0x0001
+#define F_SEAL_SHRINK       0x0002
+#define F_SEAL_GROW         0x0004
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default rate limit (messages per second per component).  0 means no rate limiting.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_RATE_LIMIT      0
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default burst size (messages per component).
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_RATE_BURST      200
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size (in bytes) at which the log file is rotated.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_FILE_MAX_BYTES      (512 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of messages routed from one ring before letting other events be handled.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DRAIN_BUDGET            (4 * LOG_SHM_SLOT_COUNT)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Interval (ms) after which pending repeat and suppression counts are reported.
+ */
+//--------------------------------------------------------------------------------------------------
+#define REPORT_INTERVAL         1000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffers that batched output is gathered in.
+ */
+//--------------------------------------------------------------------------------------------------
+#define OUTPUT_BATCH_BYTES      8192
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of a formatted line (without the time stamp), including the null terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_LINE_BYTES          (LOG_HISTORY_LINE_BYTES - 16)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of a rate limiting key ("process/component"), including the null terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_KEY_BYTES           (LIMIT_MAX_PROCESS_NAME_BYTES + LIMIT_MAX_COMPONENT_NAME_BYTES)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message source.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct logRouter_Source
+{
+    le_dls_Link_t       link;                               ///< Link in the SourceList.
+    char                procName[LIMIT_MAX_PROCESS_NAME_BYTES]; ///< Process name.
+    pid_t               pid;                                ///< Process ID.
+    logShm_Slot_t       lastMsg;                            ///< Last message routed.
+    bool                hasLastMsg;                         ///< true if lastMsg is valid.
+    uint32_t            repeatCount;                        ///< Repeats of lastMsg not reported.
+    logShm_Header_t*    ringPtr;                            ///< Client's ring (NULL if none).
+    uint32_t            tail;                               ///< Next message to read from ring.
+    int                 doorbellFd;                         ///< Doorbell eventfd (-1 if none).
+    le_fdMonitor_Ref_t  doorbellMonitor;                    ///< Doorbell monitor.
+}
+Source_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Token bucket used to rate limit a component (or a process's standard out and error).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_sls_Link_t   link;                   ///< Link in the BucketList.
+    char            key[MAX_KEY_BYTES];     ///< "process/component".
+    pid_t           lastPid;                ///< PID of the last process that used this bucket.
+    uint64_t        milliTokens;            ///< Tokens left, in thousandths of a message.
+    le_clk_Time_t   lastRefill;             ///< When tokens were last added.
+    uint32_t        suppressedCount;        ///< Messages dropped and not yet reported.
+}
+Bucket_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Log tool that is streaming the log.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t       link;       ///< Link in the StreamList.
+    le_msg_SessionRef_t sessionRef; ///< IPC session with the log tool.
+}
+Stream_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pools and lists.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t SourcePoolRef;
+static le_mem_PoolRef_t BucketPoolRef;
+static le_mem_PoolRef_t StreamPoolRef;
+static le_dls_List_t SourceList = LE_DLS_LIST_INIT;
+static le_sls_List_t BucketList = LE_SLS_LIST_INIT;
+static le_dls_List_t StreamList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Token buckets, keyed by "process/component".
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t BucketMapRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rate limit (messages per second, 0 = no rate limiting) and burst size (messages).
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t RateLimit = DEFAULT_RATE_LIMIT;
+static uint32_t RateBurst = DEFAULT_RATE_BURST;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer that reports pending repeat and suppression counts.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t ReportTimer;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Output gathered during a batch, waiting to be written to a file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t  used;                       ///< Number of bytes in data.
+    char    data[OUTPUT_BATCH_BYTES];   ///< Lines, each terminated by a line break.
+}
+OutputBatch_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Batch nesting depth.  Output is written right away when this is 0.
+ */
+//--------------------------------------------------------------------------------------------------
+static unsigned int BatchDepth;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Log file sink.  LogFileBytes includes the bytes waiting in LogFileBatch.
+ */
+//--------------------------------------------------------------------------------------------------
+static int LogFileFd = -1;
+static char LogFilePath[PATH_MAX];
+static size_t LogFileBytes;
+static OutputBatch_t LogFileBatch;
+
+
+#ifndef LEGATO_EMBEDDED
+//--------------------------------------------------------------------------------------------------
+/**
+ * Output waiting to be written to standard error.
+ */
+//--------------------------------------------------------------------------------------------------
+static OutputBatch_t StdErrBatch;
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mapping of the log history file (NULL if it couldn't be created).
+ */
+//--------------------------------------------------------------------------------------------------
+static logHistory_Header_t* HistoryPtr;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads an unsigned number from an environment variable.
+ *
+ * @return The value, or the default if the variable isn't set or isn't valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GetEnvNumber
+(
+    const char* namePtr,
+    uint32_t defaultValue
+)
+{
+    const char* valuePtr = getenv(namePtr);
+
+    if (valuePtr == NULL)
+    {
+        return defaultValue;
+    }
+
+    char* endPtr;
+    errno = 0;
+    unsigned long value = strtoul(valuePtr, &endPtr, 10);
+
+    if ((errno != 0) || (*valuePtr == '\0') || (*endPtr != '\0') || (value > UINT32_MAX))
+    {
+        LE_WARN("Ignoring invalid %s value '%s'.", namePtr, valuePtr);
+        return defaultValue;
+    }
+
+    return value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maps the log history file, creating it if it doesn't exist (or isn't valid).  History that was
+ * kept by a previous instance of the Log Control Daemon is kept.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OpenHistory
+(
+    void
+)
+{
+    if (le_dir_MakePath("/tmp/legato", S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != LE_OK)
+    {
+        LE_ERROR("Log history disabled. Couldn't create /tmp/legato.");
+        return;
+    }
+
+    int fd = open(LOG_HISTORY_PATH, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        LE_ERROR("Log history disabled. Couldn't open '%s' (%m).", LOG_HISTORY_PATH);
+        return;
+    }
+
+    struct stat st;
+    bool isNew = (fstat(fd, &st) != 0) || (st.st_size != LOG_HISTORY_FILE_BYTES);
+
+    if (isNew && ((ftruncate(fd, 0) != 0) || (ftruncate(fd, LOG_HISTORY_FILE_BYTES) != 0)))
+    {
+        LE_ERROR("Log history disabled. Couldn't size '%s' (%m).", LOG_HISTORY_PATH);
+        fd_Close(fd);
+        return;
+    }
+
+    void* mapPtr = mmap(NULL, LOG_HISTORY_FILE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    fd_Close(fd);
+
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("Log history disabled. Couldn't map '%s' (%m).", LOG_HISTORY_PATH);
+        return;
+    }
+
+    HistoryPtr = mapPtr;
+
+    if (   isNew
+        || (HistoryPtr->magic != LOG_HISTORY_MAGIC)
+        || (HistoryPtr->slotCount != LOG_HISTORY_SLOT_COUNT)
+        || (HistoryPtr->slotSize != sizeof(logHistory_Slot_t)) )
+    {
+        memset(HistoryPtr, 0, LOG_HISTORY_FILE_BYTES);
+        HistoryPtr->slotCount = LOG_HISTORY_SLOT_COUNT;
+        HistoryPtr->slotSize = sizeof(logHistory_Slot_t);
+        __atomic_store_n(&HistoryPtr->magic, LOG_HISTORY_MAGIC, __ATOMIC_RELEASE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Appends a line to the log history.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteHistory
+(
+    const char* linePtr
+)
+{
+    uint32_t lineNum = HistoryPtr->lineCount;
+    logHistory_Slot_t* slotPtr = logHistory_GetSlotPtr(HistoryPtr, lineNum);
+
+    __atomic_store_n(&slotPtr->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    le_utf8_Copy(slotPtr->line, linePtr, sizeof(slotPtr->line), NULL);
+
+    __atomic_store_n(&slotPtr->seq, lineNum + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&HistoryPtr->lineCount, lineNum + 1, __ATOMIC_RELEASE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens the log file for appending.
+ *
+ * @return LE_OK if successful, LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t OpenLogFile
+(
+    void
+)
+{
+    LogFileFd = open(LogFilePath, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (LogFileFd < 0)
+    {
+        LE_ERROR("Couldn't open log file '%s' (%m).", LogFilePath);
+        return LE_FAULT;
+    }
+
+    struct stat st;
+    LogFileBytes = (fstat(LogFileFd, &st) == 0) ? st.st_size : 0;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes out the output gathered in a batch buffer.
+ *
+ * @return LE_OK if successful, LE_FAULT if the write failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FlushOutput
+(
+    OutputBatch_t* batchPtr,
+    int fd
+)
+{
+    size_t used = batchPtr->used;
+
+    batchPtr->used = 0;
+
+    if ((used == 0) || (fd_WriteSize(fd, batchPtr->data, used) == used))
+    {
+        return LE_OK;
+    }
+
+    return LE_FAULT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds a line to a batch buffer, making room by writing out the buffer if needed.  Outside a
+ * batch, the line is written right away.
+ *
+ * @return LE_OK if successful, LE_FAULT if a write failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AppendOutput
+(
+    OutputBatch_t* batchPtr,
+    int fd,
+    const char* prefixPtr,      ///< [IN] Text to put before the line (may be empty).
+    const char* linePtr
+)
+{
+    size_t prefixLen = strlen(prefixPtr);
+    size_t lineLen = strlen(linePtr);
+    size_t len = prefixLen + lineLen + 1;
+
+    // Lines are much shorter than the buffer, so one flush always makes enough room.
+    if (   (batchPtr->used + len > sizeof(batchPtr->data))
+        && (FlushOutput(batchPtr, fd) != LE_OK) )
+    {
+        return LE_FAULT;
+    }
+
+    char* destPtr = batchPtr->data + batchPtr->used;
+
+    memcpy(destPtr, prefixPtr, prefixLen);
+    memcpy(destPtr + prefixLen, linePtr, lineLen);
+    destPtr[len - 1] = '\n';
+    batchPtr->used += len;
+
+    if (BatchDepth == 0)
+    {
+        return FlushOutput(batchPtr, fd);
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops writing to the log file after an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AbandonLogFile
+(
+    const char* whatPtr     ///< [IN] What failed.
+)
+{
+    LE_ERROR("Couldn't %s log file '%s' (%m). Not writing to it anymore.", whatPtr, LogFilePath);
+
+    if (LogFileFd >= 0)
+    {
+        fd_Close(LogFileFd);
+        LogFileFd = -1;
+    }
+    LogFileBatch.used = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Appends a line to the log file, rotating the file when it gets too big.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteLogFile
+(
+    const char* linePtr
+)
+{
+    if (LogFileBytes >= LOG_FILE_MAX_BYTES)
+    {
+        char oldPath[PATH_MAX + 2];
+        snprintf(oldPath, sizeof(oldPath), "%s.1", LogFilePath);
+
+        if (FlushOutput(&LogFileBatch, LogFileFd) != LE_OK)
+        {
+            AbandonLogFile("write to");
+            return;
+        }
+
+        fd_Close(LogFileFd);
+        LogFileFd = -1;
+
+        if ((rename(LogFilePath, oldPath) != 0) || (OpenLogFile() != LE_OK))
+        {
+            AbandonLogFile("rotate");
+            return;
+        }
+    }
+
+    if (AppendOutput(&LogFileBatch, LogFileFd, "", linePtr) != LE_OK)
+    {
+        AbandonLogFile("write to");
+        return;
+    }
+
+    LogFileBytes += strlen(linePtr) + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a line to a log tool that is streaming the log.  Lines too long for the log control
+ * protocol are truncated.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteStream
+(
+    Stream_t* streamPtr,
+    const char* linePtr
+)
+{
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(streamPtr->sessionRef);
+
+    le_utf8_Copy(le_msg_GetPayloadPtr(msgRef), linePtr, le_msg_GetMaxPayloadSize(msgRef), NULL);
+
+    le_msg_Send(msgRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts a Legato severity level to a syslog priority.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifdef LEGATO_EMBEDDED
+static int ConvertToSyslogLevel
+(
+    le_log_Level_t level
+)
+{
+    switch (level)
+    {
+        case LE_LOG_DEBUG:
+            return LOG_DEBUG;
+
+        case LE_LOG_INFO:
+            return LOG_INFO;
+
+        case LE_LOG_WARN:
+            return LOG_WARNING;
+
+        case LE_LOG_ERR:
+            return LOG_ERR;
+
+        case LE_LOG_CRIT:
+            return LOG_CRIT;
+
+        case LE_LOG_EMERG:
+            return LOG_EMERG;
+    }
+
+    // Traces.
+    return LOG_DEBUG;
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cuts off a partial UTF-8 character left at the end of a line that snprintf() truncated.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TrimPartialChar
+(
+    char* linePtr,
+    size_t lineLen      ///< Length of the truncated line (not including the null terminator).
+)
+{
+    // Find the start of the last character.
+    size_t charStart = lineLen;
+
+    while ((charStart > 0) && ((linePtr[charStart - 1] & 0xC0) == 0x80))
+    {
+        charStart--;
+    }
+
+    if (   (charStart > 0)
+        && (le_utf8_NumBytesInChar(linePtr[charStart - 1]) > lineLen - charStart + 1) )
+    {
+        linePtr[charStart - 1] = '\0';
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats a message and sends it to all the sinks.  This is where messages end up once they have
+ * made it through duplicate suppression and rate limiting.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FanOut
+(
+    const char* procNamePtr,
+    pid_t pid,
+    const logShm_Slot_t* msgPtr,
+    bool isOnClientStdErr       ///< true if the client has written this to its own standard error.
+)
+{
+    bool isTrace = (msgPtr->level < LE_LOG_DEBUG) || (msgPtr->level > LE_LOG_EMERG);
+    const char* levelPtr = isTrace ? msgPtr->keyword : log_GetSeverityStr(msgPtr->level);
+
+    // Format the message, the same way that log clients format messages they output themselves.
+    char line[MAX_LINE_BYTES];
+    int lineLen;
+
+    if (msgPtr->compName[0] != '\0')
+    {
+        lineLen = snprintf(line, sizeof(line), "%s | %s[%d]/%s T=%s | %s %s() %u | %s",
+                           levelPtr, procNamePtr, (int)pid, msgPtr->compName, msgPtr->threadName,
+                           msgPtr->fileName, msgPtr->funcName, msgPtr->lineNumber, msgPtr->msg);
+    }
+    else
+    {
+        lineLen = snprintf(line, sizeof(line), "%s | %s[%d] | %s", levelPtr, procNamePtr,
+                           (int)pid, msgPtr->msg);
+    }
+
+    // Long messages are cut short, but not in the middle of a character.
+    if (lineLen >= (int)sizeof(line))
+    {
+        TrimPartialChar(line, sizeof(line) - 1);
+    }
+
+    char timeStamp[16] = "";
+    time_t timestamp = msgPtr->timestamp;
+    struct tm tm;
+
+    if (localtime_r(&timestamp, &tm) != NULL)
+    {
+        strftime(timeStamp, sizeof(timeStamp), "%b %e %H:%M:%S", &tm);
+    }
+
+#ifdef LEGATO_EMBEDDED
+    syslog(ConvertToSyslogLevel(isTrace ? LE_LOG_DEBUG : msgPtr->level), "%s\n", line);
+    (void)isOnClientStdErr;
+#else
+    if (!isOnClientStdErr)
+    {
+        char prefix[sizeof(timeStamp) + 3];
+        snprintf(prefix, sizeof(prefix), "%s : ", timeStamp);
+        (void)AppendOutput(&StdErrBatch, STDERR_FILENO, prefix, line);
+    }
+#endif
+
+    if ((HistoryPtr == NULL) && (LogFileFd < 0) && le_dls_IsEmpty(&StreamList))
+    {
+        return;
+    }
+
+    char stampedLine[LOG_HISTORY_LINE_BYTES];
+    snprintf(stampedLine, sizeof(stampedLine), "%s %s", timeStamp, line);
+
+    if (HistoryPtr != NULL)
+    {
+        WriteHistory(stampedLine);
+    }
+
+    if (LogFileFd >= 0)
+    {
+        WriteLogFile(stampedLine);
+    }
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&StreamList);
+    while (linkPtr != NULL)
+    {
+        WriteStream(CONTAINER_OF(linkPtr, Stream_t, link), stampedLine);
+
+        linkPtr = le_dls_PeekNext(&StreamList, linkPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts the report timer, if it isn't already running.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScheduleReport
+(
+    void
+)
+{
+    if (!le_timer_IsRunning(ReportTimer))
+    {
+        le_timer_Start(ReportTimer);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reports how many times a source's last message was repeated (if it was).
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportRepeats
+(
+    Source_t* sourcePtr
+)
+{
+    if (sourcePtr->repeatCount == 0)
+    {
+        return;
+    }
+
+    logShm_Slot_t report = sourcePtr->lastMsg;
+
+    snprintf(report.msg, sizeof(report.msg), "Last message repeated %" PRIu32 " times.",
+             sourcePtr->repeatCount);
+    report.timestamp = time(NULL);
+
+    sourcePtr->repeatCount = 0;
+
+    FanOut(sourcePtr->procName, sourcePtr->pid, &report, (sourcePtr->ringPtr != NULL));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reports how many messages a token bucket dropped (if any).
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportSuppressed
+(
+    Bucket_t* bucketPtr
+)
+{
+    if (bucketPtr->suppressedCount == 0)
+    {
+        return;
+    }
+
+    logShm_Slot_t report = { .timestamp = time(NULL), .level = LE_LOG_WARN };
+    char procName[LIMIT_MAX_PROCESS_NAME_BYTES];
+
+    // The key is "process/component".
+    le_utf8_CopyUpToSubStr(procName, bucketPtr->key, "/", sizeof(procName), NULL);
+
+    snprintf(report.msg, sizeof(report.msg),
+             "%" PRIu32 " messages from '%s' dropped (more than %" PRIu32 " per second).",
+             bucketPtr->suppressedCount, bucketPtr->key, RateLimit);
+
+    bucketPtr->suppressedCount = 0;
+
+    FanOut(procName, bucketPtr->lastPid, &report, false);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reports all pending repeat and suppression counts.  Called by the report timer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportTimerExpired
+(
+    le_timer_Ref_t timerRef
+)
+{
+    logRouter_StartBatch();
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&SourceList);
+    while (linkPtr != NULL)
+    {
+        ReportRepeats(CONTAINER_OF(linkPtr, Source_t, link));
+
+        linkPtr = le_dls_PeekNext(&SourceList, linkPtr);
+    }
+
+    le_sls_Link_t* bucketLinkPtr = le_sls_Peek(&BucketList);
+    while (bucketLinkPtr != NULL)
+    {
+        ReportSuppressed(CONTAINER_OF(bucketLinkPtr, Bucket_t, link));
+
+        bucketLinkPtr = le_sls_PeekNext(&BucketList, bucketLinkPtr);
+    }
+
+    logRouter_EndBatch();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a message is identical to the last one from the same source.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsRepeat
+(
+    const Source_t* sourcePtr,
+    const logShm_Slot_t* msgPtr
+)
+{
+    const logShm_Slot_t* lastPtr = &sourcePtr->lastMsg;
+
+    return sourcePtr->hasLastMsg
+        && (msgPtr->level == lastPtr->level)
+        && (msgPtr->lineNumber == lastPtr->lineNumber)
+        && (strcmp(msgPtr->msg, lastPtr->msg) == 0)
+        && (strcmp(msgPtr->compName, lastPtr->compName) == 0)
+        && (strcmp(msgPtr->fileName, lastPtr->fileName) == 0)
+        && (strcmp(msgPtr->funcName, lastPtr->funcName) == 0)
+        && (strcmp(msgPtr->keyword, lastPtr->keyword) == 0)
+        && (strcmp(msgPtr->threadName, lastPtr->threadName) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes a token from a component's bucket.
+ *
+ * @return true if the message may be output, false if it must be dropped.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool TakeToken
+(
+    const Source_t* sourcePtr,
+    const logShm_Slot_t* msgPtr
+)
+{
+    if (   (RateLimit == 0)
+        || (msgPtr->level == LE_LOG_CRIT)
+        || (msgPtr->level == LE_LOG_EMERG) )
+    {
+        return true;
+    }
+
+    char key[MAX_KEY_BYTES];
+    snprintf(key, sizeof(key), "%s/%s", sourcePtr->procName, msgPtr->compName);
+
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+    Bucket_t* bucketPtr = le_hashmap_Get(BucketMapRef, key);
+
+    if (bucketPtr == NULL)
+    {
+        bucketPtr = le_mem_ForceAlloc(BucketPoolRef);
+        LE_ASSERT(le_utf8_Copy(bucketPtr->key, key, sizeof(bucketPtr->key), NULL) == LE_OK);
+        bucketPtr->milliTokens = (uint64_t)RateBurst * 1000;
+        bucketPtr->lastRefill = now;
+        bucketPtr->suppressedCount = 0;
+        bucketPtr->link = LE_SLS_LINK_INIT;
+
+        le_sls_Queue(&BucketList, &bucketPtr->link);
+        le_hashmap_Put(BucketMapRef, bucketPtr->key, bucketPtr);
+    }
+
+    bucketPtr->lastPid = sourcePtr->pid;
+
+    // Refill: RateLimit messages per second is RateLimit thousandths of a message per ms.
+    le_clk_Time_t elapsed = le_clk_Sub(now, bucketPtr->lastRefill);
+    uint64_t elapsedMs = ((uint64_t)elapsed.sec * 1000) + (elapsed.usec / 1000);
+
+    if (elapsedMs > 0)
+    {
+        uint64_t capacity = (uint64_t)RateBurst * 1000;
+
+        bucketPtr->milliTokens += elapsedMs * RateLimit;
+        if (bucketPtr->milliTokens > capacity)
+        {
+            bucketPtr->milliTokens = capacity;
+        }
+        bucketPtr->lastRefill = now;
+    }
+
+    if (bucketPtr->milliTokens < 1000)
+    {
+        bucketPtr->suppressedCount++;
+        ScheduleReport();
+        return false;
+    }
+
+    bucketPtr->milliTokens -= 1000;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Null-terminates all the strings in a message.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TerminateStrings
+(
+    logShm_Slot_t* msgPtr
+)
+{
+    msgPtr->keyword[sizeof(msgPtr->keyword) - 1] = '\0';
+    msgPtr->compName[sizeof(msgPtr->compName) - 1] = '\0';
+    msgPtr->threadName[sizeof(msgPtr->threadName) - 1] = '\0';
+    msgPtr->fileName[sizeof(msgPtr->fileName) - 1] = '\0';
+    msgPtr->funcName[sizeof(msgPtr->funcName) - 1] = '\0';
+    msgPtr->msg[sizeof(msgPtr->msg) - 1] = '\0';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Routes a message.
+ *
+ * The message's strings don't need to be null-terminated; they are terminated here.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_Route
+(
+    logRouter_SourceRef_t sourceRef,
+    logShm_Slot_t* msgPtr           ///< [IN] Message (may be modified).
+)
+{
+    TerminateStrings(msgPtr);
+
+    if (IsRepeat(sourceRef, msgPtr))
+    {
+        if (sourceRef->repeatCount++ == 0)
+        {
+            ScheduleReport();
+        }
+        return;
+    }
+
+    ReportRepeats(sourceRef);
+
+    sourceRef->lastMsg = *msgPtr;
+    sourceRef->hasLastMsg = true;
+
+    if (TakeToken(sourceRef, msgPtr))
+    {
+        FanOut(sourceRef->procName, sourceRef->pid, msgPtr, (sourceRef->ringPtr != NULL));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops reading a source's ring and unmaps it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DetachRing
+(
+    Source_t* sourcePtr
+)
+{
+    le_fdMonitor_Delete(sourcePtr->doorbellMonitor);
+    fd_Close(sourcePtr->doorbellFd);
+    munmap(sourcePtr->ringPtr, LOG_SHM_RING_BYTES);
+
+    sourcePtr->doorbellMonitor = NULL;
+    sourcePtr->doorbellFd = -1;
+    sourcePtr->ringPtr = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Routes the messages waiting in a source's ring.
+ *
+ * @return true if the ring is empty (or was detached), false if the budget ran out first.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DrainRing
+(
+    Source_t* sourcePtr,
+    size_t budget               ///< [IN] Maximum number of messages to route.
+)
+{
+    logShm_Header_t* ringPtr = sourcePtr->ringPtr;
+
+    for (;;)
+    {
+        uint32_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE);
+
+        if ((uint32_t)(head - sourcePtr->tail) > LOG_SHM_SLOT_COUNT)
+        {
+            LE_ERROR("Log ring of '%s[%d]' is corrupt. Not reading it anymore.",
+                     sourcePtr->procName, (int)sourcePtr->pid);
+            DetachRing(sourcePtr);
+            return true;
+        }
+
+        while (sourcePtr->tail != head)
+        {
+            if (budget == 0)
+            {
+                return false;
+            }
+            budget--;
+
+            logShm_Slot_t msg = *logShm_GetSlotPtr(ringPtr, sourcePtr->tail);
+
+            sourcePtr->tail++;
+            __atomic_store_n(&ringPtr->tail, sourcePtr->tail, __ATOMIC_RELEASE);
+
+            logRouter_Route(sourcePtr, &msg);
+        }
+
+        // Tell the client to ring the doorbell, then check once more for messages written
+        // before it could see that.
+        __atomic_store_n(&ringPtr->isWaiting, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (__atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE) == sourcePtr->tail)
+        {
+            return true;
+        }
+
+        __atomic_store_n(&ringPtr->isWaiting, 0, __ATOMIC_RELAXED);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handles the doorbell of a source's ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DoorbellHandler
+(
+    int fd,
+    short events
+)
+{
+    Source_t* sourcePtr = le_fdMonitor_GetContextPtr();
+    eventfd_t count;
+
+    if (events & POLLIN)
+    {
+        // Clear the doorbell before looking at the ring, so no ring is missed.
+        (void)eventfd_read(fd, &count);
+
+        logRouter_StartBatch();
+
+        if (!DrainRing(sourcePtr, DRAIN_BUDGET))
+        {
+            // Come back to this ring once the other pending events have been handled.
+            (void)eventfd_write(fd, 1);
+        }
+
+        logRouter_EndBatch();
+    }
+    else
+    {
+        LE_ERROR("Unexpected events (0x%x) on log ring doorbell of '%s[%d]'.",
+                 events, sourcePtr->procName, (int)sourcePtr->pid);
+        DetachRing(sourcePtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Attaches a client's shared memory ring to a message source.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_DUPLICATE if the source already has a ring.
+ * - LE_FAULT if the shared memory is not acceptable (check the logs).
+ *
+ * @note The shared memory file descriptor is always closed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t logRouter_AttachRing
+(
+    logRouter_SourceRef_t sourceRef,
+    int memFd,              ///< [IN] File descriptor of the client's ring.
+    int* doorbellFdPtr      ///< [OUT] Copy of the doorbell to send back to the client (it is
+                            ///        closed when the response is sent).
+)
+{
+    if (sourceRef->ringPtr != NULL)
+    {
+        fd_Close(memFd);
+        return LE_DUPLICATE;
+    }
+
+    struct stat st;
+    int seals = fcntl(memFd, F_GET_SEALS);
+    void* mapPtr = MAP_FAILED;
+
+    // A ring that could be shrunk under us would crash us.
+    if ((seals < 0) || !(seals & F_SEAL_SHRINK))
+    {
+        LE_ERROR("Log ring from '%s[%d]' is not sealed against shrinking.",
+                 sourceRef->procName, (int)sourceRef->pid);
+    }
+    else if ((fstat(memFd, &st) != 0) || (st.st_size != LOG_SHM_RING_BYTES))
+    {
+        LE_ERROR("Log ring from '%s[%d]' has the wrong size.",
+                 sourceRef->procName, (int)sourceRef->pid);
+    }
+    else
+    {
+        mapPtr = mmap(NULL, LOG_SHM_RING_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+        if (mapPtr == MAP_FAILED)
+        {
+            LE_ERROR("Failed to map log ring from '%s[%d]' (%m).",
+                     sourceRef->procName, (int)sourceRef->pid);
+        }
+    }
+
+    fd_Close(memFd);
+
+    if (mapPtr == MAP_FAILED)
+    {
+        return LE_FAULT;
+    }
+
+    logShm_Header_t* ringPtr = mapPtr;
+
+    if (   (ringPtr->magic != LOG_SHM_MAGIC)
+        || (ringPtr->slotCount != LOG_SHM_SLOT_COUNT)
+        || (ringPtr->slotSize != sizeof(logShm_Slot_t)) )
+    {
+        LE_ERROR("Log ring from '%s[%d]' has the wrong layout.",
+                 sourceRef->procName, (int)sourceRef->pid);
+        munmap(mapPtr, LOG_SHM_RING_BYTES);
+        return LE_FAULT;
+    }
+
+    int doorbellFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int clientDoorbellFd = (doorbellFd < 0) ? -1 : dup(doorbellFd);
+
+    if (clientDoorbellFd < 0)
+    {
+        LE_ERROR("Failed to create log ring doorbell (%m).");
+        if (doorbellFd >= 0)
+        {
+            fd_Close(doorbellFd);
+        }
+        munmap(mapPtr, LOG_SHM_RING_BYTES);
+        return LE_FAULT;
+    }
+
+    char monitorName[LIMIT_MAX_PROCESS_NAME_BYTES + 8];
+    snprintf(monitorName, sizeof(monitorName), "%sLogRing", sourceRef->procName);
+
+    sourceRef->ringPtr = ringPtr;
+    sourceRef->tail = __atomic_load_n(&ringPtr->tail, __ATOMIC_RELAXED);
+    sourceRef->doorbellFd = doorbellFd;
+    sourceRef->doorbellMonitor = le_fdMonitor_Create(monitorName, doorbellFd, DoorbellHandler,
+                                                     POLLIN);
+    le_fdMonitor_SetContextPtr(sourceRef->doorbellMonitor, sourceRef);
+
+    // Route anything the client logged before it got the doorbell, and start waiting for it.
+    (void)eventfd_write(doorbellFd, 1);
+
+    *doorbellFdPtr = clientDoorbellFd;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a message source.
+ *
+ * @return Reference to the source.
+ */
+//--------------------------------------------------------------------------------------------------
+logRouter_SourceRef_t logRouter_CreateSource
+(
+    const char* procNamePtr,    ///< [IN] Name of the process the messages come from.
+    pid_t pid                   ///< [IN] PID of the process the messages come from.
+)
+{
+    Source_t* sourcePtr = le_mem_ForceAlloc(SourcePoolRef);
+
+    memset(sourcePtr, 0, sizeof(*sourcePtr));
+    le_utf8_Copy(sourcePtr->procName, procNamePtr, sizeof(sourcePtr->procName), NULL);
+    sourcePtr->pid = pid;
+    sourcePtr->doorbellFd = -1;
+    sourcePtr->link = LE_DLS_LINK_INIT;
+
+    le_dls_Queue(&SourceList, &sourcePtr->link);
+
+    return sourcePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a message source.  Any messages still in its ring are routed first.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_DeleteSource
+(
+    logRouter_SourceRef_t sourceRef
+)
+{
+    if (sourceRef->ringPtr != NULL)
+    {
+        // The client may have died; whatever it logged last is the most interesting part.
+        logRouter_StartBatch();
+        (void)DrainRing(sourceRef, SIZE_MAX);
+        logRouter_EndBatch();
+
+        if (sourceRef->ringPtr != NULL)
+        {
+            DetachRing(sourceRef);
+        }
+    }
+
+    ReportRepeats(sourceRef);
+
+    le_dls_Remove(&SourceList, &sourceRef->link);
+    le_mem_Release(sourceRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets (or clears) the log file that messages are written to, in addition to syslog.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the file couldn't be opened (check the logs).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t logRouter_SetFile
+(
+    const char* pathPtr         ///< [IN] Path of the log file, or NULL to stop writing to a file.
+)
+{
+    if (LogFileFd >= 0)
+    {
+        (void)FlushOutput(&LogFileBatch, LogFileFd);
+        fd_Close(LogFileFd);
+        LogFileFd = -1;
+    }
+
+    if (pathPtr == NULL)
+    {
+        LogFilePath[0] = '\0';
+        return LE_OK;
+    }
+
+    if (   (pathPtr[0] != '/')
+        || (le_utf8_Copy(LogFilePath, pathPtr, sizeof(LogFilePath) - 2, NULL) != LE_OK) )
+    {
+        LE_ERROR("Invalid log file path '%s'.", pathPtr);
+        LogFilePath[0] = '\0';
+        return LE_FAULT;
+    }
+
+    return OpenLogFile();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a batch of messages.  Output to the log file (and standard error) is held back until the
+ * matching logRouter_EndBatch().  Batches can be nested.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_StartBatch
+(
+    void
+)
+{
+    BatchDepth++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ends a batch of messages, writing out the output held back since the outermost
+ * logRouter_StartBatch().
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_EndBatch
+(
+    void
+)
+{
+    LE_ASSERT(BatchDepth > 0);
+
+    if (--BatchDepth > 0)
+    {
+        return;
+    }
+
+    if ((LogFileFd >= 0) && (FlushOutput(&LogFileBatch, LogFileFd) != LE_OK))
+    {
+        AbandonLogFile("write to");
+    }
+
+#ifndef LEGATO_EMBEDDED
+    (void)FlushOutput(&StdErrBatch, STDERR_FILENO);
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts sending every routed message to a log tool as text.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_AddStream
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] IPC session with the log tool.
+)
+{
+    Stream_t* streamPtr = le_mem_ForceAlloc(StreamPoolRef);
+
+    streamPtr->sessionRef = sessionRef;
+    streamPtr->link = LE_DLS_LINK_INIT;
+
+    le_dls_Queue(&StreamList, &streamPtr->link);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops sending messages to a log tool.  Does nothing if the session isn't a stream consumer.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_RemoveStream
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] IPC session with the log tool.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&StreamList);
+
+    while (linkPtr != NULL)
+    {
+        Stream_t* streamPtr = CONTAINER_OF(linkPtr, Stream_t, link);
+
+        if (streamPtr->sessionRef == sessionRef)
+        {
+            le_dls_Remove(&StreamList, linkPtr);
+            le_mem_Release(streamPtr);
+            return;
+        }
+
+        linkPtr = le_dls_PeekNext(&StreamList, linkPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the routing engine.  Must be called once, before any other function in this module.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_Init
+(
+    void
+)
+{
+    SourcePoolRef = le_mem_CreatePool("LogSources", sizeof(Source_t));
+    BucketPoolRef = le_mem_CreatePool("LogBuckets", sizeof(Bucket_t));
+    StreamPoolRef = le_mem_CreatePool("LogStreams", sizeof(Stream_t));
+
+    BucketMapRef = le_hashmap_Create("LogBuckets", 64, le_hashmap_HashString,
+                                     le_hashmap_EqualsString);
+
+    RateLimit = GetEnvNumber("LE_LOG_RATE_LIMIT", DEFAULT_RATE_LIMIT);
+    RateBurst = GetEnvNumber("LE_LOG_RATE_BURST", DEFAULT_RATE_BURST);
+    if (RateBurst == 0)
+    {
+        RateBurst = 1;
+    }
+
+    ReportTimer = le_timer_Create("LogReport");
+    le_timer_SetMsInterval(ReportTimer, REPORT_INTERVAL);
+    le_timer_SetHandler(ReportTimer, ReportTimerExpired);
+    le_timer_SetWakeup(ReportTimer, false);
+
+    OpenHistory();
+
+    const char* filePathPtr = getenv("LE_LOG_FILE");
+    if ((filePathPtr != NULL) && (filePathPtr[0] != '\0'))
+    {
+        (void)logRouter_SetFile(filePathPtr);
+    }
+}
@@ -0,0 +1,159 @@
+/** @file logRouter.h
+ *
+ * Log Control Daemon's log routing engine.  Receives log messages from client processes' shared
+ * memory rings (see logShm.h) and from application processes' standard out and standard error,
+ * suppresses repeated messages and floods, and fans the rest out to syslog, an optional log file,
+ * the in-RAM log history (see logHistory.h) and any live stream consumers.  See logRouter.c for
+ * details.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LOG_ROUTER_INCLUDE_GUARD
+#define LOG_ROUTER_INCLUDE_GUARD
+
+#include "logShm.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a message source: a client process, or one of an application process's standard
+ * output streams.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct logRouter_Source* logRouter_SourceRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the routing engine.  Must be called once, before any other function in this module.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a message source.
+ *
+ * @return Reference to the source.
+ */
+//--------------------------------------------------------------------------------------------------
+logRouter_SourceRef_t logRouter_CreateSource
+(
+    const char* procNamePtr,    ///< [IN] Name of the process the messages come from.
+    pid_t pid                   ///< [IN] PID of the process the messages come from.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a message source.  Any messages still in its ring are routed first.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_DeleteSource
+(
+    logRouter_SourceRef_t sourceRef
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Attaches a client's shared memory ring to a message source.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_DUPLICATE if the source already has a ring.
+ * - LE_FAULT if the shared memory is not acceptable (check the logs).
+ *
+ * @note The shared memory file descriptor is always closed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t logRouter_AttachRing
+(
+    logRouter_SourceRef_t sourceRef,
+    int memFd,              ///< [IN] File descriptor of the client's ring.
+    int* doorbellFdPtr      ///< [OUT] Copy of the doorbell to send back to the client (it is
+                            ///        closed when the response is sent).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Routes a message.
+ *
+ * The message's strings don't need to be null-terminated; they are terminated here.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_Route
+(
+    logRouter_SourceRef_t sourceRef,
+    logShm_Slot_t* msgPtr           ///< [IN] Message (may be modified).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a batch of messages.  Output to the log file (and standard error) is held back until the
+ * matching logRouter_EndBatch().  Batches can be nested.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_StartBatch
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ends a batch of messages, writing out the output held back since the outermost
+ * logRouter_StartBatch().
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_EndBatch
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets (or clears) the log file that messages are written to, in addition to syslog.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the file couldn't be opened (check the logs).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t logRouter_SetFile
+(
+    const char* pathPtr         ///< [IN] Path of the log file, or NULL to stop writing to a file.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts sending every routed message to a log tool as text.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_AddStream
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] IPC session with the log tool.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops sending messages to a log tool.  Does nothing if the session isn't a stream consumer.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRouter_RemoveStream
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] IPC session with the log tool.
+);
+
+
+#endif // LOG_ROUTER_INCLUDE_GUARD
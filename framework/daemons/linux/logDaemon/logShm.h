@@ -0,0 +1,137 @@
+/** @file logShm.h
+ *
+ * Layout of the shared memory log message ring that a log client uses to hand its log messages to
+ * the Log Control Daemon.
+ *
+ * Each client process creates one ring in a sealed memfd, after it has registered its log
+ * sessions, and passes the memfd to the Log Control Daemon in a LOG_CMD_ATTACH_RING command.  The
+ * Log Control Daemon replies with an eventfd that the client uses as a doorbell.
+ *
+ * @verbatim
+ *
+ *   +--------+--------+--------+-----+------------------------+
+ *   | Header | slot 0 | slot 1 | ... | slot (slotCount - 1)   |
+ *   +--------+--------+--------+-----+------------------------+
+ *
+ * @endverbatim
+ *
+ * The client's threads serialize among themselves (with the log module's mutex) and copy each
+ * message into the slot at (head % slotCount), then advance head.  The Log Control Daemon copies
+ * messages out of the slot at (tail % slotCount) and advances tail.  Before it goes back to sleep,
+ * the Log Control Daemon sets isWaiting and checks the ring one more time; a client that finds
+ * isWaiting set after advancing head clears it and writes to the doorbell.  So a busy client rings
+ * the doorbell at most once per batch of messages instead of once per message.
+ *
+ * If the ring is full, the client sends the message straight to syslog (or standard error on a
+ * PC) itself, so nothing is lost.  On a PC, the client also writes every message it puts in the
+ * ring to its own standard error.
+ *
+ * The Log Control Daemon never trusts the contents of the ring: head is checked against tail
+ * before use and every string is terminated before it is used.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LOG_SHM_INCLUDE_GUARD
+#define LOG_SHM_INCLUDE_GUARD
+
+#include "limit.h"
+#include "log.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of the magic number at the start of the ring ("LELR").
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_SHM_MAGIC           0x524C454C
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of slots in a client's ring.  This is the number of messages that a client can log in a
+ * burst before the Log Control Daemon gets to run.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_SHM_SLOT_COUNT      64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of the source file name (base name only) in a ring slot, including the null
+ * terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_SHM_FILE_NAME_BYTES 48
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of the function name in a ring slot, including the null terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_SHM_FUNC_NAME_BYTES 64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t magic;         ///< LOG_SHM_MAGIC.
+    uint32_t slotCount;     ///< LOG_SHM_SLOT_COUNT.
+    uint32_t slotSize;      ///< sizeof(logShm_Slot_t).
+    uint32_t head;          ///< Number of messages written by the client.
+    uint32_t tail;          ///< Number of messages read by the Log Control Daemon.
+    uint32_t isWaiting;     ///< Non-zero if the Log Control Daemon is waiting for the doorbell.
+    uint32_t reserved[2];
+}
+logShm_Header_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A message in the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int64_t  timestamp;                                 ///< time() when the message was logged.
+    int32_t  level;                                     ///< Severity level (-1 for a trace).
+    uint32_t lineNumber;                                ///< Source line number.
+    char     keyword[LIMIT_MAX_LOG_KEYWORD_BYTES];      ///< Trace keyword (traces only).
+    char     compName[LIMIT_MAX_COMPONENT_NAME_BYTES];  ///< Component name.
+    char     threadName[LIMIT_MAX_THREAD_NAME_BYTES];   ///< Thread name.
+    char     fileName[LOG_SHM_FILE_NAME_BYTES];         ///< Source file base name.
+    char     funcName[LOG_SHM_FUNC_NAME_BYTES];         ///< Function name.
+    char     msg[LOG_MAX_MSG_SIZE];                     ///< Formatted message.
+}
+logShm_Slot_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of a ring, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_SHM_RING_BYTES  (sizeof(logShm_Header_t) + (LOG_SHM_SLOT_COUNT * sizeof(logShm_Slot_t)))
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a pointer to the slot that a message number goes in.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline logShm_Slot_t* logShm_GetSlotPtr
+(
+    logShm_Header_t* headerPtr,
+    uint32_t msgNum
+)
+{
+    return ((logShm_Slot_t*)(headerPtr + 1)) + (msgNum % LOG_SHM_SLOT_COUNT);
+}
+
+
+#endif // LOG_SHM_INCLUDE_GUARD
@@ -70,7 +70,7 @@ User List ------> User --+---> Name               |        |        |
 @endverbatim
  *
  * The User object represents a single user account.  It has a unique ID which is used as the key
- * to find it in the User List.  Each User also has
+ * to find it in the User Map, a hash map that indexes the User List.  Each User also has
  *  - list of bindings from a client-side interface name to a server's user name and service name.
  *  - list of services that it offers, and
  *  - list of client connections that are waiting for a binding to be created for them.
@@ -81,6 +81,14 @@ User List ------> User --+---> Name               |        |        |
  * the 'sdir' tool.  Each Binding object has a list of client connections that match that binding
  * but are waiting for the server to advertise the service.
  *
+ * The lists are kept so that the 'sdir' tool can report things in the order in which they were
+ * created, but lookups never search them.  Hash maps index the Binding objects by client User and
+ * client-side interface name (the Binding Map) and the advertised Server Connections by server
+ * User and service name (the Service Map).  Also, each binding destination (server User and
+ * service name) has a Bound Service object, found through the Bound Service Map, that keeps a list
+ * of the bindings that refer to it, so the bindings affected by a service appearing or
+ * disappearing can be found without searching every user's Binding List.
+ *
  * Connection objects are used to keep track of the details of socket connections (e.g., the
  * file descriptor, File Descriptor Monitor object, etc.) and the interface name, protocol ID, and
  * maximum message size advertised or requested.  Server Connections keep track of
@@ -114,8 +122,8 @@ User List ------> User --+---> Name               |        |        |
  * object is not found for that service name on that User, the new one is is added to the list.
  * Otherwise, the new server connection is dropped.
  *
- * When a new Server Connection is added to a Service List, all users' Binding Lists are
- * searched for matching bindings, and if any that match have non-empty Waiting Clients Lists,
+ * When a new Server Connection is added to a Service List, the bindings on the matching Bound
+ * Service's list are associated with it, and if any of them have non-empty Waiting Clients Lists,
  * all those Client Connections are removed from those lists and dispatched to the new Server
  * Connection.
  *
@@ -250,6 +258,27 @@ static le_mem_PoolRef_t UserPoolRef;
 static le_dls_List_t UserList = LE_DLS_LIST_INIT;
 
 
+//--------------------------------------------------------------------------------------------------
+/// The User Map, which indexes the User List by Unix user ID.
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t UserMapRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key used to find an object that belongs to a User and is identified by an interface or service
+ * name.  Keys that are stored in a map are kept inside the object they index, and point at that
+ * object's own copy of the name.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const User_t*   userPtr;            ///< Pointer to the User object.
+    const char*     name;               ///< Interface or service name.
+}
+NameKey_t;
+
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -265,6 +294,7 @@ typedef struct
     User_t*                     userPtr;        ///< Pointer to the User object for the client uid.
     pid_t                       pid;            ///< Process ID of client process.
     svcdir_InterfaceDetails_t   interface;      ///< IPC interface details.
+    NameKey_t                   serviceKey;     ///< Key in the Service Map.
 }
 ServerConnection_t;
 
@@ -275,6 +305,42 @@ ServerConnection_t;
 static le_mem_PoolRef_t ServerConnectionPoolRef;
 
 
+//--------------------------------------------------------------------------------------------------
+/// The Service Map, which indexes the Server Connections on all users' Service Lists by server
+/// User and service name.
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t ServiceMapRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Represents a service that one or more bindings refer to, whether or not a server is currently
+ * serving it.  Objects of this type are allocated from the Bound Service Pool and are kept in the
+ * Bound Service Map.  Each Binding object holds a reference to its Bound Service object.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    NameKey_t       key;                ///< Key in the Bound Service Map.
+    char            serviceName[LIMIT_MAX_IPC_INTERFACE_NAME_BYTES]; ///< Service name.
+    le_dls_List_t   bindingList;        ///< List of Bindings that refer to this service.
+}
+BoundService_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/// Pool from which Bound Service objects are allocated.
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t BoundServicePoolRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/// The Bound Service Map, in which all Bound Service objects are kept, indexed by server User and
+/// service name.
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t BoundServiceMapRef;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Represents a binding from a user's client interface to a service.  Objects of this type are
@@ -290,6 +356,9 @@ typedef struct
     char                serverInterfaceName[LIMIT_MAX_IPC_INTERFACE_NAME_BYTES];///< Service name
     ServerConnection_t* serverConnectionPtr;///< Ptr to Server Connection (NULL if service unavail.)
     le_dls_List_t       waitingClientsList; ///< List of Client Connections waiting for the service.
+    NameKey_t           clientKey;          ///< Key in the Binding Map.
+    BoundService_t*     boundServicePtr;    ///< Ptr to the Bound Service whose Binding List I'm in.
+    le_dls_Link_t       boundServiceLink;   ///< Used to link into the Bound Service's Binding List.
 }
 Binding_t;
 
@@ -300,6 +369,13 @@ Binding_t;
 static le_mem_PoolRef_t BindingPoolRef;
 
 
+//--------------------------------------------------------------------------------------------------
+/// The Binding Map, which indexes the Binding objects on all users' Binding Lists by client User
+/// and client-side interface name.
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t BindingMapRef;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Enumeration of the different states that a client connection can be in.
@@ -370,6 +446,48 @@ static le_fdMonitor_Ref_t ServerSocketMonitorRef;
 // =======================================
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hashes a name key (see NameKey_t).
+ *
+ * @return The hash value.
+ **/
+//--------------------------------------------------------------------------------------------------
+static size_t HashNameKey
+(
+    const void* keyPtr  ///< [in] Pointer to the NameKey_t.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const NameKey_t* nameKeyPtr = keyPtr;
+
+    return le_hashmap_HashString(nameKeyPtr->name)
+           ^ le_hashmap_HashVoidPointer(nameKeyPtr->userPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compares two name keys (see NameKey_t).
+ *
+ * @return true if they refer to the same User and name.
+ **/
+//--------------------------------------------------------------------------------------------------
+static bool EqualsNameKey
+(
+    const void* firstKeyPtr,    ///< [in] Pointer to the first NameKey_t.
+    const void* secondKeyPtr    ///< [in] Pointer to the second NameKey_t.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const NameKey_t* firstPtr = firstKeyPtr;
+    const NameKey_t* secondPtr = secondKeyPtr;
+
+    return (firstPtr->userPtr == secondPtr->userPtr)
+           && (strcmp(firstPtr->name, secondPtr->name) == 0);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a User object for a given Unix user ID.
@@ -399,8 +517,9 @@ static User_t* CreateUser
     userPtr->serviceList = LE_DLS_LIST_INIT;
     userPtr->unboundClientsList = LE_DLS_LIST_INIT;
 
-    // Add it to the User List.
+    // Add it to the User List and the User Map.
     le_dls_Queue(&UserList, &userPtr->link);
+    le_hashmap_Put(UserMapRef, &userPtr->uid, userPtr);
 
     return userPtr;
 }
@@ -408,7 +527,7 @@ static User_t* CreateUser
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Searches the User List for a particular Unix user ID.  If found, increments the reference count
+ * Looks up a particular Unix user ID in the User Map.  If found, increments the reference count
  * on that object.  If not found, creates a new User object.
  *
  * @return Pointer to the User object.
@@ -420,19 +539,12 @@ static User_t* GetUser
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_dls_Link_t* linkPtr = le_dls_Peek(&UserList);
+    User_t* userPtr = le_hashmap_Get(UserMapRef, &uid);
 
-    while (linkPtr != NULL)
+    if (userPtr != NULL)
     {
-        User_t* userPtr = CONTAINER_OF(linkPtr, User_t, link);
-
-        if (userPtr->uid == uid)
-        {
-            le_mem_AddRef(userPtr);
-            return userPtr;
-        }
-
-        linkPtr = le_dls_PeekNext(&UserList, linkPtr);
+        le_mem_AddRef(userPtr);
+        return userPtr;
     }
 
     return CreateUser(uid);
@@ -453,14 +565,16 @@ static void UserDestructor
 {
     User_t* userPtr = objPtr;
 
-    // Remove the User object from the User List.
+    // Remove the User object from the User List and the User Map.
     le_dls_Remove(&UserList, &userPtr->link);
+    le_hashmap_Remove(UserMapRef, &userPtr->uid);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Searches a (client) User's Binding List for a particular client-side interface name.
+ * Looks up a (client) User's binding for a particular client-side interface name in the
+ * Binding Map.
  *
  * @return Pointer to the Binding object or NULL if not found.
  **/
@@ -472,21 +586,91 @@ static Binding_t* FindBinding
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_dls_Link_t* linkPtr = le_dls_Peek(&userPtr->bindingList);
+    NameKey_t key = { .userPtr = userPtr, .name = interfaceName };
 
-    while (linkPtr != NULL)
-    {
-        Binding_t* bindingPtr = CONTAINER_OF(linkPtr, Binding_t, link);
+    return le_hashmap_Get(BindingMapRef, &key);
+}
 
-        if (strcmp(bindingPtr->clientInterfaceName, interfaceName) == 0)
-        {
-            return bindingPtr;
-        }
 
-        linkPtr = le_dls_PeekNext(&userPtr->bindingList, linkPtr);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Looks up the Bound Service object for a given server User and service name in the Bound
+ * Service Map.
+ *
+ * @return Pointer to the Bound Service object or NULL if no binding refers to that service.
+ **/
+//--------------------------------------------------------------------------------------------------
+static BoundService_t* FindBoundService
+(
+    const User_t* userPtr,      ///< [in] Pointer to the server's User object.
+    const char* serviceName     ///< [in] Service name.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    NameKey_t key = { .userPtr = userPtr, .name = serviceName };
+
+    return le_hashmap_Get(BoundServiceMapRef, &key);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the Bound Service object for a given server User and service name.  If found, increments
+ * the reference count on that object.  If not found, creates a new Bound Service object.
+ *
+ * @return Pointer to the Bound Service object.
+ **/
+//--------------------------------------------------------------------------------------------------
+static BoundService_t* GetBoundService
+(
+    User_t* userPtr,            ///< [in] Pointer to the server's User object.
+    const char* serviceName     ///< [in] Service name.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    BoundService_t* boundServicePtr = FindBoundService(userPtr, serviceName);
+
+    if (boundServicePtr != NULL)
+    {
+        le_mem_AddRef(boundServicePtr);
+        return boundServicePtr;
     }
 
-    return NULL;
+    boundServicePtr = le_mem_ForceAlloc(BoundServicePoolRef);
+
+    // Note: we know the service name is a valid length.
+    le_utf8_Copy(boundServicePtr->serviceName,
+                 serviceName,
+                 sizeof(boundServicePtr->serviceName),
+                 NULL);
+
+    boundServicePtr->key.userPtr = userPtr;
+    boundServicePtr->key.name = boundServicePtr->serviceName;
+    boundServicePtr->bindingList = LE_DLS_LIST_INIT;
+
+    le_hashmap_Put(BoundServiceMapRef, &boundServicePtr->key, boundServicePtr);
+
+    return boundServicePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor function that runs when a Bound Service object's reference count reaches zero and
+ * the object is about to be released back into its pool.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BoundServiceDestructor
+(
+    void* objPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    BoundService_t* boundServicePtr = objPtr;
+
+    LE_ASSERT(le_dls_IsEmpty(&boundServicePtr->bindingList));
+
+    le_hashmap_Remove(BoundServiceMapRef, &boundServicePtr->key);
 }
 
 
@@ -597,9 +781,9 @@ static le_result_t ReceiveMessage
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Searches a User's Service List for a particular service name.
+ * Looks up a User's service with a particular service name in the Service Map.
  *
- * @return Pointer to the Server Connection object for the matching service.
+ * @return Pointer to the Server Connection object for the matching service, or NULL if not found.
  **/
 //--------------------------------------------------------------------------------------------------
 static ServerConnection_t* FindService
@@ -609,21 +793,9 @@ static ServerConnection_t* FindService
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_dls_Link_t* linkPtr = le_dls_Peek(&userPtr->serviceList);
+    NameKey_t key = { .userPtr = userPtr, .name = serviceName };
 
-    while (linkPtr != NULL)
-    {
-        ServerConnection_t* serverConnectionPtr = CONTAINER_OF(linkPtr, ServerConnection_t, link);
-
-        if (strcmp(serverConnectionPtr->interface.interfaceName, serviceName) == 0)
-        {
-            return serverConnectionPtr;
-        }
-
-        linkPtr = le_dls_PeekNext(&userPtr->serviceList, linkPtr);
-    }
-
-    return NULL;
+    return le_hashmap_Get(ServiceMapRef, &key);
 }
 
 
@@ -917,8 +1089,16 @@ static void CreateBinding
     bindingPtr->serverConnectionPtr = NULL;
     bindingPtr->waitingClientsList = LE_DLS_LIST_INIT;
 
-    // Add the Binding to the client User's Binding List.
+    // Add the Binding to the client User's Binding List and the Binding Map.
     le_dls_Queue(&bindingPtr->clientUserPtr->bindingList, &bindingPtr->link);
+    bindingPtr->clientKey.userPtr = clientUserPtr;
+    bindingPtr->clientKey.name = bindingPtr->clientInterfaceName;
+    le_hashmap_Put(BindingMapRef, &bindingPtr->clientKey, bindingPtr);
+
+    // Add the Binding to its destination service's Binding List.
+    bindingPtr->boundServicePtr = GetBoundService(serverUserPtr, serverInterfaceName);
+    bindingPtr->boundServiceLink = LE_DLS_LINK_INIT;
+    le_dls_Queue(&bindingPtr->boundServicePtr->bindingList, &bindingPtr->boundServiceLink);
 
     // Look for a server serving the binding's destination service.
     bindingPtr->serverConnectionPtr = FindService(bindingPtr->serverUserPtr, serverInterfaceName);
@@ -1000,51 +1180,43 @@ static void ResolveBindingsToServer
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // For each user,
-    le_dls_Link_t* userLinkPtr = le_dls_Peek(&UserList);
+    BoundService_t* boundServicePtr = FindBoundService(connectionPtr->userPtr,
+                                                       connectionPtr->interface.interfaceName);
+    if (boundServicePtr == NULL)
+    {
+        // No bindings refer to this service.
+        return;
+    }
 
-    while (userLinkPtr != NULL)
+    // For each of the bindings pointing at the new server's service,
+    le_dls_Link_t* bindingLinkPtr = le_dls_Peek(&boundServicePtr->bindingList);
+    while (bindingLinkPtr != NULL)
     {
-        User_t* userPtr = CONTAINER_OF(userLinkPtr, User_t, link);
+        Binding_t* bindingPtr = CONTAINER_OF(bindingLinkPtr, Binding_t, boundServiceLink);
 
-        // For each of the user's bindings,
-        le_dls_Link_t* bindingLinkPtr = le_dls_Peek(&userPtr->bindingList);
-        while (bindingLinkPtr != NULL)
-        {
-            Binding_t* bindingPtr = CONTAINER_OF(bindingLinkPtr, Binding_t, link);
+        bindingPtr->serverConnectionPtr = connectionPtr;
 
-            // If the binding is pointing at the new server's service,
-            if (   (connectionPtr->userPtr == bindingPtr->serverUserPtr)
-                && (0 == strcmp(connectionPtr->interface.interfaceName,
-                                bindingPtr->serverInterfaceName))  )
+        // While there's still a client connection on the Waiting Clients List, get
+        // a pointer to the first one, without removing it from the list, then try
+        // to dispatch that client to the server.
+        le_dls_Link_t* clientLinkPtr;
+        while (NULL != (clientLinkPtr = le_dls_Peek(&bindingPtr->waitingClientsList)))
+        {
+            ClientConnection_t* clientConnectionPtr = CONTAINER_OF(clientLinkPtr,
+                                                                   ClientConnection_t,
+                                                                   link);
+            if (DispatchToServer(clientConnectionPtr, connectionPtr) == LE_CLOSED)
             {
-                bindingPtr->serverConnectionPtr = connectionPtr;
-
-                // While there's still a client connection on the Waiting Clients List, get
-                // a pointer to the first one, without removing it from the list, then try
-                // to dispatch that client to the server.
-                le_dls_Link_t* clientLinkPtr;
-                while (NULL != (clientLinkPtr = le_dls_Peek(&bindingPtr->waitingClientsList)))
-                {
-                    ClientConnection_t* clientConnectionPtr = CONTAINER_OF(clientLinkPtr,
-                                                                           ClientConnection_t,
-                                                                           link);
-                    if (DispatchToServer(clientConnectionPtr, connectionPtr) == LE_CLOSED)
-                    {
-                        // Server went down.  Client was left on the Waiting Clients List.
-                        // Server Connection destructor was run and it disconnected itself
-                        // from the Binding object.
-                        return;
-                    }
-                    // NOTE: If the server didn't go down, then the Client Connection has been
-                    // deleted and its destructor removed it from the Waiting Clients List.
-                }
+                // Server went down.  Client was left on the Waiting Clients List.
+                // Server Connection destructor was run and it disconnected itself
+                // from the Binding object.
+                return;
             }
-
-            bindingLinkPtr = le_dls_PeekNext(&userPtr->bindingList, bindingLinkPtr);
+            // NOTE: If the server didn't go down, then the Client Connection has been
+            // deleted and its destructor removed it from the Waiting Clients List.
         }
 
-        userLinkPtr = le_dls_PeekNext(&UserList, userLinkPtr);
+        bindingLinkPtr = le_dls_PeekNext(&boundServicePtr->bindingList, bindingLinkPtr);
     }
 }
 
@@ -1078,8 +1250,9 @@ static void ProcessAdvertisementFromServer
     // connection to the service list.
     else
     {
-        // Add the object to the User's Service List.
+        // Add the object to the User's Service List and the Service Map.
         le_dls_Queue(&connectionPtr->userPtr->serviceList, &connectionPtr->link);
+        le_hashmap_Put(ServiceMapRef, &connectionPtr->serviceKey, connectionPtr);
 
         LE_DEBUG("Server (uid %u '%s', pid %d) now serving service '%s' (%s).",
                  connectionPtr->userPtr->uid,
@@ -1613,6 +1786,9 @@ static void CreateServerConnection
     // Haven't received ID yet, so clear it out.
     memset(&connectionPtr->interface, 0, sizeof(connectionPtr->interface));
 
+    connectionPtr->serviceKey.userPtr = connectionPtr->userPtr;
+    connectionPtr->serviceKey.name = connectionPtr->interface.interfaceName;
+
     // Set up a File Descriptor Monitor for this new connection, and monitor for hang-up,
     // error, and data arriving.
 
@@ -1640,20 +1816,16 @@ static void ServerConnectionDestructor
 {
     ServerConnection_t* connectionPtr = objPtr;
 
-    // Disassociate the Server Connection object from all Binding objects that refer to it...
-
-    // For each user,
-    le_dls_Link_t* userLinkPtr = le_dls_Peek(&UserList);
-
-    while (userLinkPtr != NULL)
+    // Disassociate the Server Connection object from all Binding objects that refer to it.
+    // Only bindings to the service that it advertised can refer to it.
+    BoundService_t* boundServicePtr = FindBoundService(connectionPtr->userPtr,
+                                                       connectionPtr->interface.interfaceName);
+    if (boundServicePtr != NULL)
     {
-        User_t* userPtr = CONTAINER_OF(userLinkPtr, User_t, link);
-
-        // For each of the user's bindings,
-        le_dls_Link_t* bindingLinkPtr = le_dls_Peek(&userPtr->bindingList);
+        le_dls_Link_t* bindingLinkPtr = le_dls_Peek(&boundServicePtr->bindingList);
         while (bindingLinkPtr != NULL)
         {
-            Binding_t* bindingPtr = CONTAINER_OF(bindingLinkPtr, Binding_t, link);
+            Binding_t* bindingPtr = CONTAINER_OF(bindingLinkPtr, Binding_t, boundServiceLink);
 
             // If the binding is associated with the deleted server connection,
             if (connectionPtr == bindingPtr->serverConnectionPtr)
@@ -1661,10 +1833,8 @@ static void ServerConnectionDestructor
                 bindingPtr->serverConnectionPtr = NULL;
             }
 
-            bindingLinkPtr = le_dls_PeekNext(&userPtr->bindingList, bindingLinkPtr);
+            bindingLinkPtr = le_dls_PeekNext(&boundServicePtr->bindingList, bindingLinkPtr);
         }
-
-        userLinkPtr = le_dls_PeekNext(&UserList, userLinkPtr);
     }
 
     if (connectionPtr->interface.interfaceName[0] == '\0')
@@ -1689,6 +1859,7 @@ static void ServerConnectionDestructor
         if (le_dls_IsInList(&connectionPtr->userPtr->serviceList, &connectionPtr->link))
         {
             le_dls_Remove(&connectionPtr->userPtr->serviceList, &connectionPtr->link);
+            le_hashmap_Remove(ServiceMapRef, &connectionPtr->serviceKey);
         }
     }
 
@@ -1779,8 +1950,14 @@ static void BindingDestructor
 {
     Binding_t* bindingPtr = objPtr;
 
-    // Remove the Binding object from the User's Binding List.
+    // Remove the Binding object from the User's Binding List and the Binding Map.
     le_dls_Remove(&bindingPtr->clientUserPtr->bindingList, &bindingPtr->link);
+    le_hashmap_Remove(BindingMapRef, &bindingPtr->clientKey);
+
+    // Remove the Binding object from its destination service's Binding List.
+    le_dls_Remove(&bindingPtr->boundServicePtr->bindingList, &bindingPtr->boundServiceLink);
+    le_mem_Release(bindingPtr->boundServicePtr);
+    bindingPtr->boundServicePtr = NULL;
 
     // While the list of waiting clients is not empty, pop one off and process it.
     le_dls_Link_t* linkPtr;
@@ -2565,6 +2742,7 @@ COMPONENT_INIT
     ServerConnectionPoolRef = le_mem_CreatePool("Server Connection", sizeof(ServerConnection_t));
     UserPoolRef = le_mem_CreatePool("User", sizeof(User_t));
     BindingPoolRef = le_mem_CreatePool("Binding", sizeof(Binding_t));
+    BoundServicePoolRef = le_mem_CreatePool("Bound Service", sizeof(BoundService_t));
 
     /// Expand the pools to their expected maximum sizes.
     /// @todo Make this configurable.
@@ -2572,12 +2750,20 @@ COMPONENT_INIT
     le_mem_ExpandPool(ServerConnectionPoolRef, 30);
     le_mem_ExpandPool(UserPoolRef, 30);
     le_mem_ExpandPool(BindingPoolRef, 30);
+    le_mem_ExpandPool(BoundServicePoolRef, 30);
 
     // Register destructor functions.
     le_mem_SetDestructor(ClientConnectionPoolRef, ClientConnectionDestructor);
     le_mem_SetDestructor(ServerConnectionPoolRef, ServerConnectionDestructor);
     le_mem_SetDestructor(UserPoolRef, UserDestructor);
     le_mem_SetDestructor(BindingPoolRef, BindingDestructor);
+    le_mem_SetDestructor(BoundServicePoolRef, BoundServiceDestructor);
+
+    // Create the maps that index the lists.
+    UserMapRef = le_hashmap_Create("Users", 31, le_hashmap_HashUInt32, le_hashmap_EqualsUInt32);
+    BindingMapRef = le_hashmap_Create("Bindings", 127, HashNameKey, EqualsNameKey);
+    ServiceMapRef = le_hashmap_Create("Services", 63, HashNameKey, EqualsNameKey);
+    BoundServiceMapRef = le_hashmap_Create("Bound Services", 127, HashNameKey, EqualsNameKey);
 
     // Create built-in, hard-coded bindings.
     CreateHardCodedBindings();
@@ -36,6 +36,7 @@
 #include "fileSystem.h"
 #include "sysPaths.h"
 #include "sysStatus.h"
+#include "bootTrace.h"
 #include <mntent.h>
 #include <linux/limits.h>
 
@@ -1165,6 +1166,7 @@ static int TryToRun
 {
 
     // Start the Supervisor.
+    bootTrace_Mark("start", "launch supervisor");
     pid_t supervisorPid = fork();
     if (supervisorPid == 0)
     {
@@ -1812,6 +1814,10 @@ int main
     char** argv
 )
 {
+    // Start a new boot trace (see the bootTrace tool).
+    bootTrace_Start();
+
+    uint64_t phaseStart = bootTrace_Now();
     bool isReadOnly = sysStatus_IsReadOnly();
 
     if (!isReadOnly)
@@ -1825,15 +1831,28 @@ int main
         MakeDir("/home/root");
     }
 
+    bootTrace_Record("start", "bind mounts", phaseStart);
+
     daemon_Daemonize(5000); // 5 second timeout in case older supervisor is installed.
 
+    bool isFirstRun = true;
+
     while(1)
     {
+        // Each time the framework is restarted, trace its start-up again.
+        if (!isFirstRun)
+        {
+            bootTrace_Start();
+        }
+        isFirstRun = false;
+
         if (!isReadOnly)
         {
             // Verify and install the current system.
             // R/O system are always ready. So, nothing to do for them.
+            phaseStart = bootTrace_Now();
             CheckAndInstallCurrentSystem();
+            bootTrace_Record("start", "check and install system", phaseStart);
         }
 
         // Run the current system.
@@ -30,6 +30,15 @@
  * The working area is not cleaned up by the Supervisor, rather it is left to the installer to
  * clean up.
  *
+ * Setting up a sandbox takes a config tree read for each required or bundled item, a walk of every
+ * linked directory and a bind mount for every linked file.  To avoid most of this the first time a
+ * sandbox is set up its links are compiled into a "sandbox manifest", stored under
+ * SANDBOX_MANIFEST_DIR.  The manifest lists every link (with directories already expanded into
+ * their files), together with the identity (device, inode and modification time) of each directory
+ * that was walked, and it is tagged with the app's hash.  The next time the sandbox is set up, if
+ * the app's hash is the same and none of the walked directories has changed, the links are created
+ * straight from the manifest.  Manifests are discarded whenever the apps' config changes.
+ *
  * @todo Implement support for dynamic files.
  *
  * The application objects instantiated by this class contains a list of process object containers
@@ -59,6 +68,8 @@
 #include "fileDescriptor.h"
 #include "fileSystem.h"
 #include "file.h"
+#include "properties.h"
+#include "bootTrace.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -177,6 +188,39 @@
 #define MAX_CREATE_PROC                                   32
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The name of the node in the config tree that contains the list of applications.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CFG_NODE_APPS_LIST                              "apps"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory where the sandbox manifests are kept, one file per app named after the app.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SANDBOX_MANIFEST_DIR                            CURRENT_SYSTEM_PATH"/sandboxManifests"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * First word of a sandbox manifest's header line.  Must be changed whenever the manifest format,
+ * or what goes into a sandbox, changes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SANDBOX_MANIFEST_MAGIC                          "sandboxManifest1"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes in a sandbox manifest line (including the newline and null-terminator).
+ */
+//--------------------------------------------------------------------------------------------------
+#define SANDBOX_MANIFEST_LINE_BYTES                     (LIMIT_MAX_PATH_BYTES * 2 + 128)
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * File link object.  Used to hold links that should be created for applications.
@@ -341,10 +385,30 @@ typedef struct app_Ref
     le_timer_Ref_t  killTimer;          // Timeout timer for killing processes.
     le_sls_List_t   additionalLinks;    // List of additional links that are temporarily added to
                                         // the app.
+    bool            isSettingUpArea;    // true while the app's working area is being set up.
+    char            lastLinkDir[LIMIT_MAX_PATH_BYTES]; // Last directory made for a link while
+                                                       // setting up the working area.
+    FILE*           manifestFilePtr;    // Sandbox manifest being compiled, or NULL.
 }
 App_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Identity of a directory walked while compiling a sandbox manifest, used to tell whether files
+ * have been added to or removed from it since.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    unsigned long long  dev;            ///< Device containing the directory.
+    unsigned long long  ino;            ///< Inode number.
+    long long           mtimeSec;       ///< Modification time, seconds.
+    long                mtimeNsec;      ///< Modification time, nanoseconds.
+}
+SourceSig_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * The memory pool for application objects.
@@ -1278,6 +1342,7 @@ static le_result_t GetAbsDestPath
 //--------------------------------------------------------------------------------------------------
 static le_result_t CreateIntermediateDirs
 (
+    app_Ref_t appRef,                   ///< [IN] Application reference.
     const char* pathPtr,                ///< [IN] Path.
     const char* smackLabelPtr           ///< [IN] SMACK label to use for the created dirs.
 )
@@ -1290,6 +1355,13 @@ static le_result_t CreateIntermediateDirs
         return LE_FAULT;
     }
 
+    // While the working area is being set up, links are mostly created a directory at a time, so
+    // don't make the same directories over and over again.
+    if (appRef->isSettingUpArea && (strcmp(dirPath, appRef->lastLinkDir) == 0))
+    {
+        return LE_OK;
+    }
+
     if (dir_MakePathSmack(dirPath,
                           S_IRUSR | S_IXUSR | S_IROTH | S_IXOTH,
                           smackLabelPtr) == LE_FAULT)
@@ -1297,10 +1369,143 @@ static le_result_t CreateIntermediateDirs
         return LE_FAULT;
     }
 
+    if (appRef->isSettingUpArea)
+    {
+        LE_ASSERT(le_utf8_Copy(appRef->lastLinkDir, dirPath, sizeof(appRef->lastLinkDir), NULL)
+                  == LE_OK);
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the path of an app's sandbox manifest.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the path is too long.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetManifestPath
+(
+    app_Ref_t appRef,                   ///< [IN] Application reference.
+    const char* suffixPtr,              ///< [IN] Suffix to add to the file name.
+    char* bufPtr,                       ///< [OUT] Buffer to store the path.
+    size_t bufSize                      ///< [IN] Size of the buffer.
+)
+{
+    bufPtr[0] = '\0';
+
+    if (le_path_Concat("/", bufPtr, bufSize, SANDBOX_MANIFEST_DIR, appRef->name, NULL) != LE_OK)
+    {
+        return LE_OVERFLOW;
+    }
+
+    return le_utf8_Append(bufPtr, suffixPtr, bufSize, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the identity of a directory.  Symlinks are followed, just as they are when directories are
+ * walked.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if the directory could not be stat'ed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetSourceSig
+(
+    const char* pathPtr,                ///< [IN] Path to the directory.
+    SourceSig_t* sigPtr                 ///< [OUT] Identity of the directory.
+)
+{
+    struct stat fileStat;
+
+    if (stat(pathPtr, &fileStat) == -1)
+    {
+        return LE_FAULT;
+    }
+
+    memset(sigPtr, 0, sizeof(*sigPtr));
+    sigPtr->dev = fileStat.st_dev;
+    sigPtr->ino = fileStat.st_ino;
+    sigPtr->mtimeSec = fileStat.st_mtim.tv_sec;
+    sigPtr->mtimeNsec = fileStat.st_mtim.tv_nsec;
+
     return LE_OK;
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops compiling an app's sandbox manifest and deletes what has been written of it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AbortSandboxManifest
+(
+    app_Ref_t appRef                    ///< [IN] Application reference.
+)
+{
+    char tmpPath[LIMIT_MAX_PATH_BYTES];
+
+    fclose(appRef->manifestFilePtr);
+    appRef->manifestFilePtr = NULL;
+
+    if (GetManifestPath(appRef, ".new", tmpPath, sizeof(tmpPath)) == LE_OK)
+    {
+        file_Delete(tmpPath);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds an entry to the sandbox manifest being compiled for an app, if any.  Entry types are:
+ *
+ *  - 'F' a file link from the source to the destination.
+ *  - 'D' a directory link from the source to the destination.
+ *  - 'S' the source directory is labelled "*" (shared with everyone).
+ *  - 'W' the source directory was walked.  Only 'W' entries carry the identity of their source:
+ *        whatever the other sources are, the same links are created for them.
+ *
+ * If the entry can't be recorded the manifest is abandoned.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RecordManifestEntry
+(
+    app_Ref_t appRef,                   ///< [IN] Application reference.
+    char type,                          ///< [IN] Entry type.
+    const char* srcPtr,                 ///< [IN] Source path.
+    const char* destPtr                 ///< [IN] Destination path, relative to the working area.
+)
+{
+    if (appRef->manifestFilePtr == NULL)
+    {
+        return;
+    }
+
+    SourceSig_t sig = { 0 };
+
+    if (   (strpbrk(srcPtr, "\t\n") != NULL)
+        || (strpbrk(destPtr, "\t\n") != NULL)
+        || ((type == 'W') && (GetSourceSig(srcPtr, &sig) != LE_OK))
+        || (fprintf(appRef->manifestFilePtr, "%c\t%llu\t%llu\t%lld\t%ld\t%s\t%s\n",
+                    type, sig.dev, sig.ino, sig.mtimeSec, sig.mtimeNsec,
+                    srcPtr, destPtr) < 0) )
+    {
+        LE_WARN("Could not record '%s' in the sandbox manifest for app '%s'.",
+                srcPtr,
+                appRef->name);
+
+        AbortSandboxManifest(appRef);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Check if the link already exists.
@@ -1408,11 +1613,13 @@ static le_result_t CreateDirLink
     }
 
     // Create the necessary intermediate directories along the destination path.
-    if (CreateIntermediateDirs(destPath, appDirLabelPtr) != LE_OK)
+    if (CreateIntermediateDirs(appRef, destPath, appDirLabelPtr) != LE_OK)
     {
         goto failure;
     }
 
+    RecordManifestEntry(appRef, 'D', srcPtr, destPtr);
+
     // See if the destination already exists.
     if (DoesLinkExist(appRef, srcStat, destPath))
     {
@@ -1502,11 +1709,13 @@ static le_result_t CreateFileLink
     }
 
     // Create the necessary intermediate directories along the destination path.
-    if (CreateIntermediateDirs(destPath, appDirLabelPtr) != LE_OK)
+    if (CreateIntermediateDirs(appRef, destPath, appDirLabelPtr) != LE_OK)
     {
         goto failure;
     }
 
+    RecordManifestEntry(appRef, 'F', srcPtr, destPtr);
+
     // See if the destination already exists.
     if (DoesLinkExist(appRef, srcStat, destPath))
     {
@@ -1665,6 +1874,11 @@ static le_result_t RecursivelyCreateLinks
     {
         switch (srcEntPtr->fts_info)
         {
+            case FTS_D:
+                // Files added to or removed from this directory must invalidate the manifest.
+                RecordManifestEntry(appRef, 'W', srcEntPtr->fts_path, "");
+                break;
+
             case FTS_SL:
             case FTS_F:
             case FTS_NSOK:
@@ -2186,6 +2400,8 @@ static le_result_t CreateRequiredLinks
                     return LE_FAULT;
                 }
 
+                RecordManifestEntry(appRef, 'S', srcPath, "");
+
             }
             else
             {
@@ -2227,6 +2443,359 @@ static le_result_t CreateRequiredLinks
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the app's hash from the app's info file.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if the hash could not be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetAppHash
+(
+    app_Ref_t appRef,                   ///< [IN] Application reference.
+    char* bufPtr,                       ///< [OUT] Buffer to store the hash string.
+    size_t bufSize                      ///< [IN] Size of the buffer.
+)
+{
+    char infoFilePath[LIMIT_MAX_PATH_BYTES] = "";
+
+    if (   (le_path_Concat("/", infoFilePath, sizeof(infoFilePath),
+                           appRef->installDirPath, "info.properties", NULL) != LE_OK)
+        || (properties_GetValueForKey(infoFilePath, "app.md5", bufPtr, bufSize) != LE_OK) )
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens a sandbox manifest file.
+ *
+ * @return
+ *      The file stream, or NULL if the file could not be opened.
+ */
+//--------------------------------------------------------------------------------------------------
+static FILE* OpenManifestFile
+(
+    const char* pathPtr,                ///< [IN] Path to the file.
+    bool forWriting                     ///< [IN] true to create the file, false to read it.
+)
+{
+    // The Supervisor forks while the launch workers set up sandboxes, so don't leak the fd.
+    int fd;
+
+    if (forWriting)
+    {
+        fd = open(pathPtr, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    }
+    else
+    {
+        fd = open(pathPtr, O_RDONLY | O_CLOEXEC);
+    }
+
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    FILE* filePtr = fdopen(fd, forWriting ? "w" : "r");
+
+    if (filePtr == NULL)
+    {
+        fd_Close(fd);
+    }
+
+    return filePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Splits a sandbox manifest entry line into its fields.
+ *
+ * @return
+ *      true if the line is a valid entry.
+ *      false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ParseManifestEntry
+(
+    char* linePtr,                      ///< [IN] The line.  Modified to terminate the paths.
+    char* typePtr,                      ///< [OUT] Entry type.
+    SourceSig_t* sigPtr,                ///< [OUT] Identity of the source (walked directories).
+    char** srcPtrPtr,                   ///< [OUT] Source path.
+    char** destPtrPtr                   ///< [OUT] Destination path.
+)
+{
+    int offset = 0;
+
+    memset(sigPtr, 0, sizeof(*sigPtr));
+
+    if (   (sscanf(linePtr, "%c\t%llu\t%llu\t%lld\t%ld%n",
+                   typePtr, &sigPtr->dev, &sigPtr->ino,
+                   &sigPtr->mtimeSec, &sigPtr->mtimeNsec, &offset) != 5)
+        || (linePtr[offset] != '\t') )
+    {
+        return false;
+    }
+
+    char* srcPtr = linePtr + offset + 1;
+    char* destPtr = strchr(srcPtr, '\t');
+    char* endPtr = strchr(srcPtr, '\n');
+
+    if ((destPtr == NULL) || (endPtr == NULL) || (destPtr > endPtr) || (destPtr == srcPtr))
+    {
+        return false;
+    }
+
+    *destPtr++ = '\0';
+    *endPtr = '\0';
+
+    *srcPtrPtr = srcPtr;
+    *destPtrPtr = destPtr;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a sandbox's links from the app's sandbox manifest, if it has one and nothing it was
+ * compiled from has changed.
+ *
+ * @return
+ *      LE_OK if the links were created from the manifest.
+ *      LE_NOT_FOUND if there is no usable manifest.
+ *      LE_FAULT if a link could not be created.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ApplySandboxManifest
+(
+    app_Ref_t appRef,                   ///< [IN] Application reference.
+    const char* appDirLabelPtr          ///< [IN] SMACK label to use for created directories.
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+    char hash[LIMIT_MD5_STR_BYTES];
+
+    if (   (GetManifestPath(appRef, "", path, sizeof(path)) != LE_OK)
+        || (GetAppHash(appRef, hash, sizeof(hash)) != LE_OK) )
+    {
+        return LE_NOT_FOUND;
+    }
+
+    FILE* filePtr = OpenManifestFile(path, false);
+
+    if (filePtr == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    char line[SANDBOX_MANIFEST_LINE_BYTES];
+    char header[SANDBOX_MANIFEST_LINE_BYTES];
+
+    snprintf(header, sizeof(header), "%s %s\n", SANDBOX_MANIFEST_MAGIC, hash);
+
+    if ((fgets(line, sizeof(line), filePtr) == NULL) || (strcmp(line, header) != 0))
+    {
+        LE_INFO("Sandbox manifest for app '%s' is out of date.", appRef->name);
+        fclose(filePtr);
+        return LE_NOT_FOUND;
+    }
+
+    long entriesPos = ftell(filePtr);
+
+    // Check all the walked directories before touching the sandbox.
+    char type;
+    SourceSig_t sig;
+    char* srcPtr;
+    char* destPtr;
+
+    while (fgets(line, sizeof(line), filePtr) != NULL)
+    {
+        SourceSig_t currSig;
+
+        if (!ParseManifestEntry(line, &type, &sig, &srcPtr, &destPtr))
+        {
+            LE_WARN("Sandbox manifest for app '%s' is corrupt.", appRef->name);
+            fclose(filePtr);
+            return LE_NOT_FOUND;
+        }
+
+        if (   (type == 'W')
+            && (   (GetSourceSig(srcPtr, &currSig) != LE_OK)
+                || (memcmp(&sig, &currSig, sizeof(sig)) != 0) ) )
+        {
+            LE_INFO("Sandbox manifest for app '%s' is out of date ('%s' changed).",
+                    appRef->name,
+                    srcPtr);
+            fclose(filePtr);
+            return LE_NOT_FOUND;
+        }
+    }
+
+    // Create the links.
+    le_result_t result = LE_OK;
+
+    fseek(filePtr, entriesPos, SEEK_SET);
+
+    while ((result == LE_OK) && (fgets(line, sizeof(line), filePtr) != NULL))
+    {
+        LE_ASSERT(ParseManifestEntry(line, &type, &sig, &srcPtr, &destPtr));
+
+        switch (type)
+        {
+            case 'F':
+                result = CreateFileLink(appRef, appDirLabelPtr, srcPtr, destPtr);
+                break;
+
+            case 'D':
+                result = CreateDirLink(appRef, appDirLabelPtr, srcPtr, destPtr);
+                break;
+
+            case 'S':
+                result = smack_SetLabel(srcPtr, "*");
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    fclose(filePtr);
+
+    if (result == LE_OK)
+    {
+        LE_INFO("Set up sandbox for app '%s' from its manifest.", appRef->name);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts compiling a sandbox manifest for an app.  The links created for the app are recorded in
+ * the manifest until CloseSandboxManifest() is called.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OpenSandboxManifest
+(
+    app_Ref_t appRef                    ///< [IN] Application reference.
+)
+{
+    char tmpPath[LIMIT_MAX_PATH_BYTES];
+    char hash[LIMIT_MD5_STR_BYTES];
+
+    if (   (GetManifestPath(appRef, ".new", tmpPath, sizeof(tmpPath)) != LE_OK)
+        || (GetAppHash(appRef, hash, sizeof(hash)) != LE_OK) )
+    {
+        return;
+    }
+
+    appRef->manifestFilePtr = OpenManifestFile(tmpPath, true);
+
+    if (appRef->manifestFilePtr == NULL)
+    {
+        LE_WARN("Could not create sandbox manifest '%s'.  %m.", tmpPath);
+        return;
+    }
+
+    if (fprintf(appRef->manifestFilePtr, "%s %s\n", SANDBOX_MANIFEST_MAGIC, hash) < 0)
+    {
+        AbortSandboxManifest(appRef);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finishes compiling an app's sandbox manifest.  The manifest replaces the app's previous one if
+ * the sandbox was set up successfully, otherwise it is discarded.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseSandboxManifest
+(
+    app_Ref_t appRef,                   ///< [IN] Application reference.
+    bool isComplete                     ///< [IN] true if all the links were created.
+)
+{
+    if (appRef->manifestFilePtr == NULL)
+    {
+        return;
+    }
+
+    if (!isComplete)
+    {
+        AbortSandboxManifest(appRef);
+        return;
+    }
+
+    char tmpPath[LIMIT_MAX_PATH_BYTES];
+    char path[LIMIT_MAX_PATH_BYTES];
+
+    LE_ASSERT(GetManifestPath(appRef, ".new", tmpPath, sizeof(tmpPath)) == LE_OK);
+    LE_ASSERT(GetManifestPath(appRef, "", path, sizeof(path)) == LE_OK);
+
+    int result = fclose(appRef->manifestFilePtr);
+    appRef->manifestFilePtr = NULL;
+
+    if ((result != 0) || (rename(tmpPath, path) != 0))
+    {
+        LE_WARN("Could not save sandbox manifest '%s'.  %m.", path);
+        file_Delete(tmpPath);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates the links in the application execution area by following the app's configuration.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateAppAreaLinks
+(
+    app_Ref_t appRef,                   ///< [IN] The application reference.
+    const char* appDirLabelPtr          ///< [IN] SMACK label to use for created directories.
+)
+{
+    // Create default links.
+    if (appRef->sandboxed && (CreateDefaultLinks(appRef, appDirLabelPtr) != LE_OK))
+    {
+        return LE_FAULT;
+    }
+
+    // Create links to the app's lib and bin directories.
+    if (CreateLibBinLinks(appRef, appDirLabelPtr) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    // Create links to bundled files.
+    if (CreateBundledLinks(appRef, appDirLabelPtr) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    // Create links to required files.
+    if (CreateRequiredLinks(appRef, appDirLabelPtr) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets up the application execution area in the file system.  For a sandboxed app this will be the
@@ -2266,33 +2835,34 @@ static le_result_t SetupAppArea
                 return LE_FAULT;
             }
         }
-
-        // Create default links.
-        if (CreateDefaultLinks(appRef, appDirLabel) != LE_OK)
-        {
-            return LE_FAULT;
-        }
     }
 
-    // Create links to the app's lib and bin directories.
-    if (CreateLibBinLinks(appRef, appDirLabel) != LE_OK)
-    {
-        return LE_FAULT;
-    }
+    appRef->isSettingUpArea = true;
+    appRef->lastLinkDir[0] = '\0';
 
-    // Create links to bundled files.
-    if (CreateBundledLinks(appRef, appDirLabel) != LE_OK)
+    le_result_t result = LE_NOT_FOUND;
+
+    if (appRef->sandboxed)
     {
-        return LE_FAULT;
+        result = ApplySandboxManifest(appRef, appDirLabel);
     }
 
-    // Create links to required files.
-    if (CreateRequiredLinks(appRef, appDirLabel) != LE_OK)
+    if (result != LE_OK)
     {
-        return LE_FAULT;
+        // Links that were already created from the manifest will simply be skipped.
+        if (appRef->sandboxed)
+        {
+            OpenSandboxManifest(appRef);
+        }
+
+        result = CreateAppAreaLinks(appRef, appDirLabel);
+
+        CloseSandboxManifest(appRef, (result == LE_OK));
     }
 
-    return LE_OK;
+    appRef->isSettingUpArea = false;
+
+    return result;
 }
 
 
@@ -2473,6 +3043,29 @@ static app_Proc_Ref_t FindProcContainerByName
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Discards all sandbox manifests.  Called when the apps' configuration changes, because that may
+ * change what goes into their sandboxes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DiscardSandboxManifests
+(
+    void* contextPtr                    ///< [IN] Not used.
+)
+{
+    if (le_dir_RemoveRecursive(SANDBOX_MANIFEST_DIR) != LE_OK)
+    {
+        LE_ERROR("Could not remove the sandbox manifests.");
+    }
+
+    if (le_dir_MakePath(SANDBOX_MANIFEST_DIR, S_IRWXU) != LE_OK)
+    {
+        LE_ERROR("Could not make sandbox manifests dir, sandboxes will be set up from scratch.");
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initialize the application system.
@@ -2494,6 +3087,14 @@ void app_Init
     {
         LE_ERROR("Could not make appsWriteable dir, applications may not start.");
     }
+
+    // Create the sandbox manifests area, only accessible to the Supervisor.
+    if (le_dir_MakePath(SANDBOX_MANIFEST_DIR, S_IRWXU) != LE_OK)
+    {
+        LE_ERROR("Could not make sandbox manifests dir, sandboxes will be set up from scratch.");
+    }
+
+    le_cfg_AddChangeHandler(CFG_NODE_APPS_LIST, DiscardSandboxManifests, NULL);
 }
 
 
@@ -2617,6 +3218,8 @@ app_Ref_t app_Create
     const char* cfgPathRootPtr      ///< [IN] The path in the config tree for this application.
 )
 {
+    uint64_t startTime = bootTrace_Now();
+
     // Create a new app object.
     App_t* appPtr = le_mem_ForceAlloc(AppPool);
 
@@ -2639,6 +3242,9 @@ app_Ref_t app_Create
     appPtr->additionalLinks = LE_SLS_LIST_INIT;
     appPtr->state = APP_STATE_STOPPED;
     appPtr->killTimer = NULL;
+    appPtr->isSettingUpArea = false;
+    appPtr->lastLinkDir[0] = '\0';
+    appPtr->manifestFilePtr = NULL;
 
     // Get a config iterator for this app.
     le_cfg_IteratorRef_t cfgIterator = le_cfg_CreateReadTxn(appPtr->cfgPathRoot);
@@ -2756,6 +3362,11 @@ app_Ref_t app_Create
     }
 
     le_cfg_CancelTxn(cfgIterator);
+
+    char traceName[BOOT_TRACE_NAME_BYTES];
+    snprintf(traceName, sizeof(traceName), "%s create", appPtr->name);
+    bootTrace_Record("app", traceName, startTime);
+
     return appPtr;
 
 failed:
@@ -2851,6 +3462,8 @@ le_result_t app_Start
         return LE_FAULT;
     }
 
+    uint64_t startTime = bootTrace_Now();
+
     appRef->state = APP_STATE_RUNNING;
 
     // Create /tmp for sandboxed apps and link in /tmp files.
@@ -2896,6 +3509,10 @@ le_result_t app_Start
         procLinkPtr = le_dls_PeekNext(&(appRef->procs), procLinkPtr);
     }
 
+    char traceName[BOOT_TRACE_NAME_BYTES];
+    snprintf(traceName, sizeof(traceName), "%s start", appRef->name);
+    bootTrace_Record("app", traceName, startTime);
+
     return LE_OK;
 }
 
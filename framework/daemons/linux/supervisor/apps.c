@@ -5,6 +5,7 @@
  * app related IPC messages.
  *
  *  - @ref c_apps_applications
+ *  - @ref c_apps_autoStart
  *  - @ref c_apps_appProcs
  *
  * @section c_apps_applications Applications
@@ -14,6 +15,8 @@
  * An app can be started by either an le_appCtrl_Start() IPC call or automatically on start-up
  * using the apps_AutoStart() API.
  *
+ * @ref c_apps_autoStart describes how apps are started automatically.
+ *
  * When an app's container is created, a new app container object is created which contains a
  * list link, an app stop handler reference and the app object (which is also instantiated).  After
  * the app container object is created, it is placed on the list of inactive apps, waiting to be
@@ -39,6 +42,25 @@
  * means we do not have to recreate app containers each time.  App containers are only cleaned when
  * the app is uninstalled.
  *
+ * @section c_apps_autoStart Automatic Start-Up
+ *
+ * Creating an app's container is the slow part of starting an app: it sets up the app's sandbox
+ * (bind mounts, SMACK rules, cgroups, etc.), and none of it depends on other apps.  So on
+ * start-up, apps_AutoStart() creates the containers of all the auto-start apps concurrently, in a
+ * bounded pool of worker threads, while the main thread starts the apps' processes as their
+ * containers become ready.
+ *
+ * Processes are still only ever started by the main thread, and in dependency order: the IPC
+ * bindings in the apps' configuration (the same ones that "sdir load" sends to the Service
+ * Directory) form a launch graph, and an app is not started until all the auto-start apps that
+ * serve its bound interfaces have been started.  Apps that are part of a dependency cycle are
+ * started once all the containers have been created.  apps_AutoStart() does not return until all
+ * the auto-start apps have been launched, so no IPC requests are handled while it runs.
+ *
+ * The time it took to create the container, to wait for a worker or a dependency, and to start
+ * the processes is recorded for the most recent launch of each app and can be queried with
+ * le_appInfo_GetLaunchTimes() (e.g., "app launchTimes").
+ *
  * @section c_apps_appProcs Application Processes
  *
  * Generally the processes in an application are encapsulated and handled by the application class
@@ -108,6 +130,23 @@
 #define CFG_NODE_SANDBOXED                  "sandboxed"
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The name of the node in the config tree that contains an app's IPC bindings.  Each binding's
+ * "app" node names the app that serves the bound interface.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CFG_NODE_BINDINGS                   "bindings"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of worker threads used to create app containers during auto-start.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_LAUNCH_WORKERS                  4
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * The name of the socket for the AppStop Server and Client.
@@ -144,6 +183,21 @@ static apps_ShutdownHandler_t AllAppsShutdownHandler = NULL;
 struct AppContainer;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timing of the most recent launch of an app, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    bool        isValid;        ///< true if the app has been launched since the Supervisor started.
+    uint32_t    createMs;       ///< Time spent creating the app's container (0 if it existed).
+    uint32_t    waitMs;         ///< Time spent waiting for a worker or for the app's dependencies.
+    uint32_t    startMs;        ///< Time spent starting the app's processes.
+}
+LaunchTimes_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Prototype for app stopped handler.
@@ -174,6 +228,7 @@ typedef struct AppContainer
                                           ///< this app. NULL if not connected client.
     le_appCtrl_TraceAttachHandlerFunc_t traceAttachHandler; ///< Client's trace attach handler.
     void* traceAttachContextPtr;          ///< Context for the client's trace attach handler.
+    LaunchTimes_t           launchTimes;  ///< Timing of the app's most recent launch.
 }
 AppContainer_t;
 
@@ -218,6 +273,97 @@ static le_dls_List_t ActiveAppsList = LE_DLS_LIST_INIT;
 static le_dls_List_t InactiveAppsList = LE_DLS_LIST_INIT;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of an app in the launch graph built by apps_AutoStart().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    LAUNCH_STATE_CREATING,      ///< Waiting for a worker to create the app's container.
+    LAUNCH_STATE_CREATED,       ///< Container created.  Waiting for the app's dependencies.
+    LAUNCH_STATE_DONE           ///< Started, or failed to be created or started.
+}
+LaunchState_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An app in the launch graph built by apps_AutoStart().  Objects of this type are allocated from
+ * the Launch Node Pool and are kept on the Launch List, in the order that the apps appear in the
+ * config tree.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char                appName[LIMIT_MAX_APP_NAME_BYTES];  ///< Name of the app.
+    le_dls_Link_t       link;               ///< Link in the Launch List.
+    le_sls_Link_t       doneLink;           ///< Link in the Created List.
+    LaunchState_t       state;              ///< Where the app is in its launch.
+    AppContainer_t*     appContainerPtr;    ///< App container (NULL until created).
+    app_Ref_t           appRef;             ///< App object created by a worker (NULL if failed).
+    le_sls_List_t       dependentList;      ///< Launch Edges to the apps that depend on this one.
+    size_t              pendingDepCount;    ///< Number of dependencies that are not done yet.
+    le_clk_Time_t       createdTime;        ///< When the app's container was created.
+    uint32_t            createMs;           ///< Time spent creating the app's container.
+}
+LaunchNode_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Edge of the launch graph, from an app to one of the apps that depend on it.  Objects of this
+ * type are allocated from the Launch Edge Pool and are kept on a Launch Node's Dependent List.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_sls_Link_t       link;               ///< Link in the Dependent List.
+    LaunchNode_t*       dependentPtr;       ///< The app that depends on the app whose list I'm in.
+}
+LaunchEdge_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory pools for the launch graph.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t LaunchNodePool;
+static le_mem_PoolRef_t LaunchEdgePool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The Launch List, in which all the Launch Nodes are kept while apps_AutoStart() runs.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t LaunchList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map of app names to the Launch Nodes on the Launch List.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t LaunchNodeMap;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State shared between the main thread and the launch workers.  Protected by LaunchMutex.
+ *
+ * The workers take Launch Nodes from the Launch List, starting at NextCreateLinkPtr, create their
+ * app objects and put them on the Created List.  The main thread is woken up through
+ * LaunchCreatedSem each time a node is put on the Created List.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mutex_Ref_t LaunchMutex;
+static le_sem_Ref_t LaunchCreatedSem;
+static le_dls_Link_t* NextCreateLinkPtr;
+static le_sls_List_t CreatedList = LE_SLS_LIST_INIT;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Application Process object container.
@@ -531,37 +677,21 @@ static AppContainer_t* GetActiveAppWithProc
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create the app container if necessary.  This function searches for the app container in the
- * active and inactive lists first, if it can't find it then it creates the app container.
+ * Creates the app object for an installed app.  This sets up the app's sandbox, so it takes a
+ * while, but it doesn't touch this module's lists, so it can be called by the launch workers.
  *
  * @return
  *  - LE_OK if successful.
- *  - LE_NOT_FOUND if the app is not installed (no container created).
+ *  - LE_NOT_FOUND if the app is not installed.
  *  - LE_FAULT if there was some other error (check logs).
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t CreateApp
+static le_result_t CreateAppObject
 (
-    const char* appNamePtr,          ///< [IN] Name of the application to launch.
-    AppContainer_t** containerPtrPtr ///< [OUT] Ptr to the app container, or NULL if not created.
+    const char* appNamePtr,          ///< [IN] Name of the application.
+    app_Ref_t* appRefPtr             ///< [OUT] Reference to the app object.
 )
 {
-    // Check active list.
-    *containerPtrPtr = GetActiveApp(appNamePtr);
-
-    if (*containerPtrPtr != NULL)
-    {
-        return LE_OK;
-    }
-
-    // Check the inactive list.
-    *containerPtrPtr = GetInactiveApp(appNamePtr);
-
-    if (*containerPtrPtr != NULL)
-    {
-        return LE_OK;
-    }
-
     // Get the configuration path for this app.
     char configPath[LIMIT_MAX_PATH_BYTES] = { 0 };
 
@@ -587,16 +717,31 @@ static le_result_t CreateApp
     }
 
     // Create the app object.
-    app_Ref_t appRef = app_Create(configPath);
+    *appRefPtr = app_Create(configPath);
 
-    if (appRef == NULL)
-    {
-        le_cfg_CancelTxn(appCfg);
+    le_cfg_CancelTxn(appCfg);
 
+    if (*appRefPtr == NULL)
+    {
         return LE_FAULT;
     }
 
-    // Create the app container for this app.
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an app container for an app object and adds it to the inactive list.
+ *
+ * @return Pointer to the app container.
+ */
+//--------------------------------------------------------------------------------------------------
+static AppContainer_t* AddAppContainer
+(
+    app_Ref_t appRef                 ///< [IN] Reference to the app object.
+)
+{
     AppContainer_t* containerPtr = le_mem_ForceAlloc(AppContainerPool);
 
     containerPtr->appRef = appRef;
@@ -605,18 +750,81 @@ static le_result_t CreateApp
     containerPtr->clientRef = NULL;
     containerPtr->traceAttachHandler = NULL;
     containerPtr->traceAttachContextPtr = NULL;
+    memset(&containerPtr->launchTimes, 0, sizeof(containerPtr->launchTimes));
 
     // Add this app to the inactive list.
     le_dls_Queue(&InactiveAppsList, &(containerPtr->link));
     containerPtr->isActive = false;
 
-    le_cfg_CancelTxn(appCfg);
+    return containerPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the app container if necessary.  This function searches for the app container in the
+ * active and inactive lists first, if it can't find it then it creates the app container.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the app is not installed (no container created).
+ *  - LE_FAULT if there was some other error (check logs).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateApp
+(
+    const char* appNamePtr,          ///< [IN] Name of the application to launch.
+    AppContainer_t** containerPtrPtr ///< [OUT] Ptr to the app container, or NULL if not created.
+)
+{
+    // Check active list.
+    *containerPtrPtr = GetActiveApp(appNamePtr);
+
+    if (*containerPtrPtr != NULL)
+    {
+        return LE_OK;
+    }
 
-    *containerPtrPtr = containerPtr;
+    // Check the inactive list.
+    *containerPtrPtr = GetInactiveApp(appNamePtr);
+
+    if (*containerPtrPtr != NULL)
+    {
+        return LE_OK;
+    }
+
+    app_Ref_t appRef;
+    le_result_t result = CreateAppObject(appNamePtr, &appRef);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    *containerPtrPtr = AddAppContainer(appRef);
     return LE_OK;
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the number of milliseconds between two relative times.
+ *
+ * @return The number of milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t ElapsedMs
+(
+    le_clk_Time_t startTime,         ///< [IN] Start of the interval.
+    le_clk_Time_t endTime            ///< [IN] End of the interval.
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(endTime, startTime);
+
+    return (uint32_t)(elapsed.sec * 1000 + elapsed.usec / 1000);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Starts an app.
@@ -661,6 +869,8 @@ static le_result_t LaunchApp
     const char* appNamePtr      ///< [IN] Name of the application to launch.
 )
 {
+    le_clk_Time_t requestTime = le_clk_GetRelativeTime();
+
     // Create the app.
     AppContainer_t* appContainerPtr;
     le_result_t result = CreateApp(appNamePtr, &appContainerPtr);
@@ -675,8 +885,17 @@ static le_result_t LaunchApp
         return LE_DUPLICATE;
     }
 
+    le_clk_Time_t createdTime = le_clk_GetRelativeTime();
+
     // Start the app.
-    return StartApp(appContainerPtr);
+    result = StartApp(appContainerPtr);
+
+    appContainerPtr->launchTimes.isValid = true;
+    appContainerPtr->launchTimes.createMs = ElapsedMs(requestTime, createdTime);
+    appContainerPtr->launchTimes.waitMs = 0;
+    appContainerPtr->launchTimes.startMs = ElapsedMs(createdTime, le_clk_GetRelativeTime());
+
+    return result;
 }
 
 
@@ -1113,6 +1332,254 @@ static void ProcBlockHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds an auto-start app to the launch graph.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddLaunchNode
+(
+    const char* appNamePtr,                 ///< [IN] Name of the app.
+    le_clk_Time_t requestTime               ///< [IN] When the auto-start began.
+)
+{
+    LaunchNode_t* nodePtr = le_mem_ForceAlloc(LaunchNodePool);
+
+    LE_ASSERT(le_utf8_Copy(nodePtr->appName, appNamePtr, sizeof(nodePtr->appName), NULL) == LE_OK);
+    nodePtr->link = LE_DLS_LINK_INIT;
+    nodePtr->doneLink = LE_SLS_LINK_INIT;
+    nodePtr->appRef = NULL;
+    nodePtr->dependentList = LE_SLS_LIST_INIT;
+    nodePtr->pendingDepCount = 0;
+    nodePtr->createdTime = requestTime;
+    nodePtr->createMs = 0;
+
+    // An app whose container already exists doesn't need a worker.
+    nodePtr->appContainerPtr = GetInactiveApp(appNamePtr);
+    if (nodePtr->appContainerPtr == NULL)
+    {
+        nodePtr->appContainerPtr = GetActiveApp(appNamePtr);
+    }
+    nodePtr->state = (nodePtr->appContainerPtr == NULL) ? LAUNCH_STATE_CREATING
+                                                        : LAUNCH_STATE_CREATED;
+
+    le_dls_Queue(&LaunchList, &nodePtr->link);
+    le_hashmap_Put(LaunchNodeMap, nodePtr->appName, nodePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds the edges from the apps that serve an app's bound interfaces to that app.  Bindings to
+ * apps that are not being auto-started, to users, or to the app itself are ignored.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddLaunchEdges
+(
+    LaunchNode_t* nodePtr,                  ///< [IN] The app whose bindings are to be followed.
+    le_cfg_IteratorRef_t appCfg             ///< [IN] Config iterator positioned at the app.
+)
+{
+    le_cfg_GoToNode(appCfg, CFG_NODE_BINDINGS);
+
+    if (le_cfg_GoToFirstChild(appCfg) == LE_OK)
+    {
+        do
+        {
+            char serverName[LIMIT_MAX_APP_NAME_BYTES];
+            LaunchNode_t* serverPtr = NULL;
+
+            if (   (le_cfg_GetString(appCfg, "app", serverName, sizeof(serverName), "") == LE_OK)
+                && (strcmp(serverName, nodePtr->appName) != 0) )
+            {
+                serverPtr = le_hashmap_Get(LaunchNodeMap, serverName);
+            }
+
+            if (serverPtr == NULL)
+            {
+                continue;
+            }
+
+            // Only count each server once, no matter how many interfaces are bound to it.
+            le_sls_Link_t* edgeLinkPtr = le_sls_Peek(&serverPtr->dependentList);
+
+            while (   (edgeLinkPtr != NULL)
+                   && (CONTAINER_OF(edgeLinkPtr, LaunchEdge_t, link)->dependentPtr != nodePtr) )
+            {
+                edgeLinkPtr = le_sls_PeekNext(&serverPtr->dependentList, edgeLinkPtr);
+            }
+
+            if (edgeLinkPtr == NULL)
+            {
+                LaunchEdge_t* edgePtr = le_mem_ForceAlloc(LaunchEdgePool);
+
+                edgePtr->link = LE_SLS_LINK_INIT;
+                edgePtr->dependentPtr = nodePtr;
+                le_sls_Stack(&serverPtr->dependentList, &edgePtr->link);
+
+                nodePtr->pendingDepCount++;
+
+                LE_DEBUG("App '%s' will be started after app '%s'.",
+                         nodePtr->appName,
+                         serverPtr->appName);
+            }
+        }
+        while (le_cfg_GoToNextSibling(appCfg) == LE_OK);
+
+        le_cfg_GoToParent(appCfg);
+    }
+
+    le_cfg_GoToParent(appCfg);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of a launch worker thread.  Creates the app objects of the Launch Nodes on the
+ * Launch List that are waiting for one, until there are none left.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* LaunchWorkerMain
+(
+    void* contextPtr                        ///< [IN] Not used.
+)
+{
+    le_cfg_ConnectService();
+
+    for (;;)
+    {
+        LaunchNode_t* nodePtr = NULL;
+
+        le_mutex_Lock(LaunchMutex);
+
+        while ((NextCreateLinkPtr != NULL) && (nodePtr == NULL))
+        {
+            LaunchNode_t* candidatePtr = CONTAINER_OF(NextCreateLinkPtr, LaunchNode_t, link);
+
+            if (candidatePtr->state == LAUNCH_STATE_CREATING)
+            {
+                nodePtr = candidatePtr;
+            }
+
+            NextCreateLinkPtr = le_dls_PeekNext(&LaunchList, NextCreateLinkPtr);
+        }
+
+        le_mutex_Unlock(LaunchMutex);
+
+        if (nodePtr == NULL)
+        {
+            break;
+        }
+
+        le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+        if (CreateAppObject(nodePtr->appName, &nodePtr->appRef) != LE_OK)
+        {
+            nodePtr->appRef = NULL;
+        }
+
+        nodePtr->createdTime = le_clk_GetRelativeTime();
+        nodePtr->createMs = ElapsedMs(startTime, nodePtr->createdTime);
+
+        le_mutex_Lock(LaunchMutex);
+        le_sls_Queue(&CreatedList, &nodePtr->doneLink);
+        le_mutex_Unlock(LaunchMutex);
+
+        le_sem_Post(LaunchCreatedSem);
+    }
+
+    le_cfg_DisconnectService();
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts an app in the launch graph whose container has been created, unless the creation
+ * failed.  Then does the same for the apps that depend on it whose containers have been created
+ * and that no longer wait for any other app.
+ *
+ * A dependency that failed releases the apps that depend on it just the same, since clients wait
+ * for their services anyway.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FinishLaunchNode
+(
+    LaunchNode_t* nodePtr                   ///< [IN] The app to start.
+)
+{
+    LE_ASSERT(nodePtr->state == LAUNCH_STATE_CREATED);
+
+    nodePtr->state = LAUNCH_STATE_DONE;
+
+    AppContainer_t* appContainerPtr = nodePtr->appContainerPtr;
+
+    if (appContainerPtr == NULL)
+    {
+        // The error has already been logged.
+    }
+    else if (appContainerPtr->isActive)
+    {
+        LE_ERROR("Application '%s' is already running.", nodePtr->appName);
+    }
+    else
+    {
+        le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+        // No need to check the return code because there is nothing we can do about errors.
+        StartApp(appContainerPtr);
+
+        appContainerPtr->launchTimes.isValid = true;
+        appContainerPtr->launchTimes.createMs = nodePtr->createMs;
+        appContainerPtr->launchTimes.waitMs = ElapsedMs(nodePtr->createdTime, startTime);
+        appContainerPtr->launchTimes.startMs = ElapsedMs(startTime, le_clk_GetRelativeTime());
+    }
+
+    le_sls_Link_t* edgeLinkPtr;
+
+    while ((edgeLinkPtr = le_sls_Pop(&nodePtr->dependentList)) != NULL)
+    {
+        LaunchEdge_t* edgePtr = CONTAINER_OF(edgeLinkPtr, LaunchEdge_t, link);
+        LaunchNode_t* dependentPtr = edgePtr->dependentPtr;
+
+        le_mem_Release(edgePtr);
+
+        dependentPtr->pendingDepCount--;
+
+        if ((dependentPtr->pendingDepCount == 0) && (dependentPtr->state == LAUNCH_STATE_CREATED))
+        {
+            FinishLaunchNode(dependentPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handles a Launch Node taken off the Created List, whose app object has been created by a launch
+ * worker (or failed to be).  Starts the app if it doesn't have to wait for its dependencies.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleLaunchNodeCreated
+(
+    LaunchNode_t* nodePtr                   ///< [IN] The app whose app object was created.
+)
+{
+    if (nodePtr->appRef != NULL)
+    {
+        nodePtr->appContainerPtr = AddAppContainer(nodePtr->appRef);
+    }
+
+    nodePtr->state = LAUNCH_STATE_CREATED;
+
+    if (nodePtr->pendingDepCount == 0)
+    {
+        FinishLaunchNode(nodePtr);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initialize the applications system.
@@ -1133,6 +1600,13 @@ void apps_Init
     AppMap = le_ref_CreateMap("App", 5);
     AppAttachHandlerMap = le_ref_CreateMap("AppAttachHandlers", 5);
 
+    LaunchNodePool = le_mem_CreatePool("launchNodes", sizeof(LaunchNode_t));
+    LaunchEdgePool = le_mem_CreatePool("launchEdges", sizeof(LaunchEdge_t));
+    LaunchNodeMap = le_hashmap_Create("LaunchNodes", 31, le_hashmap_HashString,
+                                      le_hashmap_EqualsString);
+    LaunchMutex = le_mutex_CreateNonRecursive("LaunchMutex");
+    LaunchCreatedSem = le_sem_Create("LaunchCreatedSem", 0);
+
     le_instStat_AddAppUninstallEventHandler(DeletesInactiveApp, NULL);
     le_instStat_AddAppInstallEventHandler(DeletesInactiveApp, NULL);
 
@@ -1224,6 +1698,9 @@ void apps_SetShutdownHandler
 //--------------------------------------------------------------------------------------------------
 /**
  * Start all applications marked as 'auto' start.
+ *
+ * The apps' containers are created concurrently and their processes are started in dependency
+ * order (see @ref c_apps_autoStart).  Returns when all the apps have been launched.
  */
 //--------------------------------------------------------------------------------------------------
 void apps_AutoStart
@@ -1231,6 +1708,8 @@ void apps_AutoStart
     void
 )
 {
+    le_clk_Time_t requestTime = le_clk_GetRelativeTime();
+
     // Read the list of applications from the config tree.
     le_cfg_IteratorRef_t appCfg = le_cfg_CreateReadTxn(CFG_NODE_APPS_LIST);
 
@@ -1243,6 +1722,7 @@ void apps_AutoStart
         return;
     }
 
+    // Build the launch graph: first the apps, then the dependencies between them.
     do
     {
         // Check the start mode for this application.
@@ -1259,15 +1739,110 @@ void apps_AutoStart
             }
             else
             {
-                // Launch the application now.  No need to check the return code because there is
-                // nothing we can do about errors.
-                LaunchApp(appName);
+                AddLaunchNode(appName, requestTime);
             }
         }
     }
     while (le_cfg_GoToNextSibling(appCfg) == LE_OK);
 
+    le_cfg_GoToParent(appCfg);
+
+    size_t appCount = 0;
+    size_t createCount = 0;
+    le_dls_Link_t* linkPtr = le_dls_Peek(&LaunchList);
+
+    while (linkPtr != NULL)
+    {
+        LaunchNode_t* nodePtr = CONTAINER_OF(linkPtr, LaunchNode_t, link);
+
+        le_cfg_GoToNode(appCfg, nodePtr->appName);
+        AddLaunchEdges(nodePtr, appCfg);
+        le_cfg_GoToParent(appCfg);
+
+        appCount++;
+        if (nodePtr->state == LAUNCH_STATE_CREATING)
+        {
+            createCount++;
+        }
+
+        linkPtr = le_dls_PeekNext(&LaunchList, linkPtr);
+    }
+
     le_cfg_CancelTxn(appCfg);
+
+    // Start the workers that create the app containers.
+    size_t workerCount = (createCount < MAX_LAUNCH_WORKERS) ? createCount : MAX_LAUNCH_WORKERS;
+    le_thread_Ref_t workers[MAX_LAUNCH_WORKERS];
+    size_t i;
+
+    NextCreateLinkPtr = le_dls_Peek(&LaunchList);
+
+    for (i = 0; i < workerCount; i++)
+    {
+        char threadName[LIMIT_MAX_THREAD_NAME_BYTES];
+
+        snprintf(threadName, sizeof(threadName), "AppLauncher%zu", i);
+
+        workers[i] = le_thread_Create(threadName, LaunchWorkerMain, NULL);
+        le_thread_SetJoinable(workers[i]);
+        le_thread_Start(workers[i]);
+    }
+
+    // Apps whose containers already existed can be started as soon as their dependencies are.
+    linkPtr = le_dls_Peek(&LaunchList);
+
+    while (linkPtr != NULL)
+    {
+        LaunchNode_t* nodePtr = CONTAINER_OF(linkPtr, LaunchNode_t, link);
+
+        if ((nodePtr->state == LAUNCH_STATE_CREATED) && (nodePtr->pendingDepCount == 0))
+        {
+            FinishLaunchNode(nodePtr);
+        }
+
+        linkPtr = le_dls_PeekNext(&LaunchList, linkPtr);
+    }
+
+    // Start the apps as the workers create their containers.
+    for (i = 0; i < createCount; i++)
+    {
+        le_sem_Wait(LaunchCreatedSem);
+
+        le_mutex_Lock(LaunchMutex);
+        le_sls_Link_t* doneLinkPtr = le_sls_Pop(&CreatedList);
+        le_mutex_Unlock(LaunchMutex);
+
+        HandleLaunchNodeCreated(CONTAINER_OF(doneLinkPtr, LaunchNode_t, doneLink));
+    }
+
+    for (i = 0; i < workerCount; i++)
+    {
+        le_thread_Join(workers[i], NULL);
+    }
+
+    // Any app that is still waiting is part of a dependency cycle.  Start those in config order.
+    while ((linkPtr = le_dls_Pop(&LaunchList)) != NULL)
+    {
+        LaunchNode_t* nodePtr = CONTAINER_OF(linkPtr, LaunchNode_t, link);
+
+        if (nodePtr->state == LAUNCH_STATE_CREATED)
+        {
+            LE_WARN("App '%s' is part of a dependency cycle.", nodePtr->appName);
+
+            FinishLaunchNode(nodePtr);
+        }
+
+        LE_ASSERT(le_sls_IsEmpty(&nodePtr->dependentList));
+
+        le_hashmap_Remove(LaunchNodeMap, nodePtr->appName);
+        le_mem_Release(nodePtr);
+    }
+
+    LE_INFO("Launched %zu apps in %u ms (%zu containers created by %zu workers).",
+            appCount,
+            ElapsedMs(requestTime, le_clk_GetRelativeTime()),
+            createCount,
+            workerCount);
 }
 
 
@@ -2206,6 +2781,63 @@ le_result_t le_appInfo_GetHash
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the timing of the most recent launch of an application, in milliseconds.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the application has not been launched since the Supervisor started.
+ *
+ * @note If the application name pointer is null or if its string is empty or of bad format it is a
+ *       fatal error, the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_appInfo_GetLaunchTimes
+(
+    const char* appName,
+        ///< [IN]
+        ///< Application name.
+
+    uint32_t* createTimePtr,
+        ///< [OUT]
+        ///< Time spent creating the app's sandbox.
+
+    uint32_t* waitTimePtr,
+        ///< [OUT]
+        ///< Time spent waiting for the apps it depends on.
+
+    uint32_t* startTimePtr
+        ///< [OUT]
+        ///< Time spent starting the app's processes.
+)
+{
+    if (!IsAppNameValid(appName))
+    {
+        LE_KILL_CLIENT("Invalid app name.");
+        return LE_FAULT;
+    }
+
+    AppContainer_t* appContainerPtr = GetActiveApp(appName);
+
+    if (appContainerPtr == NULL)
+    {
+        appContainerPtr = GetInactiveApp(appName);
+    }
+
+    if ((appContainerPtr == NULL) || (!appContainerPtr->launchTimes.isValid))
+    {
+        return LE_NOT_FOUND;
+    }
+
+    *createTimePtr = appContainerPtr->launchTimes.createMs;
+    *waitTimePtr = appContainerPtr->launchTimes.waitMs;
+    *startTimePtr = appContainerPtr->launchTimes.startMs;
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * A watchdog has timed out. This function determines the watchdogAction to take and applies it.
@@ -14,6 +14,7 @@
 #include "smack.h"
 #include "sysPaths.h"
 #include "wait.h"
+#include "bootTrace.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -101,6 +102,7 @@ static void LoadIpcBindingConfig
     void
 )
 {
+    uint64_t startTime = bootTrace_Now();
 
     // Fork a process.
     pid_t pid = fork();
@@ -153,6 +155,8 @@ static void LoadIpcBindingConfig
         LE_FATAL("Couldn't load IPC binding config. `sdir load` failed for an unknown reason (status = %d).",
             status);
     }
+
+    bootTrace_Record("supervisor", "sdir load", startTime);
 }
 
 
@@ -167,6 +171,7 @@ static void StartDaemon
 )
 {
     const char* daemonNamePtr = le_path_GetBasenamePtr(daemonPtr->path, "/");
+    uint64_t startTime = bootTrace_Now();
 
     // Kill all other instances of this process just in case.
     kill_ByName(daemonNamePtr);
@@ -241,6 +246,9 @@ static void StartDaemon
     fd_Close(syncPipeFd[0]);
 
     LE_INFO("Started system process '%s' with PID: %d.", daemonNamePtr, pid);
+
+    // Record the time from start to ready.
+    bootTrace_Record("daemon", daemonNamePtr, startTime);
 }
 
 
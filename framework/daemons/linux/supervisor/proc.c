@@ -24,6 +24,7 @@
 #include "killProc.h"
 #include "interfaces.h"
 #include "sysStatus.h"
+#include "bootTrace.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -1240,6 +1241,8 @@ le_result_t proc_Start
         return LE_FAULT;
     }
 
+    uint64_t startTime = bootTrace_Now();
+
     // Create a pipe for parent/child synchronization.
     int syncPipeFd[2];
     LE_FATAL_IF(pipe(syncPipeFd) == -1, "Could not create synchronization pipe.  %m.");
@@ -1406,6 +1409,8 @@ le_result_t proc_Start
         procRef->blockPipe = blockPipeFd[WRITE_PIPE];
     }
 
+    bootTrace_Record("proc", procRef->namePtr, startTime);
+
     return LE_OK;
 }
 
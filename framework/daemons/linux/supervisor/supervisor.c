@@ -216,6 +216,7 @@
 #include "sysStatus.h"
 #include "fileDescriptor.h"
 #include "start.h"
+#include "bootTrace.h"
 #include "sysPaths.h"
 #include "sysStatus.h"
 
@@ -423,19 +424,25 @@ static void StartFramework
     alarm(30);
 
     // Start all framework daemons.
+    uint64_t phaseStart = bootTrace_Now();
     fwDaemons_Start();
+    bootTrace_Record("supervisor", "framework daemons", phaseStart);
 
     // Connect to the services we need from the framework daemons.
     LE_DEBUG("---- Connecting to services ----");
+    phaseStart = bootTrace_Now();
     le_cfg_ConnectService();
     logFd_ConnectService();
     le_instStat_ConnectService();
+    bootTrace_Record("supervisor", "connect services", phaseStart);
 
     // Cancel the start-up watchdog timer.
     alarm(0);
 
     // Insert kernel modules
+    phaseStart = bootTrace_Now();
     kernelModules_Insert();
+    bootTrace_Record("supervisor", "kernel modules", phaseStart);
 
     // Advertise services.
     LE_DEBUG("---- Advertising the Supervisor's APIs ----");
@@ -448,8 +455,10 @@ static void StartFramework
     le_appProc_AdvertiseService();
 
     // Initialize the apps sub system.
+    phaseStart = bootTrace_Now();
     apps_Init();
     apps_VerifyAppWriteableDeviceFiles();
+    bootTrace_Record("supervisor", "apps init", phaseStart);
 
     State = STATE_NORMAL;
 
@@ -457,12 +466,17 @@ static void StartFramework
     {
         // Launch all user apps in the config tree that should be launched on system startup.
         LE_INFO("Auto-starting apps.");
+        phaseStart = bootTrace_Now();
         apps_AutoStart();
+        bootTrace_Record("supervisor", "auto-start apps", phaseStart);
     }
     else
     {
         LE_INFO("Skipping app auto-start.");
     }
+
+    // Everything started after this is not part of the boot.
+    bootTrace_Finish();
 }
 
 
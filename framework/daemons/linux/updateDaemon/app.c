@@ -39,6 +39,7 @@
 #include "smack.h"
 #include "sysPaths.h"
 #include "fileSystem.h"
+#include "objectStore.h"
 
 
 static const char* InstallHookScriptPath = "/legato/systems/current/bin/install-hook";
@@ -301,7 +302,16 @@ static le_result_t SetSmackPermReadOnlyDir
     }
 
     fts_close(ftsPtr);
-    return (result == LE_OK) ? LE_OK:LE_FAULT;
+
+    if (result != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    // The labels are final, so the read-only files can now be shared with other apps and versions.
+    objectStore_AddTree(readOnlyPath);
+
+    return LE_OK;
 }
 
 
@@ -530,6 +540,8 @@ static le_result_t PerformAppDelete
         {
             LE_ERROR("Was unable to remove old application path, '%s'.", appPath);
         }
+
+        objectStore_RemoveUnused();
     }
 
     return LE_OK;
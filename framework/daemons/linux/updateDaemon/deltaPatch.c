@@ -0,0 +1,316 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file deltaPatch.c
+ *
+ * Implementation of the file patcher used by delta app updates.
+ *
+ * A BSDIFF40 patch is a 32 byte header followed by three bzip2 streams:
+ *
+ *  - control: triplets (x, y, z) of 8 byte sign-magnitude integers, meaning "add x bytes of the
+ *    diff stream to the x bytes at the current position in the original, then copy y bytes from
+ *    the extra stream, then move the position in the original by z bytes";
+ *  - diff: bytes to add to bytes of the original;
+ *  - extra: bytes copied as they are.
+ *
+ * The bspatch in 3rdParty works on flash partitions through the platform adaptor, so this one is
+ * written for files: it reads the patch and the original from memory, and writes the new file
+ * sequentially, hashing it at the same time.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "fileDescriptor.h"
+#include "deltaPatch.h"
+
+#include <bzlib.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the patch header, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define PATCH_HEADER_BYTES  32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffer that the new file is written from.
+ */
+//--------------------------------------------------------------------------------------------------
+#define OUTPUT_BUFFER_BYTES (64 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * New file contents waiting to be written.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t OutputBuffer[OUTPUT_BUFFER_BYTES];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decodes an 8 byte sign-magnitude integer from a patch.
+ */
+//--------------------------------------------------------------------------------------------------
+static int64_t DecodeInt
+(
+    const uint8_t* bytePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int64_t value = bytePtr[7] & 0x7f;
+    int i;
+
+    for (i = 6; i >= 0; i--)
+    {
+        value = (value << 8) | bytePtr[i];
+    }
+
+    return (bytePtr[7] & 0x80) ? -value : value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads exactly a given number of bytes from one of the patch's bzip2 streams.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadStream
+(
+    bz_stream* streamPtr,
+    uint8_t* bufPtr,
+    size_t len
+)
+//--------------------------------------------------------------------------------------------------
+{
+    streamPtr->next_out = (char*)bufPtr;
+    streamPtr->avail_out = len;
+
+    while (streamPtr->avail_out > 0)
+    {
+        unsigned int availIn = streamPtr->avail_in;
+        unsigned int availOut = streamPtr->avail_out;
+
+        int result = BZ2_bzDecompress(streamPtr);
+
+        if ((result != BZ_OK) && (result != BZ_STREAM_END))
+        {
+            LE_ERROR("Corrupted patch stream (%d).", result);
+            return false;
+        }
+        if ((streamPtr->avail_out > 0) &&
+            ((result == BZ_STREAM_END) ||
+             ((streamPtr->avail_in == availIn) && (streamPtr->avail_out == availOut))))
+        {
+            LE_ERROR("Patch stream ended early.");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes out the contents of the OutputBuffer, adding them to the hash.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FlushOutput
+(
+    int outFd,
+    md5_Ctx_t* md5Ptr,
+    size_t len
+)
+//--------------------------------------------------------------------------------------------------
+{
+    md5_Update(md5Ptr, OutputBuffer, len);
+
+    if (fd_WriteSize(outFd, OutputBuffer, len) != (ssize_t)len)
+    {
+        LE_ERROR("Failed to write patched file (%m).");
+        return false;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuilds a file from the original and a patch.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FORMAT_ERROR if the patch is corrupted or doesn't apply to the original.
+ * - LE_FAULT if the new file couldn't be written.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t deltaPatch_Apply
+(
+    const uint8_t* patchPtr,    ///< [IN] The patch.
+    size_t patchLen,            ///< [IN] Size of the patch, in bytes.
+    const uint8_t* origPtr,     ///< [IN] Contents of the original file.
+    size_t origLen,             ///< [IN] Size of the original file, in bytes.
+    int outFd,                  ///< [IN] File to write the new contents to.
+    md5_Ctx_t* md5Ptr           ///< [IN/OUT] Hash that the new contents are added to.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((patchLen < PATCH_HEADER_BYTES) || (memcmp(patchPtr, "BSDIFF40", 8) != 0))
+    {
+        LE_ERROR("Not a BSDIFF40 patch.");
+        return LE_FORMAT_ERROR;
+    }
+
+    int64_t ctrlLen = DecodeInt(patchPtr + 8);
+    int64_t diffLen = DecodeInt(patchPtr + 16);
+    int64_t newLen = DecodeInt(patchPtr + 24);
+
+    if (   (ctrlLen < 0) || (diffLen < 0) || (newLen < 0)
+        || (ctrlLen > (int64_t)(patchLen - PATCH_HEADER_BYTES))
+        || (diffLen > (int64_t)(patchLen - PATCH_HEADER_BYTES) - ctrlLen) )
+    {
+        LE_ERROR("Bad patch header.");
+        return LE_FORMAT_ERROR;
+    }
+
+    // Set up the three streams.
+    bz_stream streams[3];
+    const size_t streamOffsets[3] = { PATCH_HEADER_BYTES,
+                                      PATCH_HEADER_BYTES + ctrlLen,
+                                      PATCH_HEADER_BYTES + ctrlLen + diffLen };
+    const size_t streamEnds[3] = { PATCH_HEADER_BYTES + ctrlLen,
+                                   PATCH_HEADER_BYTES + ctrlLen + diffLen,
+                                   patchLen };
+    bz_stream* ctrlStreamPtr = &streams[0];
+    bz_stream* diffStreamPtr = &streams[1];
+    bz_stream* extraStreamPtr = &streams[2];
+    int streamCount;
+
+    for (streamCount = 0; streamCount < 3; streamCount++)
+    {
+        memset(&streams[streamCount], 0, sizeof(bz_stream));
+
+        if (BZ2_bzDecompressInit(&streams[streamCount], 0, 0) != BZ_OK)
+        {
+            LE_ERROR("Failed to start bzip2 decompressor.");
+            break;
+        }
+
+        streams[streamCount].next_in = (char*)patchPtr + streamOffsets[streamCount];
+        streams[streamCount].avail_in = streamEnds[streamCount] - streamOffsets[streamCount];
+    }
+
+    le_result_t result = (streamCount == 3) ? LE_OK : LE_FAULT;
+    int64_t newPos = 0;
+    int64_t origPos = 0;
+    size_t outLen = 0;
+
+    while ((result == LE_OK) && (newPos < newLen))
+    {
+        uint8_t ctrl[24];
+
+        if (!ReadStream(ctrlStreamPtr, ctrl, sizeof(ctrl)))
+        {
+            result = LE_FORMAT_ERROR;
+            break;
+        }
+
+        int64_t addLen = DecodeInt(ctrl);
+        int64_t copyLen = DecodeInt(ctrl + 8);
+        int64_t seekLen = DecodeInt(ctrl + 16);
+
+        if ((addLen < 0) || (copyLen < 0) || (addLen > newLen - newPos) ||
+            (copyLen > newLen - newPos - addLen))
+        {
+            LE_ERROR("Bad patch control data.");
+            result = LE_FORMAT_ERROR;
+            break;
+        }
+
+        // Add the diff bytes to the original's bytes (treating bytes outside it as zeros).
+        while ((result == LE_OK) && (addLen > 0))
+        {
+            size_t count = sizeof(OutputBuffer) - outLen;
+            if ((int64_t)count > addLen)
+            {
+                count = addLen;
+            }
+
+            if (!ReadStream(diffStreamPtr, OutputBuffer + outLen, count))
+            {
+                result = LE_FORMAT_ERROR;
+                break;
+            }
+
+            size_t i;
+            for (i = 0; i < count; i++)
+            {
+                if ((origPos + (int64_t)i >= 0) && (origPos + (int64_t)i < (int64_t)origLen))
+                {
+                    OutputBuffer[outLen + i] += origPtr[origPos + i];
+                }
+            }
+
+            outLen += count;
+            newPos += count;
+            origPos += count;
+            addLen -= count;
+
+            if (outLen == sizeof(OutputBuffer))
+            {
+                result = FlushOutput(outFd, md5Ptr, outLen) ? LE_OK : LE_FAULT;
+                outLen = 0;
+            }
+        }
+
+        // Copy the extra bytes.
+        while ((result == LE_OK) && (copyLen > 0))
+        {
+            size_t count = sizeof(OutputBuffer) - outLen;
+            if ((int64_t)count > copyLen)
+            {
+                count = copyLen;
+            }
+
+            if (!ReadStream(extraStreamPtr, OutputBuffer + outLen, count))
+            {
+                result = LE_FORMAT_ERROR;
+                break;
+            }
+
+            outLen += count;
+            newPos += count;
+            copyLen -= count;
+
+            if (outLen == sizeof(OutputBuffer))
+            {
+                result = FlushOutput(outFd, md5Ptr, outLen) ? LE_OK : LE_FAULT;
+                outLen = 0;
+            }
+        }
+
+        origPos += seekLen;
+    }
+
+    if ((result == LE_OK) && (outLen > 0) && !FlushOutput(outFd, md5Ptr, outLen))
+    {
+        result = LE_FAULT;
+    }
+
+    while (streamCount > 0)
+    {
+        BZ2_bzDecompressEnd(&streams[--streamCount]);
+    }
+
+    return result;
+}
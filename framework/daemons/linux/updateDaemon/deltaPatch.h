@@ -0,0 +1,39 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file deltaPatch.h
+ *
+ * Applies binary diffs (in the BSDIFF40 format produced by bsdiff) to files, for delta app
+ * updates.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_DELTA_PATCH_H_INCLUDE_GUARD
+#define LEGATO_DELTA_PATCH_H_INCLUDE_GUARD
+
+#include "md5.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuilds a file from the original and a patch.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FORMAT_ERROR if the patch is corrupted or doesn't apply to the original.
+ * - LE_FAULT if the new file couldn't be written.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t deltaPatch_Apply
+(
+    const uint8_t* patchPtr,    ///< [IN] The patch.
+    size_t patchLen,            ///< [IN] Size of the patch, in bytes.
+    const uint8_t* origPtr,     ///< [IN] Contents of the original file.
+    size_t origLen,             ///< [IN] Size of the original file, in bytes.
+    int outFd,                  ///< [IN] File to write the new contents to.
+    md5_Ctx_t* md5Ptr           ///< [IN/OUT] Hash that the new contents are added to.
+);
+
+
+#endif  // LEGATO_DELTA_PATCH_H_INCLUDE_GUARD
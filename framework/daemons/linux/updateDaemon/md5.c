@@ -0,0 +1,250 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file md5.c
+ *
+ * Implementation of the MD5 message digest algorithm, as described in RFC 1321.
+ *
+ * MD5 is only used here to recognize content (the build tools name apps and systems after an MD5
+ * hash of their files), not for security.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+// Only the C library is used, so that the host tools can build this without the framework.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "md5.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Per-round shift amounts.
+ */
+//--------------------------------------------------------------------------------------------------
+static const uint8_t Shifts[64] =
+{
+    7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,
+    5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,
+    4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,
+    6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Per-round constants (the integer part of abs(sin(i + 1)) * 2^32).
+ */
+//--------------------------------------------------------------------------------------------------
+static const uint32_t Constants[64] =
+{
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hashes one 64 byte block.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HashBlock
+(
+    md5_Ctx_t* ctxPtr,
+    const uint8_t* blockPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t words[16];
+    int i;
+
+    // The block is little-endian, whatever the byte order of the host.
+    for (i = 0; i < 16; i++)
+    {
+        words[i] =   (uint32_t)blockPtr[i * 4]
+                   | ((uint32_t)blockPtr[i * 4 + 1] << 8)
+                   | ((uint32_t)blockPtr[i * 4 + 2] << 16)
+                   | ((uint32_t)blockPtr[i * 4 + 3] << 24);
+    }
+
+    uint32_t a = ctxPtr->state[0];
+    uint32_t b = ctxPtr->state[1];
+    uint32_t c = ctxPtr->state[2];
+    uint32_t d = ctxPtr->state[3];
+
+    for (i = 0; i < 64; i++)
+    {
+        uint32_t f;
+        int g;
+
+        if (i < 16)
+        {
+            f = (b & c) | (~b & d);
+            g = i;
+        }
+        else if (i < 32)
+        {
+            f = (d & b) | (~d & c);
+            g = (5 * i + 1) % 16;
+        }
+        else if (i < 48)
+        {
+            f = b ^ c ^ d;
+            g = (3 * i + 5) % 16;
+        }
+        else
+        {
+            f = c ^ (b | ~d);
+            g = (7 * i) % 16;
+        }
+
+        uint32_t sum = a + f + Constants[i] + words[g];
+
+        a = d;
+        d = c;
+        c = b;
+        b = b + ((sum << Shifts[i]) | (sum >> (32 - Shifts[i])));
+    }
+
+    ctxPtr->state[0] += a;
+    ctxPtr->state[1] += b;
+    ctxPtr->state[2] += c;
+    ctxPtr->state[3] += d;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a new MD5 hash computation.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Init
+(
+    md5_Ctx_t* ctxPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ctxPtr->state[0] = 0x67452301;
+    ctxPtr->state[1] = 0xefcdab89;
+    ctxPtr->state[2] = 0x98badcfe;
+    ctxPtr->state[3] = 0x10325476;
+    ctxPtr->byteCount = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds bytes to an MD5 hash computation.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Update
+(
+    md5_Ctx_t* ctxPtr,
+    const void* dataPtr,    ///< [IN] Bytes to hash.
+    size_t dataLen          ///< [IN] Number of bytes to hash.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const uint8_t* bytePtr = dataPtr;
+    size_t blockUsed = ctxPtr->byteCount % sizeof(ctxPtr->block);
+
+    ctxPtr->byteCount += dataLen;
+
+    // Top up a partial block first.
+    if (blockUsed > 0)
+    {
+        size_t count = sizeof(ctxPtr->block) - blockUsed;
+        if (count > dataLen)
+        {
+            count = dataLen;
+        }
+
+        memcpy(ctxPtr->block + blockUsed, bytePtr, count);
+        bytePtr += count;
+        dataLen -= count;
+
+        if (blockUsed + count < sizeof(ctxPtr->block))
+        {
+            return;
+        }
+
+        HashBlock(ctxPtr, ctxPtr->block);
+    }
+
+    // Hash whole blocks straight out of the caller's buffer.
+    while (dataLen >= sizeof(ctxPtr->block))
+    {
+        HashBlock(ctxPtr, bytePtr);
+        bytePtr += sizeof(ctxPtr->block);
+        dataLen -= sizeof(ctxPtr->block);
+    }
+
+    memcpy(ctxPtr->block, bytePtr, dataLen);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finishes an MD5 hash computation.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Final
+(
+    md5_Ctx_t* ctxPtr,
+    uint8_t digest[MD5_DIGEST_BYTES]    ///< [OUT] The hash.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const uint8_t padding[64] = { 0x80 };
+    uint64_t bitCount = ctxPtr->byteCount * 8;
+    uint8_t lengthBytes[8];
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        lengthBytes[i] = (uint8_t)(bitCount >> (8 * i));
+    }
+
+    // Pad to 56 bytes mod 64, then append the message length in bits.
+    size_t blockUsed = ctxPtr->byteCount % 64;
+    md5_Update(ctxPtr, padding, (blockUsed < 56) ? (56 - blockUsed) : (120 - blockUsed));
+    md5_Update(ctxPtr, lengthBytes, sizeof(lengthBytes));
+
+    for (i = 0; i < 16; i++)
+    {
+        digest[i] = (uint8_t)(ctxPtr->state[i / 4] >> (8 * (i % 4)));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts an MD5 digest to a string of lowercase hex digits (the same format as md5sum prints).
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_ToString
+(
+    const uint8_t digest[MD5_DIGEST_BYTES],
+    char str[MD5_STRING_BYTES]              ///< [OUT] The hash as a string.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    int i;
+
+    for (i = 0; i < MD5_DIGEST_BYTES; i++)
+    {
+        str[i * 2] = hexDigits[digest[i] >> 4];
+        str[i * 2 + 1] = hexDigits[digest[i] & 0xf];
+    }
+
+    str[MD5_STRING_BYTES - 1] = '\0';
+}
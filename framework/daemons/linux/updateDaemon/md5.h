@@ -0,0 +1,97 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file md5.h
+ *
+ * Incremental MD5 hash computation (RFC 1321), used by the Update Daemon to check what it unpacks
+ * against the MD5 hashes computed by the build tools.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_MD5_H_INCLUDE_GUARD
+#define LEGATO_MD5_H_INCLUDE_GUARD
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of an MD5 digest, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MD5_DIGEST_BYTES 16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An MD5 hash string is 32 characters long, plus a null terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MD5_STRING_BYTES 33
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * MD5 hash computation state.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t state[4];      ///< Intermediate digest (A, B, C, D).
+    uint64_t byteCount;     ///< Number of bytes hashed so far.
+    uint8_t  block[64];     ///< Bytes waiting for a complete block.
+}
+md5_Ctx_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a new MD5 hash computation.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Init
+(
+    md5_Ctx_t* ctxPtr
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds bytes to an MD5 hash computation.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Update
+(
+    md5_Ctx_t* ctxPtr,
+    const void* dataPtr,    ///< [IN] Bytes to hash.
+    size_t dataLen          ///< [IN] Number of bytes to hash.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finishes an MD5 hash computation.
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_Final
+(
+    md5_Ctx_t* ctxPtr,
+    uint8_t digest[MD5_DIGEST_BYTES]    ///< [OUT] The hash.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts an MD5 digest to a string of lowercase hex digits (the same format as md5sum prints).
+ */
+//--------------------------------------------------------------------------------------------------
+void md5_ToString
+(
+    const uint8_t digest[MD5_DIGEST_BYTES],
+    char str[MD5_STRING_BYTES]              ///< [OUT] The hash as a string.
+);
+
+
+#endif  // LEGATO_MD5_H_INCLUDE_GUARD
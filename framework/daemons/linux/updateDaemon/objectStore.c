@@ -0,0 +1,466 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file objectStore.c
+ *
+ * Implementation of the content-addressed store of the files of installed apps and systems.
+ *
+ * The store is a flat directory on the same file system as the apps and systems.  Each entry is a
+ * hard link to a file of one or more trees, named "<md5>-<mode>-<uid>-<gid>[-<SMACK label>]".  All
+ * the attributes that live in the inode are part of the name, so that two trees only share a file
+ * if they would have had identical copies of it.  In particular, files of different apps have
+ * different SMACK labels, so with SMACK enabled only the versions of the same app (and the
+ * framework's files of the systems) share files.
+ *
+ * An entry whose link count drops to 1 is no longer used by any tree and is removed.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "file.h"
+#include "fileDescriptor.h"
+#include "smack.h"
+#include "md5.h"
+#include "objectStore.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path to the store's directory.  It must be on the same file system as /legato/apps and
+ * /legato/systems.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* StorePath = "/legato/objects";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name of the extended attribute holding a file's SMACK label.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMACK_LABEL_XATTR   "security.SMACK64"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Suffix of the temporary link used to replace a file atomically.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TEMP_LINK_SUFFIX    "~objectStore"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffer that files are read into to hash them.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t ReadBuffer[64 * 1024];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the SMACK label of a file (an empty string if it has none, or if SMACK is disabled).
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetLabel
+(
+    const char* pathPtr,
+    char label[LIMIT_MAX_SMACK_LABEL_BYTES]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ssize_t len = lgetxattr(pathPtr, SMACK_LABEL_XATTR, label, LIMIT_MAX_SMACK_LABEL_BYTES - 1);
+
+    label[(len > 0) ? len : 0] = '\0';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the path of a file's entry in the store.
+ *
+ * @return LE_OK, or LE_FAULT if the file couldn't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetObjectPath
+(
+    const char* pathPtr,            ///< [IN] Path to the file.
+    const struct stat* statPtr,     ///< [IN] File's status.
+    char objectPath[LIMIT_MAX_PATH_BYTES]   ///< [OUT] Path of the file's entry in the store.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd = open(pathPtr, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd == -1)
+    {
+        LE_ERROR("Failed to open '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+
+    md5_Ctx_t md5;
+    ssize_t len;
+
+    md5_Init(&md5);
+    while ((len = read(fd, ReadBuffer, sizeof(ReadBuffer))) > 0)
+    {
+        md5_Update(&md5, ReadBuffer, len);
+    }
+    fd_Close(fd);
+
+    if (len < 0)
+    {
+        LE_ERROR("Failed to read '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+
+    uint8_t digest[MD5_DIGEST_BYTES];
+    char md5Str[MD5_STRING_BYTES];
+    char label[LIMIT_MAX_SMACK_LABEL_BYTES];
+
+    md5_Final(&md5, digest);
+    md5_ToString(digest, md5Str);
+    GetLabel(pathPtr, label);
+
+    if (snprintf(objectPath,
+                 LIMIT_MAX_PATH_BYTES,
+                 "%s/%s-%o-%u-%u%s%s",
+                 StorePath,
+                 md5Str,
+                 (unsigned int)(statPtr->st_mode & 07777),
+                 (unsigned int)statPtr->st_uid,
+                 (unsigned int)statPtr->st_gid,
+                 (label[0] != '\0') ? "-" : "",
+                 label) >= LIMIT_MAX_PATH_BYTES)
+    {
+        LE_ERROR("Object path too long for '%s'.", pathPtr);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds a regular file to the store, or replaces it by a link to the stored copy.
+ *
+ * @return Number of bytes reclaimed.
+ */
+//--------------------------------------------------------------------------------------------------
+static off_t AddFile
+(
+    const char* pathPtr,            ///< [IN] Path to the file.
+    const struct stat* statPtr      ///< [IN] File's status.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char objectPath[LIMIT_MAX_PATH_BYTES];
+    struct stat objectStat;
+
+    if (GetObjectPath(pathPtr, statPtr, objectPath) != LE_OK)
+    {
+        return 0;
+    }
+
+    if (lstat(objectPath, &objectStat) != 0)
+    {
+        // First copy of this file: it becomes the stored copy.
+        if (link(pathPtr, objectPath) != 0)
+        {
+            LE_WARN("Failed to add '%s' to the object store (%m).", pathPtr);
+        }
+        return 0;
+    }
+
+    if ((objectStat.st_dev == statPtr->st_dev) && (objectStat.st_ino == statPtr->st_ino))
+    {
+        // Already shared.
+        return 0;
+    }
+
+    if (!S_ISREG(objectStat.st_mode) || (objectStat.st_size != statPtr->st_size))
+    {
+        LE_WARN("Object '%s' doesn't match '%s'.", objectPath, pathPtr);
+        return 0;
+    }
+
+    // Replace the file atomically, so it is never missing from its tree.
+    char tempPath[LIMIT_MAX_PATH_BYTES];
+
+    if (snprintf(tempPath, sizeof(tempPath), "%s" TEMP_LINK_SUFFIX, pathPtr) >= sizeof(tempPath))
+    {
+        return 0;
+    }
+
+    (void)unlink(tempPath);
+
+    if (link(objectPath, tempPath) != 0)
+    {
+        // E.g., too many links to the stored copy.
+        LE_DEBUG("Failed to link '%s' to '%s' (%m).", tempPath, objectPath);
+        return 0;
+    }
+
+    if (rename(tempPath, pathPtr) != 0)
+    {
+        LE_WARN("Failed to replace '%s' (%m).", pathPtr);
+        (void)unlink(tempPath);
+        return 0;
+    }
+
+    // The file's own inode is gone only if nothing else linked to it.
+    return (statPtr->st_nlink == 1) ? statPtr->st_size : 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the store, and removes the files that are no longer used by any app or system
+ * (e.g., if the Update Daemon was stopped while it was removing an app).  Must be called once,
+ * before any other function in this module.
+ */
+//--------------------------------------------------------------------------------------------------
+void objectStore_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_FATAL_IF(le_dir_MakePath(StorePath, S_IRWXU) != LE_OK,
+                "Failed to create directory '%s'.",
+                StorePath);
+
+    objectStore_RemoveUnused();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds the regular files of a directory tree to the store.  Files that are already in the store
+ * are replaced by hard links to the stored copy, so their space is reclaimed.  The attributes of
+ * the files must not change afterwards (set SMACK labels first).
+ *
+ * Files that can't be shared are left as they are, so this can't fail.
+ */
+//--------------------------------------------------------------------------------------------------
+void objectStore_AddTree
+(
+    const char* dirPath     ///< [IN] Path to the directory.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* pathArrayPtr[] = { (char*)dirPath, NULL };
+    FTS* ftsPtr = fts_open(pathArrayPtr, FTS_PHYSICAL, NULL);
+
+    if (ftsPtr == NULL)
+    {
+        LE_ERROR("Could not access dir '%s' (%m).", dirPath);
+        return;
+    }
+
+    size_t fileCount = 0;
+    off_t bytesReclaimed = 0;
+
+    FTSENT* entPtr;
+    while ((entPtr = fts_read(ftsPtr)) != NULL)
+    {
+        if (entPtr->fts_info == FTS_F)
+        {
+            fileCount++;
+            bytesReclaimed += AddFile(entPtr->fts_path, entPtr->fts_statp);
+        }
+    }
+
+    fts_close(ftsPtr);
+
+    LE_INFO("Added %zu files of '%s' to the object store (%lld bytes reclaimed).",
+            fileCount,
+            dirPath,
+            (long long)bytesReclaimed);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a directory with the same permissions, owner and SMACK label as another.
+ *
+ * @return LE_OK if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyDir
+(
+    const char* srcPath,
+    const struct stat* statPtr,
+    const char* destPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char label[LIMIT_MAX_SMACK_LABEL_BYTES];
+
+    if (   (mkdir(destPath, S_IRWXU) != 0)
+        || (lchown(destPath, statPtr->st_uid, statPtr->st_gid) != 0)
+        || (chmod(destPath, statPtr->st_mode & 07777) != 0) )
+    {
+        LE_ERROR("Failed to create directory '%s' (%m).", destPath);
+        return LE_FAULT;
+    }
+
+    GetLabel(srcPath, label);
+    if ((label[0] != '\0') && (smack_SetLabel(destPath, label) != LE_OK))
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies a read-only directory tree by hard linking its files instead of copying their contents.
+ * Files that can't be linked are copied.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the copy failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t objectStore_LinkTree
+(
+    const char* srcPath,    ///< [IN] Path to the directory to copy.
+    const char* destPath    ///< [IN] Path to the (non-existent) copy.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* pathArrayPtr[] = { (char*)srcPath, NULL };
+    FTS* ftsPtr = fts_open(pathArrayPtr, FTS_PHYSICAL, NULL);
+
+    if (ftsPtr == NULL)
+    {
+        LE_ERROR("Could not access dir '%s' (%m).", srcPath);
+        return LE_FAULT;
+    }
+
+    size_t srcPathLen = strlen(srcPath);
+    le_result_t result = LE_OK;
+
+    FTSENT* entPtr;
+    while ((result == LE_OK) && ((entPtr = fts_read(ftsPtr)) != NULL))
+    {
+        char newPath[LIMIT_MAX_PATH_BYTES] = "";
+
+        if (le_path_Concat("/", newPath, sizeof(newPath),
+                           destPath, entPtr->fts_path + srcPathLen, NULL) != LE_OK)
+        {
+            LE_ERROR("Destination path to '%s' too long.", entPtr->fts_path);
+            result = LE_FAULT;
+            break;
+        }
+
+        switch (entPtr->fts_info)
+        {
+            case FTS_D:
+                result = CopyDir(entPtr->fts_path, entPtr->fts_statp, newPath);
+                break;
+
+            case FTS_DP:
+                break;
+
+            case FTS_F:
+                if (link(entPtr->fts_path, newPath) != 0)
+                {
+                    LE_DEBUG("Failed to link '%s' (%m); copying it.", entPtr->fts_path);
+
+                    if (file_Copy(entPtr->fts_path, newPath, NULL) != LE_OK)
+                    {
+                        result = LE_FAULT;
+                    }
+                }
+                break;
+
+            case FTS_SL:
+            case FTS_SLNONE:
+            {
+                char target[LIMIT_MAX_PATH_BYTES];
+                ssize_t len = readlink(entPtr->fts_path, target, sizeof(target) - 1);
+
+                if (len < 0)
+                {
+                    LE_ERROR("Failed to read link '%s' (%m).", entPtr->fts_path);
+                    result = LE_FAULT;
+                    break;
+                }
+                target[len] = '\0';
+
+                if (symlink(target, newPath) != 0)
+                {
+                    LE_ERROR("Failed to create link '%s' (%m).", newPath);
+                    result = LE_FAULT;
+                }
+                break;
+            }
+
+            default:
+                LE_ERROR("Unexpected file type %d at '%s'.", entPtr->fts_info, entPtr->fts_path);
+                result = LE_FAULT;
+                break;
+        }
+    }
+
+    fts_close(ftsPtr);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Removes the files in the store that are no longer used by any app or system.  Must be called
+ * after removing apps or systems.
+ */
+//--------------------------------------------------------------------------------------------------
+void objectStore_RemoveUnused
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    DIR* dirPtr = opendir(StorePath);
+
+    if (dirPtr == NULL)
+    {
+        LE_ERROR("Failed to open '%s' (%m).", StorePath);
+        return;
+    }
+
+    size_t removedCount = 0;
+    struct dirent* entryPtr;
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        struct stat st;
+
+        if (   (fstatat(dirfd(dirPtr), entryPtr->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+            && S_ISREG(st.st_mode)
+            && (st.st_nlink == 1) )
+        {
+            if (unlinkat(dirfd(dirPtr), entryPtr->d_name, 0) == 0)
+            {
+                removedCount++;
+            }
+            else
+            {
+                LE_ERROR("Failed to remove object '%s' (%m).", entryPtr->d_name);
+            }
+        }
+    }
+
+    closedir(dirPtr);
+
+    if (removedCount > 0)
+    {
+        LE_INFO("Removed %zu unused files from the object store.", removedCount);
+    }
+}
@@ -0,0 +1,81 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file objectStore.h
+ *
+ * Content-addressed store of the files of installed apps and systems.
+ *
+ * Every installed copy of an app or a system has its own directory tree, but many of their files
+ * are identical (e.g., the same library in several apps, or the framework's files in the current
+ * system and its snapshots).  The store keeps one hard link to each distinct file, named after the
+ * MD5 hash of its contents and its attributes (permissions, owner and SMACK label), so that the
+ * trees can share a single copy of each file.
+ *
+ * Shared files are never modified in place: only the read-only parts of apps and systems are
+ * added to the store.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_OBJECT_STORE_H_INCLUDE_GUARD
+#define LEGATO_OBJECT_STORE_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the store, and removes the files that are no longer used by any app or system
+ * (e.g., if the Update Daemon was stopped while it was removing an app).  Must be called once,
+ * before any other function in this module.
+ */
+//--------------------------------------------------------------------------------------------------
+void objectStore_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds the regular files of a directory tree to the store.  Files that are already in the store
+ * are replaced by hard links to the stored copy, so their space is reclaimed.  The attributes of
+ * the files must not change afterwards (set SMACK labels first).
+ *
+ * Files that can't be shared are left as they are, so this can't fail.
+ */
+//--------------------------------------------------------------------------------------------------
+void objectStore_AddTree
+(
+    const char* dirPath     ///< [IN] Path to the directory.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies a read-only directory tree by hard linking its files instead of copying their contents.
+ * Files that can't be linked are copied.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the copy failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t objectStore_LinkTree
+(
+    const char* srcPath,    ///< [IN] Path to the directory to copy.
+    const char* destPath    ///< [IN] Path to the (non-existent) copy.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Removes the files in the store that are no longer used by any app or system.  Must be called
+ * after removing apps or systems.
+ */
+//--------------------------------------------------------------------------------------------------
+void objectStore_RemoveUnused
+(
+    void
+);
+
+
+#endif  // LEGATO_OBJECT_STORE_H_INCLUDE_GUARD
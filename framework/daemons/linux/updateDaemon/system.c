@@ -23,6 +23,7 @@
 #include "sysPaths.h"
 #include "sysStatus.h"
 #include "smack.h"
+#include "objectStore.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -114,6 +115,15 @@ const char* system_CurrentAppsDir = CURRENT_SYSTEM_PATH "/apps";
 static const char* CurrentAppsWriteableDir = CURRENT_SYSTEM_PATH "/appsWriteable";
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directories of a system that hold the framework's files.  These are never modified once the
+ * system is installed, so their files are shared with the other systems.
+ **/
+//--------------------------------------------------------------------------------------------------
+static const char* const ReadOnlySystemDirs[] = { "bin", "lib", "modules", NULL };
+
+
 // People should really use the const variables, so undefine the macros.
 #undef UNPACK_BASE_PATH
 
@@ -282,6 +292,129 @@ static void SetSystemFilesPermissions
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a directory of a system holds framework files (see ReadOnlySystemDirs).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsReadOnlySystemDir
+(
+    const char* dirNamePtr      ///< [IN] Name of the directory, relative to the system's.
+)
+{
+    int i;
+
+    for (i = 0; ReadOnlySystemDirs[i] != NULL; i++)
+    {
+        if (strcmp(dirNamePtr, ReadOnlySystemDirs[i]) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the framework files of a new system to the object store, so they share storage with the
+ * same files in other systems.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ShareSystemFiles
+(
+    const char* newSystemPath         ///< [IN] Path to new system.
+)
+{
+    int i;
+
+    for (i = 0; ReadOnlySystemDirs[i] != NULL; i++)
+    {
+        char path[LIMIT_MAX_PATH_BYTES] = "";
+
+        LE_ASSERT(snprintf(path, sizeof(path), "%s/%s", newSystemPath, ReadOnlySystemDirs[i])
+                  < sizeof(path));
+
+        if (le_dir_IsDir(path))
+        {
+            objectStore_AddTree(path);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a system.  The framework files are hard linked rather than copied.  Like
+ * file_CopyRecursive(), mounted files and directories are not copied.
+ *
+ * @return LE_OK if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopySystem
+(
+    const char* srcPath,        ///< [IN] Path to the system to copy.
+    const char* destPath        ///< [IN] Path to the (existing, empty) copy.
+)
+{
+    DIR* dirPtr = opendir(srcPath);
+
+    if (dirPtr == NULL)
+    {
+        LE_ERROR("Error opening directory %s.  %m.", srcPath);
+        return LE_FAULT;
+    }
+
+    le_result_t result = LE_OK;
+    struct dirent* entryPtr;
+
+    while ((result == LE_OK) && ((entryPtr = readdir(dirPtr)) != NULL))
+    {
+        char srcEntryPath[LIMIT_MAX_PATH_BYTES] = "";
+        char destEntryPath[LIMIT_MAX_PATH_BYTES] = "";
+        struct stat st;
+
+        if ((strcmp(entryPtr->d_name, ".") == 0) || (strcmp(entryPtr->d_name, "..") == 0))
+        {
+            continue;
+        }
+
+        if (   (le_path_Concat("/", srcEntryPath, sizeof(srcEntryPath),
+                               srcPath, entryPtr->d_name, NULL) != LE_OK)
+            || (le_path_Concat("/", destEntryPath, sizeof(destEntryPath),
+                               destPath, entryPtr->d_name, NULL) != LE_OK) )
+        {
+            LE_ERROR("Path to '%s' is too long.", entryPtr->d_name);
+            result = LE_FAULT;
+            break;
+        }
+
+        if (lstat(srcEntryPath, &st) != 0)
+        {
+            LE_ERROR("Error when trying to lstat '%s'. (%m)", srcEntryPath);
+            result = LE_FAULT;
+        }
+        else if (fs_IsMountPoint(srcEntryPath))
+        {
+            // Mounted things are not part of the system.
+        }
+        else if (S_ISDIR(st.st_mode) && IsReadOnlySystemDir(entryPtr->d_name))
+        {
+            result = objectStore_LinkTree(srcEntryPath, destEntryPath);
+        }
+        else if (file_CopyRecursive(srcEntryPath, destEntryPath, NULL) != LE_OK)
+        {
+            result = LE_FAULT;
+        }
+    }
+
+    closedir(dirPtr);
+
+    return result;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get a given system's index.
@@ -744,6 +877,9 @@ le_result_t system_FinishUpdate
     // path to some index.
     SetSystemFilesPermissions(system_UnpackPath);
 
+    // The labels are final, so the framework files can now be shared with other systems.
+    ShareSystemFiles(system_UnpackPath);
+
     // Now, move the unpacked system into its index.
     char newSystemPath[100] = "";
     snprintf(newSystemPath, sizeof(newSystemPath), "%s/%d", SystemPath, currentIndex);
@@ -783,7 +919,7 @@ le_result_t system_Snapshot
 
     system_PrepUnpackDir();
 
-    if (file_CopyRecursive(CURRENT_SYSTEM_PATH, system_UnpackPath, NULL) != LE_OK)
+    if (CopySystem(CURRENT_SYSTEM_PATH, system_UnpackPath) != LE_OK)
     {
         return LE_FAULT;
     }
@@ -1057,6 +1193,8 @@ void system_RemoveUnusedApps
     }
 
     fts_close(ftsPtr);
+
+    objectStore_RemoveUnused();
 }
 
 
@@ -1185,6 +1323,8 @@ void system_RemoveUnneeded
     }
 
     fts_close(ftsPtr);
+
+    objectStore_RemoveUnused();
 }
 
 
@@ -0,0 +1,2428 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file tarExtract.c
+ *
+ * Implementation of the in-process tarball extractor used by the Update Unpacker.
+ *
+ * Update pack payloads used to be piped into a separate tar process (which in turn ran bzip2),
+ * one kilobyte at a time.  Extracting in-process avoids the fork/exec and the copies through the
+ * pipes, and lets the unpacker hash the content while it is written, instead of reading it all
+ * back to check it.
+ *
+ * The payload goes through two stages:
+ *
+ *  - a decompressor ("codec"), chosen by looking at the first bytes of the payload: bzip2 (what the
+ *    build tools produce), gzip (much faster to decompress than bzip2, for packs that were
+ *    compressed with gzip), or none (a plain tarball).  Concatenated compressed streams are
+ *    accepted, like bzip2 and gzip do.
+ *
+ *  - a tar parser, which understands the ustar and GNU formats (including GNU long names and pax
+ *    path/linkpath/size records), and creates regular files, directories, symbolic links and hard
+ *    links.  Ownership and modification times are not restored (like "tar xmo"); permissions are
+ *    restored exactly (like "tar xp").  Anything else (devices, FIFOs, sparse files, ...) is
+ *    rejected.
+ *
+ * A tarball can also be a delta against an installed app (see tarExtract_SetBase()), in which
+ * case it can also contain entries that keep a file of the installed app (which is hard linked
+ * into the new app) and entries that carry a binary diff to apply to a file of the installed app
+ * (see deltaPatch.h).  Those entries are preceded by pax headers giving the MD5 hash of the file's
+ * contents, so the hash of the whole new app can be computed without reading the kept files.
+ *
+ * Every entry is created relative to the destination directory without following any symbolic
+ * link, and paths containing ".." are rejected, so a tarball can't write outside the destination
+ * directory.
+ *
+ * Every entry is also remembered (path, type, MD5 hash of its contents or target of the link), so
+ * the hash of the whole content can be computed at the end exactly the way the build tools compute
+ * it over a staging directory:
+ *
+ * @verbatim
+   ( find -P -print0 |LC_ALL=C sort -z &&
+     find -P -type f -print0 |LC_ALL=C sort -z |xargs -0 md5sum &&
+     find -P -type l -print0 |LC_ALL=C sort -z |xargs -0 -r -n 1 readlink ) | md5sum
+   @endverbatim
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "fileDescriptor.h"
+#include "tarExtract.h"
+#include "deltaPatch.h"
+
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <bzlib.h>
+#include <zlib.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of a tar block (headers and data are padded to a multiple of this).
+ */
+//--------------------------------------------------------------------------------------------------
+#define TAR_BLOCK_BYTES         512
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes looked at to recognize the compression format.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CODEC_MAGIC_BYTES       4
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffer that the decompressor writes into.  The tar parser writes file contents
+ * straight out of this buffer, so this is also the largest write done to a file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define OUTPUT_BUFFER_BYTES     (64 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest GNU long name or pax extended header accepted, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_EXT_HEADER_BYTES    8192
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest binary diff accepted in a delta, in bytes (it is held in memory while it is applied).
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_PATCH_BYTES         (32 * 1024 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Offsets and sizes of the fields of a ustar header that are used here.
+ */
+//--------------------------------------------------------------------------------------------------
+#define HDR_NAME_OFFSET         0
+#define HDR_NAME_BYTES          100
+#define HDR_MODE_OFFSET         100
+#define HDR_MODE_BYTES          8
+#define HDR_SIZE_OFFSET         124
+#define HDR_SIZE_BYTES          12
+#define HDR_CHKSUM_OFFSET       148
+#define HDR_CHKSUM_BYTES        8
+#define HDR_TYPE_OFFSET         156
+#define HDR_LINKNAME_OFFSET     157
+#define HDR_LINKNAME_BYTES      100
+#define HDR_MAGIC_OFFSET        257
+#define HDR_PREFIX_OFFSET       345
+#define HDR_PREFIX_BYTES        155
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A decompressor.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* name;           ///< Name used in log messages.
+    bool hasEndMarker;          ///< true if the compressed stream marks its own end.
+
+    /// Checks whether the first bytes of a payload are in this format.
+    bool (*isMatch)(const uint8_t* magicPtr);
+
+    /// Starts decompressing a stream.  Returns LE_OK or LE_FAULT.
+    le_result_t (*start)(void);
+
+    /// Decompresses as much as it can.  Returns LE_OK, LE_FORMAT_ERROR or LE_FAULT.
+    le_result_t (*decompress)(const uint8_t** inPtrPtr,     ///< [IN/OUT] Compressed bytes.
+                              size_t* inLenPtr,             ///< [IN/OUT] # of compressed bytes.
+                              uint8_t* outPtr,              ///< [OUT] Decompressed bytes.
+                              size_t* outLenPtr,            ///< [IN/OUT] Buffer size/# produced.
+                              bool* isEndPtr);              ///< [OUT] true at the end of a stream.
+
+    /// Releases the decompressor's resources.
+    void (*stop)(void);
+}
+Codec_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Something extracted from the tarball.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_sls_Link_t link;                     ///< Link in the EntryList.
+    char type;                              ///< 'f' (file), 'd' (directory) or 'l' (symlink).
+    uint8_t digest[MD5_DIGEST_BYTES];       ///< MD5 hash of the file's contents (files only).
+    char path[LIMIT_MAX_PATH_BYTES];        ///< Path, as find prints it ("." or "./...").
+    char target[LIMIT_MAX_PATH_BYTES];      ///< Target of the link (symlinks only).
+}
+Entry_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the tar parser.
+ */
+//--------------------------------------------------------------------------------------------------
+static enum
+{
+    TAR_HEADER,         ///< Reading a header block.
+    TAR_FILE_DATA,      ///< Writing the contents of a regular file.
+    TAR_EXT_DATA,       ///< Reading a GNU long name or a pax extended header.
+    TAR_SKIP_DATA,      ///< Skipping data that isn't needed (pax global header).
+    TAR_PATCH_DATA,     ///< Reading a binary diff (deltas only).
+    TAR_PADDING,        ///< Skipping the padding after some data.
+    TAR_END             ///< Found the end of the archive.
+}
+TarState = TAR_HEADER;
+
+
+/// Pool of Entry_t objects.
+static le_mem_PoolRef_t EntryPool;
+
+/// Entries (Entry_t), by path.
+static le_hashmap_Ref_t EntryMap;
+
+/// All the entries, for releasing them and for hashing.
+static le_sls_List_t EntryList = LE_SLS_LIST_INIT;
+
+/// File descriptor of the destination directory (-1 if not extracting).
+static int RootFd = -1;
+
+/// File descriptor of the directory that the last entry was created in (-1 if none).
+static int ParentFd = -1;
+
+/// Path (relative to the destination directory) of the directory that ParentFd refers to.
+static char ParentPath[LIMIT_MAX_PATH_BYTES];
+
+/// File descriptor of the installed app that a delta applies to (-1 if not extracting a delta).
+static int BaseFd = -1;
+
+/// Decompressor (NULL until enough bytes have been received to recognize the format).
+static const Codec_t* CodecPtr = NULL;
+
+/// First bytes of the payload, kept until the decompressor is chosen.
+static uint8_t MagicBuffer[CODEC_MAGIC_BYTES];
+
+/// Number of bytes in the MagicBuffer.
+static size_t MagicLen;
+
+/// true if the decompressor found the end of the compressed stream.
+static bool IsStreamEnded;
+
+/// Decompressed bytes.
+static uint8_t OutputBuffer[OUTPUT_BUFFER_BYTES];
+
+/// Header block being received.
+static uint8_t HeaderBuffer[TAR_BLOCK_BYTES];
+
+/// Number of bytes in the HeaderBuffer.
+static size_t HeaderLen;
+
+/// Size of the current entry's data.
+static uint64_t EntrySize;
+
+/// Number of bytes of the current entry's data not received yet.
+static uint64_t DataRemaining;
+
+/// Number of padding bytes not received yet.
+static size_t PaddingRemaining;
+
+/// Type of the extended header being received ('L', 'K' or 'x').
+static char ExtType;
+
+/// Extended header being received.
+static char ExtBuffer[MAX_EXT_HEADER_BYTES];
+
+/// Number of bytes in the ExtBuffer.
+static size_t ExtLen;
+
+/// Path given by an extended header for the next entry (empty if none).
+static char PendingPath[LIMIT_MAX_PATH_BYTES];
+
+/// Link target given by an extended header for the next entry (empty if none).
+static char PendingLinkPath[LIMIT_MAX_PATH_BYTES];
+
+/// true if a pax header gave the size of the next entry.
+static bool HasPendingSize;
+
+/// Size of the next entry given by a pax header.
+static uint64_t PendingSize;
+
+/// true if a pax header gave the MD5 hash of the next entry's contents.
+static bool HasPendingDigest;
+
+/// MD5 hash of the next entry's contents given by a pax header.
+static uint8_t PendingDigest[MD5_DIGEST_BYTES];
+
+/// Binary diff being received (NULL if none).
+static uint8_t* PatchBufferPtr = NULL;
+
+/// Number of bytes in the patch buffer.
+static size_t PatchLen;
+
+/// Path of the file that the binary diff being received produces.
+static char PatchPath[LIMIT_MAX_PATH_BYTES];
+
+/// Path (in the installed app) of the file that the binary diff being received applies to.
+static char PatchOrigPath[LIMIT_MAX_PATH_BYTES];
+
+/// Permissions of the file that the binary diff being received produces.
+static mode_t PatchMode;
+
+/// MD5 hash of the file that the binary diff being received produces.
+static uint8_t PatchDigest[MD5_DIGEST_BYTES];
+
+/// File being written (-1 if none).
+static int FileFd = -1;
+
+/// Permissions to give to the file being written once it is complete.
+static mode_t FileMode;
+
+/// Entry of the file being written.
+static Entry_t* FileEntryPtr;
+
+/// Hash of the contents of the file being written.
+static md5_Ctx_t FileMd5;
+
+/// bzip2 decompressor state.
+static bz_stream BzStream;
+
+/// gzip decompressor state.
+static z_stream ZStream;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a payload starts with the bzip2 magic ("BZh" followed by the block size).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsBzip2
+(
+    const uint8_t* magicPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (memcmp(magicPtr, "BZh", 3) == 0) && (magicPtr[3] >= '1') && (magicPtr[3] <= '9');
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts decompressing a bzip2 stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StartBzip2
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    memset(&BzStream, 0, sizeof(BzStream));
+
+    int result = BZ2_bzDecompressInit(&BzStream, 0, 0);
+    if (result != BZ_OK)
+    {
+        LE_ERROR("Failed to start bzip2 decompressor (%d).", result);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decompresses bzip2 data.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t DecompressBzip2
+(
+    const uint8_t** inPtrPtr,
+    size_t* inLenPtr,
+    uint8_t* outPtr,
+    size_t* outLenPtr,
+    bool* isEndPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    BzStream.next_in = (char*)*inPtrPtr;
+    BzStream.avail_in = *inLenPtr;
+    BzStream.next_out = (char*)outPtr;
+    BzStream.avail_out = *outLenPtr;
+
+    int result = BZ2_bzDecompress(&BzStream);
+
+    *inPtrPtr = (const uint8_t*)BzStream.next_in;
+    *inLenPtr = BzStream.avail_in;
+    *outLenPtr -= BzStream.avail_out;
+
+    switch (result)
+    {
+        case BZ_STREAM_END:
+            *isEndPtr = true;
+            return LE_OK;
+
+        case BZ_OK:
+            return LE_OK;
+
+        case BZ_MEM_ERROR:
+            LE_ERROR("Out of memory decompressing bzip2 data.");
+            return LE_FAULT;
+
+        default:
+            LE_ERROR("Corrupted bzip2 data (%d).", result);
+            return LE_FORMAT_ERROR;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Releases the bzip2 decompressor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopBzip2
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    BZ2_bzDecompressEnd(&BzStream);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether a payload starts with the gzip magic.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsGzip
+(
+    const uint8_t* magicPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (magicPtr[0] == 0x1f) && (magicPtr[1] == 0x8b);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts decompressing a gzip stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StartGzip
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    memset(&ZStream, 0, sizeof(ZStream));
+
+    // Adding 16 to the window bits selects the gzip wrapper (instead of zlib's).
+    int result = inflateInit2(&ZStream, 16 + MAX_WBITS);
+    if (result != Z_OK)
+    {
+        LE_ERROR("Failed to start gzip decompressor (%d).", result);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decompresses gzip data.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t DecompressGzip
+(
+    const uint8_t** inPtrPtr,
+    size_t* inLenPtr,
+    uint8_t* outPtr,
+    size_t* outLenPtr,
+    bool* isEndPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ZStream.next_in = (Bytef*)*inPtrPtr;
+    ZStream.avail_in = *inLenPtr;
+    ZStream.next_out = outPtr;
+    ZStream.avail_out = *outLenPtr;
+
+    int result = inflate(&ZStream, Z_NO_FLUSH);
+
+    *inPtrPtr = ZStream.next_in;
+    *inLenPtr = ZStream.avail_in;
+    *outLenPtr -= ZStream.avail_out;
+
+    switch (result)
+    {
+        case Z_STREAM_END:
+            *isEndPtr = true;
+            return LE_OK;
+
+        case Z_OK:
+        case Z_BUF_ERROR:   // No progress possible; more input is needed.
+            return LE_OK;
+
+        case Z_MEM_ERROR:
+            LE_ERROR("Out of memory decompressing gzip data.");
+            return LE_FAULT;
+
+        default:
+            LE_ERROR("Corrupted gzip data (%d: %s).", result, ZStream.msg ? ZStream.msg : "");
+            return LE_FORMAT_ERROR;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Releases the gzip decompressor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopGzip
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    inflateEnd(&ZStream);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Matches any payload (used for uncompressed tarballs).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsAnything
+(
+    const uint8_t* magicPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts passing through an uncompressed stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StartNone
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies uncompressed data.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyNone
+(
+    const uint8_t** inPtrPtr,
+    size_t* inLenPtr,
+    uint8_t* outPtr,
+    size_t* outLenPtr,
+    bool* isEndPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count = (*inLenPtr < *outLenPtr) ? *inLenPtr : *outLenPtr;
+
+    memcpy(outPtr, *inPtrPtr, count);
+
+    *inPtrPtr += count;
+    *inLenPtr -= count;
+    *outLenPtr = count;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops passing through an uncompressed stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopNone
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The decompressors, in the order in which they are tried.  The last one matches anything.
+ */
+//--------------------------------------------------------------------------------------------------
+static const Codec_t Codecs[] =
+{
+    { "bzip2", true, IsBzip2, StartBzip2, DecompressBzip2, StopBzip2 },
+    { "gzip", true, IsGzip, StartGzip, DecompressGzip, StopGzip },
+    { "none", false, IsAnything, StartNone, CopyNone, StopNone },
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies a header field, which may not be null-terminated, into a string.
+ *
+ * @return LE_OK, or LE_OVERFLOW if the string doesn't fit.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyField
+(
+    char* destPtr,
+    size_t destSize,
+    const uint8_t* fieldPtr,
+    size_t fieldSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t len = strnlen((const char*)fieldPtr, fieldSize);
+
+    if (len >= destSize)
+    {
+        return LE_OVERFLOW;
+    }
+
+    memcpy(destPtr, fieldPtr, len);
+    destPtr[len] = '\0';
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parses a numeric header field: octal digits, or GNU's base-256 for values that don't fit.
+ *
+ * @return true if successful.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ParseNumber
+(
+    const uint8_t* fieldPtr,
+    size_t fieldSize,
+    uint64_t* valuePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t value = 0;
+    size_t i = 0;
+
+    if (fieldPtr[0] & 0x80)
+    {
+        // Base-256, big-endian.  Negative numbers aren't valid for anything used here.
+        if (fieldPtr[0] & 0x40)
+        {
+            return false;
+        }
+
+        value = fieldPtr[0] & 0x3f;
+
+        for (i = 1; i < fieldSize; i++)
+        {
+            if (value >> 56)
+            {
+                return false;
+            }
+            value = (value << 8) | fieldPtr[i];
+        }
+
+        *valuePtr = value;
+        return true;
+    }
+
+    while ((i < fieldSize) && (fieldPtr[i] == ' '))
+    {
+        i++;
+    }
+
+    for (; (i < fieldSize) && (fieldPtr[i] >= '0') && (fieldPtr[i] <= '7'); i++)
+    {
+        value = (value << 3) | (fieldPtr[i] - '0');
+    }
+
+    if ((i < fieldSize) && (fieldPtr[i] != ' ') && (fieldPtr[i] != '\0'))
+    {
+        return false;
+    }
+
+    *valuePtr = value;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks the checksum of the header in the HeaderBuffer.  Both the POSIX (unsigned) and the old
+ * (signed) sums are accepted.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsHeaderChecksumValid
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t expected;
+    uint32_t unsignedSum = 0;
+    int32_t signedSum = 0;
+    size_t i;
+
+    if (!ParseNumber(HeaderBuffer + HDR_CHKSUM_OFFSET, HDR_CHKSUM_BYTES, &expected))
+    {
+        return false;
+    }
+
+    for (i = 0; i < TAR_BLOCK_BYTES; i++)
+    {
+        // The checksum field itself counts as spaces.
+        uint8_t byte = ((i >= HDR_CHKSUM_OFFSET) && (i < HDR_CHKSUM_OFFSET + HDR_CHKSUM_BYTES)) ?
+                       ' ' : HeaderBuffer[i];
+
+        unsignedSum += byte;
+        signedSum += (int8_t)byte;
+    }
+
+    return (expected == unsignedSum) || ((int64_t)expected == signedSum);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts a path from the tarball into the form that find prints ("." or "./a/b"): leading
+ * slashes, "." components and repeated or trailing slashes are dropped.
+ *
+ * @return LE_OK, or LE_FORMAT_ERROR if the path contains ".." or is too long.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t NormalizePath
+(
+    const char* rawPathPtr,
+    char* pathPtr               ///< [OUT] Buffer of LIMIT_MAX_PATH_BYTES.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t len = 1;
+
+    pathPtr[0] = '.';
+
+    while (*rawPathPtr != '\0')
+    {
+        const char* endPtr = strchrnul(rawPathPtr, '/');
+        size_t compLen = endPtr - rawPathPtr;
+
+        if ((compLen == 2) && (memcmp(rawPathPtr, "..", 2) == 0))
+        {
+            LE_ERROR("Tarball entry path contains '..'.");
+            return LE_FORMAT_ERROR;
+        }
+
+        if ((compLen > 0) && !((compLen == 1) && (rawPathPtr[0] == '.')))
+        {
+            if (len + 1 + compLen >= LIMIT_MAX_PATH_BYTES)
+            {
+                LE_ERROR("Tarball entry path is too long.");
+                return LE_FORMAT_ERROR;
+            }
+
+            pathPtr[len++] = '/';
+            memcpy(pathPtr + len, rawPathPtr, compLen);
+            len += compLen;
+        }
+
+        rawPathPtr = (*endPtr == '/') ? endPtr + 1 : endPtr;
+    }
+
+    pathPtr[len] = '\0';
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens a directory under the destination (or base) directory, without following symbolic links,
+ * optionally creating any missing directories along the way.
+ *
+ * @return The file descriptor, or -1 on error (logged).
+ */
+//--------------------------------------------------------------------------------------------------
+static int OpenDir
+(
+    int topFd,              ///< [IN] Destination or base directory.
+    const char* dirPath,    ///< [IN] Path relative to topFd ("" for topFd itself).
+    bool isCreating         ///< [IN] true to create missing directories.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd = dup(topFd);
+
+    while ((fd != -1) && (*dirPath != '\0'))
+    {
+        char compName[LIMIT_MAX_PATH_BYTES];
+        const char* endPtr = strchrnul(dirPath, '/');
+
+        memcpy(compName, dirPath, endPtr - dirPath);
+        compName[endPtr - dirPath] = '\0';
+
+        int childFd = openat(fd, compName, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+        if ((childFd == -1) && (errno == ENOENT) && isCreating)
+        {
+            if ((mkdirat(fd, compName, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == 0) ||
+                (errno == EEXIST))
+            {
+                childFd = openat(fd, compName, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            }
+        }
+
+        if (childFd == -1)
+        {
+            LE_ERROR("Failed to open directory '%s' (%m).", compName);
+        }
+
+        fd_Close(fd);
+        fd = childFd;
+
+        dirPath = (*endPtr == '/') ? endPtr + 1 : endPtr;
+    }
+
+    return fd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Splits an entry path ("./a/b/c") in place into the path of its directory relative to the top
+ * directory ("a/b", or "" for the top directory itself) and its name ("c").
+ */
+//--------------------------------------------------------------------------------------------------
+static void SplitPath
+(
+    char* pathPtr,                  ///< [IN] Entry path, other than "." (modified).
+    const char** dirPathPtrPtr,     ///< [OUT] Directory path.
+    const char** namePtrPtr         ///< [OUT] Name of the entry in the directory.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char* lastSlashPtr = strrchr(pathPtr, '/');
+
+    *lastSlashPtr = '\0';
+    *namePtrPtr = lastSlashPtr + 1;
+    *dirPathPtrPtr = (pathPtr[1] == '\0') ? pathPtr + 1 : pathPtr + 2;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the directory that an entry goes in.
+ *
+ * @return LE_OK, or LE_FAULT if the directory couldn't be opened.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetParentDir
+(
+    const char* pathPtr,            ///< [IN] Entry path ("./...").
+    int* fdPtr,                     ///< [OUT] Directory's file descriptor (don't close it).
+    const char** baseNamePtrPtr     ///< [OUT] Name of the entry in the directory.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* relPathPtr = pathPtr + 2;
+    const char* lastSlashPtr = strrchr(relPathPtr, '/');
+
+    if (lastSlashPtr == NULL)
+    {
+        *fdPtr = RootFd;
+        *baseNamePtrPtr = relPathPtr;
+        return LE_OK;
+    }
+
+    size_t dirLen = lastSlashPtr - relPathPtr;
+
+    // Tarballs list the contents of a directory together, so usually the directory is the same as
+    // for the previous entry.
+    if (   (ParentFd == -1)
+        || (strncmp(ParentPath, relPathPtr, dirLen) != 0)
+        || (ParentPath[dirLen] != '\0') )
+    {
+        if (ParentFd != -1)
+        {
+            fd_Close(ParentFd);
+        }
+
+        memcpy(ParentPath, relPathPtr, dirLen);
+        ParentPath[dirLen] = '\0';
+
+        ParentFd = OpenDir(RootFd, ParentPath, true);
+        if (ParentFd == -1)
+        {
+            return LE_FAULT;
+        }
+    }
+
+    *fdPtr = ParentFd;
+    *baseNamePtrPtr = lastSlashPtr + 1;
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Removes whatever non-directory is in the way of a new entry.
+ *
+ * @return LE_OK, or LE_FAULT on error (logged).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RemoveExisting
+(
+    int dirFd,
+    const char* baseName,
+    const char* pathPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((unlinkat(dirFd, baseName, 0) != 0) && (errno != ENOENT))
+    {
+        LE_ERROR("Failed to replace '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the entry for a path, creating it if it doesn't exist yet.
+ */
+//--------------------------------------------------------------------------------------------------
+static Entry_t* GetEntry
+(
+    const char* pathPtr,
+    char type
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Entry_t* entryPtr = le_hashmap_Get(EntryMap, pathPtr);
+
+    if (entryPtr == NULL)
+    {
+        entryPtr = le_mem_ForceAlloc(EntryPool);
+        entryPtr->link = LE_SLS_LINK_INIT;
+        LE_ASSERT(le_utf8_Copy(entryPtr->path, pathPtr, sizeof(entryPtr->path), NULL) == LE_OK);
+
+        le_sls_Queue(&EntryList, &entryPtr->link);
+        le_hashmap_Put(EntryMap, entryPtr->path, entryPtr);
+    }
+
+    entryPtr->type = type;
+    entryPtr->target[0] = '\0';
+
+    return entryPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a new, empty regular file, replacing whatever non-directory was there.  The file is
+ * write-only until its final permissions are set.
+ *
+ * @return The file descriptor, or -1 on error (logged).
+ */
+//--------------------------------------------------------------------------------------------------
+static int OpenNewFile
+(
+    const char* pathPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int dirFd;
+    const char* baseName;
+
+    if (   (GetParentDir(pathPtr, &dirFd, &baseName) != LE_OK)
+        || (RemoveExisting(dirFd, baseName, pathPtr) != LE_OK) )
+    {
+        return -1;
+    }
+
+    int fd = openat(dirFd, baseName, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                    S_IRUSR | S_IWUSR);
+    if (fd == -1)
+    {
+        LE_ERROR("Failed to create '%s' (%m).", pathPtr);
+    }
+
+    return fd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts the padding that follows an entry's data.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartPadding
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    PaddingRemaining = (TAR_BLOCK_BYTES - (EntrySize % TAR_BLOCK_BYTES)) % TAR_BLOCK_BYTES;
+    TarState = (PaddingRemaining > 0) ? TAR_PADDING : TAR_HEADER;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finishes writing a regular file.
+ *
+ * @return LE_OK, or LE_FAULT on error (logged).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FinishFile
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = LE_OK;
+
+    md5_Final(&FileMd5, FileEntryPtr->digest);
+
+    if (fchmod(FileFd, FileMode) != 0)
+    {
+        LE_ERROR("Failed to set permissions of '%s' (%m).", FileEntryPtr->path);
+        result = LE_FAULT;
+    }
+
+    fd_Close(FileFd);
+    FileFd = -1;
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a regular file.  Its contents follow the header.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateFile
+(
+    const char* pathPtr,
+    mode_t mode
+)
+//--------------------------------------------------------------------------------------------------
+{
+    FileFd = OpenNewFile(pathPtr);
+    if (FileFd == -1)
+    {
+        return LE_FAULT;
+    }
+
+    FileEntryPtr = GetEntry(pathPtr, 'f');
+    FileMode = mode;
+    md5_Init(&FileMd5);
+
+    DataRemaining = EntrySize;
+
+    if (DataRemaining == 0)
+    {
+        StartPadding();
+        return FinishFile();
+    }
+
+    TarState = TAR_FILE_DATA;
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a directory.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateDir
+(
+    const char* pathPtr,
+    mode_t mode
+)
+//--------------------------------------------------------------------------------------------------
+{
+    GetEntry(pathPtr, 'd');
+
+    if (strcmp(pathPtr, ".") == 0)
+    {
+        if (fchmod(RootFd, mode) != 0)
+        {
+            LE_ERROR("Failed to set permissions of unpack directory (%m).");
+            return LE_FAULT;
+        }
+        return LE_OK;
+    }
+
+    int dirFd;
+    const char* baseName;
+    struct stat st;
+
+    if (GetParentDir(pathPtr, &dirFd, &baseName) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (mkdirat(dirFd, baseName, S_IRWXU) != 0)
+    {
+        if (   (errno != EEXIST)
+            || (fstatat(dirFd, baseName, &st, AT_SYMLINK_NOFOLLOW) != 0)
+            || !S_ISDIR(st.st_mode) )
+        {
+            LE_ERROR("Failed to create directory '%s' (%m).", pathPtr);
+            return LE_FAULT;
+        }
+    }
+
+    // Set the exact permissions, regardless of the umask.
+    if (fchmodat(dirFd, baseName, mode, 0) != 0)
+    {
+        LE_ERROR("Failed to set permissions of '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a symbolic link.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateSymlink
+(
+    const char* pathPtr,
+    const char* targetPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int dirFd;
+    const char* baseName;
+
+    if (   (GetParentDir(pathPtr, &dirFd, &baseName) != LE_OK)
+        || (RemoveExisting(dirFd, baseName, pathPtr) != LE_OK) )
+    {
+        return LE_FAULT;
+    }
+
+    if (symlinkat(targetPtr, dirFd, baseName) != 0)
+    {
+        LE_ERROR("Failed to create symlink '%s' (%m).", pathPtr);
+        return LE_FAULT;
+    }
+
+    Entry_t* entryPtr = GetEntry(pathPtr, 'l');
+    LE_ASSERT(le_utf8_Copy(entryPtr->target, targetPtr, sizeof(entryPtr->target), NULL) == LE_OK);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a hard link to a regular file extracted earlier.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateHardLink
+(
+    const char* pathPtr,
+    const char* rawTargetPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char targetPath[LIMIT_MAX_PATH_BYTES];
+
+    if (NormalizePath(rawTargetPtr, targetPath) != LE_OK)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    Entry_t* targetPtr = le_hashmap_Get(EntryMap, targetPath);
+    if ((targetPtr == NULL) || (targetPtr->type != 'f'))
+    {
+        LE_ERROR("Hard link '%s' points to '%s', which isn't a file in the tarball.",
+                 pathPtr,
+                 targetPath);
+        return LE_FORMAT_ERROR;
+    }
+
+    // The target's directory is opened separately, because the link's directory may be different.
+    const char* targetDirPath;
+    const char* targetBaseName;
+    SplitPath(targetPath, &targetDirPath, &targetBaseName);
+
+    int targetDirFd = OpenDir(RootFd, targetDirPath, false);
+    if (targetDirFd == -1)
+    {
+        return LE_FAULT;
+    }
+
+    le_result_t result = LE_OK;
+    int dirFd;
+    const char* baseName;
+
+    if (   (GetParentDir(pathPtr, &dirFd, &baseName) != LE_OK)
+        || (RemoveExisting(dirFd, baseName, pathPtr) != LE_OK) )
+    {
+        result = LE_FAULT;
+    }
+    else if (linkat(targetDirFd, targetBaseName, dirFd, baseName, 0) != 0)
+    {
+        LE_ERROR("Failed to create hard link '%s' (%m).", pathPtr);
+        result = LE_FAULT;
+    }
+    else
+    {
+        // find sees the link as another regular file with the same contents.
+        uint8_t digest[MD5_DIGEST_BYTES];
+        memcpy(digest, targetPtr->digest, sizeof(digest));
+
+        Entry_t* entryPtr = GetEntry(pathPtr, 'f');
+        memcpy(entryPtr->digest, digest, sizeof(digest));
+    }
+
+    fd_Close(targetDirFd);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens the directory in the installed app that a delta entry refers to.
+ *
+ * @return LE_OK, or LE_FORMAT_ERROR if the path isn't valid or the directory doesn't exist (the
+ *         delta doesn't apply to the installed app).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t OpenOrigDir
+(
+    const char* rawOrigPathPtr,     ///< [IN] Path of the file in the installed app.
+    int* dirFdPtr,                  ///< [OUT] Directory's file descriptor (to be closed).
+    char* nameBuffer                ///< [OUT] Buffer of LIMIT_MAX_PATH_BYTES for the file's name.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char origPath[LIMIT_MAX_PATH_BYTES];
+    const char* dirPath;
+    const char* name;
+
+    if (BaseFd == -1)
+    {
+        LE_ERROR("Delta entry for '%s' in a tarball that isn't a delta.", rawOrigPathPtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    if ((NormalizePath(rawOrigPathPtr, origPath) != LE_OK) || (strcmp(origPath, ".") == 0))
+    {
+        LE_ERROR("Bad delta entry '%s'.", rawOrigPathPtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    SplitPath(origPath, &dirPath, &name);
+    strcpy(nameBuffer, name);
+
+    *dirFdPtr = OpenDir(BaseFd, dirPath, false);
+    if (*dirFdPtr == -1)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens a regular file in the installed app that a delta entry refers to.
+ *
+ * @return LE_OK, or LE_FORMAT_ERROR if the file doesn't exist (the delta doesn't apply to the
+ *         installed app).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t OpenOrigFile
+(
+    int dirFd,                      ///< [IN] Directory from OpenOrigDir().
+    const char* name,               ///< [IN] Name from OpenOrigDir().
+    int* fdPtr,                     ///< [OUT] File descriptor (to be closed).
+    struct stat* statPtr            ///< [OUT] File's status.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    *fdPtr = openat(dirFd, name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (*fdPtr == -1)
+    {
+        LE_ERROR("Can't open '%s' in installed app (%m).", name);
+        return LE_FORMAT_ERROR;
+    }
+
+    if ((fstat(*fdPtr, statPtr) != 0) || !S_ISREG(statPtr->st_mode))
+    {
+        LE_ERROR("'%s' in installed app is not a regular file.", name);
+        fd_Close(*fdPtr);
+        return LE_FORMAT_ERROR;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parses a hex MD5 hash.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseDigest
+(
+    const char* strPtr,
+    size_t len,
+    uint8_t digest[MD5_DIGEST_BYTES]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    if (len != MD5_STRING_BYTES - 1)
+    {
+        LE_ERROR("Bad MD5 hash in pax header.");
+        return LE_FORMAT_ERROR;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        int digit = isdigit(strPtr[i]) ? (strPtr[i] - '0') :
+                    ((strPtr[i] >= 'a') && (strPtr[i] <= 'f')) ? (strPtr[i] - 'a' + 10) : -1;
+        if (digit < 0)
+        {
+            LE_ERROR("Bad MD5 hash in pax header.");
+            return LE_FORMAT_ERROR;
+        }
+
+        if (i % 2 == 0)
+        {
+            digest[i / 2] = digit << 4;
+        }
+        else
+        {
+            digest[i / 2] |= digit;
+        }
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds a file of the installed app to the new app unchanged, by hard linking it (or copying it if
+ * it can't be linked).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t KeepFile
+(
+    const char* pathPtr,
+    const char* rawOrigPathPtr,
+    const uint8_t digest[MD5_DIGEST_BYTES]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char origName[LIMIT_MAX_PATH_BYTES];
+    int origDirFd;
+    int origFd;
+    struct stat st;
+    int dirFd;
+    const char* baseName;
+
+    le_result_t result = OpenOrigDir(rawOrigPathPtr, &origDirFd, origName);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    result = OpenOrigFile(origDirFd, origName, &origFd, &st);
+    if (result != LE_OK)
+    {
+        fd_Close(origDirFd);
+        return result;
+    }
+
+    if (   (GetParentDir(pathPtr, &dirFd, &baseName) != LE_OK)
+        || (RemoveExisting(dirFd, baseName, pathPtr) != LE_OK) )
+    {
+        result = LE_FAULT;
+    }
+    else if (linkat(origDirFd, origName, dirFd, baseName, 0) != 0)
+    {
+        LE_DEBUG("Can't link '%s' to installed app (%m); copying it.", pathPtr);
+
+        int fd = OpenNewFile(pathPtr);
+        if (fd == -1)
+        {
+            result = LE_FAULT;
+        }
+        else
+        {
+            off_t offset = 0;
+
+            while (offset < st.st_size)
+            {
+                if (sendfile(fd, origFd, &offset, st.st_size - offset) <= 0)
+                {
+                    LE_ERROR("Failed to copy '%s' from installed app (%m).", pathPtr);
+                    result = LE_FAULT;
+                    break;
+                }
+            }
+
+            if ((result == LE_OK) && (fchmod(fd, st.st_mode & 07777) != 0))
+            {
+                LE_ERROR("Failed to set permissions of '%s' (%m).", pathPtr);
+                result = LE_FAULT;
+            }
+
+            fd_Close(fd);
+        }
+    }
+
+    fd_Close(origFd);
+    fd_Close(origDirFd);
+
+    if (result == LE_OK)
+    {
+        Entry_t* entryPtr = GetEntry(pathPtr, 'f');
+        memcpy(entryPtr->digest, digest, MD5_DIGEST_BYTES);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds a file of the new app by applying the binary diff that was just received to a file of
+ * the installed app.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ApplyPatch
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char origName[LIMIT_MAX_PATH_BYTES];
+    int origDirFd;
+    int origFd;
+    struct stat st;
+
+    le_result_t result = OpenOrigDir(PatchOrigPath, &origDirFd, origName);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    result = OpenOrigFile(origDirFd, origName, &origFd, &st);
+    fd_Close(origDirFd);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    void* origPtr = NULL;
+    if (st.st_size > 0)
+    {
+        origPtr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, origFd, 0);
+        if (origPtr == MAP_FAILED)
+        {
+            LE_ERROR("Failed to map '%s' (%m).", PatchOrigPath);
+            fd_Close(origFd);
+            return LE_FAULT;
+        }
+    }
+
+    int fd = OpenNewFile(PatchPath);
+    if (fd == -1)
+    {
+        result = LE_FAULT;
+    }
+    else
+    {
+        md5_Ctx_t md5;
+        uint8_t digest[MD5_DIGEST_BYTES];
+
+        md5_Init(&md5);
+        result = deltaPatch_Apply(PatchBufferPtr, PatchLen, origPtr, st.st_size, fd, &md5);
+        md5_Final(&md5, digest);
+
+        if ((result == LE_OK) && (memcmp(digest, PatchDigest, sizeof(digest)) != 0))
+        {
+            LE_ERROR("Patched '%s' doesn't have the expected contents.", PatchPath);
+            result = LE_FORMAT_ERROR;
+        }
+
+        if ((result == LE_OK) && (fchmod(fd, PatchMode) != 0))
+        {
+            LE_ERROR("Failed to set permissions of '%s' (%m).", PatchPath);
+            result = LE_FAULT;
+        }
+
+        fd_Close(fd);
+
+        if (result == LE_OK)
+        {
+            Entry_t* entryPtr = GetEntry(PatchPath, 'f');
+            memcpy(entryPtr->digest, digest, sizeof(digest));
+        }
+    }
+
+    if (origPtr != NULL)
+    {
+        munmap(origPtr, st.st_size);
+    }
+    fd_Close(origFd);
+
+    free(PatchBufferPtr);
+    PatchBufferPtr = NULL;
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the value of a pax record into a buffer of LIMIT_MAX_PATH_BYTES.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyPaxValue
+(
+    char* destPtr,
+    const char* valuePtr,
+    size_t valueLen
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (valueLen >= LIMIT_MAX_PATH_BYTES)
+    {
+        LE_ERROR("Path in pax header is too long.");
+        return LE_FORMAT_ERROR;
+    }
+
+    memcpy(destPtr, valuePtr, valueLen);
+    destPtr[valueLen] = '\0';
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Processes a complete GNU long name, GNU long link name or pax extended header.  The values apply
+ * to the next entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ProcessExtHeader
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ExtBuffer[ExtLen] = '\0';
+
+    if (ExtType == 'L')
+    {
+        return CopyField(PendingPath, sizeof(PendingPath), (uint8_t*)ExtBuffer, ExtLen) == LE_OK ?
+               LE_OK : LE_FORMAT_ERROR;
+    }
+    if (ExtType == 'K')
+    {
+        return CopyField(PendingLinkPath, sizeof(PendingLinkPath), (uint8_t*)ExtBuffer, ExtLen)
+               == LE_OK ? LE_OK : LE_FORMAT_ERROR;
+    }
+
+    // pax records look like "<length> <key>=<value>\n", where <length> covers the whole record.
+    size_t offset = 0;
+
+    while (offset < ExtLen)
+    {
+        char* recordPtr = ExtBuffer + offset;
+        char* keyPtr;
+        unsigned long recordLen = strtoul(recordPtr, &keyPtr, 10);
+
+        if (   (*keyPtr != ' ')
+            || (recordLen <= (size_t)(keyPtr - recordPtr))
+            || (recordLen > ExtLen - offset)
+            || (recordPtr[recordLen - 1] != '\n') )
+        {
+            LE_ERROR("Malformed pax extended header.");
+            return LE_FORMAT_ERROR;
+        }
+
+        keyPtr++;
+
+        char* valuePtr = memchr(keyPtr, '=', recordPtr + recordLen - keyPtr);
+        if (valuePtr == NULL)
+        {
+            LE_ERROR("Malformed pax extended header record.");
+            return LE_FORMAT_ERROR;
+        }
+
+        size_t keyLen = valuePtr - keyPtr;
+        valuePtr++;
+        size_t valueLen = recordPtr + recordLen - 1 - valuePtr;
+
+        if ((keyLen == 4) && (memcmp(keyPtr, "path", 4) == 0))
+        {
+            if (CopyPaxValue(PendingPath, valuePtr, valueLen) != LE_OK)
+            {
+                return LE_FORMAT_ERROR;
+            }
+        }
+        else if ((keyLen == 8) && (memcmp(keyPtr, "linkpath", 8) == 0))
+        {
+            if (CopyPaxValue(PendingLinkPath, valuePtr, valueLen) != LE_OK)
+            {
+                return LE_FORMAT_ERROR;
+            }
+        }
+        else if ((keyLen == 4) && (memcmp(keyPtr, "size", 4) == 0))
+        {
+            PendingSize = strtoull(valuePtr, NULL, 10);
+            HasPendingSize = true;
+        }
+        else if (   (keyLen == sizeof(TAR_EXTRACT_PAX_MD5) - 1)
+                 && (memcmp(keyPtr, TAR_EXTRACT_PAX_MD5, keyLen) == 0) )
+        {
+            if (ParseDigest(valuePtr, valueLen, PendingDigest) != LE_OK)
+            {
+                return LE_FORMAT_ERROR;
+            }
+            HasPendingDigest = true;
+        }
+
+        offset += recordLen;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Processes a complete header block.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ProcessHeader
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    // A block of zeros marks the end of the archive.  Anything after that is ignored.
+    for (i = 0; (i < TAR_BLOCK_BYTES) && (HeaderBuffer[i] == 0); i++)
+    {
+    }
+    if (i == TAR_BLOCK_BYTES)
+    {
+        TarState = TAR_END;
+        return LE_OK;
+    }
+
+    if (!IsHeaderChecksumValid())
+    {
+        LE_ERROR("Bad tarball header checksum.");
+        return LE_FORMAT_ERROR;
+    }
+
+    uint64_t mode;
+
+    if (   !ParseNumber(HeaderBuffer + HDR_SIZE_OFFSET, HDR_SIZE_BYTES, &EntrySize)
+        || !ParseNumber(HeaderBuffer + HDR_MODE_OFFSET, HDR_MODE_BYTES, &mode) )
+    {
+        LE_ERROR("Bad number in tarball header.");
+        return LE_FORMAT_ERROR;
+    }
+
+    char type = HeaderBuffer[HDR_TYPE_OFFSET];
+
+    // Extended headers carry values for the next entry in their data.
+    if ((type == 'L') || (type == 'K') || (type == 'x'))
+    {
+        if (EntrySize >= sizeof(ExtBuffer))
+        {
+            LE_ERROR("Tarball extended header is too long (%" PRIu64 " bytes).", EntrySize);
+            return LE_FORMAT_ERROR;
+        }
+
+        ExtType = type;
+        ExtLen = 0;
+        DataRemaining = EntrySize;
+
+        if (DataRemaining == 0)
+        {
+            StartPadding();
+            return ProcessExtHeader();
+        }
+
+        TarState = TAR_EXT_DATA;
+        return LE_OK;
+    }
+
+    // A pax global header doesn't carry anything that matters here.
+    if (type == 'g')
+    {
+        DataRemaining = EntrySize;
+        TarState = TAR_SKIP_DATA;
+        if (DataRemaining == 0)
+        {
+            StartPadding();
+        }
+        return LE_OK;
+    }
+
+    // Work out the entry's path and link target, preferring the extended headers' values.
+    char rawPath[LIMIT_MAX_PATH_BYTES];
+    char rawLinkPath[LIMIT_MAX_PATH_BYTES];
+    char path[LIMIT_MAX_PATH_BYTES];
+
+    if (PendingPath[0] != '\0')
+    {
+        LE_ASSERT(le_utf8_Copy(rawPath, PendingPath, sizeof(rawPath), NULL) == LE_OK);
+    }
+    else
+    {
+        size_t prefixLen = 0;
+
+        if (   (memcmp(HeaderBuffer + HDR_MAGIC_OFFSET, "ustar", 5) == 0)
+            && (HeaderBuffer[HDR_PREFIX_OFFSET] != '\0') )
+        {
+            LE_ASSERT(CopyField(rawPath, sizeof(rawPath),
+                                HeaderBuffer + HDR_PREFIX_OFFSET, HDR_PREFIX_BYTES) == LE_OK);
+            prefixLen = strlen(rawPath);
+            rawPath[prefixLen++] = '/';
+        }
+
+        LE_ASSERT(CopyField(rawPath + prefixLen, sizeof(rawPath) - prefixLen,
+                            HeaderBuffer + HDR_NAME_OFFSET, HDR_NAME_BYTES) == LE_OK);
+    }
+
+    if (PendingLinkPath[0] != '\0')
+    {
+        LE_ASSERT(le_utf8_Copy(rawLinkPath, PendingLinkPath, sizeof(rawLinkPath), NULL) == LE_OK);
+    }
+    else
+    {
+        LE_ASSERT(CopyField(rawLinkPath, sizeof(rawLinkPath),
+                            HeaderBuffer + HDR_LINKNAME_OFFSET, HDR_LINKNAME_BYTES) == LE_OK);
+    }
+
+    if (HasPendingSize)
+    {
+        EntrySize = PendingSize;
+    }
+
+    bool hasDigest = HasPendingDigest;
+
+    PendingPath[0] = '\0';
+    PendingLinkPath[0] = '\0';
+    HasPendingSize = false;
+    HasPendingDigest = false;
+
+    if (NormalizePath(rawPath, path) != LE_OK)
+    {
+        LE_ERROR("Bad tarball entry '%s'.", rawPath);
+        return LE_FORMAT_ERROR;
+    }
+
+    le_result_t result;
+
+    switch (type)
+    {
+        case '0':
+        case '\0':
+        case '7':
+            if (strcmp(path, ".") == 0)
+            {
+                LE_ERROR("Tarball entry '%s' is not a directory.", rawPath);
+                return LE_FORMAT_ERROR;
+            }
+            return CreateFile(path, mode & 07777);
+
+        case '5':
+            result = CreateDir(path, mode & 07777);
+            break;
+
+        case '2':
+        case '1':
+            if (strcmp(path, ".") == 0)
+            {
+                LE_ERROR("Tarball entry '%s' is not a directory.", rawPath);
+                return LE_FORMAT_ERROR;
+            }
+            result = (type == '2') ? CreateSymlink(path, rawLinkPath) :
+                                     CreateHardLink(path, rawLinkPath);
+            break;
+
+        case TAR_EXTRACT_TYPE_KEEP:
+        case TAR_EXTRACT_TYPE_PATCH:
+            if ((strcmp(path, ".") == 0) || !hasDigest)
+            {
+                LE_ERROR("Bad delta entry '%s'.", rawPath);
+                return LE_FORMAT_ERROR;
+            }
+            if (type == TAR_EXTRACT_TYPE_KEEP)
+            {
+                result = KeepFile(path, rawLinkPath, PendingDigest);
+                break;
+            }
+            if ((EntrySize == 0) || (EntrySize > MAX_PATCH_BYTES))
+            {
+                LE_ERROR("Bad size of binary diff for '%s' (%" PRIu64 " bytes).",
+                         rawPath,
+                         EntrySize);
+                return LE_FORMAT_ERROR;
+            }
+
+            // Receive the binary diff; it is applied once it is complete.
+            PatchBufferPtr = malloc(EntrySize);
+            LE_ASSERT(PatchBufferPtr != NULL);
+            PatchLen = 0;
+            LE_ASSERT(le_utf8_Copy(PatchPath, path, sizeof(PatchPath), NULL) == LE_OK);
+            LE_ASSERT(le_utf8_Copy(PatchOrigPath, rawLinkPath, sizeof(PatchOrigPath), NULL)
+                      == LE_OK);
+            PatchMode = mode & 07777;
+            memcpy(PatchDigest, PendingDigest, sizeof(PatchDigest));
+
+            DataRemaining = EntrySize;
+            TarState = TAR_PATCH_DATA;
+            return LE_OK;
+
+        default:
+            LE_ERROR("Unsupported type '%c' of tarball entry '%s'.", type, rawPath);
+            return LE_FORMAT_ERROR;
+    }
+
+    // Other types of entries don't normally have data, but skip it if they do.
+    DataRemaining = EntrySize;
+    TarState = TAR_SKIP_DATA;
+    if (DataRemaining == 0)
+    {
+        StartPadding();
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parses decompressed tarball bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseTar
+(
+    const uint8_t* dataPtr,
+    size_t dataLen
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = LE_OK;
+
+    while ((dataLen > 0) && (result == LE_OK))
+    {
+        size_t count = dataLen;
+
+        switch (TarState)
+        {
+            case TAR_HEADER:
+                if (count > TAR_BLOCK_BYTES - HeaderLen)
+                {
+                    count = TAR_BLOCK_BYTES - HeaderLen;
+                }
+                memcpy(HeaderBuffer + HeaderLen, dataPtr, count);
+                HeaderLen += count;
+
+                if (HeaderLen == TAR_BLOCK_BYTES)
+                {
+                    HeaderLen = 0;
+                    result = ProcessHeader();
+                }
+                break;
+
+            case TAR_FILE_DATA:
+            case TAR_EXT_DATA:
+            case TAR_SKIP_DATA:
+            case TAR_PATCH_DATA:
+                if (count > DataRemaining)
+                {
+                    count = DataRemaining;
+                }
+
+                if (TarState == TAR_FILE_DATA)
+                {
+                    md5_Update(&FileMd5, dataPtr, count);
+
+                    if (fd_WriteSize(FileFd, (void*)dataPtr, count) != (ssize_t)count)
+                    {
+                        LE_ERROR("Failed to write '%s' (%m).", FileEntryPtr->path);
+                        return LE_FAULT;
+                    }
+                }
+                else if (TarState == TAR_EXT_DATA)
+                {
+                    memcpy(ExtBuffer + ExtLen, dataPtr, count);
+                    ExtLen += count;
+                }
+                else if (TarState == TAR_PATCH_DATA)
+                {
+                    memcpy(PatchBufferPtr + PatchLen, dataPtr, count);
+                    PatchLen += count;
+                }
+
+                DataRemaining -= count;
+
+                if (DataRemaining == 0)
+                {
+                    int prevState = TarState;
+
+                    StartPadding();
+
+                    if (prevState == TAR_FILE_DATA)
+                    {
+                        result = FinishFile();
+                    }
+                    else if (prevState == TAR_EXT_DATA)
+                    {
+                        result = ProcessExtHeader();
+                    }
+                    else if (prevState == TAR_PATCH_DATA)
+                    {
+                        result = ApplyPatch();
+                    }
+                }
+                break;
+
+            case TAR_PADDING:
+                if (count > PaddingRemaining)
+                {
+                    count = PaddingRemaining;
+                }
+                PaddingRemaining -= count;
+
+                if (PaddingRemaining == 0)
+                {
+                    TarState = TAR_HEADER;
+                }
+                break;
+
+            case TAR_END:
+                return LE_OK;
+        }
+
+        dataPtr += count;
+        dataLen -= count;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decompresses payload bytes and passes them to the tar parser.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Decompress
+(
+    const uint8_t* inPtr,
+    size_t inLen
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result;
+
+    for (;;)
+    {
+        if (IsStreamEnded)
+        {
+            if (inLen == 0)
+            {
+                return LE_OK;
+            }
+
+            // Another compressed stream follows (e.g., from a parallel compressor).
+            CodecPtr->stop();
+            IsStreamEnded = false;
+
+            result = CodecPtr->start();
+            if (result != LE_OK)
+            {
+                // Don't stop it again in tarExtract_Stop().
+                CodecPtr = NULL;
+                return result;
+            }
+        }
+
+        size_t prevInLen = inLen;
+        size_t outLen = sizeof(OutputBuffer);
+
+        result = CodecPtr->decompress(&inPtr, &inLen, OutputBuffer, &outLen, &IsStreamEnded);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        if (outLen > 0)
+        {
+            result = ParseTar(OutputBuffer, outLen);
+            if (result != LE_OK)
+            {
+                return result;
+            }
+        }
+
+        if (!IsStreamEnded)
+        {
+            // If the output buffer wasn't filled, the decompressor needs more input.
+            if ((outLen < sizeof(OutputBuffer)) && (inLen == 0))
+            {
+                return LE_OK;
+            }
+
+            if ((outLen == 0) && (inLen == prevInLen))
+            {
+                LE_ERROR("%s decompressor is stuck.", CodecPtr->name);
+                return LE_FORMAT_ERROR;
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Chooses the decompressor from the first bytes of the payload, starts it, and passes it those
+ * bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StartCodec
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    // Short payloads can only be uncompressed (and will turn out to be truncated).
+    memset(MagicBuffer + MagicLen, 0, sizeof(MagicBuffer) - MagicLen);
+
+    for (i = 0; !Codecs[i].isMatch(MagicBuffer); i++)
+    {
+    }
+
+    LE_INFO("Payload compression: %s.", Codecs[i].name);
+
+    le_result_t result = Codecs[i].start();
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    CodecPtr = &Codecs[i];
+    IsStreamEnded = false;
+
+    return Decompress(MagicBuffer, MagicLen);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the extractor.  Must be called once, before any other function in this module.
+ */
+//--------------------------------------------------------------------------------------------------
+void tarExtract_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    EntryPool = le_mem_CreatePool("TarEntry", sizeof(Entry_t));
+    le_mem_SetNumObjsToForce(EntryPool, 32);    // Grow in chunks of 32 blocks.
+
+    EntryMap = le_hashmap_Create("TarEntries", 127, le_hashmap_HashString, le_hashmap_EqualsString);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts extracting a tarball.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the destination directory couldn't be opened.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t tarExtract_Start
+(
+    const char* dirPath ///< [IN] Path to the (existing) directory to extract the tarball into.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(RootFd == -1);
+
+    RootFd = open(dirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (RootFd == -1)
+    {
+        LE_ERROR("Failed to open unpack directory '%s' (%m).", dirPath);
+        return LE_FAULT;
+    }
+
+    TarState = TAR_HEADER;
+    HeaderLen = 0;
+    MagicLen = 0;
+    PendingPath[0] = '\0';
+    PendingLinkPath[0] = '\0';
+    HasPendingSize = false;
+    HasPendingDigest = false;
+
+    // find always lists the top directory, whether or not the tarball has an entry for it.
+    GetEntry(".", 'd');
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes the tarball being extracted a delta against an installed app.  Must be called right after
+ * tarExtract_Start().
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the installed app's directory couldn't be opened.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t tarExtract_SetBase
+(
+    const char* baseDirPath ///< [IN] Path to the installed app's directory.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT((RootFd != -1) && (BaseFd == -1));
+
+    BaseFd = open(baseDirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (BaseFd == -1)
+    {
+        LE_ERROR("Failed to open installed app directory '%s' (%m).", baseDirPath);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Feeds the next bytes of the (compressed) tarball to the extractor.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FORMAT_ERROR if the tarball is corrupted or contains something that can't be extracted.
+ * - LE_FAULT if writing to the file system failed.
+ *
+ * Errors are logged.  After an error, the extraction must be stopped with tarExtract_Stop().
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t tarExtract_Write
+(
+    const void* dataPtr,    ///< [IN] Bytes of the tarball.
+    size_t dataLen          ///< [IN] Number of bytes.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const uint8_t* bytePtr = dataPtr;
+
+    LE_ASSERT(RootFd != -1);
+
+    if (CodecPtr == NULL)
+    {
+        size_t count = sizeof(MagicBuffer) - MagicLen;
+        if (count > dataLen)
+        {
+            count = dataLen;
+        }
+
+        memcpy(MagicBuffer + MagicLen, bytePtr, count);
+        MagicLen += count;
+        bytePtr += count;
+        dataLen -= count;
+
+        if (MagicLen < sizeof(MagicBuffer))
+        {
+            return LE_OK;
+        }
+
+        le_result_t result = StartCodec();
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    return Decompress(bytePtr, dataLen);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tells the extractor that all the bytes of the tarball have been fed to it.
+ *
+ * @return
+ * - LE_OK if the whole tarball has been extracted.
+ * - LE_FORMAT_ERROR if the tarball is truncated or corrupted.
+ * - LE_FAULT if writing to the file system failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t tarExtract_Finish
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(RootFd != -1);
+
+    if (CodecPtr == NULL)
+    {
+        le_result_t result = StartCodec();
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    if (CodecPtr->hasEndMarker && !IsStreamEnded)
+    {
+        LE_ERROR("Compressed payload (%s) is truncated.", CodecPtr->name);
+        return LE_FORMAT_ERROR;
+    }
+
+    // Some tar implementations leave out the end-of-archive blocks.
+    if ((TarState != TAR_END) && ((TarState != TAR_HEADER) || (HeaderLen != 0)))
+    {
+        LE_ERROR("Tarball is truncated.");
+        return LE_FORMAT_ERROR;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compares entries by path, byte by byte (the order of "LC_ALL=C sort").
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareEntries
+(
+    const void* aPtr,
+    const void* bPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return strcmp((*(const Entry_t* const*)aPtr)->path, (*(const Entry_t* const*)bPtr)->path);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the MD5 hash of the extracted content, the way the build tools hash a staging
+ * directory (see the "MakeAppInfoProperties" and "PackSystem" build rules in mkTools).
+ *
+ * Must be called after tarExtract_Finish() succeeded.
+ */
+//--------------------------------------------------------------------------------------------------
+void tarExtract_GetMd5
+(
+    const char* const* excludedPaths,   ///< [IN] NULL-terminated list of paths (e.g.,
+                                        ///       "./info.properties") to leave out of the hash.
+    char md5Str[MD5_STRING_BYTES]       ///< [OUT] The hash.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t entryCount = 0;
+    size_t i;
+    const char* const* excludedPtr;
+
+    Entry_t** entries = malloc(le_hashmap_Size(EntryMap) * sizeof(Entry_t*));
+    LE_ASSERT(entries != NULL);
+
+    le_sls_Link_t* linkPtr;
+    for (linkPtr = le_sls_Peek(&EntryList); linkPtr != NULL; linkPtr = le_sls_PeekNext(&EntryList,
+                                                                                       linkPtr))
+    {
+        Entry_t* entryPtr = CONTAINER_OF(linkPtr, Entry_t, link);
+
+        for (excludedPtr = excludedPaths; *excludedPtr != NULL; excludedPtr++)
+        {
+            if (strcmp(*excludedPtr, entryPtr->path) == 0)
+            {
+                break;
+            }
+        }
+
+        if (*excludedPtr == NULL)
+        {
+            entries[entryCount++] = entryPtr;
+        }
+    }
+
+    qsort(entries, entryCount, sizeof(Entry_t*), CompareEntries);
+
+    md5_Ctx_t ctx;
+    md5_Init(&ctx);
+
+    // find -P -print0
+    for (i = 0; i < entryCount; i++)
+    {
+        md5_Update(&ctx, entries[i]->path, strlen(entries[i]->path) + 1);
+    }
+
+    // find -P -type f -print0 | xargs -0 md5sum
+    for (i = 0; i < entryCount; i++)
+    {
+        if (entries[i]->type == 'f')
+        {
+            char hexDigest[MD5_STRING_BYTES];
+            const char* charPtr;
+
+            md5_ToString(entries[i]->digest, hexDigest);
+
+            // md5sum escapes backslashes and newlines in file names, and flags lines that have
+            // escapes with a leading backslash.
+            if (strpbrk(entries[i]->path, "\\\n") != NULL)
+            {
+                md5_Update(&ctx, "\\", 1);
+            }
+            md5_Update(&ctx, hexDigest, MD5_STRING_BYTES - 1);
+            md5_Update(&ctx, "  ", 2);
+
+            for (charPtr = entries[i]->path; *charPtr != '\0'; charPtr++)
+            {
+                if (*charPtr == '\\')
+                {
+                    md5_Update(&ctx, "\\\\", 2);
+                }
+                else if (*charPtr == '\n')
+                {
+                    md5_Update(&ctx, "\\n", 2);
+                }
+                else
+                {
+                    md5_Update(&ctx, charPtr, 1);
+                }
+            }
+            md5_Update(&ctx, "\n", 1);
+        }
+    }
+
+    // find -P -type l -print0 | xargs -0 -r -n 1 readlink
+    for (i = 0; i < entryCount; i++)
+    {
+        if (entries[i]->type == 'l')
+        {
+            md5_Update(&ctx, entries[i]->target, strlen(entries[i]->target));
+            md5_Update(&ctx, "\n", 1);
+        }
+    }
+
+    free(entries);
+
+    uint8_t digest[MD5_DIGEST_BYTES];
+    md5_Final(&ctx, digest);
+    md5_ToString(digest, md5Str);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops extracting and releases everything held by the extractor.  Files that were already
+ * extracted are left in place.  Does nothing if the extractor isn't running.
+ */
+//--------------------------------------------------------------------------------------------------
+void tarExtract_Stop
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (FileFd != -1)
+    {
+        fd_Close(FileFd);
+        FileFd = -1;
+    }
+    if (ParentFd != -1)
+    {
+        fd_Close(ParentFd);
+        ParentFd = -1;
+    }
+    if (RootFd != -1)
+    {
+        fd_Close(RootFd);
+        RootFd = -1;
+    }
+    if (BaseFd != -1)
+    {
+        fd_Close(BaseFd);
+        BaseFd = -1;
+    }
+
+    free(PatchBufferPtr);
+    PatchBufferPtr = NULL;
+
+    if (CodecPtr != NULL)
+    {
+        CodecPtr->stop();
+        CodecPtr = NULL;
+    }
+
+    le_hashmap_RemoveAll(EntryMap);
+
+    le_sls_Link_t* linkPtr;
+    while ((linkPtr = le_sls_Pop(&EntryList)) != NULL)
+    {
+        le_mem_Release(CONTAINER_OF(linkPtr, Entry_t, link));
+    }
+}
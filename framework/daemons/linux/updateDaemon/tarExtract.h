@@ -0,0 +1,168 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file tarExtract.h
+ *
+ * In-process, streaming extractor for the (compressed) tarballs in update packs.
+ *
+ * The Update Unpacker feeds the payload to the extractor as it reads it from the update pack.  The
+ * extractor recognizes the compression format from the first bytes of the payload, decompresses
+ * it, and creates the files, directories and links described by the tarball under the destination
+ * directory, hashing the contents as they are written.  When the payload is complete, the
+ * extractor can compute the same MD5 hash that the build tools compute over a staging directory,
+ * so the unpacked content can be checked without reading it back.
+ *
+ * A tarball can also be a delta against an installed app, built by the mkAppDelta tool.  Besides
+ * ordinary entries (files, directories and links that are added or replaced), a delta contains:
+ *
+ *  - TAR_EXTRACT_TYPE_KEEP entries, whose link name is the path of a file of the installed app
+ *    that is kept unchanged at the entry's path;
+ *  - TAR_EXTRACT_TYPE_PATCH entries, whose link name is the path of a file of the installed app
+ *    and whose data is a binary diff (see deltaPatch.h) that turns that file into the entry's
+ *    file.
+ *
+ * Both are preceded by a pax header with a TAR_EXTRACT_PAX_MD5 record giving the MD5 hash of the
+ * resulting file.  Anything in the installed app that the delta doesn't mention is left out of
+ * the new app.
+ *
+ * Only one tarball can be extracted at a time.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_TAR_EXTRACT_H_INCLUDE_GUARD
+#define LEGATO_TAR_EXTRACT_H_INCLUDE_GUARD
+
+#include "md5.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Type flag of delta entries that keep a file of the installed app.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TAR_EXTRACT_TYPE_KEEP   'C'
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Type flag of delta entries that patch a file of the installed app.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TAR_EXTRACT_TYPE_PATCH  'P'
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Keyword of the pax record giving the MD5 hash (in hex) of a delta entry's resulting file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TAR_EXTRACT_PAX_MD5     "LEGATO.md5"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the extractor.  Must be called once, before any other function in this module.
+ */
+//--------------------------------------------------------------------------------------------------
+void tarExtract_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts extracting a tarball.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the destination directory couldn't be opened.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t tarExtract_Start
+(
+    const char* dirPath ///< [IN] Path to the (existing) directory to extract the tarball into.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes the tarball being extracted a delta against an installed app.  Must be called right after
+ * tarExtract_Start().
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the installed app's directory couldn't be opened.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t tarExtract_SetBase
+(
+    const char* baseDirPath ///< [IN] Path to the installed app's directory.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Feeds the next bytes of the (compressed) tarball to the extractor.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FORMAT_ERROR if the tarball is corrupted or contains something that can't be extracted.
+ * - LE_FAULT if writing to the file system failed.
+ *
+ * Errors are logged.  After an error, the extraction must be stopped with tarExtract_Stop().
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t tarExtract_Write
+(
+    const void* dataPtr,    ///< [IN] Bytes of the tarball.
+    size_t dataLen          ///< [IN] Number of bytes.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tells the extractor that all the bytes of the tarball have been fed to it.
+ *
+ * @return
+ * - LE_OK if the whole tarball has been extracted.
+ * - LE_FORMAT_ERROR if the tarball is truncated or corrupted.
+ * - LE_FAULT if writing to the file system failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t tarExtract_Finish
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the MD5 hash of the extracted content, the way the build tools hash a staging
+ * directory (see the "MakeAppInfoProperties" and "PackSystem" build rules in mkTools).
+ *
+ * Must be called after tarExtract_Finish() succeeded.
+ */
+//--------------------------------------------------------------------------------------------------
+void tarExtract_GetMd5
+(
+    const char* const* excludedPaths,   ///< [IN] NULL-terminated list of paths (e.g.,
+                                        ///       "./info.properties") to leave out of the hash.
+    char md5Str[MD5_STRING_BYTES]       ///< [OUT] The hash.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops extracting and releases everything held by the extractor.  Files that were already
+ * extracted are left in place.  Does nothing if the extractor isn't running.
+ */
+//--------------------------------------------------------------------------------------------------
+void tarExtract_Stop
+(
+    void
+);
+
+
+#endif  // LEGATO_TAR_EXTRACT_H_INCLUDE_GUARD
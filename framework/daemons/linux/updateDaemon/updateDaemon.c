@@ -11,6 +11,12 @@
  *
  * - updateUnpack.c - unpacks incoming update pack files and drives execution of the update.
  *
+ * - tarExtract.c - decompresses and extracts the tarballs in update packs, in-process.
+ *
+ * - deltaPatch.c - applies the binary diffs in delta app updates.
+ *
+ * - objectStore.c - shares identical files between installed apps and systems.
+ *
  * - updateExec.c - implements execution of the updates.
  *
  * @note The Update Daemon only supports a single update task at a time.  Requests to start
@@ -41,6 +47,8 @@
 #include "user.h"
 #include "pipeline.h"
 #include "updateUnpack.h"
+#include "tarExtract.h"
+#include "objectStore.h"
 #include "instStat.h"
 #include "app.h"
 #include "system.h"
@@ -2149,6 +2157,10 @@ COMPONENT_INIT
     // Make sure that we can report app install events.
     instStat_Init();
 
+    // Get ready to extract update pack payloads.
+    tarExtract_Init();
+    objectStore_Init();
+
     updateCtrl_Initialize();
 
     // Register session close handler for the le_update service.
@@ -5,7 +5,13 @@
  * Implementation of the Update Pack parser.  This file parses an update pack, and drives the
  * rest of the update based on the contents of the update pack.
  *
- * This is single-threaded, event-driven code that shares the main thread's event loop.
+ * This is single-threaded, event-driven code that shares the main thread's event loop.  (The one
+ * exception is a thread that may be started to stream a firmware image, see StartFirmwareUpdate().)
+ *
+ * The input is usually a pipe, which can't be rewound, so it is read in chunks into InputBuffer.
+ * The end of each JSON header is found by scanning the buffered bytes, and only the header is
+ * handed to the JSON parser.  Whatever was read past the end of the header is used before
+ * reading any more from the input.
  *
  * Copyright (C) Sierra Wireless Inc.
  */
@@ -15,26 +21,46 @@
 #include "interfaces.h"
 #include "limit.h"
 #include "updateUnpack.h"
-#include "pipeline.h"
 #include "fileDescriptor.h"
+#include "tarExtract.h"
 #include "system.h"
 #include "app.h"
 
 
-/// An MD5 hash string is 32 characters long, plus a null terminator.
-#define MD5_STRING_BYTES 33
+/// Number of bytes read from the update pack at a time while unpacking a payload.
+#define PAYLOAD_READ_BYTES (64 * 1024)
+
+/// Size of the buffer that JSON headers are read into.  No header can be longer than this.
+#define INPUT_BUFFER_BYTES 4096
 
 /// File descriptor to read the update pack from.
 static int InputFd = -1;
 
-/// Reference to the FD Monitor for the input stream (NULL if not unpacking).
-static le_fdMonitor_Ref_t InputFdMonitor = NULL;
+/// Bytes read from the update pack that haven't been used yet.
+static char InputBuffer[INPUT_BUFFER_BYTES];
+
+/// Offset of the first unused byte in InputBuffer.
+static size_t InputStart;
 
-/// Reference to an unpack pipeline (NULL if not unpacking).
-static pipeline_Ref_t Pipeline = NULL;
+/// Number of unused bytes in InputBuffer.
+static size_t InputLen;
 
-/// File descriptor connected to the input of a pipeline (-1 if not unpacking)
-static int PipelineFd = -1;
+/// Scan for the end of the JSON header at the start of the unused bytes in InputBuffer.
+static struct
+{
+    size_t len;         ///< Number of bytes scanned so far.
+    size_t depth;       ///< Number of objects and arrays that haven't been closed yet.
+    bool isStarted;     ///< true once the opening '{' or '[' has been found.
+    bool isInString;    ///< true if inside a string.
+    bool isEscaped;     ///< true if the previous character was a backslash inside a string.
+}
+HeaderScan;
+
+/// Length of the JSON header being parsed, in bytes.
+static size_t HeaderLen;
+
+/// Reference to the FD Monitor for the input stream (NULL if not unpacking).
+static le_fdMonitor_Ref_t InputFdMonitor = NULL;
 
 /// Function to be called to report progress.
 static updateUnpack_ProgressHandler_t ProgressFunc = NULL;
@@ -51,10 +77,13 @@ static char AppName[LIMIT_MAX_APP_NAME_BYTES];
 /// The MD5 hash obtained from a JSON header.
 static char Md5[MD5_STRING_BYTES]; ///< The system's MD5 hash.
 
+/// The MD5 hash of the installed app that a delta app update applies to (from a JSON header).
+static char BaseMd5[MD5_STRING_BYTES];
+
 /// # of bytes of payload following the JSON.
 static size_t PayloadSize;
 
-/// # of bytes of payload that have been copied to the unpack pipeline.
+/// # of bytes of payload that have been read from the update pack.
 static size_t PayloadBytesCopied;
 
 /// Percentage complete on current task.
@@ -161,24 +190,18 @@ static void Reset
 
     DeleteFdMonitor();
 
-    // Close the pipes.
+    // Close the input stream.
     if (InputFd != -1)
     {
         fd_Close(InputFd);
         InputFd = -1;
     }
-    if (PipelineFd != -1)
-    {
-        fd_Close(PipelineFd);
-        PipelineFd = -1;
-    }
 
-    // Delete the pipeline.
-    if (Pipeline != NULL)
-    {
-        pipeline_Delete(Pipeline);
-        Pipeline = NULL;
-    }
+    InputStart = 0;
+    InputLen = 0;
+
+    // Stop extracting.
+    tarExtract_Stop();
 }
 
 
@@ -252,6 +275,99 @@ static void HandleInternalError
 }
 
 
+static void InputFdEventHandler(int fd, short events);
+static bool ScanHeader(void);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads bytes from the update pack, using the bytes left over in InputBuffer first.
+ *
+ * @return The number of bytes read, 0 at the end of the input, or -1 with errno set on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static ssize_t ReadInput
+(
+    void* bufferPtr,
+    size_t bufferSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (InputLen > 0)
+    {
+        size_t len = (bufferSize < InputLen) ? bufferSize : InputLen;
+
+        memcpy(bufferPtr, InputBuffer + InputStart, len);
+        InputStart += len;
+        InputLen -= len;
+
+        return len;
+    }
+
+    ssize_t readResult;
+    do
+    {
+        readResult = read(InputFd, bufferPtr, bufferSize);
+    }
+    while ((readResult == -1) && (errno == EINTR));
+
+    return readResult;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function queued to the event loop to use the bytes left over in InputBuffer, which the input's
+ * FD Monitor won't report.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessBufferedInput
+(
+    void* param1Ptr,    ///< Not used.
+    void* param2Ptr     ///< Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    (void)param1Ptr;
+    (void)param2Ptr;
+
+    if ((InputLen == 0) || (InputFdMonitor == NULL))
+    {
+        return;
+    }
+
+    // The input may be blocking while looking for a header, so don't read from it here.
+    if (State == STATE_PARSING_JSON)
+    {
+        ScanHeader();
+    }
+    else
+    {
+        InputFdEventHandler(InputFd, POLLIN);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts monitoring the input for bytes to read, and queues the processing of any bytes that are
+ * left over in InputBuffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MonitorInput
+(
+    const char* namePtr     ///< Name of the FD Monitor.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    InputFdMonitor = le_fdMonitor_Create(namePtr, InputFd, InputFdEventHandler, POLLIN);
+
+    if (InputLen > 0)
+    {
+        le_event_QueueFunction(ProcessBufferedInput, NULL, NULL);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Called when app unpack finishes successfully.
@@ -265,7 +381,7 @@ static void AppUnpackDone
 {
     char buf[1];
     //Check whether InputFd reaches EOF, if not it is an error condition.
-    if (fd_ReadSize(InputFd, buf, sizeof(buf)) != 0)
+    if ((InputLen > 0) || (fd_ReadSize(InputFd, buf, sizeof(buf)) != 0))
     {
         LE_ERROR("Malformed update pack. Only one app update/remove allowed per update pack.");
         HandleFormatError();
@@ -334,6 +450,162 @@ static void JsonErrorHandler
 
 static void JsonEventHandler(le_json_Event_t event);
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hands a JSON header (the first len unused bytes in InputBuffer) to the JSON parser.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ParseHeader
+(
+    size_t len
+)
+//--------------------------------------------------------------------------------------------------
+{
+    DeleteFdMonitor();
+
+    HeaderLen = len;
+
+    ParsingSession = le_json_ParseBuffer(InputBuffer + InputStart, len,
+                                         JsonEventHandler, JsonErrorHandler, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scans the unused bytes in InputBuffer for the end of the JSON header, and hands the header to
+ * the JSON parser once it has been found.
+ *
+ * Anything that isn't a JSON object or array is handed to the parser as soon as it is found, to
+ * let the parser report the error.
+ *
+ * @return true if the header has been handed to the parser.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ScanHeader
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    bool isComplete = false;
+
+    while (!isComplete && (HeaderScan.len < InputLen))
+    {
+        char c = InputBuffer[InputStart + HeaderScan.len];
+        HeaderScan.len++;
+
+        if (!HeaderScan.isStarted)
+        {
+            if ((c == '{') || (c == '['))
+            {
+                HeaderScan.isStarted = true;
+                HeaderScan.depth = 1;
+            }
+            else if (!isspace((unsigned char)c))
+            {
+                isComplete = true;
+            }
+        }
+        else if (HeaderScan.isInString)
+        {
+            if (HeaderScan.isEscaped)
+            {
+                HeaderScan.isEscaped = false;
+            }
+            else if (c == '\\')
+            {
+                HeaderScan.isEscaped = true;
+            }
+            else if (c == '"')
+            {
+                HeaderScan.isInString = false;
+            }
+        }
+        else if (c == '"')
+        {
+            HeaderScan.isInString = true;
+        }
+        else if ((c == '{') || (c == '['))
+        {
+            HeaderScan.depth++;
+        }
+        else if ((c == '}') || (c == ']'))
+        {
+            HeaderScan.depth--;
+            isComplete = (HeaderScan.depth == 0);
+        }
+    }
+
+    if (isComplete)
+    {
+        ParseHeader(HeaderScan.len);
+        return true;
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a chunk of the update pack while looking for the end of a JSON header.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadHeaderBytes
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (ScanHeader())
+    {
+        return;
+    }
+
+    // Make room at the end of the buffer.
+    if ((InputStart > 0) && (InputLen > 0))
+    {
+        memmove(InputBuffer, InputBuffer + InputStart, InputLen);
+    }
+    InputStart = 0;
+
+    if (InputLen == sizeof(InputBuffer))
+    {
+        LE_ERROR("Malformed update pack (JSON header longer than %zu bytes)", sizeof(InputBuffer));
+        HandleFormatError();
+        return;
+    }
+
+    ssize_t readResult;
+    do
+    {
+        readResult = read(InputFd, InputBuffer + InputLen, sizeof(InputBuffer) - InputLen);
+    }
+    while ((readResult == -1) && (errno == EINTR));
+
+    if (readResult == -1)
+    {
+        if (errno != EWOULDBLOCK)
+        {
+            LE_ERROR("Failed to read from input stream (%m).");
+            HandleInternalError();
+        }
+        return;
+    }
+
+    if (readResult == 0)
+    {
+        // At the end of the input, let the parser decide whether what's left is an error.
+        ParseHeader(InputLen);
+        return;
+    }
+
+    InputLen += readResult;
+
+    ScanHeader();
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Start parsing a JSON header.
@@ -349,50 +621,100 @@ static void StartParsing
     Command[0] = '\0';
     AppName[0] = '\0';
     Md5[0] = '\0';
+    BaseMd5[0] = '\0';
     PayloadSize = 0;
 
     // Set the state
     State = STATE_PARSING_JSON;
 
-    // Start the parser (and wait for callbacks).
-    ParsingSession = le_json_Parse(InputFd, JsonEventHandler, JsonErrorHandler, NULL);
+    if (ParsingSession != NULL)
+    {
+        le_json_Cleanup(ParsingSession);
+        ParsingSession = NULL;
+    }
+
+    memset(&HeaderScan, 0, sizeof(HeaderScan));
+
+    // Read the header in chunks (and wait for the parser's callbacks).
+    MonitorInput("header");
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Completion callback for "tar xj" operation.
+ * Checks the MD5 hash of the unpacked content against the one from the JSON header.
+ *
+ * The build tools hash the staging directory before they add info.properties to it (and, for a
+ * system, before they write the version file, which may or may not be left over from an earlier
+ * build), so those files are left out.
+ *
+ * @return true if the hash matches.
  */
 //--------------------------------------------------------------------------------------------------
-static void UntarDone
+static bool IsUnpackedMd5Valid
 (
-    pipeline_Ref_t pipeline,
-    int status
+    void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    pipeline_Delete(Pipeline);
-    Pipeline = NULL;
+    static const char* const infoExcluded[] = { "./info.properties", NULL };
+    static const char* const versionExcluded[] = { "./info.properties", "./version", NULL };
 
-    if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+    char md5[MD5_STRING_BYTES];
+
+    tarExtract_GetMd5(infoExcluded, md5);
+    if (strcmp(md5, Md5) == 0)
     {
-        if (WIFEXITED(status))
-        {
-            LE_ERROR("Payload unpack pipeline failed with exit code: %d", WEXITSTATUS(status));
-        }
-        else if (WIFSIGNALED(status))
-        {
-            LE_ERROR("Payload unpack pipeline killed by signal: %d", WTERMSIG(status));
-        }
-        else
+        return true;
+    }
+
+    if (strcmp(Command, "updateSystem") == 0)
+    {
+        tarExtract_GetMd5(versionExcluded, md5);
+        if (strcmp(md5, Md5) == 0)
         {
-            LE_ERROR("Payload unpack pipeline died for unknown reason (status: %d)", status);
+            return true;
         }
+    }
+
+    LE_ERROR("MD5 hash of unpacked content (%s) doesn't match update pack's (%s).", md5, Md5);
+
+    return false;
+}
+
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when all the payload bytes have been fed to the tarball extractor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UntarDone
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = tarExtract_Finish();
+
+    if (result == LE_FORMAT_ERROR)
+    {
+        HandleFormatError();
+        return;
+    }
+    else if (result != LE_OK)
+    {
         HandleInternalError();
         return;
     }
 
+    if (!IsUnpackedMd5Valid())
+    {
+        HandleFormatError();
+        return;
+    }
+
+    tarExtract_Stop();
+
     // If this update pack contains changes to individual apps,
     if (Type == TYPE_APP_UPDATE)
     {
@@ -463,19 +785,19 @@ static void SkipForwardDone
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Copy bytes from the input fd to the pipeline's input fd until the input fd's read buffer is
- * empty or we have copied all the payload bytes.
+ * Feed bytes from the input fd to the tarball extractor until the input fd's read buffer is
+ * empty or we have unpacked all the payload bytes.
  */
 //--------------------------------------------------------------------------------------------------
-static void CopyBytesToPipeline
+static void UnpackPayloadBytes
 (
     void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    char buffer[1024];
+    static char buffer[PAYLOAD_READ_BYTES];
 
-    // Keep copying as much as we can until we've copied all the payload.
+    // Keep unpacking as much as we can until we've unpacked all the payload.
     while (PayloadBytesCopied < PayloadSize)
     {
         // Compute the number of bytes to read.
@@ -486,12 +808,7 @@ static void CopyBytesToPipeline
         }
 
         // Read the bytes, retrying if interrupted by a signal.
-        ssize_t readResult;
-        do
-        {
-            readResult = read(InputFd, buffer, bytesToRead);
-        }
-        while ((readResult == -1) && (errno == EINTR));
+        ssize_t readResult = ReadInput(buffer, bytesToRead);
 
         // Handle errors
         if (readResult == -1)
@@ -506,7 +823,8 @@ static void CopyBytesToPipeline
             }
 
             LE_ERROR("Failed to read from input stream (%m).");
-            goto error;
+            HandleInternalError();
+            return;
         }
 
         // Handle end of file.
@@ -515,31 +833,21 @@ static void CopyBytesToPipeline
             LE_ERROR("Unexpected early end of input after %zu bytes of %zu.",
                      PayloadBytesCopied,
                      PayloadSize);
-            goto error;
+            HandleInternalError();
+            return;
         }
 
-        // Write the bytes that we read.
-        ssize_t bytesWritten = 0;
-        ssize_t writeResult;
-        do
+        // Decompress and extract the bytes that we read.
+        le_result_t result = tarExtract_Write(buffer, readResult);
+        if (result == LE_FORMAT_ERROR)
         {
-            writeResult = write(PipelineFd, buffer + bytesWritten, readResult - bytesWritten);
-
-            // If some bytes were written, remember how many bytes, so we don't try to write the
-            // same bytes again if we have more to write.
-            if (writeResult > 0)
-            {
-                bytesWritten += writeResult;
-            }
+            HandleFormatError();
+            return;
         }
-        while (   ((writeResult == -1) && (errno == EINTR)) // Retry if interrupted by a signal
-               || ((writeResult != -1) && (bytesWritten < readResult))  ); // Continue if not done
-
-        // Check for errors.
-        if (writeResult == -1)
+        else if (result != LE_OK)
         {
-            LE_ERROR("Failed to write to output stream (%m)");
-            goto error;
+            HandleInternalError();
+            return;
         }
 
         // Update the static progress variables and report progress to the client.
@@ -548,22 +856,15 @@ static void CopyBytesToPipeline
         ReportProgress();
     }
 
-    // If we have copied all the payload bytes to the pipeline's input, then we can stop
-    // monitoring the input fd now, close the pipeline input write pipe, and wait for the pipeline
-    // completion callback (UntarDone()).
-    LE_INFO("Payload copied: %zu/%zu", PayloadBytesCopied, PayloadSize);
+    // If we have unpacked all the payload bytes, then we can stop monitoring the input fd now
+    // and finish the extraction.
     LE_ASSERT(PayloadBytesCopied <= PayloadSize);
     if (PayloadBytesCopied == PayloadSize)
     {
+        LE_INFO("Payload unpacked: %zu/%zu", PayloadBytesCopied, PayloadSize);
         DeleteFdMonitor();
-        fd_Close(PipelineFd);
-        PipelineFd = -1;
+        UntarDone();
     }
-    return;
-
-error:
-
-    HandleInternalError();
 }
 
 
@@ -592,12 +893,7 @@ static void DiscardPayloadBytes
         }
 
         // Read the bytes, retrying if interrupted by a signal.
-        ssize_t readResult;
-        do
-        {
-            readResult = read(InputFd, buffer, bytesToRead);
-        }
-        while ((readResult == -1) && (errno == EINTR));
+        ssize_t readResult = ReadInput(buffer, bytesToRead);
 
         // Handle errors
         if (readResult == -1)
@@ -635,7 +931,7 @@ static void DiscardPayloadBytes
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Event handler for the input fd when copying bytes to a pipeline.
+ * Event handler for the input fd when reading a JSON header, or unpacking or skipping a payload.
  */
 //--------------------------------------------------------------------------------------------------
 static void InputFdEventHandler
@@ -647,9 +943,13 @@ static void InputFdEventHandler
 {
     if (events & POLLIN)
     {
-        if (State == STATE_UNPACKING_PAYLOAD)
+        if (State == STATE_PARSING_JSON)
+        {
+            ReadHeaderBytes();
+        }
+        else if (State == STATE_UNPACKING_PAYLOAD)
         {
-            CopyBytesToPipeline();
+            UnpackPayloadBytes();
         }
         else if (State == STATE_SKIPPING_PAYLOAD)
         {
@@ -670,76 +970,120 @@ static void InputFdEventHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Function that runs in the unpack pipeline's "tar" process.
- **/
+ * Start unpacking a tarball.
+ */
 //--------------------------------------------------------------------------------------------------
-static int Untar
+static void StartUntar
 (
-    void* param
+    const char* dirPath ///< Path to the directory to unpack the tarball into.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    const char* unpackDir = param;
+    State = STATE_UNPACKING_PAYLOAD;
+
+    PayloadBytesCopied = 0;
+
+    if (tarExtract_Start(dirPath) != LE_OK)
+    {
+        HandleInternalError();
+        return;
+    }
+
+    // A delta app update is unpacked against the installed app it was computed from.
+    if (BaseMd5[0] != '\0')
+    {
+        char baseDirPath[LIMIT_MAX_PATH_BYTES];
 
-    // Close all open file descriptors except for stdin, stdout, and stderr.
-    // This ensures that we don't keep copies of things like the pipeline input write pipe open.
-    fd_CloseAllNonStd();
+        LE_ASSERT(snprintf(baseDirPath, sizeof(baseDirPath), "/legato/apps/%s", BaseMd5)
+                  < sizeof(baseDirPath));
 
-    // Try bsdtar first.  If that fails, fallback to tar.
-    execl("/usr/bin/bsdtar", "bsdtar", "xjmop", "-f", "-", "-C", unpackDir, (char*)NULL);
-    execl("/bin/tar", "tar", "xjop", "-C", unpackDir, (char*)NULL);
+        if (tarExtract_SetBase(baseDirPath) != LE_OK)
+        {
+            HandleInternalError();
+            return;
+        }
+    }
 
-    LE_FATAL("Failed to exec tar (%m)");
+    fd_SetNonBlocking(InputFd);
+
+    // Create FD Monitor for the Input FD.
+    MonitorInput("unpack");
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Start unpacking a tarball.
+ * Start reading and throwing away payload bytes from the input stream.
  */
 //--------------------------------------------------------------------------------------------------
-static void StartUntar
+static void StartSkipForward
 (
-    const char* dirPath ///< Path to the directory to unpack the tarball into.
+    void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    State = STATE_UNPACKING_PAYLOAD;
+    State = STATE_SKIPPING_PAYLOAD;
 
     PayloadBytesCopied = 0;
 
-    // Create a pipeline: PipelineFd -> tar
-    Pipeline = pipeline_Create();
-    PipelineFd = pipeline_CreateInputPipe(Pipeline);
-    pipeline_Append(Pipeline, Untar, (void*)dirPath);
-    pipeline_Start(Pipeline, UntarDone);
-
     fd_SetNonBlocking(InputFd);
 
     // Create FD Monitor for the Input FD.
-    InputFdMonitor = le_fdMonitor_Create("unpack", InputFd, InputFdEventHandler, POLLIN);
+    MonitorInput("skip");
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Start reading and throwing away payload bytes from the input stream.
+ * Thread that streams the firmware image to the fwupdate service when some of it has already been
+ * read into InputBuffer: the buffered bytes first, then the rest of the input.
  */
 //--------------------------------------------------------------------------------------------------
-static void StartSkipForward
+static void* FirmwareStreamMain
 (
-    void
+    void* contextPtr    ///< File descriptor of the socket to write the image to.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    State = STATE_SKIPPING_PAYLOAD;
+    int outFd = (int)(intptr_t)contextPtr;
+    static char buffer[PAYLOAD_READ_BYTES];
+    ssize_t readResult;
 
-    PayloadBytesCopied = 0;
+    // The main thread is blocked in le_fwupdate_Download() until this is done, so it is safe to
+    // use the input here.
+    while ((readResult = ReadInput(buffer, sizeof(buffer))) > 0)
+    {
+        ssize_t offset = 0;
 
-    fd_SetNonBlocking(InputFd);
+        while (offset < readResult)
+        {
+            // Don't raise SIGPIPE if the fwupdate service stops reading.
+            ssize_t sent = send(outFd, buffer + offset, readResult - offset, MSG_NOSIGNAL);
 
-    // Create FD Monitor for the Input FD.
-    InputFdMonitor = le_fdMonitor_Create("skip", InputFd, InputFdEventHandler, POLLIN);
+            if (sent < 0)
+            {
+                if (errno != EINTR)
+                {
+                    LE_ERROR("Failed to stream firmware image (%m).");
+                    fd_Close(outFd);
+                    return NULL;
+                }
+            }
+            else
+            {
+                offset += sent;
+            }
+        }
+    }
+
+    if (readResult < 0)
+    {
+        LE_ERROR("Failed to read from input stream (%m).");
+    }
+
+    fd_Close(outFd);
+
+    return NULL;
 }
 
 
@@ -756,11 +1100,49 @@ static void StartFirmwareUpdate
 {
     PayloadBytesCopied = 0;
 
+    int imageFd = InputFd;
+    le_thread_Ref_t streamThread = NULL;
+
+    fd_SetBlocking(InputFd);
+
+    // Bytes of the image that were read along with the JSON header have to be passed on to the
+    // fwupdate service before the rest of the input, so stream it all through a socket.
+    if (InputLen > 0)
+    {
+        int fds[2];
+
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        {
+            LE_ERROR("Failed to create socket pair (%m).");
+            HandleInternalError();
+            return;
+        }
+
+        imageFd = fds[0];
+
+        streamThread = le_thread_Create("fwStream", FirmwareStreamMain, (void*)(intptr_t)fds[1]);
+        le_thread_SetJoinable(streamThread);
+        le_thread_Start(streamThread);
+    }
+    else
+    {
+        // The IPC API closes the fd once it has been sent, and Reset() closes InputFd.
+        imageFd = dup(InputFd);
+        LE_FATAL_IF(imageFd == -1, "Failed to duplicate input fd (%m).");
+    }
+
     le_fwupdate_ConnectService();   // TODO: Change to a TryConnectService() when available.
 
     LE_INFO("Starting firmware update.");
 
-    if ( le_fwupdate_Download(InputFd) == LE_OK )
+    le_result_t result = le_fwupdate_Download(imageFd);
+
+    if (streamThread != NULL)
+    {
+        LE_ASSERT(le_thread_Join(streamThread, NULL) == LE_OK);
+    }
+
+    if (result == LE_OK)
     {
         LE_INFO("Firmware update download successful. Waiting for modem to reset.");
 
@@ -826,8 +1208,10 @@ static void JsonDone
             StartUntar(system_UnpackPath);
         }
     }
-    else if (strcmp(Command, "updateApp") == 0)
+    else if ((strcmp(Command, "updateApp") == 0) || (strcmp(Command, "updateAppDelta") == 0))
     {
+        bool isDelta = (strcmp(Command, "updateAppDelta") == 0);
+
         if (Type == TYPE_FIRMWARE_UPDATE)
         {
             LE_ERROR("Malformed update pack (app update can't be mixed with firmware update)");
@@ -849,6 +1233,17 @@ static void JsonDone
             LE_ERROR("Malformed update pack (app update payload missing)");
             HandleFormatError();
         }
+        // A delta also requires "baseMd5".
+        else if (isDelta && (BaseMd5[0] == '\0'))
+        {
+            LE_ERROR("Malformed update pack (installed app's MD5 hash missing from app delta)");
+            HandleFormatError();
+        }
+        else if (!isDelta && (BaseMd5[0] != '\0'))
+        {
+            LE_ERROR("Malformed update pack (unexpected installed app's MD5 hash)");
+            HandleFormatError();
+        }
         else
         {
             if (Type == TYPE_UNKNOWN)
@@ -862,7 +1257,13 @@ static void JsonDone
                 system_RemoveUnusedApps();
             }
 
-            if (app_Exists(Md5) == false)
+            if ((app_Exists(Md5) == false) && isDelta && (app_Exists(BaseMd5) == false))
+            {
+                LE_ERROR("App delta applies to app with MD5 sum %s, which is not installed.",
+                         BaseMd5);
+                HandleFormatError();
+            }
+            else if (app_Exists(Md5) == false)
             {
                 LE_INFO("App with MD5 sum %s being unpacked.", Md5);
 
@@ -1045,6 +1446,21 @@ static void Md5EventHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * "baseMd5" member parsing event function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BaseMd5EventHandler
+(
+    le_json_Event_t event
+)
+//--------------------------------------------------------------------------------------------------
+{
+    StringMemberEventHandler(event, BaseMd5, sizeof(BaseMd5), "installed app's MD5 hash");
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * "version" member parsing event function.
@@ -1140,6 +1556,10 @@ static void JsonEventHandler
 
         case LE_JSON_DOC_END:
 
+            // The payload (or the next header) starts right after the header.
+            InputStart += HeaderLen;
+            InputLen -= HeaderLen;
+
             // Confirm we have everything we need and move to the APPLYING state.
             JsonDone();
             break;
@@ -1156,6 +1576,10 @@ static void JsonEventHandler
             {
                 le_json_SetEventHandler(Md5EventHandler);
             }
+            else if (strcmp(memberName, "baseMd5") == 0)
+            {
+                le_json_SetEventHandler(BaseMd5EventHandler);
+            }
             else if (strcmp(memberName, "name") == 0)
             {
                 le_json_SetEventHandler(NameEventHandler);
@@ -41,14 +41,22 @@
  * have a faultAction and watchdogAction which restarts the process.
  *
  * Algorithm
- * When a process kicks us, if we have no timer for it we will:
- *    create a timer,
- *    add it to our timer list and
+ * When a process kicks us, if we have no watchdog for it we will:
+ *    create a watchdog,
+ *    add it to our watchdog container and
  *    set it running with the appropriate time out (for now, that configured for the app).
- * If the timer times out before the next kick then the watchdog will
+ * If the watchdog times out before the next kick then the watchdog will
  *    attempt to alert the supervisor that the app has timed out.
  *          The supervisor can then apply the configured fault action.
- *    delist the timer and dispose of it.
+ *    delist the watchdog and dispose of it.
+ *
+ * Watchdogs do not have timers of their own.  Kicks are by far the most frequent event the daemon
+ * handles, so a kick only records the watchdog's new deadline.  Running watchdogs are kept in a
+ * min-heap ordered by the deadline they had when they were last placed in the heap, and a single
+ * timer is set to go off at the top of the heap.  When it does, watchdogs that have been kicked
+ * since are moved down the heap to their new deadline, and the others have expired.  A watchdog
+ * only needs to be moved up the heap (and the timer reset) when its deadline gets earlier, which
+ * only happens if a shorter timeout is given to le_wdog_Timeout().
  *
  * Analysis
  *
@@ -59,11 +67,11 @@
  *         the dead process won't be around to kick the watchdog again at which time
  *         we have case 1.
  * case 3: Another race condition - the app times out and we tell the supervisor about it.
- *         We delist the timer and destroy it.
+ *         We delist the watchdog and destroy it.
  *         The supervisor kills the app but between the timeout and the supervisor acting
  *         the app sends a kick.
- *         We treat the kick as a kick from a new app and create a timer.
- *         When the timer times out we have case 1 again.
+ *         We treat the kick as a kick from a new app and create a watchdog.
+ *         When the watchdog times out we have case 1 again.
  *
  *         The analysis assumes that the time between timeouts is significantly shorter
  *         than the time expected before pIDs are re-used.
@@ -225,7 +233,13 @@ typedef struct
                                         ///< mandatory watchdog will not accidentally get set
                                         ///< beyond it's maximum period by being treated as a
                                         ///< non-mandatory watchdog.
-    le_timer_Ref_t timer;               ///< The timer this watchdog uses
+    le_clk_Time_t timeoutInterval;      ///< Interval the watchdog was last started with
+    le_clk_Time_t deadline;             ///< Relative time at which the watchdog expires
+    le_clk_Time_t heapDeadline;         ///< Deadline the watchdog is ordered by in the deadline
+                                        ///< heap.  Kicks only update deadline, so this may be
+                                        ///< earlier.
+    ssize_t heapIndex;                  ///< Position in the deadline heap, or -1 if the watchdog
+                                        ///< is not running.
 }
 WatchdogObj_t;
 
@@ -273,6 +287,24 @@ static le_hashmap_Ref_t MandatoryWatchdogRefs;  ///< The container used to track
 
 static le_timer_Ref_t DefaultExternalWdogTimer; ///< Default external wdog timer
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initial number of entries in the deadline heap.  The heap doubles in size when it is full.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEADLINE_HEAP_INITIAL_SIZE  LE_WDOG_HASTABLE_WIDTH
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Min-heap of running watchdogs, ordered by heapDeadline, and the single timer that goes off at
+ * the deadline of the watchdog at the top of the heap.
+ */
+//--------------------------------------------------------------------------------------------------
+static WatchdogObj_t** DeadlineHeapPtr;         ///< The heap entries
+static size_t DeadlineHeapCount;                ///< Number of watchdogs in the heap
+static size_t DeadlineHeapCapacity;             ///< Number of entries allocated
+static le_timer_Ref_t DeadlineTimer;            ///< Goes off at the earliest heap deadline
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Trace reference used for controlling tracing in this module.
@@ -289,8 +321,247 @@ static le_log_TraceRef_t TraceRef;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove the watchdog from our container, free the timer it contains and then free the storage
- * we allocated to hold the watchdog structure.
+ * Store a watchdog at the given position in the deadline heap.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void SetHeapEntry
+(
+    size_t index,               ///< [IN] Position in the heap.
+    WatchdogObj_t* dogPtr       ///< [IN] The watchdog to store.
+)
+{
+    DeadlineHeapPtr[index] = dogPtr;
+    dogPtr->heapIndex = index;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move a watchdog towards the top of the deadline heap until its parent's deadline is earlier.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SiftUp
+(
+    size_t index                ///< [IN] Position of the watchdog to move.
+)
+{
+    WatchdogObj_t* dogPtr = DeadlineHeapPtr[index];
+
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+        WatchdogObj_t* parentPtr = DeadlineHeapPtr[parent];
+
+        if (!le_clk_GreaterThan(parentPtr->heapDeadline, dogPtr->heapDeadline))
+        {
+            break;
+        }
+
+        SetHeapEntry(index, parentPtr);
+        index = parent;
+    }
+
+    SetHeapEntry(index, dogPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move a watchdog towards the bottom of the deadline heap until both its children's deadlines are
+ * later.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SiftDown
+(
+    size_t index                ///< [IN] Position of the watchdog to move.
+)
+{
+    WatchdogObj_t* dogPtr = DeadlineHeapPtr[index];
+
+    for (;;)
+    {
+        size_t child = (2 * index) + 1;
+
+        if (child >= DeadlineHeapCount)
+        {
+            break;
+        }
+
+        // Pick the child that expires first.
+        if ((child + 1 < DeadlineHeapCount) &&
+            le_clk_GreaterThan(DeadlineHeapPtr[child]->heapDeadline,
+                               DeadlineHeapPtr[child + 1]->heapDeadline))
+        {
+            child++;
+        }
+
+        if (!le_clk_GreaterThan(dogPtr->heapDeadline, DeadlineHeapPtr[child]->heapDeadline))
+        {
+            break;
+        }
+
+        SetHeapEntry(index, DeadlineHeapPtr[child]);
+        index = child;
+    }
+
+    SetHeapEntry(index, dogPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the deadline timer to go off at the deadline of the watchdog at the top of the heap, or
+ * stop it if no watchdog is running.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ArmDeadlineTimer
+(
+    void
+)
+{
+    le_timer_Stop(DeadlineTimer);
+
+    if (DeadlineHeapCount == 0)
+    {
+        return;
+    }
+
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+    le_clk_Time_t interval = {0, 0};
+
+    if (le_clk_GreaterThan(DeadlineHeapPtr[0]->heapDeadline, now))
+    {
+        interval = le_clk_Sub(DeadlineHeapPtr[0]->heapDeadline, now);
+    }
+
+    // timer is stopped here so this should never fail
+    LE_ASSERT(LE_OK == le_timer_SetInterval(DeadlineTimer, interval));
+    LE_ASSERT(LE_OK == le_timer_Start(DeadlineTimer));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is the watchdog running?
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsWatchdogRunning
+(
+    const WatchdogObj_t* dogPtr     ///< [IN] The watchdog
+)
+{
+    return (dogPtr->heapIndex >= 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop a watchdog by removing it from the deadline heap.  Does nothing if it is not running.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopWatchdog
+(
+    WatchdogObj_t* dogPtr           ///< [IN] The watchdog to stop
+)
+{
+    if (!IsWatchdogRunning(dogPtr))
+    {
+        return;
+    }
+
+    size_t index = dogPtr->heapIndex;
+
+    LE_ASSERT((index < DeadlineHeapCount) && (DeadlineHeapPtr[index] == dogPtr));
+    dogPtr->heapIndex = -1;
+
+    // Fill the hole with the last watchdog in the heap, and move it to where it belongs.
+    DeadlineHeapCount--;
+    if (index < DeadlineHeapCount)
+    {
+        WatchdogObj_t* lastDogPtr = DeadlineHeapPtr[DeadlineHeapCount];
+
+        SetHeapEntry(index, lastDogPtr);
+        if ((index > 0) &&
+            le_clk_GreaterThan(DeadlineHeapPtr[(index - 1) / 2]->heapDeadline,
+                               lastDogPtr->heapDeadline))
+        {
+            SiftUp(index);
+        }
+        else
+        {
+            SiftDown(index);
+        }
+    }
+
+    // No need to re-arm the deadline timer: if it goes off early it will find nothing expired.
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start (or restart) a watchdog so that it expires after the given interval.
+ *
+ * This is the kick path, so for a running watchdog it normally only records the new deadline.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartWatchdog
+(
+    WatchdogObj_t* dogPtr,          ///< [IN] The watchdog to start
+    le_clk_Time_t interval          ///< [IN] Time until the watchdog expires
+)
+{
+    dogPtr->timeoutInterval = interval;
+    dogPtr->deadline = le_clk_Add(le_clk_GetRelativeTime(), interval);
+
+    if (IsWatchdogRunning(dogPtr))
+    {
+        // A later deadline is picked up when the watchdog reaches the top of the heap.
+        if (!le_clk_GreaterThan(dogPtr->heapDeadline, dogPtr->deadline))
+        {
+            return;
+        }
+
+        dogPtr->heapDeadline = dogPtr->deadline;
+        SiftUp(dogPtr->heapIndex);
+    }
+    else
+    {
+        // Grow the heap if it is full.
+        if (DeadlineHeapCount == DeadlineHeapCapacity)
+        {
+            size_t newCapacity = (DeadlineHeapCapacity == 0) ?
+                                    DEADLINE_HEAP_INITIAL_SIZE : (DeadlineHeapCapacity * 2);
+            WatchdogObj_t** newHeapPtr = realloc(DeadlineHeapPtr,
+                                                 newCapacity * sizeof(WatchdogObj_t*));
+            LE_ASSERT(newHeapPtr != NULL);
+
+            DeadlineHeapPtr = newHeapPtr;
+            DeadlineHeapCapacity = newCapacity;
+        }
+
+        dogPtr->heapDeadline = dogPtr->deadline;
+        SetHeapEntry(DeadlineHeapCount, dogPtr);
+        DeadlineHeapCount++;
+        SiftUp(dogPtr->heapIndex);
+    }
+
+    if (dogPtr->heapIndex == 0)
+    {
+        ArmDeadlineTimer();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Restart a watchdog with the interval it was last started with.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void RestartWatchdog
+(
+    WatchdogObj_t* dogPtr           ///< [IN] The watchdog to restart
+)
+{
+    StartWatchdog(dogPtr, dogPtr->timeoutInterval);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the watchdog from our container, stop it and then free the storage we allocated to hold
+ * the watchdog structure.
  */
 //--------------------------------------------------------------------------------------------------
 static void DeleteWatchdog
@@ -309,8 +580,10 @@ static void DeleteWatchdog
         if (deadDogPtr->procId >= 0)
         {
             deadDogPtr->procId = NO_PROC;
-            le_timer_SetContextPtr(deadDogPtr->timer, deadDogPtr);
-            le_timer_Start(deadDogPtr->timer);
+            if (!IsWatchdogRunning(deadDogPtr))
+            {
+                RestartWatchdog(deadDogPtr);
+            }
         }
         le_mem_Release(deadDogPtr);
     }
@@ -475,10 +748,9 @@ static le_result_t GetAppNameFromPid
 //--------------------------------------------------------------------------------------------------
 static void WatchdogHandleExpiry
 (
-    le_timer_Ref_t timerRef ///< [IN] The reference to the expired timer
+    WatchdogObj_t* watchDogPtr ///< [IN] The expired watchdog (already stopped)
 )
 {
-    WatchdogObj_t* watchDogPtr = le_timer_GetContextPtr(timerRef);
     if (watchDogPtr->procId == NO_PROC)
     {
         // Mandatory watchdog expired without the process restarting.  Restart Legato.
@@ -542,6 +814,41 @@ static le_clk_Time_t MakeTimerInterval
     return interval;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The handler for the deadline timer.  Move the watchdogs at the top of the heap which have been
+ * kicked since they were placed there to their new deadlines, and handle the expiry of the others.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeadlineTimerHandler
+(
+    le_timer_Ref_t timerRef ///< [IN] The deadline timer
+)
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    while ((DeadlineHeapCount > 0) && !le_clk_GreaterThan(DeadlineHeapPtr[0]->heapDeadline, now))
+    {
+        WatchdogObj_t* dogPtr = DeadlineHeapPtr[0];
+
+        if (le_clk_GreaterThan(dogPtr->deadline, now))
+        {
+            // Kicked since it was placed in the heap.
+            dogPtr->heapDeadline = dogPtr->deadline;
+            SiftDown(0);
+        }
+        else
+        {
+            // Expiry handling may restart or free this and other watchdogs, so take it out of
+            // the heap first.
+            StopWatchdog(dogPtr);
+            WatchdogHandleExpiry(dogPtr);
+        }
+    }
+
+    ArmDeadlineTimer();
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Check a regular watchdog is running.
@@ -558,9 +865,8 @@ bool CheckWatchdog
     const WatchdogObj_t* dogPtr = valuePtr;
 
     // If watchdog is operating correctly...
-    if (   (dogPtr->timer) &&
-           (le_clk_Equal(dogPtr->maxKickTimeoutInterval, MakeTimerInterval(LE_WDOG_TIMEOUT_NEVER)) ||
-            le_timer_IsRunning(dogPtr->timer)))
+    if (le_clk_Equal(dogPtr->maxKickTimeoutInterval, MakeTimerInterval(LE_WDOG_TIMEOUT_NEVER)) ||
+        IsWatchdogRunning(dogPtr))
     {
         // ...  continue to next watchdog
         return true;
@@ -816,8 +1122,6 @@ static void InitNewWatchdog
     le_clk_Time_t maxKickTimeoutInterval
 )
 {
-    char timerName[LIMIT_MAX_TIMER_NAME_BYTES];
-
     newDogPtr->procId = clientPid;
     newDogPtr->kickTimeoutInterval = kickTimeoutInterval;
     newDogPtr->maxKickTimeoutInterval = maxKickTimeoutInterval;
@@ -827,15 +1131,8 @@ static void InitNewWatchdog
         newDogPtr->kickTimeoutInterval = newDogPtr->maxKickTimeoutInterval;
     }
 
-    LE_ASSERT(0 <= snprintf(timerName, sizeof(timerName),
-                            "wdog_p%p", newDogPtr));
-    newDogPtr->timer = le_timer_Create(timerName);
-    _Static_assert (sizeof(pid_t) <= sizeof(intptr_t), "pid_t is truncated by cast to void*");
-    LE_ASSERT(LE_OK == le_timer_SetContextPtr(newDogPtr->timer, newDogPtr));
-    LE_ASSERT(LE_OK == le_timer_SetHandler(newDogPtr->timer, WatchdogHandleExpiry));
-
-    // Do not wake up a suspended system.
-    LE_ASSERT(LE_OK == le_timer_SetWakeup(newDogPtr->timer, false));
+    newDogPtr->timeoutInterval = newDogPtr->kickTimeoutInterval;
+    newDogPtr->heapIndex = -1;
 }
 
 
@@ -868,12 +1165,10 @@ static WatchdogObj_t* CreateNewWatchdog
         LE_DEBUG("Attaching %d to mandatory watchdog", clientPid);
         newDogPtr = &(mandatoryWdogPtr->watchdog);
         le_mem_AddRef(mandatoryWdogPtr);
-        // Stop the timer -- mandatory timers are always running, even if process
+        // Stop the watchdog -- mandatory watchdogs are always running, even if process
         // doesn't exist.
-        le_timer_Stop(newDogPtr->timer);
+        StopWatchdog(newDogPtr);
         // Then update the proc ID to point to this new process.
-        LE_ASSERT(LE_OK == le_timer_SetContextPtr(newDogPtr->timer,
-                                                  newDogPtr));
         newDogPtr->procId = clientPid;
     }
     else
@@ -920,9 +1215,7 @@ static void CreateMandatoryWatchdog
     LE_ASSERT(NULL == le_hashmap_Put(MandatoryWatchdogRefs, &(newDogPtr->key), newDogPtr));
 
     // Immediately start this watchdog.
-    LE_ASSERT(LE_OK == le_timer_SetInterval(newDogPtr->watchdog.timer,
-                                            newDogPtr->watchdog.kickTimeoutInterval));
-    le_timer_Start(newDogPtr->watchdog.timer);
+    StartWatchdog(&(newDogPtr->watchdog), newDogPtr->watchdog.kickTimeoutInterval);
 }
 
 
@@ -955,9 +1248,7 @@ static MandatoryWatchdogObj_t* CreateFrameworkWatchdog
     LE_ASSERT(NULL == le_hashmap_Put(MandatoryWatchdogRefs, &(newDogPtr->key), newDogPtr));
 
     // Immediately start this watchdog.
-    LE_ASSERT(LE_OK == le_timer_SetInterval(newDogPtr->watchdog.timer,
-                                            newDogPtr->watchdog.kickTimeoutInterval));
-    le_timer_Start(newDogPtr->watchdog.timer);
+    StartWatchdog(&(newDogPtr->watchdog), newDogPtr->watchdog.kickTimeoutInterval);
 
     return newDogPtr;
 }
@@ -975,11 +1266,8 @@ static void CleanupWdog
 {
     WatchdogObj_t* deadDogPtr = objectPtr;
 
-    // If this watchdog has a timer, delete it.
-    if (deadDogPtr->timer)
-    {
-        le_timer_Delete(deadDogPtr->timer);
-    }
+    // Make sure the deadline heap no longer refers to this watchdog.
+    StopWatchdog(deadDogPtr);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1050,7 +1338,6 @@ static void ResetClientWatchdog
     WatchdogObj_t* watchDogPtr = GetClientWatchdogPtr();
     if (watchDogPtr != NULL)
     {
-        le_timer_Stop(watchDogPtr->timer);
         if (timeout == TIMEOUT_KICK)
         {
             timeoutValue = watchDogPtr->kickTimeoutInterval;
@@ -1074,12 +1361,11 @@ static void ResetClientWatchdog
 
         if (!le_clk_Equal(timeoutValue, MakeTimerInterval(LE_WDOG_TIMEOUT_NEVER)))
         {
-            // timer should be stopped here so this should never fail
-            LE_ASSERT(LE_OK == le_timer_SetInterval(watchDogPtr->timer, timeoutValue));
-            le_timer_Start(watchDogPtr->timer);
+            StartWatchdog(watchDogPtr, timeoutValue);
         }
         else
         {
+            StopWatchdog(watchDogPtr);
             LE_DEBUG("Timeout set to NEVER!");
         }
     }
@@ -1103,7 +1389,7 @@ void ResetFrameworkWatchdog
 
     if (watchDogPtr != NULL)
     {
-        le_timer_Restart(watchDogPtr->watchdog.timer);
+        RestartWatchdog(&(watchDogPtr->watchdog));
     }
 }
 
@@ -1263,6 +1549,12 @@ static le_result_t InitializeTimerContainer
     LE_ASSERT(NULL != MandatoryWatchdogRefs);
     le_hashmap_MakeTraceable(MandatoryWatchdogRefs);
 
+    DeadlineTimer = le_timer_Create("wdog_DeadlineTimer");
+    LE_ASSERT(LE_OK == le_timer_SetHandler(DeadlineTimer, DeadlineTimerHandler));
+
+    // Do not wake up a suspended system.
+    LE_ASSERT(LE_OK == le_timer_SetWakeup(DeadlineTimer, false));
+
     return LE_OK;
 }
 
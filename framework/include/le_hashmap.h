@@ -15,13 +15,21 @@
  * type of key that you intend to store. It's unwise to mix types in a single table because
  * implementation of the table has no way to detect this behaviour.
  *
- * Choose the initial size should carefully as the index size remains fixed. The best
- * choice for the initial size is a prime number slightly larger than the
- * maximum expected capacity. If a too small size is chosen, there will be an
- * increase in collisions that degrade performance over time.
+ * The initial size should be the maximum expected capacity. If the map grows beyond it,
+ * the index is doubled in size, so a too small size only costs some extra work while the map
+ * grows. Each time the index grows, the existing entries are moved into the new index a few at a
+ * time by later additions and removals, so no single call has to move the whole map.
  *
  * All hashmaps have names for diagnostic purposes.
  *
+ * @subsection c_hashmap_compact Compact HashMaps
+ *
+ * A map created using @c le_hashmap_CreateCompact() stores its keys, values and hashes in a single
+ * table instead of allocating an entry for each key-value pair. This uses less memory and makes
+ * lookups faster for maps of small keys that are looked up often, at the cost of rebuilding the
+ * whole table at once when it needs to grow. Compact maps are used exactly like other maps, but
+ * adding items during an iteration (see below) may cause items to be skipped or visited twice.
+ *
  * @section c_hashmap_insert Adding key-value pairs
  *
  * Key-value pairs are added using le_hashmap_Put(). For example:
@@ -241,7 +249,7 @@ typedef bool (*le_hashmap_ForEachHandler_t)
  * Create a HashMap.
  *
  * If you create a hashmap with a smaller capacity than you actually use, then
- * the map will continue to work, but performance will degrade the more you put in the map.
+ * the map will grow as needed.
  *
  * @return  Returns a reference to the map.
  *
@@ -256,6 +264,27 @@ le_hashmap_Ref_t le_hashmap_Create
     le_hashmap_EqualsFunc_t    equalsFunc        ///< [in] Equality function
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a compact HashMap.
+ *
+ * A compact map uses open addressing: keys, values and hashes are stored inline in a single table
+ * rather than in separately allocated entries.  It is used with the same functions as any other
+ * map.
+ *
+ * @return  Returns a reference to the map.
+ *
+ * @note Terminates the process on failure, so no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_hashmap_Ref_t le_hashmap_CreateCompact
+(
+    const char*                nameStr,          ///< [in] Name of the HashMap
+    size_t                     capacity,         ///< [in] Expected capacity of the map
+    le_hashmap_HashFunc_t      hashFunc,         ///< [in] Hash function
+    le_hashmap_EqualsFunc_t    equalsFunc        ///< [in] Equality function
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a key-value pair to a HashMap. If the key already exists in the map, the previous value
@@ -22,6 +22,16 @@
  * event-driven manner: As JSON data is received, asynchronous call-back functions are called
  * to deliver parsed information or an error message.
  *
+ * If the file descriptor refers to a regular file, the parser reads it in large chunks and,
+ * when parsing stops, moves the file's read position back to just after the last byte it
+ * processed.  Other types of file descriptor (pipes, sockets, etc.) are read one byte at a time
+ * so that no data following the document is consumed.  Either way, anything after the end
+ * of the document is left in the file descriptor for the client to read.
+ *
+ * A JSON document that is already in memory (e.g., a buffer or a memory-mapped file) can be
+ * parsed using le_json_ParseBuffer() instead.  Parsing is still done by the event loop after the
+ * function returns, so the buffer must remain valid until parsing stops.
+ *
  * Parsing stops automatically when the end of the document is reached or an error is encountered.
  *
  * le_json_Cleanup() must be called to release memory resources allocated by the parser.
@@ -80,7 +90,8 @@
  * string containing the name of a given event.
  *
  * To get the number of bytes that have been read by the parser since le_json_Parse() was called,
- * call le_json_GetBytesRead().
+ * call le_json_GetBytesRead().  This counts only the bytes that have actually been processed by
+ * the parser, not data that has been read ahead of it.
  *
  *  @section c_json_example Example
  *
@@ -222,6 +233,28 @@ le_json_ParsingSessionRef_t le_json_Parse
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a JSON document held in memory (e.g., a buffer or a memory-mapped file).
+ *
+ * Like le_json_Parse(), this returns immediately and parsing is done later by the calling
+ * thread's event loop.
+ *
+ * @return Reference to the JSON parsing session started by this function call.
+ *
+ * @warning The buffer must remain valid until parsing has stopped.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_ParsingSessionRef_t le_json_ParseBuffer
+(
+    const void* bufferPtr,  ///< Buffer containing the JSON document.
+    size_t bufferSize,      ///< Number of bytes of data in the buffer.
+    le_json_EventHandler_t  eventHandler,   ///< Function to call when normal parsing events happen.
+    le_json_ErrorHandler_t  errorHandler,   ///< Function to call when errors happen.
+    void* opaquePtr   ///< Opaque pointer to be fetched by handlers using le_json_GetOpaquePtr().
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Stops parsing and cleans up memory allocated by the parser.
@@ -280,6 +280,28 @@ $ export LE_LOG_LEVEL=DEBUG
  * For example,
  * @verbatim
 $ export LE_LOG_TRACE=framework/fdMonitor:framework/logControl
+@endverbatim
+ *
+ * @subsubsection c_log_control_env_binary LE_LOG_BINARY
+ *
+ * Setting @c LE_LOG_BINARY to @c 1 makes the process log in binary mode.  Instead of formatting
+ * and outputting each message in the thread that logs it, the thread copies the format string's
+ * arguments into its own lock-free ring buffer, and a background thread formats and outputs the
+ * messages, in order, shortly afterwards.  This makes logging a message much cheaper for the
+ * calling thread.  Log level filtering and trace keywords work the same way in both modes.
+ *
+ * In binary mode:
+ * - the format string, file name and function name passed to the logging macros must remain
+ *   valid for the life of the process (as string literals do);
+ * - messages can be dropped if a thread logs faster than they can be output, in which case a
+ *   warning reporting the number of dropped messages is logged;
+ * - critical and emergency messages (including those from @c LE_FATAL and @c LE_ASSERT) are
+ *   output right away, after all the messages logged before them;
+ * - messages logged just before a process is killed or crashes may never be output.
+ *
+ * For example,
+ * @verbatim
+$ export LE_LOG_BINARY=1
 @endverbatim
  *
  * @subsection c_log_control_functions Programmatic Log Control
@@ -406,6 +428,20 @@ void _le_log_Send
     ...
 ) __attribute__ ((format (printf, 7, 8)));
 
+// Same as _le_log_Send(), but the message is always output before returning, even in binary
+// logging mode.  For callers whose file and function name strings don't outlive the call.
+void _le_log_SendNow
+(
+    const le_log_Level_t level,
+    const le_log_TraceRef_t traceRef,
+    le_log_SessionRef_t logSession,
+    const char* filenamePtr,
+    const char* functionNamePtr,
+    const unsigned int lineNumber,
+    const char* formatPtr,
+    ...
+) __attribute__ ((format (printf, 7, 8)));
+
 le_log_TraceRef_t _le_log_GetTraceRef
 (
     le_log_SessionRef_t logSession,
@@ -237,8 +237,10 @@
  *  - @c le_mem_GetObjectCount()
  *  - @c le_mem_GetObjectSize()
  *
- * Statistics are fetched together atomically using a single function call.
- * This prevents inconsistencies between them if in a multi-threaded program.
+ * Statistics are fetched together using a single function call.  Each counter is updated
+ * atomically, so the values are accurate even when several threads are allocating from and
+ * releasing into the same pool.  Free objects held in a thread's local cache (see
+ * @ref mem_threading) are counted as free.
  *
  * If you don't have a reference to a specified pool, but you have the name of the pool, you can
  * get a reference to the pool using @c le_mem_FindPool().
@@ -284,6 +286,11 @@
  * or similar methods should be used to @a synchronize threads and avoid
  * data structure corruption or thread misbehaviour.
  *
+ * To avoid contention between threads, each thread keeps a small cache of free objects for the
+ * pools it uses, so most allocations and releases don't need to synchronize with other threads.
+ * Cached objects are handed back to other threads on demand, so a fixed-size pool never appears
+ * to be exhausted while it still has free objects.
+ *
  * Although memory pools are @a thread-safe, they are not @a async-safe. This means that memory pools
  * @a can be corrupted if they are accessed by a signal handler while they are being accessed
  * by a normal thread.  To be safe, <b> don't call any memory pool functions from within a signal handler. </b>
@@ -679,6 +679,21 @@
  * From this, they obtain a protocol reference that they provide to sessions when they create
  * them.
  *
+ * By default, the whole payload buffer is sent, so every message in a protocol costs as much as
+ * the largest one.  If the sender knows how many bytes of the payload it has actually filled
+ * in, it can call le_msg_SetPayloadSize() before sending the message (or the response), and only
+ * that many bytes will be transferred.  The rest of the receiver's payload buffer will be filled
+ * with zeros.  Code generated by ifgen always does this.
+ *
+ * Protocols that carry large messages can also have them moved through shared memory instead of
+ * being copied through the kernel.  This is enabled per client process by setting the
+ * @c LE_MSG_SHM_THRESHOLD environment variable (e.g., using an @c envVars section in the .adef)
+ * to the smallest message size, in bytes, that should go through shared memory.  It's
+ * negotiated when each session is opened and is invisible to the code using this API; if the
+ * shared memory can't be set up, messages just go through the socket.  Each session using it
+ * holds 8 slots of the protocol's largest message size in each direction, so it's best used only
+ * by processes that really move bulk data.
+ *
  * @section c_messagingSecurity Security
  *
  * Security is provided in the form of authentication and access control.
@@ -1332,6 +1347,28 @@ size_t le_msg_GetMaxPayloadSize
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the number of bytes at the start of the message payload buffer that are actually in use.
+ * Only that many bytes will be sent when the message (or its response) is sent.  On the
+ * receiving side, the rest of the payload buffer will be filled with zeros.
+ *
+ * By default, the whole payload buffer (le_msg_GetMaxPayloadSize() bytes) is sent.
+ *
+ * @note    The message size is reset to the maximum when a request message is received, so a
+ *          server that writes its response into the request's payload buffer must call this
+ *          again before le_msg_Respond() if it wants to send a short response.
+ *
+ * @warning The process will exit if the size is larger than the payload buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_SetPayloadSize
+(
+    le_msg_MessageRef_t msgRef,     ///< [in] Reference to the message.
+    size_t              size        ///< [in] Number of payload bytes in use.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets the file descriptor to be sent with this message.
@@ -16,6 +16,11 @@
  *   - Packing arrays of the above types
  *   - Packing strings.
  * It also supports unpacking any of the above.
+ *
+ * For messages whose maximum size is known in advance, the store/load functions access each field
+ * without any bounds checks, so the size of the whole message only has to be checked once.  They
+ * lay out the data exactly like the pack/unpack functions do, so either can be used to decode a
+ * message encoded by the other.
  */
 
 #ifndef LE_PACK_H_INCLUDE_GUARD
@@ -955,4 +960,175 @@ static inline bool le_pack_UnpackArrayHeader
         }                                                               \
     } while (0)
 
+//--------------------------------------------------------------------------------------------------
+// Store/load functions
+//
+// These are used by code which has already checked that the buffer can hold the largest possible
+// message, e.g. code generated by ifgen with a precomputed message layout, so they only advance
+// the buffer pointer and don't track the available size.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a value into a buffer as the given type, incrementing the buffer pointer.
+ *
+ * @note The type must be the one the matching le_pack_PackXXX() function packs, e.g. uint8_t for
+ * bool, or uint32_t for 32-bit enums.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_PACK_STORE(bufferPtr, type, value)                                   \
+    do {                                                                        \
+        type _storeValue = (type)(value);                                       \
+        memcpy(*(bufferPtr), &_storeValue, sizeof(_storeValue));                \
+        *(bufferPtr) += sizeof(_storeValue);                                    \
+    } while (0)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load a value of the given type from a buffer, incrementing the buffer pointer.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_PACK_LOAD(bufferPtr, type, valuePtr)                                 \
+    do {                                                                        \
+        type _loadValue;                                                        \
+        memcpy(&_loadValue, *(bufferPtr), sizeof(_loadValue));                  \
+        *(bufferPtr) += sizeof(_loadValue);                                     \
+        *(valuePtr) = _loadValue;                                               \
+    } while (0)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a reference into a buffer, incrementing the buffer pointer.
+ *
+ * @return false if the reference is not a safe reference (or NULL); nothing is stored.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool le_pack_StoreReference
+(
+    uint8_t** bufferPtr,
+    const void* ref
+)
+{
+    size_t refAsInt = (size_t)ref;
+
+    if ((refAsInt > UINT32_MAX) ||
+        !((refAsInt & 0x01) || !refAsInt))
+    {
+        return false;
+    }
+
+    LE_PACK_STORE(bufferPtr, uint32_t, refAsInt);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load a reference from a buffer, incrementing the buffer pointer.
+ *
+ * @return false if the value loaded is not a safe reference (or NULL).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool le_pack_LoadReference
+(
+    uint8_t** bufferPtr,
+    void* refPtr                ///< Pointer to the reference.  Declared as void * to allow implicit
+                                ///< conversion from pointer to reference types.
+)
+{
+    uint32_t refAsInt;
+
+    LE_PACK_LOAD(bufferPtr, uint32_t, &refAsInt);
+
+    if ((refAsInt & 0x01) ||
+        (!refAsInt))
+    {
+        // Double cast to avoid warnings.
+        *(void **)refPtr = (void *)(size_t)refAsInt;
+        return true;
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store an array into a buffer with a single copy, incrementing the buffer pointer.
+ *
+ * @note Only for arrays whose elements are stored exactly as they are laid out in memory, i.e.
+ * integers, chars and doubles.
+ *
+ * @return false if the array has more than arrayMaxCount elements; nothing is stored.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool le_pack_StoreArray
+(
+    uint8_t** bufferPtr,
+    const void* arrayPtr,
+    size_t elementSize,
+    size_t arrayCount,
+    size_t arrayMaxCount
+)
+{
+    if (arrayCount > arrayMaxCount)
+    {
+        return false;
+    }
+
+    LE_PACK_STORE(bufferPtr, uint32_t, arrayCount);
+
+    if (arrayCount)
+    {
+        memcpy(*bufferPtr, arrayPtr, arrayCount * elementSize);
+        *bufferPtr += arrayCount * elementSize;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load an array from a buffer with a single copy, incrementing the buffer pointer.
+ *
+ * @note Only for arrays whose elements are stored exactly as they are laid out in memory, i.e.
+ * integers, chars and doubles.
+ *
+ * @return false if the array has more than arrayMaxCount elements, or if arrayPtr is NULL and the
+ * array isn't empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool le_pack_LoadArray
+(
+    uint8_t** bufferPtr,
+    void* arrayPtr,
+    size_t elementSize,
+    size_t* arrayCountPtr,
+    size_t arrayMaxCount
+)
+{
+    uint32_t arrayCount;
+
+    LE_PACK_LOAD(bufferPtr, uint32_t, &arrayCount);
+
+    if (arrayCount > arrayMaxCount)
+    {
+        return false;
+    }
+    else if (!arrayPtr)
+    {
+        // Missing array pointer must match zero sized array.
+        *arrayCountPtr = 0;
+        return (arrayCount == 0);
+    }
+
+    if (arrayCount)
+    {
+        memcpy(arrayPtr, *bufferPtr, arrayCount * elementSize);
+        *bufferPtr += arrayCount * elementSize;
+    }
+    *arrayCountPtr = arrayCount;
+
+    return true;
+}
+
 #endif /* LE_PACK_H_INCLUDE_GUARD */
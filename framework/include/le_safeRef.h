@@ -56,6 +56,18 @@
  * created by calling @c le_ref_CreateMap().  It takes a single argument, the maximum number
  * of mappings expected to track of at any time.
  *
+ * @subsection c_safeRef_slotMap Slot Reference Maps
+ *
+ * A map created by @c le_ref_CreateSlotMap() keeps its mappings in an array of slots instead of
+ * a hashmap.  Each Safe Reference holds the index of its slot and a generation count that changes
+ * every time the slot is reused, so a lookup is a single array access and stale references are
+ * still detected.  Slot maps are used with the same functions as any other map, and are a good
+ * choice for maps that are looked up often, such as the ones behind IPC APIs.  Because the
+ * generation count is limited in size, a stale reference to a slot that has since been reused a
+ * great many times (more than half a million on 32-bit systems) may be mistaken for a valid one.
+ * A slot map can hold up to 4096 Safe References at a time on 32-bit systems, and about a million
+ * on 64-bit systems.
+ *
  * @section c_safeRef_multithreading Multithreading
  *
  * This API's functions are reentrant, but not thread safe. If there's the slightest
@@ -215,6 +227,23 @@ le_ref_MapRef_t le_ref_CreateMap
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a Reference Map that keeps its mappings in an array of slots (see @ref c_safeRef_slotMap).
+ * The array grows as needed.
+ *
+ * @return A reference to the Reference Map object.
+ */
+//--------------------------------------------------------------------------------------------------
+le_ref_MapRef_t le_ref_CreateSlotMap
+(
+    const char* name,   ///< [in] Name of the map (for diagnostics).
+
+    size_t      maxRefs ///< [in] Maximum number of Safe References expected to be kept in
+                        ///       this Reference Map at any one time.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a Safe Reference, storing a mapping between that reference and a specified pointer for
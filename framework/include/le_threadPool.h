@@ -0,0 +1,209 @@
+/**
+ * @page c_threadPool Thread Pool API
+ *
+ * @ref le_threadPool.h "API Reference"
+ *
+ * <HR>
+ *
+ * A thread pool runs work items on a set of worker threads, so that an event-driven thread can
+ * hand off blocking or CPU-intensive work (e.g., copying files, writing to flash, or decoding
+ * messages) without having to create and manage its own threads, and without stalling its
+ * Event Loop while the work is being done.
+ *
+ * @section threadPool_create Creating a Thread Pool
+ *
+ * le_threadPool_Create() creates a pool with a minimum and a maximum number of worker threads.
+ *
+ * - If they are the same, the pool is @b fixed: all the workers are started when the pool is
+ *   created, and they run until it is deleted.
+ * - If the maximum is higher, the pool is @b elastic: more workers are started when work is
+ *   submitted while all of the existing ones are busy, up to the maximum.  Workers above the
+ *   minimum stop after they have been idle for a while.
+ *
+ * @code
+ * le_threadPool_Ref_t PoolRef;
+ *
+ * COMPONENT_INIT
+ * {
+ *     PoolRef = le_threadPool_Create("FileCopy", 1, 4);
+ * }
+ * @endcode
+ *
+ * @section threadPool_submit Submitting Work
+ *
+ * le_threadPool_Submit() queues a work function to be called by one of the pool's workers.  When
+ * it returns, an optional completion function is queued to the Event Loop of the thread that
+ * submitted the work (using le_event_QueueFunctionToThread()), so the result can be used without
+ * any locking.  Both functions receive the same two parameters.
+ *
+ * @code
+ * static void CopyFile(void* param1Ptr, void* param2Ptr)  // Runs in a worker thread.
+ * {
+ *     CopyJob_t* jobPtr = param1Ptr;
+ *     jobPtr->result = CopyContents(jobPtr->srcPath, jobPtr->destPath);
+ * }
+ *
+ * static void CopyDone(void* param1Ptr, void* param2Ptr)  // Runs in the submitting thread.
+ * {
+ *     CopyJob_t* jobPtr = param1Ptr;
+ *     LE_INFO("Copied '%s' (%s).", jobPtr->srcPath, LE_RESULT_TXT(jobPtr->result));
+ *     le_mem_Release(jobPtr);
+ * }
+ *
+ * ...
+ *     le_threadPool_Submit(PoolRef, CopyFile, CopyDone, jobPtr, NULL);
+ * @endcode
+ *
+ * Each worker has its own double-ended queue of work items.  Work submitted by one of the pool's
+ * own workers goes onto that worker's queue, and the worker runs the most recently submitted
+ * item first.  Work submitted by any other thread goes onto a queue shared by the pool.  A worker
+ * whose queue is empty takes work from the shared queue, and failing that, steals the oldest item
+ * from another worker's queue.  So work items run in parallel, and there is no guarantee about
+ * the order in which they run or complete.
+ *
+ * Work functions can use any Legato API that doesn't need an Event Loop.  They must not call
+ * le_event_RunLoop(), and shouldn't register handlers, since the worker threads don't run their
+ * Event Loops.
+ *
+ * @warning A thread that passes a completion function must be running its Event Loop, and must
+ * not exit before the completion function has been called.
+ *
+ * @section threadPool_stats Statistics
+ *
+ * le_threadPool_GetStats() fetches the number of workers, the number of work items waiting to be
+ * run (and the highest that has been reached), and how long work items have waited to be started
+ * and taken to run.
+ *
+ * @section threadPool_delete Deleting a Thread Pool
+ *
+ * le_threadPool_Delete() runs all the work that has been submitted, stops the workers and frees
+ * the pool.  It blocks until all of that has been done, so it must not be called by one of the
+ * pool's own workers.  No more work may be submitted to the pool once it is being deleted.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+//--------------------------------------------------------------------------------------------------
+/** @file le_threadPool.h
+ *
+ * Legato @ref c_threadPool include file.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_THREAD_POOL_INCLUDE_GUARD
+#define LEGATO_THREAD_POOL_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a thread pool.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_threadPool* le_threadPool_Ref_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prototype for work functions and completion functions.
+ *
+ * @param param1Ptr Value passed to le_threadPool_Submit().
+ * @param param2Ptr Value passed to le_threadPool_Submit().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*le_threadPool_WorkFunc_t)
+(
+    void* param1Ptr,
+    void* param2Ptr
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread pool statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t          numThreads;         ///< Number of worker threads currently running.
+    size_t          maxNumThreads;      ///< Maximum number of workers running at any one time.
+    size_t          queueDepth;         ///< Number of work items waiting to be run.
+    size_t          maxQueueDepth;      ///< Maximum number of items waiting at any one time.
+    uint64_t        numCompleted;       ///< Number of work items that have been run.
+    uint64_t        numStolen;          ///< Number of work items stolen from another worker.
+    le_clk_Time_t   totalWaitTime;      ///< Total time completed items waited to be started.
+    le_clk_Time_t   maxWaitTime;        ///< Longest time a work item waited to be started.
+    le_clk_Time_t   totalRunTime;       ///< Total time spent running work items.
+}
+le_threadPool_Stats_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a thread pool.
+ *
+ * @return Reference to the pool.
+ *
+ * @note Terminates the process on failure, no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_threadPool_Ref_t le_threadPool_Create
+(
+    const char* name,           ///< [IN] Name of the pool, used to name its worker threads.
+    size_t      minThreads,     ///< [IN] Number of workers that are always running.
+    size_t      maxThreads      ///< [IN] Maximum number of workers (must be at least 1, and no
+                                ///<      less than minThreads).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Submits work to a thread pool.
+ *
+ * The work function will be called by one of the pool's worker threads.  Then, if a completion
+ * function is given, it will be queued to the calling thread's Event Loop.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_Submit
+(
+    le_threadPool_Ref_t         pool,           ///< [IN] The pool.
+    le_threadPool_WorkFunc_t    workFunc,       ///< [IN] Function to call in a worker thread.
+    le_threadPool_WorkFunc_t    completionFunc, ///< [IN] Function to call in the calling thread
+                                                ///<      afterwards, or NULL.
+    void*                       param1Ptr,      ///< [IN] Value to pass to both functions.
+    void*                       param2Ptr       ///< [IN] Value to pass to both functions.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fetches the statistics for a thread pool.
+ *
+ * @return
+ *      Nothing.  Uses output parameter instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_GetStats
+(
+    le_threadPool_Ref_t     pool,       ///< [IN] The pool.
+    le_threadPool_Stats_t*  statsPtr    ///< [OUT] Pointer to where the stats will be stored.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a thread pool, after running all the work that has been submitted to it.
+ *
+ * @warning Blocks until all the pool's workers have stopped, so it must not be called by one of
+ *          them.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_Delete
+(
+    le_threadPool_Ref_t     pool        ///< [IN] The pool.
+);
+
+
+#endif // LEGATO_THREAD_POOL_INCLUDE_GUARD
@@ -63,6 +63,15 @@
  * The number of times that a timer has expired can be retrieved by @ref le_timer_GetExpiryCount. This
  * count is independent of whether there is an expiry handler for the timer.
  *
+ * @section le_timer_slack Timer Slack
+ *
+ * Timers that don't need to expire at a precise time can be given some slack using
+ * @ref le_timer_SetMsSlack.  A timer with slack may expire at any time between its expiry time and
+ * its expiry time plus the slack.  This allows several timers in the same thread to be handled
+ * together on a single wake-up, instead of each one waking up the thread (and possibly the
+ * system) separately.  The default slack is zero, so timers expire as close as possible to their
+ * expiry time.
+ *
  * @section le_timer_thread Thread Support
  *
  * A timer should only be used by the thread that created it. It's not safe for a thread to use
@@ -98,6 +107,7 @@
  *     - @ref le_timer_GetContextPtr
  *     - @ref le_timer_GetExpiryCount
  *     - @ref le_timer_SetWakeup
+ *     - @ref le_timer_SetMsSlack
  *
  * @section timer_troubleshooting Troubleshooting
  *
@@ -281,6 +291,28 @@ le_result_t le_timer_SetWakeup
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the timer slack using milliseconds.
+ *
+ * The timer may expire up to this much later than its expiry time, so that its expiry can be
+ * handled together with other timers in the same thread.  The default is 0 (no slack).
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_BUSY if the timer is currently running
+ *
+ * @note
+ *      If an invalid timer object is given, the process exits.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_timer_SetMsSlack
+(
+    le_timer_Ref_t timerRef,     ///< [IN] Set slack for this timer object.
+    uint32_t slack               ///< [IN] Timer slack in milliseconds.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set context pointer for the timer.
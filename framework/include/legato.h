@@ -38,6 +38,7 @@
  * @subpage c_singlyLinkedList <br>
  * @subpage c_clock <br>
  * @subpage c_threading <br>
+ * @subpage c_threadPool <br>
  * @subpage c_timer <br>
  * @subpage c_test <br>
  * @subpage c_utf8 <br>
@@ -203,6 +204,7 @@ extern "C" {
 #include "le_semaphore.h"
 #include "le_safeRef.h"
 #include "le_thread.h"
+#include "le_threadPool.h"
 #include "le_eventLoop.h"
 #include "le_fdMonitor.h"
 #include "le_hashmap.h"
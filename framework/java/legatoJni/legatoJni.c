@@ -590,14 +590,14 @@ JNIEXPORT void JNICALL Java_io_legato_LegatoJni_LogMessage
         const char* nMethodPtr = (*envPtr)->GetStringUTFChars(envPtr, method, NULL);
         const char* nMessagePtr = (*envPtr)->GetStringUTFChars(envPtr, message, NULL);
 
-        _le_log_Send((le_log_Level_t)severity,
-                     NULL,
-                     nLogSessionRef,
-                     nFilePtr,
-                     nMethodPtr,
-                     (unsigned int)line,
-                     "%s",
-                     nMessagePtr);
+        _le_log_SendNow((le_log_Level_t)severity,
+                        NULL,
+                        nLogSessionRef,
+                        nFilePtr,
+                        nMethodPtr,
+                        (unsigned int)line,
+                        "%s",
+                        nMessagePtr);
 
         (*envPtr)->ReleaseStringUTFChars(envPtr, file, nFilePtr);
         (*envPtr)->ReleaseStringUTFChars(envPtr, method, nMethodPtr);
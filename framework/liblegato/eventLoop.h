@@ -38,6 +38,28 @@ typedef enum
 event_LoopState_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event Queue.
+ *
+ * Intrusive multi-producer, single-consumer queue of Event Reports.  Any thread can push onto it
+ * without holding a lock, but only the thread that owns it can pop from it.
+ *
+ * Producers push onto a LIFO stack with a single compare-and-swap, so a push is either complete
+ * or hasn't happened yet.  When the consumer runs out of links to pop, it takes the whole stack
+ * in one exchange and reverses it, so links are still popped in the order they were pushed.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_sls_Link_t*      pushedPtr;          ///< Links pushed since the consumer last took them,
+                                            ///< newest first.  Updated atomically.
+    le_sls_Link_t*      poppedPtr;          ///< Links taken by the consumer, oldest first.  Only
+                                            ///< used by the consumer.
+}
+event_Queue_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Event Loop's per-thread record.
@@ -51,14 +73,20 @@ event_LoopState_t;
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    le_sls_List_t       eventQueue;         ///< The thread's event queue.
+    event_Queue_t       eventQueue;         ///< The thread's event queue.
+    size_t              queueCount;         ///< Number of reports pushed but not yet processed.
+                                            ///< The thread is woken up by whoever raises this
+                                            ///< from zero.  Updated atomically.
+    size_t              maxQueueCount;      ///< Highest value queueCount has reached.
+    size_t              reportCount;        ///< Number of reports pushed onto the queue.
+    size_t              wakeupCount;        ///< Number of writes to the eventfd.
     le_dls_List_t       handlerList;        ///< List of handlers registered with this thread.
     le_dls_List_t       fdMonitorList;      ///< List of FD Monitors created by this thread.
     int                 epollFd;            ///< epoll(7) file descriptor.
     int                 eventQueueFd;       ///< eventfd(2) file descriptor for the Event Queue.
     void*               contextPtr;         ///< Context pointer from last Handler called.
     event_LoopState_t   state;              ///< Current state of the event loop.
-    uint64_t            liveEventCount;     ///< Number of events ready for dequeing.  Ensures
+    size_t              liveEventCount;     ///< Number of events ready for dequeing.  Ensures
                                             ///< balance between queued events and monitored fds
                                             ///< in le_event_ServiceLoop().
 }
@@ -0,0 +1,501 @@
+/** @file bootTrace.c
+ *
+ * Boot tracer.  Records the start-up phases of the framework into a ring of fixed-size binary
+ * records in a file on tmpfs (BOOT_TRACE_PATH), shared by all the processes that take part in
+ * start-up.
+ *
+ * @verbatim
+ *
+ *   +--------+----------+----------+-----+------------------------+
+ *   | Header | record 0 | record 1 | ... | record (capacity - 1)  |
+ *   +--------+----------+----------+-----+------------------------+
+ *
+ * @endverbatim
+ *
+ * startSystem creates a new trace file each time it starts the framework (bootTrace_Start()).
+ * Every other process maps the file the first time it records an event, and records the name of
+ * the process at the same time.  If there is no trace file, recording does nothing.
+ *
+ * A writer claims the next record by atomically incrementing the header's event counter, so
+ * recording never blocks and needs no system calls once the file is mapped.  Event number n goes
+ * in record (n % capacity), so once the ring is full the oldest events are overwritten.  Each
+ * record's sequence number is cleared while the record is being written and set to (n + 1) once
+ * it is complete, which is how the reader finds (and skips) records that are being written or
+ * that were overwritten while it was copying them.
+ *
+ * The Supervisor marks the boot finished once the auto-start apps have been started
+ * (bootTrace_Finish()).  Nothing is recorded after that.
+ *
+ * Times are CLOCK_MONOTONIC, so they are comparable across processes and count from (roughly)
+ * when the kernel started.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "bootTrace.h"
+#include "fileDescriptor.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of the magic number at the start of the trace file ("LEBT").
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACE_MAGIC 0x5442454C
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Version of the trace file layout.  Must be changed whenever Header_t or Record_t change.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACE_VERSION 1
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of records in the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACE_CAPACITY 1024
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory the trace file is created in.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACE_DIR "/tmp/legato"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of the trace file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t magic;         ///< TRACE_MAGIC.
+    uint32_t version;       ///< TRACE_VERSION.
+    uint32_t capacity;      ///< Number of records in the ring.
+    uint32_t isFinished;    ///< Non-zero once the boot has been marked finished.
+    uint32_t eventCount;    ///< Number of events claimed so far (next event number).
+    uint32_t reserved;
+}
+Header_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A record in the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t seq;                               ///< Event number + 1, or 0 while being written.
+    uint8_t type;                               ///< bootTrace_EventType_t.
+    uint8_t reserved[3];
+    int32_t pid;                                ///< Process that recorded the event.
+    int32_t tid;                                ///< Thread that recorded the event.
+    uint64_t startNs;                           ///< CLOCK_MONOTONIC time, in nanoseconds.
+    uint64_t durationNs;                        ///< Duration (complete events only).
+    char category[BOOT_TRACE_CATEGORY_BYTES];   ///< Category (null-terminated).
+    char name[BOOT_TRACE_NAME_BYTES];           ///< Name (null-terminated, may be truncated).
+}
+Record_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the trace file, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACE_FILE_SIZE (sizeof(Header_t) + (TRACE_CAPACITY * sizeof(Record_t)))
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This process's mapping of the trace file, or NULL if there is no trace to record into.
+ */
+//--------------------------------------------------------------------------------------------------
+static Header_t* HeaderPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes sure the trace file is only mapped once per process.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_once_t OpenOnce = PTHREAD_ONCE_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a pointer to a record in a mapped trace file.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline Record_t* GetRecordPtr
+(
+    Header_t* headerPtr,
+    uint32_t eventNum
+)
+{
+    return ((Record_t*)(headerPtr + 1)) + (eventNum % TRACE_CAPACITY);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maps an existing trace file.
+ *
+ * @return Pointer to the mapping, or NULL if there is no (valid) trace file.
+ */
+//--------------------------------------------------------------------------------------------------
+static Header_t* MapTraceFile
+(
+    int openFlags       ///< [IN] O_RDONLY or O_RDWR.
+)
+{
+    int fd = open(BOOT_TRACE_PATH, openFlags | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    struct stat st;
+    Header_t* headerPtr = NULL;
+
+    if ((fstat(fd, &st) == 0) && (st.st_size == TRACE_FILE_SIZE))
+    {
+        int prot = (openFlags == O_RDWR) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+
+        headerPtr = mmap(NULL, TRACE_FILE_SIZE, prot, MAP_SHARED, fd, 0);
+        if (headerPtr == MAP_FAILED)
+        {
+            headerPtr = NULL;
+        }
+        else if (   (headerPtr->magic != TRACE_MAGIC)
+                 || (headerPtr->version != TRACE_VERSION)
+                 || (headerPtr->capacity != TRACE_CAPACITY) )
+        {
+            munmap(headerPtr, TRACE_FILE_SIZE);
+            headerPtr = NULL;
+        }
+    }
+
+    fd_Close(fd);
+
+    return headerPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes an event into the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteEvent
+(
+    bootTrace_EventType_t type,
+    const char* categoryPtr,
+    const char* namePtr,
+    uint64_t startNs,
+    uint64_t durationNs
+)
+{
+    uint32_t eventNum = __atomic_fetch_add(&HeaderPtr->eventCount, 1, __ATOMIC_RELAXED);
+    Record_t* recordPtr = GetRecordPtr(HeaderPtr, eventNum);
+
+    __atomic_store_n(&recordPtr->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    recordPtr->type = type;
+    recordPtr->pid = getpid();
+    recordPtr->tid = syscall(SYS_gettid);
+    recordPtr->startNs = startNs;
+    recordPtr->durationNs = durationNs;
+    le_utf8_Copy(recordPtr->category, categoryPtr, sizeof(recordPtr->category), NULL);
+    le_utf8_Copy(recordPtr->name, namePtr, sizeof(recordPtr->name), NULL);
+
+    __atomic_store_n(&recordPtr->seq, eventNum + 1, __ATOMIC_RELEASE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maps the trace file for recording, if there is one and the boot isn't finished yet, and records
+ * the name of this process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OpenTrace
+(
+    void
+)
+{
+    Header_t* headerPtr = MapTraceFile(O_RDWR);
+
+    if (headerPtr == NULL)
+    {
+        return;
+    }
+
+    if (__atomic_load_n(&headerPtr->isFinished, __ATOMIC_ACQUIRE))
+    {
+        munmap(headerPtr, TRACE_FILE_SIZE);
+        return;
+    }
+
+    HeaderPtr = headerPtr;
+
+    WriteEvent(BOOT_TRACE_PROCESS, "", program_invocation_short_name, bootTrace_Now(), 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether events should be recorded, mapping the trace file the first time.
+ *
+ * @return true if events should be recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsRecording
+(
+    void
+)
+{
+    pthread_once(&OpenOnce, OpenTrace);
+
+    return (HeaderPtr != NULL) && !__atomic_load_n(&HeaderPtr->isFinished, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a new, empty boot trace, replacing the previous one.  Called by startSystem each time it
+ * is about to start the framework.
+ *
+ * @note Must not be called while other threads in this process are recording events.
+ */
+//--------------------------------------------------------------------------------------------------
+void bootTrace_Start
+(
+    void
+)
+{
+    static const char newPath[] = BOOT_TRACE_PATH ".new";
+
+    pthread_once(&OpenOnce, OpenTrace);
+
+    if (HeaderPtr != NULL)
+    {
+        munmap(HeaderPtr, TRACE_FILE_SIZE);
+        HeaderPtr = NULL;
+    }
+
+    if (le_dir_MakePath(TRACE_DIR, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != LE_OK)
+    {
+        LE_WARN("Boot trace disabled. Couldn't create '%s'.", TRACE_DIR);
+        return;
+    }
+
+    // Build the new file beside the old one and rename it into place, so that a process that is
+    // still mapping the old file never sees a half-initialized one.
+    int fd = open(newPath, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP);
+    if (fd < 0)
+    {
+        LE_WARN("Boot trace disabled. Couldn't create '%s' (%m).", newPath);
+        return;
+    }
+
+    Header_t* headerPtr = MAP_FAILED;
+
+    if (ftruncate(fd, TRACE_FILE_SIZE) == 0)
+    {
+        headerPtr = mmap(NULL, TRACE_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+
+    fd_Close(fd);
+
+    if (headerPtr == MAP_FAILED)
+    {
+        LE_WARN("Boot trace disabled. Couldn't size or map '%s' (%m).", newPath);
+        unlink(newPath);
+        return;
+    }
+
+    headerPtr->magic = TRACE_MAGIC;
+    headerPtr->version = TRACE_VERSION;
+    headerPtr->capacity = TRACE_CAPACITY;
+
+    if (rename(newPath, BOOT_TRACE_PATH) != 0)
+    {
+        LE_WARN("Boot trace disabled. Couldn't rename '%s' (%m).", newPath);
+        munmap(headerPtr, TRACE_FILE_SIZE);
+        unlink(newPath);
+        return;
+    }
+
+    HeaderPtr = headerPtr;
+
+    WriteEvent(BOOT_TRACE_PROCESS, "", program_invocation_short_name, bootTrace_Now(), 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the current time in the boot trace's time base.
+ *
+ * @return CLOCK_MONOTONIC time, in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t bootTrace_Now
+(
+    void
+)
+{
+    struct timespec now;
+
+    LE_ASSERT(clock_gettime(CLOCK_MONOTONIC, &now) == 0);
+
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records a phase that started at a given time (see bootTrace_Now()) and ends now.
+ *
+ * Does nothing if there is no boot trace, or if the boot has been marked finished.
+ */
+//--------------------------------------------------------------------------------------------------
+void bootTrace_Record
+(
+    const char* categoryPtr,    ///< [IN] Category of the phase.
+    const char* namePtr,        ///< [IN] Name of the phase.
+    uint64_t startNs            ///< [IN] Time at which the phase started.
+)
+{
+    if (IsRecording())
+    {
+        WriteEvent(BOOT_TRACE_COMPLETE, categoryPtr, namePtr, startNs, bootTrace_Now() - startNs);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records a point in time.
+ *
+ * Does nothing if there is no boot trace, or if the boot has been marked finished.
+ */
+//--------------------------------------------------------------------------------------------------
+void bootTrace_Mark
+(
+    const char* categoryPtr,    ///< [IN] Category of the event.
+    const char* namePtr         ///< [IN] Name of the event.
+)
+{
+    if (IsRecording())
+    {
+        WriteEvent(BOOT_TRACE_INSTANT, categoryPtr, namePtr, bootTrace_Now(), 0);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Marks the boot as finished.  Nothing more is recorded in the boot trace after this, so that
+ * apps started and restarted later don't push the start-up phases out of the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+void bootTrace_Finish
+(
+    void
+)
+{
+    if (IsRecording())
+    {
+        WriteEvent(BOOT_TRACE_INSTANT, "boot", "finished", bootTrace_Now(), 0);
+
+        __atomic_store_n(&HeaderPtr->isFinished, 1, __ATOMIC_RELEASE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the events in the boot trace, oldest first.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_NOT_FOUND if there is no boot trace.
+ * - LE_FORMAT_ERROR if the boot trace file is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t bootTrace_Read
+(
+    void (*handlerPtr)(const bootTrace_Event_t* eventPtr, void* contextPtr),
+                                ///< [IN] Function to call for each event.
+    void* contextPtr,           ///< [IN] Passed to the handler.
+    bool* isFinishedPtr,        ///< [OUT] Set to true if the boot has been marked finished.
+    size_t* droppedCountPtr     ///< [OUT] Number of events that were pushed out of the ring.
+)
+{
+    if (access(BOOT_TRACE_PATH, F_OK) != 0)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    Header_t* headerPtr = MapTraceFile(O_RDONLY);
+    if (headerPtr == NULL)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    *isFinishedPtr = (__atomic_load_n(&headerPtr->isFinished, __ATOMIC_ACQUIRE) != 0);
+
+    uint32_t eventCount = __atomic_load_n(&headerPtr->eventCount, __ATOMIC_ACQUIRE);
+    uint32_t eventNum = (eventCount > TRACE_CAPACITY) ? (eventCount - TRACE_CAPACITY) : 0;
+
+    *droppedCountPtr = eventNum;
+
+    for (; eventNum < eventCount; eventNum++)
+    {
+        const Record_t* recordPtr = GetRecordPtr(headerPtr, eventNum);
+
+        if (__atomic_load_n(&recordPtr->seq, __ATOMIC_ACQUIRE) != eventNum + 1)
+        {
+            // Still being written (or already overwritten).
+            continue;
+        }
+
+        bootTrace_Event_t event;
+
+        event.type = recordPtr->type;
+        event.startNs = recordPtr->startNs;
+        event.durationNs = recordPtr->durationNs;
+        event.pid = recordPtr->pid;
+        event.tid = recordPtr->tid;
+        memcpy(event.category, recordPtr->category, sizeof(event.category));
+        memcpy(event.name, recordPtr->name, sizeof(event.name));
+        event.category[sizeof(event.category) - 1] = '\0';
+        event.name[sizeof(event.name) - 1] = '\0';
+
+        // Make sure the record wasn't reused while it was being copied.
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&recordPtr->seq, __ATOMIC_RELAXED) != eventNum + 1)
+        {
+            continue;
+        }
+
+        handlerPtr(&event, contextPtr);
+    }
+
+    munmap(headerPtr, TRACE_FILE_SIZE);
+
+    return LE_OK;
+}
@@ -0,0 +1,159 @@
+/** @file bootTrace.h
+ *
+ * Boot tracer's intra-framework header file.
+ *
+ * The boot tracer records how long each phase of the framework's start-up takes (in startSystem,
+ * the Supervisor, and on behalf of each framework daemon, app and process) into a small ring of
+ * fixed-size binary records in a shared file under /tmp.  The bootTrace tool dumps the ring as a
+ * Chrome trace (JSON) timeline.  See bootTrace.c for details.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef BOOT_TRACE_INCLUDE_GUARD
+#define BOOT_TRACE_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path of the file holding the boot trace ring.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BOOT_TRACE_PATH "/tmp/legato/bootTrace"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of an event's category, including the null terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BOOT_TRACE_CATEGORY_BYTES 12
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of an event's name, including the null terminator.  Longer names are truncated.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BOOT_TRACE_NAME_BYTES 56
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kinds of events in the boot trace.  The values are the Chrome trace event phase characters.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    BOOT_TRACE_COMPLETE = 'X',      ///< A phase with a start time and a duration.
+    BOOT_TRACE_INSTANT = 'i',       ///< A point in time.
+    BOOT_TRACE_PROCESS = 'M',       ///< The name of the process that recorded events.
+}
+bootTrace_EventType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An event read back from the boot trace.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    bootTrace_EventType_t type;                     ///< Kind of event.
+    uint64_t startNs;                               ///< CLOCK_MONOTONIC time, in nanoseconds.
+    uint64_t durationNs;                            ///< Duration (complete events only).
+    pid_t pid;                                      ///< Process that recorded the event.
+    pid_t tid;                                      ///< Thread that recorded the event.
+    char category[BOOT_TRACE_CATEGORY_BYTES];       ///< Category ("start", "daemon", "app", ...)
+    char name[BOOT_TRACE_NAME_BYTES];               ///< Name of the phase or process.
+}
+bootTrace_Event_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a new, empty boot trace, replacing the previous one.  Called by startSystem each time it
+ * is about to start the framework.
+ */
+//--------------------------------------------------------------------------------------------------
+void bootTrace_Start
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the current time in the boot trace's time base.
+ *
+ * @return CLOCK_MONOTONIC time, in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t bootTrace_Now
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records a phase that started at a given time (see bootTrace_Now()) and ends now.
+ *
+ * Does nothing if there is no boot trace, or if the boot has been marked finished.
+ */
+//--------------------------------------------------------------------------------------------------
+void bootTrace_Record
+(
+    const char* categoryPtr,    ///< [IN] Category of the phase.
+    const char* namePtr,        ///< [IN] Name of the phase.
+    uint64_t startNs            ///< [IN] Time at which the phase started.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records a point in time.
+ *
+ * Does nothing if there is no boot trace, or if the boot has been marked finished.
+ */
+//--------------------------------------------------------------------------------------------------
+void bootTrace_Mark
+(
+    const char* categoryPtr,    ///< [IN] Category of the event.
+    const char* namePtr         ///< [IN] Name of the event.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Marks the boot as finished.  Nothing more is recorded in the boot trace after this, so that
+ * apps started and restarted later don't push the start-up phases out of the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+void bootTrace_Finish
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the events in the boot trace, oldest first.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_NOT_FOUND if there is no boot trace.
+ * - LE_FORMAT_ERROR if the boot trace file is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t bootTrace_Read
+(
+    void (*handlerPtr)(const bootTrace_Event_t* eventPtr, void* contextPtr),
+                                ///< [IN] Function to call for each event.
+    void* contextPtr,           ///< [IN] Passed to the handler.
+    bool* isFinishedPtr,        ///< [OUT] Set to true if the boot has been marked finished.
+    size_t* droppedCountPtr     ///< [OUT] Number of events that were pushed out of the ring.
+);
+
+
+#endif // BOOT_TRACE_INCLUDE_GUARD
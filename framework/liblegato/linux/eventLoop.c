@@ -65,9 +65,16 @@
  * Included in the set of file descriptors that are being monitored by epoll is an eventfd
  * (see 'man eventfd') monitored in "level-triggered" mode.
  *
- * Whenever an Event Report is added to the Event Queue for a thread, the number 1 is written to
- * that thread's eventfd.  When Event Reports are popped off a thread's Event Queue, that thread's
- * eventfd is read to decrement it.  As long as the eventfd's value is greater than 0, epoll_wait()
+ * Each thread's Event Queue is a multi-producer, single-consumer linked list that is updated with
+ * atomic operations instead of the Mutex.  A report is pushed in a single atomic step, before it
+ * is counted, so every counted report can be popped straight away.  The Per-Thread Record keeps
+ * an atomic count of the Event Reports that have been pushed onto the queue but not yet
+ * processed.  A producer that raises this count from zero writes to the thread's eventfd
+ * to wake it up.  Any other producer knows that the thread is already awake (or about to be), so
+ * it doesn't make the system call.  The thread reads the eventfd to reset it, processes the
+ * Event Reports that were counted at that time, and takes them off the count.  If more were
+ * added in the meantime, it writes to its own eventfd so that it comes back for them after
+ * checking the other fds.  As long as the eventfd's value is greater than 0, epoll_wait()
  * will return immediately, reporting that there is something to read from that fd.
  *
  * The Event Loop is an infinite loop that calls epoll_wait() and then responds to any fd events
@@ -88,6 +95,11 @@
  * multithreaded race conditions.  A Mutex is provided for that purpose, and it can be locked
  * and unlocked using the functions Lock() and Unlock().
  *
+ * The exception is the Event Queue, which is updated with atomic operations only, so that
+ * queueing a function doesn't need the Mutex.  Reporting an event still locks the Mutex while it
+ * walks the Event's Handler List.  Producers disable thread cancellation while they push, so that
+ * a report is never left pushed but uncounted, or counted without its thread being woken up.
+ *
  * ----
  *
  * Copyright (C) Sierra Wireless Inc.
@@ -327,9 +339,9 @@ static le_ref_MapRef_t HandlerRefMap;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Mutex is used to protect all data structures, other than the Init Handler List, from
- * multithreaded race conditions.  Threads wishing to access anything under the Event List or
- * the Per-Thread Records must hold this lock while doing so.
+ * Mutex is used to protect all data structures, other than the Init Handler List and the
+ * Event Queues, from multithreaded race conditions.  Threads wishing to access anything under
+ * the Event List or the Per-Thread Records must hold this lock while doing so.
  */
 //--------------------------------------------------------------------------------------------------
 static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mutex.
@@ -337,12 +349,12 @@ static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mute
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Guards against thread cancellation and locks the mutex.
+ * Guards against thread cancellation.
  *
  * @return Old state of cancelability.
  **/
 //--------------------------------------------------------------------------------------------------
-static int Lock
+static int DisableCancel
 (
     void
 )
@@ -354,6 +366,43 @@ static int Lock
 
     LE_FATAL_IF(err != 0, "pthread_setcancelstate() failed (%s)", strerror(err));
 
+    return oldState;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Releases the thread cancellation guard created by DisableCancel().
+ **/
+//--------------------------------------------------------------------------------------------------
+static void RestoreCancel
+(
+    int restoreTo   ///< Old state of cancellability to be restored.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int junk;
+
+    int err = pthread_setcancelstate(restoreTo, &junk);
+    LE_FATAL_IF(err != 0, "pthread_setcancelstate() failed (%s)", strerror(err));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Guards against thread cancellation and locks the mutex.
+ *
+ * @return Old state of cancelability.
+ **/
+//--------------------------------------------------------------------------------------------------
+static int Lock
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int oldState = DisableCancel();
+
     LE_ASSERT(pthread_mutex_lock(&Mutex) == 0);
 
     return oldState;
@@ -371,12 +420,9 @@ static void Unlock
 )
 //--------------------------------------------------------------------------------------------------
 {
-    int junk;
-
     LE_ASSERT(pthread_mutex_unlock(&Mutex) == 0);
 
-    int err = pthread_setcancelstate(restoreTo, &junk);
-    LE_FATAL_IF(err != 0, "pthread_setcancelstate() failed (%s)", strerror(err));
+    RestoreCancel(restoreTo);
 }
 
 
@@ -486,9 +532,8 @@ static void DeleteHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Write to a thread's Event File Descriptor.  This increments it by one.
- *
- * This must be done exactly once for each Event Report pushed onto the thread's Event Queue.
+ * Write to a thread's Event File Descriptor.  This increments it by one, which wakes the thread
+ * up if it is waiting in epoll_wait().
  */
 //--------------------------------------------------------------------------------------------------
 static void WriteEventFd
@@ -501,6 +546,8 @@ static void WriteEventFd
 
     ssize_t writeSize;
 
+    __atomic_add_fetch(&perThreadRecPtr->wakeupCount, 1, __ATOMIC_RELAXED);
+
     for (;;)
     {
         writeSize = write(perThreadRecPtr->eventQueueFd, &writeBuff, sizeof(writeBuff));
@@ -508,9 +555,13 @@ static void WriteEventFd
         {
             return;
         }
+        else if ((writeSize == -1) && (errno == EINTR))
+        {
+            continue;
+        }
         else
         {
-            if ((writeSize == -1) && (errno != EINTR))
+            if (writeSize == -1)
             {
                 LE_FATAL("write() failed with errno %d (%m).", errno);
             }
@@ -525,13 +576,12 @@ static void WriteEventFd
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read a thread's Event File Descriptor.  This fetches the value of the Event FD (which is
- * the number of event reports on the Event Queue) and resets the Event FD value to zero.
- *
- * @return The number of Event Reports on the thread's Event Queue.
+ * Read a thread's Event File Descriptor.  This resets the Event FD value to zero, so epoll stops
+ * reporting it until the thread is woken up again.  The Event FD is non-blocking, so this returns
+ * immediately if it is already zero.
  */
 //--------------------------------------------------------------------------------------------------
-static uint64_t ReadEventFd
+static void ReadEventFd
 (
     event_PerThreadRec_t* perThreadRecPtr
 )
@@ -543,13 +593,17 @@ static uint64_t ReadEventFd
     for (;;)
     {
         readSize = read(perThreadRecPtr->eventQueueFd, &readBuff, sizeof(readBuff));
-        if (readSize == sizeof(readBuff))
+        if ((readSize == sizeof(readBuff)) || ((readSize == -1) && (errno == EAGAIN)))
         {
-            return readBuff;
+            return;
+        }
+        else if ((readSize == -1) && (errno == EINTR))
+        {
+            continue;
         }
         else
         {
-            if ((readSize == -1) && (errno != EINTR))
+            if (readSize == -1)
             {
                 LE_FATAL("read() failed with errno %d (%m).", errno);
             }
@@ -564,33 +618,190 @@ static uint64_t ReadEventFd
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Process one event report from the calling thread's Event Queue.
- **/
+ * Initialize a thread's Event Queue.
+ */
 //--------------------------------------------------------------------------------------------------
-static void ProcessOneEventReport
+static void InitQueue
+(
+    event_Queue_t* queuePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    queuePtr->pushedPtr = NULL;
+    queuePtr->poppedPtr = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a link onto an Event Queue.  Can be called by any thread.
+ *
+ * The link is published by a single compare-and-swap, so the consumer never sees a push that is
+ * only partly done.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushLink
+(
+    event_Queue_t* queuePtr,
+    le_sls_Link_t* linkPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_sls_Link_t* nextPtr = __atomic_load_n(&queuePtr->pushedPtr, __ATOMIC_RELAXED);
+
+    do
+    {
+        linkPtr->nextPtr = nextPtr;
+    }
+    while (!__atomic_compare_exchange_n(&queuePtr->pushedPtr, &nextPtr, linkPtr,
+                                        true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pop the oldest link off an Event Queue.  Must only be called by the thread that owns it.
+ *
+ * @return Pointer to the link, or NULL if the queue is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sls_Link_t* PopLink
+(
+    event_Queue_t* queuePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (queuePtr->poppedPtr == NULL)
+    {
+        // Take everything pushed so far, and reverse it into the order it was pushed in.
+        le_sls_Link_t* linkPtr = __atomic_exchange_n(&queuePtr->pushedPtr, NULL, __ATOMIC_ACQUIRE);
+
+        while (linkPtr != NULL)
+        {
+            le_sls_Link_t* nextPtr = linkPtr->nextPtr;
+
+            linkPtr->nextPtr = queuePtr->poppedPtr;
+            queuePtr->poppedPtr = linkPtr;
+            linkPtr = nextPtr;
+        }
+    }
+
+    le_sls_Link_t* linkPtr = queuePtr->poppedPtr;
+
+    if (linkPtr != NULL)
+    {
+        queuePtr->poppedPtr = linkPtr->nextPtr;
+        linkPtr->nextPtr = NULL;
+    }
+
+    return linkPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push an Event Report onto a thread's Event Queue, and wake the thread up unless it already has
+ * unprocessed reports (in which case it is either awake or has already been woken up).
+ *
+ * @warning Assumes the calling thread is protected from cancellation.
+ */
+//--------------------------------------------------------------------------------------------------
+static void QueueReport
+(
+    event_PerThreadRec_t*   perThreadRecPtr, ///< [in] Pointer to the thread's event data record.
+    Report_t*               reportPtr        ///< [in] The report.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    PushLink(&perThreadRecPtr->eventQueue, &reportPtr->link);
+
+    __atomic_add_fetch(&perThreadRecPtr->reportCount, 1, __ATOMIC_RELAXED);
+
+    size_t count = __atomic_add_fetch(&perThreadRecPtr->queueCount, 1, __ATOMIC_ACQ_REL);
+
+    size_t maxCount = __atomic_load_n(&perThreadRecPtr->maxQueueCount, __ATOMIC_RELAXED);
+    while ((count > maxCount) &&
+           !__atomic_compare_exchange_n(&perThreadRecPtr->maxQueueCount, &maxCount, count,
+                                        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        // maxCount has been refreshed, so just try again.
+    }
+
+    if (count == 1)
+    {
+        WriteEventFd(perThreadRecPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pop the next Event Report off the calling thread's Event Queue.  Must only be called when
+ * the queue's count says there is a report on it.
+ *
+ * @return Pointer to the report.
+ */
+//--------------------------------------------------------------------------------------------------
+static Report_t* PopReport
 (
     event_PerThreadRec_t* perThreadRecPtr   ///< [in] Ptr to the calling thread's per-thread record.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_sls_Link_t* linkPtr;
-    Report_t* reportObjPtr;
-    Handler_t* handlerPtr;
+    le_sls_Link_t* linkPtr = PopLink(&perThreadRecPtr->eventQueue);
 
-    int oldState = Lock();
+    // Reports are pushed before they are counted, so a counted report is always there.
+    LE_ASSERT(linkPtr != NULL);
 
-    // Pop an Event Report off the head of the Event Queue (inside a critical section).
-    linkPtr = le_sls_Pop(&perThreadRecPtr->eventQueue);
+    return CONTAINER_OF(linkPtr, Report_t, link);
+}
 
-    Unlock(oldState);
 
-    if (linkPtr == NULL)
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take processed Event Reports off the calling thread's queue count.  If there are more reports
+ * on the queue, and this was the end of a batch, wake the thread up again so that it comes back
+ * for them after checking its other file descriptors.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FinishEventReports
+(
+    event_PerThreadRec_t* perThreadRecPtr,  ///< [in] Ptr to the calling thread's per-thread record.
+    size_t numReports,                      ///< [in] Number of reports processed.
+    bool isEndOfBatch                       ///< [in] true if no more reports will be processed
+                                            ///       before checking the file descriptors.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count = __atomic_sub_fetch(&perThreadRecPtr->queueCount, numReports, __ATOMIC_ACQ_REL);
+
+    if (isEndOfBatch && (count > 0))
     {
-        return;
+        WriteEventFd(perThreadRecPtr);
     }
+}
 
-    // Convert the link pointer into a pointer to the Report base class.
-    reportObjPtr = CONTAINER_OF(linkPtr, Report_t, link);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process one event report from the calling thread's Event Queue.
+ *
+ * Must only be called when the queue's count says there is a report on it.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ProcessOneEventReport
+(
+    event_PerThreadRec_t* perThreadRecPtr   ///< [in] Ptr to the calling thread's per-thread record.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Report_t* reportObjPtr;
+    Handler_t* handlerPtr;
+    int oldState;
+
+    // Pop an Event Report off the head of the Event Queue.  Only this thread pops from it, so
+    // this doesn't need the mutex.
+    reportObjPtr = PopReport(perThreadRecPtr);
 
     // If it's a queued function report,
     if (reportObjPtr->type == LE_EVENT_REPORT_QUEUED_FUNC)
@@ -663,6 +874,26 @@ static void ProcessOneEventReport
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process one of the event reports counted by the last call to le_event_ServiceLoop() that read
+ * the eventfd.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ProcessLiveEventReport
+(
+    event_PerThreadRec_t* perThreadRecPtr   ///< [in] Ptr to the calling thread's per-thread record.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    perThreadRecPtr->liveEventCount--;
+
+    ProcessOneEventReport(perThreadRecPtr); // This function assumes the mutex is NOT locked.
+
+    FinishEventReports(perThreadRecPtr, 1, (perThreadRecPtr->liveEventCount == 0));
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Process Event Reports from the calling thread's Event Queue until the queue is empty.
@@ -674,18 +905,22 @@ static void ProcessEventReports
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Read the eventfd to fetch the number of Reports on the Event Queue and reset the count
-    // to zero.
-    uint64_t numReports = ReadEventFd(perThreadRecPtr);
+    // Reset the eventfd to zero, then fetch the number of Reports on the Event Queue.  Anything
+    // queued after this point will be counted in the next batch.
+    ReadEventFd(perThreadRecPtr);
+    size_t numReports = __atomic_load_n(&perThreadRecPtr->queueCount, __ATOMIC_ACQUIRE);
 
     // Process only those event reports that are already on the queue.  Anything reported by the
     // event handlers will have to wait until next time ProcessEventReports() is called.
     // This approach ensures that event handlers that re-queue events to the event
     // queue don't cause fd events to be starved.
-    for (; numReports > 0; numReports--)
+    size_t i;
+    for (i = 0; i < numReports; i++)
     {
         ProcessOneEventReport(perThreadRecPtr);
     }
+
+    FinishEventReports(perThreadRecPtr, numReports, true);
 }
 
 
@@ -718,7 +953,7 @@ static void PubSubHandlerFunc
  * Queue a function onto a specific thread's Event Queue (could belong to the calling thread or
  * could belong to some other thread).
  *
- * @warning Assumes the mutex is locked and the thread is protected from cancellation.
+ * @warning Assumes the calling thread is protected from cancellation.
  */
 //--------------------------------------------------------------------------------------------------
 static void QueueFunction
@@ -740,11 +975,8 @@ static void QueueFunction
     reportPtr->param1Ptr = param1Ptr;
     reportPtr->param2Ptr = param2Ptr;
 
-    // Queue it to the Event Queue.
-    le_sls_Queue(&perThreadRecPtr->eventQueue, &reportPtr->baseClass.link);
-
-    // Write to the eventfd to notify the Event Loop that there is something on the queue.
-    WriteEventFd(perThreadRecPtr);
+    // Queue it to the Event Queue, notifying the Event Loop that there is something on the queue.
+    QueueReport(perThreadRecPtr, &reportPtr->baseClass);
 }
 
 
@@ -838,7 +1070,12 @@ void event_InitThread
     event_PerThreadRec_t* recPtr = thread_GetEventRecPtr();
 
     // Initialize the various thread-specific lists and queues.
-    recPtr->eventQueue = LE_SLS_LIST_INIT;
+    InitQueue(&recPtr->eventQueue);
+    recPtr->queueCount = 0;
+    recPtr->maxQueueCount = 0;
+    recPtr->reportCount = 0;
+    recPtr->wakeupCount = 0;
+    recPtr->liveEventCount = 0;
     recPtr->handlerList = LE_DLS_LIST_INIT;
     recPtr->fdMonitorList = LE_DLS_LIST_INIT;
 
@@ -848,8 +1085,9 @@ void event_InitThread
     LE_FATAL_IF(recPtr->epollFd < 0, "epoll_create1(0) failed with errno %d (%m).", errno);
 
     // Open an eventfd for this thread.  This will be uses to signal to the epoll fd that there
-    // are Event Reports on the Event Queue.
-    recPtr->eventQueueFd = eventfd(0, 0);
+    // are Event Reports on the Event Queue.  It is only read when epoll says it might be
+    // readable, but it's made non-blocking so that a spurious wake-up can't block the thread.
+    recPtr->eventQueueFd = eventfd(0, EFD_NONBLOCK);
     LE_FATAL_IF(recPtr->eventQueueFd < 0, "eventfd() failed with errno %d (%m).", errno);
 
     // Add the eventfd to the list of file descriptors to wait for using epoll_wait().
@@ -946,7 +1184,7 @@ void event_DestructThread
     fdMon_DestructThread(perThreadRecPtr);
 
     // Discard everything on the Event Queue.
-    while (NULL != (singleLinkPtr = le_sls_Pop(&perThreadRecPtr->eventQueue)))
+    while (NULL != (singleLinkPtr = PopLink(&perThreadRecPtr->eventQueue)))
     {
         Report_t* reportPtr = CONTAINER_OF(singleLinkPtr, Report_t, link);
 
@@ -1221,11 +1459,10 @@ void le_event_Report
         reportObjPtr->handlerRef = handlerPtr->safeRef;
         memset(reportObjPtr->payload, 0, eventPtr->payloadSize);
         memcpy(reportObjPtr->payload, payloadPtr, payloadSize);
-        le_sls_Queue(&perThreadRecPtr->eventQueue, &reportObjPtr->baseClass.link);
 
-        // Increment the eventfd for the handler's thread's Event Queue.
-        // This will wake up the thread and tell it that it has something on its Event Queue.
-        WriteEventFd(perThreadRecPtr);
+        // Push it onto the handler's thread's Event Queue.
+        // This will wake up the thread if it has nothing else on its Event Queue.
+        QueueReport(perThreadRecPtr, &reportObjPtr->baseClass);
 
         linkPtr = le_dls_PeekNext(&eventPtr->handlerList, linkPtr);
     }
@@ -1282,11 +1519,10 @@ void le_event_ReportWithRefCounting
         reportObjPtr->handlerRef = handlerPtr->safeRef;
         reportObjPtr->payload[0] = objectPtr;
         le_mem_AddRef(objectPtr);
-        le_sls_Queue(&perThreadRecPtr->eventQueue, &reportObjPtr->baseClass.link);
 
-        // Increment the eventfd for the handler's thread's Event Queue.
-        // This will wake up the thread and tell it that it has something on its Event Queue.
-        WriteEventFd(perThreadRecPtr);
+        // Push it onto the handler's thread's Event Queue.
+        // This will wake up the thread if it has nothing else on its Event Queue.
+        QueueReport(perThreadRecPtr, &reportObjPtr->baseClass);
 
         linkPtr = le_dls_PeekNext(&eventPtr->handlerList, linkPtr);
     }
@@ -1366,11 +1602,13 @@ void le_event_QueueFunction
 )
 //--------------------------------------------------------------------------------------------------
 {
-    int oldState = Lock();
+    // The Event Queue doesn't use the Mutex, but mustn't be left half-updated by a thread
+    // cancellation.
+    int oldState = DisableCancel();
 
     QueueFunction(thread_GetEventRecPtr(), func, param1Ptr, param2Ptr);
 
-    Unlock(oldState);
+    RestoreCancel(oldState);
 }
 
 
@@ -1389,11 +1627,13 @@ void le_event_QueueFunctionToThread
 )
 //--------------------------------------------------------------------------------------------------
 {
-    int oldState = Lock();
+    // The Event Queue doesn't use the Mutex, but mustn't be left half-updated by a thread
+    // cancellation.
+    int oldState = DisableCancel();
 
     QueueFunction(thread_GetOtherEventRecPtr(thread), func, param1Ptr, param2Ptr);
 
-    Unlock(oldState);
+    RestoreCancel(oldState);
 }
 
 
@@ -1531,13 +1771,12 @@ le_result_t le_event_ServiceLoop
     int epollFd = perThreadRecPtr->epollFd;
     struct epoll_event epollEventList[MAX_EPOLL_EVENTS];
 
-    LE_DEBUG("perThreadRecPtr->liveEventCount is" "%" PRIu64, perThreadRecPtr->liveEventCount);
+    LE_DEBUG("perThreadRecPtr->liveEventCount is %zu", perThreadRecPtr->liveEventCount);
 
     // If there are still live events remaining in the queue, process a single event, then return
     if (perThreadRecPtr->liveEventCount > 0)
     {
-        perThreadRecPtr->liveEventCount--;
-        ProcessOneEventReport(perThreadRecPtr); // This function assumes the mutex is NOT locked.
+        ProcessLiveEventReport(perThreadRecPtr);
         return LE_OK;
     }
 
@@ -1602,16 +1841,17 @@ le_result_t le_event_ServiceLoop
     }
 
     // Read the eventfd to reset it to zero so epoll stops telling us about it until more
-    // are added.
-    perThreadRecPtr->liveEventCount = ReadEventFd(perThreadRecPtr);
+    // are added, then fetch the number of events on the queue.
+    ReadEventFd(perThreadRecPtr);
+    perThreadRecPtr->liveEventCount = __atomic_load_n(&perThreadRecPtr->queueCount,
+                                                      __ATOMIC_ACQUIRE);
 
-    LE_DEBUG("perThreadRecPtr->liveEventCount is" "%" PRIu64, perThreadRecPtr->liveEventCount);
+    LE_DEBUG("perThreadRecPtr->liveEventCount is %zu", perThreadRecPtr->liveEventCount);
 
     // If events were read, process the top event
     if (perThreadRecPtr->liveEventCount > 0)
     {
-        perThreadRecPtr->liveEventCount--;
-        ProcessOneEventReport(perThreadRecPtr);
+        ProcessLiveEventReport(perThreadRecPtr);
         return LE_OK;
     }
     else
@@ -15,6 +15,21 @@
  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
  * See the License for the specific language governing permissions and
  * limitations under the License.
+ *
+ * Two kinds of map are supported:
+ *
+ *  - Chained maps (le_hashmap_Create()) keep a power-of-two array of buckets, each holding a
+ *    list of entries allocated from a per-map pool.  When the load factor exceeds 0.75 the bucket
+ *    array is doubled.  The entries are not all moved at once; instead both bucket arrays are
+ *    kept while a few of the old buckets are moved on each Put or Remove.  An entry whose old
+ *    bucket hasn't been moved yet is still found in the old array, so every lookup only ever
+ *    searches one bucket.  Buckets are not moved while the map's iterator is part way through the
+ *    map, so that iteration neither skips nor repeats entries.
+ *
+ *  - Compact maps (le_hashmap_CreateCompact()) use open addressing with linear probing in a
+ *    single array of slots holding the key, value and hash inline.  Removed entries leave a
+ *    "deleted" marker behind so that they don't break probe sequences, or move entries under the
+ *    iterator.  The table is rebuilt in one go when occupied and deleted slots exceed 0.75 of it.
  */
 
 #include "legato.h"
@@ -35,6 +50,29 @@
     }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of old buckets moved into the new bucket array on each Put or Remove while a chained map
+ * is being resized.  A resize starts when the map is 3/4 full and the next one can't start until
+ * the map is 3/2 full, so moving at least two buckets per operation always finishes in time.
+ */
+//--------------------------------------------------------------------------------------------------
+#define REHASH_BUCKETS_PER_STEP 2
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Markers stored in the key of an unused slot of a compact map.  Only their addresses matter; no
+ * key passed in by the user can ever have one of these addresses.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char EmptySlotMarker;
+static const char DeletedSlotMarker;
+
+#define EMPTY_SLOT_KEY      ((const void*)&EmptySlotMarker)
+#define DELETED_SLOT_KEY    ((const void*)&DeletedSlotMarker)
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Calculate a hash. First this calls the user-supplied hash function.
@@ -79,7 +117,7 @@ static inline size_t HashKey(Hashmap_t* map, const void* key) {
 static Entry_t* CreateEntry
 (
     const void* newKeyPtr,
-    int newHash,
+    size_t newHash,
     const void* newValuePtr,
     le_mem_PoolRef_t poolRef
 )
@@ -124,9 +162,9 @@ static inline size_t CalculateIndex(size_t bucketCount, size_t hash) {
 static inline bool EqualKeys
 (
     const void* keyAPtr,
-    int hashA,
+    size_t hashA,
     const void* keyBPtr,
-    int hashB,
+    size_t hashB,
     le_hashmap_EqualsFunc_t equalsFuncPtr
 )
 {
@@ -139,22 +177,381 @@ static inline bool EqualKeys
     return equalsFuncPtr(keyAPtr, keyBPtr);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks if a map is a compact (open addressing) map.
+ *
+ * @return  Returns true if the map was created by le_hashmap_CreateCompact()
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsCompact(Hashmap_t* map) {
+    return (map->slotsPtr != NULL);
+}
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Create a HashMap
+ * Checks if a slot of a compact map holds an entry.
  *
- * @return  Returns a reference to the map.
+ * @return  Returns true if the slot is neither empty nor deleted
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsSlotInUse(const Slot_t* slotPtr) {
+    return (slotPtr->keyPtr != EMPTY_SLOT_KEY) && (slotPtr->keyPtr != DELETED_SLOT_KEY);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the total number of buckets of a chained map, including the buckets being moved out of
+ * during a resize.  Bucket indices used by the iterator range from zero to this value.
  *
- * @note Terminates the process on failure, so no need to check the return value for errors.
+ * @return  Returns the number of buckets
  */
 //--------------------------------------------------------------------------------------------------
-le_hashmap_Ref_t le_hashmap_Create
+static inline size_t TotalBucketCount(Hashmap_t* map) {
+    return map->oldBucketCount + map->bucketCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a bucket of a chained map.  The buckets being moved out of during a resize come first,
+ * followed by the buckets of the current bucket array.
+ *
+ * @return  Returns a pointer to the bucket's list of entries
+ */
+//--------------------------------------------------------------------------------------------------
+static inline le_dls_List_t* GetBucket(Hashmap_t* map, size_t index) {
+    if (index < map->oldBucketCount) {
+        return &(map->oldBucketsPtr[index]);
+    }
+    return &(map->bucketsPtr[index - map->oldBucketCount]);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the chain length counter of a bucket of a chained map.  See GetBucket().
+ *
+ * @return  Returns a pointer to the bucket's chain length
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t* GetChainLength(Hashmap_t* map, size_t index) {
+    if (index < map->oldBucketCount) {
+        return &(map->oldChainLengthPtr[index]);
+    }
+    return &(map->chainLengthPtr[index - map->oldBucketCount]);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the bucket of a chained map in which an entry with the given hash is stored.  While the
+ * map is being resized this is the old bucket if that hasn't been moved yet.
+ *
+ * @return  Returns the index of the bucket, suitable for GetBucket()
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t FindBucket(Hashmap_t* map, size_t hash) {
+    if (map->oldBucketCount > 0) {
+        size_t oldIndex = CalculateIndex(map->oldBucketCount, hash);
+        if (oldIndex >= map->rehashIndex) {
+            return oldIndex;
+        }
+    }
+    return map->oldBucketCount + CalculateIndex(map->bucketCount, hash);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the entry for a key in a bucket of a chained map.
+ *
+ * @return  Returns a pointer to the entry, or NULL if the key is not in the bucket
+ */
+//--------------------------------------------------------------------------------------------------
+static Entry_t* FindEntry
+(
+    Hashmap_t* map,
+    le_dls_List_t* listHeadPtr,
+    const void* keyPtr,
+    size_t hash
+)
+{
+    le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
+
+    while (theLinkPtr != NULL) {
+        Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
+        if (EqualKeys(currentEntryPtr->keyPtr,
+                      currentEntryPtr->hash,
+                      keyPtr,
+                      hash,
+                      map->equalsFuncPtr))
+        {
+            return currentEntryPtr;
+        }
+        theLinkPtr = le_dls_PeekNext(listHeadPtr, theLinkPtr);
+    }
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocates an array of empty buckets and their chain length counters for a chained map.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AllocBuckets
+(
+    size_t bucketCount,
+    le_dls_List_t** bucketsPtrPtr,
+    size_t** chainLengthPtrPtr
+)
+{
+    le_dls_List_t* bucketsPtr = malloc(bucketCount * sizeof(le_dls_List_t));
+    LE_ASSERT(bucketsPtr);
+    size_t* chainLengthPtr = malloc(bucketCount * sizeof(size_t));
+    LE_ASSERT(chainLengthPtr);
+
+    size_t i;
+    for (i = 0; i < bucketCount; i++)
+    {
+        bucketsPtr[i] = LE_DLS_LIST_INIT;
+        chainLengthPtr[i] = 0;
+    }
+
+    *bucketsPtrPtr = bucketsPtr;
+    *chainLengthPtrPtr = chainLengthPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocates an array of empty slots for a compact map.
+ *
+ * @return  Returns a pointer to the slots
+ */
+//--------------------------------------------------------------------------------------------------
+static Slot_t* AllocSlots
+(
+    size_t slotCount
+)
+{
+    Slot_t* slotsPtr = malloc(slotCount * sizeof(Slot_t));
+    LE_ASSERT(slotsPtr);
+
+    size_t i;
+    for (i = 0; i < slotCount; i++)
+    {
+        slotsPtr[i].keyPtr = EMPTY_SLOT_KEY;
+        slotsPtr[i].valuePtr = NULL;
+        slotsPtr[i].hash = 0;
+    }
+    return slotsPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resets the map's iterator to the start of the map, if it isn't part way through the map.  This
+ * must be done before moving entries around, since a finished iterator still refers to the last
+ * entry it visited.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RewindIdleIterator(Hashmap_t* map) {
+    if (!map->iteratorPtr->isIterating) {
+        map->iteratorPtr->currentIndex = -1;
+        map->iteratorPtr->currentListPtr = NULL;
+        map->iteratorPtr->currentLinkPtr = NULL;
+        map->iteratorPtr->currentEntryPtr = NULL;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Frees the old bucket array of a chained map once all of its buckets have been moved.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FinishResize(Hashmap_t* map) {
+    free(map->oldBucketsPtr);
+    free(map->oldChainLengthPtr);
+    map->oldBucketsPtr = NULL;
+    map->oldChainLengthPtr = NULL;
+    map->oldBucketCount = 0;
+    map->rehashIndex = 0;
+
+    HASHMAP_TRACE(
+        map,
+        "Hashmap %s: Resize to %zu buckets complete",
+        map->nameStr,
+        map->bucketCount
+    );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves up to maxBuckets of the old buckets of a chained map that is being resized into the new
+ * bucket array.  Nothing is moved while the map's iterator is part way through the map.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MoveOldBuckets(Hashmap_t* map, size_t maxBuckets) {
+    if ((map->oldBucketCount == 0) || map->iteratorPtr->isIterating) {
+        return;
+    }
+
+    RewindIdleIterator(map);
+
+    while ((maxBuckets > 0) && (map->rehashIndex < map->oldBucketCount)) {
+        le_dls_List_t* oldListPtr = &(map->oldBucketsPtr[map->rehashIndex]);
+        le_dls_Link_t* theLinkPtr;
+
+        // Keep the entries in the same relative order in their new buckets.
+        while ((theLinkPtr = le_dls_Pop(oldListPtr)) != NULL) {
+            Entry_t* entryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
+            size_t index = CalculateIndex(map->bucketCount, entryPtr->hash);
+
+            le_dls_Queue(&(map->bucketsPtr[index]), theLinkPtr);
+            map->chainLengthPtr[index]++;
+        }
+        map->oldChainLengthPtr[map->rehashIndex] = 0;
+
+        map->rehashIndex++;
+        maxBuckets--;
+    }
+
+    if (map->rehashIndex == map->oldBucketCount) {
+        FinishResize(map);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts doubling the number of buckets of a chained map if its load factor has gone over 0.75.
+ * The entries are moved into the new buckets a few at a time by MoveOldBuckets().
+ */
+//--------------------------------------------------------------------------------------------------
+static void GrowIfNeeded(Hashmap_t* map) {
+    // If a previous resize hasn't finished (which can only happen if the iterator has been held
+    // part way through the map) then the map just gets more collisions until it has.
+    if ((map->oldBucketCount > 0) || (map->size <= (map->bucketCount * 3 / 4))) {
+        return;
+    }
+
+    map->oldBucketsPtr = map->bucketsPtr;
+    map->oldChainLengthPtr = map->chainLengthPtr;
+    map->oldBucketCount = map->bucketCount;
+    map->rehashIndex = 0;
+
+    map->bucketCount *= 2;
+    AllocBuckets(map->bucketCount, &map->bucketsPtr, &map->chainLengthPtr);
+    le_mem_SetNumObjsToForce(map->entryPoolRef, map->bucketCount / 8);
+
+    HASHMAP_TRACE(
+        map,
+        "Hashmap %s: Resizing from %zu to %zu buckets for %zu entries",
+        map->nameStr,
+        map->oldBucketCount,
+        map->bucketCount,
+        map->size
+    );
+
+    MoveOldBuckets(map, REHASH_BUCKETS_PER_STEP);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the slot of a compact map which holds a key, or else the slot in which to put it.
+ *
+ * @return  Returns the index of the slot.  *foundPtr is set to true if the slot holds the key.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t FindSlot
+(
+    Hashmap_t* map,
+    const void* keyPtr,
+    size_t hash,
+    bool* foundPtr
+)
+{
+    size_t index = CalculateIndex(map->bucketCount, hash);
+    size_t firstDeleted = map->bucketCount;
+
+    // There is always at least one empty slot, so this terminates.
+    for (;;) {
+        Slot_t* slotPtr = &(map->slotsPtr[index]);
+
+        if (slotPtr->keyPtr == EMPTY_SLOT_KEY) {
+            *foundPtr = false;
+            return (firstDeleted < map->bucketCount) ? firstDeleted : index;
+        }
+
+        if (slotPtr->keyPtr == DELETED_SLOT_KEY) {
+            if (firstDeleted == map->bucketCount) {
+                firstDeleted = index;
+            }
+        }
+        else if (EqualKeys(slotPtr->keyPtr, slotPtr->hash, keyPtr, hash, map->equalsFuncPtr)) {
+            *foundPtr = true;
+            return index;
+        }
+
+        index = CalculateIndex(map->bucketCount, index + 1);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuilds the slot table of a compact map once occupied and deleted slots exceed 0.75 of it.
+ * The new table is sized to be at most 3/8 full, which drops all deleted markers and doubles the
+ * table if it is full of entries.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RebuildSlotsIfNeeded(Hashmap_t* map) {
+    if (map->usedSlotCount <= (map->bucketCount * 3 / 4)) {
+        return;
+    }
+
+    size_t oldSlotCount = map->bucketCount;
+    Slot_t* oldSlotsPtr = map->slotsPtr;
+
+    size_t newSlotCount = 4;
+    while ((newSlotCount * 3 / 8) < map->size) {
+        newSlotCount <<= 1;
+    }
+
+    map->slotsPtr = AllocSlots(newSlotCount);
+    map->bucketCount = newSlotCount;
+    map->usedSlotCount = map->size;
+
+    size_t i;
+    for (i = 0; i < oldSlotCount; i++) {
+        if (IsSlotInUse(&oldSlotsPtr[i])) {
+            size_t index = CalculateIndex(newSlotCount, oldSlotsPtr[i].hash);
+            while (map->slotsPtr[index].keyPtr != EMPTY_SLOT_KEY) {
+                index = CalculateIndex(newSlotCount, index + 1);
+            }
+            map->slotsPtr[index] = oldSlotsPtr[i];
+        }
+    }
+    free(oldSlotsPtr);
+
+    HASHMAP_TRACE(
+        map,
+        "Hashmap %s: Rebuilt slot table from %zu to %zu slots for %zu entries",
+        map->nameStr,
+        oldSlotCount,
+        newSlotCount,
+        map->size
+    );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a map of either kind.
+ *
+ * @return  Returns a reference to the map.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t CreateMap
 (
     const char*                nameStr,          ///< [in] Name of the HashMap
     size_t                     capacity,         ///< [in] Expected capacity of the map
     le_hashmap_HashFunc_t      hashFunc,         ///< [in] The hash function
-    le_hashmap_EqualsFunc_t    equalsFunc        ///< [in] The equality function
+    le_hashmap_EqualsFunc_t    equalsFunc,       ///< [in] The equality function
+    bool                       isCompact         ///< [in] Use open addressing?
 )
 {
     LE_ASSERT(hashFunc);
@@ -180,33 +577,42 @@ le_hashmap_Ref_t le_hashmap_Create
         mapRef->bucketCount <<= 1;
     }
 
-    /**
-     * The memory pool is required to store entries. We set a default size and expansion
-     * size to reduce the number of forced allocations.
-     * Initial entries for each hash are actually doubly linked list objects which store
-     * where the starting entry is in the pool.
-     */
-    char poolName[LIMIT_MAX_MEM_POOL_NAME_BYTES] = "hashMap_";
-    le_utf8_Append(poolName, nameStr, sizeof(poolName), NULL);
-    mapRef->entryPoolRef = le_mem_ExpandPool(le_mem_CreatePool(poolName,
-                                                               sizeof(Entry_t)),
-                                                               mapRef->bucketCount / 2);
-    le_mem_SetNumObjsToForce(mapRef->entryPoolRef, mapRef->bucketCount / 8);
-
-    mapRef->bucketsPtr = malloc(mapRef->bucketCount * sizeof(le_dls_List_t));
-    LE_ASSERT(mapRef->bucketsPtr);
-    mapRef->chainLengthPtr = malloc(mapRef->bucketCount * sizeof(size_t));
-    LE_ASSERT(mapRef->chainLengthPtr);
-    mapRef->iteratorPtr = malloc(sizeof(HashmapIt_t));
-    LE_ASSERT(mapRef->iteratorPtr);
+    mapRef->oldBucketsPtr = NULL;
+    mapRef->oldChainLengthPtr = NULL;
+    mapRef->oldBucketCount = 0;
+    mapRef->rehashIndex = 0;
+    mapRef->usedSlotCount = 0;
 
-    uint32_t i = 0;
-    for (i=0; i<mapRef->bucketCount; i++)
+    if (isCompact)
+    {
+        // Entries are stored in the slots themselves, so there is no entry pool.
+        mapRef->entryPoolRef = NULL;
+        mapRef->bucketsPtr = NULL;
+        mapRef->chainLengthPtr = NULL;
+        mapRef->slotsPtr = AllocSlots(mapRef->bucketCount);
+    }
+    else
     {
-        mapRef->bucketsPtr[i] = LE_DLS_LIST_INIT;
-        mapRef->chainLengthPtr[i] = 0;
+        /**
+         * The memory pool is required to store entries. We set a default size and expansion
+         * size to reduce the number of forced allocations.
+         * Initial entries for each hash are actually doubly linked list objects which store
+         * where the starting entry is in the pool.
+         */
+        char poolName[LIMIT_MAX_MEM_POOL_NAME_BYTES] = "hashMap_";
+        le_utf8_Append(poolName, nameStr, sizeof(poolName), NULL);
+        mapRef->entryPoolRef = le_mem_ExpandPool(le_mem_CreatePool(poolName,
+                                                                   sizeof(Entry_t)),
+                                                                   mapRef->bucketCount / 2);
+        le_mem_SetNumObjsToForce(mapRef->entryPoolRef, mapRef->bucketCount / 8);
+
+        AllocBuckets(mapRef->bucketCount, &mapRef->bucketsPtr, &mapRef->chainLengthPtr);
+        mapRef->slotsPtr = NULL;
     }
 
+    mapRef->iteratorPtr = malloc(sizeof(HashmapIt_t));
+    LE_ASSERT(mapRef->iteratorPtr);
+
     mapRef->size = 0;
 
     mapRef->hashFuncPtr = hashFunc;
@@ -215,11 +621,55 @@ le_hashmap_Ref_t le_hashmap_Create
 
     memset(mapRef->iteratorPtr, 0, sizeof(HashmapIt_t));
     mapRef->iteratorPtr->theMapPtr = mapRef;
+    mapRef->iteratorPtr->currentIndex = -1;
     mapRef->iteratorPtr->isValueValid = true;
+    mapRef->iteratorPtr->isIterating = false;
 
     return mapRef;
 }
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a HashMap
+ *
+ * @return  Returns a reference to the map.
+ *
+ * @note Terminates the process on failure, so no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_hashmap_Ref_t le_hashmap_Create
+(
+    const char*                nameStr,          ///< [in] Name of the HashMap
+    size_t                     capacity,         ///< [in] Expected capacity of the map
+    le_hashmap_HashFunc_t      hashFunc,         ///< [in] The hash function
+    le_hashmap_EqualsFunc_t    equalsFunc        ///< [in] The equality function
+)
+{
+    return CreateMap(nameStr, capacity, hashFunc, equalsFunc, false);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a compact HashMap, which uses open addressing and stores keys, values and hashes inline
+ * in a single table instead of in separately allocated entries.
+ *
+ * @return  Returns a reference to the map.
+ *
+ * @note Terminates the process on failure, so no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_hashmap_Ref_t le_hashmap_CreateCompact
+(
+    const char*                nameStr,          ///< [in] Name of the HashMap
+    size_t                     capacity,         ///< [in] Expected capacity of the map
+    le_hashmap_HashFunc_t      hashFunc,         ///< [in] The hash function
+    le_hashmap_EqualsFunc_t    equalsFunc        ///< [in] The equality function
+)
+{
+    return CreateMap(nameStr, capacity, hashFunc, equalsFunc, true);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a key-value pair to a HashMap. If the key already exists in the map then the previous value
@@ -238,97 +688,194 @@ void* le_hashmap_Put
 )
 {
     size_t hash = HashKey(mapRef, keyPtr);
-    size_t index = CalculateIndex(mapRef->bucketCount, hash);
 
-    HASHMAP_TRACE(
-        mapRef,
-        "Hashmap %s: Generated index of %zu for hash %u",
-        mapRef->nameStr,
-        index,
-        (int)hash
-    );
+    if (IsCompact(mapRef))
+    {
+        bool found;
+        size_t index = FindSlot(mapRef, keyPtr, hash, &found);
+        Slot_t* slotPtr = &(mapRef->slotsPtr[index]);
 
-    le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[index]);
+        if (found)
+        {
+            const void* oldValue = slotPtr->valuePtr;
+            slotPtr->valuePtr = valuePtr;
 
-    if (le_dls_NumLinks(listHeadPtr) == 0)
-    {
-        Entry_t* newEntryPtr = CreateEntry(keyPtr, hash, valuePtr, mapRef->entryPoolRef);
-        LE_ASSERT(newEntryPtr);
+            HASHMAP_TRACE(
+                mapRef,
+                "Hashmap %s: Replaced entry in slot %zu. Total map size now %zu",
+                mapRef->nameStr,
+                index,
+                mapRef->size
+            );
 
-        le_dls_Stack(listHeadPtr, &(newEntryPtr->entryListLink));
+            return (void *)oldValue;
+        }
+
+        if (slotPtr->keyPtr == EMPTY_SLOT_KEY)
+        {
+            mapRef->usedSlotCount++;
+        }
+        slotPtr->keyPtr = keyPtr;
+        slotPtr->valuePtr = valuePtr;
+        slotPtr->hash = hash;
         mapRef->size++;
 
         HASHMAP_TRACE(
             mapRef,
-            "Hashmap %s: Added first entry to bucket. Total map size now %zu",
+            "Hashmap %s: Added entry to slot %zu. Total map size now %zu",
             mapRef->nameStr,
+            index,
             mapRef->size
         );
 
-        mapRef->chainLengthPtr[index]++;
+        RebuildSlotsIfNeeded(mapRef);
 
         return NULL;
     }
-    else
+
+    MoveOldBuckets(mapRef, REHASH_BUCKETS_PER_STEP);
+
+    size_t index = FindBucket(mapRef, hash);
+
+    HASHMAP_TRACE(
+        mapRef,
+        "Hashmap %s: Generated index of %zu for hash %zu",
+        mapRef->nameStr,
+        index,
+        hash
+    );
+
+    le_dls_List_t* listHeadPtr = GetBucket(mapRef, index);
+    Entry_t* currentEntryPtr = FindEntry(mapRef, listHeadPtr, keyPtr, hash);
+
+    // Replace existing value if the keys match.
+    if (currentEntryPtr != NULL)
     {
-        le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
+        const void* oldValue = currentEntryPtr->valuePtr;
+        currentEntryPtr->valuePtr = valuePtr;
 
-        while (true) {
-            Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
+        HASHMAP_TRACE(
+            mapRef,
+            "Hashmap %s: Replaced entry in bucket. Total map size now %zu",
+            mapRef->nameStr,
+            mapRef->size
+        );
 
-            // Replace existing value if the keys match.
-            if (EqualKeys(currentEntryPtr->keyPtr,
-                          currentEntryPtr->hash,
-                          keyPtr,
-                          hash,
-                          mapRef->equalsFuncPtr)
-                          )
-            {
-                const void* oldValue = currentEntryPtr->valuePtr;
-                currentEntryPtr->valuePtr = valuePtr;
+        return (void *)oldValue;
+    }
 
-                HASHMAP_TRACE(
-                    mapRef,
-                    "Hashmap %s: Replaced entry in bucket. Total map size now %zu",
-                    mapRef->nameStr,
-                    mapRef->size
-                );
+    // Otherwise add a new entry at the tail of the bucket.
+    Entry_t* newEntryPtr = CreateEntry(keyPtr, hash, valuePtr, mapRef->entryPoolRef);
+    LE_ASSERT(newEntryPtr);
 
-                return (void *)oldValue;
-            }
+    le_dls_Queue(listHeadPtr, &(newEntryPtr->entryListLink));
+    mapRef->size++;
+    (*GetChainLength(mapRef, index))++;
+
+    HASHMAP_TRACE(
+        mapRef,
+        "Hashmap %s: Added entry to bucket. Bucket now contains %zu entries, map size now %zu",
+        mapRef->nameStr,
+        *GetChainLength(mapRef, index),
+        mapRef->size
+    );
 
-            // Add a new entry if we are at the tail
-            if (le_dls_PeekNext(listHeadPtr, theLinkPtr) == NULL) {
-                Entry_t* newEntryPtr = CreateEntry(keyPtr, hash, valuePtr, mapRef->entryPoolRef);
-                LE_ASSERT(newEntryPtr);
+    GrowIfNeeded(mapRef);
 
-                le_dls_Queue(listHeadPtr, &(newEntryPtr->entryListLink));
-                mapRef->size++;
+    return NULL;
+}
 
-                HASHMAP_TRACE(
-                    mapRef,
-                    "Hashmap %s: Added entry to bucket at tail. Map size now %zu",
-                    mapRef->nameStr,
-                    mapRef->size
-                );
+//--------------------------------------------------------------------------------------------------
+/**
+ * Looks up a key in a map of either kind.
+ *
+ * @return  Returns true if found, in which case the stored key and value are returned through the
+ *          (optional) output pointers
+ */
+//--------------------------------------------------------------------------------------------------
+static bool LookUp
+(
+    Hashmap_t* map,
+    const void* keyPtr,
+    const void** storedKeyPtrPtr,
+    const void** valuePtrPtr
+)
+{
+    size_t hash = HashKey(map, keyPtr);
+    const void* storedKeyPtr = NULL;
+    const void* valuePtr = NULL;
+    bool found;
 
-                mapRef->chainLengthPtr[index]++;
+    if (IsCompact(map))
+    {
+        size_t index = FindSlot(map, keyPtr, hash, &found);
+        HASHMAP_TRACE(
+            map,
+            "Hashmap %s: Probed to slot %zu for hash %zu",
+            map->nameStr,
+            index,
+            hash
+        );
 
-                HASHMAP_TRACE(
-                    mapRef,
-                    "Hashmap %s: Bucket now contains %zu entries (%zu)",
-                    mapRef->nameStr,
-                    le_dls_NumLinks(listHeadPtr),
-                    mapRef->chainLengthPtr[index]
-                );
+        if (found)
+        {
+            storedKeyPtr = map->slotsPtr[index].keyPtr;
+            valuePtr = map->slotsPtr[index].valuePtr;
+        }
+    }
+    else
+    {
+        size_t index = FindBucket(map, hash);
+        HASHMAP_TRACE(
+            map,
+            "Hashmap %s: Generated index of %zu for hash %zu",
+            map->nameStr,
+            index,
+            hash
+        );
 
-                return NULL;
-            }
+        le_dls_List_t* listHeadPtr = GetBucket(map, index);
+        HASHMAP_TRACE(
+            map,
+            "Hashmap %s: Looked up list contains %zu links",
+            map->nameStr,
+            *GetChainLength(map, index)
+        );
 
-            // Move to next entry.
-            theLinkPtr = le_dls_PeekNext(listHeadPtr, theLinkPtr);
+        Entry_t* entryPtr = FindEntry(map, listHeadPtr, keyPtr, hash);
+        found = (entryPtr != NULL);
+        if (found)
+        {
+            storedKeyPtr = entryPtr->keyPtr;
+            valuePtr = entryPtr->valuePtr;
         }
     }
+
+    if (!found)
+    {
+        HASHMAP_TRACE(
+            map,
+            "Hashmap %s: Key not found",
+            map->nameStr
+        );
+        return false;
+    }
+
+    HASHMAP_TRACE(
+        map,
+        "Hashmap %s: Key found",
+        map->nameStr
+    );
+
+    if (storedKeyPtrPtr != NULL)
+    {
+        *storedKeyPtrPtr = storedKeyPtr;
+    }
+    if (valuePtrPtr != NULL)
+    {
+        *valuePtrPtr = valuePtr;
+    }
+    return true;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -346,51 +893,11 @@ void* le_hashmap_Get
     const void* keyPtr         ///< [in] Pointer to the key to be retrieved
 )
 {
-    size_t hash = HashKey(mapRef, keyPtr);
-    size_t index = CalculateIndex(mapRef->bucketCount, hash);
-    HASHMAP_TRACE(
-        mapRef,
-        "Hashmap %s: Generated index of %zu for hash %zu",
-        mapRef->nameStr,
-        index,
-        hash
-    );
-
-    le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[index]);
-    HASHMAP_TRACE(
-        mapRef,
-        "Hashmap %s: Looked up list contains %zu links",
-        mapRef->nameStr,
-        le_dls_NumLinks(listHeadPtr)
-    );
-
-    le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
+    const void* valuePtr = NULL;
 
-    while (theLinkPtr != NULL) {
-        Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
-        if (EqualKeys(currentEntryPtr->keyPtr,
-                          currentEntryPtr->hash,
-                          keyPtr,
-                          hash,
-                          mapRef->equalsFuncPtr)
-                          )
-        {
-            HASHMAP_TRACE(
-                mapRef,
-                "Hashmap %s: Returning found value for key",
-                mapRef->nameStr
-            );
-            return (void*)(currentEntryPtr->valuePtr);
-        }
-        theLinkPtr = le_dls_PeekNext(listHeadPtr, theLinkPtr);
-    }
+    LookUp(mapRef, keyPtr, NULL, &valuePtr);
 
-    HASHMAP_TRACE(
-        mapRef,
-        "Hashmap %s: Key not found",
-        mapRef->nameStr
-    );
-    return NULL;
+    return (void*)valuePtr;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -405,54 +912,14 @@ void* le_hashmap_Get
 void* le_hashmap_GetStoredKey
 (
     le_hashmap_Ref_t mapRef,   ///< [in] Reference to the map.
-    const void* keyPtr         ///< [in] Pointer to the key to be retrieved.
-)
-{
-    size_t hash = HashKey(mapRef, keyPtr);
-    size_t index = CalculateIndex(mapRef->bucketCount, hash);
-    HASHMAP_TRACE(
-        mapRef,
-        "Hashmap %s: Generated index of %zu for hash %zu",
-        mapRef->nameStr,
-        index,
-        hash
-    );
-
-    le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[index]);
-    HASHMAP_TRACE(
-        mapRef,
-        "Hashmap %s: Looked up list contains %zu links",
-        mapRef->nameStr,
-        le_dls_NumLinks(listHeadPtr)
-    );
-
-    le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
+    const void* keyPtr         ///< [in] Pointer to the key to be retrieved.
+)
+{
+    const void* storedKeyPtr = NULL;
 
-    while (theLinkPtr != NULL) {
-        Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
-        if (EqualKeys(currentEntryPtr->keyPtr,
-                          currentEntryPtr->hash,
-                          keyPtr,
-                          hash,
-                          mapRef->equalsFuncPtr)
-                          )
-        {
-            HASHMAP_TRACE(
-                mapRef,
-                "Hashmap %s: Returning original key",
-                mapRef->nameStr
-            );
-            return (void*)(currentEntryPtr->keyPtr);
-        }
-        theLinkPtr = le_dls_PeekNext(listHeadPtr, theLinkPtr);
-    }
+    LookUp(mapRef, keyPtr, &storedKeyPtr, NULL);
 
-    HASHMAP_TRACE(
-        mapRef,
-        "Hashmap %s: Key not found",
-        mapRef->nameStr
-    );
-    return NULL;
+    return (void*)storedKeyPtr;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -473,50 +940,96 @@ void* le_hashmap_Remove
    const void* keyPtr       ///< [in] Pointer to the key to be removed
 )
 {
-    int hash = HashKey(mapRef, keyPtr);
-    size_t index = CalculateIndex(mapRef->bucketCount, hash);
-
-    HASHMAP_TRACE(
-        mapRef,
-        "Hashmap %s: Generated index of %zu for hash %u",
-        mapRef->nameStr,
-        index,
-        hash
-    );
+    size_t hash = HashKey(mapRef, keyPtr);
 
-    le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[index]);
-    le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
+    if (IsCompact(mapRef))
+    {
+        bool found;
+        size_t index = FindSlot(mapRef, keyPtr, hash, &found);
 
-    while (theLinkPtr != NULL) {
-        Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
-        if (EqualKeys(currentEntryPtr->keyPtr,
-                          currentEntryPtr->hash,
-                          keyPtr,
-                          hash,
-                          mapRef->equalsFuncPtr)
-                          )
+        if (found)
         {
-            if (mapRef->iteratorPtr->currentLinkPtr == theLinkPtr)
+            Slot_t* slotPtr = &(mapRef->slotsPtr[index]);
+
+            if (mapRef->iteratorPtr->currentIndex == (int32_t)index)
             {
                 le_hashmap_PrevNode(mapRef->iteratorPtr);
                 mapRef->iteratorPtr->isValueValid = false;
             }
 
-            void* value = (void*)(currentEntryPtr->valuePtr);
-            le_dls_Remove(listHeadPtr, theLinkPtr);
-            le_mem_Release( currentEntryPtr );
+            void* value = (void*)(slotPtr->valuePtr);
             mapRef->size--;
-            mapRef->chainLengthPtr[index]--;
+
+            // If the next slot is empty then no probe sequence passes through this one, so it can
+            // be emptied instead of being marked deleted.
+            if (mapRef->slotsPtr[CalculateIndex(mapRef->bucketCount, index + 1)].keyPtr ==
+                EMPTY_SLOT_KEY)
+            {
+                slotPtr->keyPtr = EMPTY_SLOT_KEY;
+                mapRef->usedSlotCount--;
+            }
+            else
+            {
+                slotPtr->keyPtr = DELETED_SLOT_KEY;
+            }
+            slotPtr->valuePtr = NULL;
 
             HASHMAP_TRACE(
                 mapRef,
-                "Hashmap %s: Removing key from map",
-                mapRef->nameStr
+                "Hashmap %s: Removing key from slot %zu",
+                mapRef->nameStr,
+                index
             );
 
             return value;
         }
-        theLinkPtr = le_dls_PeekNext(listHeadPtr, theLinkPtr);
+
+        HASHMAP_TRACE(
+            mapRef,
+            "Hashmap %s: Key not found",
+            mapRef->nameStr
+        );
+        return NULL;
+    }
+
+    MoveOldBuckets(mapRef, REHASH_BUCKETS_PER_STEP);
+
+    size_t index = FindBucket(mapRef, hash);
+
+    HASHMAP_TRACE(
+        mapRef,
+        "Hashmap %s: Generated index of %zu for hash %zu",
+        mapRef->nameStr,
+        index,
+        hash
+    );
+
+    le_dls_List_t* listHeadPtr = GetBucket(mapRef, index);
+    Entry_t* currentEntryPtr = FindEntry(mapRef, listHeadPtr, keyPtr, hash);
+
+    if (currentEntryPtr != NULL)
+    {
+        le_dls_Link_t* theLinkPtr = &(currentEntryPtr->entryListLink);
+
+        if (mapRef->iteratorPtr->currentLinkPtr == theLinkPtr)
+        {
+            le_hashmap_PrevNode(mapRef->iteratorPtr);
+            mapRef->iteratorPtr->isValueValid = false;
+        }
+
+        void* value = (void*)(currentEntryPtr->valuePtr);
+        le_dls_Remove(listHeadPtr, theLinkPtr);
+        le_mem_Release( currentEntryPtr );
+        mapRef->size--;
+        (*GetChainLength(mapRef, index))--;
+
+        HASHMAP_TRACE(
+            mapRef,
+            "Hashmap %s: Removing key from map",
+            mapRef->nameStr
+        );
+
+        return value;
     }
 
     HASHMAP_TRACE(
@@ -577,47 +1090,7 @@ bool le_hashmap_ContainsKey
     const void* keyPtr        ///< [in] Pointer to the key to be searched for
 )
 {
-    int hash = HashKey(mapRef, keyPtr);
-    size_t index = CalculateIndex(mapRef->bucketCount, hash);
-
-    HASHMAP_TRACE(
-        mapRef,
-        "Hashmap %s: Generated index of %zu for hash %u",
-        mapRef->nameStr,
-        index,
-        hash
-    );
-
-    le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[index]);
-    le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
-
-    while (theLinkPtr != NULL) {
-        Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
-        if (EqualKeys(currentEntryPtr->keyPtr,
-                          currentEntryPtr->hash,
-                          keyPtr,
-                          hash,
-                          mapRef->equalsFuncPtr)
-                          )
-        {
-            HASHMAP_TRACE(
-                mapRef,
-                "Hashmap %s: Key found",
-                mapRef->nameStr
-            );
-
-            return true;
-        }
-        theLinkPtr = le_dls_PeekNext(listHeadPtr, theLinkPtr);
-    }
-
-    HASHMAP_TRACE(
-       mapRef,
-       "Hashmap %s: Key not found",
-       mapRef->nameStr
-    );
-
-    return false;
+    return LookUp(mapRef, keyPtr, NULL, NULL);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -636,25 +1109,44 @@ void le_hashmap_RemoveAll
 {
     // Reset the iterator
     mapRef->iteratorPtr->isValueValid = false;
+    mapRef->iteratorPtr->isIterating = false;
     mapRef->iteratorPtr->currentIndex = -1;
     mapRef->iteratorPtr->currentListPtr = NULL;
     mapRef->iteratorPtr->currentLinkPtr = NULL;
     mapRef->iteratorPtr->currentEntryPtr = NULL;
 
-    uint32_t i;
-    for (i = 0; i < mapRef->bucketCount; i++) {
-        le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[i]);
-        le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
+    size_t i;
 
-        while (theLinkPtr != NULL) {
-            Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
-            le_dls_Link_t* linkPtrToRemove = theLinkPtr;
-            theLinkPtr = le_dls_PeekNext(listHeadPtr, theLinkPtr);
-            le_dls_Remove(listHeadPtr, linkPtrToRemove);
-            le_mem_Release( currentEntryPtr );
+    if (IsCompact(mapRef))
+    {
+        for (i = 0; i < mapRef->bucketCount; i++) {
+            mapRef->slotsPtr[i].keyPtr = EMPTY_SLOT_KEY;
+            mapRef->slotsPtr[i].valuePtr = NULL;
+        }
+        mapRef->usedSlotCount = 0;
+    }
+    else
+    {
+        for (i = 0; i < TotalBucketCount(mapRef); i++) {
+            le_dls_List_t* listHeadPtr = GetBucket(mapRef, i);
+            le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
+
+            while (theLinkPtr != NULL) {
+                Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
+                le_dls_Link_t* linkPtrToRemove = theLinkPtr;
+                theLinkPtr = le_dls_PeekNext(listHeadPtr, theLinkPtr);
+                le_dls_Remove(listHeadPtr, linkPtrToRemove);
+                le_mem_Release( currentEntryPtr );
+            }
+            *listHeadPtr = LE_DLS_LIST_INIT;
+            *GetChainLength(mapRef, i) = 0;
+        }
+
+        // Nothing is left to move if the map was being resized.
+        if (mapRef->oldBucketCount > 0)
+        {
+            FinishResize(mapRef);
         }
-        mapRef->bucketsPtr[i] = LE_DLS_LIST_INIT;
-        mapRef->chainLengthPtr[i] = 0;
     }
     mapRef->size=0;
 
@@ -682,9 +1174,31 @@ bool le_hashmap_ForEach
     void* context                            ///< [in] Pointer to a context to be supplied to the callback
 )
 {
-    uint32_t i;
-    for (i = 0; i < mapRef->bucketCount; i++) {
-        le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[i]);
+    size_t i;
+
+    if (IsCompact(mapRef))
+    {
+        for (i = 0; i < mapRef->bucketCount; i++) {
+            Slot_t* slotPtr = &(mapRef->slotsPtr[i]);
+
+            if (IsSlotInUse(slotPtr) &&
+                !forEachFn(slotPtr->keyPtr, slotPtr->valuePtr, context))
+            {
+                // Check to see if this is the last element, and return false if not.
+                size_t j;
+                for (j = i; j < mapRef->bucketCount; ++j)
+                {
+                    if (IsSlotInUse(&(mapRef->slotsPtr[j]))) { return false; }
+                }
+                return true;   // Despite stopping early, all elements have been examined.
+            }
+        }
+
+        return true;
+    }
+
+    for (i = 0; i < TotalBucketCount(mapRef); i++) {
+        le_dls_List_t* listHeadPtr = GetBucket(mapRef, i);
         le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
 
         while (theLinkPtr != NULL) {
@@ -692,11 +1206,10 @@ bool le_hashmap_ForEach
             if (!forEachFn(currentEntryPtr->keyPtr, currentEntryPtr->valuePtr, context)) {
                 // Check to see if this is the last element, and return false if not.
                 if (le_dls_PeekNext(listHeadPtr, theLinkPtr) != NULL) { return false; }
-                uint32_t j;
-                for (j = i; j < mapRef->bucketCount; ++j)
+                size_t j;
+                for (j = i; j < TotalBucketCount(mapRef); ++j)
                 {
-                    le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[j]);
-                    if (le_dls_Peek(listHeadPtr)) { return false; }
+                    if (le_dls_Peek(GetBucket(mapRef, j))) { return false; }
                 }
                 return true;   // Despite stopping early, all elements have been examined.
             }
@@ -726,9 +1239,17 @@ le_hashmap_It_Ref_t le_hashmap_GetIterator
 {
     // Set the counter to -1 so that we know the iterator is at the start
     mapRef->iteratorPtr->currentIndex = -1;
+    mapRef->iteratorPtr->isIterating = false;
     // Mark the iterator as valid
     mapRef->iteratorPtr->isValueValid = true;
 
+    // The whole map is about to be walked anyway, so finish any resize in progress now rather than
+    // holding it up until the iteration is over.
+    if (!IsCompact(mapRef))
+    {
+        MoveOldBuckets(mapRef, mapRef->oldBucketCount);
+    }
+
     return mapRef->iteratorPtr;
 }
 
@@ -747,12 +1268,34 @@ le_result_t le_hashmap_NextNode
     le_hashmap_It_Ref_t iteratorRef        ///< [IN] Reference to the iterator
 )
 {
+    Hashmap_t* mapPtr = iteratorRef->theMapPtr;
+
     iteratorRef->isValueValid = true;
 
     // If the map is empty immediately return LE_NOT_FOUND
-    if (le_hashmap_isEmpty(iteratorRef->theMapPtr))
+    if (le_hashmap_isEmpty(mapPtr))
+    {
+        iteratorRef->isValueValid = false;
+        iteratorRef->isIterating = false;
+        return LE_NOT_FOUND;
+    }
+
+    if (IsCompact(mapPtr))
     {
+        for (
+               iteratorRef->currentIndex = iteratorRef->currentIndex + 1;
+               iteratorRef->currentIndex < (int32_t)mapPtr->bucketCount;
+               iteratorRef->currentIndex++ )
+        {
+            if (IsSlotInUse(&(mapPtr->slotsPtr[iteratorRef->currentIndex])))
+            {
+                iteratorRef->isIterating = true;
+                return LE_OK;
+            }
+        }
+
         iteratorRef->isValueValid = false;
+        iteratorRef->isIterating = false;
         return LE_NOT_FOUND;
     }
 
@@ -769,10 +1312,10 @@ le_result_t le_hashmap_NextNode
         // Find the next list head
         for (
                iteratorRef->currentIndex = iteratorRef->currentIndex + 1;
-               iteratorRef->currentIndex < iteratorRef->theMapPtr->bucketCount;
+               iteratorRef->currentIndex < (int32_t)TotalBucketCount(mapPtr);
                iteratorRef->currentIndex++ )
         {
-            le_dls_List_t* listHeadPtr = &(iteratorRef->theMapPtr->bucketsPtr[iteratorRef->currentIndex]);
+            le_dls_List_t* listHeadPtr = GetBucket(mapPtr, iteratorRef->currentIndex);
             theLinkPtr = le_dls_Peek(listHeadPtr);
 
             if (NULL != theLinkPtr)
@@ -781,9 +1324,10 @@ le_result_t le_hashmap_NextNode
                 iteratorRef->currentLinkPtr = theLinkPtr;
                 iteratorRef->currentEntryPtr = currentEntryPtr;
                 iteratorRef->currentListPtr = listHeadPtr;
+                iteratorRef->isIterating = true;
 
                 HASHMAP_TRACE(
-                    iteratorRef->theMapPtr,
+                    mapPtr,
                     "Found index head match, index is %d",
                     iteratorRef->currentIndex
                 );
@@ -796,10 +1340,11 @@ le_result_t le_hashmap_NextNode
         Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
         iteratorRef->currentLinkPtr = theLinkPtr;
         iteratorRef->currentEntryPtr = currentEntryPtr;
+        iteratorRef->isIterating = true;
         // No change to the current list head pointer as we're in the same list
 
         HASHMAP_TRACE(
-            iteratorRef->theMapPtr,
+            mapPtr,
             "Found index list match, index is %d",
             iteratorRef->currentIndex
         );
@@ -809,6 +1354,7 @@ le_result_t le_hashmap_NextNode
 
     // At the end without finding another entry, need to invalidate the iterator
     iteratorRef->isValueValid = false;
+    iteratorRef->isIterating = false;
     return LE_NOT_FOUND;
 }
 
@@ -827,16 +1373,38 @@ le_result_t le_hashmap_PrevNode
     le_hashmap_It_Ref_t iteratorRef        ///< [IN] Reference to the iterator
 )
 {
+    Hashmap_t* mapPtr = iteratorRef->theMapPtr;
+
     iteratorRef->isValueValid = true;
 
     // If the map is empty or if we're already at the beginning of the table, immediately return
     // LE_NOT_FOUND.
     if (
-         (le_hashmap_isEmpty(iteratorRef->theMapPtr)) ||
+         (le_hashmap_isEmpty(mapPtr)) ||
          (iteratorRef->currentIndex == -1)
        )
     {
         iteratorRef->isValueValid = false;
+        iteratorRef->isIterating = false;
+        return LE_NOT_FOUND;
+    }
+
+    if (IsCompact(mapPtr))
+    {
+        for (
+               iteratorRef->currentIndex = iteratorRef->currentIndex - 1;
+               iteratorRef->currentIndex >= 0;
+               iteratorRef->currentIndex-- )
+        {
+            if (IsSlotInUse(&(mapPtr->slotsPtr[iteratorRef->currentIndex])))
+            {
+                iteratorRef->isIterating = true;
+                return LE_OK;
+            }
+        }
+
+        iteratorRef->isValueValid = false;
+        iteratorRef->isIterating = false;
         return LE_NOT_FOUND;
     }
 
@@ -851,7 +1419,7 @@ le_result_t le_hashmap_PrevNode
                iteratorRef->currentIndex >= 0;
                iteratorRef->currentIndex-- )
         {
-            le_dls_List_t* listHeadPtr = &(iteratorRef->theMapPtr->bucketsPtr[iteratorRef->currentIndex]);
+            le_dls_List_t* listHeadPtr = GetBucket(mapPtr, iteratorRef->currentIndex);
             theLinkPtr = le_dls_PeekTail(listHeadPtr);
 
             if (NULL != theLinkPtr)
@@ -860,9 +1428,10 @@ le_result_t le_hashmap_PrevNode
                 iteratorRef->currentLinkPtr = theLinkPtr;
                 iteratorRef->currentEntryPtr = currentEntryPtr;
                 iteratorRef->currentListPtr = listHeadPtr;
+                iteratorRef->isIterating = true;
 
                 HASHMAP_TRACE(
-                    iteratorRef->theMapPtr,
+                    mapPtr,
                     "Found index head match, index is %d",
                     iteratorRef->currentIndex
                 );
@@ -875,10 +1444,11 @@ le_result_t le_hashmap_PrevNode
         Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
         iteratorRef->currentLinkPtr = theLinkPtr;
         iteratorRef->currentEntryPtr = currentEntryPtr;
+        iteratorRef->isIterating = true;
         // No change to the current list head pointer as we're in the same list
 
         HASHMAP_TRACE(
-            iteratorRef->theMapPtr,
+            mapPtr,
             "Found index list match, index is %d",
             iteratorRef->currentIndex
         );
@@ -888,6 +1458,7 @@ le_result_t le_hashmap_PrevNode
 
     // At the beginning, without finding another entry, need to invalidate the iterator.
     iteratorRef->isValueValid = false;
+    iteratorRef->isIterating = false;
     return LE_NOT_FOUND;
 }
 
@@ -907,6 +1478,11 @@ const void* le_hashmap_GetKey
 {
     if (!iteratorRef->isValueValid || (iteratorRef->currentIndex == -1)) return NULL;
 
+    if (IsCompact(iteratorRef->theMapPtr))
+    {
+        return iteratorRef->theMapPtr->slotsPtr[iteratorRef->currentIndex].keyPtr;
+    }
+
     return iteratorRef->currentEntryPtr->keyPtr;
 }
 
@@ -926,9 +1502,66 @@ void* le_hashmap_GetValue
     if (!iteratorRef->isValueValid || (iteratorRef->currentIndex == -1)) return NULL;
 
     // Need to cast away the const
+    if (IsCompact(iteratorRef->theMapPtr))
+    {
+        return (void*)iteratorRef->theMapPtr->slotsPtr[iteratorRef->currentIndex].valuePtr;
+    }
+
     return (void*)iteratorRef->currentEntryPtr->valuePtr;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the first entry of a map at or after the given bucket (or slot) index.
+ *
+ * @return  LE_OK if an entry was found, LE_NOT_FOUND otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetFirstNodeFrom
+(
+    Hashmap_t* map,
+    size_t index,
+    void **keyPtr,
+    void **valuePtr
+)
+{
+    if (IsCompact(map))
+    {
+        for ( ; index < map->bucketCount; index++ )
+        {
+            Slot_t* slotPtr = &(map->slotsPtr[index]);
+
+            if (IsSlotInUse(slotPtr))
+            {
+                *keyPtr = (void *)slotPtr->keyPtr;
+                if (NULL != valuePtr)
+                {
+                    *valuePtr = (void *)slotPtr->valuePtr;
+                }
+                return LE_OK;
+            }
+        }
+        return LE_NOT_FOUND;
+    }
+
+    for ( ; index < TotalBucketCount(map); index++ )
+    {
+        le_dls_Link_t* theLinkPtr = le_dls_Peek(GetBucket(map, index));
+
+        if (NULL != theLinkPtr)
+        {
+            Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
+            *keyPtr = (void *)currentEntryPtr->keyPtr;
+            if (NULL != valuePtr)
+            {
+                *valuePtr = (void *)currentEntryPtr->valuePtr;
+            }
+            return LE_OK;
+        }
+    }
+    return LE_NOT_FOUND;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Retrieves the key and value of the first node stored in the hashmap.
@@ -963,23 +1596,8 @@ le_result_t le_hashmap_GetFirstNode
     }
 
     // Find the first list head
-    size_t index = 0;
-    for (
-           ;
-           index < mapRef->bucketCount;
-           index++ )
-    {
-        le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[index]);
-        le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
+    GetFirstNodeFrom(mapRef, 0, firstKeyPtr, firstValuePtr);
 
-        if (NULL != theLinkPtr)
-        {
-            Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
-            *firstKeyPtr = (void *)currentEntryPtr->keyPtr;
-            *firstValuePtr = (void *)currentEntryPtr->valuePtr;
-            break;
-        }
-    }
     return LE_OK;
 };
 
@@ -1017,7 +1635,22 @@ le_result_t le_hashmap_GetNodeAfter
 
     // Find the node pointed to by the key
     size_t hash = HashKey(mapRef, keyPtr);
-    size_t index = CalculateIndex(mapRef->bucketCount, hash);
+
+    if (IsCompact(mapRef))
+    {
+        bool found;
+        size_t index = FindSlot(mapRef, keyPtr, hash, &found);
+
+        if (!found)
+        {
+            // The original key was never found
+            return LE_BAD_PARAMETER;
+        }
+
+        return GetFirstNodeFrom(mapRef, index + 1, nextKeyPtr, nextValuePtr);
+    }
+
+    size_t index = FindBucket(mapRef, hash);
     HASHMAP_TRACE(
         mapRef,
         "Hashmap %s: Generated index of %zu for hash %zu",
@@ -1026,73 +1659,36 @@ le_result_t le_hashmap_GetNodeAfter
         hash
     );
 
-    le_dls_List_t* listHeadPtr = &(mapRef->bucketsPtr[index]);
+    le_dls_List_t* listHeadPtr = GetBucket(mapRef, index);
+    Entry_t* currentEntryPtr = FindEntry(mapRef, listHeadPtr, keyPtr, hash);
+
+    if (currentEntryPtr == NULL)
+    {
+        // The original key was never found
+        return LE_BAD_PARAMETER;
+    }
+
     HASHMAP_TRACE(
         mapRef,
-        "Hashmap %s: Looked up list contains %zu links",
-        mapRef->nameStr,
-        le_dls_NumLinks(listHeadPtr)
+        "Hashmap %s: Found value for key",
+        mapRef->nameStr
     );
 
-    le_dls_Link_t* theLinkPtr = le_dls_Peek(listHeadPtr);
-
-    while (theLinkPtr != NULL) {
-        Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
-        if (EqualKeys(currentEntryPtr->keyPtr,
-                          currentEntryPtr->hash,
-                          keyPtr,
-                          hash,
-                          mapRef->equalsFuncPtr)
-                          )
-        {
-            HASHMAP_TRACE(
-                mapRef,
-                "Hashmap %s: Found value for key",
-                mapRef->nameStr
-            );
-            // Now find the next node, if there is one
-            theLinkPtr = le_dls_PeekNext(listHeadPtr, theLinkPtr);
-            if (NULL == theLinkPtr)
-            {
-                // Find the next list head
-                for (
-                       index++;
-                       index < mapRef->bucketCount;
-                       index++ )
-                {
-                    listHeadPtr = &(mapRef->bucketsPtr[index]);
-                    theLinkPtr = le_dls_Peek(listHeadPtr);
-
-                    if (NULL != theLinkPtr)
-                    {
-                        Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
-                        *nextKeyPtr = (void *)currentEntryPtr->keyPtr;
-                        if (NULL != nextValuePtr)
-                        {
-                            *nextValuePtr = (void *)currentEntryPtr->valuePtr;
-                        }
-                        return LE_OK;
-                    }
-                }
-                // There was no list head - we are off the end of the map
-                return LE_NOT_FOUND;
-            }
-            else
-            {
-                Entry_t* currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
-                *nextKeyPtr = (void *)currentEntryPtr->keyPtr;
-                if (NULL != nextValuePtr)
-                {
-                    *nextValuePtr = (void *)currentEntryPtr->valuePtr;
-                }
-                return LE_OK;
-            }
-        }
-        theLinkPtr = le_dls_PeekNext(listHeadPtr, theLinkPtr);
+    // Now find the next node, if there is one
+    le_dls_Link_t* theLinkPtr = le_dls_PeekNext(listHeadPtr, &(currentEntryPtr->entryListLink));
+    if (NULL == theLinkPtr)
+    {
+        // Find the next list head.  If there is none we are off the end of the map.
+        return GetFirstNodeFrom(mapRef, index + 1, nextKeyPtr, nextValuePtr);
     }
 
-    // The original key was never found
-    return LE_BAD_PARAMETER;
+    currentEntryPtr = CONTAINER_OF(theLinkPtr, Entry_t, entryListLink);
+    *nextKeyPtr = (void *)currentEntryPtr->keyPtr;
+    if (NULL != nextValuePtr)
+    {
+        *nextValuePtr = (void *)currentEntryPtr->valuePtr;
+    }
+    return LE_OK;
 }
 
 
@@ -1101,6 +1697,9 @@ le_result_t le_hashmap_GetNodeAfter
  * Counts the total number of collisions in the map. A collision occurs
  * when more than one entry is stored in the map at the same index.
  *
+ * For a compact map, this is the number of entries that are not stored in the slot their hash
+ * maps to.
+ *
  * @return  Returns The sum of the collisions in the map
  *
  */
@@ -1112,9 +1711,24 @@ size_t le_hashmap_CountCollisions
 )
 {
     size_t i, collCount = 0;
-    for (i = 0; i < mapRef->bucketCount; i++) {
-        if (mapRef->chainLengthPtr[i] > 1) {
-            collCount += mapRef->chainLengthPtr[i] - 1;
+
+    if (IsCompact(mapRef))
+    {
+        for (i = 0; i < mapRef->bucketCount; i++) {
+            Slot_t* slotPtr = &(mapRef->slotsPtr[i]);
+
+            if (IsSlotInUse(slotPtr) &&
+                (CalculateIndex(mapRef->bucketCount, slotPtr->hash) != i)) {
+                collCount++;
+            }
+        }
+        return collCount;
+    }
+
+    for (i = 0; i < TotalBucketCount(mapRef); i++) {
+        size_t chainLength = *GetChainLength(mapRef, i);
+        if (chainLength > 1) {
+            collCount += chainLength - 1;
         }
     }
     return collCount;
@@ -20,8 +20,22 @@ struct Entry {
     le_dls_Link_t entryListLink;
 };
 
+/**
+ * A slot in the table of a map created by le_hashmap_CreateCompact().  Keys and hashes are
+ * stored inline, so no entries need to be allocated and lookups don't chase list links.
+ */
+typedef struct Slot Slot_t;
+struct Slot {
+    const void* keyPtr;
+    const void* valuePtr;
+    size_t hash;
+};
+
 /**
  * A hashmap iterator
+ *
+ * For chained maps, currentIndex counts the buckets being moved out of (if the map is being
+ * resized) followed by the buckets of the current table.  For compact maps it is a slot index.
  */
 typedef struct le_hashmap_It {
     le_hashmap_Ref_t theMapPtr;
@@ -30,6 +44,8 @@ typedef struct le_hashmap_It {
     le_dls_Link_t* currentLinkPtr;
     Entry_t* currentEntryPtr;
     bool isValueValid;
+    bool isIterating;           ///< Is the iterator part way through the map?  Entries aren't
+                                ///  moved between buckets while it is.
 }
 HashmapIt_t;
 
@@ -44,6 +60,12 @@ typedef struct le_hashmap {
     le_mem_PoolRef_t entryPoolRef;
     le_dls_List_t* bucketsPtr;
     size_t* chainLengthPtr;
+    le_dls_List_t* oldBucketsPtr;   ///< Buckets being moved into bucketsPtr during a resize.
+    size_t* oldChainLengthPtr;      ///< Chain lengths of the buckets being moved.
+    size_t oldBucketCount;          ///< Number of buckets being moved (0 if not resizing).
+    size_t rehashIndex;             ///< Next bucket in oldBucketsPtr to be moved.
+    Slot_t* slotsPtr;               ///< Slot table of a compact map (NULL if chained).
+    size_t usedSlotCount;           ///< Number of slots that are occupied or deleted.
     const char* nameStr;
     HashmapIt_t* iteratorPtr;
     le_log_TraceRef_t traceRef;
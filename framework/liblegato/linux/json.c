@@ -13,6 +13,10 @@
 /// including the null terminator.
 #define MAX_STRING_BYTES 1024
 
+/// Number of bytes read from the file descriptor in one go when it is safe to read ahead
+/// (i.e., when bytes read past the end of the document can be handed back using lseek()).
+#define READ_CHUNK_BYTES 4096
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -54,9 +58,14 @@ typedef struct le_json_ParsingSession
     size_t numBytes;                ///< # of bytes of content in the buffer.
     double number;                  ///< Value of last number parsed.
 
-    int fd;                         ///< File descriptor to read the JSON document from.
+    int fd;                         ///< File descriptor to read the JSON document from (or -1).
     le_fdMonitor_Ref_t fdMonitor;   ///< File Descriptor Monitor used to monitor the fd.
-    size_t bytesRead;               ///< # of bytes read from the file descriptor.
+    size_t readSize;                ///< Max # of bytes to read from the fd in one read() call.
+    char readBuffer[READ_CHUNK_BYTES]; ///< Buffer into which data is read from the fd.
+    const char* dataPtr;            ///< Data waiting to be processed (readBuffer or client's).
+    size_t dataLen;                 ///< # of bytes of data at dataPtr.
+    size_t dataPos;                 ///< Offset of the next byte to be processed at dataPtr.
+    size_t bytesRead;               ///< # of bytes of the document processed so far.
     size_t line;                    ///< Line number of the JSON document (starts at 1).
 
     le_json_ErrorHandler_t errorHandler; ///< Function to call when errors happen.
@@ -130,8 +139,27 @@ static void StopParsing
     if (NotStopped(parserPtr))
     {
         parserPtr->next = EXPECT_NOTHING;
-        le_fdMonitor_Delete(parserPtr->fdMonitor);
-        parserPtr->fdMonitor = NULL;
+
+        if (parserPtr->fdMonitor != NULL)
+        {
+            le_fdMonitor_Delete(parserPtr->fdMonitor);
+            parserPtr->fdMonitor = NULL;
+        }
+
+        // If data was read from the fd past the point where parsing stopped, hand it back so
+        // that whoever reads from the fd next (e.g., the payload following a JSON header) sees
+        // it.  Read-ahead is only ever done on seekable fds.
+        size_t unprocessed = parserPtr->dataLen - parserPtr->dataPos;
+
+        if ((parserPtr->fd != -1) && (unprocessed > 0))
+        {
+            if (lseek(parserPtr->fd, -(off_t)unprocessed, SEEK_CUR) == -1)
+            {
+                LE_ERROR("Failed to rewind fd %d by %zu bytes (%m).", parserPtr->fd, unprocessed);
+            }
+        }
+
+        parserPtr->dataLen = parserPtr->dataPos;
     }
 }
 
@@ -469,7 +497,7 @@ static void ParseValue
 //--------------------------------------------------------------------------------------------------
 {
     // Throw away whitespace until something else comes along.
-    if (!isspace(c))
+    if (!isspace((unsigned char)c))
     {
         if (c == '{')   // Start of an object.
         {
@@ -506,7 +534,7 @@ static void ParseValue
             AddToBuffer(parserPtr, c);
             parserPtr->next = EXPECT_NULL;
         }
-        else if (isdigit(c) || (c == '-'))
+        else if (isdigit((unsigned char)c) || (c == '-'))
         {
             PushContext(parserPtr, LE_JSON_CONTEXT_NUMBER, GetEventHandler(parserPtr));
             AddToBuffer(parserPtr, c);
@@ -679,7 +707,7 @@ static void ProcessChar
                 parserPtr->next = EXPECT_VALUE_OR_ARRAY_END;
                 Report(parserPtr, LE_JSON_ARRAY_START);
             }
-            else if (!isspace(c))
+            else if (!isspace((unsigned char)c))
             {
                 Error(parserPtr, LE_JSON_SYNTAX_ERROR, "Document must start with '{' or '['.");
             }
@@ -698,7 +726,7 @@ static void ProcessChar
                 PushContext(parserPtr, LE_JSON_CONTEXT_MEMBER, GetEventHandler(parserPtr));
                 parserPtr->next = EXPECT_STRING;
             }
-            else if (!isspace(c))
+            else if (!isspace((unsigned char)c))
             {
                 Error(parserPtr,
                       LE_JSON_SYNTAX_ERROR,
@@ -713,7 +741,7 @@ static void ProcessChar
             {
                 parserPtr->next = EXPECT_VALUE;
             }
-            else if (!isspace(c))
+            else if (!isspace((unsigned char)c))
             {
                 Error(parserPtr,
                       LE_JSON_SYNTAX_ERROR,
@@ -738,7 +766,7 @@ static void ProcessChar
             {
                 parserPtr->next = EXPECT_MEMBER;
             }
-            else if (!isspace(c))
+            else if (!isspace((unsigned char)c))
             {
                 Error(parserPtr,
                       LE_JSON_SYNTAX_ERROR,
@@ -754,7 +782,7 @@ static void ProcessChar
                 PushContext(parserPtr, LE_JSON_CONTEXT_MEMBER, GetEventHandler(parserPtr));
                 parserPtr->next = EXPECT_STRING;
             }
-            else if (!isspace(c))
+            else if (!isspace((unsigned char)c))
             {
                 Error(parserPtr,
                       LE_JSON_SYNTAX_ERROR,
@@ -787,7 +815,7 @@ static void ProcessChar
             {
                 parserPtr->next = EXPECT_VALUE;
             }
-            else if (!isspace(c))
+            else if (!isspace((unsigned char)c))
             {
                 Error(parserPtr,
                       LE_JSON_SYNTAX_ERROR,
@@ -802,7 +830,7 @@ static void ProcessChar
 
         case EXPECT_NUMBER:
 
-            if ((c == '.') || isdigit(c))
+            if ((c == '.') || isdigit((unsigned char)c))
             {
                 AddToBuffer(parserPtr, c);
             }
@@ -851,6 +879,144 @@ static void ProcessChar
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counts the number of new-line characters in a block of data.
+ *
+ * @return The number of '\n' characters found.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t CountNewLines
+(
+    const char* dataPtr,
+    size_t len
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count = 0;
+    const char* endPtr = dataPtr + len;
+
+    while ((dataPtr = memchr(dataPtr, '\n', endPtr - dataPtr)) != NULL)
+    {
+        count++;
+        dataPtr++;
+    }
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the length of the run of characters at the start of a block of data that can be consumed
+ * without being passed to ProcessChar() one at a time, given the parser's current state.
+ *
+ * Inside a string, that is everything up to the next '"' (found using memchr(), which the C
+ * library vectorizes), limited to the space left in the string buffer.  Between tokens, that
+ * is any leading whitespace.  In all other states it is nothing.
+ *
+ * @return The length of the run (may be 0).
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetRunLength
+(
+    Parser_t* parserPtr,
+    const char* dataPtr,
+    size_t len
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t runLen = 0;
+
+    switch (parserPtr->next)
+    {
+        case EXPECT_STRING:
+        {
+            const char* quotePtr = memchr(dataPtr, '"', len);
+            size_t spaceLeft = sizeof(parserPtr->buffer) - 1 - parserPtr->numBytes;
+
+            runLen = (quotePtr == NULL) ? len : (size_t)(quotePtr - dataPtr);
+
+            // If the string doesn't fit, leave the overflowing character for ProcessChar() to
+            // report.
+            if (runLen > spaceLeft)
+            {
+                runLen = spaceLeft;
+            }
+            break;
+        }
+
+        case EXPECT_OBJECT_OR_ARRAY:
+        case EXPECT_MEMBER_OR_OBJECT_END:
+        case EXPECT_COLON:
+        case EXPECT_VALUE:
+        case EXPECT_COMMA_OR_OBJECT_END:
+        case EXPECT_MEMBER:
+        case EXPECT_VALUE_OR_ARRAY_END:
+        case EXPECT_COMMA_OR_ARRAY_END:
+
+            while ((runLen < len) && isspace((unsigned char)dataPtr[runLen]))
+            {
+                runLen++;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return runLen;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Processes the parser's pending data (dataPtr, dataLen, dataPos) until it has all been processed
+ * or parsing stops.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessData
+(
+    Parser_t* parserPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while (NotStopped(parserPtr) && (parserPtr->dataPos < parserPtr->dataLen))
+    {
+        const char* dataPtr = parserPtr->dataPtr + parserPtr->dataPos;
+        size_t len = parserPtr->dataLen - parserPtr->dataPos;
+
+        // Consume runs of string content or whitespace in bulk.
+        size_t runLen = GetRunLength(parserPtr, dataPtr, len);
+
+        if (runLen > 0)
+        {
+            if (parserPtr->next == EXPECT_STRING)
+            {
+                memcpy(parserPtr->buffer + parserPtr->numBytes, dataPtr, runLen);
+                parserPtr->numBytes += runLen;
+            }
+
+            parserPtr->dataPos += runLen;
+            parserPtr->bytesRead += runLen;
+            parserPtr->line += CountNewLines(dataPtr, runLen);
+        }
+        else
+        {
+            char c = *dataPtr;
+
+            parserPtr->dataPos++;
+            parserPtr->bytesRead++;
+            if (c == '\n')
+            {
+                parserPtr->line++;
+            }
+            ProcessChar(parserPtr, c);
+        }
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read data from the JSON document file descriptor and process it.
@@ -865,11 +1031,10 @@ static void ReadData
 {
     while (NotStopped(parserPtr))
     {
-        char c;
         ssize_t bytesRead;
         do
         {
-            bytesRead = read(fd, &c, 1);
+            bytesRead = read(fd, parserPtr->readBuffer, parserPtr->readSize);
         }
         while ((bytesRead == -1) && (errno == EINTR));
 
@@ -914,12 +1079,11 @@ static void ReadData
         }
         else
         {
-            parserPtr->bytesRead++;
-            if (c == '\n')
-            {
-                parserPtr->line++;
-            }
-            ProcessChar(parserPtr, c);
+            parserPtr->dataPtr = parserPtr->readBuffer;
+            parserPtr->dataLen = bytesRead;
+            parserPtr->dataPos = 0;
+
+            ProcessData(parserPtr);
         }
     }
 }
@@ -975,29 +1139,58 @@ static void FdEventHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Parse a JSON document received via a file descriptor.
+ * Function queued to the event loop by le_json_ParseBuffer() to parse the client's buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ParseBufferHandler
+(
+    void* param1Ptr,    ///< Pointer to the Parser object.
+    void* param2Ptr     ///< Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Parser_t* parserPtr = param1Ptr;
+    (void)param2Ptr;
+
+    ProcessData(parserPtr);
+
+    if (NotStopped(parserPtr))
+    {
+        // The document has been truncated.
+        Error(parserPtr, LE_JSON_READ_ERROR, "Unexpected end-of-file.");
+    }
+
+    // Release the reference taken by le_json_ParseBuffer().
+    le_mem_Release(parserPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a Parser object with its top-level context.  Its input has to be set up by the caller.
  *
- * @return Reference to the JSON parsing session started by this function call.
+ * @return Pointer to the new Parser object.
  */
 //--------------------------------------------------------------------------------------------------
-le_json_ParsingSessionRef_t le_json_Parse
+static Parser_t* CreateParser
 (
-    int fd, ///< File descriptor to read the JSON document from.
     le_json_EventHandler_t  eventHandler,   ///< Function to call when normal parsing events happen.
     le_json_ErrorHandler_t  errorHandler,   ///< Function to call when errors happen.
     void* opaquePtr   ///< Opaque pointer to be fetched by handlers using le_json_GetOpaquePtr().
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Create a Parser.
     Parser_t* parserPtr = le_mem_ForceAlloc(ParserPool);
 
     parserPtr->next = EXPECT_OBJECT_OR_ARRAY;
     parserPtr->numBytes = 0;
 
-    parserPtr->fd = fd;
-    parserPtr->fdMonitor = le_fdMonitor_Create("le_json", fd, FdEventHandler, POLLIN);
-    le_fdMonitor_SetContextPtr(parserPtr->fdMonitor, parserPtr);
+    parserPtr->fd = -1;
+    parserPtr->fdMonitor = NULL;
+    parserPtr->readSize = 0;
+    parserPtr->dataPtr = NULL;
+    parserPtr->dataLen = 0;
+    parserPtr->dataPos = 0;
     parserPtr->bytesRead = 0;
     parserPtr->line = 1;
 
@@ -1016,6 +1209,83 @@ le_json_ParsingSessionRef_t le_json_Parse
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a JSON document received via a file descriptor.
+ *
+ * @return Reference to the JSON parsing session started by this function call.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_ParsingSessionRef_t le_json_Parse
+(
+    int fd, ///< File descriptor to read the JSON document from.
+    le_json_EventHandler_t  eventHandler,   ///< Function to call when normal parsing events happen.
+    le_json_ErrorHandler_t  errorHandler,   ///< Function to call when errors happen.
+    void* opaquePtr   ///< Opaque pointer to be fetched by handlers using le_json_GetOpaquePtr().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Parser_t* parserPtr = CreateParser(eventHandler, errorHandler, opaquePtr);
+
+    parserPtr->fd = fd;
+
+    // Whatever follows the document in the fd must be left there for the client to read, so
+    // reading ahead is only done if the fd is a regular file (whose read position can be moved
+    // back when parsing stops).  Anything else is read one byte at a time.
+    struct stat fileStat;
+
+    if ((fstat(fd, &fileStat) == 0) && S_ISREG(fileStat.st_mode))
+    {
+        parserPtr->readSize = sizeof(parserPtr->readBuffer);
+    }
+    else
+    {
+        parserPtr->readSize = 1;
+    }
+
+    parserPtr->fdMonitor = le_fdMonitor_Create("le_json", fd, FdEventHandler, POLLIN);
+    le_fdMonitor_SetContextPtr(parserPtr->fdMonitor, parserPtr);
+
+    return parserPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a JSON document held in memory (e.g., a buffer or a memory-mapped file).
+ *
+ * Like le_json_Parse(), this returns immediately and parsing is done later by the calling
+ * thread's event loop.
+ *
+ * @return Reference to the JSON parsing session started by this function call.
+ *
+ * @warning The buffer must remain valid until parsing has stopped.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_ParsingSessionRef_t le_json_ParseBuffer
+(
+    const void* bufferPtr,  ///< Buffer containing the JSON document.
+    size_t bufferSize,      ///< Number of bytes of data in the buffer.
+    le_json_EventHandler_t  eventHandler,   ///< Function to call when normal parsing events happen.
+    le_json_ErrorHandler_t  errorHandler,   ///< Function to call when errors happen.
+    void* opaquePtr   ///< Opaque pointer to be fetched by handlers using le_json_GetOpaquePtr().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Parser_t* parserPtr = CreateParser(eventHandler, errorHandler, opaquePtr);
+
+    parserPtr->dataPtr = bufferPtr;
+    parserPtr->dataLen = bufferSize;
+
+    // Hold a reference until the queued function has run, in case the client calls
+    // le_json_Cleanup() before that.
+    le_mem_AddRef(parserPtr);
+    le_event_QueueFunction(ParseBufferHandler, parserPtr, NULL);
+
+    return parserPtr;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Stops parsing and cleans up memory allocated by the parser.
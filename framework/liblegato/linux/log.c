@@ -12,13 +12,24 @@
 #include "logDaemon/logDaemon.h"
 #include "limit.h"
 #include "messagingSession.h"
+#include "logRing.h"
+#include "logDaemon/logShm.h"
+#include "fileDescriptor.h"
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Maximum length of log messages.
- */
-//--------------------------------------------------------------------------------------------------
-#define MAX_MSG_SIZE            256
+#include <sys/mman.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC         0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING   0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS         1033
+#define F_SEAL_SEAL         0x0001
+#define F_SEAL_SHRINK       0x0002
+#define F_SEAL_GROW         0x0004
+#endif
 
 
 //--------------------------------------------------------------------------------------------------
@@ -136,6 +147,27 @@ static le_msg_SessionRef_t IpcSessionRef;
 //--------------------------------------------------------------------------------------------------
 static le_log_TraceRef_t TraceRef;
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if messages are recorded in binary form and output by a background thread (see logRing.c).
+ * Set by log_Init() only.
+ **/
+//--------------------------------------------------------------------------------------------------
+static bool IsBinaryMode = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Shared memory ring that messages are handed to the Log Control Daemon through (NULL if not
+ * attached), the doorbell that wakes the Log Control Daemon up, and the process that attached
+ * them.  A forked child doesn't use its parent's ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static logShm_Header_t* ShmRingPtr = NULL;
+static int ShmDoorbellFd = -1;
+static pid_t ShmPid;
+
 /// Macro used to generate trace output in this module.
 /// Takes the same parameters as LE_DEBUG() et. al.
 #define TRACE(...) LE_TRACE(TraceRef, ##__VA_ARGS__)
@@ -443,6 +475,34 @@ static void ReadLevelFromEnv
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enables binary logging mode if the LE_LOG_BINARY environment variable is set to 1.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ReadBinaryModeFromEnv
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* envStrPtr = getenv("LE_LOG_BINARY");
+
+    if (envStrPtr != NULL)
+    {
+        if (strcmp(envStrPtr, "1") == 0)
+        {
+            logRing_Init();
+            IsBinaryMode = true;
+        }
+        else if (strcmp(envStrPtr, "0") != 0)
+        {
+            LE_ERROR("LE_LOG_BINARY environment variable has invalid value '%s'.", envStrPtr);
+        }
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Loads the default list of enabled trace keywords from the environment, if present.
@@ -737,6 +797,85 @@ static void RegisterWithLogControlDaemon
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a shared memory ring and hands it to the Log Control Daemon, so that messages can be
+ * given to the Log Control Daemon without a system call each.  If anything goes wrong, messages
+ * keep going straight to syslog.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void AttachShmRing
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef SYS_memfd_create
+    int memFd = syscall(SYS_memfd_create, "le_log", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    int memFd = -1;
+#endif
+    if (memFd < 0)
+    {
+        TRACE("Couldn't create log ring (%m).");
+        return;
+    }
+
+    void* mapPtr = MAP_FAILED;
+
+    // The Log Control Daemon refuses memory that could be shrunk under it.
+    if (   (ftruncate(memFd, LOG_SHM_RING_BYTES) == 0)
+        && (fcntl(memFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == 0) )
+    {
+        mapPtr = mmap(NULL, LOG_SHM_RING_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+    }
+
+    if (mapPtr == MAP_FAILED)
+    {
+        TRACE("Couldn't set up log ring (%m).");
+        fd_Close(memFd);
+        return;
+    }
+
+    // The memory starts out zeroed, so head, tail and the counters are already 0.
+    logShm_Header_t* ringPtr = mapPtr;
+    ringPtr->magic = LOG_SHM_MAGIC;
+    ringPtr->slotCount = LOG_SHM_SLOT_COUNT;
+    ringPtr->slotSize = sizeof(logShm_Slot_t);
+
+    le_msg_MessageRef_t msgRef = le_msg_CreateMsg(IpcSessionRef);
+
+    snprintf(le_msg_GetPayloadPtr(msgRef), LOG_MAX_CMD_PACKET_BYTES, "%c%s/*/%d",
+             LOG_CMD_ATTACH_RING, le_arg_GetProgramName(), getpid());
+
+    // The memfd is closed once it has been sent.
+    le_msg_SetFd(msgRef, memFd);
+
+    msgRef = le_msg_RequestSyncResponse(msgRef);
+
+    // The response carries the doorbell, unless the Log Control Daemon didn't accept the ring
+    // (e.g., an older Log Control Daemon).
+    int doorbellFd = -1;
+
+    if (msgRef != NULL)
+    {
+        doorbellFd = le_msg_GetFd(msgRef);
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    if (doorbellFd < 0)
+    {
+        TRACE("Log Control Daemon didn't accept log ring.");
+        munmap(mapPtr, LOG_SHM_RING_BYTES);
+        return;
+    }
+
+    ShmDoorbellFd = doorbellFd;
+    ShmPid = getpid();
+    __atomic_store_n(&ShmRingPtr, ringPtr, __ATOMIC_RELEASE);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initialize the logging system.
@@ -751,6 +890,7 @@ void log_Init
 
     // Load the default log level filter and output destination settings from the environment.
     ReadLevelFromEnv();
+    ReadBinaryModeFromEnv();
 
     // Create the keyword memory pool.
     KeywordMemPool = le_mem_CreatePool("TraceKeys", sizeof(KeywordObj_t));
@@ -859,6 +999,8 @@ void log_ConnectToControlDaemon
 
             linkPtr = le_sls_PeekNext(&SessionList, linkPtr);
         }
+
+        AttachShmRing();
     }
 }
 
@@ -978,6 +1120,29 @@ const char* log_SeverityLevelToStr
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the string that identifies a severity level in log messages (e.g., "-WRN-").
+ *
+ * @return
+ *      Pointer to a string constant.
+ *      NULL if the value is out of range.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* log_GetSeverityStr
+(
+    le_log_Level_t level    ///< [IN] Severity level.
+)
+{
+    if ((level < LE_LOG_DEBUG) || (level > LE_LOG_EMERG))
+    {
+        return NULL;
+    }
+
+    return SeverityStr[level];
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Converts the legato log levels to the syslog priority levels.
@@ -1019,18 +1184,170 @@ static int ConvertToSyslogLevel
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Builds the log message and sends it to the logging system.
+ * Writes a log message into the shared memory ring, and rings the doorbell if the Log Control
+ * Daemon is waiting for it.  If the ring is full, the message is left for the caller to output
+ * directly, so that a burst of messages is never lost.
+ *
+ * @return true if the message was taken care of, false if the caller must output it.
  */
 //--------------------------------------------------------------------------------------------------
-void _le_log_Send
+static bool WriteShmRing
 (
-    const le_log_Level_t level,         // The severity level. Set to -1 if this is a Trace log.
-    const le_log_TraceRef_t traceRef,   // The Trace reference. Set to NULL if this is not a Trace log.
+    le_log_Level_t level,           ///< [IN] Severity level (-1 if this is a trace message).
+    const char* levelPtr,           ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,        ///< [IN] Component name.
+    const char* threadNamePtr,      ///< [IN] Thread name.
+    const char* fileNamePtr,        ///< [IN] Source file base name.
+    const char* functionNamePtr,    ///< [IN] Function name.
+    unsigned int lineNumber,        ///< [IN] Source line number.
+    time_t timestamp,               ///< [IN] Time at which the message was logged.
+    const char* msgPtr              ///< [IN] Formatted message.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    logShm_Header_t* ringPtr = ShmRingPtr;
+
+    Lock();
+
+    uint32_t head = ringPtr->head;
+
+    if ((uint32_t)(head - __atomic_load_n(&ringPtr->tail, __ATOMIC_ACQUIRE)) >= LOG_SHM_SLOT_COUNT)
+    {
+        Unlock();
+        return false;
+    }
+
+    logShm_Slot_t* slotPtr = logShm_GetSlotPtr(ringPtr, head);
+
+    slotPtr->timestamp = timestamp;
+    slotPtr->level = level;
+    slotPtr->lineNumber = lineNumber;
+    le_utf8_Copy(slotPtr->keyword, (level == (le_log_Level_t)-1) ? levelPtr : "",
+                 sizeof(slotPtr->keyword), NULL);
+    le_utf8_Copy(slotPtr->compName, compNamePtr, sizeof(slotPtr->compName), NULL);
+    le_utf8_Copy(slotPtr->threadName, threadNamePtr, sizeof(slotPtr->threadName), NULL);
+    le_utf8_Copy(slotPtr->fileName, fileNamePtr, sizeof(slotPtr->fileName), NULL);
+    le_utf8_Copy(slotPtr->funcName, functionNamePtr, sizeof(slotPtr->funcName), NULL);
+    le_utf8_Copy(slotPtr->msg, msgPtr, sizeof(slotPtr->msg), NULL);
+
+    __atomic_store_n(&ringPtr->head, head + 1, __ATOMIC_RELEASE);
+
+    // Pairs with the Log Control Daemon setting isWaiting and then checking head once more.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (   __atomic_load_n(&ringPtr->isWaiting, __ATOMIC_RELAXED)
+        && __atomic_exchange_n(&ringPtr->isWaiting, 0, __ATOMIC_RELAXED) )
+    {
+        uint64_t one = 1;
+        ssize_t result;
+
+        do
+        {
+            result = write(ShmDoorbellFd, &one, sizeof(one));
+        }
+        while ((result < 0) && (errno == EINTR));
+    }
+
+    Unlock();
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Outputs a formatted log message to the logging system (syslog on embedded targets, stderr
+ * otherwise).
+ */
+//--------------------------------------------------------------------------------------------------
+void log_EmitMsg
+(
+    le_log_Level_t level,           ///< [IN] Severity level (-1 if this is a trace message).
+    const char* levelPtr,           ///< [IN] Severity level string or trace keyword (NULL = use
+                                    ///       the level's string).
+    const char* compNamePtr,        ///< [IN] Component name.
+    const char* threadNamePtr,      ///< [IN] Thread name.
+    const char* filenamePtr,        ///< [IN] Source file name (only the base name is output).
+    const char* functionNamePtr,    ///< [IN] Function name.
+    unsigned int lineNumber,        ///< [IN] Source line number.
+    time_t timestamp,               ///< [IN] Time at which the message was logged.
+    const char* msgPtr              ///< [IN] Formatted message.
+)
+{
+    if (levelPtr == NULL)
+    {
+        levelPtr = SeverityStr[level];
+    }
+
+    // Get the file name.
+    char* baseFileNamePtr = le_path_GetBasenamePtr((char*)filenamePtr, "/");
+
+    // If the Log Control Daemon takes this process's messages, hand the message to it.  On a PC,
+    // the message is still written to this process's own standard error below, as the Log Control
+    // Daemon leaves that to the client.
+    if (   (__atomic_load_n(&ShmRingPtr, __ATOMIC_ACQUIRE) != NULL)
+        && (getpid() == ShmPid)
+        && WriteShmRing(level, levelPtr, compNamePtr, threadNamePtr, baseFileNamePtr,
+                        functionNamePtr, lineNumber, timestamp, msgPtr) )
+    {
+#ifdef LEGATO_EMBEDDED
+        return;
+#endif
+    }
+
+    // Get the process name.
+    const char* procNamePtr = le_arg_GetProgramName();
+    if (procNamePtr == NULL)
+    {
+        procNamePtr = "n/a";
+    }
+
+    // If running on an embedded target, write the message out to the log.
+#ifdef LEGATO_EMBEDDED
+
+    syslog(ConvertToSyslogLevel(level), "%s | %s[%d]/%s T=%s | %s %s() %d | %s\n",
+           levelPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr, baseFileNamePtr,
+           functionNamePtr, lineNumber, msgPtr);
+
+    // If running on a PC, write the message to standard error with a timestamp added.
+#else
+
+    char timeStamp[26] = "";
+    char* timeStampPtr = timeStamp;
+
+    if ( (timestamp != ((time_t)-1)) && (ctime_r(&timestamp, timeStamp) != NULL) )
+    {
+        // Tue Jan 14 18:01:56 2014
+        // 0123456789012345678901234
+        timeStampPtr = timeStamp + 4; // Skip day of week.
+        timeStamp[19] = '\0';  // Exclude the year.
+    }
+
+    fprintf(stderr, "%s : %s | %s[%d]/%s T=%s | %s %s() %d | %s\n",
+            timeStampPtr, levelPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr,
+            baseFileNamePtr, functionNamePtr, lineNumber, msgPtr);
+
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds the log message and sends it to the logging system.  In binary mode, the message is
+ * recorded in the calling thread's ring buffer instead, unless it has to be output right away.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendMsg
+(
+    bool mayDefer,                      // true if the message can be output later.
+    le_log_Level_t level,               // The severity level. Set to -1 if this is a Trace log.
+    le_log_TraceRef_t traceRef,         // The Trace reference. Set to NULL if this is not a Trace log.
     le_log_SessionRef_t logSession,     // The log session.
     const char* filenamePtr,            // The name of the source file that logged the message.
     const char* functionNamePtr,        // The name of the function that logged the message.
-    const unsigned int lineNumber,      // The line number in the source file that logged the message.
-    const char* formatPtr, ...          // The user message format and options.
+    unsigned int lineNumber,            // The line number in the source file that logged the message.
+    const char* formatPtr,              // The user message format.
+    va_list varParams                   // The user message options.
 )
 {
     // Save the current errno to be used in the log message because some of the system calls below
@@ -1074,24 +1391,23 @@ void _le_log_Send
     // NOTE: The component name won't change, so it's safe to read this without locking the mutex.
     const char* compNamePtr = logSession->componentNamePtr;
 
-    // Get the file name.
-    char* baseFileNamePtr = le_path_GetBasenamePtr((char*)filenamePtr, "/");
-
-    // Get the thread name.
-    const char* threadNamePtr = le_thread_GetMyName();
-
-    // Get the process name.
-    const char* procNamePtr = le_arg_GetProgramName();
-    if (procNamePtr == NULL)
+    if (IsBinaryMode)
     {
-        procNamePtr = "n/a";
+        // Critical and emergency messages are often the last thing a process logs before it dies,
+        // so they are always output right away.
+        if (mayDefer && (level != LE_LOG_CRIT) && (level != LE_LOG_EMERG))
+        {
+            logRing_Write(level, levelPtr, compNamePtr, filenamePtr, functionNamePtr, lineNumber,
+                          savedErrno, formatPtr, varParams);
+            return;
+        }
+
+        // Output everything that was logged before this message first.
+        logRing_Flush();
     }
 
     // Get the user message.
-    char msg[MAX_MSG_SIZE] = "";
-
-    va_list varParams;
-    va_start(varParams, formatPtr);
+    char msg[LOG_MAX_MSG_SIZE] = "";
 
     // Reset the errno to ensure that we report the proper errno value.
     errno = savedErrno;
@@ -1100,35 +1416,61 @@ void _le_log_Send
     // it.  If there was a truncation then that'll just show up in the logs.
     vsnprintf(msg, sizeof(msg), formatPtr, varParams);
 
-    va_end(varParams);
+    log_EmitMsg(level, levelPtr, compNamePtr, le_thread_GetMyName(), filenamePtr,
+                functionNamePtr, lineNumber, time(NULL), msg);
+}
 
-    // If running on an embedded target, write the message out to the log.
-#ifdef LEGATO_EMBEDDED
 
-    syslog(ConvertToSyslogLevel(level), "%s | %s[%d]/%s T=%s | %s %s() %d | %s\n",
-           levelPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr, baseFileNamePtr,
-           functionNamePtr, lineNumber, msg);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds the log message and sends it to the logging system.
+ */
+//--------------------------------------------------------------------------------------------------
+void _le_log_Send
+(
+    const le_log_Level_t level,         // The severity level. Set to -1 if this is a Trace log.
+    const le_log_TraceRef_t traceRef,   // The Trace reference. Set to NULL if this is not a Trace log.
+    le_log_SessionRef_t logSession,     // The log session.
+    const char* filenamePtr,            // The name of the source file that logged the message.
+    const char* functionNamePtr,        // The name of the function that logged the message.
+    const unsigned int lineNumber,      // The line number in the source file that logged the message.
+    const char* formatPtr, ...          // The user message format and options.
+)
+{
+    va_list varParams;
+    va_start(varParams, formatPtr);
 
-    // If running on a PC, write the message to standard error with a timestamp added.
-#else
+    SendMsg(true, level, traceRef, logSession, filenamePtr, functionNamePtr, lineNumber,
+            formatPtr, varParams);
 
-    time_t now;
-    char timeStamp[26] = "";
-    char* timeStampPtr = timeStamp;
+    va_end(varParams);
+}
 
-    if ( (time(&now) != ((time_t)-1)) && (ctime_r(&now, timeStamp) != NULL) )
-    {
-        // Tue Jan 14 18:01:56 2014
-        // 0123456789012345678901234
-        timeStampPtr = timeStamp + 4; // Skip day of week.
-        timeStamp[19] = '\0';  // Exclude the year.
-    }
 
-    fprintf(stderr, "%s : %s | %s[%d]/%s T=%s | %s %s() %d | %s\n",
-            timeStampPtr, levelPtr, procNamePtr, getpid(), compNamePtr, threadNamePtr,
-            baseFileNamePtr, functionNamePtr, lineNumber, msg);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds the log message and sends it to the logging system before returning, even in binary
+ * logging mode.
+ */
+//--------------------------------------------------------------------------------------------------
+void _le_log_SendNow
+(
+    const le_log_Level_t level,         // The severity level. Set to -1 if this is a Trace log.
+    const le_log_TraceRef_t traceRef,   // The Trace reference. Set to NULL if this is not a Trace log.
+    le_log_SessionRef_t logSession,     // The log session.
+    const char* filenamePtr,            // The name of the source file that logged the message.
+    const char* functionNamePtr,        // The name of the function that logged the message.
+    const unsigned int lineNumber,      // The line number in the source file that logged the message.
+    const char* formatPtr, ...          // The user message format and options.
+)
+{
+    va_list varParams;
+    va_start(varParams, formatPtr);
 
-#endif
+    SendMsg(false, level, traceRef, logSession, filenamePtr, functionNamePtr, lineNumber,
+            formatPtr, varParams);
+
+    va_end(varParams);
 }
 
 
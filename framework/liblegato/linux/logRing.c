@@ -0,0 +1,1347 @@
+/** @file logRing.c
+ *
+ * Binary logging module.  Used instead of formatting log messages in the thread that logs them
+ * when the LE_LOG_BINARY environment variable is set to 1.
+ *
+ * Each thread that logs gets its own single-producer/single-consumer ring buffer.  Writing a
+ * record into it doesn't take any locks and doesn't make any system calls: the logging thread
+ * copies the record header (severity, source location, timestamp, and pointers to the constant
+ * strings) followed by the raw values of the format string's arguments.  Which values to copy, and
+ * how big they are, is found by scanning the format string's conversion specifications.
+ * Conversions that can't be captured this way (%n, wide characters and strings, and positional
+ * arguments) make the record fall back to holding the message already formatted with vsnprintf().
+ *
+ * A "flusher" thread (a plain POSIX thread, started the first time a message is recorded)
+ * periodically drains all the ring buffers, formats each record and outputs it through
+ * log_EmitMsg().  Every record carries a process-wide sequence number, so records from different
+ * threads are merged back into the order in which they were logged: the flusher takes a snapshot
+ * of all the rings and outputs everything in the snapshot, from all the rings, in sequence order.
+ * The flusher is woken early when a ring buffer gets half full or when it went to sleep with
+ * nothing to do.
+ *
+ * The list of rings is only locked long enough to take the snapshot, and to free dead threads'
+ * rings, so threads can start logging (and the process can fork) while messages are being output.
+ * The consumers of the rings (the flusher, and logRing_Flush()) are serialized by another mutex.
+ *
+ * If a ring buffer is full, the message is dropped and counted, and the flusher logs a warning
+ * with the number of messages that were dropped.
+ *
+ * The rings of threads that have died are freed by the flusher once they have been drained.
+ * Everything still in the rings is flushed when the process exits normally, and before a
+ * critical or emergency message is output (see _le_log_Send()).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "log.h"
+#include "logRing.h"
+#include "limit.h"
+#include <semaphore.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of each thread's ring buffer, in bytes.  Must be a power of two.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RING_BYTES              (16 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of argument data in a record.  A message whose arguments don't fit is
+ * formatted right away, and truncated to this size.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_ARGS_BYTES          512
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Alignment of records and argument values in the ring, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RECORD_ALIGN            8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rounds a size up to a multiple of RECORD_ALIGN.
+ */
+//--------------------------------------------------------------------------------------------------
+#define ALIGN_UP(size)          (((size) + (RECORD_ALIGN - 1)) & ~((size_t)RECORD_ALIGN - 1))
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum size of a single conversion specification (from the '%' to the conversion character),
+ * after the '*' width and precision have been replaced by their values.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_SPEC_BYTES          48
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Longest time, in milliseconds, that a record waits in a ring before the flusher outputs it while
+ * messages are being logged.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FLUSH_INTERVAL_MS       50
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time, in milliseconds, that the flusher sleeps for when there was nothing to flush.  Logging a
+ * message wakes it up early.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IDLE_INTERVAL_MS        1000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value stored in place of a string's length when the string pointer was NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NULL_STRING_LEN         UINT32_MAX
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record header.  Followed in the ring by the record's arguments, or by the formatted message if
+ * formatPtr is NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t size;                  ///< Size of the record in bytes, header included.  A size of
+                                    ///  zero marks the unused space at the end of the ring.
+    uint32_t lineNumber;            ///< Source line number.
+    uint64_t seq;                   ///< Process-wide sequence number.
+    le_log_Level_t level;           ///< Severity level (-1 for trace messages).
+    int savedErrno;                 ///< errno value to use for %m.
+    time_t timestamp;               ///< Time at which the message was logged.
+    const char* levelPtr;           ///< Severity level string or trace keyword.
+    const char* compNamePtr;        ///< Component name.
+    const char* filenamePtr;        ///< Source file name.
+    const char* functionNamePtr;    ///< Function name.
+    const char* formatPtr;          ///< Format string, or NULL if the message is already formatted.
+}
+RecordHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest record, in bytes.  Writers always reserve this much contiguous space.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_RECORD_BYTES        (ALIGN_UP(sizeof(RecordHeader_t)) + MAX_ARGS_BYTES)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A thread's ring buffer.
+ *
+ * The head and tail are byte counts that only ever increase.  Only the owning thread writes the
+ * head and only the consumer holding DrainMutex writes the tail.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct Ring
+{
+    le_dls_Link_t link;                                     ///< Link in the RingList.
+    size_t head;                                            ///< Bytes ever written.
+    size_t tail;                                            ///< Bytes ever consumed.
+    size_t dropCount;                                       ///< Messages dropped since last report.
+    bool isOrphan;                                          ///< true if the thread has died.
+    size_t drainHead;                                       ///< Head when the snapshot was taken.
+    struct Ring* drainNextPtr;                              ///< Next ring in the snapshot.
+    const char* threadNameSrcPtr;                           ///< Name the threadName was copied from.
+    char threadName[LIMIT_MAX_THREAD_NAME_BYTES];           ///< Name of the owning thread.
+    uint8_t data[RING_BYTES] __attribute__((aligned(RECORD_ALIGN)));  ///< Record storage.
+}
+Ring_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Type of argument consumed by a conversion specification.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    ARG_NONE,           ///< No argument (%%).
+    ARG_ERRNO,          ///< No argument, uses errno (%m).
+    ARG_INT,            ///< int (or anything promoted to int).
+    ARG_LONG,           ///< long.
+    ARG_LLONG,          ///< long long.
+    ARG_INTMAX,         ///< intmax_t.
+    ARG_SIZE,           ///< size_t.
+    ARG_PTRDIFF,        ///< ptrdiff_t.
+    ARG_DOUBLE,         ///< double (or float, promoted).
+    ARG_LDOUBLE,        ///< long double.
+    ARG_PTR,            ///< void*.
+    ARG_STR,            ///< const char*.
+    ARG_UNSUPPORTED     ///< Can't be captured; the message must be formatted right away.
+}
+ArgType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A parsed conversion specification.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t len;             ///< Number of characters, from the '%' to the conversion character.
+    bool widthStar;         ///< true if the width is given by an int argument.
+    bool precisionStar;     ///< true if the precision is given by an int argument.
+    int precision;          ///< Precision given in the format string (-1 if none or '*').
+    ArgType_t type;         ///< Type of the value argument.
+}
+ConvSpec_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of all the ring buffers (Ring_t objects), including those of threads that have died but
+ * whose records haven't all been output yet.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t RingList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex used to protect the RingList.  Never held while outputting messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t RingListMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex used to serialize the consumers of the rings.  Recursive so that logRing_Flush() can be
+ * called from an atexit() handler while flushing.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t DrainMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of nested calls to Drain() in progress.  Only accessed with DrainMutex locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static int DrainDepth;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key used to find the calling thread's ring buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_key_t RingKey;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Next record sequence number.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t NextSeq;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true once the flusher thread has been started in this process.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FlusherRunning;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true while the flusher is sleeping because it had nothing to flush.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FlusherIdle;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if a full-ish ring buffer has already posted FlusherSem since the flusher last woke up.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FlusherKicked;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Semaphore used to wake up the flusher thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static sem_t FlusherSem;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parses the conversion specification that starts at a given '%'.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ParseConvSpec
+(
+    const char* specPtr,        ///< [IN] Pointer to the '%'.
+    ConvSpec_t* convPtr         ///< [OUT] Parsed specification.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    enum { LEN_NONE, LEN_L, LEN_LL, LEN_J, LEN_Z, LEN_T, LEN_BIG_L } length = LEN_NONE;
+    const char* charPtr = specPtr + 1;
+
+    convPtr->widthStar = false;
+    convPtr->precisionStar = false;
+    convPtr->precision = -1;
+
+    // Flags.
+    while ((*charPtr != '\0') && (strchr("-+ #0'I", *charPtr) != NULL))
+    {
+        charPtr++;
+    }
+
+    // Width.
+    if (*charPtr == '*')
+    {
+        convPtr->widthStar = true;
+        charPtr++;
+    }
+    else
+    {
+        while (isdigit((unsigned char)*charPtr))
+        {
+            charPtr++;
+        }
+    }
+
+    // Precision.
+    if (*charPtr == '.')
+    {
+        charPtr++;
+
+        if (*charPtr == '*')
+        {
+            convPtr->precisionStar = true;
+            charPtr++;
+        }
+        else
+        {
+            convPtr->precision = 0;
+
+            while (isdigit((unsigned char)*charPtr))
+            {
+                if (convPtr->precision < LOG_MAX_MSG_SIZE)
+                {
+                    convPtr->precision = (convPtr->precision * 10) + (*charPtr - '0');
+                }
+                charPtr++;
+            }
+        }
+    }
+
+    // Length modifier.
+    switch (*charPtr)
+    {
+        case 'h':
+            charPtr++;
+            if (*charPtr == 'h')
+            {
+                charPtr++;
+            }
+            break;
+
+        case 'l':
+            charPtr++;
+            if (*charPtr == 'l')
+            {
+                length = LEN_LL;
+                charPtr++;
+            }
+            else
+            {
+                length = LEN_L;
+            }
+            break;
+
+        case 'q':
+            length = LEN_LL;
+            charPtr++;
+            break;
+
+        case 'j':
+            length = LEN_J;
+            charPtr++;
+            break;
+
+        case 'z':
+        case 'Z':
+            length = LEN_Z;
+            charPtr++;
+            break;
+
+        case 't':
+            length = LEN_T;
+            charPtr++;
+            break;
+
+        case 'L':
+            length = LEN_BIG_L;
+            charPtr++;
+            break;
+    }
+
+    // Conversion.
+    switch (*charPtr)
+    {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            switch (length)
+            {
+                case LEN_L:     convPtr->type = ARG_LONG;       break;
+                case LEN_LL:    convPtr->type = ARG_LLONG;      break;
+                case LEN_BIG_L: convPtr->type = ARG_LLONG;      break;
+                case LEN_J:     convPtr->type = ARG_INTMAX;     break;
+                case LEN_Z:     convPtr->type = ARG_SIZE;       break;
+                case LEN_T:     convPtr->type = ARG_PTRDIFF;    break;
+                default:        convPtr->type = ARG_INT;        break;
+            }
+            break;
+
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            convPtr->type = (length == LEN_BIG_L) ? ARG_LDOUBLE : ARG_DOUBLE;
+            break;
+
+        case 'c':
+            convPtr->type = (length == LEN_L) ? ARG_UNSUPPORTED : ARG_INT;
+            break;
+
+        case 's':
+            convPtr->type = (length == LEN_L) ? ARG_UNSUPPORTED : ARG_STR;
+            break;
+
+        case 'p':
+            convPtr->type = ARG_PTR;
+            break;
+
+        case 'm':
+            convPtr->type = ARG_ERRNO;
+            break;
+
+        case '%':
+            convPtr->type = ARG_NONE;
+            break;
+
+        default:
+            // %n, positional arguments ('$'), wide characters, and malformed specifications.
+            convPtr->type = ARG_UNSUPPORTED;
+            break;
+    }
+
+    if (*charPtr != '\0')
+    {
+        charPtr++;
+    }
+
+    convPtr->len = charPtr - specPtr;
+
+    // Leave room to replace the '*'s with numbers.
+    if (convPtr->len > (MAX_SPEC_BYTES - 24))
+    {
+        convPtr->type = ARG_UNSUPPORTED;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Appends a value to a record's arguments area.
+ *
+ * @return true if it fit, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool PutValue
+(
+    uint8_t* bufPtr,            ///< [IN] Arguments area.
+    size_t* usedPtr,            ///< [IN/OUT] Bytes already used in the arguments area.
+    const void* valuePtr,       ///< [IN] Value.
+    size_t valueSize            ///< [IN] Size of the value.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((*usedPtr + ALIGN_UP(valueSize)) > MAX_ARGS_BYTES)
+    {
+        return false;
+    }
+
+    memcpy(bufPtr + *usedPtr, valuePtr, valueSize);
+    *usedPtr += ALIGN_UP(valueSize);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the arguments of a format string into a record's arguments area.
+ *
+ * Copies a value for each argument the format consumes, in order.  Strings are stored as a
+ * uint32_t length followed by the characters.
+ *
+ * @return true if successful, false if the arguments don't fit or can't be captured.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool EncodeArgs
+(
+    const char* formatPtr,      ///< [IN] Format string.
+    va_list args,               ///< [IN] Arguments.
+    uint8_t* bufPtr,            ///< [OUT] Arguments area (MAX_ARGS_BYTES long).
+    size_t* usedPtr             ///< [OUT] Number of bytes used in the arguments area.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* specPtr = formatPtr;
+    size_t used = 0;
+    ConvSpec_t conv;
+
+#define PUT(type) \
+    do { type value = va_arg(args, type); \
+         if (!PutValue(bufPtr, &used, &value, sizeof(value))) { return false; } } while (0)
+
+    while ((specPtr = strchr(specPtr, '%')) != NULL)
+    {
+        ParseConvSpec(specPtr, &conv);
+        specPtr += conv.len;
+
+        int precision = conv.precision;
+
+        if (conv.type == ARG_UNSUPPORTED)
+        {
+            return false;
+        }
+
+        if (conv.widthStar)
+        {
+            PUT(int);
+        }
+
+        if (conv.precisionStar)
+        {
+            precision = va_arg(args, int);
+            if (!PutValue(bufPtr, &used, &precision, sizeof(precision)))
+            {
+                return false;
+            }
+        }
+
+        switch (conv.type)
+        {
+            case ARG_INT:       PUT(int);           break;
+            case ARG_LONG:      PUT(long);          break;
+            case ARG_LLONG:     PUT(long long);     break;
+            case ARG_INTMAX:    PUT(intmax_t);      break;
+            case ARG_SIZE:      PUT(size_t);        break;
+            case ARG_PTRDIFF:   PUT(ptrdiff_t);     break;
+            case ARG_DOUBLE:    PUT(double);        break;
+            case ARG_LDOUBLE:   PUT(long double);   break;
+            case ARG_PTR:       PUT(void*);         break;
+
+            case ARG_STR:
+            {
+                const char* strPtr = va_arg(args, const char*);
+                uint32_t len = NULL_STRING_LEN;
+
+                if (strPtr != NULL)
+                {
+                    // Don't read past the precision: the string doesn't have to be terminated.
+                    size_t maxLen = LOG_MAX_MSG_SIZE - 1;
+                    if ((precision >= 0) && ((size_t)precision < maxLen))
+                    {
+                        maxLen = precision;
+                    }
+                    len = strnlen(strPtr, maxLen);
+                }
+
+                if (!PutValue(bufPtr, &used, &len, sizeof(len)))
+                {
+                    return false;
+                }
+
+                if (strPtr != NULL)
+                {
+                    if ((used + len + 1) > MAX_ARGS_BYTES)
+                    {
+                        return false;
+                    }
+                    memcpy(bufPtr + used, strPtr, len);
+                    bufPtr[used + len] = '\0';
+                    used += ALIGN_UP(len + 1);
+                }
+                break;
+            }
+
+            default:
+                // ARG_NONE and ARG_ERRNO don't consume an argument.
+                break;
+        }
+    }
+
+#undef PUT
+
+    *usedPtr = used;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats a record's message from its format string and arguments area.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DecodeArgs
+(
+    const char* formatPtr,      ///< [IN] Format string.
+    const uint8_t* bufPtr,      ///< [IN] Arguments area.
+    int savedErrno,             ///< [IN] errno value to use for %m.
+    char* msgPtr,               ///< [OUT] Buffer for the message.
+    size_t msgSize              ///< [IN] Size of the buffer.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* textPtr = formatPtr;
+    size_t pos = 0;
+    size_t used = 0;
+    ConvSpec_t conv;
+
+#define GET(type, var) \
+    type var; memcpy(&var, bufPtr + used, sizeof(var)); used += ALIGN_UP(sizeof(var))
+
+#define EMIT(value) \
+    snprintf(msgPtr + pos, msgSize - pos, spec, value)
+
+    msgPtr[0] = '\0';
+
+    while ((*textPtr != '\0') && (pos < (msgSize - 1)))
+    {
+        const char* specPtr = strchr(textPtr, '%');
+        size_t literalLen = (specPtr != NULL) ? (size_t)(specPtr - textPtr) : strlen(textPtr);
+
+        // Copy the literal text up to the next conversion specification.
+        if (literalLen > (msgSize - 1 - pos))
+        {
+            literalLen = msgSize - 1 - pos;
+        }
+        memcpy(msgPtr + pos, textPtr, literalLen);
+        pos += literalLen;
+        msgPtr[pos] = '\0';
+
+        if ((specPtr == NULL) || (pos >= (msgSize - 1)))
+        {
+            break;
+        }
+
+        ParseConvSpec(specPtr, &conv);
+        textPtr = specPtr + conv.len;
+
+        // Rebuild the specification with the '*'s replaced by their values.
+        char spec[MAX_SPEC_BYTES];
+        size_t specLen = 0;
+        size_t i;
+
+        for (i = 0; i < conv.len; i++)
+        {
+            if (specPtr[i] != '*')
+            {
+                spec[specLen++] = specPtr[i];
+            }
+            else
+            {
+                GET(int, starValue);
+
+                if ((i > 0) && (specPtr[i - 1] == '.') && (starValue < 0))
+                {
+                    // A negative precision is taken as if the precision were omitted.
+                    specLen--;
+                }
+                else
+                {
+                    specLen += snprintf(spec + specLen, sizeof(spec) - specLen, "%d", starValue);
+                }
+            }
+        }
+        spec[specLen] = '\0';
+
+        int count = 0;
+
+        switch (conv.type)
+        {
+            case ARG_INT:       { GET(int, v);          count = EMIT(v); break; }
+            case ARG_LONG:      { GET(long, v);         count = EMIT(v); break; }
+            case ARG_LLONG:     { GET(long long, v);    count = EMIT(v); break; }
+            case ARG_INTMAX:    { GET(intmax_t, v);     count = EMIT(v); break; }
+            case ARG_SIZE:      { GET(size_t, v);       count = EMIT(v); break; }
+            case ARG_PTRDIFF:   { GET(ptrdiff_t, v);    count = EMIT(v); break; }
+            case ARG_DOUBLE:    { GET(double, v);       count = EMIT(v); break; }
+            case ARG_LDOUBLE:   { GET(long double, v);  count = EMIT(v); break; }
+            case ARG_PTR:       { GET(void*, v);        count = EMIT(v); break; }
+
+            case ARG_STR:
+            {
+                GET(uint32_t, len);
+
+                if (len == NULL_STRING_LEN)
+                {
+                    count = EMIT((const char*)NULL);
+                }
+                else
+                {
+                    count = EMIT((const char*)(bufPtr + used));
+                    used += ALIGN_UP(len + 1);
+                }
+                break;
+            }
+
+            case ARG_ERRNO:
+                // Output strerror()'s string in place of %m, with the same flags and width.
+                spec[specLen - 1] = 's';
+                count = EMIT(strerror(savedErrno));
+                break;
+
+            default:
+                // %%
+                msgPtr[pos] = '%';
+                msgPtr[pos + 1] = '\0';
+                count = 1;
+                break;
+        }
+
+        if (count > 0)
+        {
+            pos += count;
+        }
+
+        if (pos >= msgSize)
+        {
+            pos = msgSize - 1;
+        }
+    }
+
+#undef GET
+#undef EMIT
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the oldest record in a ring, skipping the unused space at the end of the ring if needed.
+ * Must be called by the consumer, with the DrainMutex locked.
+ *
+ * @return Pointer to the record, or NULL if there are no records before the given head.
+ */
+//--------------------------------------------------------------------------------------------------
+static RecordHeader_t* PeekRecord
+(
+    Ring_t* ringPtr,
+    size_t head             ///< Head of the ring, loaded with acquire ordering.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while (ringPtr->tail != head)
+    {
+        size_t pos = ringPtr->tail & (RING_BYTES - 1);
+        RecordHeader_t* recPtr = (RecordHeader_t*)(ringPtr->data + pos);
+
+        if (*((uint32_t*)recPtr) != 0)
+        {
+            return recPtr;
+        }
+
+        // Wrap marker.
+        __atomic_store_n(&ringPtr->tail, ringPtr->tail + (RING_BYTES - pos), __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats and outputs a record.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OutputRecord
+(
+    Ring_t* ringPtr,
+    const RecordHeader_t* recPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const uint8_t* argsPtr = (const uint8_t*)recPtr + ALIGN_UP(sizeof(RecordHeader_t));
+    char msg[LOG_MAX_MSG_SIZE];
+    const char* msgPtr = (const char*)argsPtr;
+
+    if (recPtr->formatPtr != NULL)
+    {
+        DecodeArgs(recPtr->formatPtr, argsPtr, recPtr->savedErrno, msg, sizeof(msg));
+        msgPtr = msg;
+    }
+
+    log_EmitMsg(recPtr->level,
+                recPtr->levelPtr,
+                recPtr->compNamePtr,
+                ringPtr->threadName,
+                recPtr->filenamePtr,
+                recPtr->functionNamePtr,
+                recPtr->lineNumber,
+                recPtr->timestamp,
+                msgPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes a snapshot of the rings: links all the rings in the RingList through their drainNextPtr
+ * and records their heads.  The RingList is only locked while doing this.
+ *
+ * @return The first ring in the snapshot, or NULL if there are no rings.
+ */
+//--------------------------------------------------------------------------------------------------
+static Ring_t* TakeSnapshot
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Ring_t* firstPtr = NULL;
+    Ring_t** nextPtrPtr = &firstPtr;
+
+    LE_ASSERT(pthread_mutex_lock(&RingListMutex) == 0);
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&RingList);
+    while (linkPtr != NULL)
+    {
+        Ring_t* ringPtr = CONTAINER_OF(linkPtr, Ring_t, link);
+
+        ringPtr->drainHead = __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE);
+        *nextPtrPtr = ringPtr;
+        nextPtrPtr = &ringPtr->drainNextPtr;
+
+        linkPtr = le_dls_PeekNext(&RingList, linkPtr);
+    }
+
+    *nextPtrPtr = NULL;
+
+    LE_ASSERT(pthread_mutex_unlock(&RingListMutex) == 0);
+
+    return firstPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Outputs all the records in a snapshot of all the rings, merged in sequence order, then reports
+ * dropped messages and frees the rings of dead threads.
+ *
+ * @return The number of records output.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t Drain
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t count = 0;
+    Ring_t* ringPtr;
+
+    LE_ASSERT(pthread_mutex_lock(&DrainMutex) == 0);
+    DrainDepth++;
+
+    Ring_t* firstPtr = TakeSnapshot();
+
+    for (;;)
+    {
+        Ring_t* oldestRingPtr = NULL;
+        RecordHeader_t* oldestRecPtr = NULL;
+
+        for (ringPtr = firstPtr; ringPtr != NULL; ringPtr = ringPtr->drainNextPtr)
+        {
+            RecordHeader_t* recPtr = PeekRecord(ringPtr, ringPtr->drainHead);
+
+            if ((recPtr != NULL) && ((oldestRecPtr == NULL) || (recPtr->seq < oldestRecPtr->seq)))
+            {
+                oldestRingPtr = ringPtr;
+                oldestRecPtr = recPtr;
+            }
+        }
+
+        if (oldestRecPtr == NULL)
+        {
+            break;
+        }
+
+        OutputRecord(oldestRingPtr, oldestRecPtr);
+        count++;
+
+        __atomic_store_n(&oldestRingPtr->tail,
+                         oldestRingPtr->tail + oldestRecPtr->size,
+                         __ATOMIC_RELEASE);
+    }
+
+    ringPtr = firstPtr;
+    while (ringPtr != NULL)
+    {
+        Ring_t* nextPtr = ringPtr->drainNextPtr;
+
+        size_t dropCount = __atomic_exchange_n(&ringPtr->dropCount, 0, __ATOMIC_RELAXED);
+        if (dropCount > 0)
+        {
+            char msg[LOG_MAX_MSG_SIZE];
+
+            snprintf(msg, sizeof(msg), "%zu log messages were dropped (ring buffer full).",
+                     dropCount);
+            log_EmitMsg(LE_LOG_WARN, NULL, "framework", ringPtr->threadName, __FILE__,
+                        __func__, __LINE__, time(NULL), msg);
+        }
+
+        // The owner sets isOrphan after its last write, so check it before checking for records.
+        // A nested call mustn't free rings that the outer call is still using.
+        if (   (DrainDepth == 1)
+            && __atomic_load_n(&ringPtr->isOrphan, __ATOMIC_ACQUIRE)
+            && (PeekRecord(ringPtr, __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE)) == NULL) )
+        {
+            LE_ASSERT(pthread_mutex_lock(&RingListMutex) == 0);
+            le_dls_Remove(&RingList, &ringPtr->link);
+            LE_ASSERT(pthread_mutex_unlock(&RingListMutex) == 0);
+            free(ringPtr);
+        }
+
+        ringPtr = nextPtr;
+    }
+
+    DrainDepth--;
+    LE_ASSERT(pthread_mutex_unlock(&DrainMutex) == 0);
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the flusher thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* FlusherMain
+(
+    void* unusedPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    (void)unusedPtr;
+
+    bool wasBusy = true;
+
+    for (;;)
+    {
+        struct timespec deadline;
+        long intervalMs = wasBusy ? FLUSH_INTERVAL_MS : IDLE_INTERVAL_MS;
+
+        if (!wasBusy)
+        {
+            __atomic_store_n(&FlusherIdle, true, __ATOMIC_RELAXED);
+        }
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += intervalMs / 1000;
+        deadline.tv_nsec += (intervalMs % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        // Time-outs and interruptions are normal; just flush.
+        (void)sem_timedwait(&FlusherSem, &deadline);
+
+        __atomic_store_n(&FlusherIdle, false, __ATOMIC_RELAXED);
+        __atomic_store_n(&FlusherKicked, false, __ATOMIC_RELAXED);
+
+        wasBusy = (Drain() > 0);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts the flusher thread if it isn't running yet in this process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartFlusher
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(pthread_mutex_lock(&RingListMutex) == 0);
+
+    if (!FlusherRunning)
+    {
+        pthread_t thread;
+        pthread_attr_t attr;
+        sigset_t allSignals;
+        sigset_t oldSignals;
+
+        // The flusher must never run signal handlers, so create it with all signals blocked.
+        sigfillset(&allSignals);
+        LE_ASSERT(pthread_sigmask(SIG_SETMASK, &allSignals, &oldSignals) == 0);
+
+        LE_ASSERT(pthread_attr_init(&attr) == 0);
+        LE_ASSERT(pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) == 0);
+
+        if (pthread_create(&thread, &attr, FlusherMain, NULL) == 0)
+        {
+            FlusherRunning = true;
+        }
+
+        pthread_attr_destroy(&attr);
+        LE_ASSERT(pthread_sigmask(SIG_SETMASK, &oldSignals, NULL) == 0);
+    }
+
+    LE_ASSERT(pthread_mutex_unlock(&RingListMutex) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor for the calling thread's ring, called when the thread dies.  The ring is freed by
+ * the flusher once its records have been output.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RingDestructor
+(
+    void* ringPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    __atomic_store_n(&((Ring_t*)ringPtr)->isOrphan, true, __ATOMIC_RELEASE);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the calling thread's ring, creating it if needed.
+ *
+ * @return Pointer to the ring, or NULL if out of memory.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline Ring_t* GetRing
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Ring_t* ringPtr = pthread_getspecific(RingKey);
+
+    if (ringPtr == NULL)
+    {
+        ringPtr = calloc(1, sizeof(Ring_t));
+
+        if (ringPtr == NULL)
+        {
+            return NULL;
+        }
+
+        ringPtr->link = LE_DLS_LINK_INIT;
+
+        LE_ASSERT(pthread_mutex_lock(&RingListMutex) == 0);
+        le_dls_Queue(&RingList, &ringPtr->link);
+        LE_ASSERT(pthread_mutex_unlock(&RingListMutex) == 0);
+
+        LE_ASSERT(pthread_setspecific(RingKey, ringPtr) == 0);
+    }
+
+    if (!__atomic_load_n(&FlusherRunning, __ATOMIC_RELAXED))
+    {
+        StartFlusher();
+    }
+
+    return ringPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called in the parent process before it forks.  Stops the RingList from changing.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrepareFork
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(pthread_mutex_lock(&RingListMutex) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called in the parent process after it forks.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ParentAfterFork
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(pthread_mutex_unlock(&RingListMutex) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called in the child process after a fork.  Only the forking thread exists in the child, and the
+ * records in the rings belong to the parent, so discard them all and forget the other threads.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ChildAfterFork
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Ring_t* myRingPtr = pthread_getspecific(RingKey);
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&RingList);
+    while (linkPtr != NULL)
+    {
+        Ring_t* ringPtr = CONTAINER_OF(linkPtr, Ring_t, link);
+        linkPtr = le_dls_PeekNext(&RingList, linkPtr);
+
+        if (ringPtr == myRingPtr)
+        {
+            ringPtr->tail = ringPtr->head;
+            ringPtr->dropCount = 0;
+        }
+        else
+        {
+            le_dls_Remove(&RingList, &ringPtr->link);
+            free(ringPtr);
+        }
+    }
+
+    FlusherRunning = false;
+    FlusherIdle = false;
+    FlusherKicked = false;
+    LE_ASSERT(sem_init(&FlusherSem, 0, 0) == 0);
+
+    // The mutexes may be owned by the parent's threads, so they can't be unlocked here.
+    pthread_mutex_t unlockedMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+    RingListMutex = unlockedMutex;
+    DrainMutex = unlockedMutex;
+    DrainDepth = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flushes the rings when the process exits.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushAtExit
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    logRing_Flush();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the binary logging module.  Must be called only once, by log_Init(), and only if
+ * binary logging mode has been enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(pthread_key_create(&RingKey, RingDestructor) == 0);
+    LE_ASSERT(sem_init(&FlusherSem, 0, 0) == 0);
+    LE_ASSERT(pthread_atfork(PrepareFork, ParentAfterFork, ChildAfterFork) == 0);
+    LE_ASSERT(atexit(FlushAtExit) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records a log message in the calling thread's ring buffer, to be formatted and output later by
+ * the flusher thread.
+ *
+ * The level string, component name, file name, function name and format string are kept by
+ * reference, so they must remain valid for the life of the process.  Everything the format's
+ * conversion specifications refer to (including strings) is copied.
+ *
+ * If the ring buffer is full, the message is dropped, and a count of dropped messages is logged
+ * later.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Write
+(
+    le_log_Level_t level,               ///< [IN] Severity level (-1 if this is a trace message).
+    const char* levelPtr,               ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,            ///< [IN] Component name.
+    const char* filenamePtr,            ///< [IN] Source file name (full path).
+    const char* functionNamePtr,        ///< [IN] Function name.
+    unsigned int lineNumber,            ///< [IN] Source line number.
+    int savedErrno,                     ///< [IN] errno value to use for %m.
+    const char* formatPtr,              ///< [IN] printf-style format string.
+    va_list args                        ///< [IN] Arguments for the format string.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Ring_t* ringPtr = GetRing();
+
+    if (ringPtr == NULL)
+    {
+        return;
+    }
+
+    // Reserve MAX_RECORD_BYTES of contiguous space, wrapping to the start of the ring if needed.
+    size_t head = ringPtr->head;
+    size_t tail = __atomic_load_n(&ringPtr->tail, __ATOMIC_ACQUIRE);
+    size_t pos = head & (RING_BYTES - 1);
+    size_t toEnd = RING_BYTES - pos;
+    size_t needed = (toEnd < MAX_RECORD_BYTES) ? (toEnd + MAX_RECORD_BYTES) : MAX_RECORD_BYTES;
+
+    if ((RING_BYTES - (head - tail)) < needed)
+    {
+        __atomic_fetch_add(&ringPtr->dropCount, 1, __ATOMIC_RELAXED);
+        if (!__atomic_exchange_n(&FlusherKicked, true, __ATOMIC_RELAXED))
+        {
+            sem_post(&FlusherSem);
+        }
+        return;
+    }
+
+    if (toEnd < MAX_RECORD_BYTES)
+    {
+        *((uint32_t*)(ringPtr->data + pos)) = 0;
+        head += toEnd;
+        pos = 0;
+    }
+
+    // The thread name rarely changes, so only copy it when it does.
+    const char* threadNamePtr = le_thread_GetMyName();
+    if (threadNamePtr != ringPtr->threadNameSrcPtr)
+    {
+        le_utf8_Copy(ringPtr->threadName, threadNamePtr, sizeof(ringPtr->threadName), NULL);
+        ringPtr->threadNameSrcPtr = threadNamePtr;
+    }
+
+    RecordHeader_t* recPtr = (RecordHeader_t*)(ringPtr->data + pos);
+    uint8_t* argsPtr = ringPtr->data + pos + ALIGN_UP(sizeof(RecordHeader_t));
+    size_t argsSize;
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME_COARSE, &now);
+
+    recPtr->lineNumber = lineNumber;
+    recPtr->level = level;
+    recPtr->savedErrno = savedErrno;
+    recPtr->timestamp = now.tv_sec;
+    recPtr->levelPtr = levelPtr;
+    recPtr->compNamePtr = compNamePtr;
+    recPtr->filenamePtr = filenamePtr;
+    recPtr->functionNamePtr = functionNamePtr;
+    recPtr->formatPtr = formatPtr;
+
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    bool isEncoded = EncodeArgs(formatPtr, argsCopy, argsPtr, &argsSize);
+    va_end(argsCopy);
+
+    if (!isEncoded)
+    {
+        // Format the message now instead.
+        errno = savedErrno;
+        int len = vsnprintf((char*)argsPtr, MAX_ARGS_BYTES, formatPtr, args);
+        if (len < 0)
+        {
+            len = 0;
+            argsPtr[0] = '\0';
+        }
+        else if (len >= MAX_ARGS_BYTES)
+        {
+            len = MAX_ARGS_BYTES - 1;
+        }
+        argsSize = len + 1;
+        recPtr->formatPtr = NULL;
+    }
+
+    recPtr->size = ALIGN_UP(sizeof(RecordHeader_t)) + ALIGN_UP(argsSize);
+    recPtr->seq = __atomic_fetch_add(&NextSeq, 1, __ATOMIC_RELAXED);
+
+    head += recPtr->size;
+    __atomic_store_n(&ringPtr->head, head, __ATOMIC_RELEASE);
+
+    // Wake up the flusher if it's sleeping with nothing to do, or if this ring is filling up.
+    if (__atomic_load_n(&FlusherIdle, __ATOMIC_RELAXED))
+    {
+        if (__atomic_exchange_n(&FlusherIdle, false, __ATOMIC_RELAXED))
+        {
+            sem_post(&FlusherSem);
+        }
+    }
+    else if (((head - tail) > (RING_BYTES / 2))
+             && !__atomic_load_n(&FlusherKicked, __ATOMIC_RELAXED)
+             && !__atomic_exchange_n(&FlusherKicked, true, __ATOMIC_RELAXED))
+    {
+        sem_post(&FlusherSem);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats and outputs all the messages that have been recorded so far, by all threads, before
+ * returning.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Flush
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Drain();
+}
@@ -0,0 +1,68 @@
+/** @file logRing.h
+ *
+ * Binary logging module's intra-framework header file.
+ *
+ * In binary logging mode, a thread that logs a message doesn't format or output it.  Instead, it
+ * copies the format string pointer and the raw values of the arguments into its own ring buffer,
+ * and a background "flusher" thread formats and outputs the messages later, in the order in which
+ * they were logged.  See logRing.c for details.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LOG_RING_INCLUDE_GUARD
+#define LOG_RING_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the binary logging module.  Must be called only once, by log_Init(), and only if
+ * binary logging mode has been enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records a log message in the calling thread's ring buffer, to be formatted and output later by
+ * the flusher thread.
+ *
+ * The level string, component name, file name, function name and format string are kept by
+ * reference, so they must remain valid for the life of the process.  Everything the format's
+ * conversion specifications refer to (including strings) is copied.
+ *
+ * If the ring buffer is full, the message is dropped, and a count of dropped messages is logged
+ * later.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Write
+(
+    le_log_Level_t level,               ///< [IN] Severity level (-1 if this is a trace message).
+    const char* levelPtr,               ///< [IN] Severity level string or trace keyword.
+    const char* compNamePtr,            ///< [IN] Component name.
+    const char* filenamePtr,            ///< [IN] Source file name (full path).
+    const char* functionNamePtr,        ///< [IN] Function name.
+    unsigned int lineNumber,            ///< [IN] Source line number.
+    int savedErrno,                     ///< [IN] errno value to use for %m.
+    const char* formatPtr,              ///< [IN] printf-style format string.
+    va_list args                        ///< [IN] Arguments for the format string.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats and outputs all the messages that have been recorded so far, by all threads, before
+ * returning.
+ */
+//--------------------------------------------------------------------------------------------------
+void logRing_Flush
+(
+    void
+);
+
+
+#endif // LOG_RING_INCLUDE_GUARD
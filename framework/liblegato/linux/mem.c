@@ -39,6 +39,33 @@
  * is unlikely to occur in normal data.  Whenever a block is allocated or released, the
  * guard bands are checked for corruption and any corruption is reported.
  *
+ * THREAD CACHES
+ * =============
+ *
+ * To keep threads from serializing on the module's mutex, each thread keeps a small cache of free
+ * blocks for the pools it uses most recently (enabled by the "USE_THREAD_CACHE" macro).  The cache
+ * is direct-mapped: a pool hashes to exactly one slot, and a slot holds up to
+ * THREAD_CACHE_MAX_BLOCKS free blocks from one pool.  Allocations are served from the slot and
+ * releases are pushed onto it, touching only the thread's own cache lock, which is uncontended.
+ * The module's mutex is only taken to refill an empty slot or to return a batch of blocks to the
+ * pool's shared free list when a slot is full or is taken over by another pool.
+ *
+ * Blocks in a thread cache are free, so they are not counted as "in use" in the pool statistics.
+ * The counters in the pool object are updated with atomic operations, which keeps them accurate
+ * (and readable by the Inspect tool) without taking the mutex.  If a pool's shared free list is
+ * empty when an allocation that can't expand the pool is attempted (le_mem_TryAlloc() and
+ * le_mem_AssertAlloc()), blocks are reclaimed from all thread caches before the allocation fails,
+ * so fixed-size pools never run out while blocks are sitting idle in another thread's cache.
+ * le_mem_ForceAlloc() expands the pool instead, so that allocating from a growing pool doesn't
+ * lock every thread's cache each time; the pool may then hold up to THREAD_CACHE_MAX_BLOCKS more
+ * blocks per thread than it would without the caches.  Blocks are also reclaimed before a
+ * super-pool is expanded to create or expand one of its sub-pools, which is rare.
+ *
+ * Sub-pools are never cached, because their blocks must all be on the sub-pool's free list when
+ * the sub-pool is deleted.
+ *
+ * A thread's cache is flushed back to the pools when the thread exits.
+ *
  * Copyright (C) Sierra Wireless Inc.
  *
  */
@@ -49,6 +76,10 @@
 #define USE_GUARD_BAND
 #define FILL_DELETED_AND_CHECK_ALLOCATED
 
+#ifndef LE_MEM_VALGRIND
+    #define USE_THREAD_CACHE
+#endif
+
 #define NUM_GUARD_BAND_WORDS 8
 #define GUARD_WORD ((uint32_t)0xDEADBEEF)
 #define GUARD_BAND_SIZE (sizeof(GUARD_WORD) * NUM_GUARD_BAND_WORDS)
@@ -71,6 +102,30 @@
 #define DEFAULT_NUM_BLOCKS_TO_FORCE     1
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of slots in each thread's block cache.  Must be a power of two.
+ */
+//--------------------------------------------------------------------------------------------------
+#define THREAD_CACHE_NUM_SLOTS          16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of free blocks held in a single thread cache slot.
+ */
+//--------------------------------------------------------------------------------------------------
+#define THREAD_CACHE_MAX_BLOCKS         16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of blocks moved between a thread cache slot and its pool's shared free list at a time.
+ */
+//--------------------------------------------------------------------------------------------------
+#define THREAD_CACHE_BATCH_SIZE         (THREAD_CACHE_MAX_BLOCKS / 2)
+
+
 #ifdef LE_MEM_TRACE
     #undef le_mem_TryAlloc
     #undef le_mem_AssertAlloc
@@ -143,6 +198,64 @@ static le_mem_PoolRef_t SubPoolsPool;
 static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;
 
 
+#ifdef USE_THREAD_CACHE
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A slot in a thread's block cache.  Holds free blocks belonging to a single pool.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    MemPool_t*      poolPtr;        ///< Pool the cached blocks belong to (NULL if slot unused).
+    le_sls_List_t   freeList;       ///< Free blocks cached for the pool.
+    size_t          numBlocks;      ///< Number of blocks on the free list.
+}
+CacheSlot_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A thread's block cache.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t   link;           ///< Link in the list of all thread caches.
+    pthread_mutex_t mutex;          ///< Protects the slots.  Normally only taken by the owning
+                                    ///  thread, so it is uncontended except while blocks are
+                                    ///  being reclaimed by another thread.
+    CacheSlot_t     slots[THREAD_CACHE_NUM_SLOTS];  ///< The cache slots.
+}
+ThreadCache_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of all thread caches in the process.  Protected by the module's mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t ThreadCacheList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key under which a pointer to the thread's cache (ThreadCache_t) is kept in thread-local storage.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_key_t ThreadCacheKey;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true once ThreadCacheKey has been created by mem_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ThreadCacheReady = false;
+
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Exposing the memory pool list; mainly for the Inspect tool.
@@ -280,6 +393,357 @@ static inline void Unlock
 #endif
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adjusts the number of blocks in use in a pool, updating the maximum if needed.
+ *
+ * @note
+ *      Does not need the mutex locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void AdjustBlocksInUse
+(
+    MemPool_t*  poolPtr,    ///< [IN] The pool.
+    ssize_t     delta       ///< [IN] Number of blocks to add to (or remove from) the in-use count.
+)
+{
+    size_t numInUse = __atomic_add_fetch(&poolPtr->numBlocksInUse, delta, __ATOMIC_RELAXED);
+
+    size_t maxUsed = __atomic_load_n(&poolPtr->maxNumBlocksUsed, __ATOMIC_RELAXED);
+    while (   (numInUse > maxUsed)
+           && !__atomic_compare_exchange_n(&poolPtr->maxNumBlocksUsed,
+                                           &maxUsed,
+                                           numInUse,
+                                           true,
+                                           __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED) )
+    {
+        // maxUsed was updated with the current value; try again.
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records the allocation of a block from a pool in the pool's statistics.
+ *
+ * @note
+ *      Does not need the mutex locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void CountAlloc
+(
+    MemPool_t* poolPtr      ///< [IN] The pool the block was allocated from.
+)
+{
+    __atomic_add_fetch(&poolPtr->numAllocations, 1, __ATOMIC_RELAXED);
+    AdjustBlocksInUse(poolPtr, 1);
+}
+
+
+#ifdef USE_THREAD_CACHE
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the slot that a given pool maps to in a thread cache.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline CacheSlot_t* GetCacheSlot
+(
+    ThreadCache_t*  cachePtr,   ///< [IN] The thread cache.
+    MemPool_t*      poolPtr     ///< [IN] The pool.
+)
+{
+    uintptr_t hash = (uintptr_t)poolPtr;
+    hash = (hash >> 4) ^ (hash >> 10);
+
+    return &(cachePtr->slots[hash & (THREAD_CACHE_NUM_SLOTS - 1)]);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves up to a given number of blocks from a cache slot back onto its pool's shared free list.
+ *
+ * @note
+ *      Assumes that both the module's mutex and the cache's mutex are locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushCacheSlot
+(
+    CacheSlot_t*    slotPtr,    ///< [IN] The slot to flush.
+    size_t          numBlocks   ///< [IN] Maximum number of blocks to move back to the pool.
+)
+{
+    while ((numBlocks > 0) && (slotPtr->numBlocks > 0))
+    {
+        le_sls_Stack(&(slotPtr->poolPtr->freeList), le_sls_Pop(&(slotPtr->freeList)));
+        slotPtr->numBlocks--;
+        numBlocks--;
+    }
+
+    if (slotPtr->numBlocks == 0)
+    {
+        slotPtr->poolPtr = NULL;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves all of a pool's blocks out of every thread cache and back onto the pool's free list.
+ *
+ * @note
+ *      Assumes that the module's mutex is locked and that the calling thread does not hold
+ *      its own cache's mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReclaimCachedBlocks
+(
+    MemPool_t* poolPtr      ///< [IN] The pool whose blocks are to be reclaimed.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&ThreadCacheList);
+
+    while (linkPtr != NULL)
+    {
+        ThreadCache_t* cachePtr = CONTAINER_OF(linkPtr, ThreadCache_t, link);
+        CacheSlot_t* slotPtr = GetCacheSlot(cachePtr, poolPtr);
+
+        LE_ASSERT(pthread_mutex_lock(&cachePtr->mutex) == 0);
+        if (slotPtr->poolPtr == poolPtr)
+        {
+            FlushCacheSlot(slotPtr, slotPtr->numBlocks);
+        }
+        LE_ASSERT(pthread_mutex_unlock(&cachePtr->mutex) == 0);
+
+        linkPtr = le_dls_PeekNext(&ThreadCacheList, linkPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread-local storage destructor for a thread cache.  Returns all cached blocks to their pools.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteThreadCache
+(
+    void* objPtr    ///< [IN] Pointer to the thread's cache.
+)
+{
+    ThreadCache_t* cachePtr = objPtr;
+    size_t i;
+
+    Lock();
+
+    LE_ASSERT(pthread_mutex_lock(&cachePtr->mutex) == 0);
+    for (i = 0; i < THREAD_CACHE_NUM_SLOTS; i++)
+    {
+        FlushCacheSlot(&(cachePtr->slots[i]), cachePtr->slots[i].numBlocks);
+    }
+    LE_ASSERT(pthread_mutex_unlock(&cachePtr->mutex) == 0);
+
+    le_dls_Remove(&ThreadCacheList, &(cachePtr->link));
+
+    Unlock();
+
+    pthread_mutex_destroy(&cachePtr->mutex);
+    free(cachePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the calling thread's block cache, creating it if necessary.
+ *
+ * @return  Pointer to the cache, or NULL if thread caches are not available yet.
+ *
+ * @note
+ *      Must be called without the mutex locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static ThreadCache_t* GetThreadCache
+(
+    void
+)
+{
+    if (!ThreadCacheReady)
+    {
+        return NULL;
+    }
+
+    ThreadCache_t* cachePtr = pthread_getspecific(ThreadCacheKey);
+
+    if (cachePtr == NULL)
+    {
+        // NOTE: This can't come from a memory pool, because it is needed to allocate from one.
+        cachePtr = calloc(1, sizeof(ThreadCache_t));
+        LE_ASSERT(cachePtr);
+
+        cachePtr->link = LE_DLS_LINK_INIT;
+        LE_ASSERT(pthread_mutex_init(&cachePtr->mutex, NULL) == 0);
+
+        Lock();
+        le_dls_Queue(&ThreadCacheList, &(cachePtr->link));
+        Unlock();
+
+        LE_ASSERT(pthread_setspecific(ThreadCacheKey, cachePtr) == 0);
+    }
+
+    return cachePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes a free block for a pool from the calling thread's cache.  If the cache is empty, it is
+ * refilled from the pool's shared free list, and if that is empty too, blocks can be reclaimed
+ * from the other threads' caches.
+ *
+ * @return  Pointer to the block, or NULL if the pool has no free blocks.
+ *
+ * @note
+ *      Must be called without the mutex locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static MemBlock_t* AllocFromCache
+(
+    ThreadCache_t*  cachePtr,   ///< [IN] The calling thread's cache.
+    MemPool_t*      poolPtr,    ///< [IN] The pool to allocate from.
+    bool            canReclaim  ///< [IN] true to reclaim blocks from other threads' caches if
+                                ///<      the pool's shared free list is empty.
+)
+{
+    CacheSlot_t* slotPtr = GetCacheSlot(cachePtr, poolPtr);
+    le_sls_Link_t* blockLinkPtr = NULL;
+
+    // Fast path: only touch our own cache.
+    LE_ASSERT(pthread_mutex_lock(&cachePtr->mutex) == 0);
+    if ((slotPtr->poolPtr == poolPtr) && (slotPtr->numBlocks > 0))
+    {
+        blockLinkPtr = le_sls_Pop(&(slotPtr->freeList));
+        slotPtr->numBlocks--;
+    }
+    LE_ASSERT(pthread_mutex_unlock(&cachePtr->mutex) == 0);
+
+    if (blockLinkPtr != NULL)
+    {
+        return CONTAINER_OF(blockLinkPtr, MemBlock_t, link);
+    }
+
+    // Slow path: refill the slot from the pool's shared free list.
+    Lock();
+
+    size_t numFree = le_sls_NumLinks(&(poolPtr->freeList));
+    if ((numFree == 0) && canReclaim)
+    {
+        // Some other thread may be sitting on free blocks.
+        ReclaimCachedBlocks(poolPtr);
+        numFree = le_sls_NumLinks(&(poolPtr->freeList));
+    }
+
+    LE_ASSERT(pthread_mutex_lock(&cachePtr->mutex) == 0);
+
+    blockLinkPtr = le_sls_Pop(&(poolPtr->freeList));
+
+    if (blockLinkPtr != NULL)
+    {
+        // Take no more than half of what's left, so other threads aren't starved.
+        size_t numToMove = (numFree - 1) / 2;
+        if (numToMove > THREAD_CACHE_BATCH_SIZE)
+        {
+            numToMove = THREAD_CACHE_BATCH_SIZE;
+        }
+
+        if ((numToMove > 0) && (slotPtr->poolPtr != poolPtr))
+        {
+            FlushCacheSlot(slotPtr, slotPtr->numBlocks);
+            slotPtr->poolPtr = poolPtr;
+        }
+
+        while (numToMove > 0)
+        {
+            le_sls_Stack(&(slotPtr->freeList), le_sls_Pop(&(poolPtr->freeList)));
+            slotPtr->numBlocks++;
+            numToMove--;
+        }
+    }
+
+    LE_ASSERT(pthread_mutex_unlock(&cachePtr->mutex) == 0);
+
+    Unlock();
+
+    if (blockLinkPtr == NULL)
+    {
+        return NULL;
+    }
+
+    return CONTAINER_OF(blockLinkPtr, MemBlock_t, link);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Puts a free block into the calling thread's cache.  If the cache slot is full, or is holding
+ * blocks of another pool, a batch of blocks is returned to the shared free list first.
+ *
+ * @note
+ *      Must be called without the mutex locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseToCache
+(
+    ThreadCache_t*  cachePtr,   ///< [IN] The calling thread's cache.
+    MemBlock_t*     blockPtr    ///< [IN] The free block.
+)
+{
+    MemPool_t* poolPtr = blockPtr->poolPtr;
+    CacheSlot_t* slotPtr = GetCacheSlot(cachePtr, poolPtr);
+
+    // Fast path: only touch our own cache.
+    LE_ASSERT(pthread_mutex_lock(&cachePtr->mutex) == 0);
+    if (slotPtr->poolPtr == NULL)
+    {
+        slotPtr->poolPtr = poolPtr;
+    }
+    if ((slotPtr->poolPtr == poolPtr) && (slotPtr->numBlocks < THREAD_CACHE_MAX_BLOCKS))
+    {
+        le_sls_Stack(&(slotPtr->freeList), &(blockPtr->link));
+        slotPtr->numBlocks++;
+        blockPtr = NULL;
+    }
+    LE_ASSERT(pthread_mutex_unlock(&cachePtr->mutex) == 0);
+
+    if (blockPtr == NULL)
+    {
+        return;
+    }
+
+    // Slow path: make room by returning a batch of blocks to the shared free list.
+    Lock();
+    LE_ASSERT(pthread_mutex_lock(&cachePtr->mutex) == 0);
+
+    if (slotPtr->poolPtr != poolPtr)
+    {
+        FlushCacheSlot(slotPtr, slotPtr->numBlocks);
+    }
+    else
+    {
+        FlushCacheSlot(slotPtr, THREAD_CACHE_BATCH_SIZE);
+    }
+    slotPtr->poolPtr = poolPtr;
+
+    le_sls_Stack(&(slotPtr->freeList), &(blockPtr->link));
+    slotPtr->numBlocks++;
+
+    LE_ASSERT(pthread_mutex_unlock(&cachePtr->mutex) == 0);
+    Unlock();
+}
+
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initializes a memory pool.
@@ -516,6 +980,13 @@ void mem_Init
     // Create a memory for all sub-pools.
     SubPoolsPool = le_mem_CreatePool("SubPools", sizeof(MemPool_t));
     le_mem_ExpandPool(SubPoolsPool, DEFAULT_SUB_POOLS_POOL_SIZE);
+
+    #ifdef USE_THREAD_CACHE
+        // Create the thread-local data key used to find each thread's block cache.  The
+        // destructor returns the cached blocks to their pools when the thread dies.
+        LE_ASSERT(pthread_key_create(&ThreadCacheKey, DeleteThreadCache) == 0);
+        ThreadCacheReady = true;
+    #endif
 }
 
 
@@ -677,6 +1148,14 @@ le_mem_PoolRef_t le_mem_ExpandPool
         if (pool->superPoolPtr)
         {
             // This is a sub-pool so the memory blocks to create must come from the super-pool.
+            #ifdef USE_THREAD_CACHE
+                // Don't expand the super-pool if it has free blocks sitting in thread caches.
+                if (le_sls_NumLinks(&(pool->superPoolPtr->freeList)) < numObjects)
+                {
+                    ReclaimCachedBlocks(pool->superPoolPtr);
+                }
+            #endif
+
             // Check that there are enough blocks in the superpool.
             ssize_t numBlocksToAdd = numObjects - le_sls_NumLinks(&(pool->superPoolPtr->freeList));
 
@@ -693,12 +1172,7 @@ le_mem_PoolRef_t le_mem_ExpandPool
             pool->totalBlocks = pool->totalBlocks + numObjects;
 
             // Update the super-pool's block use counts.
-            pool->superPoolPtr->numBlocksInUse += numObjects;
-
-            if (pool->superPoolPtr->numBlocksInUse > pool->superPoolPtr->maxNumBlocksUsed)
-            {
-                pool->superPoolPtr->maxNumBlocksUsed = pool->superPoolPtr->numBlocksInUse;
-            }
+            AdjustBlocksInUse(pool->superPoolPtr, numObjects);
         }
         else
         {
@@ -722,9 +1196,12 @@ le_mem_PoolRef_t le_mem_ExpandPool
  *      to allocate.
  */
 //--------------------------------------------------------------------------------------------------
-void* le_mem_TryAlloc
+static void* TryAlloc
 (
-    le_mem_PoolRef_t    pool    ///< [IN] The pool from which the object is to be allocated.
+    le_mem_PoolRef_t    pool,       ///< [IN] The pool from which the object is to be allocated.
+    bool                canReclaim  ///< [IN] true to reclaim free blocks from other threads'
+                                    ///<      caches if needed (the pool isn't going to be
+                                    ///<      expanded if this fails).
 )
 {
     LE_ASSERT(pool != NULL);
@@ -732,36 +1209,48 @@ void* le_mem_TryAlloc
     MemBlock_t* blockPtr = NULL;
     void* userPtr = NULL;
 
-    Lock();
-
-    #ifndef LE_MEM_VALGRIND
-        // Pop a link off the pool.
-        le_sls_Link_t* blockLinkPtr = le_sls_Pop(&(pool->freeList));
+    #ifdef USE_THREAD_CACHE
+        ThreadCache_t* cachePtr = NULL;
 
-        if (blockLinkPtr != NULL)
+        if (pool->superPoolPtr == NULL)
         {
-            // Get the block from the block link.
-            blockPtr = CONTAINER_OF(blockLinkPtr, MemBlock_t, link);
+            cachePtr = GetThreadCache();
         }
-    #else
-        blockPtr = malloc(pool->blockSize);
 
-        if (blockPtr != NULL)
+        if (cachePtr != NULL)
         {
-            InitBlock(pool, blockPtr);
+            blockPtr = AllocFromCache(cachePtr, pool, canReclaim);
         }
+        else
     #endif
+    {
+        Lock();
+
+        #ifndef LE_MEM_VALGRIND
+            // Pop a link off the pool.
+            le_sls_Link_t* blockLinkPtr = le_sls_Pop(&(pool->freeList));
+
+            if (blockLinkPtr != NULL)
+            {
+                // Get the block from the block link.
+                blockPtr = CONTAINER_OF(blockLinkPtr, MemBlock_t, link);
+            }
+        #else
+            blockPtr = malloc(pool->blockSize);
+
+            if (blockPtr != NULL)
+            {
+                InitBlock(pool, blockPtr);
+            }
+        #endif
+
+        Unlock();
+    }
 
     if (blockPtr != NULL)
     {
         // Update the pool and the block.
-        pool->numAllocations++;
-        pool->numBlocksInUse++;
-
-        if (pool->numBlocksInUse > pool->maxNumBlocksUsed)
-        {
-            pool->maxNumBlocksUsed = pool->numBlocksInUse;
-        }
+        CountAlloc(pool);
 
         blockPtr->refCount = 1;
 
@@ -774,12 +1263,32 @@ void* le_mem_TryAlloc
         #endif
     }
 
-    Unlock();
+    #ifndef USE_THREAD_CACHE
+        (void)canReclaim;
+    #endif
 
     return userPtr;
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Attempts to allocate an object from a pool.
+ *
+ * @return
+ *      A pointer to the allocated object, or NULL if the pool doesn't have any free objects
+ *      to allocate.
+ */
+//--------------------------------------------------------------------------------------------------
+void* le_mem_TryAlloc
+(
+    le_mem_PoolRef_t    pool    ///< [IN] The pool from which the object is to be allocated.
+)
+{
+    return TryAlloc(pool, true);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Allocates an object from a pool or logs a fatal error and terminates the process if the pool
@@ -827,7 +1336,8 @@ void* le_mem_ForceAlloc
     void* objPtr;
 
     #ifndef LE_MEM_VALGRIND
-        while ((objPtr = le_mem_TryAlloc(pool)) == NULL)
+        // Expand the pool rather than reclaim blocks from other threads' caches.
+        while ((objPtr = TryAlloc(pool, false)) == NULL)
         {
             // Expand the pool.
             le_mem_ExpandPool(pool, pool->numBlocksToForce);
@@ -911,44 +1421,56 @@ void le_mem_Release
         CheckGuardBands(blockPtr);
     #endif
 
-    Lock();
-
-    switch (blockPtr->refCount)
+    // The reference count is updated atomically, so the mutex is only needed if the block has
+    // to go back onto its pool's shared free list.
+    switch (__atomic_fetch_sub(&blockPtr->refCount, 1, __ATOMIC_ACQ_REL))
     {
         case 1:
         {
-            MemPool_t* poolPtr = blockPtr->poolPtr;
-
             // The reference count has reached zero.
-            blockPtr->refCount = 0;
+            MemPool_t* poolPtr = blockPtr->poolPtr;
 
             // Call the destructor, if there is one.
-            if (poolPtr->destructor)
+            // Note that the destructor is called without the mutex locked, because it is not a
+            // recursive mutex and therefore would deadlock if the destructor uses this API.
+            le_mem_Destructor_t destructor = poolPtr->destructor;
+            if (destructor)
             {
-                // Make sure that the destructor is not called with the mutex locked, because
-                // it is not a recursive mutex and therefore will deadlock if locked again by
-                // the same thread.  Also, fetch the destructor function address before unlocking
-                // the mutex so that we don't touch the pool object while the mutex is unlocked.
-                le_mem_Destructor_t destructor = poolPtr->destructor;
-                Unlock();
                 destructor(objPtr);
-
-                // Re-lock the mutex now so that it is safe to access the pool object again.
-                Lock();
             }
 
-            #ifndef LE_MEM_VALGRIND
-                // Release the memory back into the pool.
-                // Note that we don't do this before calling the destructor because the destructor
-                // still needs to access it, but after it goes back on the free list, it could get
-                // reallocated by another thread (or even the destructor itself) and have its
-                // contents clobbered.
-                le_sls_Stack(&(poolPtr->freeList), &(blockPtr->link));
-            #else
-                free(blockPtr);
+            // Release the memory back into the pool.
+            // Note that we don't do this before calling the destructor because the destructor
+            // still needs to access it, but after it goes back on the free list, it could get
+            // reallocated by another thread (or even the destructor itself) and have its
+            // contents clobbered.
+            #ifdef USE_THREAD_CACHE
+                ThreadCache_t* cachePtr = NULL;
+
+                if (poolPtr->superPoolPtr == NULL)
+                {
+                    cachePtr = GetThreadCache();
+                }
+
+                if (cachePtr != NULL)
+                {
+                    ReleaseToCache(cachePtr, blockPtr);
+                }
+                else
             #endif
+            {
+                Lock();
+
+                #ifndef LE_MEM_VALGRIND
+                    le_sls_Stack(&(poolPtr->freeList), &(blockPtr->link));
+                #else
+                    free(blockPtr);
+                #endif
+
+                Unlock();
+            }
 
-            poolPtr->numBlocksInUse--;
+            AdjustBlocksInUse(poolPtr, -1);
 
             break;
         }
@@ -960,10 +1482,8 @@ void le_mem_Release
                      blockPtr->poolPtr->name);
 
         default:
-            blockPtr->refCount--;
+            break;
     }
-
-    Unlock();
 }
 
 
@@ -991,13 +1511,7 @@ void le_mem_AddRef
         CheckGuardBands(memBlockPtr);
     #endif
 
-    Lock();
-
-    LE_ASSERT(memBlockPtr->refCount != 0);
-
-    memBlockPtr->refCount++;
-
-    Unlock();
+    LE_ASSERT(__atomic_fetch_add(&memBlockPtr->refCount, 1, __ATOMIC_RELAXED) != 0);
 }
 
 
@@ -1043,11 +1557,14 @@ void le_mem_GetStats
 
     Lock();
 
-    statsPtr->numAllocs = pool->numAllocations;
+    // The usage counters are updated without the mutex, so read them atomically.
+    size_t numBlocksInUse = __atomic_load_n(&pool->numBlocksInUse, __ATOMIC_RELAXED);
+
+    statsPtr->numAllocs = __atomic_load_n(&pool->numAllocations, __ATOMIC_RELAXED);
     statsPtr->numOverflows = pool->numOverflows;
-    statsPtr->numFree = pool->totalBlocks - pool->numBlocksInUse;
-    statsPtr->numBlocksInUse = pool->numBlocksInUse;
-    statsPtr->maxNumBlocksUsed = pool->maxNumBlocksUsed;
+    statsPtr->numFree = pool->totalBlocks - numBlocksInUse;
+    statsPtr->numBlocksInUse = numBlocksInUse;
+    statsPtr->maxNumBlocksUsed = __atomic_load_n(&pool->maxNumBlocksUsed, __ATOMIC_RELAXED);
 
     Unlock();
 }
@@ -1069,7 +1586,7 @@ void le_mem_ResetStats
     LE_ASSERT(pool != NULL);
 
     Lock();
-    pool->numAllocations = 0;
+    __atomic_store_n(&pool->numAllocations, 0, __ATOMIC_RELAXED);
     pool->numOverflows = 0;
     Unlock();
 }
@@ -1344,7 +1861,7 @@ void le_mem_DeleteSubPool
     MoveBlocks(superPool, subPool, numBlocks);
 
     // Update the superPool's block use count.
-    superPool->numBlocksInUse -= numBlocks;
+    AdjustBlocksInUse(superPool, -(ssize_t)numBlocks);
 
     // Remove the sub-pool from the list of sub-pools.
     PoolListChangeCount++;
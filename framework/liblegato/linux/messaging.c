@@ -85,6 +85,15 @@
  * side.  For all other types of messages, this is set to 0 (NULL) to indicate that it does
  * not belong to a request-response transaction.
  *
+ * A client process can opt in to a shared memory transport for bulk data by setting the
+ * LE_MSG_SHM_THRESHOLD environment variable to a message size in bytes.  When a session opens,
+ * the client creates a sealed memfd holding a pair of message rings (one for each direction) and
+ * passes it to the server over the session's socket.  From then on, messages at least that big
+ * are copied into the sender's ring and only a one-byte "doorbell" datagram is sent over the
+ * socket, so the socket still orders, wakes up and closes sessions exactly as before.  Messages
+ * that are smaller, or that find the ring full, are sent over the socket as usual.  See
+ * messagingShm.c for the details.
+ *
  * See also @ref serviceDirectoryProtocol.
  *
  * @warning The code in this subsystem @b must be thread safe and re-entrant.
@@ -98,6 +107,7 @@
 #include "messagingProtocol.h"
 #include "messagingSession.h"
 #include "messagingInterface.h"
+#include "messagingShm.h"
 
 // =======================================
 //  PROTECTED (INTER-MODULE) FUNCTIONS
@@ -119,4 +129,5 @@ void msg_Init
     msgMessage_Init();
     msgInterface_Init();
     msgSession_Init();
+    msgShm_Init();
 }
@@ -12,9 +12,18 @@
 #include "messagingProtocol.h"
 #include "messagingSession.h"
 #include "messagingInterface.h"
+#include "messagingShm.h"
 #include "fileDescriptor.h"
 #include "unixSocket.h"
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Contents of the doorbell datagram sent in place of a message that went through shared memory.
+ */
+//--------------------------------------------------------------------------------------------------
+static char Doorbell[MSGSHM_DOORBELL_SIZE] = { 'D' };
+
 // =======================================
 //  PRIVATE FUNCTIONS
 // =======================================
@@ -32,6 +41,12 @@ static void MessageDestructor
 {
     Message_t* msgPtr = objPtr;
 
+    // A spare receive buffer (see msgMessage_ReceiveBatch()) never held a message.
+    if (msgPtr->sessionRef == NULL)
+    {
+        return;
+    }
+
     // If the session is still open and we are releasing a message that the client expects a
     // response to, the client could get stuck waiting for the response forever.  So, we close
     // the session to wake up the client (and probably kill it).
@@ -67,6 +82,332 @@ static void MessageDestructor
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a Message object ready to be sent.  If it is a response message, this moves the response fd
+ * into the position of the fd to be sent.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrepareForSend
+(
+    Message_t*  msgPtr      ///< The Message to be sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // If this is a response message,
+    if (le_msg_NeedsResponse(msgPtr))
+    {
+        // If there was an fd that was received from the client but not fetched from the message
+        // generate a warning and close that fd.
+        if (msgPtr->fd >= 0)
+        {
+            LE_WARN("File descriptor not retrieved from message received from client.");
+            fd_Close(msgPtr->fd);
+        }
+
+        // Move the responseFd to the normal fd position in the message object.
+        msgPtr->fd = msgPtr->clientServer.server.responseFd;
+        msgPtr->clientServer.server.responseFd = -1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reverses PrepareForSend() for a Message object that was not sent, so that it can be prepared
+ * again later without its response fd being mistaken for an unfetched fd from the client.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UndoPrepareForSend
+(
+    Message_t*  msgPtr      ///< The Message that wasn't sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (le_msg_NeedsResponse(msgPtr))
+    {
+        msgPtr->clientServer.server.responseFd = msgPtr->fd;
+        msgPtr->fd = -1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Works out what to send over the socket for a Message object.  If the session uses the shared
+ * memory transport and the message can go through its ring, the message is copied into the ring
+ * and only a doorbell is sent over the socket.
+ *
+ * @return true if the message was copied into the ring (the slot must be committed once the
+ *         doorbell has been sent), false if the message itself is to be sent over the socket.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetSendBuffer
+(
+    Message_t*  msgPtr,         ///< [IN] The Message to be sent.
+    size_t      slotOffset,     ///< [IN] Number of ring slots already filled for this send.
+    void**      dataPtrPtr,     ///< [OUT] What to send over the socket.
+    size_t*     dataSizePtr     ///< [OUT] Number of bytes to send over the socket.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The first bytes come from our transaction ID and the rest (if any)
+    // from our Message object's payload section, which comes right after the transaction ID.
+    // Only the part of the payload that is in use is sent.
+    size_t size = sizeof(msgPtr->txnId) + msgPtr->payloadSize;
+    msgShm_RingRef_t ringRef = msgPtr->sessionRef->shmRingRef;
+
+    if (ringRef != NULL)
+    {
+        void* slotPtr = msgShm_GetTxSlot(ringRef, slotOffset, size);
+
+        if (slotPtr != NULL)
+        {
+            memcpy(slotPtr, &msgPtr->txnId, size);
+
+            *dataPtrPtr = Doorbell;
+            *dataSizePtr = sizeof(Doorbell);
+            return true;
+        }
+    }
+
+    *dataPtrPtr = &msgPtr->txnId;
+    *dataSizePtr = size;
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Binds a newly allocated Message object to a session and initializes its data members, except
+ * for the transaction ID and the payload.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InitMessage
+(
+    Message_t*          msgPtr,
+    le_msg_SessionRef_t sessionRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    msgPtr->link = LE_DLS_LINK_INIT;
+    msgPtr->sessionRef = sessionRef;
+    le_mem_AddRef(sessionRef);  // Message object holds a reference to the Session object.
+
+    msgInterface_Type_t interfaceType = msgSession_GetInterfaceType(sessionRef);
+    switch (interfaceType)
+    {
+        case LE_MSG_INTERFACE_CLIENT:
+            msgPtr->clientServer.client.completionCallback = NULL;
+            msgPtr->clientServer.client.contextPtr = NULL;
+            break;
+
+        case LE_MSG_INTERFACE_SERVER:
+            msgPtr->clientServer.server.responseFd = -1;
+            break;
+
+        default:
+            LE_FATAL("Unhandled interface type (%d).", interfaceType);
+    }
+
+    msgPtr->fd = -1;
+    msgPtr->payloadSize = le_msg_GetProtocolMaxMsgSize(le_msg_GetSessionProtocol(sessionRef));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handles a shared memory setup datagram received by the server: attaches to the client's shared
+ * memory and tells the client whether it worked.  The shared memory is only used if the client
+ * has been told that it was accepted; otherwise messages keep going through the socket.
+ *
+ * @return
+ * - LE_UNAVAILABLE if the setup was handled (whether the shared memory is in use or not).
+ * - LE_FAULT if the setup was not expected.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AcceptSharedMemory
+(
+    le_msg_MessageRef_t msgRef      ///< [IN] Message object that the setup was received into.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_SessionRef_t sessionRef = msgRef->sessionRef;
+    char answer[MSGSHM_SETUP_SIZE] = { 'S', MSGSHM_SETUP_REFUSED };
+
+    if (sessionRef->shmRingRef != NULL)
+    {
+        LE_ERROR("Received unexpected shared memory setup.");
+        return LE_FAULT;
+    }
+
+    if (msgRef->fd >= 0)
+    {
+        sessionRef->shmRingRef = msgShm_Attach(msgRef->fd);
+        msgRef->fd = -1;
+    }
+    else
+    {
+        LE_ERROR("Received shared memory setup without a file descriptor.");
+    }
+
+    if (sessionRef->shmRingRef != NULL)
+    {
+        answer[1] = MSGSHM_SETUP_ACCEPTED;
+    }
+
+    le_result_t result = unixSocket_SendDataMsg(sessionRef->socketFd, answer, sizeof(answer));
+
+    if (result != LE_OK)
+    {
+        LE_WARN("Failed to answer shared memory setup (%s).", LE_RESULT_TXT(result));
+
+        // The client won't use the shared memory without an answer, so neither must we.
+        if (sessionRef->shmRingRef != NULL)
+        {
+            msgShm_Delete(sessionRef->shmRingRef);
+            sessionRef->shmRingRef = NULL;
+        }
+    }
+    else if (sessionRef->shmRingRef != NULL)
+    {
+        LE_DEBUG("Session on '%s' now using shared memory.",
+                 le_msg_GetInterfaceName(le_msg_GetSessionInterface(sessionRef)));
+    }
+
+    return LE_UNAVAILABLE;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handles the server's answer to the client's offer of shared memory.  The client starts using the
+ * shared memory if the server accepted it, or deletes it and keeps using the socket if not.
+ *
+ * @return
+ * - LE_UNAVAILABLE if the answer was handled.
+ * - LE_FAULT if no shared memory was offered.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FinishSharedMemoryOffer
+(
+    le_msg_SessionRef_t sessionRef, ///< [IN] Client-side session that the answer was received on.
+    uint8_t             answer      ///< [IN] MSGSHM_SETUP_ACCEPTED or MSGSHM_SETUP_REFUSED.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (sessionRef->shmOfferedRingRef == NULL)
+    {
+        LE_ERROR("Received unexpected shared memory setup answer.");
+        return LE_FAULT;
+    }
+
+    if (answer == MSGSHM_SETUP_ACCEPTED)
+    {
+        sessionRef->shmRingRef = sessionRef->shmOfferedRingRef;
+
+        LE_DEBUG("Session on '%s' now using shared memory.",
+                 le_msg_GetInterfaceName(le_msg_GetSessionInterface(sessionRef)));
+    }
+    else
+    {
+        LE_WARN("Server refused shared memory on '%s'. Messages will go through the socket.",
+                le_msg_GetInterfaceName(le_msg_GetSessionInterface(sessionRef)));
+
+        msgShm_Delete(sessionRef->shmOfferedRingRef);
+    }
+
+    sessionRef->shmOfferedRingRef = NULL;
+
+    return LE_UNAVAILABLE;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finishes receiving a datagram into a Message object.  If the datagram is a doorbell, the message
+ * is copied out of the session's shared memory ring.  If it is a shared memory setup datagram (or
+ * the server's answer to one), it is handled here.
+ *
+ * @return
+ * - LE_OK if the Message object now holds a valid message.
+ * - LE_UNAVAILABLE if the datagram was a setup datagram, so the Message object holds no message.
+ * - LE_FAULT if the message was not valid.
+ * - The receive result, if the receive failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FinishReceive
+(
+    le_msg_MessageRef_t msgRef,     ///< [IN] Message object that the datagram was received into.
+    le_result_t         result,     ///< [IN] Result of the receive.
+    size_t*             byteCountPtr///< [IN+OUT] Number of bytes received.  Updated to the size of
+                                    ///     the message copied out of shared memory for a doorbell.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_SessionRef_t sessionRef = msgRef->sessionRef;
+    size_t byteCount = *byteCountPtr;
+    bool isServer = (msgSession_GetInterfaceType(sessionRef) == LE_MSG_INTERFACE_SERVER);
+
+    if (isServer)
+    {
+        msgRef->clientServer.server.responseFd = -1;
+    }
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    // The second byte of a setup datagram from the server is its answer to the client's offer.
+    uint8_t setupAnswer = ((uint8_t*)&msgRef->txnId)[1];
+
+    if ((byteCount == MSGSHM_DOORBELL_SIZE) || (byteCount == MSGSHM_SETUP_SIZE))
+    {
+        // What was received into the transaction ID isn't one, so don't let the Message object
+        // look like an outstanding request if it ends up being released.
+        msgRef->txnId = NULL;
+    }
+
+    if (byteCount == MSGSHM_DOORBELL_SIZE)
+    {
+        if (sessionRef->shmRingRef == NULL)
+        {
+            LE_ERROR("Received doorbell on a session without shared memory.");
+            return LE_FAULT;
+        }
+
+        byteCount = sizeof(msgRef->txnId) + le_msg_GetMaxPayloadSize(msgRef);
+        result = msgShm_Receive(sessionRef->shmRingRef, &msgRef->txnId, &byteCount);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        *byteCountPtr = byteCount;
+    }
+    else if (byteCount == MSGSHM_SETUP_SIZE)
+    {
+        if (isServer)
+        {
+            return AcceptSharedMemory(msgRef);
+        }
+        else
+        {
+            return FinishSharedMemoryOffer(sessionRef, setupAnswer);
+        }
+    }
+
+    if (byteCount < sizeof(msgRef->txnId))
+    {
+        LE_ERROR("Received message too short (%zu bytes).", byteCount);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
 // =======================================
 //  PROTECTED (INTER-MODULE) FUNCTIONS
 // =======================================
@@ -142,29 +483,98 @@ le_result_t msgMessage_Send
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // If this is a response message,
-    if (le_msg_NeedsResponse(msgPtr))
+    void* dataPtr;
+    size_t dataSize;
+
+    PrepareForSend(msgPtr);
+
+    bool viaShm = GetSendBuffer(msgPtr, 0, &dataPtr, &dataSize);
+
+    le_result_t result = unixSocket_SendMsg(socketFd,
+                                            dataPtr,
+                                            dataSize,
+                                            msgPtr->fd,
+                                            false   ); // Don't send process credentials.
+
+    if (viaShm && (result == LE_OK))
     {
-        // If there was an fd that was received from the client but not fetched from the message
-        // generate a warning and close that fd.
-        if (msgPtr->fd >= 0)
+        msgShm_CommitTx(msgPtr->sessionRef->shmRingRef, 1);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a batch of messages over a connected socket using a single system call.
+ *
+ * Messages are sent in order.  If only some of them could be sent, the count is updated to the
+ * number sent, and the rest are left ready to be passed to this function again later.
+ *
+ * @return
+ * - LE_OK if at least one message was sent (*countPtr updated to the number sent).
+ * - LE_NO_MEMORY if the socket doesn't have enough send buffer space available right now.
+ * - LE_COMM_ERROR if the localSocketFd is not connected.
+ * - LE_FAULT if failed for some other reason (check your logs).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_SendBatch
+(
+    int         socketFd,   ///< [IN] Connected socket's file descriptor.
+    Message_t** msgArray,   ///< [IN] The Messages to be sent.
+    size_t*     countPtr    ///< [IN+OUT] Number of Messages (at most UNIXSOCKET_MAX_BATCH_MSGS).
+                            ///     Updated to the number of Messages sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    unixSocket_MsgBuff_t buffs[UNIXSOCKET_MAX_BATCH_MSGS];
+    bool viaShm[UNIXSOCKET_MAX_BATCH_MSGS];
+    size_t count = *countPtr;
+    size_t slotCount = 0;
+    size_t i;
+
+    LE_ASSERT(count <= UNIXSOCKET_MAX_BATCH_MSGS);
+
+    for (i = 0; i < count; i++)
+    {
+        PrepareForSend(msgArray[i]);
+
+        viaShm[i] = GetSendBuffer(msgArray[i], slotCount, &buffs[i].dataPtr, &buffs[i].dataSize);
+        if (viaShm[i])
         {
-            LE_WARN("File descriptor not retrieved from message received from client.");
-            fd_Close(msgPtr->fd);
+            slotCount++;
         }
 
-        // Move the responseFd to the normal fd position in the message object.
-        msgPtr->fd = msgPtr->clientServer.server.responseFd;
-        msgPtr->clientServer.server.responseFd = -1;
+        buffs[i].fd = msgArray[i]->fd;
     }
 
-    // The first bytes come from our transaction ID and the rest (if any)
-    // from our Message object's payload section, which comes right after the transaction ID.
-    return unixSocket_SendMsg(  socketFd,
-                                &msgPtr->txnId,
-                                sizeof(msgPtr->txnId) + le_msg_GetMaxPayloadSize(msgPtr),
-                                msgPtr->fd,
-                                false   ); // Don't send process credentials.
+    le_result_t result = unixSocket_SendMsgBatch(socketFd, buffs, countPtr);
+
+    // Commit the ring slots of the messages whose doorbells went out.  The slots of the others
+    // will be filled again when they are retried.
+    if (slotCount > 0)
+    {
+        size_t sentSlotCount = 0;
+
+        for (i = 0; i < *countPtr; i++)
+        {
+            if (viaShm[i])
+            {
+                sentSlotCount++;
+            }
+        }
+
+        msgShm_CommitTx(msgArray[0]->sessionRef->shmRingRef, sentSlotCount);
+    }
+
+    // Put the messages that weren't sent back the way they were, so they can be sent again.
+    for (i = *countPtr; i < count; i++)
+    {
+        UndoPrepareForSend(msgArray[i]);
+    }
+
+    return result;
 }
 
 
@@ -186,17 +596,136 @@ le_result_t msgMessage_Receive
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Receive the first bytes into our transaction ID and the rest (if any)
-    // into our Message object's payload section.
-    size_t byteCount = sizeof(msgRef->txnId) + le_msg_GetMaxPayloadSize(msgRef);
-    le_result_t result = unixSocket_ReceiveMsg( socketFd,
-                                                &msgRef->txnId,
-                                                &byteCount,
-                                                &msgRef->fd,
-                                                NULL    );  // Don't receive credentials.
-    if (msgSession_GetInterfaceType(msgRef->sessionRef) == LE_MSG_INTERFACE_SERVER)
+    le_result_t result;
+
+    do
+    {
+        // Receive the first bytes into our transaction ID and the rest (if any)
+        // into our Message object's payload section.  The sender may have sent only the part of
+        // the payload that it was using, in which case the rest of our (zeroed) payload is left
+        // as is.
+        size_t byteCount = sizeof(msgRef->txnId) + le_msg_GetMaxPayloadSize(msgRef);
+        result = unixSocket_ReceiveMsg( socketFd,
+                                        &msgRef->txnId,
+                                        &byteCount,
+                                        &msgRef->fd,
+                                        NULL    );  // Don't receive credentials.
+
+        result = FinishReceive(msgRef, result, &byteCount);
+    }
+    while (result == LE_UNAVAILABLE);   // Setup datagrams aren't messages.  Keep going.
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive a batch of messages from a connected socket using a single system call.
+ *
+ * Receives into up to maxCount Message objects, taken from the session's spares (left over from
+ * earlier batches) or newly allocated.  Only those that a datagram is received into are bound to
+ * the session and have the rest of their payload zeroed; the others are kept as spares for next
+ * time.  The valid messages are returned in msgArray, in the order they were received.
+ *
+ * @return
+ * - LE_OK if at least one valid message was received (*countPtr set to the number received).
+ * - LE_WOULD_BLOCK if there's nothing there to receive and the socket is set non-blocking, or if
+ *   only a shared memory setup datagram was received.
+ * - LE_CLOSED if the connection has closed.
+ * - LE_FAULT if only invalid messages were received or another error occurred.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_ReceiveBatch
+(
+    int                  socketFd,   ///< [IN] The socket's file descriptor.
+    le_msg_SessionRef_t  sessionRef, ///< [IN] Session to receive the messages for.
+    le_msg_MessageRef_t* msgArray,   ///< [OUT] Array to store the received Messages in.
+    size_t               maxCount,   ///< [IN] Max number of messages (at most
+                                     ///     UNIXSOCKET_MAX_BATCH_MSGS).
+    size_t*              countPtr    ///< [OUT] Number of Messages stored in msgArray.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    unixSocket_MsgBuff_t buffs[UNIXSOCKET_MAX_BATCH_MSGS];
+    le_msg_ProtocolRef_t protocolRef = le_msg_GetSessionProtocol(sessionRef);
+    size_t bufferSize = sizeof(((Message_t*)NULL)->txnId) +
+                        le_msg_GetProtocolMaxMsgSize(protocolRef);
+    size_t received = maxCount;
+    size_t i;
+
+    LE_ASSERT((maxCount > 0) && (maxCount <= UNIXSOCKET_MAX_BATCH_MSGS));
+
+    *countPtr = 0;
+
+    // Receive the first bytes of each message into its transaction ID and the rest (if any)
+    // into its payload section, as msgMessage_Receive() does.
+    for (i = 0; i < maxCount; i++)
     {
-        msgRef->clientServer.server.responseFd = -1;
+        if (sessionRef->rxSpareCount > 0)
+        {
+            sessionRef->rxSpareCount--;
+            msgArray[i] = sessionRef->rxSpareMsgs[sessionRef->rxSpareCount];
+        }
+        else
+        {
+            msgArray[i] = msgProto_AllocMessage(protocolRef);
+            msgArray[i]->sessionRef = NULL;
+        }
+
+        buffs[i].dataPtr = &msgArray[i]->txnId;
+        buffs[i].dataSize = bufferSize;
+    }
+
+    le_result_t result = unixSocket_ReceiveMsgBatch(socketFd, buffs, &received);
+    if (result != LE_OK)
+    {
+        received = 0;
+    }
+
+    bool onlySetup = true;
+
+    for (i = 0; i < maxCount; i++)
+    {
+        le_msg_MessageRef_t msgRef = msgArray[i];
+
+        if (i >= received)
+        {
+            sessionRef->rxSpareMsgs[sessionRef->rxSpareCount] = msgRef;
+            sessionRef->rxSpareCount++;
+            continue;
+        }
+
+        InitMessage(msgRef, sessionRef);
+        msgRef->fd = buffs[i].fd;
+
+        size_t byteCount = buffs[i].dataSize;
+        le_result_t msgResult = FinishReceive(msgRef, buffs[i].result, &byteCount);
+
+        if (msgResult == LE_OK)
+        {
+            // The sender may have sent only the part of the payload that it was using.  The rest
+            // must read as zeros, as it does in a newly created message.
+            memset((uint8_t*)&msgRef->txnId + byteCount, 0, bufferSize - byteCount);
+
+            msgArray[*countPtr] = msgRef;
+            (*countPtr)++;
+            continue;
+        }
+
+        if (msgResult != LE_UNAVAILABLE)
+        {
+            onlySetup = false;
+        }
+
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    if ((result == LE_OK) && (*countPtr == 0))
+    {
+        // If all we got was a shared memory setup, there's nothing to process, but it isn't an
+        // error either.  The FD Monitor will report anything else waiting on the socket.
+        result = (onlySetup ? LE_WOULD_BLOCK : LE_FAULT);
     }
 
     return result;
@@ -247,33 +776,12 @@ le_msg_MessageRef_t le_msg_CreateMsg
 {
     // Get a reference to the Session's Protocol and ask the Protocol to allocate a Message
     // object from its Message Pool.
-    le_msg_ProtocolRef_t protocolRef = le_msg_GetSessionProtocol(sessionRef);
-    Message_t* msgPtr = msgProto_AllocMessage(protocolRef);
-
-    // Initialize the Message object's data members.
-    msgPtr->link = LE_DLS_LINK_INIT;
-    msgPtr->sessionRef = sessionRef;
-    le_mem_AddRef(sessionRef);  // Message object holds a reference to the Session object.
-
-    msgInterface_Type_t interfaceType = msgSession_GetInterfaceType(sessionRef);
-    switch (interfaceType)
-    {
-        case LE_MSG_INTERFACE_CLIENT:
-            msgPtr->clientServer.client.completionCallback = NULL;
-            msgPtr->clientServer.client.contextPtr = NULL;
-            break;
+    Message_t* msgPtr = msgProto_AllocMessage(le_msg_GetSessionProtocol(sessionRef));
 
-        case LE_MSG_INTERFACE_SERVER:
-            msgPtr->clientServer.server.responseFd = -1;
-            break;
+    InitMessage(msgPtr, sessionRef);
 
-        default:
-            LE_FATAL("Unhandled interface type (%d).", interfaceType);
-    }
-
-    msgPtr->fd = -1;
     msgPtr->txnId = 0;
-    memset(msgPtr->payload, 0, le_msg_GetProtocolMaxMsgSize(protocolRef));
+    memset(msgPtr->payload, 0, msgPtr->payloadSize);
 
     return msgPtr;
 }
@@ -372,6 +880,27 @@ size_t le_msg_GetMaxPayloadSize
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the number of bytes at the start of the message payload buffer that are actually in use.
+ * Only that many bytes will be sent when the message (or its response) is sent.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_msg_SetPayloadSize
+(
+    le_msg_MessageRef_t msgRef,     ///< [in] Reference to the message.
+    size_t              size        ///< [in] Number of payload bytes in use.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t maxSize = le_msg_GetMaxPayloadSize(msgRef);
+
+    LE_FATAL_IF(size > maxSize, "Payload size %zu exceeds maximum %zu.", size, maxSize);
+
+    msgRef->payloadSize = size;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets the file descriptor to be sent with this message.
@@ -18,7 +18,8 @@
 typedef struct le_msg_Message
 {
     le_dls_Link_t               link;       ///< Used to link onto message queues.
-    le_msg_SessionRef_t         sessionRef; ///< The session to which this message belongs.
+    le_msg_SessionRef_t         sessionRef; ///< The session to which this message belongs
+                                            ///  (NULL for a spare receive buffer).
 
     union
     {
@@ -41,6 +42,7 @@ typedef struct le_msg_Message
     clientServer;
 
     int                         fd;         ///< File descriptor to send or received (-1 = no fd)
+    size_t                      payloadSize;///< Number of payload bytes to send.
     void*                       txnId;      ///< Safe reference value used as a transaction ID.
     void*                       payload[0]; ///< Variable-length payload buffer appears at the end.
 }
@@ -108,6 +110,55 @@ le_result_t msgMessage_Receive
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a batch of messages over a connected socket using a single system call.
+ *
+ * Messages are sent in order.  If only some of them could be sent, the count is updated to the
+ * number sent, and the rest are left ready to be passed to this function again later.
+ *
+ * @return
+ * - LE_OK if at least one message was sent (*countPtr updated to the number sent).
+ * - LE_NO_MEMORY if the socket doesn't have enough send buffer space available right now.
+ * - LE_COMM_ERROR if the localSocketFd is not connected.
+ * - LE_FAULT if failed for some other reason (check your logs).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_SendBatch
+(
+    int         socketFd,   ///< [IN] Connected socket's file descriptor.
+    Message_t** msgArray,   ///< [IN] The Messages to be sent.
+    size_t*     countPtr    ///< [IN+OUT] Number of Messages (at most UNIXSOCKET_MAX_BATCH_MSGS).
+                            ///     Updated to the number of Messages sent.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receive a batch of messages from a connected socket using a single system call.
+ *
+ * Receives into up to maxCount Message objects, reusing the session's spares from earlier batches
+ * where it can.  Message objects that nothing was received into are kept by the session as spares.
+ * The valid messages are returned in msgArray, in the order they were received.
+ *
+ * @return
+ * - LE_OK if at least one valid message was received (*countPtr set to the number received).
+ * - LE_WOULD_BLOCK if there's nothing there to receive and the socket is set non-blocking.
+ * - LE_CLOSED if the connection has closed.
+ * - LE_FAULT if only invalid messages were received or another error occurred.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgMessage_ReceiveBatch
+(
+    int                  socketFd,   ///< [IN] The socket's file descriptor.
+    le_msg_SessionRef_t  sessionRef, ///< [IN] Session to receive the messages for.
+    le_msg_MessageRef_t* msgArray,   ///< [OUT] Array to store the received Messages in.
+    size_t               maxCount,   ///< [IN] Max number of messages (at most
+                                     ///     UNIXSOCKET_MAX_BATCH_MSGS).
+    size_t*              countPtr    ///< [OUT] Number of Messages stored in msgArray.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets a pointer to the queue link inside a Message object.
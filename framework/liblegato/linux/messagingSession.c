@@ -144,23 +144,85 @@ static le_msg_MessageRef_t PopTransmitQueue
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Puts a message back onto the head of the Transmit Queue.
+ * Pops up to a given number of messages off of the Transmit Queue.
+ *
+ * @return The number of messages popped (0 if the queue is empty).
  *
  * @note    This is used on both the client side and the server side.
  */
 //--------------------------------------------------------------------------------------------------
-static void UnPopTransmitQueue
+static size_t PopTransmitQueueBatch
 (
-    msgSession_Session_t* sessionPtr,
-    le_msg_MessageRef_t msgRef
+    msgSession_Session_t*   sessionPtr,
+    le_msg_MessageRef_t*    msgArray,   ///< [OUT] Array to store the popped messages in.
+    size_t                  maxCount    ///< [IN] Max number of messages to pop.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_dls_Link_t* linkPtr = msgMessage_GetQueueLinkPtr(msgRef);
+    size_t count = 0;
+    le_dls_Link_t* linkPtr;
 
     LOCK
-    le_dls_Stack(&sessionPtr->transmitQueue, linkPtr);
+    while ((count < maxCount) && (NULL != (linkPtr = le_dls_Pop(&sessionPtr->transmitQueue))))
+    {
+        msgArray[count] = msgMessage_GetMessageContainingLink(linkPtr);
+        count++;
+    }
     UNLOCK
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Puts messages back onto the head of the Transmit Queue, in the order they are in the array.
+ *
+ * @note    This is used on both the client side and the server side.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnPopTransmitQueueBatch
+(
+    msgSession_Session_t*   sessionPtr,
+    le_msg_MessageRef_t*    msgArray,   ///< [IN] Messages to put back.
+    size_t                  count       ///< [IN] Number of messages in the array.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    LOCK
+    while (count > 0)
+    {
+        count--;
+        le_dls_Stack(&sessionPtr->transmitQueue, msgMessage_GetQueueLinkPtr(msgArray[count]));
+    }
+    UNLOCK
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Updates a set of batching counters after a system call has transferred some messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void RecordBatch
+(
+    msgSession_BatchStats_t*    statsPtr,
+    size_t                      msgCount    ///< [IN] Number of messages transferred.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    statsPtr->msgCount += msgCount;
+    statsPtr->callCount++;
+
+    if (msgCount > statsPtr->maxBatch)
+    {
+        statsPtr->maxBatch = msgCount;
+    }
 }
 
 
@@ -448,6 +510,14 @@ static msgSession_Session_t* CreateSession
     sessionPtr->closeHandler = NULL;
     sessionPtr->closeContextPtr = NULL;
 
+    sessionPtr->rxBatchSize = 1;
+    sessionPtr->rxSpareCount = 0;
+    memset(&sessionPtr->rxStats, 0, sizeof(sessionPtr->rxStats));
+    memset(&sessionPtr->txStats, 0, sizeof(sessionPtr->txStats));
+
+    sessionPtr->shmRingRef = NULL;
+    sessionPtr->shmOfferedRingRef = NULL;
+
     sessionPtr->interfaceRef = interfaceRef;
 
     SessionObjListChangeCount++;
@@ -489,6 +559,18 @@ static void CloseSession
     fd_Close(sessionPtr->socketFd);
     sessionPtr->socketFd = -1;
 
+    // Release the shared memory, if the session was using it.
+    if (sessionPtr->shmRingRef != NULL)
+    {
+        msgShm_Delete(sessionPtr->shmRingRef);
+        sessionPtr->shmRingRef = NULL;
+    }
+    if (sessionPtr->shmOfferedRingRef != NULL)
+    {
+        msgShm_Delete(sessionPtr->shmOfferedRingRef);
+        sessionPtr->shmOfferedRingRef = NULL;
+    }
+
     // If there are any messages stranded on the transmit queue, the pending transaction list,
     // or the receive queue, clean them all up.
     if (sessionPtr->interfaceRef->interfaceType == LE_MSG_INTERFACE_SERVER)
@@ -497,6 +579,13 @@ static void CloseSession
     }
     PurgeTransmitQueue(sessionPtr);
     PurgeReceiveQueue(sessionPtr);
+
+    // Free the spare Message objects kept for receiving into.
+    while (sessionPtr->rxSpareCount > 0)
+    {
+        sessionPtr->rxSpareCount--;
+        le_msg_ReleaseMsg(sessionPtr->rxSpareMsgs[sessionPtr->rxSpareCount]);
+    }
 }
 
 
@@ -637,6 +726,61 @@ static void RetryOpen
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Offers the server a shared memory transport for a session that has just been opened, if this
+ * process has enabled it (see msgShm_GetThreshold()) and the protocol's messages can be big enough
+ * to use it.  If anything goes wrong, the session just keeps sending everything over the socket.
+ *
+ * @note    This is used only on the client side.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OfferSharedMemory
+(
+    msgSession_Session_t* sessionPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static char setupData[MSGSHM_SETUP_SIZE] = { 'S', 'M' };
+
+    size_t threshold = msgShm_GetThreshold();
+    size_t maxMsgSize = sizeof(void*)
+                        + le_msg_GetProtocolMaxMsgSize(le_msg_GetSessionProtocol(sessionPtr));
+
+    if ((threshold == 0) || (maxMsgSize < threshold))
+    {
+        return;
+    }
+
+    int fd;
+    msgShm_RingRef_t ringRef = msgShm_Create(maxMsgSize, threshold, &fd);
+    if (ringRef == NULL)
+    {
+        return;
+    }
+
+    // The setup goes ahead of any message on the socket, so the server will be attached before it
+    // gets the first doorbell.
+    le_result_t result = unixSocket_SendMsg(sessionPtr->socketFd,
+                                            setupData,
+                                            sizeof(setupData),
+                                            fd,
+                                            false);  // Don't send credentials.
+    fd_Close(fd);
+
+    // Messages keep going through the socket until the server accepts the shared memory.
+    if (result == LE_OK)
+    {
+        sessionPtr->shmOfferedRingRef = ringRef;
+    }
+    else
+    {
+        LE_WARN("Failed to send shared memory setup (%s).", LE_RESULT_TXT(result));
+        msgShm_Delete(ringRef);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Receives an LE_OK session open response from the server.
@@ -672,6 +816,8 @@ static le_result_t ReceiveSessionOpenResponse
             TRACE("Session opened on interface (%s:%s)",
                   le_msg_GetInterfaceName(interfaceRef),
                   le_msg_GetProtocolIdStr(le_msg_GetSessionProtocol(sessionPtr)));
+
+            OfferSharedMemory(sessionPtr);
         }
         else if ((serverResponse == LE_UNAVAILABLE) || (serverResponse == LE_NOT_PERMITTED))
         {
@@ -903,6 +1049,11 @@ static void ClientSocketError
 //--------------------------------------------------------------------------------------------------
 /**
  * Receive messages from the socket and put them on the Receive Queue.
+ *
+ * Messages are received in batches.  The batch size starts at one and doubles (up to
+ * UNIXSOCKET_MAX_BATCH_MSGS) every time a batch is filled, so a flood of messages is drained with
+ * few system calls without allocating many Message objects for every wake-up in the common case
+ * where only one message is waiting.
  */
 //--------------------------------------------------------------------------------------------------
 static void ReceiveMessages
@@ -911,25 +1062,46 @@ static void ReceiveMessages
 )
 //--------------------------------------------------------------------------------------------------
 {
+    le_msg_MessageRef_t msgArray[UNIXSOCKET_MAX_BATCH_MSGS];
+
     for (;;)
     {
-        // Create a Message object.
-        le_msg_MessageRef_t msgRef = le_msg_CreateMsg(sessionPtr);
+        size_t batchSize = sessionPtr->rxBatchSize;
+        size_t count;
+
+        // Receive from the socket into a batch of Message objects.
+        le_result_t result = msgMessage_ReceiveBatch(sessionPtr->socketFd,
+                                                     sessionPtr,
+                                                     msgArray,
+                                                     batchSize,
+                                                     &count);
+        if (result != LE_OK)
+        {
+            // Nothing left to receive from the socket.  We are done.
+            break;
+        }
 
-        // Receive from the socket into the Message object.
-        le_result_t result = msgMessage_Receive(sessionPtr->socketFd, msgRef);
+        RecordBatch(&sessionPtr->rxStats, count);
 
-        if (result == LE_OK)
+        // Received something.  Push it onto the Receive Queue for later processing.
+        size_t i;
+        for (i = 0; i < count; i++)
         {
-            // Received something.  Push it onto the Receive Queue for later processing.
-            PushReceiveQueue(sessionPtr, msgRef);
+            PushReceiveQueue(sessionPtr, msgArray[i]);
         }
-        else
+
+        if (count < batchSize)
         {
-            // Nothing left to receive from the socket.  We are done.
-            le_msg_ReleaseMsg(msgRef);
+            // The socket has been drained.  If more arrives, the FD Monitor will tell us.
+            sessionPtr->rxBatchSize = count;
             break;
         }
+
+        sessionPtr->rxBatchSize = batchSize * 2;
+        if (sessionPtr->rxBatchSize > UNIXSOCKET_MAX_BATCH_MSGS)
+        {
+            sessionPtr->rxBatchSize = UNIXSOCKET_MAX_BATCH_MSGS;
+        }
     }
 }
 
@@ -980,10 +1152,59 @@ static void ServerSocketError
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finishes off a message that has been sent from the Transmit Queue.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FinishSentMessage
+(
+    msgSession_Session_t* sessionPtr,
+    le_msg_MessageRef_t msgRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (sessionPtr->interfaceRef->interfaceType)
+    {
+        // If this is the client side of the session,
+        case LE_MSG_INTERFACE_CLIENT:
+            // If a response is expected from the other side later, then put this
+            // message on the Transaction List.
+            if (msgMessage_GetTxnId(msgRef) != 0)
+            {
+                AddToTxnList(sessionPtr, msgRef);
+            }
+            // Otherwise, release it.
+            else
+            {
+                le_msg_ReleaseMsg(msgRef);
+            }
+
+            break;
+
+        // If this is the server side of the session,
+        case LE_MSG_INTERFACE_SERVER:
+            // Release the message, but first clear out the transaction ID so that
+            // the message knows that it is not being deleted without a reponse message
+            // being sent if one was expected.
+            msgMessage_SetTxnId(msgRef, 0);
+            le_msg_ReleaseMsg(msgRef);
+
+            break;
+
+        default:
+            LE_FATAL("Unhandled interface type (%d)",
+                     sessionPtr->interfaceRef->interfaceType);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Send messages from a session's Transmit Queue until either the socket becomes full or there
  * are no more messages waiting on the queue.
+ *
+ * Up to UNIXSOCKET_MAX_BATCH_MSGS queued messages are sent with each system call.
  */
 //--------------------------------------------------------------------------------------------------
 static void SendFromTransmitQueue
@@ -992,11 +1213,13 @@ static void SendFromTransmitQueue
 )
 //--------------------------------------------------------------------------------------------------
 {
+    le_msg_MessageRef_t msgArray[UNIXSOCKET_MAX_BATCH_MSGS];
+
     for (;;)
     {
-        le_msg_MessageRef_t msgRef = PopTransmitQueue(sessionPtr);
+        size_t count = PopTransmitQueueBatch(sessionPtr, msgArray, UNIXSOCKET_MAX_BATCH_MSGS);
 
-        if (msgRef == NULL)
+        if (count == 0)
         {
             // Since the Transmit Queue is empty, tell the FD Monitor that we don't need to be
             // notified about writeability anymore.
@@ -1004,51 +1227,31 @@ static void SendFromTransmitQueue
             break;
         }
 
-        le_result_t result = msgMessage_Send(sessionPtr->socketFd, msgRef);
+        size_t sentCount = count;
+        le_result_t result = msgMessage_SendBatch(sessionPtr->socketFd, msgArray, &sentCount);
+
+        if (sentCount > 0)
+        {
+            RecordBatch(&sessionPtr->txStats, sentCount);
+        }
+
+        size_t i;
+        for (i = 0; i < sentCount; i++)
+        {
+            FinishSentMessage(sessionPtr, msgArray[i]);
+        }
+
+        // Put the messages that weren't sent back on the head of the queue.
+        UnPopTransmitQueueBatch(sessionPtr, msgArray + sentCount, count - sentCount);
 
         switch (result)
         {
             case LE_OK:
-                switch (sessionPtr->interfaceRef->interfaceType)
-                {
-                    // If this is the client side of the session,
-                    case LE_MSG_INTERFACE_CLIENT:
-                        // If a response is expected from the other side later, then put this
-                        // message on the Transaction List.
-                        if (msgMessage_GetTxnId(msgRef) != 0)
-                        {
-                            AddToTxnList(sessionPtr, msgRef);
-                        }
-                        // Otherwise, release it.
-                        else
-                        {
-                            le_msg_ReleaseMsg(msgRef);
-                        }
-
-                        break;
-
-                    // If this is the server side of the session,
-                    case LE_MSG_INTERFACE_SERVER:
-                        // Release the message, but first clear out the transaction ID so that
-                        // the message knows that it is not being deleted without a reponse message
-                        // being sent if one was expected.
-                        msgMessage_SetTxnId(msgRef, 0);
-                        le_msg_ReleaseMsg(msgRef);
-
-                        break;
-
-                    default:
-                        LE_FATAL("Unhandled interface type (%d)",
-                                 sessionPtr->interfaceRef->interfaceType);
-                }
-
-                break;  // Continue to loop around and send another.
+                break;  // Continue to loop around and send more.
 
             case LE_NO_MEMORY:
-                // Have to wait for the socket to become writeable.  Put the message back on
-                // the head of the queue and ask the FD Monitor to tell us when the socket becomes
-                // writeable again.
-                UnPopTransmitQueue(sessionPtr, msgRef);
+                // Have to wait for the socket to become writeable.  Ask the FD Monitor to tell
+                // us when the socket becomes writeable again.
                 EnableWriteabilityNotification(sessionPtr);
 
                 return;
@@ -1056,10 +1259,8 @@ static void SendFromTransmitQueue
             case LE_COMM_ERROR:
                 // In this case, we expect a handler function to be called by the FD Monitor,
                 // so we don't need to handle this case here.  However, we must stop
-                // trying to transmit now.  Stick the current message back on the Transmit Queue
-                // so it gets cleaned up with the others when the session closes.
-                UnPopTransmitQueue(sessionPtr, msgRef);
-
+                // trying to transmit now.  The unsent messages are back on the Transmit Queue
+                // so they get cleaned up with the others when the session closes.
                 return;
 
             default:
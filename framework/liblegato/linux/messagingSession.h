@@ -11,6 +11,8 @@
 #define LE_MESSAGING_SESSION_H_INCLUDE_GUARD
 
 #include "messagingInterface.h"
+#include "messagingShm.h"
+#include "unixSocket.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -30,6 +32,22 @@ typedef enum
 msgSession_SessionState_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counters kept for each direction of a session's socket traffic to show how well messages are
+ * being batched into system calls (see unixSocket_SendMsgBatch() and
+ * unixSocket_ReceiveMsgBatch()).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t msgCount;    ///< Number of messages transferred.
+    size_t callCount;   ///< Number of system calls that transferred them.
+    size_t maxBatch;    ///< Largest number of messages transferred by a single system call.
+}
+msgSession_BatchStats_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Represents a client-server session.
@@ -61,6 +79,18 @@ typedef struct le_msg_Session
     void*                           openContextPtr; ///< Open handler's context pointer.
     le_msg_SessionEventHandler_t    closeHandler;   ///< Close handler function.
     void*                           closeContextPtr;///< Close handler's context pointer.
+
+    size_t                          rxBatchSize;    ///< # of messages to try to receive next time.
+    le_msg_MessageRef_t             rxSpareMsgs[UNIXSOCKET_MAX_BATCH_MSGS]; ///< Message objects left
+                                                    ///  over from earlier batches, to be received
+                                                    ///  into next time (not bound to the session).
+    size_t                          rxSpareCount;   ///< # of Message objects in rxSpareMsgs.
+    msgSession_BatchStats_t         rxStats;        ///< Batching counters for received messages.
+    msgSession_BatchStats_t         txStats;        ///< Batching counters for sent messages.
+
+    msgShm_RingRef_t                shmRingRef;     ///< Shared memory rings (NULL = not in use).
+    msgShm_RingRef_t                shmOfferedRingRef; ///< Shared memory rings offered to the
+                                                    ///  server, waiting for its answer (client).
 }
 msgSession_Session_t;
 
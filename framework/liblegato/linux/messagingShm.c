@@ -0,0 +1,548 @@
+/** @file messagingShm.c
+ *
+ * @ref c_messaging implementation's "Shared Memory Transport" module implementation.
+ *
+ * A session that uses the shared memory transport has a pair of single-producer, single-consumer
+ * rings of fixed-size slots in a memfd that is created by the client and passed to the server over
+ * the session's socket.  The server answers whether it could attach to the memfd, and neither side
+ * puts anything in the rings until that answer has been sent or received.  Ring 0 carries messages from the client to the server, and ring 1 carries
+ * messages from the server to the client.
+ *
+ * @verbatim
+ *
+ *   +--------------+-------------------------+-------------------------+
+ *   | Header       | Ring 0 (client->server) | Ring 1 (server->client) |
+ *   +--------------+-------------------------+-------------------------+
+ *                    slot 0 | slot 1 | ...
+ *                    [ size | txn ID + payload ]
+ *
+ * @endverbatim
+ *
+ * The producer copies a message into the next slot of its ring and sends a one-byte "doorbell"
+ * datagram over the socket (carrying the message's file descriptor, if any).  The consumer copies
+ * the message out of the slot when the doorbell arrives and then advances the ring's consumed
+ * counter in the header, which is how the producer knows that the slot can be reused.  Because
+ * every message still has a datagram on the socket, messages sent through the ring and messages
+ * sent through the socket are always received in the order they were sent, and the existing
+ * socket event handling, blocking and closing behaviour all stay the same.
+ *
+ * The server never trusts the contents of the shared memory: the memfd must be sealed against
+ * shrinking, the geometry is copied out of the header and checked once when attaching, and the
+ * size of every received slot is checked before it is copied.
+ *
+ * See @ref messaging.c for an overview of the @ref c_messaging implementation.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "messagingShm.h"
+#include "fileDescriptor.h"
+
+#include <sys/mman.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC         0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING   0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS         1033
+#define F_GET_SEALS         1034
+#define F_SEAL_SEAL         0x0001
+#define F_SEAL_SHRINK       0x0002
+#define F_SEAL_GROW         0x0004
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Value of the magic number at the start of the shared memory ("LEMR").
+ */
+//--------------------------------------------------------------------------------------------------
+#define SHM_MAGIC 0x524D454CU
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Alignment of slots and of the consumed counters, to keep the two sides from sharing cache lines.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SHM_ALIGN 64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of slots in each ring.  This is the number of messages that can be in flight in each
+ * direction before messages start going through the socket instead.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SHM_SLOT_COUNT 8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest shared memory that a server will accept from a client, in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SHM_MAX_BYTES (16 * 1024 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the header at the start of each slot, in bytes.  It holds the size of the message.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SLOT_HEADER_BYTES 8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Counter of slots consumed from one ring.  Written only by that ring's consumer.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t count;                         ///< Total number of slots consumed (wraps around).
+    uint8_t pad[SHM_ALIGN - sizeof(uint32_t)];
+}
+ConsumedCounter_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header at the start of the shared memory.  The geometry fields are written by the client before
+ * the memory is shared and never change afterwards.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t magic;                         ///< SHM_MAGIC.
+    uint32_t slotSize;                      ///< Size of each slot, in bytes (header included).
+    uint32_t slotCount;                     ///< Number of slots in each ring.
+    uint32_t threshold;                     ///< Smallest message to send through a ring, in bytes.
+    uint8_t pad[SHM_ALIGN - (4 * sizeof(uint32_t))];
+    ConsumedCounter_t consumed[2];          ///< Consumed counter for each ring.
+}
+SharedHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Process-local view of a ring pair.  Holds private copies of everything that must not be taken
+ * from the shared memory after it has been checked.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct msgShm_Ring
+{
+    uint8_t*    basePtr;        ///< Start of the mapping.
+    size_t      mapSize;        ///< Size of the mapping, in bytes.
+    size_t      slotSize;       ///< Size of each slot, in bytes (header included).
+    uint32_t    slotCount;      ///< Number of slots in each ring.
+    size_t      threshold;      ///< Smallest message to send through the ring, in bytes.
+    uint8_t*    txRingPtr;      ///< First slot of the ring we produce into.
+    uint8_t*    rxRingPtr;      ///< First slot of the ring we consume from.
+    uint32_t*   txConsumedPtr;  ///< Peer's consumed counter for our transmit ring.
+    uint32_t*   rxConsumedPtr;  ///< Our consumed counter for our receive ring.
+    uint32_t    txCount;        ///< Number of slots we have committed (wraps around).
+    uint32_t    rxCount;        ///< Number of slots we have consumed (wraps around).
+}
+Ring_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which Ring objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t RingPoolRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a memfd, using the system call directly so that C libraries without a wrapper still work.
+ *
+ * @return The file descriptor, or -1 on failure (errno set).
+ */
+//--------------------------------------------------------------------------------------------------
+static int CreateMemFd
+(
+    const char* namePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef SYS_memfd_create
+    return syscall(SYS_memfd_create, namePtr, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocates a Ring object for a mapping and points it at the rings inside.
+ *
+ * @return Pointer to the Ring object.
+ */
+//--------------------------------------------------------------------------------------------------
+static Ring_t* CreateRing
+(
+    void* basePtr,          ///< [IN] Start of the mapping.
+    size_t mapSize,         ///< [IN] Size of the mapping.
+    size_t slotSize,        ///< [IN] Size of each slot.
+    uint32_t slotCount,     ///< [IN] Number of slots in each ring.
+    size_t threshold,       ///< [IN] Smallest message to send through the ring.
+    int txRing              ///< [IN] Index of the ring that this side produces into (0 or 1).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Ring_t* ringPtr = le_mem_ForceAlloc(RingPoolRef);
+    SharedHeader_t* headerPtr = basePtr;
+    uint8_t* ringsPtr = (uint8_t*)basePtr + sizeof(SharedHeader_t);
+    int rxRing = 1 - txRing;
+
+    ringPtr->basePtr = basePtr;
+    ringPtr->mapSize = mapSize;
+    ringPtr->slotSize = slotSize;
+    ringPtr->slotCount = slotCount;
+    ringPtr->threshold = threshold;
+    ringPtr->txRingPtr = ringsPtr + (txRing * slotCount * slotSize);
+    ringPtr->rxRingPtr = ringsPtr + (rxRing * slotCount * slotSize);
+    ringPtr->txConsumedPtr = &headerPtr->consumed[txRing].count;
+    ringPtr->rxConsumedPtr = &headerPtr->consumed[rxRing].count;
+    ringPtr->txCount = 0;
+    ringPtr->rxCount = 0;
+
+    return ringPtr;
+}
+
+
+// =======================================
+//  PROTECTED (INTER-MODULE) FUNCTIONS
+// =======================================
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes this module.  This must be called only once at start-up, before any other functions
+ * in this module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    RingPoolRef = le_mem_CreatePool("MsgShmRing", sizeof(Ring_t));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the message size threshold configured for this process in the LE_MSG_SHM_THRESHOLD
+ * environment variable.
+ *
+ * @return The threshold, in bytes, or 0 if the shared memory transport is not enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t msgShm_GetThreshold
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* envStrPtr = getenv(MSGSHM_THRESHOLD_ENV_VAR);
+    int threshold;
+
+    if (envStrPtr == NULL)
+    {
+        return 0;
+    }
+
+    if ((le_utf8_ParseInt(&threshold, envStrPtr) != LE_OK) || (threshold <= 0))
+    {
+        LE_WARN("Ignoring invalid %s value '%s'.", MSGSHM_THRESHOLD_ENV_VAR, envStrPtr);
+        return 0;
+    }
+
+    // Anything smaller than a transaction ID could be mistaken for a control datagram.
+    if ((size_t)threshold < sizeof(void*))
+    {
+        return sizeof(void*);
+    }
+
+    return threshold;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a new ring pair in a new shared memory file (client side).
+ *
+ * @return A reference to the ring pair, or NULL on failure (check your logs).
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_RingRef_t msgShm_Create
+(
+    size_t maxMsgSize,  ///< [IN] Largest message (including the transaction ID), in bytes.
+    size_t threshold,   ///< [IN] Smallest message to send through the ring, in bytes.
+    int* fdPtr          ///< [OUT] File descriptor of the shared memory, to be sent to the server.
+                        ///        The caller must close it.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t slotSize = (SLOT_HEADER_BYTES + maxMsgSize + SHM_ALIGN - 1) & ~(size_t)(SHM_ALIGN - 1);
+    size_t mapSize = sizeof(SharedHeader_t) + (2 * SHM_SLOT_COUNT * slotSize);
+
+    if (mapSize > SHM_MAX_BYTES)
+    {
+        LE_WARN("Messages of %zu bytes are too large for the shared memory transport.",
+                maxMsgSize);
+        return NULL;
+    }
+
+    int fd = CreateMemFd("le_msg");
+    if (fd < 0)
+    {
+        LE_WARN("Failed to create shared memory for messaging. Errno = %d (%m).", errno);
+        return NULL;
+    }
+
+    if (ftruncate(fd, mapSize) != 0)
+    {
+        LE_ERROR("Failed to size shared memory. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return NULL;
+    }
+
+    // The server refuses memory that could be shrunk under it (which would make it crash).
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+    {
+        LE_ERROR("Failed to seal shared memory. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return NULL;
+    }
+
+    void* basePtr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (basePtr == MAP_FAILED)
+    {
+        LE_ERROR("Failed to map shared memory. Errno = %d (%m).", errno);
+        fd_Close(fd);
+        return NULL;
+    }
+
+    // The memory starts out zeroed, so the consumed counters are already 0.
+    SharedHeader_t* headerPtr = basePtr;
+    headerPtr->magic = SHM_MAGIC;
+    headerPtr->slotSize = slotSize;
+    headerPtr->slotCount = SHM_SLOT_COUNT;
+    headerPtr->threshold = threshold;
+
+    *fdPtr = fd;
+
+    return CreateRing(basePtr, mapSize, slotSize, SHM_SLOT_COUNT, threshold, 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Attaches to a ring pair created by the client (server side).
+ *
+ * @return A reference to the ring pair, or NULL if the shared memory was not acceptable.
+ *
+ * @note The file descriptor is always closed.
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_RingRef_t msgShm_Attach
+(
+    int fd      ///< [IN] File descriptor of the shared memory received from the client.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat fileStat;
+    void* basePtr = MAP_FAILED;
+    size_t mapSize = 0;
+    Ring_t* ringPtr = NULL;
+
+    int seals = fcntl(fd, F_GET_SEALS);
+
+    if ((seals < 0) || !(seals & F_SEAL_SHRINK))
+    {
+        LE_ERROR("Shared memory from client is not sealed against shrinking.");
+    }
+    else if (fstat(fd, &fileStat) != 0)
+    {
+        LE_ERROR("Failed to stat shared memory. Errno = %d (%m).", errno);
+    }
+    else if ((fileStat.st_size < (off_t)sizeof(SharedHeader_t))
+             || (fileStat.st_size > SHM_MAX_BYTES))
+    {
+        LE_ERROR("Shared memory from client has bad size (%lld).", (long long)fileStat.st_size);
+    }
+    else
+    {
+        mapSize = fileStat.st_size;
+        basePtr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (basePtr == MAP_FAILED)
+        {
+            LE_ERROR("Failed to map shared memory. Errno = %d (%m).", errno);
+        }
+    }
+
+    fd_Close(fd);
+
+    if (basePtr == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    // Take one copy of the geometry and only ever use that copy.
+    SharedHeader_t* headerPtr = basePtr;
+    uint32_t magic = headerPtr->magic;
+    uint32_t slotSize = headerPtr->slotSize;
+    uint32_t slotCount = headerPtr->slotCount;
+    uint32_t threshold = headerPtr->threshold;
+
+    if (   (magic != SHM_MAGIC)
+        || (slotSize <= SLOT_HEADER_BYTES + sizeof(void*))
+        || ((slotSize % SHM_ALIGN) != 0)
+        || (slotCount == 0)
+        || (slotCount > SHM_SLOT_COUNT)
+        || ((uint64_t)slotSize * slotCount * 2 > mapSize - sizeof(SharedHeader_t)) )
+    {
+        LE_ERROR("Shared memory from client has a bad header.");
+        munmap(basePtr, mapSize);
+        return NULL;
+    }
+
+    if (threshold < sizeof(void*))
+    {
+        threshold = sizeof(void*);
+    }
+
+    ringPtr = CreateRing(basePtr, mapSize, slotSize, slotCount, threshold, 1);
+
+    return ringPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Detaches from a ring pair and deletes it.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_Delete
+(
+    msgShm_RingRef_t ringRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    munmap(ringRef->basePtr, ringRef->mapSize);
+
+    le_mem_Release(ringRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the slot that a message to be sent through the ring should be copied into.
+ *
+ * Slots are handed out in order.  Several slots can be filled before their doorbells are sent,
+ * by passing the number of slots already filled in the offset.
+ *
+ * @return Pointer to the slot's data area, or NULL if the message should be sent through the
+ *         socket instead (too small, too large, or the ring is full).
+ */
+//--------------------------------------------------------------------------------------------------
+void* msgShm_GetTxSlot
+(
+    msgShm_RingRef_t ringRef,
+    size_t offset,      ///< [IN] Number of slots already filled but not yet committed.
+    size_t size         ///< [IN] Number of bytes that will be copied into the slot.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((size < ringRef->threshold) || (size > ringRef->slotSize - SLOT_HEADER_BYTES))
+    {
+        return NULL;
+    }
+
+    // The consumer advances its counter only after it has copied a message out of its slot.
+    uint32_t consumed = __atomic_load_n(ringRef->txConsumedPtr, __ATOMIC_ACQUIRE);
+    uint32_t slot = ringRef->txCount + offset;
+
+    if ((uint32_t)(slot - consumed) >= ringRef->slotCount)
+    {
+        return NULL;
+    }
+
+    uint8_t* slotPtr = ringRef->txRingPtr + ((slot % ringRef->slotCount) * ringRef->slotSize);
+
+    // The size is written now, but the consumer won't look at the slot until the doorbell arrives.
+    __atomic_store_n((uint32_t*)slotPtr, size, __ATOMIC_RELAXED);
+
+    return slotPtr + SLOT_HEADER_BYTES;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Commits slots that were filled with msgShm_GetTxSlot() once their doorbells have been sent.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_CommitTx
+(
+    msgShm_RingRef_t ringRef,
+    size_t count        ///< [IN] Number of slots whose doorbells were sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ringRef->txCount += count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the next message out of the receive ring and frees its slot.  This must be called once
+ * for each doorbell received.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the slot's contents are not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgShm_Receive
+(
+    msgShm_RingRef_t ringRef,
+    void* bufferPtr,    ///< [OUT] Buffer to copy the message into.
+    size_t* sizePtr     ///< [IN+OUT] Size of the buffer. Updated to the size of the message.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = LE_OK;
+    uint8_t* slotPtr = ringRef->rxRingPtr
+                       + ((ringRef->rxCount % ringRef->slotCount) * ringRef->slotSize);
+
+    // Read the size only once, so that the peer can't change it after it has been checked.
+    size_t size = __atomic_load_n((uint32_t*)slotPtr, __ATOMIC_ACQUIRE);
+
+    if ((size > ringRef->slotSize - SLOT_HEADER_BYTES) || (size > *sizePtr))
+    {
+        LE_ERROR("Bad message size in shared memory slot (%zu bytes).", size);
+        result = LE_FAULT;
+    }
+    else
+    {
+        memcpy(bufferPtr, slotPtr + SLOT_HEADER_BYTES, size);
+        *sizePtr = size;
+    }
+
+    // Hand the slot back to the producer, even if its contents were bad, so the rings stay in step.
+    ringRef->rxCount++;
+    __atomic_store_n(ringRef->rxConsumedPtr, ringRef->rxCount, __ATOMIC_RELEASE);
+
+    return result;
+}
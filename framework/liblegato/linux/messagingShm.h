@@ -0,0 +1,182 @@
+/** @file messagingShm.h
+ *
+ * Inter-module definitions exported by the Shared Memory Transport module of the
+ * @ref c_messaging implementation.
+ *
+ * See @ref messaging.c for an overview of the @ref c_messaging implementation.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LE_MESSAGING_SHM_H_INCLUDE_GUARD
+#define LE_MESSAGING_SHM_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name of the environment variable that enables the shared memory transport for the client-side
+ * sessions opened by a process.  Its value is the smallest message size (in bytes, including the
+ * transaction ID) that will be sent through the shared memory ring instead of the socket.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSGSHM_THRESHOLD_ENV_VAR "LE_MSG_SHM_THRESHOLD"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size (in bytes) of a "doorbell" datagram.  A doorbell is sent over the session's socket in place
+ * of a message whose contents have been placed in the next slot of the sender's ring.
+ *
+ * Real messages always carry a transaction ID, so they are never this short.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSGSHM_DOORBELL_SIZE 1
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size (in bytes) of a "setup" datagram.  A setup datagram is sent by the client over the session's
+ * socket, together with the file descriptor of the shared memory, to offer the shared memory
+ * transport on that session.  The server answers with a setup datagram of its own, whose second
+ * byte says whether it attached to the shared memory or not.  The client doesn't put anything in
+ * the shared memory until the server has accepted it.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSGSHM_SETUP_SIZE 2
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Values of the second byte of the server's answer to a setup datagram.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MSGSHM_SETUP_ACCEPTED 'Y'
+#define MSGSHM_SETUP_REFUSED  'N'
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a shared memory ring pair attached to a session.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct msgShm_Ring* msgShm_RingRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes this module.  This must be called only once at start-up, before any other functions
+ * in this module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the message size threshold configured for this process in the LE_MSG_SHM_THRESHOLD
+ * environment variable.
+ *
+ * @return The threshold, in bytes, or 0 if the shared memory transport is not enabled.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t msgShm_GetThreshold
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a new ring pair in a new shared memory file (client side).
+ *
+ * @return A reference to the ring pair, or NULL on failure (check your logs).
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_RingRef_t msgShm_Create
+(
+    size_t maxMsgSize,  ///< [IN] Largest message (including the transaction ID), in bytes.
+    size_t threshold,   ///< [IN] Smallest message to send through the ring, in bytes.
+    int* fdPtr          ///< [OUT] File descriptor of the shared memory, to be sent to the server.
+                        ///        The caller must close it.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Attaches to a ring pair created by the client (server side).
+ *
+ * @return A reference to the ring pair, or NULL if the shared memory was not acceptable.
+ *
+ * @note The file descriptor is always closed.
+ */
+//--------------------------------------------------------------------------------------------------
+msgShm_RingRef_t msgShm_Attach
+(
+    int fd      ///< [IN] File descriptor of the shared memory received from the client.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Detaches from a ring pair and deletes it.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_Delete
+(
+    msgShm_RingRef_t ringRef
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the slot that a message to be sent through the ring should be copied into.
+ *
+ * Slots are handed out in order.  Several slots can be filled before their doorbells are sent,
+ * by passing the number of slots already filled in the offset.
+ *
+ * @return Pointer to the slot's data area, or NULL if the message should be sent through the
+ *         socket instead (too small, too large, or the ring is full).
+ */
+//--------------------------------------------------------------------------------------------------
+void* msgShm_GetTxSlot
+(
+    msgShm_RingRef_t ringRef,
+    size_t offset,      ///< [IN] Number of slots already filled but not yet committed.
+    size_t size         ///< [IN] Number of bytes that will be copied into the slot.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Commits slots that were filled with msgShm_GetTxSlot() once their doorbells have been sent.
+ */
+//--------------------------------------------------------------------------------------------------
+void msgShm_CommitTx
+(
+    msgShm_RingRef_t ringRef,
+    size_t count        ///< [IN] Number of slots whose doorbells were sent.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies the next message out of the receive ring and frees its slot.  This must be called once
+ * for each doorbell received.
+ *
+ * @return
+ * - LE_OK if successful.
+ * - LE_FAULT if the slot's contents are not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t msgShm_Receive
+(
+    msgShm_RingRef_t ringRef,
+    void* bufferPtr,    ///< [OUT] Buffer to copy the message into.
+    size_t* sizePtr     ///< [IN+OUT] Size of the buffer. Updated to the size of the message.
+);
+
+
+#endif // LE_MESSAGING_SHM_H_INCLUDE_GUARD
@@ -9,6 +9,22 @@
  *       processor architectures.  Also, if they try to use a memory address as a Safe Ref,
  *       the memory address is guaranteed to be detected as an invalid Safe Reference.
  *
+ * Maps come in two kinds.  A hashmap map hands out consecutive odd numbers and looks them up in a
+ * hashmap.  A slot map (le_ref_CreateSlotMap()) hands out references made of a slot index and a
+ * generation count, laid out (from the most significant bit down) as:
+ *
+ *     | generation (SLOT_GENERATION_BITS) | slot index (SLOT_INDEX_BITS) | 1 |
+ *
+ * The lookup is then an array access followed by a check that the slot is in use and has the same
+ * generation.  A slot's generation is incremented every time it is given a new reference, and
+ * freed slots are reused oldest-first, so a stale reference is only mistaken for a valid one once
+ * its slot has been reused 2^SLOT_GENERATION_BITS times.
+ *
+ * The slots are kept in pages allocated from memory pools, so that they never move.  The first two
+ * pages hold FIRST_PAGE_SLOTS slots each and every page after that holds as many slots as all of
+ * the pages before it, so page n (n > 0) starts at the slot index whose highest set bit is
+ * bit (FIRST_PAGE_SLOT_BITS + n - 1).
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 
@@ -29,17 +45,89 @@
 /// Name used for diagnostics.
 static const char ModuleName[] = "ref";
 
+/// Number of bits of a slot map's Safe References that hold the slot index.  32-bit references
+/// use fewer, so that enough bits are left for the generation to catch stale references.
+#if UINTPTR_MAX > 0xFFFFFFFF
+#define SLOT_INDEX_BITS 20
+#else
+#define SLOT_INDEX_BITS 12
+#endif
+
+/// Number of bits of a slot map's Safe References that hold the slot's generation.
+#define SLOT_GENERATION_BITS ((sizeof(uintptr_t) * 8) - SLOT_INDEX_BITS - 1)
+
+/// Largest number of slots in a slot map.
+#define MAX_SLOTS ((size_t)1 << SLOT_INDEX_BITS)
+
+/// Mask of the slot index, once shifted down.
+#define SLOT_INDEX_MASK (MAX_SLOTS - 1)
+
+/// Mask of the slot generation, once shifted down.
+#define SLOT_GENERATION_MASK ((uintptr_t)-1 >> (SLOT_INDEX_BITS + 1))
+
+/// Number of bits of the slot index that index into the first page of slots.
+#define FIRST_PAGE_SLOT_BITS 4
+
+/// Number of slots in each of the first two pages of slots.
+#define FIRST_PAGE_SLOTS ((size_t)1 << FIRST_PAGE_SLOT_BITS)
+
+/// Number of pages of slots needed to hold MAX_SLOTS slots.
+#define MAX_SLOT_PAGES (SLOT_INDEX_BITS - FIRST_PAGE_SLOT_BITS + 1)
+
+/// Value of Slot_t::nextFree for a slot that is in use.
+#define SLOT_IN_USE UINT32_MAX
+
+/// Value of Slot_t::nextFree for the last slot on the free list, and of an empty free list.
+#define SLOT_LIST_END (UINT32_MAX - 1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * One slot of a slot map.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    void*       ptr;            ///< Pointer the slot's current Safe Reference maps to.
+    uintptr_t   generation;     ///< Generation of the slot's current (or last) Safe Reference.
+    uint32_t    nextFree;       ///< Next slot on the free list, or SLOT_IN_USE.
+}
+Slot_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterator over a Reference Map.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_ref_Iter
+{
+    struct le_ref_Map*  mapPtr;     ///< The map being iterated over.
+    le_hashmap_It_Ref_t hashmapIt;  ///< Hashmap iterator, for hashmap maps.
+    ssize_t             slotIndex;  ///< Current slot (-1 before the first), for slot maps.
+    bool                isDone;     ///< true once the end of a slot map has been reached.
+}
+Iter_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Reference Map object, which stores mappings from Safe References to pointers.
- * The actual mapping is held in a hashmap.
+ * The actual mapping is held in a hashmap, or in an array of slots for slot maps.
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct le_ref_Map
 {
     uint32_t             nextRefNum;     ///< The next Safe Reference value to be assigned.
 
-    le_hashmap_Ref_t    referenceMap;    ///< HashMap of Mapping objects.
+    le_hashmap_Ref_t    referenceMap;    ///< HashMap of Mapping objects (NULL for slot maps).
+
+    Slot_t*             pages[MAX_SLOT_PAGES]; ///< Pages of slots (slot maps only).
+    size_t              pageCount;       ///< Number of pages of slots allocated.
+    size_t              slotCount;       ///< Number of slots that have been used so far.
+    size_t              slotCapacity;    ///< Number of slots in the allocated pages.
+    uint32_t            freeHead;        ///< First (oldest) slot on the free list.
+    uint32_t            freeTail;        ///< Last (newest) slot on the free list.
+    uint32_t            firstGeneration; ///< Generation given to slots when first used.
+
+    Iter_t              iterator;        ///< The map's iterator.
 
     char          name[MAX_NAME_BYTES]; ///< The name of the map (for diagnostics).
 }
@@ -53,6 +141,14 @@ Map_t;
 //--------------------------------------------------------------------------------------------------
 static le_mem_PoolRef_t MapPool;
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pools of pages of slots, one for each page number.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t SlotPagePools[MAX_SLOT_PAGES];
+
 // =============================================
 //  PRIVATE FUNCTIONS
 // =============================================
@@ -93,6 +189,279 @@ bool equalsSafeRef
     return firstSafeRef == secondSafeRef;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate a Map object and give it its name.
+ *
+ * @return A pointer to the Map object.
+ */
+//--------------------------------------------------------------------------------------------------
+static Map_t* CreateMap
+(
+    const char* name    ///< [in] The name of the map (for diagnostics).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Map_t* mapPtr = le_mem_ForceAlloc(MapPool);
+
+    memset(mapPtr, 0, sizeof(*mapPtr));
+
+    size_t strLen;
+
+    LE_ASSERT(le_utf8_Copy(mapPtr->name, ModuleName, sizeof(mapPtr->name), &strLen) == LE_OK);
+
+    if (   le_utf8_Copy(mapPtr->name + strLen, name, sizeof(mapPtr->name) - strLen, NULL)
+        == LE_OVERFLOW)
+    {
+        LE_WARN("Map name '%s%s' truncated to '%s'.", ModuleName, name, mapPtr->name);
+    }
+
+    mapPtr->iterator.mapPtr = mapPtr;
+
+    return mapPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of slots in a page of slots.
+ *
+ * @return The number of slots.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline size_t PageSlotCount
+(
+    size_t pageNum          ///< [in] The page number.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (pageNum == 0) ? FIRST_PAGE_SLOTS : (FIRST_PAGE_SLOTS << (pageNum - 1));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a slot of a slot map.  The slot must be in one of the map's allocated pages.
+ *
+ * @return A pointer to the slot.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline Slot_t* GetSlot
+(
+    Map_t* mapPtr,          ///< [in] The slot map.
+    size_t index            ///< [in] The slot index.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (index < FIRST_PAGE_SLOTS)
+    {
+        return &mapPtr->pages[0][index];
+    }
+
+    // Every page after the first starts at a power of two.
+    unsigned int topBit = (sizeof(unsigned long) * 8 - 1) - __builtin_clzl(index);
+
+    return &mapPtr->pages[topBit - FIRST_PAGE_SLOT_BITS + 1][index - ((size_t)1 << topBit)];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a page of slots to a slot map.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddSlotPage
+(
+    Map_t* mapPtr           ///< [in] The slot map.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_FATAL_IF(mapPtr->pageCount == MAX_SLOT_PAGES,
+                "Too many Safe References in Map '%s' (max %zu).", mapPtr->name, MAX_SLOTS);
+
+    mapPtr->pages[mapPtr->pageCount] = le_mem_ForceAlloc(SlotPagePools[mapPtr->pageCount]);
+    mapPtr->slotCapacity += PageSlotCount(mapPtr->pageCount);
+    mapPtr->pageCount++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build a slot map's Safe Reference for a slot.
+ *
+ * @return The Safe Reference.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void* MakeSlotRef
+(
+    size_t index,           ///< [in] The slot index.
+    uintptr_t generation    ///< [in] The slot's generation.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (void*)(  ((generation & SLOT_GENERATION_MASK) << (SLOT_INDEX_BITS + 1))
+                   | ((uintptr_t)index << 1)
+                   | 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the slot that a slot map's Safe Reference refers to.
+ *
+ * @return A pointer to the slot, or NULL if the Safe Reference is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline Slot_t* LookupSlot
+(
+    Map_t* mapPtr,          ///< [in] The slot map.
+    void* safeRef           ///< [in] The Safe Reference.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uintptr_t ref = (uintptr_t)safeRef;
+    size_t index = (ref >> 1) & SLOT_INDEX_MASK;
+
+    if (((ref & 1) == 0) || (index >= mapPtr->slotCount))
+    {
+        return NULL;
+    }
+
+    Slot_t* slotPtr = GetSlot(mapPtr, index);
+
+    uintptr_t generation = ref >> (SLOT_INDEX_BITS + 1);
+
+    if (   (slotPtr->nextFree != SLOT_IN_USE)
+        || ((slotPtr->generation & SLOT_GENERATION_MASK) != generation))
+    {
+        return NULL;
+    }
+
+    return slotPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a Safe Reference in a slot map, in the oldest free slot if there is one, or else in a
+ * new slot.
+ *
+ * @return The Safe Reference.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* CreateSlotRef
+(
+    Map_t* mapPtr,          ///< [in] The slot map.
+    void* ptr               ///< [in] Pointer value to which the new Safe Reference will be mapped.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t index;
+    Slot_t* slotPtr;
+
+    if (mapPtr->freeHead != SLOT_LIST_END)
+    {
+        index = mapPtr->freeHead;
+        slotPtr = GetSlot(mapPtr, index);
+
+        mapPtr->freeHead = slotPtr->nextFree;
+        if (mapPtr->freeHead == SLOT_LIST_END)
+        {
+            mapPtr->freeTail = SLOT_LIST_END;
+        }
+
+        slotPtr->generation++;
+    }
+    else
+    {
+        if (mapPtr->slotCount == mapPtr->slotCapacity)
+        {
+            AddSlotPage(mapPtr);
+        }
+
+        index = mapPtr->slotCount++;
+        slotPtr = GetSlot(mapPtr, index);
+
+        slotPtr->generation = mapPtr->firstGeneration;
+    }
+
+    // Generation 0 would make the slot 0 reference 0x1, which is too much like a small integer.
+    if ((slotPtr->generation & SLOT_GENERATION_MASK) == 0)
+    {
+        slotPtr->generation++;
+    }
+
+    slotPtr->ptr = ptr;
+    slotPtr->nextFree = SLOT_IN_USE;
+
+    return MakeSlotRef(index, slotPtr->generation);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a Safe Reference from a slot map, putting its slot at the end of the free list.
+ *
+ * @return true if the Safe Reference was valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DeleteSlotRef
+(
+    Map_t* mapPtr,          ///< [in] The slot map.
+    void* safeRef           ///< [in] The Safe Reference to be deleted.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Slot_t* slotPtr = LookupSlot(mapPtr, safeRef);
+
+    if (slotPtr == NULL)
+    {
+        return false;
+    }
+
+    uint32_t index = ((uintptr_t)safeRef >> 1) & SLOT_INDEX_MASK;
+
+    slotPtr->ptr = NULL;
+    slotPtr->nextFree = SLOT_LIST_END;
+
+    if (mapPtr->freeTail == SLOT_LIST_END)
+    {
+        mapPtr->freeHead = index;
+    }
+    else
+    {
+        GetSlot(mapPtr, mapPtr->freeTail)->nextFree = index;
+    }
+    mapPtr->freeTail = index;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the slot that a slot map's iterator is pointing at.
+ *
+ * @return A pointer to the slot, or NULL if the iterator is not pointing at a slot that is in use.
+ */
+//--------------------------------------------------------------------------------------------------
+static Slot_t* GetIterSlot
+(
+    Iter_t* iterPtr         ///< [in] The slot map's iterator.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (iterPtr->isDone || (iterPtr->slotIndex < 0))
+    {
+        return NULL;
+    }
+
+    Slot_t* slotPtr = GetSlot(iterPtr->mapPtr, iterPtr->slotIndex);
+
+    return (slotPtr->nextFree == SLOT_IN_USE) ? slotPtr : NULL;
+}
+
+
 // =============================================
 //  PROTECTED (Intra-Module) FUNCTIONS
 // =============================================
@@ -114,6 +483,19 @@ void safeRef_Init
     // Initialize the Map Pool.
     MapPool = le_mem_CreatePool("SafeRef-Map", sizeof(Map_t));
     le_mem_ExpandPool(MapPool, DEFAULT_MAP_POOL_SIZE);
+
+    // Initialize the pools of pages of slots.  They start out empty, as most programs don't use
+    // slot maps.
+    size_t pageNum;
+
+    for (pageNum = 0; pageNum < MAX_SLOT_PAGES; pageNum++)
+    {
+        char poolName[MAX_NAME_BYTES];
+
+        snprintf(poolName, sizeof(poolName), "SafeRef-SlotPage%zu", pageNum);
+        SlotPagePools[pageNum] = le_mem_CreatePool(poolName,
+                                                   PageSlotCount(pageNum) * sizeof(Slot_t));
+    }
 }
 
 
@@ -137,17 +519,7 @@ le_ref_MapRef_t le_ref_CreateMap
 )
 //--------------------------------------------------------------------------------------------------
 {
-    Map_t* mapPtr = le_mem_ForceAlloc(MapPool);
-
-    size_t strLen;
-
-    LE_ASSERT(le_utf8_Copy(mapPtr->name, ModuleName, sizeof(mapPtr->name), &strLen) == LE_OK);
-
-    if (   le_utf8_Copy(mapPtr->name + strLen, name, sizeof(mapPtr->name) - strLen, NULL)
-        == LE_OVERFLOW)
-    {
-        LE_WARN("Map name '%s%s' truncated to '%s'.", ModuleName, name, mapPtr->name);
-    }
+    Map_t* mapPtr = CreateMap(name);
 
     /// @todo Make this a random number so that using a reference from another Map is unlikely to
     ///       get by undetected.
@@ -163,6 +535,52 @@ le_ref_MapRef_t le_ref_CreateMap
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a Reference Map that keeps its mappings in an array of slots.
+ *
+ * @return A reference to the Reference Map object.
+ */
+//--------------------------------------------------------------------------------------------------
+le_ref_MapRef_t le_ref_CreateSlotMap
+(
+    const char* name,   ///< [in] The name of the map (for diagnostics).
+
+    size_t      maxRefs ///< [in] The maximum number of Safe References expected to be kept in
+                        ///       this Reference Map at any one time.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Each map starts its slots at a different generation, so that a reference from another map
+    // is unlikely to get by undetected.
+    static uint32_t NextFirstGeneration = 1;
+
+    Map_t* mapPtr = CreateMap(name);
+
+    if (maxRefs == 0)
+    {
+        maxRefs = 1;
+    }
+    else if (maxRefs > MAX_SLOTS)
+    {
+        maxRefs = MAX_SLOTS;
+    }
+
+    while (mapPtr->slotCapacity < maxRefs)
+    {
+        AddSlotPage(mapPtr);
+    }
+
+    mapPtr->freeHead = SLOT_LIST_END;
+    mapPtr->freeTail = SLOT_LIST_END;
+    mapPtr->firstGeneration = NextFirstGeneration;
+
+    NextFirstGeneration += 0x101;
+
+    return mapPtr;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a Safe Reference, storing a mapping between that reference and a given pointer for
@@ -178,6 +596,11 @@ void* le_ref_CreateRef
 )
 //--------------------------------------------------------------------------------------------------
 {
+    if (mapRef->referenceMap == NULL)
+    {
+        return CreateSlotRef(mapRef, ptr);
+    }
+
     ssize_t thisRef = mapRef->nextRefNum;
 
     le_hashmap_Put(mapRef->referenceMap, (const void*)(thisRef), ptr);
@@ -204,6 +627,13 @@ void* le_ref_Lookup
 )
 //--------------------------------------------------------------------------------------------------
 {
+    if (mapRef->referenceMap == NULL)
+    {
+        Slot_t* slotPtr = LookupSlot(mapRef, safeRef);
+
+        return (slotPtr == NULL) ? NULL : slotPtr->ptr;
+    }
+
     return le_hashmap_Get(mapRef->referenceMap, safeRef);
 }
 
@@ -220,7 +650,18 @@ void le_ref_DeleteRef
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (le_hashmap_Remove(mapRef->referenceMap, safeRef) == NULL)
+    bool isFound;
+
+    if (mapRef->referenceMap == NULL)
+    {
+        isFound = DeleteSlotRef(mapRef, safeRef);
+    }
+    else
+    {
+        isFound = (le_hashmap_Remove(mapRef->referenceMap, safeRef) != NULL);
+    }
+
+    if (!isFound)
     {
         LE_ERROR("Deleting non-existent Safe Reference %p from Map '%s'.", safeRef, mapRef->name);
     }
@@ -234,8 +675,8 @@ void le_ref_DeleteRef
  * per map, and calling this function resets the iterator position to the start of the map.  The
  * iterator is not ready for data access until le_ref_NextNode() has been called at least once.
  *
- * @return  Returns A reference to a hashmap iterator which is ready for le_hashmap_NextNode() to be
- *          called on it.
+ * @return  Returns A reference to an iterator which is ready for le_ref_NextNode() to be called
+ *          on it.
  */
 //--------------------------------------------------------------------------------------------------
 le_ref_IterRef_t le_ref_GetIterator
@@ -243,7 +684,19 @@ le_ref_IterRef_t le_ref_GetIterator
     le_ref_MapRef_t mapRef ///< [in] Reference to the map.
 )
 {
-    return (le_ref_IterRef_t)le_hashmap_GetIterator(mapRef->referenceMap);
+    Iter_t* iterPtr = &mapRef->iterator;
+
+    if (mapRef->referenceMap == NULL)
+    {
+        iterPtr->slotIndex = -1;
+        iterPtr->isDone = false;
+    }
+    else
+    {
+        iterPtr->hashmapIt = le_hashmap_GetIterator(mapRef->referenceMap);
+    }
+
+    return iterPtr;
 }
 
 
@@ -261,7 +714,33 @@ le_result_t le_ref_NextNode
     le_ref_IterRef_t iteratorRef ///< [IN] Reference to the iterator.
 )
 {
-    return le_hashmap_NextNode((le_hashmap_It_Ref_t)iteratorRef);
+    Map_t* mapPtr = iteratorRef->mapPtr;
+
+    if (mapPtr->referenceMap != NULL)
+    {
+        return le_hashmap_NextNode(iteratorRef->hashmapIt);
+    }
+
+    if (iteratorRef->isDone)
+    {
+        return LE_FAULT;
+    }
+
+    // Slots only ever get added at the end, and deleting the current one is fine, so the
+    // iteration carries on from the current index whatever has changed.
+    for (iteratorRef->slotIndex++;
+         iteratorRef->slotIndex < (ssize_t)mapPtr->slotCount;
+         iteratorRef->slotIndex++)
+    {
+        if (GetSlot(mapPtr, iteratorRef->slotIndex)->nextFree == SLOT_IN_USE)
+        {
+            return LE_OK;
+        }
+    }
+
+    iteratorRef->isDone = true;
+
+    return LE_NOT_FOUND;
 }
 
 
@@ -280,7 +759,16 @@ const void* le_ref_GetSafeRef
     le_ref_IterRef_t iteratorRef ///< [IN] Reference to the iterator.
 )
 {
-    return le_hashmap_GetKey((le_hashmap_It_Ref_t)iteratorRef);
+    Map_t* mapPtr = iteratorRef->mapPtr;
+
+    if (mapPtr->referenceMap != NULL)
+    {
+        return le_hashmap_GetKey(iteratorRef->hashmapIt);
+    }
+
+    Slot_t* slotPtr = GetIterSlot(iteratorRef);
+
+    return (slotPtr == NULL) ? NULL : MakeSlotRef(iteratorRef->slotIndex, slotPtr->generation);
 }
 
 
@@ -299,5 +787,14 @@ void* le_ref_GetValue
     le_ref_IterRef_t iteratorRef ///< [IN] Reference to the iterator.
 )
 {
-    return le_hashmap_GetValue((le_hashmap_It_Ref_t)iteratorRef);
+    Map_t* mapPtr = iteratorRef->mapPtr;
+
+    if (mapPtr->referenceMap != NULL)
+    {
+        return le_hashmap_GetValue(iteratorRef->hashmapIt);
+    }
+
+    Slot_t* slotPtr = GetIterSlot(iteratorRef);
+
+    return (slotPtr == NULL) ? NULL : slotPtr->ptr;
 }
@@ -0,0 +1,762 @@
+//--------------------------------------------------------------------------------------------------
+/** @file threadPool.c
+ *
+ * Legato @ref c_threadPool implementation.
+ *
+ * Each pool has a shared queue for work submitted from outside the pool, and an array of worker
+ * slots, each with its own queue for work submitted by the worker in that slot.  Every queue is a
+ * doubly linked list of Work Items with its own mutex: the owner of a worker queue pushes and pops
+ * at its tail, and everybody else takes from the heads.  The queues are short-lived critical
+ * sections that are rarely contended, since a worker only touches another worker's queue when
+ * it has nothing else to do.
+ *
+ * The pool's count of queued Work Items (queueDepth) tells idle workers whether there is anything
+ * to look for.  It is only ever increased while holding the pool's mutex, and idle workers check
+ * it while holding that mutex before waiting on the pool's condition variable, so a submission
+ * can't be missed.  It is increased before the Work Item is queued, and workers decrease it
+ * atomically after they have taken a Work Item, so it never drops below zero.  (The pool's mutex
+ * is held while queueing, so the queues' mutexes are always locked after the pool's.)
+ *
+ * The worker threads are Legato threads, so the work functions can use Legato APIs, but they
+ * don't run their Event Loops.  Completion functions are queued to the submitting thread's Event
+ * Loop with le_event_QueueFunctionToThread().
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "threadPool.h"
+#include "thread.h"
+
+#include <pthread.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of milliseconds that a worker above a pool's minimum number of workers waits for work
+ * before stopping.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IDLE_TIMEOUT_MS 10000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The default number of objects in the process-wide Work Item Pool.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_WORK_ITEM_POOL_SIZE 10
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work Item.  One of these is allocated for each call to le_threadPool_Submit().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t               link;           ///< Used to link into a Work Queue.
+    le_threadPool_WorkFunc_t    workFunc;       ///< Function to call in a worker.
+    le_threadPool_WorkFunc_t    completionFunc; ///< Function to queue to the submitter, or NULL.
+    void*                       param1Ptr;      ///< First parameter to pass to the functions.
+    void*                       param2Ptr;      ///< Second parameter to pass to the functions.
+    le_thread_Ref_t             submitter;      ///< Thread that submitted the work.
+    uint64_t                    submitTime;     ///< Relative time of submission (microseconds).
+}
+WorkItem_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work Queue.  Double-ended queue of Work Items, protected by its own mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    pthread_mutex_t     mutex;          ///< Protects the list.
+    le_dls_List_t       list;           ///< List of Work Items.
+}
+WorkQueue_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Worker slot.  A pool has one of these for each of the workers it can have running at once.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    struct le_threadPool*   poolPtr;        ///< Pool that the slot belongs to.
+    WorkQueue_t             queue;          ///< Work submitted by the worker in this slot.
+    bool                    isRunning;      ///< true if a worker is running in this slot.
+}
+Worker_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread Pool object.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_threadPool
+{
+    char                name[MAX_THREAD_NAME_SIZE]; ///< Name of the pool and its workers.
+    size_t              minThreads;     ///< Number of workers that are always running.
+    size_t              maxThreads;     ///< Maximum number of workers (and number of slots).
+    Worker_t*           workersPtr;     ///< Array of maxThreads worker slots.
+    WorkQueue_t         sharedQueue;    ///< Work submitted from outside the pool.
+
+    pthread_mutex_t     mutex;          ///< Protects the members below that aren't atomic.
+    pthread_cond_t      workCond;       ///< Signalled when work is queued or workers stop.
+    size_t              numThreads;     ///< Number of workers running.
+    size_t              numIdle;        ///< Number of workers waiting on workCond.
+    size_t              numWaking;      ///< Number of idle workers signalled but not yet awake.
+    bool                isDeleting;     ///< true if le_threadPool_Delete() has been called.
+
+    // Statistics, updated atomically.
+    size_t              queueDepth;     ///< Number of queued Work Items.
+    size_t              maxQueueDepth;  ///< Maximum value of queueDepth.
+    size_t              maxNumThreads;  ///< Maximum value of numThreads.
+    uint64_t            numCompleted;   ///< Number of Work Items run.
+    uint64_t            numStolen;      ///< Number of Work Items taken from another worker's queue.
+    uint64_t            totalWaitTime;  ///< Total microseconds between submitting and starting.
+    uint64_t            maxWaitTime;    ///< Maximum microseconds between submitting and starting.
+    uint64_t            totalRunTime;   ///< Total microseconds spent running Work Items.
+}
+Pool_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which Thread Pool objects are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t ThreadPoolPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool from which Work Items are allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t WorkItemPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key used to store a pointer to the calling worker's slot in thread-local storage.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_key_t WorkerKey;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the relative time, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetTimeUsec
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000000) + now.usec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts microseconds to a le_clk_Time_t.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_clk_Time_t UsecToTime
+(
+    uint64_t usec
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t time = { .sec = usec / 1000000, .usec = usec % 1000000 };
+
+    return time;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Atomically raises a statistic to a value, if the value is higher.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateMaxSize
+(
+    size_t* maxPtr,
+    size_t value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t max = __atomic_load_n(maxPtr, __ATOMIC_RELAXED);
+
+    while ((value > max) &&
+           !__atomic_compare_exchange_n(maxPtr, &max, value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        // max has been refreshed, so just try again.
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Atomically raises a 64-bit statistic to a value, if the value is higher.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateMaxUint64
+(
+    uint64_t* maxPtr,
+    uint64_t value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t max = __atomic_load_n(maxPtr, __ATOMIC_RELAXED);
+
+    while ((value > max) &&
+           !__atomic_compare_exchange_n(maxPtr, &max, value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        // max has been refreshed, so just try again.
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes a Work Queue.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InitQueue
+(
+    WorkQueue_t* queuePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(pthread_mutex_init(&queuePtr->mutex, NULL) == 0);
+    queuePtr->list = LE_DLS_LIST_INIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pushes a Work Item onto the tail of a Work Queue.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushWork
+(
+    WorkQueue_t* queuePtr,
+    WorkItem_t* itemPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(pthread_mutex_lock(&queuePtr->mutex) == 0);
+    le_dls_Queue(&queuePtr->list, &itemPtr->link);
+    LE_ASSERT(pthread_mutex_unlock(&queuePtr->mutex) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pops a Work Item off the head or the tail of a Work Queue.
+ *
+ * @return Pointer to the Work Item, or NULL if the queue is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static WorkItem_t* PopWork
+(
+    WorkQueue_t* queuePtr,
+    bool fromTail           ///< true to pop the newest item, false to pop the oldest.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr;
+
+    // Don't bother locking an empty queue.  If something is being pushed onto it right now, the
+    // count of queued Work Items will make the caller look again.
+    if (le_dls_IsEmpty(&queuePtr->list))
+    {
+        return NULL;
+    }
+
+    LE_ASSERT(pthread_mutex_lock(&queuePtr->mutex) == 0);
+    linkPtr = fromTail ? le_dls_PopTail(&queuePtr->list) : le_dls_Pop(&queuePtr->list);
+    LE_ASSERT(pthread_mutex_unlock(&queuePtr->mutex) == 0);
+
+    return (linkPtr == NULL) ? NULL : CONTAINER_OF(linkPtr, WorkItem_t, link);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes the next Work Item for a worker: the newest item on its own queue, or else the oldest on
+ * the pool's shared queue, or else the oldest on another worker's queue.
+ *
+ * @return Pointer to the Work Item, or NULL if none was found.
+ */
+//--------------------------------------------------------------------------------------------------
+static WorkItem_t* TakeWork
+(
+    Worker_t* workerPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Pool_t* poolPtr = workerPtr->poolPtr;
+
+    WorkItem_t* itemPtr = PopWork(&workerPtr->queue, true);
+
+    if (itemPtr == NULL)
+    {
+        itemPtr = PopWork(&poolPtr->sharedQueue, false);
+    }
+
+    if (itemPtr == NULL)
+    {
+        // Start with the next slot, so that the workers don't all go after the same victim.
+        size_t first = (workerPtr - poolPtr->workersPtr) + 1;
+        size_t i;
+
+        for (i = 0; (i < poolPtr->maxThreads - 1) && (itemPtr == NULL); i++)
+        {
+            itemPtr = PopWork(&poolPtr->workersPtr[(first + i) % poolPtr->maxThreads].queue,
+                              false);
+        }
+
+        if (itemPtr != NULL)
+        {
+            __atomic_add_fetch(&poolPtr->numStolen, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (itemPtr != NULL)
+    {
+        __atomic_sub_fetch(&poolPtr->queueDepth, 1, __ATOMIC_RELAXED);
+    }
+
+    return itemPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs a Work Item, queues its completion function (if any) and releases it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunWork
+(
+    Pool_t* poolPtr,
+    WorkItem_t* itemPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t startTime = GetTimeUsec();
+    uint64_t waitTime = startTime - itemPtr->submitTime;
+
+    itemPtr->workFunc(itemPtr->param1Ptr, itemPtr->param2Ptr);
+
+    uint64_t runTime = GetTimeUsec() - startTime;
+
+    __atomic_add_fetch(&poolPtr->totalWaitTime, waitTime, __ATOMIC_RELAXED);
+    UpdateMaxUint64(&poolPtr->maxWaitTime, waitTime);
+    __atomic_add_fetch(&poolPtr->totalRunTime, runTime, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&poolPtr->numCompleted, 1, __ATOMIC_RELAXED);
+
+    if (itemPtr->completionFunc != NULL)
+    {
+        le_event_QueueFunctionToThread(itemPtr->submitter,
+                                       itemPtr->completionFunc,
+                                       itemPtr->param1Ptr,
+                                       itemPtr->param2Ptr);
+    }
+
+    le_mem_Release(itemPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Waits until there is work for a worker, or until the worker should stop.
+ *
+ * @return true if there is work, false if the worker has stopped (in which case it has been
+ *         taken off the pool's count of running workers).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool WaitForWork
+(
+    Worker_t* workerPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Pool_t* poolPtr = workerPtr->poolPtr;
+    bool isStopping = false;
+
+    LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+
+    while ((__atomic_load_n(&poolPtr->queueDepth, __ATOMIC_RELAXED) == 0) && !isStopping)
+    {
+        if (poolPtr->isDeleting)
+        {
+            isStopping = true;
+        }
+        else if (poolPtr->numThreads > poolPtr->minThreads)
+        {
+            struct timespec deadline;
+            LE_ASSERT(clock_gettime(CLOCK_MONOTONIC, &deadline) == 0);
+            deadline.tv_sec += IDLE_TIMEOUT_MS / 1000;
+            deadline.tv_nsec += (IDLE_TIMEOUT_MS % 1000) * 1000000;
+            if (deadline.tv_nsec >= 1000000000)
+            {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000;
+            }
+
+            poolPtr->numIdle++;
+            int result = pthread_cond_timedwait(&poolPtr->workCond, &poolPtr->mutex, &deadline);
+            poolPtr->numIdle--;
+            if (poolPtr->numWaking > 0)
+            {
+                poolPtr->numWaking--;
+            }
+
+            if ((result == ETIMEDOUT) &&
+                (__atomic_load_n(&poolPtr->queueDepth, __ATOMIC_RELAXED) == 0) &&
+                (poolPtr->numThreads > poolPtr->minThreads))
+            {
+                isStopping = true;
+            }
+        }
+        else
+        {
+            poolPtr->numIdle++;
+            LE_ASSERT(pthread_cond_wait(&poolPtr->workCond, &poolPtr->mutex) == 0);
+            poolPtr->numIdle--;
+            if (poolPtr->numWaking > 0)
+            {
+                poolPtr->numWaking--;
+            }
+        }
+    }
+
+    if (isStopping)
+    {
+        workerPtr->isRunning = false;
+        poolPtr->numThreads--;
+
+        // Let le_threadPool_Delete() know, in case it is waiting for the workers to stop.
+        LE_ASSERT(pthread_cond_broadcast(&poolPtr->workCond) == 0);
+    }
+
+    LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+
+    return !isStopping;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Worker thread main function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* WorkerMain
+(
+    void* contextPtr    ///< Pointer to the worker's slot.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Worker_t* workerPtr = contextPtr;
+
+    LE_ASSERT(pthread_setspecific(WorkerKey, workerPtr) == 0);
+
+    do
+    {
+        WorkItem_t* itemPtr;
+
+        while (NULL != (itemPtr = TakeWork(workerPtr)))
+        {
+            RunWork(workerPtr->poolPtr, itemPtr);
+        }
+    }
+    while (WaitForWork(workerPtr));
+
+    // NOTE: The pool may have been deleted by now, so don't touch it.
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a worker in a free slot.
+ *
+ * @warning Assumes the pool's mutex is locked, and that a slot is free.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartWorker
+(
+    Pool_t* poolPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t i;
+
+    for (i = 0; poolPtr->workersPtr[i].isRunning; i++)
+    {
+        LE_ASSERT(i < poolPtr->maxThreads - 1);
+    }
+
+    Worker_t* workerPtr = &poolPtr->workersPtr[i];
+    workerPtr->isRunning = true;
+
+    poolPtr->numThreads++;
+    UpdateMaxSize(&poolPtr->maxNumThreads, poolPtr->numThreads);
+
+    le_thread_Start(le_thread_Create(poolPtr->name, WorkerMain, workerPtr));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the Thread Pool Module.
+ *
+ * This function must be called exactly once at process start-up, before any Thread Pool API
+ * functions are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void threadPool_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ThreadPoolPool = le_mem_CreatePool("ThreadPool", sizeof(Pool_t));
+
+    WorkItemPool = le_mem_CreatePool("ThreadPoolWork", sizeof(WorkItem_t));
+    le_mem_ExpandPool(WorkItemPool, DEFAULT_WORK_ITEM_POOL_SIZE);
+
+    LE_ASSERT(pthread_key_create(&WorkerKey, NULL) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a thread pool.
+ *
+ * @return Reference to the pool.
+ *
+ * @note Terminates the process on failure, no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_threadPool_Ref_t le_threadPool_Create
+(
+    const char* name,           ///< [IN] Name of the pool, used to name its worker threads.
+    size_t      minThreads,     ///< [IN] Number of workers that are always running.
+    size_t      maxThreads      ///< [IN] Maximum number of workers (must be at least 1, and no
+                                ///<      less than minThreads).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_FATAL_IF((maxThreads == 0) || (minThreads > maxThreads),
+                "Invalid number of threads (%zu..%zu) for thread pool '%s'.",
+                minThreads,
+                maxThreads,
+                name);
+
+    Pool_t* poolPtr = le_mem_ForceAlloc(ThreadPoolPool);
+    memset(poolPtr, 0, sizeof(*poolPtr));
+
+    // The name is truncated to fit the workers' names.
+    le_utf8_Copy(poolPtr->name, name, sizeof(poolPtr->name), NULL);
+    poolPtr->minThreads = minThreads;
+    poolPtr->maxThreads = maxThreads;
+
+    poolPtr->workersPtr = calloc(maxThreads, sizeof(Worker_t));
+    LE_ASSERT(poolPtr->workersPtr != NULL);
+
+    size_t i;
+    for (i = 0; i < maxThreads; i++)
+    {
+        poolPtr->workersPtr[i].poolPtr = poolPtr;
+        InitQueue(&poolPtr->workersPtr[i].queue);
+    }
+    InitQueue(&poolPtr->sharedQueue);
+
+    pthread_condattr_t condAttr;
+    LE_ASSERT(pthread_condattr_init(&condAttr) == 0);
+    LE_ASSERT(pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC) == 0);
+    LE_ASSERT(pthread_cond_init(&poolPtr->workCond, &condAttr) == 0);
+    pthread_condattr_destroy(&condAttr);
+
+    LE_ASSERT(pthread_mutex_init(&poolPtr->mutex, NULL) == 0);
+
+    LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+    for (i = 0; i < minThreads; i++)
+    {
+        StartWorker(poolPtr);
+    }
+    LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+
+    return poolPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Submits work to a thread pool.
+ *
+ * The work function will be called by one of the pool's worker threads.  Then, if a completion
+ * function is given, it will be queued to the calling thread's Event Loop.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_Submit
+(
+    le_threadPool_Ref_t         pool,           ///< [IN] The pool.
+    le_threadPool_WorkFunc_t    workFunc,       ///< [IN] Function to call in a worker thread.
+    le_threadPool_WorkFunc_t    completionFunc, ///< [IN] Function to call in the calling thread
+                                                ///<      afterwards, or NULL.
+    void*                       param1Ptr,      ///< [IN] Value to pass to both functions.
+    void*                       param2Ptr       ///< [IN] Value to pass to both functions.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Pool_t* poolPtr = pool;
+
+    LE_ASSERT(workFunc != NULL);
+
+    WorkItem_t* itemPtr = le_mem_ForceAlloc(WorkItemPool);
+    itemPtr->link = LE_DLS_LINK_INIT;
+    itemPtr->workFunc = workFunc;
+    itemPtr->completionFunc = completionFunc;
+    itemPtr->param1Ptr = param1Ptr;
+    itemPtr->param2Ptr = param2Ptr;
+    itemPtr->submitter = (completionFunc != NULL) ? le_thread_GetCurrent() : NULL;
+    itemPtr->submitTime = GetTimeUsec();
+
+    LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+
+    LE_FATAL_IF(poolPtr->isDeleting, "Work submitted to thread pool '%s' while deleting it.",
+                poolPtr->name);
+
+    // Count the Work Item before queueing it, so that a worker can't take it and decrement the
+    // count first.
+    size_t depth = __atomic_add_fetch(&poolPtr->queueDepth, 1, __ATOMIC_RELAXED);
+    UpdateMaxSize(&poolPtr->maxQueueDepth, depth);
+
+    // Work submitted by one of the pool's own workers goes onto that worker's queue.
+    Worker_t* workerPtr = pthread_getspecific(WorkerKey);
+    if ((workerPtr != NULL) && (workerPtr->poolPtr == poolPtr))
+    {
+        PushWork(&workerPtr->queue, itemPtr);
+    }
+    else
+    {
+        PushWork(&poolPtr->sharedQueue, itemPtr);
+    }
+
+    // Wake up an idle worker that isn't already being woken up, or else start a new one, if
+    // the pool is allowed to grow.  Otherwise, a busy worker will take the work when it is done.
+    if (poolPtr->numIdle > poolPtr->numWaking)
+    {
+        poolPtr->numWaking++;
+        LE_ASSERT(pthread_cond_signal(&poolPtr->workCond) == 0);
+    }
+    else if (poolPtr->numThreads < poolPtr->maxThreads)
+    {
+        StartWorker(poolPtr);
+    }
+
+    LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fetches the statistics for a thread pool.
+ *
+ * @return
+ *      Nothing.  Uses output parameter instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_GetStats
+(
+    le_threadPool_Ref_t     pool,       ///< [IN] The pool.
+    le_threadPool_Stats_t*  statsPtr    ///< [OUT] Pointer to where the stats will be stored.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Pool_t* poolPtr = pool;
+
+    LE_ASSERT(statsPtr != NULL);
+
+    LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+    statsPtr->numThreads = poolPtr->numThreads;
+    LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+
+    statsPtr->maxNumThreads = __atomic_load_n(&poolPtr->maxNumThreads, __ATOMIC_RELAXED);
+    statsPtr->queueDepth = __atomic_load_n(&poolPtr->queueDepth, __ATOMIC_RELAXED);
+    statsPtr->maxQueueDepth = __atomic_load_n(&poolPtr->maxQueueDepth, __ATOMIC_RELAXED);
+    statsPtr->numCompleted = __atomic_load_n(&poolPtr->numCompleted, __ATOMIC_RELAXED);
+    statsPtr->numStolen = __atomic_load_n(&poolPtr->numStolen, __ATOMIC_RELAXED);
+    statsPtr->totalWaitTime = UsecToTime(__atomic_load_n(&poolPtr->totalWaitTime,
+                                                         __ATOMIC_RELAXED));
+    statsPtr->maxWaitTime = UsecToTime(__atomic_load_n(&poolPtr->maxWaitTime, __ATOMIC_RELAXED));
+    statsPtr->totalRunTime = UsecToTime(__atomic_load_n(&poolPtr->totalRunTime,
+                                                        __ATOMIC_RELAXED));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a thread pool, after running all the work that has been submitted to it.
+ *
+ * @warning Blocks until all the pool's workers have stopped, so it must not be called by one of
+ *          them.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_threadPool_Delete
+(
+    le_threadPool_Ref_t     pool        ///< [IN] The pool.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Pool_t* poolPtr = pool;
+
+    Worker_t* workerPtr = pthread_getspecific(WorkerKey);
+    LE_FATAL_IF((workerPtr != NULL) && (workerPtr->poolPtr == poolPtr),
+                "Thread pool '%s' deleted by one of its own workers.", poolPtr->name);
+
+    LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+
+    // Workers only stop once there is no work left, so all the work that has been submitted
+    // will be run before the last one stops.
+    poolPtr->isDeleting = true;
+
+    LE_ASSERT(pthread_cond_broadcast(&poolPtr->workCond) == 0);
+
+    while (poolPtr->numThreads > 0)
+    {
+        LE_ASSERT(pthread_cond_wait(&poolPtr->workCond, &poolPtr->mutex) == 0);
+    }
+
+    LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+
+    size_t i;
+    for (i = 0; i < poolPtr->maxThreads; i++)
+    {
+        pthread_mutex_destroy(&poolPtr->workersPtr[i].queue.mutex);
+    }
+    pthread_mutex_destroy(&poolPtr->sharedQueue.mutex);
+    pthread_mutex_destroy(&poolPtr->mutex);
+    pthread_cond_destroy(&poolPtr->workCond);
+
+    free(poolPtr->workersPtr);
+    le_mem_Release(poolPtr);
+}
@@ -0,0 +1,26 @@
+/** @file threadPool.h
+ *
+ * Thread Pool module's inter-module interface include file.
+ *
+ * This file defines interfaces that are for use by other modules in the framework implementation.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_SRC_THREAD_POOL_H_INCLUDE_GUARD
+#define LEGATO_SRC_THREAD_POOL_H_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the Thread Pool Module.
+ *
+ * This function must be called exactly once at process start-up, before any Thread Pool API
+ * functions are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void threadPool_Init
+(
+    void
+);
+
+#endif // LEGATO_SRC_THREAD_POOL_H_INCLUDE_GUARD
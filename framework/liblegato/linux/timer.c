@@ -23,6 +23,10 @@
 #define DEFAULT_REFMAP_NAME "Default Timer SafeRefs"
 #define DEFAULT_REFMAP_MAXSIZE 23
 
+/// Number of entries initially allocated for a thread's timer heap.  The heap doubles in size
+/// whenever it fills up.
+#define TIMER_HEAP_INITIAL_SIZE 8
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -119,9 +123,13 @@ static Timer_t* CreateTimer
     timerPtr->interval = (le_clk_Time_t){0, 0};
     timerPtr->repeatCount = 1;
     timerPtr->contextPtr = NULL;
+    timerPtr->slack = (le_clk_Time_t){0, 0};
     timerPtr->link = LE_DLS_LINK_INIT;
     timerPtr->isActive = false;
     timerPtr->expiryTime = (le_clk_Time_t){0, 0};
+    timerPtr->latestExpiryTime = (le_clk_Time_t){0, 0};
+    timerPtr->heapIndex = 0;
+    timerPtr->heapSeqNum = 0;
     timerPtr->expiryCount = 0;
     timerPtr->safeRef = NULL;
     timerPtr->safeRef = le_ref_CreateRef(SafeRefMap, timerPtr);
@@ -133,108 +141,181 @@ static Timer_t* CreateTimer
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add the timer record to the given list, sorted according to the timer value
+ * Compare two timers by their position in the timer heap.
+ *
+ * @return
+ *      true if the first timer must expire before the second one.
  */
 //--------------------------------------------------------------------------------------------------
-static void AddToTimerList
+static inline bool IsBefore
 (
-    le_dls_List_t* listPtr,               ///< [IN] The list to add to.
-    Timer_t* newTimerPtr                  ///< [IN] The timer to add
+    const Timer_t* aPtr,                ///< [IN] First timer.
+    const Timer_t* bPtr                 ///< [IN] Second timer.
 )
 {
-    Timer_t* timerPtr;
-    le_dls_Link_t* linkPtr;
-
-    if ( newTimerPtr->isActive )
+    if (le_clk_Equal(aPtr->latestExpiryTime, bPtr->latestExpiryTime))
     {
-        LE_ERROR("Timer '%s' is already active", newTimerPtr->name);
-        return;
+        // Timers with equal expiry times expire in the order they were started.
+        return (aPtr->heapSeqNum < bPtr->heapSeqNum);
     }
 
-    // Get the start of the list
-    linkPtr = le_dls_Peek(listPtr);
+    return le_clk_GreaterThan(bPtr->latestExpiryTime, aPtr->latestExpiryTime);
+}
 
-    // Find the timer whose expiry time is greater than the new timer.
-    while ( linkPtr != NULL )
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Store a timer at the given position in the timer heap.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void SetHeapEntry
+(
+    timer_ThreadRec_t* threadRecPtr,    ///< [IN] The thread's timer record.
+    size_t index,                       ///< [IN] Position in the heap.
+    Timer_t* timerPtr                   ///< [IN] The timer to store.
+)
+{
+    threadRecPtr->heapPtr[index] = timerPtr;
+    timerPtr->heapIndex = index;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move a timer towards the top of the heap until its parent expires before it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SiftUp
+(
+    timer_ThreadRec_t* threadRecPtr,    ///< [IN] The thread's timer record.
+    size_t index                        ///< [IN] Position of the timer to move.
+)
+{
+    Timer_t* timerPtr = threadRecPtr->heapPtr[index];
+
+    while (index > 0)
     {
-        timerPtr = CONTAINER_OF(linkPtr, Timer_t, link);
+        size_t parent = (index - 1) / 2;
+        Timer_t* parentPtr = threadRecPtr->heapPtr[parent];
 
-        if ( le_clk_GreaterThan(timerPtr->expiryTime, newTimerPtr->expiryTime) )
+        if (!IsBefore(timerPtr, parentPtr))
+        {
             break;
+        }
 
-        linkPtr = le_dls_PeekNext(listPtr, linkPtr);
+        SetHeapEntry(threadRecPtr, index, parentPtr);
+        index = parent;
     }
 
-    TimerListChangeCount++;
-    if (linkPtr == NULL)
-    {
-        // The list is either empty, or the new timer has the largest expiry time.
-        // In either case, add the new timer to the end of the list.
-        le_dls_Queue(listPtr, &newTimerPtr->link);
-    }
-    else
+    SetHeapEntry(threadRecPtr, index, timerPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move a timer towards the bottom of the heap until both its children expire after it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SiftDown
+(
+    timer_ThreadRec_t* threadRecPtr,    ///< [IN] The thread's timer record.
+    size_t index                        ///< [IN] Position of the timer to move.
+)
+{
+    Timer_t* timerPtr = threadRecPtr->heapPtr[index];
+    size_t count = threadRecPtr->heapCount;
+
+    for (;;)
     {
-        // Found a timer with larger expiry time; insert the new timer before it.
-        le_dls_AddBefore(listPtr, linkPtr, &newTimerPtr->link);
+        size_t child = (2 * index) + 1;
+
+        if (child >= count)
+        {
+            break;
+        }
+
+        // Pick the child that expires first.
+        if ((child + 1 < count) &&
+            IsBefore(threadRecPtr->heapPtr[child + 1], threadRecPtr->heapPtr[child]))
+        {
+            child++;
+        }
+
+        if (!IsBefore(threadRecPtr->heapPtr[child], timerPtr))
+        {
+            break;
+        }
+
+        SetHeapEntry(threadRecPtr, index, threadRecPtr->heapPtr[child]);
+        index = child;
     }
 
-    // The new timer is now on the active list
-    newTimerPtr->isActive = true;
+    SetHeapEntry(threadRecPtr, index, timerPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Peek at the first timer from the given timer list
- *
- * @return:
- *      - pointer to the first timer on the list
- *      - NULL if the list is empty
+ * Add the timer record to the given thread's timer heap, ordered according to the timer value
+ * (including slack).
  */
 //--------------------------------------------------------------------------------------------------
-static Timer_t* PeekFromTimerList
+static void AddToTimerList
 (
-    le_dls_List_t* listPtr              ///< [IN] The list to look at.
+    timer_ThreadRec_t* threadRecPtr,      ///< [IN] The thread's timer record.
+    Timer_t* newTimerPtr                  ///< [IN] The timer to add
 )
 {
-    le_dls_Link_t* linkPtr;
+    if ( newTimerPtr->isActive )
+    {
+        LE_ERROR("Timer '%s' is already active", newTimerPtr->name);
+        return;
+    }
 
-    linkPtr = le_dls_Peek(listPtr);
-    if (linkPtr != NULL)
+    // Grow the heap if it is full.
+    if (threadRecPtr->heapCount == threadRecPtr->heapCapacity)
     {
-        return ( CONTAINER_OF(linkPtr, Timer_t, link) );
+        size_t newCapacity = (threadRecPtr->heapCapacity == 0) ?
+                                TIMER_HEAP_INITIAL_SIZE : (threadRecPtr->heapCapacity * 2);
+        Timer_t** newHeapPtr = realloc(threadRecPtr->heapPtr, newCapacity * sizeof(Timer_t*));
+        LE_ASSERT(newHeapPtr != NULL);
+
+        threadRecPtr->heapPtr = newHeapPtr;
+        threadRecPtr->heapCapacity = newCapacity;
     }
-    return NULL;
+
+    newTimerPtr->latestExpiryTime = le_clk_Add(newTimerPtr->expiryTime, newTimerPtr->slack);
+    newTimerPtr->heapSeqNum = threadRecPtr->heapSeqNum++;
+
+    TimerListChangeCount++;
+    SetHeapEntry(threadRecPtr, threadRecPtr->heapCount, newTimerPtr);
+    threadRecPtr->heapCount++;
+    SiftUp(threadRecPtr, newTimerPtr->heapIndex);
+
+    le_dls_Queue(&threadRecPtr->activeTimerList, &newTimerPtr->link);
+
+    // The new timer is now on the active list
+    newTimerPtr->isActive = true;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Pop the first timer from the given timer list
+ * Peek at the first timer from the given thread's timer heap
  *
  * @return:
- *      - pointer to the first timer on the list
- *      - NULL if the list is empty
+ *      - pointer to the first timer to expire
+ *      - NULL if the heap is empty
  */
 //--------------------------------------------------------------------------------------------------
-static Timer_t* PopFromTimerList
+static Timer_t* PeekFromTimerList
 (
-    le_dls_List_t* listPtr              ///< [IN] The list to look at.
+    timer_ThreadRec_t* threadRecPtr     ///< [IN] The thread's timer record.
 )
 {
-    le_dls_Link_t* linkPtr;
-    Timer_t* timerPtr;
-
-    linkPtr = le_dls_Pop(listPtr);
-    if (linkPtr != NULL)
+    if (threadRecPtr->heapCount > 0)
     {
-        TimerListChangeCount++;
-        timerPtr = CONTAINER_OF(linkPtr, Timer_t, link);
-
-        // The timer is no longer on the active list
-        timerPtr->isActive = false;
-
-        return timerPtr;
+        return threadRecPtr->heapPtr[0];
     }
     return NULL;
 }
@@ -242,16 +323,16 @@ static Timer_t* PopFromTimerList
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove the timer from the given timer list
+ * Remove the timer from the given thread's timer heap
  *
  * @return
  *      - LE_OK on success
- *      - LE_FAULT if the timer was not in the list
+ *      - LE_FAULT if the timer was not in the heap
  */
 //--------------------------------------------------------------------------------------------------
 static le_result_t RemoveFromTimerList
 (
-    le_dls_List_t* listPtr,             ///< [IN] The list to look at.
+    timer_ThreadRec_t* threadRecPtr,    ///< [IN] The thread's timer record.
     Timer_t* timerPtr                   ///< [IN] The timer to remove
 )
 {
@@ -260,15 +341,60 @@ static le_result_t RemoveFromTimerList
         return LE_FAULT;
     }
 
+    size_t index = timerPtr->heapIndex;
+
+    LE_ASSERT((index < threadRecPtr->heapCount) && (threadRecPtr->heapPtr[index] == timerPtr));
+
     // Remove the timer from the active list
     timerPtr->isActive = false;
     TimerListChangeCount++;
-    le_dls_Remove(listPtr, &timerPtr->link);
+    le_dls_Remove(&threadRecPtr->activeTimerList, &timerPtr->link);
+
+    // Fill the hole with the last timer in the heap, and move it to where it belongs.
+    threadRecPtr->heapCount--;
+    if (index < threadRecPtr->heapCount)
+    {
+        Timer_t* lastTimerPtr = threadRecPtr->heapPtr[threadRecPtr->heapCount];
+
+        SetHeapEntry(threadRecPtr, index, lastTimerPtr);
+        if ((index > 0) && IsBefore(lastTimerPtr, threadRecPtr->heapPtr[(index - 1) / 2]))
+        {
+            SiftUp(threadRecPtr, index);
+        }
+        else
+        {
+            SiftDown(threadRecPtr, index);
+        }
+    }
 
     return LE_OK;
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pop the first timer from the given thread's timer heap
+ *
+ * @return:
+ *      - pointer to the first timer to expire
+ *      - NULL if the heap is empty
+ */
+//--------------------------------------------------------------------------------------------------
+static Timer_t* PopFromTimerList
+(
+    timer_ThreadRec_t* threadRecPtr     ///< [IN] The thread's timer record.
+)
+{
+    Timer_t* timerPtr = PeekFromTimerList(threadRecPtr);
+
+    if (timerPtr != NULL)
+    {
+        RemoveFromTimerList(threadRecPtr, timerPtr);
+    }
+    return timerPtr;
+}
+
+
 #if 0
 //--------------------------------------------------------------------------------------------------
 /**
@@ -281,7 +407,7 @@ static le_result_t RemoveFromTimerList
 //--------------------------------------------------------------------------------------------------
 static void PrintTimerList
 (
-    le_dls_List_t* listPtr               ///< [IN] The list to print.
+    le_dls_List_t* listPtr               ///< [IN] The list to print (in no particular order).
 )
 {
     Timer_t* timerPtr;
@@ -349,11 +475,12 @@ static void RestartTimerFD
 
     struct itimerspec timerInterval;
 
-    // Set the timer to expire at the expiry time of the given timer
+    // Set the timer to expire at the latest expiry time of the given timer, so that as many timers
+    // as possible can be handled on the same wake-up.  This is the expiry time if it has no slack.
     // There is a small possibility that the time set now will be slightly in the past
     // at this point but it will just cause the timerfd to expire immediately.
-    timerInterval.it_value.tv_sec = timerPtr->expiryTime.sec;
-    timerInterval.it_value.tv_nsec = timerPtr->expiryTime.usec * 1000;
+    timerInterval.it_value.tv_sec = timerPtr->latestExpiryTime.sec;
+    timerInterval.it_value.tv_nsec = timerPtr->latestExpiryTime.usec * 1000;
 
     // The timerFD does not repeat
     timerInterval.it_interval.tv_sec = 0;
@@ -438,7 +565,7 @@ static void ProcessExpiredTimer
         expiredTimer->expiryTime = le_clk_Add(expiredTimer->expiryTime, expiredTimer->interval);
 
         // Add the timer back to the timer list
-        AddToTimerList(&threadRecPtr->activeTimerList, expiredTimer);
+        AddToTimerList(threadRecPtr, expiredTimer);
         //PrintTimerList(&threadRecPtr->activeTimerList);
     }
 
@@ -491,7 +618,7 @@ static void TimerFdHandler
     LE_ERROR_IF(expiry != 1,  "On TimerFD read, unexpected expiry=%u", (unsigned int)expiry);
 
     // Pop off the first timer from the active list, and make sure it is the expected timer.
-    firstTimerPtr = PopFromTimerList(&threadRecPtr->activeTimerList);
+    firstTimerPtr = PopFromTimerList(threadRecPtr);
     LE_ASSERT( NULL != firstTimerPtr);
 
     LE_ASSERT( threadRecPtr->firstTimerPtr == firstTimerPtr );
@@ -505,18 +632,19 @@ static void TimerFdHandler
     ProcessExpiredTimer(firstTimerPtr);
 
     // Check if there are any other timers that have since expired, pop them off the
-    // list and process them.
-    firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+    // list and process them.  Timers with slack are processed as soon as their expiry time has
+    // passed, so that they share this wake-up instead of needing one of their own.
+    firstTimerPtr = PeekFromTimerList(threadRecPtr);
     while ( firstTimerPtr != NULL &&
             le_clk_GreaterThan(clk_GetRelativeTime(firstTimerPtr->isWakeupEnabled),
                                firstTimerPtr->expiryTime) )
     {
         // Pop off the timer and process it
-        firstTimerPtr = PopFromTimerList(&threadRecPtr->activeTimerList);
+        firstTimerPtr = PopFromTimerList(threadRecPtr);
         ProcessExpiredTimer(firstTimerPtr);
 
         // Try the next timer on the list
-        firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+        firstTimerPtr = PeekFromTimerList(threadRecPtr);
     }
 
     // While processing expired timers in the above loop, it is possible that a timer was started,
@@ -637,6 +765,10 @@ void timer_InitThread
 
         recPtr->timerFD = -1;
         recPtr->activeTimerList = LE_DLS_LIST_INIT;
+        recPtr->heapPtr = NULL;
+        recPtr->heapCount = 0;
+        recPtr->heapCapacity = 0;
+        recPtr->heapSeqNum = 0;
         recPtr->firstTimerPtr = NULL;
     }
 }
@@ -695,6 +827,12 @@ void timer_DestructThread
 
             le_mem_Release(timerPtr);
         }
+
+        // Release the timer heap
+        free(threadRecPtr->heapPtr);
+        threadRecPtr->heapPtr = NULL;
+        threadRecPtr->heapCount = 0;
+        threadRecPtr->heapCapacity = 0;
     }
 }
 
@@ -922,6 +1060,43 @@ le_result_t le_timer_SetWakeup
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the timer slack using milliseconds.
+ *
+ * The timer may expire up to this much later than its expiry time, so that its expiry can be
+ * handled together with other timers in the same thread.  The default is 0 (no slack).
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_BUSY if the timer is currently running
+ *
+ * @note
+ *      If an invalid timer object is given, the process exits.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_timer_SetMsSlack
+(
+    le_timer_Ref_t timerRef,     ///< [IN] Set slack for this timer object.
+    uint32_t slack               ///< [IN] Timer slack in milliseconds.
+)
+{
+    Timer_t* timerPtr = le_ref_Lookup(SafeRefMap, timerRef);
+    LE_FATAL_IF(NULL == timerPtr, "Invalid timer reference %p.", timerRef);
+
+    if ( timerPtr->isActive )
+    {
+        return LE_BUSY;
+    }
+
+    time_t seconds = slack / 1000;
+    timerPtr->slack.sec = seconds;
+    timerPtr->slack.usec = (slack - (seconds * 1000)) * 1000;
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set context pointer for the timer
@@ -1085,12 +1260,12 @@ le_result_t le_timer_Start
     timerPtr->expiryCount = 0;
     timerPtr->expiryTime = le_clk_Add(clk_GetRelativeTime(timerPtr->isWakeupEnabled),
                                       timerPtr->interval);
-    AddToTimerList(&threadRecPtr->activeTimerList, timerPtr);
+    AddToTimerList(threadRecPtr, timerPtr);
     //PrintTimerList(&threadRecPtr->activeTimerList);
 
     // Get the first timer from the active list. This is needed to determine whether the timerFD
     // needs to be restarted, in case the new timer was put at the beginning of the list.
-    firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+    firstTimerPtr = PeekFromTimerList(threadRecPtr);
     LE_FATAL_IF(NULL == firstTimerPtr, "Invalid firstTimerPtr reference %p.", firstTimerPtr);
     // If the timerFD is not running, or it is running a timer that is no longer at the beginning
     // of the active list, then (re)start the timerFD.
@@ -1136,7 +1311,7 @@ le_result_t le_timer_Stop
 
     timer_ThreadRec_t* threadRecPtr = GetThreadTimerRec(timerPtr);
 
-    result = RemoveFromTimerList(&threadRecPtr->activeTimerList, timerPtr);
+    result = RemoveFromTimerList(threadRecPtr, timerPtr);
     if (result == LE_OK)
     {
         // If the timer was at the start of the active list, then restart the timerFD using the next
@@ -1146,7 +1321,7 @@ le_result_t le_timer_Stop
             TRACE("Stopping the first active timer");
             threadRecPtr->firstTimerPtr = NULL;
 
-            firstTimerPtr = PeekFromTimerList(&threadRecPtr->activeTimerList);
+            firstTimerPtr = PeekFromTimerList(threadRecPtr);
             if (firstTimerPtr != NULL)
             {
                 RestartTimerFD(firstTimerPtr);
@@ -39,11 +39,17 @@ typedef struct
     le_clk_Time_t interval;                  ///< Interval
     uint32_t repeatCount;                    ///< Number of times the timer will repeat
     void* contextPtr;                        ///< Context for timer expiry
+    le_clk_Time_t slack;                     ///< How late the timer is allowed to expire
 
     // Internal State
     le_dls_Link_t link;                      ///< For adding to the timer list
     bool isActive;                           ///< Is the timer active/running?
     le_clk_Time_t expiryTime;                ///< Time at which the timer should expire
+    le_clk_Time_t latestExpiryTime;          ///< Expiry time plus slack; the timer heap is
+                                             ///  ordered on this.
+    size_t heapIndex;                        ///< Position of the timer in the timer heap
+    uint64_t heapSeqNum;                     ///< Order in which the timer was added to the heap,
+                                             ///  used to order timers with equal expiry times.
     uint32_t expiryCount;                    ///< Number of times the counter has expired
     le_timer_Ref_t safeRef;                  ///< For the API user to refer to this timer by
     bool isWakeupEnabled;                    ///< Will system be woken up from suspended timer.
@@ -67,10 +73,16 @@ typedef struct
 {
     int timerFD;                        ///< System timer used by the thread.
     le_dls_List_t activeTimerList;      ///< Linked list of running legato timers for this thread
+                                        ///  (unordered; used for inspection and clean-up).
+    Timer_t** heapPtr;                  ///< Binary min-heap of the running timers, ordered by
+                                        ///  latest expiry time.
+    size_t heapCount;                   ///< Number of timers in the heap.
+    size_t heapCapacity;                ///< Number of entries allocated for the heap.
+    uint64_t heapSeqNum;                ///< Sequence number for the next timer added to the heap.
     Timer_t* firstTimerPtr;             ///< Pointer to the timer on the active list that is
                                         ///  associated with the currently running timerFD,
                                         ///  or NULL if there are no timers on the active list.
-                                        ///  This is normally the first timer on the list.
+                                        ///  This is normally the timer at the top of the heap.
 
 }
 timer_ThreadRec_t;
@@ -151,6 +151,252 @@ static void ExtractAncillaryData
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fills in a message header structure for sending a message containing any combination of a data
+ * payload, a file descriptor, and process credentials.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrepareSendHeader
+(
+    struct msghdr* msgHeaderPtr,    ///< [OUT] Message header to be filled in.
+    struct iovec* ioVectorPtr,      ///< [OUT] I/O vector to be used for the data payload.
+    char* cmsgBuffer,               ///< [OUT] Ancillary data buffer (CMSG_BUFF_SIZE bytes).
+    void* dataPtr,                  ///< [IN] Pointer to the data payload to be sent (NULL if none).
+    size_t dataSize,                ///< [IN] Number of bytes of data payload to be sent.
+    int fdToSend,                   ///< [IN] The file descriptor to be sent (-1 if none).
+    bool sendCredentials            ///< [IN] true = Send credentials.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct cmsghdr* cmsgHeaderPtr = NULL;   // Ptr to an ancillary data header inside our buffer.
+
+    size_t cmsgLenSum = 0;  // Sum of the cmsg_len fields of all ancillary data message headers.
+
+    // First, fill the message header with zeros.
+    memset(msgHeaderPtr, 0, sizeof(*msgHeaderPtr));
+
+    // If we are sending a data payload,
+    if ((dataPtr != NULL) && (dataSize > 0))
+    {
+        ioVectorPtr->iov_base = dataPtr;
+        ioVectorPtr->iov_len = dataSize;
+        msgHeaderPtr->msg_iov = ioVectorPtr;
+        msgHeaderPtr->msg_iovlen = 1;
+    }
+
+    // If we are sending ancillary data,
+    if ((fdToSend >= 0) || sendCredentials)
+    {
+        // Store the address and size of our control message buffer in the message header.
+        // NOTE: This is necessary for the CMSG_FIRSTHDR and CMSG_NXTHDR macros to work.
+        msgHeaderPtr->msg_control = cmsgBuffer;
+        msgHeaderPtr->msg_controllen = CMSG_BUFF_SIZE;
+
+        // Get a pointer to the first control message header inside our control message buffer.
+        cmsgHeaderPtr = CMSG_FIRSTHDR(msgHeaderPtr);
+    }
+
+    // If we are sending a file descriptor,
+    if (fdToSend >= 0)
+    {
+        // Fill in the file descriptor's control message header.
+        // (It's a "send rights to access an fd" control message, which is a socket-level message.)
+        cmsgHeaderPtr->cmsg_level = SOL_SOCKET;
+        cmsgHeaderPtr->cmsg_type = SCM_RIGHTS;
+        cmsgHeaderPtr->cmsg_len = CMSG_LEN(sizeof(int)); // Payload is a single file descriptor.
+
+        // Store the file descriptor in the control message payload.
+        int* fdPtr = (int *)CMSG_DATA(cmsgHeaderPtr);
+        *fdPtr = fdToSend;
+
+        // Update the message header's control message length to be the actual total length of
+        // all the control messages.
+        cmsgLenSum = cmsgHeaderPtr->cmsg_len;
+
+        LE_DEBUG("Sending fd %d.", fdToSend);
+
+        // Get a pointer to the next control message header inside our control message buffer
+        // for the credentials to be stored in, if needed.
+        cmsgHeaderPtr = CMSG_NXTHDR(msgHeaderPtr, cmsgHeaderPtr);
+    }
+
+    // If we are sending process credentials,
+    if (sendCredentials)
+    {
+        // Fill in the credentials' control message header.
+        // (It's a "send credentials" control message, which is a socket-level message.)
+        cmsgHeaderPtr->cmsg_level = SOL_SOCKET;
+        cmsgHeaderPtr->cmsg_type = SCM_CREDENTIALS;
+        cmsgHeaderPtr->cmsg_len = CMSG_LEN(sizeof(struct ucred)); // Payload is a ucred structure.
+
+        // Store the credentials in the control message payload.
+        // NOTE: These must match the actual credentials of this process.
+        struct ucred* credPtr = (struct ucred*)CMSG_DATA(cmsgHeaderPtr);
+        credPtr->pid = getpid();
+        credPtr->uid = getuid();
+        credPtr->gid = getgid();
+
+        // Update the message header's control message length to be the actual total length of
+        // all the control messages.
+        cmsgLenSum += cmsgHeaderPtr->cmsg_len;
+    }
+
+    // Update the message header with the actual amount of ancillary data message space.
+    msgHeaderPtr->msg_controllen = cmsgLenSum;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts the errno value left by a failed sendmsg() or sendmmsg() call into a result code.
+ *
+ * @return
+ * - LE_NO_MEMORY if the socket doesn't have enough buffer space to send right now.
+ * - LE_COMM_ERROR if the socket is not connected.
+ * - LE_FAULT for any other error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetSendErrorResult
+(
+    const char* funcName    ///< [IN] Name of the system call that failed (for logging).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    switch (errno)
+    {
+        case EAGAIN:  // Same as EWOULDBLOCK
+            return LE_NO_MEMORY;
+
+        case ENOTCONN:
+        case ECONNRESET:
+        case EPIPE:
+            LE_WARN("%s() failed with errno %d (%m).", funcName, errno);
+            return LE_COMM_ERROR;
+
+        default:
+            LE_ERROR("%s() failed with errno %d (%m).", funcName, errno);
+            return LE_FAULT;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fills in a message header structure for receiving a message.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrepareReceiveHeader
+(
+    struct msghdr* msgHeaderPtr,    ///< [OUT] Message header to be filled in.
+    struct iovec* ioVectorPtr,      ///< [OUT] I/O vector to be used for the data payload.
+    char* cmsgBuffer,               ///< [OUT] Ancillary data buffer (CMSG_BUFF_SIZE bytes).
+    void* dataBuffPtr,              ///< [OUT] Where any received data payload will be put.
+    size_t* dataSizePtr,            ///< [IN+OUT] Size of the data buffer (zeroed here).
+    int* fdPtr,                     ///< [OUT] Where the received file descriptor will be put.
+    struct ucred* credPtr           ///< [OUT] Where received credentials will be stored.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // First, fill the message header with zeros.
+    memset(msgHeaderPtr, 0, sizeof(*msgHeaderPtr));
+
+    // Store the address and size of our control message buffer in the message header.
+    msgHeaderPtr->msg_control = cmsgBuffer;
+    msgHeaderPtr->msg_controllen = CMSG_BUFF_SIZE;
+
+    // If we are receiving a data payload,
+    if (dataBuffPtr != NULL)
+    {
+        LE_ASSERT(dataSizePtr != NULL);
+
+        if (*dataSizePtr > 0)
+        {
+            // Set up the I/O vector to point to the data buffer.
+            ioVectorPtr->iov_base = dataBuffPtr;
+            ioVectorPtr->iov_len = *dataSizePtr;
+
+            // Attach the I/O vector to the "header" structure so recvmsg() can find it.
+            msgHeaderPtr->msg_iov = ioVectorPtr;
+            msgHeaderPtr->msg_iovlen = 1;
+
+            // Zero the output parameter in case there's an error.
+            *dataSizePtr = 0;
+        }
+    }
+
+    // If we are trying to receive a file descriptor, set the output param to -1 in case we don't.
+    if (fdPtr != NULL)
+    {
+        *fdPtr = -1;
+    }
+
+    // If we are trying to receive process credentials, set the output param's PID to 0 in case we
+    // don't.
+    if (credPtr != NULL)
+    {
+        credPtr->pid = 0;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extracts the results from a message header that was filled in by recvmsg() or recvmmsg().
+ *
+ * @return
+ * - LE_OK if successful
+ * - LE_NO_MEMORY if more data was received than could fit in the buffer provided.
+ * - LE_CLOSED if the connection closed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ProcessReceiveHeader
+(
+    struct msghdr* msgHeaderPtr,    ///< [IN] Message header filled in by the system call.
+    size_t bytesReceived,           ///< [IN] Number of data bytes received.
+    void* dataBuffPtr,              ///< [IN] Where any received data payload was put.
+    size_t* dataSizePtr,            ///< [OUT] Updated to the number of bytes of data received.
+    int* fdPtr,                     ///< [OUT] Where the received file descriptor will be put.
+    struct ucred* credPtr           ///< [OUT] Where received credentials will be stored.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // If we received any ancillary data messages (control messages), extract what we want
+    // from them.
+    if (msgHeaderPtr->msg_controllen > 0)
+    {
+        ExtractAncillaryData(msgHeaderPtr, fdPtr, credPtr);
+    }
+    // If we didn't receive any ancillary data, and we still received zero bytes,
+    // then the socket must have closed.
+    else if (bytesReceived == 0)
+    {
+        return LE_CLOSED;
+    }
+
+    // Check if ancillary data was discarded.
+    if ((msgHeaderPtr->msg_flags & MSG_CTRUNC) != 0)
+    {
+        LE_WARN("Ancillary data was discarded because it couldn't fit in our buffer.");
+    }
+
+    // If we tried to receive data,
+    if (dataBuffPtr != NULL)
+    {
+        // Set the received data count output parameter.
+        *dataSizePtr = bytesReceived;
+
+        // Check to see if the data message fit into the buffer provided by the caller.
+        if ((msgHeaderPtr->msg_flags & MSG_TRUNC) != 0)
+        {
+            return LE_NO_MEMORY;
+        }
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a named sequenced-packet Unix domain socket. This binds the socket to a file system path.
@@ -389,85 +635,13 @@ le_result_t unixSocket_SendMsg
 )
 //--------------------------------------------------------------------------------------------------
 {
-    char cmsgBuffer[CMSG_BUFF_SIZE];        // Ancillary data (control message) buffer.
-    struct cmsghdr* cmsgHeaderPtr = NULL;   // Ptr to an ancillary data header inside our buffer.
-
-    struct msghdr msgHeader = {0};  // Message "header" structure required by sendmsg().
-    struct iovec ioVector;          // I/O vector structure used when data is being sent.
-
-    size_t cmsgLenSum = 0;  // Sum of the cmsg_len fields of all ancillary data message headers.
-
-    // First, fill the message header with zeros.
-    memset(&msgHeader, 0, sizeof(msgHeader));
-
-    // If we are sending a data payload,
-    if ((dataPtr != NULL) && (dataSize > 0))
-    {
-        ioVector.iov_base = dataPtr;
-        ioVector.iov_len = dataSize;
-        msgHeader.msg_iov = &ioVector;
-        msgHeader.msg_iovlen = 1;
-    }
-
-    // If we are sending ancillary data,
-    if ((fdToSend >= 0) || sendCredentials)
-    {
-        // Store the address and size of our control message buffer in the message header.
-        // NOTE: This is necessary for the CMSG_FIRSTHDR and CMSG_NXTHDR macros to work.
-        msgHeader.msg_control = cmsgBuffer;
-        msgHeader.msg_controllen = sizeof(cmsgBuffer);
-
-        // Get a pointer to the first control message header inside our control message buffer.
-        cmsgHeaderPtr = CMSG_FIRSTHDR(&msgHeader);
-    }
+    char cmsgBuffer[CMSG_BUFF_SIZE];    // Ancillary data (control message) buffer.
 
-    // If we are sending a file descriptor,
-    if (fdToSend >= 0)
-    {
-        // Fill in the file descriptor's control message header.
-        // (It's a "send rights to access an fd" control message, which is a socket-level message.)
-        cmsgHeaderPtr->cmsg_level = SOL_SOCKET;
-        cmsgHeaderPtr->cmsg_type = SCM_RIGHTS;
-        cmsgHeaderPtr->cmsg_len = CMSG_LEN(sizeof(int)); // Payload is a single file descriptor.
-
-        // Store the file descriptor in the control message payload.
-        int* fdPtr = (int *)CMSG_DATA(cmsgHeaderPtr);
-        *fdPtr = fdToSend;
-
-        // Update the message header's control message length to be the actual total length of
-        // all the control messages.
-        cmsgLenSum = cmsgHeaderPtr->cmsg_len;
+    struct msghdr msgHeader;    // Message "header" structure required by sendmsg().
+    struct iovec ioVector;      // I/O vector structure used when data is being sent.
 
-        LE_DEBUG("Sending fd %d.", fdToSend);
-
-        // Get a pointer to the next control message header inside our control message buffer
-        // for the credentials to be stored in, if needed.
-        cmsgHeaderPtr = CMSG_NXTHDR(&msgHeader, cmsgHeaderPtr);
-    }
-
-    // If we are sending process credentials,
-    if (sendCredentials)
-    {
-        // Fill in the credentials' control message header.
-        // (It's a "send credentials" control message, which is a socket-level message.)
-        cmsgHeaderPtr->cmsg_level = SOL_SOCKET;
-        cmsgHeaderPtr->cmsg_type = SCM_CREDENTIALS;
-        cmsgHeaderPtr->cmsg_len = CMSG_LEN(sizeof(struct ucred)); // Payload is a ucred structure.
-
-        // Store the credentials in the control message payload.
-        // NOTE: These must match the actual credentials of this process.
-        struct ucred* credPtr = (struct ucred*)CMSG_DATA(cmsgHeaderPtr);
-        credPtr->pid = getpid();
-        credPtr->uid = getuid();
-        credPtr->gid = getgid();
-
-        // Update the message header's control message length to be the actual total length of
-        // all the control messages.
-        cmsgLenSum += cmsgHeaderPtr->cmsg_len;
-    }
-
-    // Update the message header with the actual amount of ancillary data message space.
-    msgHeader.msg_controllen = cmsgLenSum;
+    PrepareSendHeader(&msgHeader, &ioVector, cmsgBuffer, dataPtr, dataSize, fdToSend,
+                      sendCredentials);
 
     // Now send the message (retry if interrupted by a signal).
     ssize_t bytesSent;
@@ -479,21 +653,7 @@ le_result_t unixSocket_SendMsg
 
     if (bytesSent < 0)
     {
-        switch (errno)
-        {
-            case EAGAIN:  // Same as EWOULDBLOCK
-                return LE_NO_MEMORY;
-
-            case ENOTCONN:
-            case ECONNRESET:
-            case EPIPE:
-                LE_WARN("sendmsg() failed with errno %d (%m).", errno);
-                return LE_COMM_ERROR;
-
-            default:
-                LE_ERROR("sendmsg() failed with errno %d (%m).", errno);
-                return LE_FAULT;
-        }
+        return GetSendErrorResult("sendmsg");
     }
 
     if (bytesSent < dataSize)
@@ -539,6 +699,86 @@ le_result_t unixSocket_SendDataMsg
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a batch of messages through a connected Unix domain datagram or sequenced-packet socket
+ * using a single system call (sendmmsg()).  Each message can contain a data payload and a file
+ * descriptor.
+ *
+ * Messages are sent in order.  If not all of them can be sent (e.g., the socket's send buffer
+ * filled up part way through the batch), the count is updated to the number that were sent and
+ * the rest should be retried later.
+ *
+ * @return
+ * - LE_OK if at least one message was sent (*countPtr updated to the number sent).
+ * - LE_COMM_ERROR if the localSocketFd is not connected.
+ * - LE_FAULT if failed for some other reason (check your logs).
+ * - LE_NO_MEMORY if the send socket is set to non-blocking and it doesn't have enough buffer
+ *                  space to send anything right now.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_SendMsgBatch
+(
+    int localSocketFd,                  ///< [IN] fd of the local socket that will be used to send.
+    unixSocket_MsgBuff_t* msgArray,     ///< [IN] Array of messages to be sent.
+    size_t* countPtr                    ///< [IN+OUT] Number of messages in the array (at most
+                                        ///     UNIXSOCKET_MAX_BATCH_MSGS).  Updated to the
+                                        ///     number of messages sent.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char cmsgBuffers[UNIXSOCKET_MAX_BATCH_MSGS][CMSG_BUFF_SIZE];
+    struct mmsghdr msgHeaders[UNIXSOCKET_MAX_BATCH_MSGS];
+    struct iovec ioVectors[UNIXSOCKET_MAX_BATCH_MSGS];
+
+    size_t count = *countPtr;
+    size_t i;
+
+    LE_ASSERT((count > 0) && (count <= UNIXSOCKET_MAX_BATCH_MSGS));
+
+    for (i = 0; i < count; i++)
+    {
+        PrepareSendHeader(&msgHeaders[i].msg_hdr,
+                          &ioVectors[i],
+                          cmsgBuffers[i],
+                          msgArray[i].dataPtr,
+                          msgArray[i].dataSize,
+                          msgArray[i].fd,
+                          false);   // Don't send credentials.
+        msgHeaders[i].msg_len = 0;
+    }
+
+    // Now send the messages (retry if interrupted by a signal).
+    int msgsSent;
+    do
+    {
+        msgsSent = sendmmsg(localSocketFd, msgHeaders, count, 0);
+    }
+    while ((msgsSent < 0) && (errno == EINTR));
+
+    if (msgsSent < 0)
+    {
+        *countPtr = 0;
+        return GetSendErrorResult("sendmmsg");
+    }
+
+    *countPtr = msgsSent;
+
+    for (i = 0; i < (size_t)msgsSent; i++)
+    {
+        if (msgHeaders[i].msg_len < msgArray[i].dataSize)
+        {
+            LE_ERROR("The last %zu data bytes (of %zu total) were discarded by sendmmsg()!",
+                     msgArray[i].dataSize - msgHeaders[i].msg_len,
+                     msgArray[i].dataSize);
+            return LE_FAULT;
+        }
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Receives through a connected Unix domain socket a message containing any combination of
@@ -584,45 +824,8 @@ le_result_t unixSocket_ReceiveMsg
     struct msghdr msgHeader;    // Message "header" structure required by recvmsg().
     struct iovec ioVector;      // I/O vector structure used when data is being received.
 
-    // First, fill the message header with zeros.
-    memset(&msgHeader, 0, sizeof(msgHeader));
-
-    // Store the address and size of our control message buffer in the message header.
-    msgHeader.msg_control = cmsgBuffer;
-    msgHeader.msg_controllen = sizeof(cmsgBuffer);
-
-    // If we are receiving a data payload,
-    if (dataBuffPtr != NULL)
-    {
-        LE_ASSERT(dataSizePtr != NULL);
-
-        if (*dataSizePtr > 0)
-        {
-            // Set up the I/O vector to point to the data buffer.
-            ioVector.iov_base = dataBuffPtr;
-            ioVector.iov_len = *dataSizePtr;
-
-            // Attach the I/O vector to the "header" structure so recvmsg() can find it.
-            msgHeader.msg_iov = &ioVector;
-            msgHeader.msg_iovlen = 1;
-
-            // Zero the output parameter in case there's an error.
-            *dataSizePtr = 0;
-        }
-    }
-
-    // If we are trying to receive a file descriptor, set the output param to -1 in case we don't.
-    if (fdPtr != NULL)
-    {
-        *fdPtr = -1;
-    }
-
-    // If we are trying to receive process credentials, set the output param's PID to 0 in case we
-    // don't.
-    if (credPtr != NULL)
-    {
-        credPtr->pid = 0;
-    }
+    PrepareReceiveHeader(&msgHeader, &ioVector, cmsgBuffer, dataBuffPtr, dataSizePtr, fdPtr,
+                         credPtr);
 
     // Keep trying to receive until we don't get interrupted by a signal.
     ssize_t bytesReceived;
@@ -650,39 +853,8 @@ le_result_t unixSocket_ReceiveMsg
         }
     }
 
-    // If we received any ancillary data messages (control messages), extract what we want
-    // from them.
-    if (msgHeader.msg_controllen > 0)
-    {
-        ExtractAncillaryData(&msgHeader, fdPtr, credPtr);
-    }
-    // If we didn't receive any ancillary data, and recvmsg() still returned zero,
-    // then the socket must have closed.
-    else if (bytesReceived == 0)
-    {
-        return LE_CLOSED;
-    }
-
-    // Check if ancillary data was discarded.
-    if ((msgHeader.msg_flags & MSG_CTRUNC) != 0)
-    {
-        LE_WARN("Ancillary data was discarded because it couldn't fit in our buffer.");
-    }
-
-    // If we tried to receive data,
-    if (dataBuffPtr != NULL)
-    {
-        // Set the received data count output parameter.
-        *dataSizePtr = bytesReceived;
-
-        // Check to see if the data message fit into the buffer provided by the caller.
-        if ((msgHeader.msg_flags & MSG_TRUNC) != 0)
-        {
-            return LE_NO_MEMORY;
-        }
-    }
-
-    return LE_OK;
+    return ProcessReceiveHeader(&msgHeader, bytesReceived, dataBuffPtr, dataSizePtr, fdPtr,
+                                credPtr);
 }
 
 
@@ -725,6 +897,108 @@ le_result_t unixSocket_ReceiveDataMsg
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receives a batch of messages through a connected Unix domain datagram or sequenced-packet
+ * socket using a single system call (recvmmsg()).  Each message can contain a data payload and
+ * a file descriptor.  This never blocks waiting for more messages than are already available.
+ *
+ * Each message received gets its own result code (see unixSocket_ReceiveMsg()) in the
+ * @c result field of its array entry.  A message whose result is not LE_OK should be discarded.
+ *
+ * @return
+ * - LE_OK if at least one message was received (*countPtr updated to the number received).
+ * - LE_WOULD_BLOCK if the socket is set non-blocking and there is nothing to be received.
+ * - LE_CLOSED if the connection closed.
+ * - LE_FAULT if failed for some other reason (check your logs).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_ReceiveMsgBatch
+(
+    int localSocketFd,                  ///< [IN] fd of local socket to receive the messages from.
+    unixSocket_MsgBuff_t* msgArray,     ///< [IN+OUT] Array of buffers to receive messages into.
+    size_t* countPtr                    ///< [IN+OUT] Number of buffers in the array (at most
+                                        ///     UNIXSOCKET_MAX_BATCH_MSGS).  Updated to the
+                                        ///     number of messages received.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char cmsgBuffers[UNIXSOCKET_MAX_BATCH_MSGS][CMSG_BUFF_SIZE];
+    struct mmsghdr msgHeaders[UNIXSOCKET_MAX_BATCH_MSGS];
+    struct iovec ioVectors[UNIXSOCKET_MAX_BATCH_MSGS];
+
+    size_t count = *countPtr;
+    size_t i;
+
+    LE_ASSERT((count > 0) && (count <= UNIXSOCKET_MAX_BATCH_MSGS));
+
+    *countPtr = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        PrepareReceiveHeader(&msgHeaders[i].msg_hdr,
+                             &ioVectors[i],
+                             cmsgBuffers[i],
+                             msgArray[i].dataPtr,
+                             &msgArray[i].dataSize,
+                             &msgArray[i].fd,
+                             NULL);     // Don't receive credentials.
+        msgHeaders[i].msg_len = 0;
+    }
+
+    // Keep trying to receive until we don't get interrupted by a signal.
+    // MSG_WAITFORONE stops recvmmsg() from waiting for more once it has received something.
+    int msgsReceived;
+    do
+    {
+        msgsReceived = recvmmsg(localSocketFd, msgHeaders, count, MSG_WAITFORONE, NULL);
+    }
+    while ((msgsReceived < 0) && (errno == EINTR));
+
+    // If we failed, process the error and return.
+    if (msgsReceived < 0)
+    {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            return LE_WOULD_BLOCK;
+        }
+        else if (errno == ECONNRESET)
+        {
+            return LE_CLOSED;
+        }
+        else
+        {
+            LE_ERROR("recvmmsg() failed with errno %d (%m).", errno);
+            return LE_FAULT;
+        }
+    }
+
+    for (i = 0; i < (size_t)msgsReceived; i++)
+    {
+        msgArray[i].result = ProcessReceiveHeader(&msgHeaders[i].msg_hdr,
+                                                  msgHeaders[i].msg_len,
+                                                  msgArray[i].dataPtr,
+                                                  &msgArray[i].dataSize,
+                                                  &msgArray[i].fd,
+                                                  NULL);
+
+        // Nothing can follow the end of the connection.
+        if (msgArray[i].result == LE_CLOSED)
+        {
+            if (i == 0)
+            {
+                return LE_CLOSED;
+            }
+            break;
+        }
+    }
+
+    *countPtr = i;
+
+    return LE_OK;
+}
+
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -157,6 +157,10 @@
  * - unixSocket_ReceiveMsg() receives a message containing any combination of normal
  *   data, a file descriptor, and authenticated credentials.
  *
+ * - unixSocket_SendMsgBatch() and unixSocket_ReceiveMsgBatch() send or receive up to
+ *   UNIXSOCKET_MAX_BATCH_MSGS messages (each with data and/or a file descriptor) in a single
+ *   system call, using sendmmsg() and recvmmsg().
+ *
  * When file descriptors are sent, they are duplicated in the receiving process as if they had
  * been created using the POSIX dup() function.  This means that they remain open in the sending
  * process and must be closed by the sending process when it doesn't need them anymore.
@@ -447,6 +451,60 @@ le_result_t unixSocket_SendDataMsg
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of messages that can be sent or received in one call to
+ * unixSocket_SendMsgBatch() or unixSocket_ReceiveMsgBatch().
+ */
+//--------------------------------------------------------------------------------------------------
+#define UNIXSOCKET_MAX_BATCH_MSGS 16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Describes one message in a batch passed to unixSocket_SendMsgBatch() or
+ * unixSocket_ReceiveMsgBatch().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    void*       dataPtr;    ///< Data payload to send, or buffer to receive it into.
+    size_t      dataSize;   ///< Number of bytes to send, or buffer size (updated to the number
+                            ///  of bytes received).
+    int         fd;         ///< File descriptor to send, or that was received (-1 = none).
+    le_result_t result;     ///< Receive result for this message (not used for sending).
+}
+unixSocket_MsgBuff_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sends a batch of messages through a connected Unix domain datagram or sequenced-packet socket
+ * using a single system call (sendmmsg()).  Each message can contain a data payload and a file
+ * descriptor.
+ *
+ * Messages are sent in order.  If not all of them can be sent (e.g., the socket's send buffer
+ * filled up part way through the batch), the count is updated to the number that were sent and
+ * the rest should be retried later.
+ *
+ * @return
+ * - LE_OK if at least one message was sent (*countPtr updated to the number sent).
+ * - LE_COMM_ERROR if the localSocketFd is not connected.
+ * - LE_FAULT if failed for some other reason (check your logs).
+ * - LE_NO_MEMORY if the send socket is set to non-blocking and it doesn't have enough buffer
+ *                  space to send anything right now.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_SendMsgBatch
+(
+    int localSocketFd,                  ///< [IN] fd of the local socket that will be used to send.
+    unixSocket_MsgBuff_t* msgArray,     ///< [IN] Array of messages to be sent.
+    size_t* countPtr                    ///< [IN+OUT] Number of messages in the array (at most
+                                        ///     UNIXSOCKET_MAX_BATCH_MSGS).  Updated to the
+                                        ///     number of messages sent.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Receives through a connected Unix domain socket a message containing any combination of
@@ -518,6 +576,32 @@ le_result_t unixSocket_ReceiveDataMsg
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Receives a batch of messages through a connected Unix domain datagram or sequenced-packet
+ * socket using a single system call (recvmmsg()).  Each message can contain a data payload and
+ * a file descriptor.  This never blocks waiting for more messages than are already available.
+ *
+ * Each message received gets its own result code (see unixSocket_ReceiveMsg()) in the
+ * @c result field of its array entry.  A message whose result is not LE_OK should be discarded.
+ *
+ * @return
+ * - LE_OK if at least one message was received (*countPtr updated to the number received).
+ * - LE_WOULD_BLOCK if the socket is set non-blocking and there is nothing to be received.
+ * - LE_CLOSED if the connection closed.
+ * - LE_FAULT if failed for some other reason (check your logs).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t unixSocket_ReceiveMsgBatch
+(
+    int localSocketFd,                  ///< [IN] fd of local socket to receive the messages from.
+    unixSocket_MsgBuff_t* msgArray,     ///< [IN+OUT] Array of buffers to receive messages into.
+    size_t* countPtr                    ///< [IN+OUT] Number of buffers in the array (at most
+                                        ///     UNIXSOCKET_MAX_BATCH_MSGS).  Updated to the
+                                        ///     number of messages received.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches the socket error state code (SO_ERROR).
@@ -44,6 +44,14 @@
 #define LOG_DEFAULT_LOG_FILTER      LE_LOG_INFO
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of log messages, including the null terminator.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_MAX_MSG_SIZE            256
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initialize the logging system.  This must be called VERY early in the process initialization.
@@ -140,6 +148,21 @@ const char* log_SeverityLevelToStr
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the string that identifies a severity level in log messages (e.g., "-WRN-").
+ *
+ * @return
+ *      Pointer to a string constant.
+ *      NULL if the value is out of range.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* log_GetSeverityStr
+(
+    le_log_Level_t level    ///< [IN] Severity level.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Log messages from the framework.  Used for testing only.
@@ -164,4 +187,25 @@ void log_LogGenericMsg
     const char* msgPtr          ///< [IN] Message.
 );
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Outputs a formatted log message to the logging system (syslog on embedded targets, stderr
+ * otherwise).
+ */
+//--------------------------------------------------------------------------------------------------
+void log_EmitMsg
+(
+    le_log_Level_t level,           ///< [IN] Severity level (-1 if this is a trace message).
+    const char* levelPtr,           ///< [IN] Severity level string or trace keyword (NULL = use
+                                    ///       the level's string).
+    const char* compNamePtr,        ///< [IN] Component name.
+    const char* threadNamePtr,      ///< [IN] Thread name.
+    const char* filenamePtr,        ///< [IN] Source file name (only the base name is output).
+    const char* functionNamePtr,    ///< [IN] Function name.
+    unsigned int lineNumber,        ///< [IN] Source line number.
+    time_t timestamp,               ///< [IN] Time at which the message was logged.
+    const char* msgPtr              ///< [IN] Formatted message.
+);
+
 #endif // LOG_INCLUDE_GUARD
@@ -4,6 +4,7 @@
 # Copyright (C) Sierra Wireless Inc.
 #
 
+import sys
 import codeGenHelpers
 
 def AddLangArgumentGroup(parser):
@@ -13,6 +14,62 @@ def AddLangArgumentGroup(parser):
                         default=False,
                         help='generate asynchronous-style server functions')
 
+    parser.add_argument('--concurrent-server',
+                        dest="concurrent",
+                        action='store_true',
+                        default=False,
+                        help='''generate a server that runs requests in worker threads; by default
+                        for all functions that don't take a handler''')
+
+    parser.add_argument('--worker-functions',
+                        dest="workerFunctionNames",
+                        metavar='NAME[,NAME...]',
+                        default='',
+                        help='''comma-separated list of the functions a concurrent server runs in
+                        worker threads''')
+
+    parser.add_argument('--specialize-pack',
+                        dest="specializePack",
+                        action='store_true',
+                        default=False,
+                        help='''generate specialized pack/unpack code for functions whose message
+                        layout can be computed at generation time''')
+
+def CheckArguments(args, interface):
+    """
+    Check the C specific arguments, and set args.workerFunctions to the set of names of the
+    functions the server runs in worker threads.
+    """
+    args.workerFunctions = set()
+
+    if args.workerFunctionNames and not args.concurrent:
+        print >> sys.stderr, "ERROR: --worker-functions requires --concurrent-server"
+        sys.exit(1)
+
+    if not args.concurrent:
+        return
+
+    if args.async:
+        print >> sys.stderr, "ERROR: --concurrent-server can't be used with --async-server"
+        sys.exit(1)
+
+    if not args.workerFunctionNames:
+        args.workerFunctions = set(function.name
+                                   for function in interface.functions.values()
+                                   if codeGenHelpers.IsWorkerFunctionAllowed(function))
+        return
+
+    for name in args.workerFunctionNames.split(','):
+        function = interface.functions.get(name)
+        if function is None:
+            print >> sys.stderr, "ERROR: unknown worker function '%s'" % name
+            sys.exit(1)
+        if not codeGenHelpers.IsWorkerFunctionAllowed(function):
+            print >> sys.stderr, ("ERROR: function '%s' uses a handler, so it can't be run in a"
+                                  " worker thread" % name)
+            sys.exit(1)
+        args.workerFunctions.add(name)
+
 # Custom filters needed for C templates
 Filters = { 'EscapeString':        codeGenHelpers.EscapeString,
             'FormatHeaderComment': codeGenHelpers.FormatHeaderComment,
@@ -24,11 +81,15 @@ Filters = { 'EscapeString':        codeGenHelpers.EscapeString,
             'GetParameterCount':   codeGenHelpers.GetParameterCount,
             'GetParameterCountPtr': codeGenHelpers.GetParameterCountPtr,
             'PackFunction':        codeGenHelpers.GetPackFunction,
+            'WireType':            codeGenHelpers.GetWireType,
+            'MaxRequestSize':      codeGenHelpers.GetMaxRequestSize,
+            'MaxResponseSize':     codeGenHelpers.GetMaxResponseSize,
             'UnpackFunction':      codeGenHelpers.GetUnpackFunction,
             'CAPIParameters':      codeGenHelpers.IterCAPIParameters }
 
 
-Tests = { 'SizeParameter':         codeGenHelpers.IsSizeParameter }
+Tests = { 'SizeParameter':         codeGenHelpers.IsSizeParameter,
+          'FixedLayoutFunction':   codeGenHelpers.IsFixedLayoutFunction }
 
 Globals = { 'Labeler':             codeGenHelpers.Labeler }
 
@@ -191,6 +191,90 @@ def GetUnpackFunction(apiType):
     else:
         return _PackFunctionMapping[apiType] % ("Unpack", )
 
+# C type each API type is stored as in a message, for the types whose wire size is fixed.
+_WireTypeMapping = {
+    interfaceIR.UINT8_TYPE:  "uint8_t",
+    interfaceIR.UINT16_TYPE: "uint16_t",
+    interfaceIR.UINT32_TYPE: "uint32_t",
+    interfaceIR.UINT64_TYPE: "uint64_t",
+    interfaceIR.INT8_TYPE:   "int8_t",
+    interfaceIR.INT16_TYPE:  "int16_t",
+    interfaceIR.INT32_TYPE:  "int32_t",
+    interfaceIR.INT64_TYPE:  "int64_t",
+    interfaceIR.BOOL_TYPE:   "uint8_t",
+    interfaceIR.CHAR_TYPE:   "char",
+    interfaceIR.DOUBLE_TYPE: "double",
+    interfaceIR.RESULT_TYPE: "le_result_t",
+    interfaceIR.ONOFF_TYPE:  "le_onoff_t",
+}
+
+# Array element types which are laid out in a message exactly as they are in memory, so whole
+# arrays of them can be copied at once.
+_PodArrayTypes = frozenset([
+    interfaceIR.UINT8_TYPE,
+    interfaceIR.UINT16_TYPE,
+    interfaceIR.UINT32_TYPE,
+    interfaceIR.UINT64_TYPE,
+    interfaceIR.INT8_TYPE,
+    interfaceIR.INT16_TYPE,
+    interfaceIR.INT32_TYPE,
+    interfaceIR.INT64_TYPE,
+    interfaceIR.CHAR_TYPE,
+    interfaceIR.DOUBLE_TYPE,
+])
+
+def GetWireType(apiType):
+    """
+    Get the C type a value is stored as in a message; the counterpart of GetPackFunction() for
+    code which stores values directly.
+    """
+    if isinstance(apiType, interfaceIR.BitmaskType) or \
+       isinstance(apiType, interfaceIR.EnumType):
+        if (apiType.size == 4):
+            return "uint32_t"
+        elif (apiType.size == 8):
+            return "uint64_t"
+        else:
+            raise KeyError(apiType.name)
+    else:
+        return _WireTypeMapping[apiType]
+
+def _HasFixedWireSize(apiType):
+    if isinstance(apiType, interfaceIR.ReferenceType):
+        return True
+    elif isinstance(apiType, interfaceIR.BitmaskType) or \
+         isinstance(apiType, interfaceIR.EnumType):
+        return apiType.size in (4, 8)
+    else:
+        return apiType in _WireTypeMapping
+
+def GetMaxRequestSize(function):
+    """
+    Get the largest number of bytes a client packs into a request message buffer for a function.
+    """
+    size = 0
+    if any(parameter.direction & interfaceIR.DIR_OUT for parameter in function.parameters):
+        # Required outputs
+        size += interfaceIR.UINT32_TYPE.size
+    for parameter in function.parameters:
+        if parameter.direction & interfaceIR.DIR_IN:
+            size += parameter.GetMaxSize()
+        elif isinstance(parameter, interfaceIR.ArrayParameter) or \
+             isinstance(parameter, interfaceIR.StringParameter):
+            # Size of the client's output buffer
+            size += interfaceIR.SIZE_TYPE.size
+    return size
+
+def GetMaxResponseSize(function):
+    """
+    Get the largest number of bytes a server packs into a response message buffer for a function.
+    """
+    size = function.returnType.size if function.returnType else 0
+    for parameter in function.parameters:
+        if parameter.direction & interfaceIR.DIR_OUT:
+            size += parameter.GetMaxSize()
+    return size
+
 def EscapeString(string):
     return string.encode('string_escape').replace('"', '\\"')
 
@@ -200,6 +284,38 @@ def EscapeString(string):
 def IsSizeParameter(parameter):
     return isinstance(parameter, SizeParameter)
 
+def IsWorkerFunctionAllowed(function):
+    """
+    Functions which add or remove handlers, or take a callback, must be run by the server thread.
+    """
+    return (not isinstance(function, interfaceIR.EventFunction) and
+            not any(isinstance(parameter.apiType, interfaceIR.HandlerType)
+                    for parameter in function.parameters))
+
+def IsFixedLayoutFunction(function):
+    """
+    Can the messages for a function be packed with their layout computed at generation time?
+
+    This is the case if every parameter and the return value has a fixed size in the message,
+    except for arrays of types which can be copied as a single block.
+    """
+    if isinstance(function, interfaceIR.EventFunction):
+        return False
+
+    if function.returnType and not _HasFixedWireSize(function.returnType):
+        return False
+
+    for parameter in function.parameters:
+        if isinstance(parameter, interfaceIR.StringParameter):
+            return False
+        elif isinstance(parameter, interfaceIR.ArrayParameter):
+            if parameter.apiType not in _PodArrayTypes:
+                return False
+        elif not _HasFixedWireSize(parameter.apiType):
+            return False
+
+    return True
+
 #---------------------------------------------------------------------------------------------------
 # Global functions
 #---------------------------------------------------------------------------------------------------
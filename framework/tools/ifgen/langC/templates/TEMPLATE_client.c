@@ -642,6 +642,7 @@ error_unpack:
 )
 {
     {%- with error_unpack_label=Labeler("error_unpack") %}
+    {%- set isFixedLayout = args.specializePack and function is FixedLayoutFunction %}
     le_msg_MessageRef_t _msgRef;
     le_msg_MessageRef_t _responseMsgRef;
     _Message_t* _msgPtr;
@@ -682,6 +683,12 @@ error_unpack:
     _msgPtr->id = _MSGID_{{apiName}}_{{function.name}};
     _msgBufPtr = _msgPtr->buffer;
     _msgBufSize = _MAX_MSG_SIZE;
+    {%- if isFixedLayout and function|MaxRequestSize %}
+
+    // The message layout was computed by ifgen, so check for the largest possible request once
+    // and then store each field directly.
+    LE_ASSERT(_msgBufSize >= {{function|MaxRequestSize}});
+    {%- endif %}
 
     // Pack a list of outputs requested by the client.
     {%- if any(function.parameters, "OutParameter") %}
@@ -689,8 +696,12 @@ error_unpack:
     {%- for output in function.parameters if output is OutParameter %}
     _requiredOutputs |= ((!!({{output|FormatParameterName}})) << {{loop.index0}});
     {%- endfor %}
+    {%- if isFixedLayout %}
+    LE_PACK_STORE(&_msgBufPtr, uint32_t, _requiredOutputs);
+    {%- else %}
     LE_ASSERT(le_pack_PackUint32(&_msgBufPtr, &_msgBufSize, _requiredOutputs));
     {%- endif %}
+    {%- endif %}
 
     // Pack the input parameters
     {%- if function is RemoveHandlerFunction %}
@@ -708,10 +719,15 @@ error_unpack:
     le_mem_Release(clientDataPtr);
     LE_ASSERT(le_pack_PackReference( &_msgBufPtr, &_msgBufSize,
                                      {{function.parameters[0]|FormatParameterName}} ));
+    {%- elif isFixedLayout %}
+    {{- pack.StoreInputs(function.parameters) }}
     {%- else %}
     {{- pack.PackInputs(function.parameters) }}
     {%- endif %}
 
+    // Only send the part of the message buffer that was packed.
+    le_msg_SetPayloadSize(_msgRef, _msgBufPtr - (uint8_t*)_msgPtr);
+
     // Send a request to the server and get the response.
     TRACE("Sending message to server and waiting for response : %ti bytes sent",
           _msgBufPtr-_msgPtr->buffer);
@@ -728,14 +744,26 @@ error_unpack:
     _msgPtr = le_msg_GetPayloadPtr(_responseMsgRef);
     _msgBufPtr = _msgPtr->buffer;
     _msgBufSize = _MAX_MSG_SIZE;
+    {%- if isFixedLayout and function|MaxResponseSize %}
+    LE_ASSERT(_msgBufSize >= {{function|MaxResponseSize}});
+    {%- endif %}
     {%- if function.returnType %}
 
     // Unpack the result first
+    {%- if isFixedLayout and function.returnType is ReferenceType %}
+    if (!le_pack_LoadReference( &_msgBufPtr, &_result ))
+    {
+        goto {{error_unpack_label}};
+    }
+    {%- elif isFixedLayout %}
+    LE_PACK_LOAD( &_msgBufPtr, {{function.returnType|WireType}}, &_result );
+    {%- else %}
     if (!{{function.returnType|UnpackFunction}}( &_msgBufPtr, &_msgBufSize, &_result ))
     {
         goto {{error_unpack_label}};
     }
     {%- endif %}
+    {%- endif %}
     {%- if function is AddHandlerFunction %}
 
     if (_result)
@@ -755,9 +783,15 @@ error_unpack:
     {%- endif %}
 
     // Unpack any "out" parameters
+    {%- if isFixedLayout %}
+    {%- call pack.LoadOutputs(function.parameters) %}
+        goto {{error_unpack_label}};
+    {%- endcall %}
+    {%- else %}
     {%- call pack.UnpackOutputs(function.parameters) %}
         goto {{error_unpack_label}};
     {%- endcall %}
+    {%- endif %}
 
     // Release the message object, now that all results/output has been copied.
     le_msg_ReleaseMsg(_responseMsgRef);
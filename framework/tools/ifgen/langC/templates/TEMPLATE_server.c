@@ -65,6 +65,39 @@ typedef struct {{apiName}}_ServerCmd
     uint32_t requiredOutputs;           ///< Outputs which must be sent (if any)
 } {{apiName}}_ServerCmd_t;
 {%- endif %}
+{%- if args.workerFunctions %}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Worker session object.
+ *
+ * Requests for the functions that are run in worker threads are run one at a time for each client
+ * session, in the order they were received.  This object exists while one of them is being run,
+ * and holds the requests from the same session that are waiting for it to complete.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_msg_SessionRef_t sessionRef;     ///< The client session
+    le_sls_List_t       pendingList;    ///< Requests waiting to be run (_PendingRequest_t)
+    bool                isUnpackOk;     ///< false if the running request couldn't be unpacked
+    bool                isClosed;       ///< true if the client session has been closed
+}
+_WorkerSession_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Request waiting for the running request of the same client session to complete.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_sls_Link_t       link;           ///< Link in the worker session's pending list
+    le_msg_MessageRef_t msgRef;         ///< Reference to the message
+}
+_PendingRequest_t;
+{%- endif %}
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -91,6 +124,32 @@ static le_ref_MapRef_t _HandlerRefMap;
 //--------------------------------------------------------------------------------------------------
 static le_mem_PoolRef_t _ServerCmdPool;
 {%- endif %}
+{%- if args.workerFunctions %}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of worker threads that run the requests for the functions handled by RunWorkerRequest().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_threadPool_Ref_t _WorkerPoolRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The memory pools for worker session objects and pending requests
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t _WorkerSessionPool;
+static le_mem_PoolRef_t _PendingRequestPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map of client session references to worker session objects.  Only used by the server thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t _WorkerSessionMap;
+{%- endif %}
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -142,9 +201,13 @@ static le_thread_Ref_t _ServerThreadRef;
 //--------------------------------------------------------------------------------------------------
 /**
  * Client Session Reference for the current message received from a client
+{%- if args.workerFunctions %}
+ *
+ * Thread-local, because requests are also run in worker threads.
+{%- endif %}
  */
 //--------------------------------------------------------------------------------------------------
-static le_msg_SessionRef_t _ClientSessionRef;
+static {% if args.workerFunctions %}__thread {% endif %}le_msg_SessionRef_t _ClientSessionRef;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -172,6 +235,24 @@ static void CleanupClientData
 )
 {
     LE_DEBUG("Client %p is closed !!!", sessionRef);
+    {%- if args.workerFunctions %}
+
+    // If a request from this client is being run in a worker thread, discard the requests that
+    // are waiting for it.  The worker session object is released when the request completes.
+    _WorkerSession_t* workerSessionPtr = le_hashmap_Remove(_WorkerSessionMap, sessionRef);
+    if ( workerSessionPtr != NULL )
+    {
+        workerSessionPtr->isClosed = true;
+
+        le_sls_Link_t* linkPtr;
+        while ( (linkPtr = le_sls_Pop(&workerSessionPtr->pendingList)) != NULL )
+        {
+            _PendingRequest_t* requestPtr = CONTAINER_OF(linkPtr, _PendingRequest_t, link);
+            le_msg_ReleaseMsg(requestPtr->msgRef);
+            le_mem_Release(requestPtr);
+        }
+    }
+    {%- endif %}
 
     // Iterate over the server data reference map and remove anything that matches
     // the client session.
@@ -322,6 +403,28 @@ void {{apiName}}_AdvertiseService
     // Create the server command pool
     _ServerCmdPool = le_mem_CreatePool("{{apiName}}_ServerCmd", sizeof({{apiName}}_ServerCmd_t));
     {%- endif %}
+    {%- if args.workerFunctions %}
+
+    // Create the worker thread pool, with up to one worker per CPU.  Requests often block (e.g.,
+    // waiting for a modem or for flash), so allow a few workers even if there are fewer CPUs.
+    // Workers are only started when requests are waiting for them.
+    long numWorkers = sysconf(_SC_NPROCESSORS_ONLN);
+    if ( numWorkers < 4 )
+    {
+        numWorkers = 4;
+    }
+    _WorkerPoolRef = le_threadPool_Create("{{apiName}}", 0, numWorkers);
+
+    // Create the pools and map used to run the requests of each client session in order
+    _WorkerSessionPool = le_mem_CreatePool("{{apiName}}_WorkerSession",
+                                           sizeof(_WorkerSession_t));
+    _PendingRequestPool = le_mem_CreatePool("{{apiName}}_PendingRequest",
+                                            sizeof(_PendingRequest_t));
+    _WorkerSessionMap = le_hashmap_Create("{{apiName}}_WorkerSessions",
+                                          31,
+                                          le_hashmap_HashVoidPointer,
+                                          le_hashmap_EqualsVoidPointer);
+    {%- endif %}
 
     // Create safe reference map for handler references.
     // The size of the map should be based on the number of handlers defined for the server.
@@ -346,6 +449,7 @@ void {{apiName}}_AdvertiseService
 // Client Specific Server Code
 //--------------------------------------------------------------------------------------------------
 {%- for function in functions %}
+{%- set isFixedLayout = args.specializePack and function is FixedLayoutFunction %}
 {#- Write out handler first; there should only be one per function #}
 {%- for handler in function.parameters if handler.apiType is HandlerType %}
 
@@ -388,6 +492,9 @@ static void AsyncResponse_{{apiName}}_{{function.name}}
     // Pack the input parameters
     {{ pack.PackInputs(handler.apiType.parameters) }}
 
+    // Only send the part of the message buffer that was packed.
+    le_msg_SetPayloadSize(_msgRef, _msgBufPtr - (uint8_t*)_msgPtr);
+
     // Send the async response to the client
     TRACE("Sending message to client session %p : %ti bytes sent",
           serverDataPtr->clientSessionRef,
@@ -436,12 +543,24 @@ void {{apiName}}_{{function.name}}Respond
 
     // Ensure that this Respond function has not already been called
     LE_FATAL_IF( !le_msg_NeedsResponse(_msgRef), "Response has already been sent");
+    {%- if isFixedLayout and function|MaxResponseSize %}
+
+    // The message layout was computed by ifgen, so check for the largest possible response once
+    // and then store each field directly.
+    LE_ASSERT(_msgBufSize >= {{function|MaxResponseSize}});
+    {%- endif %}
     {%- if function.returnType %}
 
     // Pack the result first
+    {%- if isFixedLayout and function.returnType is ReferenceType %}
+    LE_ASSERT(le_pack_StoreReference( &_msgBufPtr, _result ));
+    {%- elif isFixedLayout %}
+    LE_PACK_STORE( &_msgBufPtr, {{function.returnType|WireType}}, _result );
+    {%- else %}
     LE_ASSERT({{function.returnType|PackFunction}}( &_msgBufPtr, &_msgBufSize,
                                                     _result ));
     {%- endif %}
+    {%- endif %}
 
     // Null-out any parameters which are not required so pack knows not to pack them.
     {%- for parameter in function.parameters if parameter is OutParameter %}
@@ -460,7 +579,14 @@ void {{apiName}}_{{function.name}}Respond
     {%- endfor %}
 
     // Pack any "out" parameters
+    {%- if isFixedLayout %}
+    {{- pack.StoreOutputs(function.parameters) }}
+    {%- else %}
     {{- pack.PackOutputs(function.parameters) }}
+    {%- endif %}
+
+    // Only send the part of the message buffer that was packed.
+    le_msg_SetPayloadSize(_msgRef, _msgBufPtr - (uint8_t*)_msgPtr);
 
     // Return the response
     TRACE("Sending response to client session %p", le_msg_GetSession(_msgRef));
@@ -487,19 +613,36 @@ static void Handle_{{apiName}}_{{function.name}}
         ((_Message_t*)le_msg_GetPayloadPtr(_msgRef))->buffer;
     __attribute__((unused)) size_t _msgBufSize = _MAX_MSG_SIZE;
 
+    {%- if isFixedLayout and function|MaxRequestSize %}
+
+    // The message layout was computed by ifgen, so check for the largest possible request once
+    // and then load each field directly.
+    LE_ASSERT(_msgBufSize >= {{function|MaxRequestSize}});
+    {%- endif %}
+
     // Unpack which outputs are needed.
     _serverCmdPtr->requiredOutputs = 0;
     {%- if any(function.parameters, "OutParameter") %}
+    {%- if isFixedLayout %}
+    LE_PACK_LOAD(&_msgBufPtr, uint32_t, &_serverCmdPtr->requiredOutputs);
+    {%- else %}
     if (!le_pack_UnpackUint32(&_msgBufPtr, &_msgBufSize, &_serverCmdPtr->requiredOutputs))
     {
         goto {{error_unpack_label}};
     }
     {%- endif %}
+    {%- endif %}
 
     // Unpack the input parameters from the message
+    {%- if isFixedLayout %}
+    {%- call pack.LoadInputs(function.parameters) %}
+        goto {{error_unpack_label}};
+    {%- endcall %}
+    {%- else %}
     {%- call pack.UnpackInputs(function.parameters) %}
         goto {{error_unpack_label}};
     {%- endcall %}
+    {%- endif %}
 
     // Call the function
     {{apiName}}_{{function.name}} ( _serverCmdPtr
@@ -523,7 +666,8 @@ error_unpack:
     {%- endwith %}
 }
 {%- else %}
-static void Handle_{{apiName}}_{{function.name}}
+{%- set isWorkerFunction = function.name in args.workerFunctions %}
+static {% if isWorkerFunction %}bool{% else %}void{% endif %} Handle_{{apiName}}_{{function.name}}
 (
     le_msg_MessageRef_t _msgRef
 
@@ -537,15 +681,25 @@ static void Handle_{{apiName}}_{{function.name}}
 
     // Needed if we are returning a result or output values
     uint8_t* _msgBufStartPtr = _msgBufPtr;
+    {%- if isFixedLayout and function|MaxRequestSize %}
+
+    // The message layout was computed by ifgen, so check for the largest possible request once
+    // and then load each field directly.
+    LE_ASSERT(_msgBufSize >= {{function|MaxRequestSize}});
+    {%- endif %}
 
     // Unpack which outputs are needed
     {%- if any(function.parameters, "OutParameter") %}
     uint32_t _requiredOutputs = 0;
+    {%- if isFixedLayout %}
+    LE_PACK_LOAD(&_msgBufPtr, uint32_t, &_requiredOutputs);
+    {%- else %}
     if (!le_pack_UnpackUint32(&_msgBufPtr, &_msgBufSize, &_requiredOutputs))
     {
         goto {{error_unpack_label}};
     }
     {%- endif %}
+    {%- endif %}
 
     // Unpack the input parameters from the message
     {%- if function is RemoveHandlerFunction %}
@@ -574,6 +728,10 @@ static void Handle_{{apiName}}_{{function.name}}
     _UNLOCK
     handlerRef = ({{function.parameters[0].apiType|FormatType}})serverDataPtr->handlerRef;
     le_mem_Release(serverDataPtr);
+    {%- elif isFixedLayout %}
+    {%- call pack.LoadInputs(function.parameters) %}
+        goto {{error_unpack_label}};
+    {%- endcall %}
     {%- else %}
     {%- call pack.UnpackInputs(function.parameters) %}
         goto {{error_unpack_label}};
@@ -658,14 +816,40 @@ static void Handle_{{apiName}}_{{function.name}}
     // Re-use the message buffer for the response
     _msgBufPtr = _msgBufStartPtr;
     _msgBufSize = _MAX_MSG_SIZE;
+    {%- if isFixedLayout and function|MaxResponseSize %}
+    LE_ASSERT(_msgBufSize >= {{function|MaxResponseSize}});
+    {%- endif %}
     {%- if function.returnType %}
 
     // Pack the result first
+    {%- if isFixedLayout and function.returnType is ReferenceType %}
+    LE_ASSERT(le_pack_StoreReference( &_msgBufPtr, _result ));
+    {%- elif isFixedLayout %}
+    LE_PACK_STORE( &_msgBufPtr, {{function.returnType|WireType}}, _result );
+    {%- else %}
     LE_ASSERT({{function.returnType|PackFunction}}( &_msgBufPtr, &_msgBufSize, _result ));
     {%- endif %}
+    {%- endif %}
 
     // Pack any "out" parameters
+    {%- if isFixedLayout %}
+    {{- pack.StoreOutputs(function.parameters) }}
+    {%- else %}
     {{- pack.PackOutputs(function.parameters) }}
+    {%- endif %}
+
+    // Only send the part of the message buffer that was packed.
+    le_msg_SetPayloadSize(_msgRef, _msgBufPtr - (uint8_t*)le_msg_GetPayloadPtr(_msgRef));
+    {%- if isWorkerFunction %}
+
+    // The response is sent by the server thread, once this worker thread has returned.
+    return true;
+    {%- if error_unpack_label.IsUsed() %}
+
+error_unpack:
+    return false;
+    {%- endif %}
+    {%- else %}
 
     // Return the response
     TRACE("Sending response to client session %p : %ti bytes sent",
@@ -681,10 +865,139 @@ static void Handle_{{apiName}}_{{function.name}}
 error_unpack:
     LE_KILL_CLIENT("Error unpacking message");
     {%- endif %}
+    {%- endif %}
     {%- endwith %}
 }
 {%- endif %}
 {%- endfor %}
+{%- if args.workerFunctions %}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a request in a worker thread.  The response is packed into the request message, but it can
+ * only be sent by the server thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunWorkerRequest
+(
+    void* msgRef,               ///< [in] Reference to the request message.
+    void* workerSessionPtr      ///< [in] Worker session of the client that sent the request.
+)
+{
+    _WorkerSession_t* sessionPtr = workerSessionPtr;
+    _Message_t* msgPtr = le_msg_GetPayloadPtr(msgRef);
+
+    // Let the server get the client session ref from the worker thread as well.
+    _ClientSessionRef = sessionPtr->sessionRef;
+
+    switch (msgPtr->id)
+    {
+        {%- for function in functions if function.name in args.workerFunctions %}
+        case _MSGID_{{apiName}}_{{function.name}} :
+            sessionPtr->isUnpackOk = Handle_{{apiName}}_{{function.name}}(msgRef);
+            break;
+        {%- endfor %}
+
+        default: LE_FATAL("Unexpected msg id = %i", msgPtr->id);
+    }
+
+    _ClientSessionRef = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send the response to a request that has been run in a worker thread, then start the next
+ * request from the same client, if there is one.  Called in the server thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CompleteWorkerRequest
+(
+    void* msgRef,               ///< [in] Reference to the request message.
+    void* workerSessionPtr      ///< [in] Worker session of the client that sent the request.
+)
+{
+    _WorkerSession_t* sessionPtr = workerSessionPtr;
+
+    if ( sessionPtr->isUnpackOk )
+    {
+        // The response is discarded if the client has closed the session in the meantime.
+        TRACE("Sending response to client session %p", sessionPtr->sessionRef);
+
+        le_msg_Respond(msgRef);
+    }
+    else
+    {
+        if ( !sessionPtr->isClosed )
+        {
+            LE_EMERG("Error unpacking message");
+            le_msg_CloseSession(sessionPtr->sessionRef);
+        }
+        le_msg_ReleaseMsg(msgRef);
+    }
+
+    // If the session has been closed, its pending requests have already been discarded.
+    le_sls_Link_t* linkPtr = le_sls_Pop(&sessionPtr->pendingList);
+    if ( linkPtr != NULL )
+    {
+        _PendingRequest_t* requestPtr = CONTAINER_OF(linkPtr, _PendingRequest_t, link);
+        le_threadPool_Submit(_WorkerPoolRef,
+                             RunWorkerRequest,
+                             CompleteWorkerRequest,
+                             requestPtr->msgRef,
+                             sessionPtr);
+        le_mem_Release(requestPtr);
+    }
+    else
+    {
+        if ( !sessionPtr->isClosed )
+        {
+            le_hashmap_Remove(_WorkerSessionMap, sessionPtr->sessionRef);
+        }
+        le_mem_Release(sessionPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start running a request in a worker thread, or queue it if a request from the same client is
+ * already being run.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartWorkerRequest
+(
+    le_msg_MessageRef_t msgRef  ///< [in] Reference to the request message.
+)
+{
+    le_msg_SessionRef_t sessionRef = le_msg_GetSession(msgRef);
+    _WorkerSession_t* sessionPtr = le_hashmap_Get(_WorkerSessionMap, sessionRef);
+
+    if ( sessionPtr != NULL )
+    {
+        _PendingRequest_t* requestPtr = le_mem_ForceAlloc(_PendingRequestPool);
+        requestPtr->link = LE_SLS_LINK_INIT;
+        requestPtr->msgRef = msgRef;
+        le_sls_Queue(&sessionPtr->pendingList, &requestPtr->link);
+    }
+    else
+    {
+        sessionPtr = le_mem_ForceAlloc(_WorkerSessionPool);
+        sessionPtr->sessionRef = sessionRef;
+        sessionPtr->pendingList = LE_SLS_LIST_INIT;
+        sessionPtr->isUnpackOk = false;
+        sessionPtr->isClosed = false;
+        le_hashmap_Put(_WorkerSessionMap, sessionRef, sessionPtr);
+
+        le_threadPool_Submit(_WorkerPoolRef,
+                             RunWorkerRequest,
+                             CompleteWorkerRequest,
+                             msgRef,
+                             sessionPtr);
+    }
+}
+{%- endif %}
 
 
 static void ServerMsgRecvHandler
@@ -705,8 +1018,12 @@ static void ServerMsgRecvHandler
     switch (msgPtr->id)
     {
         {%- for function in functions %}
+        {%- if function.name in args.workerFunctions %}
+        case _MSGID_{{apiName}}_{{function.name}} : StartWorkerRequest(msgRef); break;
+        {%- else %}
         case _MSGID_{{apiName}}_{{function.name}} : Handle_{{apiName}}_{{function.name}}(msgRef);
             {#- #} break;
+        {%- endif %}
         {%- endfor %}
 
         default: LE_ERROR("Unknowm msg id = %i", msgPtr->id);
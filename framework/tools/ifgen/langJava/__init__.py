@@ -9,6 +9,9 @@ import codeGenHelpers
 def AddLangArgumentGroup(argParser):
     pass
 
+def CheckArguments(args, interface):
+    pass
+
 # Custom filters needed for C templates
 Filters = { 'FormatHeaderComment': codeGenHelpers.FormatHeaderComment,
             'FormatType':          codeGenHelpers.FormatType,
@@ -0,0 +1,1054 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file mkAppDelta.c  Build a delta app update pack between two versions of an app
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+
+#include "md5.h"
+#include "tarExtract.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Defines some executables requested by the tool
+ */
+//--------------------------------------------------------------------------------------------------
+#define BSDIFF "bsdiff"
+#define BZIP2  "bzip2"
+#define TAR    "tar"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest JSON header accepted at the start of an update pack
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_HEADER_BYTES    4096
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Largest binary diff that the Update Daemon accepts (see tarExtract.c)
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_PATCH_BYTES     (32 * 1024 * 1024)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of a tar block
+ */
+//--------------------------------------------------------------------------------------------------
+#define TAR_BLOCK_BYTES     512
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fields of the JSON header of an update pack that the tool needs
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char   command[32];      ///< Section type
+    char   name[256];        ///< App's name
+    char   version[256];     ///< App's version
+    char   md5[MD5_STRING_BYTES]; ///< MD5 hash of the app
+    size_t size;             ///< Size of the payload
+    size_t headerLen;        ///< Size of the JSON header (offset of the payload)
+}
+PackHeader_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An entry of an app's staging tree
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char*   pathPtr;         ///< Path relative to the tree, in the "./a/b" form
+    char    type;            ///< 'f' (regular file), 'd' (directory) or 'l' (symlink)
+    mode_t  mode;            ///< Permissions
+    off_t   size;            ///< Size of the file
+    uint8_t digest[MD5_DIGEST_BYTES]; ///< MD5 hash of the file's contents
+    char*   targetPtr;       ///< Target of the symlink
+}
+TreeEntry_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A staging tree, sorted by path
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    TreeEntry_t* entriesPtr; ///< Entries
+    size_t count;            ///< Number of entries
+}
+Tree_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Our name
+ */
+//--------------------------------------------------------------------------------------------------
+static char *ProgName;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Verbose mode enabled or disabled (default)
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsVerbose = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffer for the commands launched by system(3)
+ */
+//--------------------------------------------------------------------------------------------------
+static char CmdBuf[4096];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Original working directory. The tool creates and goes to a temporary work directory.
+ */
+//--------------------------------------------------------------------------------------------------
+static char CurrentWorkDir[PATH_MAX];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffer for copying files
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t CopyBuf[64 * 1024];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call at exit(3) to perform all clean-up actions
+ */
+//--------------------------------------------------------------------------------------------------
+static void Exithandler
+(
+    void
+)
+{
+    chdir(CurrentWorkDir);
+    snprintf( CmdBuf, sizeof(CmdBuf),
+              "rm -rf /tmp/appdelta.%u",
+              getpid() );
+    (void)system( CmdBuf );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call system(3) with the command given. In case of error, call exit(3). Return only if system(3)
+ * has succeed
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExecSystem
+(
+    char* cmdPtr
+)
+{
+    int rc;
+
+    if( IsVerbose )
+    {
+        printf("system(%s)\n", cmdPtr);
+    }
+    rc = system( cmdPtr );
+    if( (!WIFEXITED(rc)) || WEXITSTATUS(rc) )
+    {
+        fprintf(stderr,"system(%s) fails: rc=%d\n", cmdPtr, rc);
+        exit(2);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print usage and exit...
+ */
+//--------------------------------------------------------------------------------------------------
+static void Usage
+(
+    void
+)
+{
+    fprintf(stderr,
+            "usage: %s [-o deltaname] [-v] app-orig.update app-dest.update\n",
+            ProgName );
+    fprintf(stderr, "\n");
+    fprintf(stderr, "   -o, <deltaname>\n"
+                    "        Specify the output name of the delta update pack."
+                           " Else use <app>.delta.update as default.\n");
+    fprintf(stderr, "   -v, --verbose\n"
+                    "        Be verbose.\n");
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if tool exists inside the PATH list and is executable. Else raise a message explaining
+ * the missing tool and the way to solve it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckForTool
+(
+    char *toolPtr
+)
+{
+    FILE* fdPtr;
+    char  toolPath[PATH_MAX];
+    char* toolPathPtr;
+
+    snprintf( toolPath, sizeof(toolPath), "which %s", toolPtr );
+    fdPtr = popen( toolPath, "r" );
+    if( NULL == fdPtr )
+    {
+        fprintf(stderr, "popen to %s fails: %m\n", toolPath);
+        exit(1);
+    }
+    toolPathPtr = fgets( toolPath, sizeof(toolPath), fdPtr );
+    pclose( fdPtr );
+    if( !toolPathPtr )
+    {
+        fprintf(stderr,
+                "The tool '%s' is required and missing in the PATH environment variable\n"
+                "or it is not installed on this host.\n", toolPtr);
+        fprintf(stderr,
+                "Try a 'sudo apt-get install %s' or similar to install this package\n",
+                toolPtr);
+        exit(1);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the value of a string member of a JSON header. The headers written by the build tools are
+ * flat objects of strings and numbers, so a plain search is enough.
+ *
+ * @return true if the member was found
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetJsonMember
+(
+    const char* jsonPtr,
+    const char* namePtr,
+    char* valuePtr,
+    size_t valueSize
+)
+{
+    char key[64];
+    const char* startPtr;
+    size_t len;
+
+    snprintf( key, sizeof(key), "\"%s\"", namePtr );
+    startPtr = strstr( jsonPtr, key );
+    if( !startPtr )
+    {
+        return false;
+    }
+    startPtr += strlen(key);
+    while( isspace(*startPtr) || (':' == *startPtr) )
+    {
+        startPtr++;
+    }
+
+    if( '"' == *startPtr )
+    {
+        startPtr++;
+        len = strcspn( startPtr, "\"" );
+    }
+    else
+    {
+        len = strspn( startPtr, "0123456789" );
+    }
+    if( len >= valueSize )
+    {
+        return false;
+    }
+
+    memcpy( valuePtr, startPtr, len );
+    valuePtr[len] = '\0';
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the JSON header of an app update pack. Exit on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadPackHeader
+(
+    const char* packPtr,
+    PackHeader_t* headerPtr
+)
+{
+    char json[MAX_HEADER_BYTES + 1];
+    char size[32];
+    ssize_t len;
+    size_t i;
+    int depth = 0;
+    bool inString = false;
+    int fd;
+
+    fd = open( packPtr, O_RDONLY );
+    if( -1 == fd )
+    {
+        fprintf(stderr, "Unable to open '%s': %m\n", packPtr);
+        exit(1);
+    }
+    len = read( fd, json, MAX_HEADER_BYTES );
+    close( fd );
+    if( len <= 0 )
+    {
+        fprintf(stderr, "Unable to read '%s'\n", packPtr);
+        exit(1);
+    }
+
+    // Find the end of the JSON object (braces inside strings don't count).
+    for( i = 0; i < (size_t)len; i++ )
+    {
+        if( inString )
+        {
+            if( '\\' == json[i] )
+            {
+                i++;
+            }
+            else if( '"' == json[i] )
+            {
+                inString = false;
+            }
+        }
+        else if( '"' == json[i] )
+        {
+            inString = true;
+        }
+        else if( '{' == json[i] )
+        {
+            depth++;
+        }
+        else if( ('}' == json[i]) && (0 == --depth) )
+        {
+            break;
+        }
+    }
+    if( i == (size_t)len )
+    {
+        fprintf(stderr, "'%s' is not an update pack\n", packPtr);
+        exit(1);
+    }
+    json[i + 1] = '\0';
+    headerPtr->headerLen = i + 1;
+
+    memset( headerPtr->version, 0, sizeof(headerPtr->version) );
+    if( (!GetJsonMember( json, "command", headerPtr->command, sizeof(headerPtr->command) )) ||
+        (!GetJsonMember( json, "name", headerPtr->name, sizeof(headerPtr->name) )) ||
+        (!GetJsonMember( json, "md5", headerPtr->md5, sizeof(headerPtr->md5) )) ||
+        (!GetJsonMember( json, "size", size, sizeof(size) )) )
+    {
+        fprintf(stderr, "Malformed update pack header in '%s'\n", packPtr);
+        exit(1);
+    }
+    (void)GetJsonMember( json, "version", headerPtr->version, sizeof(headerPtr->version) );
+    headerPtr->size = strtoul( size, NULL, 10 );
+
+    if( strcmp( headerPtr->command, "updateApp" ) )
+    {
+        fprintf(stderr, "'%s' is not an app update pack (command '%s')\n",
+                packPtr, headerPtr->command);
+        exit(1);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy bytes from a file descriptor to another. Exit on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CopyBytes
+(
+    int fdr,
+    int fdw,
+    size_t len
+)
+{
+    while( len > 0 )
+    {
+        ssize_t rc = read( fdr, CopyBuf, (len < sizeof(CopyBuf)) ? len : sizeof(CopyBuf) );
+        if( rc <= 0 )
+        {
+            fprintf(stderr, "Read error or truncated file: %m\n");
+            exit(1);
+        }
+        if( write( fdw, CopyBuf, rc ) != rc )
+        {
+            fprintf(stderr, "Write error: %m\n");
+            exit(1);
+        }
+        len -= rc;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Extract the payload of an app update pack into a directory of the work directory
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExtractPack
+(
+    const char* packPtr,
+    const PackHeader_t* headerPtr,
+    const char* dirPtr
+)
+{
+    char tarName[PATH_MAX];
+    int fdr, fdw;
+
+    snprintf( tarName, sizeof(tarName), "%s.tar", dirPtr );
+    fdr = open( packPtr, O_RDONLY );
+    fdw = open( tarName, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR );
+    if( (-1 == fdr) || (-1 == fdw) )
+    {
+        fprintf(stderr, "Unable to copy payload of '%s': %m\n", packPtr);
+        exit(1);
+    }
+    if( (off_t)-1 == lseek( fdr, headerPtr->headerLen, SEEK_SET ) )
+    {
+        fprintf(stderr, "Unable to seek in '%s': %m\n", packPtr);
+        exit(1);
+    }
+    CopyBytes( fdr, fdw, headerPtr->size );
+    close( fdr );
+    close( fdw );
+
+    if( -1 == mkdir( dirPtr, S_IRWXU ) )
+    {
+        fprintf(stderr, "Failed to create directory '%s': %m\n", dirPtr);
+        exit(1);
+    }
+    if( snprintf( CmdBuf, sizeof(CmdBuf), TAR " -xf %s -C %s", tarName, dirPtr ) >=
+        (int)sizeof(CmdBuf) )
+    {
+        fprintf(stderr, "Command too long\n");
+        exit(1);
+    }
+    ExecSystem( CmdBuf );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the MD5 hash of a file. Exit on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HashFile
+(
+    const char* pathPtr,
+    uint8_t digest[MD5_DIGEST_BYTES]
+)
+{
+    md5_Ctx_t md5;
+    ssize_t rc;
+    int fd;
+
+    fd = open( pathPtr, O_RDONLY );
+    if( -1 == fd )
+    {
+        fprintf(stderr, "Unable to open '%s': %m\n", pathPtr);
+        exit(1);
+    }
+
+    md5_Init( &md5 );
+    while( (rc = read( fd, CopyBuf, sizeof(CopyBuf) )) > 0 )
+    {
+        md5_Update( &md5, CopyBuf, rc );
+    }
+    if( rc < 0 )
+    {
+        fprintf(stderr, "Unable to read '%s': %m\n", pathPtr);
+        exit(1);
+    }
+    close( fd );
+    md5_Final( &md5, digest );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two tree entries by path
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareEntries
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    return strcmp( ((const TreeEntry_t*)aPtr)->pathPtr, ((const TreeEntry_t*)bPtr)->pathPtr );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Scan a staging tree, hashing its files. Must be called from the tree's directory.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ScanTree
+(
+    Tree_t* treePtr
+)
+{
+    char* const paths[] = { ".", NULL };
+    FTS* ftsPtr;
+    FTSENT* entPtr;
+    size_t allocated = 0;
+
+    ftsPtr = fts_open( paths, FTS_PHYSICAL | FTS_NOCHDIR, NULL );
+    if( !ftsPtr )
+    {
+        fprintf(stderr, "Unable to scan staging tree: %m\n");
+        exit(1);
+    }
+
+    treePtr->entriesPtr = NULL;
+    treePtr->count = 0;
+
+    while( NULL != (entPtr = fts_read( ftsPtr )) )
+    {
+        TreeEntry_t* treeEntryPtr;
+
+        if( FTS_DP == entPtr->fts_info )
+        {
+            continue;
+        }
+        if( (FTS_F != entPtr->fts_info) && (FTS_D != entPtr->fts_info) &&
+            (FTS_SL != entPtr->fts_info) )
+        {
+            fprintf(stderr, "Unsupported file '%s' in staging tree\n", entPtr->fts_path);
+            exit(1);
+        }
+
+        if( treePtr->count == allocated )
+        {
+            allocated = allocated ? (2 * allocated) : 256;
+            treePtr->entriesPtr = realloc( treePtr->entriesPtr, allocated * sizeof(TreeEntry_t) );
+            if( !treePtr->entriesPtr )
+            {
+                fprintf(stderr, "Out of memory\n");
+                exit(1);
+            }
+        }
+        treeEntryPtr = &treePtr->entriesPtr[treePtr->count++];
+        memset( treeEntryPtr, 0, sizeof(*treeEntryPtr) );
+
+        treeEntryPtr->pathPtr = strdup( entPtr->fts_path );
+        treeEntryPtr->mode = entPtr->fts_statp->st_mode & 07777;
+        treeEntryPtr->size = entPtr->fts_statp->st_size;
+
+        if( FTS_F == entPtr->fts_info )
+        {
+            treeEntryPtr->type = 'f';
+            HashFile( entPtr->fts_path, treeEntryPtr->digest );
+        }
+        else if( FTS_D == entPtr->fts_info )
+        {
+            treeEntryPtr->type = 'd';
+        }
+        else
+        {
+            char target[PATH_MAX];
+            ssize_t len = readlink( entPtr->fts_path, target, sizeof(target) - 1 );
+
+            if( len < 0 )
+            {
+                fprintf(stderr, "Unable to read link '%s': %m\n", entPtr->fts_path);
+                exit(1);
+            }
+            target[len] = '\0';
+            treeEntryPtr->type = 'l';
+            treeEntryPtr->targetPtr = strdup( target );
+        }
+    }
+    fts_close( ftsPtr );
+
+    qsort( treePtr->entriesPtr, treePtr->count, sizeof(TreeEntry_t), CompareEntries );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a regular file of the original tree to keep for a file of the destination tree: the file
+ * at the same path if it has the same contents and permissions, else any file that has.
+ *
+ * @return The original file, or NULL if there is none
+ */
+//--------------------------------------------------------------------------------------------------
+static const TreeEntry_t* FindSameFile
+(
+    const Tree_t* origTreePtr,
+    const TreeEntry_t* destEntryPtr
+)
+{
+    const TreeEntry_t* origEntryPtr;
+    size_t i;
+
+    origEntryPtr = bsearch( destEntryPtr, origTreePtr->entriesPtr, origTreePtr->count,
+                            sizeof(TreeEntry_t), CompareEntries );
+    if( origEntryPtr && ('f' == origEntryPtr->type) &&
+        (origEntryPtr->mode == destEntryPtr->mode) &&
+        (0 == memcmp( origEntryPtr->digest, destEntryPtr->digest, MD5_DIGEST_BYTES )) )
+    {
+        return origEntryPtr;
+    }
+
+    for( i = 0; i < origTreePtr->count; i++ )
+    {
+        origEntryPtr = &origTreePtr->entriesPtr[i];
+        if( ('f' == origEntryPtr->type) && (origEntryPtr->mode == destEntryPtr->mode) &&
+            (0 == memcmp( origEntryPtr->digest, destEntryPtr->digest, MD5_DIGEST_BYTES )) )
+        {
+            return origEntryPtr;
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a block-padded tar record. Exit on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteTarData
+(
+    FILE* outPtr,
+    const void* dataPtr,
+    size_t len
+)
+{
+    static const uint8_t zeros[TAR_BLOCK_BYTES];
+    size_t padLen = (TAR_BLOCK_BYTES - (len % TAR_BLOCK_BYTES)) % TAR_BLOCK_BYTES;
+
+    if( (len != fwrite( dataPtr, 1, len, outPtr )) ||
+        (padLen != fwrite( zeros, 1, padLen, outPtr )) )
+    {
+        fprintf(stderr, "Write error: %m\n");
+        exit(1);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a ustar header. Names that don't fit are truncated: a pax header must give them in full.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteTarHeader
+(
+    FILE* outPtr,
+    const char* namePtr,
+    const char* linkNamePtr,
+    char type,
+    mode_t mode,
+    size_t size
+)
+{
+    char header[TAR_BLOCK_BYTES];
+    unsigned int sum = 0;
+    size_t i;
+
+    memset( header, 0, sizeof(header) );
+    strncpy( header, namePtr, 100 );
+    snprintf( header + 100, 8, "%07o", (unsigned int)mode );
+    snprintf( header + 108, 8, "%07o", 0 );
+    snprintf( header + 116, 8, "%07o", 0 );
+    snprintf( header + 124, 12, "%011llo", (unsigned long long)size );
+    snprintf( header + 136, 12, "%011o", 0 );
+    header[156] = type;
+    if( linkNamePtr )
+    {
+        strncpy( header + 157, linkNamePtr, 100 );
+    }
+    memcpy( header + 257, "ustar", 6 );
+    memcpy( header + 263, "00", 2 );
+
+    memset( header + 148, ' ', 8 );
+    for( i = 0; i < sizeof(header); i++ )
+    {
+        sum += (uint8_t)header[i];
+    }
+    snprintf( header + 148, 8, "%06o", sum );
+
+    WriteTarData( outPtr, header, sizeof(header) );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a record to a pax extended header
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddPaxRecord
+(
+    char* paxPtr,
+    size_t paxSize,
+    const char* keyPtr,
+    const char* valuePtr
+)
+{
+    // The length of a record includes its own decimal representation.
+    size_t len = strlen(keyPtr) + strlen(valuePtr) + 3;
+    size_t digits = 1;
+
+    while( snprintf( NULL, 0, "%zu", len + digits ) != (int)digits )
+    {
+        digits++;
+    }
+
+    snprintf( paxPtr + strlen(paxPtr), paxSize - strlen(paxPtr),
+              "%zu %s=%s\n", len + digits, keyPtr, valuePtr );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a tar entry, preceded by a pax extended header if the entry has a hash or long names
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteTarEntry
+(
+    FILE* outPtr,
+    const char* namePtr,
+    const char* linkNamePtr,
+    char type,
+    mode_t mode,
+    size_t size,
+    const uint8_t* digestPtr
+)
+{
+    char pax[3 * PATH_MAX];
+
+    pax[0] = '\0';
+    if( strlen( namePtr ) >= 100 )
+    {
+        AddPaxRecord( pax, sizeof(pax), "path", namePtr );
+    }
+    if( linkNamePtr && (strlen( linkNamePtr ) >= 100) )
+    {
+        AddPaxRecord( pax, sizeof(pax), "linkpath", linkNamePtr );
+    }
+    if( digestPtr )
+    {
+        char md5Str[MD5_STRING_BYTES];
+
+        md5_ToString( digestPtr, md5Str );
+        AddPaxRecord( pax, sizeof(pax), TAR_EXTRACT_PAX_MD5, md5Str );
+    }
+
+    if( pax[0] )
+    {
+        WriteTarHeader( outPtr, "./PaxHeaders/entry", NULL, 'x', 0644, strlen( pax ) );
+        WriteTarData( outPtr, pax, strlen( pax ) );
+    }
+    WriteTarHeader( outPtr, namePtr, linkNamePtr, type, mode, size );
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append the contents of a file to the tarball. Exit on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteTarFile
+(
+    FILE* outPtr,
+    const char* pathPtr,
+    size_t size
+)
+{
+    size_t padLen = (TAR_BLOCK_BYTES - (size % TAR_BLOCK_BYTES)) % TAR_BLOCK_BYTES;
+    FILE* inPtr = fopen( pathPtr, "r" );
+    size_t len;
+
+    if( !inPtr )
+    {
+        fprintf(stderr, "Unable to open '%s': %m\n", pathPtr);
+        exit(1);
+    }
+    while( size > 0 )
+    {
+        len = fread( CopyBuf, 1, (size < sizeof(CopyBuf)) ? size : sizeof(CopyBuf), inPtr );
+        if( 0 == len )
+        {
+            fprintf(stderr, "'%s' changed while reading it\n", pathPtr);
+            exit(1);
+        }
+        if( len != fwrite( CopyBuf, 1, len, outPtr ) )
+        {
+            fprintf(stderr, "Write error: %m\n");
+            exit(1);
+        }
+        size -= len;
+    }
+    fclose( inPtr );
+
+    memset( CopyBuf, 0, padLen );
+    if( padLen != fwrite( CopyBuf, 1, padLen, outPtr ) )
+    {
+        fprintf(stderr, "Write error: %m\n");
+        exit(1);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main :)
+ */
+//--------------------------------------------------------------------------------------------------
+int main
+(
+    int    argc,
+    char** argv
+)
+{
+    char workDir[PATH_MAX];
+    char outName[PATH_MAX];
+    char path[PATH_MAX];
+    char patchName[PATH_MAX];
+    PackHeader_t origHeader, destHeader;
+    Tree_t origTree, destTree;
+    char* outPtr = NULL;
+    char* origPtr;
+    char* destPtr;
+    FILE* tarPtr;
+    struct stat st;
+    size_t i;
+    int fdr, fdw;
+    int keptNum = 0, patchedNum = 0, addedNum = 0;
+    pid_t pid = getpid();
+
+    ProgName = argv[0];
+
+    while( (argc > 1) && ('-' == argv[1][0]) )
+    {
+        if( (argc > 2) && (0 == strcmp(argv[1], "-o")) )
+        {
+            outPtr = argv[2];
+            argv += 2;
+            argc -= 2;
+        }
+        else if( (0 == strcmp(argv[1], "--verbose")) || (0 == strcmp(argv[1], "-v")) )
+        {
+            IsVerbose = true;
+            argv++;
+            argc--;
+        }
+        else
+        {
+            Usage();
+        }
+    }
+    if( 3 != argc )
+    {
+        Usage();
+    }
+
+    CheckForTool( BSDIFF );
+    CheckForTool( BZIP2 );
+    CheckForTool( TAR );
+
+    // Make the paths absolute, as the tool works from a temporary work directory.
+    getcwd(CurrentWorkDir, sizeof(CurrentWorkDir));
+    origPtr = realpath( argv[1], NULL );
+    destPtr = realpath( argv[2], NULL );
+    if( (!origPtr) || (!destPtr) )
+    {
+        fprintf(stderr, "Unable to find '%s': %m\n", origPtr ? argv[2] : argv[1]);
+        exit(1);
+    }
+
+    ReadPackHeader( origPtr, &origHeader );
+    ReadPackHeader( destPtr, &destHeader );
+    if( strcmp( origHeader.name, destHeader.name ) )
+    {
+        fprintf(stderr, "'%s' and '%s' are different apps\n", origHeader.name, destHeader.name);
+        exit(1);
+    }
+    if( 0 == strcmp( origHeader.md5, destHeader.md5 ) )
+    {
+        fprintf(stderr, "'%s' and '%s' are the same app\n", argv[1], argv[2]);
+        exit(1);
+    }
+
+    if( (outPtr &&
+         (snprintf( outName, sizeof(outName), "%s%s%s",
+                    ('/' == *outPtr) ? "" : CurrentWorkDir, ('/' == *outPtr) ? "" : "/",
+                    outPtr ) >= (int)sizeof(outName))) ||
+        ((!outPtr) &&
+         (snprintf( outName, sizeof(outName), "%s/%s.delta.update",
+                    CurrentWorkDir, destHeader.name ) >= (int)sizeof(outName))) )
+    {
+        fprintf(stderr, "Output file name too long\n");
+        exit(1);
+    }
+
+    atexit( Exithandler );
+    snprintf( workDir, sizeof(workDir), "/tmp/appdelta.%u", pid );
+    if( -1 == mkdir(workDir, (mode_t)(S_IRWXU | S_IRWXG | S_IRWXO)) )
+    {
+        fprintf(stderr, "Failed to create directory '%s': %m\n", workDir);
+        exit( 1 );
+    }
+    if( -1 == chdir(workDir) )
+    {
+        fprintf(stderr, "Failed to change directory to '%s': %m\n", workDir);
+        exit( 1 );
+    }
+
+    ExtractPack( origPtr, &origHeader, "orig" );
+    ExtractPack( destPtr, &destHeader, "dest" );
+
+    chdir( "orig" );
+    ScanTree( &origTree );
+    chdir( "../dest" );
+    ScanTree( &destTree );
+    chdir( ".." );
+
+    // Describe the whole destination tree, keeping or patching the original files when possible.
+    // Original files that aren't mentioned are left out of the new app by the Update Daemon.
+    tarPtr = fopen( "delta.tar", "w" );
+    if( !tarPtr )
+    {
+        fprintf(stderr, "Unable to create 'delta.tar': %m\n");
+        exit(1);
+    }
+
+    for( i = 0; i < destTree.count; i++ )
+    {
+        TreeEntry_t* entryPtr = &destTree.entriesPtr[i];
+        const TreeEntry_t* origEntryPtr;
+
+        if( 'd' == entryPtr->type )
+        {
+            WriteTarEntry( tarPtr, entryPtr->pathPtr, NULL, '5', entryPtr->mode, 0, NULL );
+            continue;
+        }
+        if( 'l' == entryPtr->type )
+        {
+            WriteTarEntry( tarPtr, entryPtr->pathPtr, entryPtr->targetPtr, '2',
+                           entryPtr->mode, 0, NULL );
+            continue;
+        }
+
+        origEntryPtr = FindSameFile( &origTree, entryPtr );
+        if( origEntryPtr )
+        {
+            if( IsVerbose )
+            {
+                printf("keep %s (%s)\n", entryPtr->pathPtr, origEntryPtr->pathPtr);
+            }
+            WriteTarEntry( tarPtr, entryPtr->pathPtr, origEntryPtr->pathPtr,
+                           TAR_EXTRACT_TYPE_KEEP, entryPtr->mode, 0, entryPtr->digest );
+            keptNum++;
+            continue;
+        }
+
+        origEntryPtr = bsearch( entryPtr, origTree.entriesPtr, origTree.count,
+                                sizeof(TreeEntry_t), CompareEntries );
+        if( origEntryPtr && ('f' == origEntryPtr->type) && (entryPtr->size > 0) )
+        {
+            snprintf( patchName, sizeof(patchName), "patch.%zu", i );
+            if( snprintf( CmdBuf, sizeof(CmdBuf), BSDIFF " 'orig/%s' 'dest/%s' %s",
+                          origEntryPtr->pathPtr, entryPtr->pathPtr, patchName ) >=
+                (int)sizeof(CmdBuf) )
+            {
+                fprintf(stderr, "Command too long\n");
+                exit(1);
+            }
+            ExecSystem( CmdBuf );
+
+            // Only worth it if the patch is smaller than the file.
+            if( (0 == stat( patchName, &st )) && (st.st_size < entryPtr->size) &&
+                (st.st_size <= MAX_PATCH_BYTES) )
+            {
+                if( IsVerbose )
+                {
+                    printf("patch %s (%lld -> %lld bytes)\n", entryPtr->pathPtr,
+                           (long long)entryPtr->size, (long long)st.st_size);
+                }
+                WriteTarEntry( tarPtr, entryPtr->pathPtr, origEntryPtr->pathPtr,
+                               TAR_EXTRACT_TYPE_PATCH, entryPtr->mode, st.st_size,
+                               entryPtr->digest );
+                WriteTarFile( tarPtr, patchName, st.st_size );
+                unlink( patchName );
+                patchedNum++;
+                continue;
+            }
+            unlink( patchName );
+        }
+
+        if( IsVerbose )
+        {
+            printf("add %s (%lld bytes)\n", entryPtr->pathPtr, (long long)entryPtr->size);
+        }
+        if( snprintf( path, sizeof(path), "dest/%s", entryPtr->pathPtr ) >= (int)sizeof(path) )
+        {
+            fprintf(stderr, "Path too long: %s\n", entryPtr->pathPtr);
+            exit(1);
+        }
+        WriteTarEntry( tarPtr, entryPtr->pathPtr, NULL, '0', entryPtr->mode, entryPtr->size,
+                       NULL );
+        WriteTarFile( tarPtr, path, entryPtr->size );
+        addedNum++;
+    }
+
+    // End of archive: two zero blocks.
+    memset( CopyBuf, 0, 2 * TAR_BLOCK_BYTES );
+    WriteTarData( tarPtr, CopyBuf, 2 * TAR_BLOCK_BYTES );
+    if( fclose( tarPtr ) )
+    {
+        fprintf(stderr, "Write error: %m\n");
+        exit(1);
+    }
+
+    ExecSystem( BZIP2 " -9 delta.tar" );
+    if( -1 == stat( "delta.tar.bz2", &st ) )
+    {
+        fprintf(stderr, "Unable to find 'delta.tar.bz2': %m\n");
+        exit(1);
+    }
+
+    // Write the update pack: JSON header then payload.
+    fdw = open( outName, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH );
+    if( -1 == fdw )
+    {
+        fprintf(stderr, "Unable to create '%s': %m\n", outName);
+        exit(1);
+    }
+    snprintf( CmdBuf, sizeof(CmdBuf),
+              "{\n"
+              "\"command\":\"updateAppDelta\",\n"
+              "\"name\":\"%s\",\n"
+              "\"version\":\"%s\",\n"
+              "\"md5\":\"%s\",\n"
+              "\"baseMd5\":\"%s\",\n"
+              "\"size\":%lld\n"
+              "}",
+              destHeader.name, destHeader.version, destHeader.md5, origHeader.md5,
+              (long long)st.st_size );
+    if( write( fdw, CmdBuf, strlen( CmdBuf ) ) != (ssize_t)strlen( CmdBuf ) )
+    {
+        fprintf(stderr, "Write error: %m\n");
+        exit(1);
+    }
+    fdr = open( "delta.tar.bz2", O_RDONLY );
+    if( -1 == fdr )
+    {
+        fprintf(stderr, "Unable to open 'delta.tar.bz2': %m\n");
+        exit(1);
+    }
+    CopyBytes( fdr, fdw, st.st_size );
+    close( fdr );
+    if( close( fdw ) )
+    {
+        fprintf(stderr, "Write error: %m\n");
+        exit(1);
+    }
+
+    printf("%s: %d kept, %d patched, %d added (%lld bytes of payload instead of %zu)\n",
+           outName, keptNum, patchedNum, addedNum, (long long)st.st_size, destHeader.size);
+
+    exit(0);
+}
@@ -1239,6 +1239,14 @@ void ComponentBuildScriptGenerator_t::GenerateCBuildStatement
         {
             ifgenFlags += " --async-server";
         }
+        if (ifPtr->concurrent)
+        {
+            ifgenFlags += " --concurrent-server";
+            if (!ifPtr->workerFunctions.empty())
+            {
+                ifgenFlags += " --worker-functions " + ifPtr->workerFunctions;
+            }
+        }
         ifgenFlags += " --name-prefix " + ifPtr->internalName;
         script << "build" << generatedFiles << ":"
                   " GenInterfaceCode " << ifPtr->apiFilePtr->path << " |";
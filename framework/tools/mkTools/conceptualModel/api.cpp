@@ -381,7 +381,8 @@ ApiServerInterface_t::ApiServerInterface_t
 //--------------------------------------------------------------------------------------------------
 :   ApiRef_t(aPtr, cPtr, iName),
     async(isAsync),
-    manualStart(false)
+    manualStart(false),
+    concurrent(false)
 //--------------------------------------------------------------------------------------------------
 {
 }
@@ -405,6 +406,15 @@ const
     {
         codeGenDir = path::Combine(apiFilePtr->codeGenDir, "async_server/");
     }
+    else if (concurrent)
+    {
+        // Components can run different functions of the same API in worker threads.
+        codeGenDir = path::Combine(apiFilePtr->codeGenDir, "concurrent_server/");
+        if (!workerFunctions.empty())
+        {
+            codeGenDir = path::Combine(codeGenDir, md5(workerFunctions) + "/");
+        }
+    }
     else
     {
         codeGenDir = path::Combine(apiFilePtr->codeGenDir, "server/");
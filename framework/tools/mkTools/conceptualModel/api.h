@@ -158,6 +158,9 @@ struct ApiServerInterface_t : public ApiRef_t
 {
     const bool async;         ///< true = component wants to use asynchronous mode of operation.
     bool manualStart;   ///< true = generated main() should not call AdvertiseService() function.
+    bool concurrent;    ///< true = requests are run in a pool of worker threads.
+    std::string workerFunctions;    ///< Comma-separated list of the functions run in worker
+                                    ///  threads (empty = all that don't use handlers).
 
     ApiServerInterface_t(ApiFile_t* aPtr, Component_t* cPtr, const std::string& iName, bool async);
 
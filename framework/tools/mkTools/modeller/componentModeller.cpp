@@ -399,6 +399,8 @@ static void GetProvidedApi
     // Check for options.
     bool async = false;
     bool manualStart = false;
+    bool concurrent = false;
+    std::string workerFunctions;
     for (auto contentPtr : contentList)
     {
         if (contentPtr->type == parseTree::Token_t::SERVER_IPC_OPTION)
@@ -411,6 +413,21 @@ static void GetProvidedApi
             {
                 manualStart = true;
             }
+            else if (contentPtr->text == "[concurrent]")
+            {
+                concurrent = true;
+            }
+            else if (contentPtr->text.compare(0, 12, "[concurrent=") == 0)
+            {
+                // Strip the option name and the trailing ']' to get the list of functions.
+                concurrent = true;
+                workerFunctions = contentPtr->text.substr(12, contentPtr->text.length() - 13);
+            }
+
+            if (async && concurrent)
+            {
+                contentPtr->ThrowException(LE_I18N("Can't use [async] with [concurrent]."));
+            }
         }
     }
 
@@ -429,6 +446,8 @@ static void GetProvidedApi
                                                  internalName,
                                                  async);
     ifPtr->manualStart = manualStart;
+    ifPtr->concurrent = concurrent;
+    ifPtr->workerFunctions = workerFunctions;
 
     componentPtr->serverApis.push_back(ifPtr);
 
@@ -895,6 +914,10 @@ static void PrintSummary
                 std::cout << LE_I18N("      Asynchronous server-side processing mode selected.")
                           << std::endl;
             }
+            if (itemPtr->concurrent)
+            {
+                std::cout << LE_I18N("      Requests run in worker threads.") << std::endl;
+            }
             if (itemPtr->manualStart)
             {
                 std::cout << LE_I18N("      Automatic service advertisement at start-up"
@@ -1574,9 +1574,12 @@ void Lexer_t::PullServerIpcOption
 {
     PullIpcOption(tokenPtr);
 
-    // Check that it's one of the valid server-side options.
+    // Check that it's one of the valid server-side options.  Only "[concurrent]" may be given a
+    // list of function names.
     if (   (tokenPtr->text != "[manual-start]")
-           && (tokenPtr->text != "[async]") )
+           && (tokenPtr->text != "[async]")
+           && (tokenPtr->text != "[concurrent]")
+           && (tokenPtr->text.compare(0, 12, "[concurrent=") != 0) )
     {
         ThrowException(
             mk::format(LE_I18N("Invalid server-side IPC option: '%s'"), tokenPtr->text)
@@ -1613,6 +1616,9 @@ void Lexer_t::PullClientIpcOption
 //--------------------------------------------------------------------------------------------------
 /**
  * Pull an IPC option (e.g., "[manual-start]") from the file and store it in the token.
+ *
+ * The option name may be followed by an '=' and a comma-separated list of C identifiers
+ * (e.g., "[concurrent=Scan,Write]").
  */
 //--------------------------------------------------------------------------------------------------
 void Lexer_t::PullIpcOption
@@ -1636,14 +1642,28 @@ void Lexer_t::PullIpcOption
     }
 
     // Continue until terminated by ']'.
+    bool isValueList = false;
     do
     {
+        int c = context.top().nextChars[0];
+
         // Check for end-of-file or illegal character in option.
-        if (context.top().nextChars[0] == EOF)
+        if (c == EOF)
         {
             ThrowException(LE_I18N("Unexpected end-of-file before end of IPC option."));
         }
-        else if ((context.top().nextChars[0] != '-') && !islower(context.top().nextChars[0]))
+        else if (isValueList)
+        {
+            if ((c != ',') && (c != '_') && !isalnum(c))
+            {
+                UnexpectedChar(LE_I18N("Unexpected character %s inside option value."));
+            }
+        }
+        else if ((c == '=') && (tokenPtr->text.back() != '['))
+        {
+            isValueList = true;
+        }
+        else if ((c != '-') && !islower(c))
         {
             UnexpectedChar(LE_I18N("Unexpected character %s inside option."));
         }
@@ -1652,6 +1672,11 @@ void Lexer_t::PullIpcOption
 
     } while (context.top().nextChars[0] != ']');
 
+    if (tokenPtr->text.back() == '=')
+    {
+        ThrowException(LE_I18N("Empty IPC option value."));
+    }
+
     // Eat the trailing ']'.
     AdvanceOneCharacter(tokenPtr);
 }
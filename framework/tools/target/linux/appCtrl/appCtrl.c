@@ -202,6 +202,7 @@ static void PrintHelp
         "    app status [<appName>]\n"
         "    app version <appName>\n"
         "    app info [<appName>]\n"
+        "    app launchTimes [<appName>]\n"
         "    app runProc <appName> <procName> [options]\n"
         "    app runProc <appName> [<procName>] --exe=<exePath> [options]\n"
         "\n"
@@ -249,6 +250,13 @@ static void PrintHelp
         "       If no name is given, prints the information of all installed applications.\n"
         "       If a name is given, prints the information of the specified application.\n"
         "\n"
+        "    app launchTimes [<appName>]\n"
+        "       If no name is given, prints the launch times of all installed applications.\n"
+        "       If a name is given, prints the launch times of the specified application.\n"
+        "       The times (in milliseconds) spent creating the application's sandbox, waiting\n"
+        "       for the applications it is bound to, and starting its processes are printed for\n"
+        "       the most recent launch of the application.\n"
+        "\n"
         "    app runProc <appName> <procName> [options]\n"
         "       Runs a configured process inside an app using the process settings from the\n"
         "       configuration database.  If an exePath is provided as an option then the specified\n"
@@ -664,6 +672,59 @@ static void PrintStatus
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the times taken by the most recent launch of an application.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintAppLaunchTimes
+(
+    const char* appNamePtr      ///< [IN] Application name to get the launch times for.
+)
+{
+    uint32_t createTime;
+    uint32_t waitTime;
+    uint32_t startTime;
+
+    le_appInfo_ConnectService();
+
+    if (le_appInfo_GetLaunchTimes(appNamePtr, &createTime, &waitTime, &startTime) != LE_OK)
+    {
+        printf("[not launched] %s\n", appNamePtr);
+    }
+    else
+    {
+        printf("[create %u ms, wait %u ms, start %u ms] %s\n",
+               createTime, waitTime, startTime, appNamePtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implements the "launchTimes" command.
+ *
+ * @note This function does not return.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void PrintLaunchTimes
+(
+    void
+)
+{
+    if (AppNamePtr == NULL)
+    {
+        ListInstalledApps(PrintAppLaunchTimes);
+    }
+    else
+    {
+        PrintAppLaunchTimes(AppNamePtr);
+    }
+
+    exit(EXIT_SUCCESS);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Parses a line of the APP_INFO_FILE for display.
@@ -1872,6 +1933,14 @@ static void CommandArgHandler
         le_arg_AddPositionalCallback(AppNameArgHandler);
         le_arg_AllowLessPositionalArgsThanCallbacks();
     }
+    else if (strcmp(command, "launchTimes") == 0)
+    {
+        CommandFunc = PrintLaunchTimes;
+
+        // Accept an optional app name argument.
+        le_arg_AddPositionalCallback(AppNameArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+    }
     else
     {
         fprintf(stderr, "Unknown command '%s'.  Try --help.\n", command);
@@ -0,0 +1,249 @@
+//--------------------------------------------------------------------------------------------------
+/** @file bootTrace.c
+ *
+ * Boot trace tool.  Dumps the framework start-up timeline recorded by startSystem, the Supervisor
+ * and the framework daemons (see bootTrace.h) in the Chrome trace event format, which can be
+ * loaded into chrome://tracing or Perfetto.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "bootTrace.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start of the JSON document, up to the first event.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TRACE_PROLOGUE "{\n  \"displayTimeUnit\":\"ms\",\n  \"traceEvents\":["
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Output file (stdout unless --output is given).
+ */
+//--------------------------------------------------------------------------------------------------
+static FILE* OutputFilePtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true until the first event has been printed.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsFirstEvent = true;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints help to stdout and exits.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintHelp
+(
+    void
+)
+{
+    puts(
+        "NAME:\n"
+        "    bootTrace - Dumps the framework start-up timeline.\n"
+        "\n"
+        "SYNOPSIS:\n"
+        "    bootTrace [OPTIONS]\n"
+        "\n"
+        "DESCRIPTION:\n"
+        "    Prints the start-up phases recorded by startSystem, the Supervisor and the framework\n"
+        "    daemons during the last framework start, in the Chrome trace event format (JSON).\n"
+        "    Load the output into chrome://tracing or https://ui.perfetto.dev to view it.\n"
+        "\n"
+        "    Timestamps are in microseconds of CLOCK_MONOTONIC (time since the kernel started).\n"
+        "\n"
+        "OPTIONS:\n"
+        "    -o PATH, --output=PATH\n"
+        "        Writes the trace to a file instead of standard out.\n"
+        "\n"
+        "    --help\n"
+        "        Display this help and exit.\n"
+        );
+
+    exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handles the --output option.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OutputOptionCallback
+(
+    const char* pathPtr
+)
+{
+    OutputFilePtr = fopen(pathPtr, "w");
+
+    if (OutputFilePtr == NULL)
+    {
+        fprintf(stderr, "Failed to open '%s' for writing: %m.\n", pathPtr);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints a string as a JSON string literal.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintJsonString
+(
+    const char* strPtr
+)
+{
+    fputc('"', OutputFilePtr);
+
+    for (; *strPtr != '\0'; strPtr++)
+    {
+        unsigned char c = *strPtr;
+
+        if ((c == '"') || (c == '\\'))
+        {
+            fprintf(OutputFilePtr, "\\%c", c);
+        }
+        else if (c < 0x20)
+        {
+            fprintf(OutputFilePtr, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, OutputFilePtr);
+        }
+    }
+
+    fputc('"', OutputFilePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints a time in nanoseconds as microseconds (the unit of Chrome trace timestamps).
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintMicroseconds
+(
+    uint64_t ns
+)
+{
+    fprintf(OutputFilePtr, "%" PRIu64 ".%03u", ns / 1000, (unsigned int)(ns % 1000));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints one event of the boot trace as a Chrome trace event.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintEvent
+(
+    const bootTrace_Event_t* eventPtr,
+    void* contextPtr
+)
+{
+    if (IsFirstEvent)
+    {
+        fputs(TRACE_PROLOGUE, OutputFilePtr);
+    }
+
+    fprintf(OutputFilePtr, "%s\n    {\"pid\":%d,\"tid\":%d,", IsFirstEvent ? "" : ",",
+            (int)eventPtr->pid, (int)eventPtr->tid);
+    IsFirstEvent = false;
+
+    switch (eventPtr->type)
+    {
+        case BOOT_TRACE_PROCESS:
+            fputs("\"ph\":\"M\",\"name\":\"process_name\",\"args\":{\"name\":", OutputFilePtr);
+            PrintJsonString(eventPtr->name);
+            fputs("}}", OutputFilePtr);
+            return;
+
+        case BOOT_TRACE_COMPLETE:
+            fputs("\"ph\":\"X\",\"dur\":", OutputFilePtr);
+            PrintMicroseconds(eventPtr->durationNs);
+            break;
+
+        case BOOT_TRACE_INSTANT:
+            fputs("\"ph\":\"i\",\"s\":\"p\"", OutputFilePtr);
+            break;
+
+        default:
+            fprintf(OutputFilePtr, "\"ph\":\"%c\"", eventPtr->type);
+            break;
+    }
+
+    fputs(",\"ts\":", OutputFilePtr);
+    PrintMicroseconds(eventPtr->startNs);
+    fputs(",\"cat\":", OutputFilePtr);
+    PrintJsonString(eventPtr->category);
+    fputs(",\"name\":", OutputFilePtr);
+    PrintJsonString(eventPtr->name);
+    fputc('}', OutputFilePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    OutputFilePtr = stdout;
+
+    // --help option causes everything else to be ignored, prints help, and exits.
+    le_arg_SetFlagCallback(PrintHelp, NULL, "help");
+
+    // -o/--output option writes the trace to a file.
+    le_arg_SetStringCallback(OutputOptionCallback, "o", "output");
+
+    le_arg_Scan();
+
+    bool isFinished;
+    size_t droppedCount;
+
+    le_result_t result = bootTrace_Read(PrintEvent, NULL, &isFinished, &droppedCount);
+
+    if (result == LE_NOT_FOUND)
+    {
+        fprintf(stderr, "No boot trace found in '%s'.\n", BOOT_TRACE_PATH);
+        exit(EXIT_FAILURE);
+    }
+    else if (result != LE_OK)
+    {
+        fprintf(stderr, "Boot trace '%s' is not valid.\n", BOOT_TRACE_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    if (IsFirstEvent)
+    {
+        fputs(TRACE_PROLOGUE, OutputFilePtr);
+    }
+
+    fprintf(OutputFilePtr, "\n  ],\n  \"otherData\":{\"bootFinished\":%s,\"droppedEvents\":%zu}}\n",
+            isFinished ? "true" : "false", droppedCount);
+
+    if (!isFinished)
+    {
+        fprintf(stderr, "Warning: the framework hasn't finished starting; the trace is partial.\n");
+    }
+    if (droppedCount > 0)
+    {
+        fprintf(stderr, "Warning: %zu events were dropped from the boot trace.\n", droppedCount);
+    }
+
+    if (fclose(OutputFilePtr) != 0)
+    {
+        fprintf(stderr, "Failed to write the trace: %m.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -85,6 +85,9 @@ typedef struct
 {
     le_dls_List_t* bucketsPtr;  ///< Array of buckets in the hashmap in the remote process.
     size_t bucketCount;         ///< Size of the array of buckets.
+    le_dls_List_t* oldBucketsPtr; ///< Array of buckets being moved out of if the remote hashmap
+                                  ///  is being resized.  These are walked before bucketsPtr.
+    size_t oldBucketCount;      ///< Size of the array of buckets being moved out of.
     size_t* mapChgCntRef;       ///< Change counter for the remote map.
 }
 RemoteHashmapAccess_t;
@@ -638,6 +641,30 @@ static SemaphoreIter_Ref_t CreateSemaphoreIter
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the address of a bucket of a hashmap in the remote process.  If the hashmap is being
+ * resized, the buckets being moved out of come first, followed by the buckets of the new array.
+ *
+ * @return
+ *      The address of the bucket in the remote process.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t* GetRemoteBucketPtr
+(
+    RemoteHashmapAccess_t* mapAccessPtr, ///< [IN] The remote hashmap.
+    size_t index                         ///< [IN] Index of the bucket.
+)
+{
+    if (index < mapAccessPtr->oldBucketCount)
+    {
+        return mapAccessPtr->oldBucketsPtr + index;
+    }
+
+    return mapAccessPtr->bucketsPtr + (index - mapAccessPtr->oldBucketCount);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates an iterator that can be used to iterate over the map of interface objects. See the
@@ -710,6 +737,8 @@ static InterfaceObjIter_Ref_t CreateInterfaceObjIter
 
     iteratorPtr->interfaceObjMap.bucketsPtr = map.bucketsPtr;
     iteratorPtr->interfaceObjMap.bucketCount = map.bucketCount;
+    iteratorPtr->interfaceObjMap.oldBucketsPtr = map.oldBucketsPtr;
+    iteratorPtr->interfaceObjMap.oldBucketCount = map.oldBucketCount;
 
     // Get the mapChgCntRef for the process-under-inspection.
     if (fd_ReadFromOffset(FdProcMem, mapChgCntAddrOffset,
@@ -723,7 +752,8 @@ static InterfaceObjIter_Ref_t CreateInterfaceObjIter
     iteratorPtr->currIndex = 0;
 
     // Get the list of interface objects.
-    if (fd_ReadFromOffset(FdProcMem, (ssize_t)iteratorPtr->interfaceObjMap.bucketsPtr,
+    if (fd_ReadFromOffset(FdProcMem,
+                          (ssize_t)GetRemoteBucketPtr(&iteratorPtr->interfaceObjMap, 0),
                           &(iteratorPtr->interfaceObjList.List),
                           sizeof(iteratorPtr->interfaceObjList.List)) != LE_OK)
     {
@@ -1367,7 +1397,8 @@ static void* GetNextInterfaceObjPtr
     while (remEntryNextLinkPtr == NULL)
     {
         // Increment the bucket index. Return null if we run out of buckets.
-        if (iterator->currIndex < (iterator->interfaceObjMap.bucketCount - 1))
+        if (iterator->currIndex < (iterator->interfaceObjMap.oldBucketCount +
+                                   iterator->interfaceObjMap.bucketCount - 1))
         {
             iterator->currIndex++;
         }
@@ -1378,7 +1409,8 @@ static void* GetNextInterfaceObjPtr
 
         // So we haven't run out of buckets yet. Then update our interface object list.
         if (fd_ReadFromOffset(FdProcMem,
-                              (ssize_t)(iterator->interfaceObjMap.bucketsPtr + iterator->currIndex),
+                              (ssize_t)GetRemoteBucketPtr(&iterator->interfaceObjMap,
+                                                          iterator->currIndex),
                               &(iterator->interfaceObjList.List),
                               sizeof(iterator->interfaceObjList.List)) != LE_OK)
         {
@@ -1675,7 +1707,11 @@ static ColumnInfo_t ThreadObjTableInfo[] =
     {"CONTENTION SCOPE", "%*s", NULL, "%*s",  0,                    true,  0, true},
     {"GUARD SIZE",       "%*s", NULL, "%*zu", sizeof(size_t),       false, 0, true},
     {"STACK ADDR",       "%*s", NULL, "%*X",  sizeof(uint64_t),     false, 0, true},
-    {"STACK SIZE",       "%*s", NULL, "%*zu", sizeof(size_t),       false, 0, true}
+    {"STACK SIZE",       "%*s", NULL, "%*zu", sizeof(size_t),       false, 0, true},
+    {"QUEUED",           "%*s", NULL, "%*zu", sizeof(size_t),       false, 0, true},
+    {"MAX QUEUED",       "%*s", NULL, "%*zu", sizeof(size_t),       false, 0, true},
+    {"REPORTS",          "%*s", NULL, "%*zu", sizeof(size_t),       false, 0, true},
+    {"WAKEUPS",          "%*s", NULL, "%*zu", sizeof(size_t),       false, 0, true}
 };
 static size_t ThreadObjTableInfoSize = NUM_ARRAY_MEMBERS(ThreadObjTableInfo);
 
@@ -1730,7 +1766,13 @@ static ColumnInfo_t SessionObjTableInfo[] =
     {"INTERFACE NAME", "%*s", NULL, "%*s", LIMIT_MAX_IPC_INTERFACE_NAME_BYTES, true,  0, true},
     {"STATE",          "%*s", NULL, "%*s", 0,                                  true,  0, true},
     {"THREAD NAME",    "%*s", NULL, "%*s", MAX_THREAD_NAME_SIZE,               true,  0, true},
-    {"FD",             "%*s", NULL, "%*d", sizeof(int),                        false, 0, false}
+    {"FD",             "%*s", NULL, "%*d", sizeof(int),                        false, 0, false},
+    {"RX MSGS",        "%*s", NULL, "%*zu", sizeof(size_t),                    false, 0, false},
+    {"RX CALLS",       "%*s", NULL, "%*zu", sizeof(size_t),                    false, 0, false},
+    {"RX MAX BATCH",   "%*s", NULL, "%*zu", sizeof(size_t),                    false, 0, false},
+    {"TX MSGS",        "%*s", NULL, "%*zu", sizeof(size_t),                    false, 0, false},
+    {"TX CALLS",       "%*s", NULL, "%*zu", sizeof(size_t),                    false, 0, false},
+    {"TX MAX BATCH",   "%*s", NULL, "%*zu", sizeof(size_t),                    false, 0, false}
 };
 static size_t SessionObjTableInfoSize = NUM_ARRAY_MEMBERS(SessionObjTableInfo);
 
@@ -2872,6 +2914,11 @@ static int PrintThreadObjInfo
         INTERNAL_ERR("pthread_attr_getstack failed.");
     }
 
+    // Event Queue statistics.  The queue's count is raised by whoever pushes a report and
+    // lowered by the thread once it has processed it, and the thread is only woken up when the
+    // count goes up from zero, so WAKEUPS is lower than REPORTS when the thread is kept busy.
+    event_PerThreadRec_t* eventRecPtr = &threadObjRef->eventRec;
+
     // Output thread object info
     int index = 0;
 
@@ -2899,6 +2946,14 @@ static int PrintThreadObjInfo
                                                                     ThreadObjTableInfoSize, &index);
         FillSizeTColField (stackSize,                               ThreadObjTableInfo,
                                                                     ThreadObjTableInfoSize, &index);
+        FillSizeTColField (eventRecPtr->queueCount,                 ThreadObjTableInfo,
+                                                                    ThreadObjTableInfoSize, &index);
+        FillSizeTColField (eventRecPtr->maxQueueCount,              ThreadObjTableInfo,
+                                                                    ThreadObjTableInfoSize, &index);
+        FillSizeTColField (eventRecPtr->reportCount,                ThreadObjTableInfo,
+                                                                    ThreadObjTableInfoSize, &index);
+        FillSizeTColField (eventRecPtr->wakeupCount,                ThreadObjTableInfo,
+                                                                    ThreadObjTableInfoSize, &index);
 
         PrintInfo(ThreadObjTableInfo, ThreadObjTableInfoSize);
         lineCount++;
@@ -2941,6 +2996,14 @@ static int PrintThreadObjInfo
                                                           ThreadObjTableInfoSize, &index, &printed);
         ExportSizeTToJson (stackSize,                     ThreadObjTableInfo,
                                                           ThreadObjTableInfoSize, &index, &printed);
+        ExportSizeTToJson (eventRecPtr->queueCount,       ThreadObjTableInfo,
+                                                          ThreadObjTableInfoSize, &index, &printed);
+        ExportSizeTToJson (eventRecPtr->maxQueueCount,    ThreadObjTableInfo,
+                                                          ThreadObjTableInfoSize, &index, &printed);
+        ExportSizeTToJson (eventRecPtr->reportCount,      ThreadObjTableInfo,
+                                                          ThreadObjTableInfoSize, &index, &printed);
+        ExportSizeTToJson (eventRecPtr->wakeupCount,      ThreadObjTableInfo,
+                                                          ThreadObjTableInfoSize, &index, &printed);
 
         printf("]");
     }
@@ -3624,6 +3687,18 @@ static int PrintSessionObjInfo
                                                  SessionObjTableInfoSize, &index);
         FillIntColField(sessionObjRef->socketFd, SessionObjTableInfo,
                                                  SessionObjTableInfoSize, &index);
+        FillSizeTColField(sessionObjRef->rxStats.msgCount,  SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index);
+        FillSizeTColField(sessionObjRef->rxStats.callCount, SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index);
+        FillSizeTColField(sessionObjRef->rxStats.maxBatch,  SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index);
+        FillSizeTColField(sessionObjRef->txStats.msgCount,  SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index);
+        FillSizeTColField(sessionObjRef->txStats.callCount, SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index);
+        FillSizeTColField(sessionObjRef->txStats.maxBatch,  SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index);
 
         PrintInfo(SessionObjTableInfo, SessionObjTableInfoSize);
         lineCount++;
@@ -3652,6 +3727,24 @@ static int PrintSessionObjInfo
                                                  SessionObjTableInfoSize, &index, &printed);
         ExportIntToJson(sessionObjRef->socketFd, SessionObjTableInfo,
                                                  SessionObjTableInfoSize, &index, &printed);
+        ExportSizeTToJson(sessionObjRef->rxStats.msgCount,  SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index,
+                                                            &printed);
+        ExportSizeTToJson(sessionObjRef->rxStats.callCount, SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index,
+                                                            &printed);
+        ExportSizeTToJson(sessionObjRef->rxStats.maxBatch,  SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index,
+                                                            &printed);
+        ExportSizeTToJson(sessionObjRef->txStats.msgCount,  SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index,
+                                                            &printed);
+        ExportSizeTToJson(sessionObjRef->txStats.callCount, SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index,
+                                                            &printed);
+        ExportSizeTToJson(sessionObjRef->txStats.maxBatch,  SessionObjTableInfo,
+                                                            SessionObjTableInfoSize, &index,
+                                                            &printed);
 
         printf("]");
     }
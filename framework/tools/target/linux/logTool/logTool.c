@@ -26,6 +26,23 @@ $ log trace keyword processName/componentName
  * To disable a trace:
  * @verbatim
 $ log stoptrace keyword processName/componentName
+@endverbatim
+ *
+ * To print log messages as they are logged:
+ * @verbatim
+$ log stream
+@endverbatim
+ *
+ * To print the log messages kept in RAM by the log daemon (this works even if the log daemon is
+ * not running):
+ * @verbatim
+$ log dump
+@endverbatim
+ *
+ * To also write log messages to a file (or to stop doing so):
+ * @verbatim
+$ log file /path/to/file
+$ log file off
 @endverbatim
  *
  *
@@ -52,8 +69,10 @@ $ log stoptrace keyword processName/componentName
 #include "legato.h"
 #include "log.h"
 #include "logDaemon.h"
+#include "logHistory.h"
 #include "limit.h"
 #include <ctype.h>
+#include <sys/mman.h>
 
 
 //--------------------------------------------------------------------------------------------------
@@ -119,6 +138,9 @@ static void PrintHelpAndExit
         "    log trace KEYWORD_STR [DESTINATION]\n"
         "    log stoptrace KEYWORD_STR [DESTINATION]\n"
         "    log forget PROCESS_NAME\n"
+        "    log stream\n"
+        "    log dump\n"
+        "    log file PATH|off\n"
         "\n"
         "DESCRIPTION:\n"
         "    log list            Lists all processes/components registered with the\n"
@@ -146,6 +168,18 @@ static void PrintHelpAndExit
         "                        Future processes with that name will have default\n"
         "                        settings.\n"
         "\n"
+        "    log stream          Prints log messages as they are logged, until\n"
+        "                        interrupted.\n"
+        "\n"
+        "    log dump            Prints the last log messages kept in RAM by the log\n"
+        "                        daemon.  Works even if the log daemon is not running,\n"
+        "                        e.g., to see what was logged before it crashed.\n"
+        "\n"
+        "    log file            Also writes log messages to the file at absolute path\n"
+        "                        PATH, or stops doing so if 'off' is given instead.\n"
+        "                        The file is renamed to PATH.1 and started over when\n"
+        "                        it gets too big.\n"
+        "\n"
         "The [DESTINATION] is optional and specifies the process and component to\n"
         "send the command to.  The [DESTINATION] must be in this format:\n"
         "\n"
@@ -187,11 +221,19 @@ static void MsgReceiveHandler
     // Print out whatever the Log Control Daemon sent us.
     printf("%s\n", responseStr);
 
+    // Streamed messages come one at a time, so don't leave them sitting in the stdio buffer.
+    if (Command == LOG_CMD_STREAM)
+    {
+        fflush(stdout);
+    }
+
     // If the first character of the response is a '*', then there has been an error.
     if (responseStr[0] == '*')
     {
         ErrorOccurred = true;
     }
+
+    le_msg_ReleaseMsg(msgRef);
 }
 
 
@@ -479,6 +521,95 @@ static void ProcessIdArgHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function that gets called by le_arg_Scan() when the path argument for a "file" command is found
+ * on the command line.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void FilePathArgHandler
+(
+    const char* path
+)
+{
+    if ((strcmp(path, "off") != 0) && (path[0] != '/'))
+    {
+        ExitWithErrorMsg("The log file path must be an absolute path.");
+    }
+
+    CommandParamPtr = path;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the log history kept in RAM by the Log Control Daemon (see logHistory.h), oldest line
+ * first, and exits.  Lines that the Log Control Daemon overwrites while they are being printed
+ * are skipped.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void DumpHistory
+(
+    void
+)
+{
+    int fd = open(LOG_HISTORY_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        printf("***ERROR: Can't open log history '%s' (%m).\n", LOG_HISTORY_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat st;
+    void* mapPtr = MAP_FAILED;
+
+    if ((fstat(fd, &st) == 0) && (st.st_size == LOG_HISTORY_FILE_BYTES))
+    {
+        mapPtr = mmap(NULL, LOG_HISTORY_FILE_BYTES, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    logHistory_Header_t* headerPtr = mapPtr;
+
+    if (   (mapPtr == MAP_FAILED)
+        || (__atomic_load_n(&headerPtr->magic, __ATOMIC_ACQUIRE) != LOG_HISTORY_MAGIC)
+        || (headerPtr->slotCount != LOG_HISTORY_SLOT_COUNT)
+        || (headerPtr->slotSize != sizeof(logHistory_Slot_t)) )
+    {
+        printf("***ERROR: Log history '%s' is not valid.\n", LOG_HISTORY_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    uint32_t endLine = __atomic_load_n(&headerPtr->lineCount, __ATOMIC_ACQUIRE);
+    uint32_t lineNum = (endLine > LOG_HISTORY_SLOT_COUNT) ? (endLine - LOG_HISTORY_SLOT_COUNT) : 0;
+
+    for (; lineNum != endLine; lineNum++)
+    {
+        logHistory_Slot_t* slotPtr = logHistory_GetSlotPtr(headerPtr, lineNum);
+        char line[LOG_HISTORY_LINE_BYTES];
+
+        if (__atomic_load_n(&slotPtr->seq, __ATOMIC_ACQUIRE) != lineNum + 1)
+        {
+            continue;
+        }
+
+        memcpy(line, slotPtr->line, sizeof(line));
+        line[sizeof(line) - 1] = '\0';
+
+        // Check that the line wasn't overwritten while it was being copied.
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slotPtr->seq, __ATOMIC_RELAXED) != lineNum + 1)
+        {
+            continue;
+        }
+
+        printf("%s\n", line);
+    }
+
+    exit(EXIT_SUCCESS);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Function that gets called by le_arg_Scan() when it sees the first positional argument while
@@ -529,6 +660,24 @@ static void CommandArgHandler
         // This command has only a process name (or pid) as a parameter.
         le_arg_AddPositionalCallback(ProcessIdArgHandler);
     }
+    else if (strcmp(command, "stream") == 0)
+    {
+        Command = LOG_CMD_STREAM;
+
+        // This command has no parameters and no destination.
+    }
+    else if (strcmp(command, "dump") == 0)
+    {
+        // This command doesn't involve the Log Control Daemon.
+        DumpHistory();
+    }
+    else if (strcmp(command, "file") == 0)
+    {
+        Command = LOG_CMD_SET_FILE;
+
+        // This command has only a file path (or "off") as a parameter.
+        le_arg_AddPositionalCallback(FilePathArgHandler);
+    }
     else
     {
         char errorMsg[100];
@@ -583,6 +732,20 @@ COMPONENT_INIT
 
             AppendToCommand(msgRef, CommandParamPtr);
 
+            break;
+
+        case LOG_CMD_STREAM:
+
+            // This one has no arguments.  The Log Control Daemon keeps the IPC session open and
+            // sends every log message on it, until this tool is killed.
+
+            break;
+
+        case LOG_CMD_SET_FILE:
+
+            AppendToCommand(msgRef, DEFAULT_SESSION_ID "/");
+            AppendToCommand(msgRef, CommandParamPtr);
+
             break;
     }
 